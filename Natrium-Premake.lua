@@ -92,3 +92,247 @@ project "Natrium"
     filter { "system:windows", "configurations:rel or dist" }
         links "shaderc_combined"
 		
+
+-- turns files written by Na::BinaryLog back into text
+project "NaLogDecode"
+    location "tools/NaLogDecode/"
+    kind "ConsoleApp"
+    staticruntime "Off"
+
+    language "C++"
+    cppdialect "C++20"
+    systemversion "latest"
+
+    files { "tools/NaLogDecode/**.cpp" }
+
+    includedirs {
+        "%{IncludeDirectories.fmt}",
+        "%{IncludeDirectories.glm}",
+        "%{IncludeDirectories.glfw}",
+        "include/"
+    }
+
+    links {
+        "Natrium",
+        "%{Libraries.fmt}"
+    }
+
+    filter "system:linux"
+        defines { "NA_PLATFORM_LINUX" }
+
+    filter "system:windows"
+        includedirs "%{IncludeDirectories.vk}"
+
+        defines {
+            "NA_PLATFORM_WINDOWS",
+            "_CRT_SECURE_NO_WARNINGS"
+        }
+
+        buildoptions { "/utf-8" }
+
+    filter "configurations:dbg"
+        symbols "On"
+        runtime "Debug"
+        defines { "NA_CONFIG_DEBUG" }
+
+    filter "configurations:rel"
+        optimize "speed"
+        defines { "NA_CONFIG_RELEASE" }
+
+    filter "configurations:dist"
+        optimize "speed"
+        defines { "NA_CONFIG_DIST" }
+
+-- packs an asset dir into one Na::AssetPack
+project "NaPack"
+    location "tools/NaPack/"
+    kind "ConsoleApp"
+    staticruntime "Off"
+
+    language "C++"
+    cppdialect "C++20"
+    systemversion "latest"
+
+    files { "tools/NaPack/**.cpp" }
+
+    includedirs {
+        "%{IncludeDirectories.fmt}",
+        "%{IncludeDirectories.glm}",
+        "%{IncludeDirectories.glfw}",
+        "include/"
+    }
+
+    links {
+        "Natrium",
+        "%{Libraries.fmt}"
+    }
+
+    filter "system:linux"
+        defines { "NA_PLATFORM_LINUX" }
+
+    filter "system:windows"
+        includedirs "%{IncludeDirectories.vk}"
+
+        defines {
+            "NA_PLATFORM_WINDOWS",
+            "_CRT_SECURE_NO_WARNINGS"
+        }
+
+        buildoptions { "/utf-8" }
+
+    filter "configurations:dbg"
+        symbols "On"
+        runtime "Debug"
+        defines { "NA_CONFIG_DEBUG" }
+
+    filter "configurations:rel"
+        optimize "speed"
+        defines { "NA_CONFIG_RELEASE" }
+
+    filter "configurations:dist"
+        optimize "speed"
+        defines { "NA_CONFIG_DIST" }
+
+-- renders fixed workloads and writes their timings as json, see tools/NaBench/Bench.hpp
+project "NaBench"
+    location "tools/NaBench/"
+    kind "ConsoleApp"
+    staticruntime "Off"
+
+    language "C++"
+    cppdialect "C++20"
+    systemversion "latest"
+
+    files {
+        "tools/NaBench/**.hpp",
+        "tools/NaBench/**.cpp",
+        "tools/BenchCommon/**.hpp",
+        "tools/BenchCommon/**.cpp"
+    }
+
+    includedirs {
+        "%{IncludeDirectories.fmt}",
+        "%{IncludeDirectories.glm}",
+        "%{IncludeDirectories.glfw}",
+        "include/",
+        "tools/"
+    }
+
+    links {
+        "Natrium",
+        "%{Libraries.stb}",
+        "%{Libraries.fmt}",
+        "%{Libraries.tiny_obj_loader}",
+        "%{Libraries.glfw}"
+    }
+
+    filter "system:linux"
+        links {
+            "vulkan",
+            "shaderc"
+        }
+
+        defines { "NA_PLATFORM_LINUX" }
+
+    filter "system:windows"
+        includedirs "%{IncludeDirectories.vk}"
+        libdirs "%{LibraryDirectories.vk}"
+
+        links "vulkan-1"
+
+        defines {
+            "NA_PLATFORM_WINDOWS",
+            "_CRT_SECURE_NO_WARNINGS"
+        }
+
+        buildoptions { "/utf-8" }
+
+    filter "configurations:dbg"
+        symbols "On"
+        runtime "Debug"
+        defines { "NA_CONFIG_DEBUG" }
+
+    filter "configurations:rel"
+        optimize "speed"
+        defines { "NA_CONFIG_RELEASE" }
+
+    filter "configurations:dist"
+        optimize "speed"
+        defines { "NA_CONFIG_DIST" }
+
+    filter { "system:windows", "configurations:dbg" }
+        links "shaderc_combinedd"
+    filter { "system:windows", "configurations:rel or dist" }
+        links "shaderc_combined"
+
+-- cpu only timings of the containers and asset loaders as json, see tools/NaMicroBench/MicroBench.hpp
+project "NaMicroBench"
+    location "tools/NaMicroBench/"
+    kind "ConsoleApp"
+    staticruntime "Off"
+
+    language "C++"
+    cppdialect "C++20"
+    systemversion "latest"
+
+    files {
+        "tools/NaMicroBench/**.hpp",
+        "tools/NaMicroBench/**.cpp",
+        "tools/BenchCommon/**.hpp",
+        "tools/BenchCommon/**.cpp"
+    }
+
+    includedirs {
+        "%{IncludeDirectories.fmt}",
+        "%{IncludeDirectories.glm}",
+        "%{IncludeDirectories.glfw}",
+        "include/",
+        "tools/"
+    }
+
+    links {
+        "Natrium",
+        "%{Libraries.stb}",
+        "%{Libraries.fmt}",
+        "%{Libraries.tiny_obj_loader}",
+        "%{Libraries.glfw}"
+    }
+
+    filter "system:linux"
+        links {
+            "vulkan",
+            "shaderc"
+        }
+
+        defines { "NA_PLATFORM_LINUX" }
+
+    filter "system:windows"
+        includedirs "%{IncludeDirectories.vk}"
+        libdirs "%{LibraryDirectories.vk}"
+
+        links "vulkan-1"
+
+        defines {
+            "NA_PLATFORM_WINDOWS",
+            "_CRT_SECURE_NO_WARNINGS"
+        }
+
+        buildoptions { "/utf-8" }
+
+    filter "configurations:dbg"
+        symbols "On"
+        runtime "Debug"
+        defines { "NA_CONFIG_DEBUG" }
+
+    filter "configurations:rel"
+        optimize "speed"
+        defines { "NA_CONFIG_RELEASE" }
+
+    filter "configurations:dist"
+        optimize "speed"
+        defines { "NA_CONFIG_DIST" }
+
+    filter { "system:windows", "configurations:dbg" }
+        links "shaderc_combinedd"
+    filter { "system:windows", "configurations:rel or dist" }
+        links "shaderc_combined"
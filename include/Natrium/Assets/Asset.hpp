@@ -10,6 +10,9 @@ namespace Na {
 		virtual ~Asset(void) = default;
 
 		[[nodiscard]] virtual inline operator bool(void) const = 0;
+
+		// host memory held by the asset, what AssetRegistry's budget counts
+		[[nodiscard]] virtual inline u64 memory_usage(void) const { return 0; }
 	};
 
 	template<typename t_Asset = Asset>
@@ -28,6 +31,27 @@ namespace Na {
 		{
 			{ T::Load(path) } -> std::same_as<AssetHandle<T>>;
 		};
+
+	/// 
+	/// the contents of a file that is not on disk by itself, e.g. an entry of an AssetPack,
+	/// owner keeps bytes alive, so assets may point into them instead of copying
+	/// 
+	struct AssetBlob {
+		std::span<const Byte> bytes;
+		std::shared_ptr<const void> owner;
+		std::filesystem::path path; // as it was looked up, for the extension and error messages
+	};
+
+	/// 
+	/// assets AssetRegistry can load out of mounted packs, the others are always loaded from loose files
+	/// 
+	template<typename T>
+	concept BlobLoadableAsset =
+		LoadableAsset<T> &&
+		requires(const AssetBlob& blob)
+		{
+			{ T::Load(blob) } -> std::same_as<AssetHandle<T>>;
+		};
 } // namespace Na
 
 #endif // NA_ASSET_HPP
\ No newline at end of file
@@ -0,0 +1,125 @@
+#if !defined(NA_ASSET_PACK_HPP)
+#define NA_ASSET_PACK_HPP
+
+#include "Natrium/Assets/Asset.hpp"
+#include "Natrium/Core/MappedFile.hpp"
+
+namespace Na {
+	enum class PackCompression : u8 {
+		None = 0,
+		LZ4  = 1 // the LZ4 block format, entries that do not shrink are stored as they are
+	};
+
+	/// 
+	/// many assets in one file, mapped once and looked up by path through a table of contents
+	/// sorted by the path's hash, so opening an asset costs no syscalls
+	/// 
+	/// entries are content addressed, identical files are stored once and each entry keeps
+	/// a hash of its contents, uncompressed entries are aligned to k_EntryAlignment and read
+	/// in place from the mapping, compressed ones are decompressed into their own memory
+	/// 
+	/// layout, little endian: Header, the entries' data, the table of contents (Entry),
+	/// the paths, generic and relative to the packed directory, e.g. "textures/grass.png"
+	/// 
+	class AssetPack {
+	public:
+		static constexpr u32 k_Magic = 0x4B50414E; // "NAPK"
+		static constexpr u32 k_Version = 1;
+		static constexpr u64 k_EntryAlignment = 64;
+		static constexpr std::string_view k_Extension = ".napk";
+
+		struct Header {
+			u32 magic;
+			u32 version;
+			u32 entry_count;
+			u32 reserved;
+			u64 toc_offset;
+			u64 paths_offset;
+			u64 paths_size;
+		};
+
+		struct Entry {
+			u64 path_hash;
+			u64 content_hash; // of the uncompressed contents
+			u64 offset;
+			u64 stored_size;
+			u64 size;
+			u32 path_offset; // into the paths
+			u32 path_size;
+			PackCompression compression;
+			u8 reserved[7];
+		};
+		static_assert(sizeof(Header) == 40 && sizeof(Entry) == 56);
+	public:
+		AssetPack(void) = default;
+
+		// throws if the file is not a pack of this version
+		AssetPack(const std::filesystem::path& path);
+
+		AssetPack(const AssetPack& other) = delete;
+		AssetPack& operator=(const AssetPack& other) = delete;
+
+		AssetPack(AssetPack&& other) = default;
+		AssetPack& operator=(AssetPack&& other) = default;
+
+		[[nodiscard]] const Entry* find(std::string_view path) const;
+		[[nodiscard]] inline bool contains(std::string_view path) const { return this->find(path); }
+
+		/// 
+		/// nullopt if the pack has no such entry, throws if it is corrupt, the bytes of
+		/// uncompressed entries stay valid as long as the blob's owner or the pack
+		/// 
+		[[nodiscard]] std::optional<AssetBlob> read(std::string_view path) const;
+		[[nodiscard]] AssetBlob read(const Entry& entry) const;
+
+		[[nodiscard]] std::string_view entry_path(const Entry& entry) const;
+		[[nodiscard]] inline std::span<const Entry> entries(void) const { return m_Entries; }
+
+		[[nodiscard]] inline const std::filesystem::path& path(void) const { return m_Path; }
+		[[nodiscard]] inline operator bool(void) const { return (bool)m_File; }
+
+		// of a path spelled like the pack's, FNV-1a
+		[[nodiscard]] static u64 HashPath(std::string_view path);
+	private:
+		std::shared_ptr<MappedFile> m_File; // shared with the blobs read from it
+		std::span<const Entry> m_Entries;
+		std::span<const char> m_Paths;
+		std::filesystem::path m_Path;
+	};
+
+	/// 
+	/// collects entries in memory and writes them as one AssetPack
+	/// 
+	class AssetPackWriter {
+	public:
+		AssetPackWriter(void) = default;
+
+		// a later entry for the same path replaces the earlier one
+		void add(std::string_view path, std::span<const Byte> data, PackCompression compression = PackCompression::LZ4);
+		void add_file(std::string_view path, const std::filesystem::path& file, PackCompression compression = PackCompression::LZ4);
+
+		// every file under dir, with its path relative to dir, returns how many were added
+		u64 add_directory(const std::filesystem::path& dir, PackCompression compression = PackCompression::LZ4);
+
+		// written to a temporary file first, so a pack that is mounted is never seen half written
+		void write(const std::filesystem::path& path) const;
+
+		[[nodiscard]] inline u64 entry_count(void) const { return m_Entries.size(); }
+
+		// of the entries' data after compression and deduplication, without alignment
+		[[nodiscard]] u64 stored_size(void) const;
+	private:
+		struct Blob {
+			std::vector<Byte> data; // as stored
+			u64 size;
+			u64 content_hash;
+			PackCompression compression;
+		};
+	private:
+		std::map<std::string, u64, std::less<>> m_Entries; // path -> index into m_Blobs
+		std::vector<Blob> m_Blobs;
+		std::unordered_multimap<u64, u64> m_BlobsByHash; // content hash -> blob, candidates for deduplication
+	};
+} // namespace Na
+
+#endif // NA_ASSET_PACK_HPP
\ No newline at end of file
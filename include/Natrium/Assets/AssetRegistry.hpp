@@ -1,53 +1,367 @@
 #if !defined(NA_ASSET_REGISTRY_HPP)
 #define NA_ASSET_REGISTRY_HPP
 
+#include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/JobSystem.hpp"
 #include "Natrium/Assets/Asset.hpp"
+#include "Natrium/Assets/AssetPack.hpp"
 #include "Natrium/Assets/ShaderAsset.hpp"
 #include "Natrium/Graphics/ShaderModule.hpp"
 
 namespace Na {
+	class GpuMesh;
+
+	struct ShaderSourceInfo {
+		std::string_view src_path;
+		ShaderStageBits stage;
+		std::string_view entry_point = "main";
+		ShaderPermutation permutation = {};
+	};
+
+	/// 
+	/// assets AssetRegistry converts into a faster format on the first load, e.g. models,
+	/// T::Load has to accept files with k_CacheExtension written by save
+	/// 
+	template<typename T>
+	concept CacheableAsset =
+		LoadableAsset<T> &&
+		requires(const T& asset, const std::filesystem::path& path)
+		{
+			{ T::k_CacheExtension } -> std::convertible_to<std::string_view>;
+			{ T::k_CacheVersion } -> std::convertible_to<u32>;
+			asset.save(path);
+		};
+
+	/// 
+	/// the result of AssetRegistry::load_asset_async, shared by every request for the same path,
+	/// get rethrows whatever the load threw
+	/// 
+	template<DerivedAsset T>
+	class AssetFuture {
+	public:
+		AssetFuture(void) = default;
+		inline AssetFuture(std::shared_future<AssetHandle<>> future) : m_Future(std::move(future)) {}
+
+		[[nodiscard]] inline bool ready(void) const { return m_Future.valid() && m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+		inline void wait(void) const { m_Future.wait(); }
+
+		// blocks until the load is done
+		[[nodiscard]] inline AssetHandle<T> get(void) const { return std::dynamic_pointer_cast<T>(m_Future.get()); }
+
+		[[nodiscard]] inline operator bool(void) const { return m_Future.valid(); }
+	private:
+		std::shared_future<AssetHandle<>> m_Future;
+	};
+
+	/// 
+	/// safe to use from any thread, except for destroy and the setters of the dirs
+	/// 
 	class AssetRegistry {
 	public:
+		// load_asset_async runs on JobSystem::Get
 		AssetRegistry(const std::filesystem::path& asset_dir, const std::filesystem::path& shader_output_dir);
 		inline ~AssetRegistry(void) { this->destroy(); }
 
 		void destroy(void);
 
-		inline void free_asset(const std::string_view& name) { m_Assets.erase(name); }
-		inline void free_all(void) { m_Assets.clear(); }
+		void free_asset(const std::string_view& name);
+		void free_all(void);
 
+		/// 
+		/// safe to call from any thread, concurrent loads of the same path (async ones included)
+		/// share one load
+		/// 
 		template<LoadableAsset T>
 		inline AssetHandle<T> load_asset(const std::string_view& path)
 		{
-			auto it = m_Assets.find(path);
-			if (it != m_Assets.end())
-				return std::dynamic_pointer_cast<T>(it->second);
+			if (AssetHandle<> asset = this->_find(path))
+				return std::dynamic_pointer_cast<T>(asset);
+
+			std::promise<AssetHandle<>> promise;
+			u64 load_id = 0;
+			if (std::optional<std::shared_future<AssetHandle<>>> loading = this->_begin_load(path, promise, load_id))
+				return std::dynamic_pointer_cast<T>(loading->get());
+
+			try
+			{
+				AssetHandle<> asset = this->_load<T>(path);
+				this->_insert(path, asset);
+				promise.set_value(asset);
+				this->_end_load(path, load_id);
+
+				return std::dynamic_pointer_cast<T>(asset);
+			} catch (...)
+			{
+				promise.set_exception(std::current_exception());
+				this->_end_load(path, load_id);
+				throw;
+			}
+		}
+
+		/// 
+		/// T::Load runs on a load thread, requests for a path that is already loading share
+		/// that load, on_loaded is called by process_loads on the thread calling it (e.g. to create
+		/// the Texture of an image), even if the asset was loaded already
+		/// 
+		template<LoadableAsset T>
+		inline AssetFuture<T> load_asset_async(const std::string_view& path, std::function<void(AssetHandle<T>)> on_loaded = nullptr)
+		{
+			std::function<void(const AssetHandle<>&)> callback;
+			if (on_loaded)
+				callback = [on_loaded = std::move(on_loaded)](const AssetHandle<>& asset) { on_loaded(std::dynamic_pointer_cast<T>(asset)); };
 
-			AssetHandle<T> asset = T::Load(m_AssetDir / path);
-			m_Assets[path] = asset;
-			return asset;
+			return AssetFuture<T>(this->_load_async(
+				path,
+				[](const AssetRegistry& registry, std::string_view asset_path) -> AssetHandle<> { return registry._load<T>(asset_path); },
+				std::move(callback)
+			));
 		}
 
+		/// 
+		/// runs the callbacks of finished async loads and trims the registry to its budget,
+		/// returns how many loads finished, failed loads are logged and skip their callbacks
+		/// 
+		/// call once per frame from the thread that should run the callbacks
+		/// 
+		u32 process_loads(void);
+
+		/// 
+		/// assets only the registry refers to are freed least recently loaded or looked up first
+		/// once the memory_usage of every asset exceeds the budget, k_U64Max (default) never evicts
+		/// 
+		inline void set_budget(u64 budget) { m_Budget = budget; }
+		[[nodiscard]] inline u64 budget(void) const { return m_Budget; }
+		[[nodiscard]] inline u64 memory_usage(void) const { return m_MemoryUsage; }
+
+		/// 
+		/// both return how many assets were freed, evict_unused ignores the budget
+		/// 
+		u64 trim(void);
+		u64 evict_unused(void);
+
+		[[nodiscard]] u64 pending_loads(void) const;
+
+		/// 
+		/// where CacheableAssets are converted to, keyed by their path, size and write time,
+		/// the shader output dir by default
+		/// 
+		inline void set_asset_cache_dir(const std::filesystem::path& cache_dir) { m_AssetCacheDir = cache_dir; }
+		[[nodiscard]] inline const std::filesystem::path& asset_cache_dir(void) const { return m_AssetCacheDir; }
+
+		/// 
+		/// compiled shaders are cached in the shader output dir, keyed by a hash of the source,
+		/// every file it includes and the compile options, so editing a shared include
+		/// rebuilds exactly the shaders depending on it
+		/// 
+		/// includes resolve against the asset dir and the added shader include dirs
+		/// safe to call from multiple threads
+		/// 
+		/// every permutation is a variant cached on its own, see ShaderVariants to keep them loaded
+		/// 
 		ShaderModule create_shader_module_from_src(
 			const std::string_view& src_path,
 			ShaderStageBits stage,
-			const std::string_view& entry_point = "main"
+			const std::string_view& entry_point = "main",
+			const ShaderPermutation& permutation = {}
 		) const;
 
+		/// 
+		/// compiles as up to thread_count jobs (0 uses every JobSystem worker and the caller),
+		/// the modules are in the order of infos
+		/// 
+		/// rethrows the first exception once every shader was processed
+		/// 
+		[[nodiscard]] std::vector<ShaderModule> create_shader_modules_from_src(const ShaderSourceInfo* infos, u64 count, u32 thread_count = 0) const;
+		[[nodiscard]] inline std::vector<ShaderModule> create_shader_modules_from_src(const std::initializer_list<ShaderSourceInfo>& infos, u32 thread_count = 0) const { return this->create_shader_modules_from_src(infos.begin(), infos.size(), thread_count); }
+
 		ShaderModule create_shader_module_from_str(
 			const std::string_view& name,
 			const std::string_view& src,
 			ShaderStageBits stage,
-			const std::string_view& entry_point = "main"
+			const std::string_view& entry_point = "main",
+			const ShaderPermutation& permutation = {}
 		) const;
 
+		/// 
+		/// from precompiled SPIR-V through load_asset, so a mounted pack of every .spv, e.g. the
+		/// shader output dir packed with NaPack, serves all of them from one mapping without copies
+		/// 
+		ShaderModule create_shader_module(
+			const std::string_view& spv_path,
+			ShaderStageBits stage,
+			const std::string_view& entry_point = "main"
+		);
+
+		/// 
+		/// the ModelAsset at path uploaded once, every call for the same path shares the GpuMesh,
+		/// it is kept next to the model like any other asset, so it is evicted and freed the same way,
+		/// free it before the VkContext is destroyed
+		/// 
+		/// without keep_model the model is never registered, so its vertices and indices are freed
+		/// after the upload, a model loaded before is uploaded as it is and stays registered
+		/// 
+		/// warning: uploads through VkContext::GetUploadManager, call it from the thread using that
+		/// 
+		AssetHandle<GpuMesh> load_mesh(const std::string_view& path, bool keep_model = true);
+		void free_mesh(const std::string_view& path);
+
+		/// 
+		/// load_asset looks BlobLoadableAssets up in the mounted packs first, the last mounted first,
+		/// by their path spelled as in the pack, e.g. "textures/grass.png", other assets and paths
+		/// no pack has are loaded from the asset dir, throws if path is not an AssetPack
+		/// 
+		/// safe to call while assets load on other threads
+		/// 
+		void mount_pack(const std::filesystem::path& path);
+
+		// warning: not synchronized with mount_pack
+		[[nodiscard]] inline const std::vector<AssetPack>& packs(void) const { return m_Packs; }
+
 		[[nodiscard]] inline std::filesystem::path& asset_dir(void) { return m_AssetDir; }
 		[[nodiscard]] inline const std::filesystem::path& asset_dir(void) const { return m_AssetDir; }
 		inline void set_asset_dir(const std::filesystem::path& asset_dir) { m_AssetDir = asset_dir; }
+
+		inline void add_shader_include_dir(const std::filesystem::path& include_dir) { m_ShaderIncludeDirs.push_back(include_dir); }
+		[[nodiscard]] inline const std::vector<std::filesystem::path>& shader_include_dirs(void) const { return m_ShaderIncludeDirs; }
+
+		/// 
+		/// the source itself and every file its last compile included, weakly canonical,
+		/// only the source if it was never compiled through the registry
+		/// 
+		[[nodiscard]] std::vector<std::filesystem::path> shader_dependencies(
+			const std::string_view& src_path,
+			const std::string_view& entry_point = "main",
+			const ShaderPermutation& permutation = {}
+		) const;
+	private:
+		// heterogeneous lookup, so finding a path does not allocate
+		struct KeyHash {
+			using is_transparent = void;
+			inline size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+		};
+
+		struct Entry {
+			AssetHandle<> asset;
+			u64 memory_usage = 0;
+			u64 last_use = 0;
+		};
+
+		struct Shard {
+			std::mutex mutex;
+			std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> assets; // owns its keys
+		};
+
+		// one per path while it loads, or while it has callbacks to run
+		struct PendingLoad {
+			u64 id = 0;
+			std::shared_future<AssetHandle<>> future;
+			std::vector<std::function<void(const AssetHandle<>&)>> callbacks;
+		};
+
+		template<LoadableAsset T>
+		inline AssetHandle<T> _load(std::string_view path) const
+		{
+			if constexpr (BlobLoadableAsset<T>)
+			{
+				if (std::optional<AssetBlob> blob = this->_read_from_packs(path))
+					return T::Load(*blob);
+			}
+
+			std::filesystem::path src_path = m_AssetDir / path;
+
+			if constexpr (CacheableAsset<T>)
+			{
+				if (src_path.extension() == T::k_CacheExtension)
+					return T::Load(src_path);
+
+				std::filesystem::path cache_path = this->_asset_cache_path(src_path, T::k_CacheExtension, T::k_CacheVersion);
+				if (cache_path.empty())
+					return T::Load(src_path);
+
+				// a corrupt or truncated cache is imported again and overwritten
+				if (std::filesystem::exists(cache_path))
+				{
+					try
+					{
+						return T::Load(cache_path);
+					} catch (const std::exception& e)
+					{
+						g_Logger.fmt(Warn, "Reimporting {}: {}", path, e.what());
+					}
+				}
+
+				AssetHandle<T> asset = T::Load(src_path);
+				this->_write_asset_cache(cache_path, [&asset](const std::filesystem::path& tmp_path) { asset->save(tmp_path); });
+				return asset;
+			} else
+			{
+				return T::Load(src_path);
+			}
+		}
+
+		[[nodiscard]] std::optional<AssetBlob> _read_from_packs(std::string_view path) const;
+
+		// empty if src_path does not exist, its load reports that
+		[[nodiscard]] std::filesystem::path _asset_cache_path(const std::filesystem::path& src_path, std::string_view extension, u32 version) const;
+
+		// saves to a temporary file first, so concurrent loads never read a partial file
+		void _write_asset_cache(const std::filesystem::path& cache_path, const std::function<void(const std::filesystem::path&)>& save) const;
+
+		[[nodiscard]] inline Shard& _shard(std::string_view path) { return m_Shards[KeyHash{}(path) % k_ShardCount]; }
+
+		[[nodiscard]] AssetHandle<> _find(std::string_view path);
+		void _insert(std::string_view path, const AssetHandle<>& asset);
+
+		// nullopt if the caller loads the asset, otherwise the future of the load to wait for
+		[[nodiscard]] std::optional<std::shared_future<AssetHandle<>>> _begin_load(std::string_view path, std::promise<AssetHandle<>>& promise, u64& load_id);
+		void _end_load(std::string_view path, u64 load_id);
+
+		[[nodiscard]] std::shared_future<AssetHandle<>> _load_async(
+			std::string_view path,
+			AssetHandle<> (*load)(const AssetRegistry& registry, std::string_view path),
+			std::function<void(const AssetHandle<>&)> callback
+		);
+
+		u64 _evict(u64 target_usage);
+
+		void _enqueue_load(std::function<void(void)> task);
+
+		// include dirs are searched in order, the asset dir last
+		[[nodiscard]] ShaderCompileOptions _shader_compile_options(const std::string_view& entry_point, const ShaderPermutation& permutation) const;
+
+		// source is the path relative to the asset dir, or the name of a shader without a file
+		ShaderModule _create_shader_module(
+			const ShaderString& shader,
+			const std::string_view& source,
+			ShaderStageBits stage,
+			const std::string_view& entry_point,
+			const ShaderPermutation& permutation
+		) const;
 	private:
-		std::unordered_map<std::string_view, AssetHandle<>> m_Assets;
+		static constexpr u32 k_ShardCount = 16;
+
+		// lookups from different threads mostly hit different locks
+		std::array<Shard, k_ShardCount> m_Shards;
+		std::atomic<u64> m_UseClock = 0;
+		std::atomic<u64> m_MemoryUsage = 0;
+		std::atomic<u64> m_Budget = k_U64Max;
+
+		// locked before any shard
+		std::unordered_map<std::string, PendingLoad, KeyHash, std::equal_to<>> m_PendingLoads;
+		mutable std::mutex m_PendingMutex;
+		u64 m_NextLoadID = 1;
+
+		// the async loads on the JobSystem, destroy skips the ones not started yet and waits for the rest
+		JobCounter m_LoadJobs;
+		std::atomic<bool> m_StopLoading = false;
+
+		std::vector<AssetPack> m_Packs;
+		mutable std::shared_mutex m_PacksMutex; // shared by the loads reading from m_Packs
+
 		std::filesystem::path m_AssetDir;
 		std::filesystem::path m_ShaderOutputDir;
+		std::filesystem::path m_AssetCacheDir;
+		std::vector<std::filesystem::path> m_ShaderIncludeDirs;
 	};
 } // namespace Na
 
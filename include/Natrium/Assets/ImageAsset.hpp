@@ -2,26 +2,54 @@
 #define NA_IMAGE_ASSET_HPP
 
 #include "Natrium/Assets/Asset.hpp"
+#include "Natrium/Core/MappedFile.hpp"
 
 namespace Na {
+	/// 
+	/// .ktx2 and .dds files keep their format and mip levels as stored, block compressed
+	/// payloads are never decoded, anything else is decoded to eR8G8B8A8Srgb with a single level
+	/// 
+	/// .ktx2 and .dds files stay memory mapped for the asset's lifetime and data points
+	/// into the mapping, so their levels are only ever copied into staging memory,
+	/// the same goes for blobs, whose owner is kept instead
+	/// 
 	class ImageAsset : public Asset {
 	public:
 		ImageAsset(void) = default;
-		inline ~ImageAsset(void) override { free(m_Data); }
+		inline ~ImageAsset(void) override { if (!m_Source) free((void*)m_Data); }
 
 		static AssetHandle<ImageAsset> Load(const std::filesystem::path& path);
+		static AssetHandle<ImageAsset> Load(const AssetBlob& blob);
 
-		[[nodiscard]] inline void* data(void) const { return m_Data; }
+		[[nodiscard]] inline const void* data(void) const { return m_Data; }
+
+		// of every level, which are not necessarily contiguous, see level_data
 		[[nodiscard]] inline u64 size(void) const { return m_Size; }
 
 		[[nodiscard]] inline int width(void) const { return m_Width; }
 		[[nodiscard]] inline int height(void) const { return m_Height; }
 
+		[[nodiscard]] inline vk::Format format(void) const { return m_Format; }
+
+		[[nodiscard]] inline u32 mip_levels(void) const { return (u32)m_LevelSizes.size(); }
+		[[nodiscard]] inline const std::vector<u64>& level_sizes(void) const { return m_LevelSizes; }
+		[[nodiscard]] inline const void* level_data(u32 level) const { return (const Byte*)m_Data + m_LevelOffsets[level]; }
+
 		[[nodiscard]] inline operator bool(void) const override { return m_Data; };
+		[[nodiscard]] inline u64 memory_usage(void) const override { return m_Size; }
 	private:
-		void* m_Data;
-		u64 m_Size;
-		int m_Width, m_Height;
+		// source keeps file alive
+		static AssetHandle<ImageAsset> _load(const std::filesystem::path& path, std::span<const Byte> file, std::shared_ptr<const void> source);
+	private:
+		const void* m_Data = nullptr; // malloc'd unless it points into m_Source
+		u64 m_Size = 0;
+		int m_Width = 0, m_Height = 0;
+
+		vk::Format m_Format = vk::Format::eR8G8B8A8Srgb;
+		std::vector<u64> m_LevelSizes;
+		std::vector<u64> m_LevelOffsets; // from m_Data
+
+		std::shared_ptr<const void> m_Source; // the mapped file or blob of containers
 	};
 	using Image = ImageAsset;
 } // namespace Na
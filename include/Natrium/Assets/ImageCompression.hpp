@@ -0,0 +1,38 @@
+#if !defined(NA_IMAGE_COMPRESSION_HPP)
+#define NA_IMAGE_COMPRESSION_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// block compression of decoded eR8G8B8A8Srgb images, meant for content loaded at runtime,
+	/// offline encoders reach a better quality, so prefer .ktx2 / .dds for shipped textures
+	/// 
+	/// BC1 stores rgb in 4 bits per texel and ignores alpha, BC3 adds 4 bits of alpha
+	/// 
+	enum class ImageCompression : u8 {
+		None = 0,
+		BC1,
+		BC3
+	};
+
+	// the srgb block format, eR8G8B8A8Srgb for None
+	[[nodiscard]] vk::Format CompressedFormat(ImageCompression compression);
+
+	// of one level, width and height are rounded up to whole 4x4 blocks
+	[[nodiscard]] u64 CompressedSize(ImageCompression compression, u32 width, u32 height);
+
+	/// 
+	/// encodes width * height tightly packed rgba8 texels into CompressedSize bytes at dst,
+	/// endpoints are fitted to the bounds of each block, partial blocks repeat their edge texels
+	/// 
+	void CompressImage(ImageCompression compression, const u8* rgba, u32 width, u32 height, void* dst);
+
+	/// 
+	/// writes the next mip level, max(width / 2, 1) * max(height / 2, 1) texels, with a box filter,
+	/// averaged in the stored (srgb) space
+	/// 
+	void DownsampleImage(const u8* rgba, u32 width, u32 height, u8* dst);
+} // namespace Na
+
+#endif // NA_IMAGE_COMPRESSION_HPP
\ No newline at end of file
@@ -0,0 +1,68 @@
+#if !defined(NA_MESH_OPTIMIZER_HPP)
+#define NA_MESH_OPTIMIZER_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	struct MeshOptimizeSettings {
+		bool vertex_cache = true;
+		bool overdraw = true;
+		float overdraw_threshold = 1.05f; // how much the cache miss ratio may grow in exchange for less overdraw
+		bool vertex_fetch = true;
+		bool compact_indices = true; // 16 bit indices if every vertex fits
+
+		// levels of detail including the full mesh, each one aims for lod_reduction of the previous one's triangles
+		u32 lod_count = 4;
+		float lod_reduction = 0.5f;
+		float lod_max_error = 0.02f; // relative to the largest extent of the mesh
+
+		bool quantize = false; // see ModelAsset::quantize
+	};
+
+	/// 
+	/// reorders the triangles for the post transform vertex cache (Forsyth's linear speed algorithm),
+	/// the indices keep referencing the same vertices
+	/// 
+	void OptimizeVertexCache(u32* indices, u64 index_count, u32 vertex_count);
+
+	/// 
+	/// splits cache optimized triangles into clusters where the cache starts over and draws clusters
+	/// facing away from the mesh center first, so they tend to occlude the rest
+	/// positions are read every position_stride bytes, e.g. sizeof(Vertex)
+	/// 
+	void OptimizeOverdraw(
+		u32* indices, u64 index_count,
+		const glm::vec3* positions, u64 position_stride, u32 vertex_count,
+		float threshold = 1.05f
+	);
+
+	/// 
+	/// renumbers the vertices in the order the indices first use them and moves them accordingly,
+	/// unreferenced vertices are dropped, returns how many are left
+	/// 
+	u32 OptimizeVertexFetch(void* vertices, u64 vertex_size, u32 vertex_count, u32* indices, u64 index_count);
+
+	/// 
+	/// collapses edges by their quadric error until target_index_count is reached or the next collapse
+	/// would move the surface further than target_error (relative to the largest extent of the mesh),
+	/// writes up to index_count indices into destination and returns how many
+	/// 
+	/// no vertices are created or moved, so every result indexes the same vertices as the input,
+	/// vertices on open edges (e.g. uv seams) are kept in place to avoid cracks
+	/// result_error receives the largest error in the units of the positions
+	/// 
+	u64 SimplifyMesh(
+		u32* destination,
+		const u32* indices, u64 index_count,
+		const glm::vec3* positions, u64 position_stride, u32 vertex_count,
+		u64 target_index_count, float target_error,
+		float* result_error = nullptr
+	);
+
+	/// 
+	/// transformed vertices per triangle with a FIFO cache of cache_size, 0.5 is about the best possible
+	/// 
+	[[nodiscard]] float AverageCacheMissRatio(const u32* indices, u64 index_count, u32 vertex_count, u32 cache_size = 16);
+} // namespace Na
+
+#endif // NA_MESH_OPTIMIZER_HPP
\ No newline at end of file
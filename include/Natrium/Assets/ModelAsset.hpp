@@ -2,6 +2,8 @@
 #define NA_MODEL_ASSET_HPP
 
 #include "Natrium/Assets/Asset.hpp"
+#include "Natrium/Assets/MeshOptimizer.hpp"
+#include "Natrium/Graphics/Culling.hpp"
 
 namespace Na {
 	struct Vertex {
@@ -11,29 +13,158 @@ namespace Na {
 		[[nodiscard]] inline bool operator==(const Vertex& other) const { return this->position == other.position && this->uv_coord == other.uv_coord; }
 	};
 
+	/// 
+	/// 16 bytes instead of the 20 of Vertex and with a normal, built by ModelAsset::quantize,
+	/// the matching attribute binding is
+	///   { 0, AttributeInputRate::Vertex, {
+	///       { 0, ShaderAttributeType::Short4Unorm }, // position inside the bounds, see ModelAsset::dequantization_matrix
+	///       { 1, ShaderAttributeType::Half2 },
+	///       { 2, ShaderAttributeType::Byte4Snorm }
+	///   } }
+	/// 
+	struct QuantizedVertex {
+		u16 position[4];
+		u16 uv_coord[2]; // half floats, uvs may leave [0, 1]
+		i8 normal[4];
+	};
+
+	/// 
+	/// mixes every byte of the vertex, so nearby positions do not collide like XORed component hashes
+	/// 
+	[[nodiscard]] inline u64 HashVertex(const Vertex& vertex)
+	{
+		u32 words[sizeof(Vertex) / sizeof(u32)];
+		memcpy(words, &vertex, sizeof(Vertex));
+
+		u64 hash = 0x9E3779B97F4A7C15ull;
+		for (u32 word : words)
+		{
+			hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// 
+	/// a range of ModelAsset::indices, drawn with the same vertex and index buffers as the full mesh
+	/// 
+	struct MeshLod {
+		u32 first_index;
+		u32 index_count;
+		float error; // how far the surface moved at most, in model units
+	};
+
+	/// 
+	/// loads .obj files and the binary .namesh format written by save, which holds the
+	/// deduplicated vertices and indices as they are in memory, AssetRegistry caches
+	/// imported models in it
+	/// 
+	/// imported models are optimized with settings, .namesh files are loaded as saved,
+	/// the levels of detail are simplified from the full mesh and appended to its indices
+	/// 
+	/// AssetRegistry::load_mesh uploads a model once and shares its GpuMesh
+	/// 
 	class ModelAsset : public Asset {
 	public:
+		static constexpr std::string_view k_CacheExtension = ".namesh";
+		static constexpr u32 k_CacheVersion = 5;
+
 		ModelAsset(void) = default;
 		~ModelAsset(void) = default;
 
-		static AssetHandle<ModelAsset> Load(const std::filesystem::path& path);
+		static AssetHandle<ModelAsset> Load(const std::filesystem::path& path, const MeshOptimizeSettings& settings = {});
+
+		// as .namesh, 16 bit index types are saved as 16 bit indices
+		void save(const std::filesystem::path& path) const;
+
+		/// 
+		/// generates the levels of detail if there are none yet, then reorders the triangles
+		/// of each level and the vertices for the GPU, see MeshOptimizer.hpp,
+		/// compact_indices only changes index_type, the indices stay 32 bit in memory
+		/// 
+		void optimize(const MeshOptimizeSettings& settings = {});
+
+		/// 
+		/// builds quantized_vertices from vertices, positions relative to the bounds of the mesh,
+		/// normals are averaged over the triangles of the full mesh, vertices stay as they are
+		/// 
+		void quantize(void);
 
 		[[nodiscard]] inline u64 vertex_data_size(void) const { return m_Vertices.size() * sizeof(Vertex); }
 		[[nodiscard]] inline u64 index_data_size(void) const { return m_Indices.size() * sizeof(u32); }
 
 		[[nodiscard]] inline u32 vertex_count(void) const { return (u32)m_Vertices.size(); }
-		[[nodiscard]] inline u32 index_count(void) const { return (u32)m_Indices.size(); }
+
+		/// 
+		/// the indices of the full mesh, the levels of detail follow them in indices,
+		/// total_index_count spans every level, e.g. for the IndexBuffer
+		/// 
+		[[nodiscard]] inline u32 index_count(void) const { return m_Lods.empty() ? this->total_index_count() : m_Lods[0].index_count; }
+		[[nodiscard]] inline u32 total_index_count(void) const { return (u32)m_Indices.size(); }
 
 		[[nodiscard]] inline Na::ArrayList<Vertex>& vertices(void) { return m_Vertices; }
 		[[nodiscard]] inline const Na::ArrayList<Vertex>& vertices(void) const { return m_Vertices; }
 
+		// empty until quantize, same order and count as vertices
+		[[nodiscard]] inline const Na::ArrayList<QuantizedVertex>& quantized_vertices(void) const { return m_QuantizedVertices; }
+		[[nodiscard]] inline u64 quantized_vertex_data_size(void) const { return m_QuantizedVertices.size() * sizeof(QuantizedVertex); }
+
+		// maps quantized positions back into model space, apply it before the model matrix
+		[[nodiscard]] inline glm::mat4 dequantization_matrix(void) const { return glm::scale(glm::translate(glm::mat4(1.0f), m_QuantizationOffset), m_QuantizationScale); }
+
 		[[nodiscard]] inline Na::ArrayList<u32>& indices(void) { return m_Indices; }
 		[[nodiscard]] inline const Na::ArrayList<u32>& indices(void) const { return m_Indices; }
 
+		// in model space, computed at load, transform them with the model matrix for culling
+		[[nodiscard]] inline const BoundingBox& bounds(void) const { return m_Bounds; }
+		[[nodiscard]] inline const BoundingSphere& bounding_sphere(void) const { return m_BoundingSphere; }
+
+		// what IndexBuffers of the model should use, eUint16 once optimize found every vertex fits
+		[[nodiscard]] inline vk::IndexType index_type(void) const { return m_IndexType; }
+
+		// the full mesh is level 0, without generated levels it spans every index
+		[[nodiscard]] inline u32 lod_count(void) const { return std::max((u32)m_Lods.size(), 1u); }
+		[[nodiscard]] inline MeshLod lod(u32 level) const { return m_Lods.empty() ? MeshLod{ 0, this->total_index_count(), 0.0f } : m_Lods[level]; }
+
+		/// 
+		/// the coarsest level whose error stays below max_pixel_error on screen at distance,
+		/// projection_scale is viewport_height / (2 * tan(fov_y / 2)) times the scale the model is drawn at
+		/// 
+		[[nodiscard]] u32 lod_for_screen_error(float distance, float projection_scale, float max_pixel_error = 1.0f) const;
+
+		/// 
+		/// level i closer than thresholds[i], past the last threshold the level after it,
+		/// both clamped to the coarsest level
+		/// 
+		[[nodiscard]] u32 lod_for_distance(float distance, std::span<const float> thresholds) const;
+
 		[[nodiscard]] inline operator bool(void) const override { return !m_Vertices.empty() && !m_Indices.empty(); };
+		[[nodiscard]] inline u64 memory_usage(void) const override { return this->vertex_data_size() + this->quantized_vertex_data_size() + this->index_data_size() + m_Lods.size() * sizeof(MeshLod); }
+	private:
+		// the .namesh format written by save
+		void _load_mesh(const std::filesystem::path& path);
+
+		void _generate_lods(const MeshOptimizeSettings& settings);
+
+		// the sphere is centered on the box, its radius reaches the furthest vertex
+		void _compute_bounds(void);
 	private:
 		Na::ArrayList<Vertex> m_Vertices;
 		Na::ArrayList<u32> m_Indices;
+		vk::IndexType m_IndexType = vk::IndexType::eUint32;
+
+		std::vector<MeshLod> m_Lods;
+
+		BoundingBox m_Bounds;
+		BoundingSphere m_BoundingSphere;
+
+		Na::ArrayList<QuantizedVertex> m_QuantizedVertices;
+		glm::vec3 m_QuantizationOffset{ 0.0f };
+		glm::vec3 m_QuantizationScale{ 1.0f };
 	};
 	using Model = ModelAsset;
 }
@@ -42,10 +173,7 @@ namespace std {
 	template<> struct hash<Na::Vertex> {
 		size_t operator()(Na::Vertex const& vertex) const
 		{
-			return ((
-				hash<glm::vec3>()(vertex.position) ^
-				(hash<glm::vec2>()(vertex.uv_coord) << 1)
-			));
+			return (size_t)Na::HashVertex(vertex);
 		}
 	};
 } // namespace std
@@ -8,10 +8,62 @@ namespace Na {
 		None = 0,
 		Vertex   = (u32)vk::ShaderStageFlagBits::eVertex,
 		Fragment = (u32)vk::ShaderStageFlagBits::eFragment,
+		Compute  = (u32)vk::ShaderStageFlagBits::eCompute,
 
 		All      = (u32)vk::ShaderStageFlagBits::eAll
 	};
 
+	struct ShaderDefine {
+		std::string name;
+		std::string value = "1";
+
+		[[nodiscard]] bool operator==(const ShaderDefine& other) const = default;
+	};
+
+	/// 
+	/// the macros one variant of a shader is compiled with, kept sorted by name
+	/// so the same toggles given in any order are the same variant
+	/// 
+	/// e.g. ShaderPermutation().toggle("SHADOWS", cast_shadows).define("LIGHT_COUNT", "4"),
+	/// toggles that are off are left undefined, so #ifdef and #if both see them as off
+	/// 
+	class ShaderPermutation {
+	public:
+		ShaderPermutation(void) = default;
+		ShaderPermutation(const std::initializer_list<ShaderDefine>& defines);
+
+		// replaces the value if name is already defined
+		ShaderPermutation& define(const std::string_view& name, const std::string_view& value = "1");
+		ShaderPermutation& undefine(const std::string_view& name);
+		inline ShaderPermutation& toggle(const std::string_view& name, bool enabled) { return enabled ? this->define(name) : this->undefine(name); }
+
+		/// 
+		/// FNV-1a over the defines, stable across runs, names the variant's cache files
+		/// 0 for the permutation without defines
+		/// 
+		[[nodiscard]] u64 key(void) const;
+
+		[[nodiscard]] inline const std::vector<ShaderDefine>& defines(void) const { return m_Defines; }
+		[[nodiscard]] inline bool empty(void) const { return m_Defines.empty(); }
+
+		[[nodiscard]] bool operator==(const ShaderPermutation& other) const = default;
+	private:
+		std::vector<ShaderDefine> m_Defines;
+	};
+
+	/// 
+	/// #include "..." resolves against the including file's directory first, then include_dirs,
+	/// #include <...> only against include_dirs
+	/// 
+	struct ShaderCompileOptions {
+		std::string_view entry_point = "main";
+		std::vector<std::filesystem::path> include_dirs;
+		bool optimize = k_BuildConfig != BuildConfig::Debug;
+		ShaderPermutation permutation;
+
+		std::vector<std::filesystem::path>* dependencies = nullptr; // if set, receives every included file
+	};
+
 	class ShaderString : public Asset {
 	public:
 		ShaderString(const std::string& data, const std::string& name) : m_Data(data), m_Name(name) {};
@@ -19,30 +71,66 @@ namespace Na {
 		ShaderString(const std::filesystem::path& path);
 
 		static AssetHandle<ShaderString> Load(const std::filesystem::path& path) { return std::make_shared<ShaderString>(path);  }
+		static AssetHandle<ShaderString> Load(const AssetBlob& blob)
+		{
+			return std::make_shared<ShaderString>(std::string_view((const char*)blob.bytes.data(), blob.bytes.size()), blob.path.filename().string());
+		}
 
-		[[nodiscard]] ArrayVector<u32> compile(const std::string_view& entry_point = "main") const;
+		/// 
+		/// safe to call from multiple threads, they share one compiler
+		/// 
+		[[nodiscard]] ArrayVector<u32> compile(const ShaderCompileOptions& options) const;
+		[[nodiscard]] inline ArrayVector<u32> compile(const std::string_view& entry_point = "main") const { return this->compile(ShaderCompileOptions{ .entry_point = entry_point }); }
 
 		[[nodiscard]] inline const std::string& data(void) const { return m_Data; }
+		[[nodiscard]] inline const std::string& name(void) const { return m_Name; }
+
+		// empty unless loaded from a file
+		[[nodiscard]] inline const std::filesystem::path& path(void) const { return m_Path; }
 
 		[[nodiscard]] inline operator bool(void) const override { return !m_Data.empty(); };
+		[[nodiscard]] inline u64 memory_usage(void) const override { return m_Data.size(); }
 	private:
 		std::string m_Data;
 		std::string m_Name;
+		std::filesystem::path m_Path;
 	};
 
+	/// 
+	/// the words either belong to the binary or are viewed in place, e.g. in a mapped
+	/// .spv file or an AssetPack, so ShaderModule reads them without any copy
+	/// 
 	class ShaderBinary : public Asset {
 	public:
-		inline ShaderBinary(const ArrayVector<u32>& data) : m_Data(data) {}
+		inline ShaderBinary(const ArrayVector<u32>& data) : m_Data(data), m_Words(m_Data.ptr(), m_Data.size()) {}
+		inline ShaderBinary(ArrayVector<u32>&& data) : m_Data(std::move(data)), m_Words(m_Data.ptr(), m_Data.size()) {}
 
+		// source keeps words alive
+		inline ShaderBinary(std::span<const u32> words, std::shared_ptr<const void> source) : m_Words(words), m_Source(std::move(source)) {}
+
+		ShaderBinary(const ShaderBinary& other) = delete;
+		ShaderBinary& operator=(const ShaderBinary& other) = delete;
+
+		/// 
+		/// both view the words in place if they are aligned and whole, which
+		/// compiled modules always are, the rest is copied and padded
+		/// 
 		static AssetHandle<ShaderBinary> Load(const std::filesystem::path& path);
+		static AssetHandle<ShaderBinary> Load(const AssetBlob& blob);
 
-		[[nodiscard]] inline const ArrayVector<u32>& data(void) const { return m_Data; }
-		[[nodiscard]] inline u64 size(void) const { return m_Data.size() * sizeof(u32); }
-		[[nodiscard]] inline const u32* ptr(void) const { return m_Data.ptr(); }
+		[[nodiscard]] inline std::span<const u32> data(void) const { return m_Words; }
+		[[nodiscard]] inline u64 size(void) const { return m_Words.size_bytes(); }
+		[[nodiscard]] inline const u32* ptr(void) const { return m_Words.data(); }
 
-		[[nodiscard]] inline operator bool(void) const override { return !m_Data.empty(); };
+		// the words are viewed, not owned
+		[[nodiscard]] inline bool in_place(void) const { return (bool)m_Source; }
+
+		[[nodiscard]] inline operator bool(void) const override { return !m_Words.empty(); };
+		[[nodiscard]] inline u64 memory_usage(void) const override { return m_Data.size() * sizeof(u32); }
 	private:
-		ArrayVector<u32> m_Data;
+		ArrayVector<u32> m_Data; // empty when viewing
+		std::span<const u32> m_Words;
+		std::shared_ptr<const void> m_Source;
 	};
 }
 
@@ -0,0 +1,111 @@
+#if !defined(NA_ARENA_HPP)
+#define NA_ARENA_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// a linear allocator, allocations bump a cursor through heap blocks and are
+	/// only released all at once by reset, which keeps the memory for the next round
+	/// 
+	/// if a round needed more than one block, reset replaces them with a single block
+	/// of their combined size, so a steady workload stops allocating after the first frames
+	/// 
+	/// warning: not thread safe, destructors of objects in the arena are never called
+	/// 
+	class Arena {
+	public:
+		static constexpr u64 k_DefaultBlockSize = 64 * 1024;
+	public:
+		Arena(void) = default;
+		inline Arena(u64 block_size) : m_BlockSize(block_size) {}
+		inline ~Arena(void) { this->destroy(); }
+		void destroy(void);
+
+		Arena(const Arena& other) = delete;
+		Arena& operator=(const Arena& other) = delete;
+
+		Arena(Arena&& other);
+		Arena& operator=(Arena&& other);
+
+		[[nodiscard]] void* allocate(u64 size, u64 alignment = alignof(std::max_align_t));
+
+		/// 
+		/// grows or shrinks the latest allocation in place if there is room,
+		/// otherwise copies old_size bytes into a new allocation
+		/// 
+		[[nodiscard]] void* reallocate(void* ptr, u64 old_size, u64 new_size, u64 alignment = alignof(std::max_align_t));
+
+		template<typename T, typename... t_Args>
+		[[nodiscard]] inline T* create(t_Args&&... __args)
+		{
+			return new (this->allocate(sizeof(T), alignof(T))) T(std::forward<t_Args>(__args)...);
+		}
+
+		// everything allocated so far is invalidated
+		void reset(void);
+
+		// bytes handed out since the last reset
+		[[nodiscard]] inline u64 used(void) const { return m_Used; }
+		[[nodiscard]] inline u64 capacity(void) const { return m_Capacity; }
+
+		// the most bytes used by one round since construction
+		[[nodiscard]] inline u64 peak(void) const { return m_Peak; }
+
+		/// 
+		/// an arena per thread, reset lazily the first time it is used after NextFrame,
+		/// so its allocations are valid until the next frame begins
+		/// 
+		[[nodiscard]] static Arena& Thread(void);
+
+		// called by Renderer::begin_frame
+		static void NextFrame(void);
+	private:
+		struct Block {
+			Block* next;
+			u64 size;
+		};
+
+		void _allocate_block(u64 min_size);
+	private:
+		Block* m_Blocks = nullptr; // the current block first
+		Byte* m_Cursor = nullptr;
+		Byte* m_End = nullptr;
+		Byte* m_Last = nullptr; // the latest allocation, for reallocate
+
+		u64 m_BlockSize = k_DefaultBlockSize;
+		u64 m_Capacity = 0;
+		u64 m_Used = 0;
+		u64 m_Peak = 0;
+	};
+
+	/// 
+	/// a container allocator on top of an Arena, see Allocator.hpp,
+	/// deallocations are no-ops, the memory returns with Arena::reset
+	/// 
+	/// default constructed it allocates from the constructing thread's Arena::Thread
+	/// 
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		inline ArenaAllocator(void) : m_Arena(&Arena::Thread()) {}
+		inline ArenaAllocator(Arena& arena) : m_Arena(&arena) {}
+
+		[[nodiscard]] inline T* allocate(u64 count = 1) { return (T*)m_Arena->allocate(count * sizeof(T), alignof(T)); }
+
+		[[nodiscard]] inline T* reallocate(T* buffer, u64 old_count, u64 new_count)
+		{
+			return (T*)m_Arena->reallocate(buffer, old_count * sizeof(T), new_count * sizeof(T), alignof(T));
+		}
+
+		inline void deallocate(T* buffer, u64 count = 1) { (void)buffer; (void)count; }
+
+		[[nodiscard]] inline Arena& arena(void) const { return *m_Arena; }
+
+		[[nodiscard]] inline bool operator==(const ArenaAllocator& other) const { return m_Arena == other.m_Arena; }
+	private:
+		Arena* m_Arena;
+	};
+} // namespace Na
+
+#endif // NA_ARENA_HPP
\ No newline at end of file
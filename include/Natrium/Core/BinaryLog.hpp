@@ -0,0 +1,172 @@
+#if !defined(NA_BINARY_LOG_HPP)
+#define NA_BINARY_LOG_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Core/Logger.hpp"
+
+/// 
+/// logs a compact binary record if a BinaryLog is open, in every configuration including dist,
+/// format is a fmt string literal, it is only formatted by BinaryLog::Decode
+/// 
+/// arguments may be integers, enums, floats, bools, chars, strings (cut at 1 KiB) and pointers
+/// 
+#define NA_BINARY_LOG(level, format, ...)\
+	do {\
+		if constexpr ((level) >= ::Na::k_LogMinLevel)\
+		{\
+			static const ::Na::BinaryLogSite x_BinaryLogSite{ (level), format, __FILE__, __LINE__ };\
+			::Na::BinaryLog::Write(x_BinaryLogSite __VA_OPT__(,) __VA_ARGS__);\
+		}\
+	} while (0)
+
+namespace Na {
+	// a call site, registered once, records only carry its id
+	struct BinaryLogSite {
+		LogLevel level;
+		const char* format;
+		const char* file;
+		u32 line;
+		u32 id;
+
+		BinaryLogSite(LogLevel level, const char* format, const char* file, u32 line);
+	};
+
+	/// 
+	/// writes records into a memory mapped file, so they survive a crash of the process:
+	/// a ring of 64 KiB blocks, threads reserve space with one atomic add and never lock,
+	/// once the ring is full the oldest blocks are overwritten
+	/// 
+	/// a record is the site id, the raw arguments, a thread id and a TSC (or steady clock) timestamp,
+	/// the format strings are stored once per site in a table at the start of the file
+	/// 
+	class BinaryLog {
+	public:
+		static constexpr u64 k_BlockSize = 64 * 1024;
+		static constexpr u64 k_DefaultCapacity = 64 * 1024 * 1024;
+		static constexpr u64 k_SiteTableSize = 1024 * 1024;
+		static constexpr u64 k_MaxStringSize = 1024;
+
+		// 0 is the padding at the end of a record
+		enum class ArgType : u8 {
+			I64 = 1, U64, F64, Bool, Char, Str, Ptr
+		};
+
+		struct RecordHeader {
+			u32 size; // bytes, including the header, 8 byte aligned
+			u32 site; // k_U32Max for padding
+			u32 sequence; // of the block, catches records left over from an earlier round of the ring
+			u32 thread;
+			u64 ticks;
+		};
+	public:
+		// capacity is rounded up to whole blocks, throws if the file can not be created
+		static void Open(const std::filesystem::path& path, u64 capacity = k_DefaultCapacity);
+		static void Close(void);
+		[[nodiscard]] static bool IsOpen(void);
+
+		template<typename... t_Args>
+		static void Write(const BinaryLogSite& site, const t_Args&... args)
+		{
+			u32 size = (u32)sizeof(RecordHeader);
+			((size += _ArgSize(args)), ...);
+			size = (size + 7) & ~7u;
+
+			RecordHeader* header = _Reserve(site.id, size);
+			if (!header)
+				return;
+
+			Byte* ptr = (Byte*)(header + 1);
+			(_WriteArg(ptr, args), ...);
+
+			_Commit(header, size);
+		}
+
+		/// 
+		/// turns a log file back into text, one line per record, oldest first,
+		/// throws if it is not a binary log
+		/// 
+		static void Decode(const std::filesystem::path& path, std::ostream& out);
+
+		static u32 RegisterSite(BinaryLogSite& site);
+	private:
+		/// 
+		/// fills everything but the size, which stays 0 until _Commit, nullptr if no log is open,
+		/// Close waits for every reservation to be committed before it unmaps the file
+		/// 
+		static RecordHeader* _Reserve(u32 site, u32 size);
+
+		// stores the size last, an interrupted record reads as the end of its block
+		static void _Commit(RecordHeader* header, u32 size);
+
+		template<typename T>
+		static constexpr ArgType _ArgType(void)
+		{
+			using U = std::remove_cvref_t<T>;
+			if constexpr (std::is_same_v<U, bool>)
+				return ArgType::Bool;
+			else if constexpr (std::is_same_v<U, char>)
+				return ArgType::Char;
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				return ArgType::Str;
+			else if constexpr (std::is_enum_v<U>)
+				return _ArgType<std::underlying_type_t<U>>();
+			else if constexpr (std::is_integral_v<U>)
+				return std::is_signed_v<U> ? ArgType::I64 : ArgType::U64;
+			else if constexpr (std::is_floating_point_v<U>)
+				return ArgType::F64;
+			else if constexpr (std::is_pointer_v<U>)
+				return ArgType::Ptr;
+			else
+				static_assert(!sizeof(T), "NA_BINARY_LOG only takes integers, enums, floats, bools, chars, strings and pointers!");
+		}
+
+		template<typename T>
+		static inline u32 _ArgSize(const T& arg)
+		{
+			constexpr ArgType type = _ArgType<T>();
+			if constexpr (type == ArgType::Str)
+				return 1 + sizeof(u16) + (u32)std::min<u64>(std::string_view(arg).size(), k_MaxStringSize);
+			else if constexpr (type == ArgType::Bool || type == ArgType::Char)
+				return 2;
+			else
+				return 1 + 8;
+		}
+
+		template<typename T>
+		static inline void _WriteArg(Byte*& ptr, const T& arg)
+		{
+			constexpr ArgType type = _ArgType<T>();
+			*ptr++ = (Byte)type;
+
+			if constexpr (type == ArgType::Str)
+			{
+				std::string_view str(arg);
+				u16 size = (u16)std::min<u64>(str.size(), k_MaxStringSize);
+				memcpy(ptr, &size, sizeof(u16));
+				memcpy(ptr + sizeof(u16), str.data(), size);
+				ptr += sizeof(u16) + size;
+			} else if constexpr (type == ArgType::Bool || type == ArgType::Char)
+			{
+				*ptr++ = (Byte)arg;
+			} else
+			{
+				u64 bits;
+				if constexpr (type == ArgType::F64)
+				{
+					double value = (double)arg;
+					memcpy(&bits, &value, sizeof(u64));
+				} else if constexpr (type == ArgType::Ptr)
+				{
+					bits = (u64)(uintptr_t)arg;
+				} else
+				{
+					bits = (u64)(i64)arg;
+				}
+				memcpy(ptr, &bits, sizeof(u64));
+				ptr += sizeof(u64);
+			}
+		}
+	};
+} // namespace Na
+
+#endif // NA_BINARY_LOG_HPP
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define NA_CONTEXT_HPP
 
 #include "Natrium/Core.hpp"
+#include "Natrium/Core/ContextSettings.hpp"
 #include "Natrium/Core/Logger.hpp"
 #include "Natrium/Core/Event.hpp"
+#include "Natrium/Core/JobSystem.hpp"
 #include "Natrium/Graphics/VkContext.hpp"
 
 namespace Na {
@@ -17,7 +19,8 @@ namespace Na {
 		Context(Context&& other);
 		Context& operator=(Context&& other);
 
-		static Context Initialize(void);
+		// see ContextSettings and VkContext::Initialize
+		static Context Initialize(const ContextSettings& settings = {});
 		static void Shutdown(void);
 
 		static EventQueue& GetEventQueue(void) { return s_Context->m_EventQueue; }
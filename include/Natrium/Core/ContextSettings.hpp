@@ -0,0 +1,17 @@
+#if !defined(NA_CONTEXT_SETTINGS_HPP)
+#define NA_CONTEXT_SETTINGS_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	struct ContextSettings {
+		// skips glfw, e.g. for rendering on machines without a display
+		bool headless = false;
+
+		// creates VkContext::GetBindlessTable if the device has DeviceFeatures::descriptor_indexing,
+		// without it Textures and StorageBuffers are never registered and bindless pipelines fail
+		bool bindless = false;
+	};
+} // namespace Na
+
+#endif // NA_CONTEXT_SETTINGS_HPP
\ No newline at end of file
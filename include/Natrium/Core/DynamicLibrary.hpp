@@ -19,16 +19,27 @@ namespace Na {
 		void load(const std::string_view& name);
 		void unload(void);
 
+		/// 
+		/// loads the file at path as it is, e.g. a copy of a library made to reload it,
+		/// check operator bool for failure
+		/// 
+		void load_from(const std::filesystem::path& path);
+
+		// where load looks for name: next to the executable, with the platform's prefix and extension
+		[[nodiscard]] static std::filesystem::path PathOf(const std::string_view& name);
+
 		void* fn(const char* name) const;
 		template<typename FnT>
 		inline FnT fn(const char* name) const { return (FnT)this->fn(name); }
 
 		inline operator bool(void) const { return m_Handle; }
 		inline const std::string_view& name(void) const { return m_Name; }
+		inline const std::filesystem::path& path(void) const { return m_Path; }
 		inline void* handle(void) { return m_Handle; }
 	private:
 		void* m_Handle = nullptr;
 		std::string_view m_Name;
+		std::filesystem::path m_Path;
 	};
 } // namespace Na
 
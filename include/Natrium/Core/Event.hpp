@@ -9,6 +9,7 @@
 						Na::EventType type = Na::EventType::x;\
 						bool handled = false;\
 						Na::Window* window;\
+						double timestamp;\
 					 }
 
 namespace Na {
@@ -26,6 +27,16 @@ namespace Na {
 		GamepadButtonPressed, GamepadButtonReleased, GamepadAxisMoved
 	};
 
+	inline constexpr u64 k_EventTypeCount = (u64)EventType::GamepadAxisMoved + 1;
+
+	// a bit per EventType
+	using EventTypeMask = u32;
+
+	template<typename... t_Types>
+	[[nodiscard]] inline constexpr EventTypeMask EventTypes(t_Types... types) { return ((EventTypeMask(1) << (u8)types) | ... | 0); }
+
+	inline constexpr EventTypeMask k_AllEventTypes = ((EventTypeMask(1) << k_EventTypeCount) - 1) & ~EventTypes(EventType::None);
+
 	struct Event_KeyPressed {
 		NA_EVENT_BASE(KeyPressed);
 		Key key;
@@ -128,6 +139,7 @@ namespace Na {
 			EventType type;
 			bool handled;
 			Window* window;
+			double timestamp; // seconds on the glfwGetTime clock, when the platform reported it
 			u32 padding1, padding2;
 		};
 
@@ -159,6 +171,25 @@ namespace Na {
 	};
 
 	using EventQueue = ArrayList<Event>;
+
+	/// 
+	/// how PollEvents thins out high frequency input before it reaches the queue
+	/// 
+	/// consecutive events of the same window are merged, anything in between, e.g. a click,
+	/// keeps them apart, so ordering is preserved
+	/// 
+	struct InputCoalescing {
+		// keeps the latest position, so high polling rate mice can't flood the queue,
+		// turn it off when the full cursor path is needed, e.g. for drawing
+		bool mouse_moves = true;
+		bool mouse_scrolls = false; // sums the offsets
+
+		// stick axes closer to 0 than this read as 0, triggers are left alone
+		float axis_deadzone = 0.0f;
+
+		// axis changes smaller than this are dropped, reaching the rest or the end of the range never is
+		float axis_epsilon = 0.0f;
+	};
 } // namespace Na
 
 #endif // NA_EVENT_HPP
\ No newline at end of file
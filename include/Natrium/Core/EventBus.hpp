@@ -0,0 +1,75 @@
+#if !defined(NA_EVENT_BUS_HPP)
+#define NA_EVENT_BUS_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Core/Event.hpp"
+#include "Natrium/Template/ArrayList.hpp"
+
+namespace Na {
+	using EventCallback = std::function<void(Event& e)>;
+
+	struct EventSubscription {
+		u64 id = 0; // 0 is null
+
+		[[nodiscard]] inline explicit operator bool(void) const { return id; }
+	};
+
+	/// 
+	/// a listener list per EventType, so an event only reaches the listeners
+	/// that subscribed to its type, higher priorities first, equal ones in subscription order
+	/// 
+	/// dispatch stops at the first listener that sets handled, listeners subscribed
+	/// during dispatch join once it returns, unsubscribed ones are skipped right away
+	/// 
+	/// warning: not thread safe
+	/// 
+	class EventBus {
+	public:
+		EventBus(void) = default;
+
+		EventBus(const EventBus& other) = delete;
+		EventBus& operator=(const EventBus& other) = delete;
+
+		EventBus(EventBus&& other) = default;
+		EventBus& operator=(EventBus&& other) = default;
+
+		// types is an EventTypes mask, e.g. EventTypes(EventType::KeyPressed, EventType::KeyReleased)
+		EventSubscription subscribe(EventTypeMask types, EventCallback callback, i64 priority = 0);
+		void unsubscribe(EventSubscription subscription);
+
+		void clear(void);
+
+		// returns true if a listener handled it
+		bool dispatch(Event& e);
+		void dispatch(EventQueue& events);
+
+		[[nodiscard]] inline bool has_listeners(EventType type) const { return !m_Listeners[(u8)type].empty(); }
+		[[nodiscard]] inline u64 listener_count(EventType type) const { return m_Listeners[(u8)type].size(); }
+	private:
+		struct Listener {
+			u64 id;
+			i64 priority;
+			EventCallback callback; // empty once unsubscribed during dispatch
+		};
+
+		struct PendingSubscription {
+			u64 id;
+			EventTypeMask types;
+			i64 priority;
+			EventCallback callback;
+		};
+
+		void _insert(EventTypeMask types, u64 id, i64 priority, const EventCallback& callback);
+		void _apply_pending(void);
+	private:
+		std::array<ArrayList<Listener>, k_EventTypeCount> m_Listeners;
+
+		ArrayList<PendingSubscription> m_PendingSubscriptions;
+		bool m_PendingRemovals = false;
+
+		u64 m_NextId = 1;
+		u32 m_DispatchDepth = 0;
+	};
+} // namespace Na
+
+#endif // NA_EVENT_BUS_HPP
\ No newline at end of file
@@ -0,0 +1,58 @@
+#if !defined(NA_FILE_WATCHER_HPP)
+#define NA_FILE_WATCHER_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// reports files written, created or moved into the watched directories and their
+	/// subdirectories, through inotify on linux and ReadDirectoryChangesW on windows
+	/// 
+	/// nothing runs in the background, changes queue up in the kernel until poll
+	/// 
+	/// warning: not thread safe
+	/// 
+	class FileWatcher {
+	public:
+		FileWatcher(void) = default;
+		inline ~FileWatcher(void) { this->close(); }
+
+		FileWatcher(const FileWatcher& other) = delete;
+		FileWatcher& operator=(const FileWatcher& other) = delete;
+
+		FileWatcher(FileWatcher&& other) = delete;
+		FileWatcher& operator=(FileWatcher&& other) = delete;
+
+		/// 
+		/// throws if dir can not be watched, watching a dir twice does nothing
+		/// 
+		void watch(const std::filesystem::path& dir);
+		void close(void);
+
+		/// 
+		/// never blocks, returns the changed files since the last poll, each one once,
+		/// as weakly canonical paths
+		/// 
+		/// a file may be reported while it is still being written, e.g. on windows
+		/// every write is reported as it happens
+		/// 
+		[[nodiscard]] std::vector<std::filesystem::path> poll(void);
+
+		[[nodiscard]] inline u64 dir_count(void) const { return m_Dirs.size(); }
+	private:
+		struct WatchedDir;
+
+	#if defined(NA_PLATFORM_LINUX)
+		// also watches every subdirectory, false if dir itself can not be watched
+		bool _add_watch(const std::filesystem::path& dir);
+	#endif
+	private:
+		std::vector<WatchedDir*> m_Dirs;
+
+	#if defined(NA_PLATFORM_LINUX)
+		int m_Inotify = -1;
+	#endif
+	};
+} // namespace Na
+
+#endif // NA_FILE_WATCHER_HPP
\ No newline at end of file
@@ -0,0 +1,149 @@
+#if !defined(NA_JOB_SYSTEM_HPP)
+#define NA_JOB_SYSTEM_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Template/LockFreeQueue.hpp"
+
+namespace Na {
+	struct JobTask;
+
+	/// 
+	/// counts the unfinished jobs started with it, see JobSystem::run and JobSystem::wait,
+	/// keeps the first exception thrown by one of them
+	/// 
+	/// warning: must outlive the jobs started with it and the jobs depending on it
+	/// 
+	class JobCounter {
+	public:
+		JobCounter(void) = default;
+		// the job that finished last may still be releasing the parked jobs
+		inline ~JobCounter(void) { std::lock_guard lock(m_ParkMutex); }
+
+		JobCounter(const JobCounter& other) = delete;
+		JobCounter& operator=(const JobCounter& other) = delete;
+
+		[[nodiscard]] inline bool done(void) const { return !m_Pending.load(std::memory_order_acquire); }
+		[[nodiscard]] inline u32 pending(void) const { return m_Pending.load(std::memory_order_relaxed); }
+	private:
+		friend class JobSystem;
+
+		std::atomic<u32> m_Pending = 0;
+		std::atomic<bool> m_Failed = false;
+		std::exception_ptr m_Exception = nullptr; // written once by whoever set m_Failed
+
+		// jobs depending on this counter, pushed once it is done, dependencies are const
+		mutable std::mutex m_ParkMutex;
+		mutable JobTask* m_Parked = nullptr;
+	};
+
+	// a job with its counters, only used by JobSystem
+	struct JobTask {
+		std::function<void(void)> job;
+		JobCounter* counter;
+		const JobCounter* dependency;
+		JobTask* next_parked = nullptr;
+	};
+
+	/// 
+	/// a worker per core, each with its own work-stealing deque, idle workers steal
+	/// from a random other worker and sleep once nothing is left anywhere
+	/// 
+	/// jobs started on a worker go to its deque (newest first for the owner, oldest first
+	/// for thieves), jobs from other threads go through a shared bounded queue, when the
+	/// queues are full the job runs on the calling thread
+	/// 
+	/// one instance is created by Context::Initialize, meant to be shared by every subsystem
+	/// instead of spawning threads of their own
+	/// 
+	class JobSystem {
+	public:
+		using Job = std::function<void(void)>;
+		static constexpr u64 k_DequeCapacity = 4096;
+		static constexpr u64 k_QueueCapacity = 4096;
+	public:
+		// worker_count 0 takes one worker per core minus the calling thread
+		JobSystem(u32 worker_count = 0);
+		inline ~JobSystem(void) { this->destroy(); }
+		// runs every queued job, then joins the workers
+		void destroy(void);
+
+		JobSystem(const JobSystem& other) = delete;
+		JobSystem& operator=(const JobSystem& other) = delete;
+
+		/// 
+		/// counter is incremented now and decremented once the job finished,
+		/// a job is only queued once dependency is done, until then it waits without a thread
+		/// 
+		/// exceptions are stored in counter, see wait, without one they are logged
+		/// 
+		void run(Job job, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr);
+
+		/// 
+		/// runs queued jobs on the calling thread until counter is done,
+		/// so waiting inside a job does not block a worker, rethrows the first exception
+		/// 
+		void wait(JobCounter& counter);
+
+		/// 
+		/// splits [0, count) into batches of at least min_batch and
+		/// calls fn(begin, end) for each of them, returns once all are done
+		/// 
+		void parallel_for(u64 count, u64 min_batch, const std::function<void(u64, u64)>& fn);
+
+		[[nodiscard]] inline u32 worker_count(void) const { return m_WorkerCount; }
+
+		// true on the workers of any JobSystem
+		[[nodiscard]] static bool IsWorkerThread(void);
+
+		static void Initialize(u32 worker_count = 0);
+		static void Shutdown(void);
+
+		[[nodiscard]] static JobSystem& Get(void);
+	private:
+		using Task = JobTask;
+
+		/// 
+		/// bounded Chase-Lev deque, push and pop only from the owning worker,
+		/// steal from any thread
+		/// 
+		class WorkStealingDeque {
+		public:
+			bool push(Task* task);
+			Task* pop(void);
+			Task* steal(void);
+		private:
+			alignas(k_CacheLineSize) std::atomic<i64> m_Top = 0;
+			alignas(k_CacheLineSize) std::atomic<i64> m_Bottom = 0;
+			alignas(k_CacheLineSize) std::atomic<Task*> m_Tasks[k_DequeCapacity] = {};
+		};
+
+		struct Worker {
+			WorkStealingDeque deque;
+			std::thread thread;
+		};
+
+		void _worker_main(u32 index);
+
+		void _push(Task* task);
+		Task* _find(void);
+
+		// false if the dependency is already done, the task has to be pushed then
+		bool _park(Task* task);
+		void _finish(JobCounter* counter);
+
+		void _execute(Task* task);
+
+		void _wake_one(void);
+	private:
+		u32 m_WorkerCount = 0;
+		std::unique_ptr<Worker[]> m_Workers;
+
+		MpmcQueue<Task*> m_Queue{ k_QueueCapacity };
+
+		alignas(k_CacheLineSize) std::atomic<u32> m_Epoch = 0;
+		std::atomic<u32> m_Sleeping = 0;
+		std::atomic<bool> m_Stop = false;
+	};
+} // namespace Na
+
+#endif // NA_JOB_SYSTEM_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define NA_LOGGER_HPP
 
 #include "Natrium/Core.hpp"
+#include "Natrium/Template/LockFreeQueue.hpp"
 
 #define NA_COLOR_RSET  "\x1B[0m"         // reset color
 #define NA_COLOR_FRED  "\x1B[31m"        // red
@@ -34,20 +35,103 @@ namespace Na {
 		return "";
 	}
 
+	/// 
+	/// records below this level are compiled out of Logger, pass e.g. -DNA_LOG_MIN_LEVEL=Warn
+	/// 
+#if defined(NA_LOG_MIN_LEVEL)
+	inline constexpr LogLevel k_LogMinLevel = NA_LOG_MIN_LEVEL;
+#else
+	inline constexpr LogLevel k_LogMinLevel = Trace;
+#endif // NA_LOG_MIN_LEVEL
+
+	/// 
+	/// a record as it waits in AsyncLogSink, the message is formatted by the caller,
+	/// the timestamp, colors and I/O are left to the sink's thread
+	/// 
+	struct LogRecord {
+		static constexpr u64 k_InlineSize = 224;
+
+		std::chrono::system_clock::time_point time;
+		std::string_view name;
+		LogLevel level; // None for lines that are written as they are, e.g. headers
+		u16 size;
+		char text[k_InlineSize];
+		std::string long_text; // if the message did not fit into text
+
+		[[nodiscard]] inline std::string_view message(void) const { return long_text.empty() ? std::string_view(text, size) : long_text; }
+	};
+
+	/// 
+	/// writes log records to a stream on a thread of its own, loggers pointing at it only
+	/// format their message and push it into a lock-free queue
+	/// 
+	/// when the queue is full the caller waits for room rather than dropping the record,
+	/// Fatal records are flushed before the call returns
+	/// 
+	class AsyncLogSink {
+	public:
+		AsyncLogSink(std::ostream* stream, u64 capacity = 4096);
+		inline ~AsyncLogSink(void) { this->destroy(); }
+		// writes whatever is queued, then joins the thread
+		void destroy(void);
+
+		AsyncLogSink(const AsyncLogSink& other) = delete;
+		AsyncLogSink& operator=(const AsyncLogSink& other) = delete;
+
+		void push(LogRecord&& record);
+
+		// blocks until every record pushed so far was written and the stream flushed
+		void flush(void);
+
+		[[nodiscard]] inline u64 written(void) const { return m_Written.load(std::memory_order_acquire); }
+	private:
+		void _thread_main(void);
+	private:
+		std::ostream* m_Stream;
+		MpmcQueue<LogRecord> m_Queue;
+
+		alignas(k_CacheLineSize) std::atomic<u64> m_Pushed = 0;
+		alignas(k_CacheLineSize) std::atomic<u64> m_Written = 0;
+
+		std::atomic<u32> m_Epoch = 0;
+		std::atomic<bool> m_Sleeping = false;
+		std::atomic<bool> m_Stop = false;
+
+		std::thread m_Thread;
+	};
+
 #if !defined(NA_CONFIG_DIST)
-	template<typename t_Stream = std::ostream, bool t_Enabled = true>
+	template<typename t_Stream = std::ostream, bool t_Enabled = true, LogLevel t_MinLevel = k_LogMinLevel>
 #else
-	template<typename t_Stream = std::ostream, bool t_Enabled = false>
+	template<typename t_Stream = std::ostream, bool t_Enabled = false, LogLevel t_MinLevel = k_LogMinLevel>
 #endif 
 	class Logger {
 	public:
 		std::string_view name;
 		t_Stream* stream;
+
+		// if set, records go to it instead of stream
+		AsyncLogSink* sink = nullptr;
 	public:
 		inline void log(LogLevel level, const std::string_view& msg)
 		{
-			if (!t_Enabled)
+			if (!t_Enabled || level < t_MinLevel)
+				return;
+
+			if (sink)
+			{
+				LogRecord record = this->_record(level);
+				if (msg.size() <= LogRecord::k_InlineSize)
+				{
+					memcpy(record.text, msg.data(), msg.size());
+					record.size = (u16)msg.size();
+				} else
+				{
+					record.long_text = msg;
+				}
+				sink->push(std::move(record));
 				return;
+			}
 
 			*stream << NA_FORMAT(
 				"{}[{:%H:%M:%S}][{}]{}: {}\n",
@@ -62,9 +146,25 @@ namespace Na {
 		template<typename... t_Args>
 		inline void fmt(LogLevel level, fmt::format_string<t_Args...> str, t_Args&&... __args)
 		{
-			if (!t_Enabled)
+			if (!t_Enabled || level < t_MinLevel)
 				return;
 
+			if (sink)
+			{
+				LogRecord record = this->_record(level);
+
+				// formatting straight into the record, only long messages allocate,
+				// fmt never moves from its arguments, so forwarding them twice is fine
+				auto result = fmt::format_to_n(record.text, LogRecord::k_InlineSize, str, std::forward<t_Args>(__args)...);
+				if (result.size <= LogRecord::k_InlineSize)
+					record.size = (u16)result.size;
+				else
+					record.long_text = NA_FORMAT(str, std::forward<t_Args>(__args)...);
+
+				sink->push(std::move(record));
+				return;
+			}
+
 			*stream << NA_FORMAT(
 				"{}[{:%H:%M:%S}][{}]{}: {}\n",
 				LogLevelStr(level),
@@ -77,10 +177,10 @@ namespace Na {
 
 		inline void header(LogLevel level = LogLevel::Info)
 		{
-			if (!t_Enabled)
+			if (!t_Enabled || level < t_MinLevel)
 				return;
 
-			*stream << NA_FORMAT(
+			std::string line = NA_FORMAT(
 				"{}[{:%Y-%m-%d %H:%M:%S}][{}]{}\n",
 				LogLevelStr(level),
 				std::chrono::round<std::chrono::seconds>(std::chrono::system_clock::now()),
@@ -91,6 +191,16 @@ namespace Na {
 			#endif
 				NA_COLOR_RSET
 			);
+
+			if (sink)
+			{
+				LogRecord record = this->_record(None);
+				record.long_text = std::move(line);
+				sink->push(std::move(record));
+				return;
+			}
+
+			*stream << line;
 		}
 
 		inline void new_line(void)
@@ -98,6 +208,15 @@ namespace Na {
 			if (!t_Enabled)
 				return;
 
+			if (sink)
+			{
+				LogRecord record = this->_record(None);
+				record.text[0] = '\n';
+				record.size = 1;
+				sink->push(std::move(record));
+				return;
+			}
+
 			*stream << '\n';
 		}
 
@@ -110,6 +229,17 @@ namespace Na {
 		}
 
 		[[nodiscard]] inline constexpr bool enabled(void) { return t_Enabled; }
+		[[nodiscard]] inline constexpr bool enabled(LogLevel level) { return t_Enabled && level >= t_MinLevel; }
+	private:
+		[[nodiscard]] inline LogRecord _record(LogLevel level) const
+		{
+			LogRecord record;
+			record.time = std::chrono::system_clock::now();
+			record.name = name;
+			record.level = level;
+			record.size = 0;
+			return record;
+		}
 	};
 	inline Logger<> g_Logger{"Natrium", &std::clog};
 } // namespace Na
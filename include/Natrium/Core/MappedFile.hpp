@@ -0,0 +1,47 @@
+#if !defined(NA_MAPPED_FILE_HPP)
+#define NA_MAPPED_FILE_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// a read only view of a whole file, pages are read from disk as they are touched,
+	/// so payloads can be copied from it straight into their destination (e.g. staging memory)
+	/// 
+	/// warning: the contents change if the file is written while mapped
+	/// 
+	class MappedFile {
+	public:
+		MappedFile(void) = default;
+		inline MappedFile(const std::filesystem::path& path) { this->open(path); }
+		inline ~MappedFile(void) { this->close(); }
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		MappedFile(MappedFile&& other);
+		MappedFile& operator=(MappedFile&& other);
+
+		/// 
+		/// throws if the file can not be opened or mapped, an empty file maps to nothing
+		/// 
+		void open(const std::filesystem::path& path);
+		void close(void);
+
+		[[nodiscard]] inline const Byte* data(void) const { return m_Data; }
+		[[nodiscard]] inline u64 size(void) const { return m_Size; }
+		[[nodiscard]] inline std::span<const Byte> bytes(void) const { return { m_Data, m_Size }; }
+
+		[[nodiscard]] inline operator bool(void) const { return m_Data; }
+	private:
+		const Byte* m_Data = nullptr;
+		u64 m_Size = 0;
+
+	#if defined(NA_PLATFORM_WINDOWS)
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+	#endif
+	};
+} // namespace Na
+
+#endif // NA_MAPPED_FILE_HPP
\ No newline at end of file
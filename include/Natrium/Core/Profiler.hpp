@@ -0,0 +1,110 @@
+#if !defined(NA_PROFILER_HPP)
+#define NA_PROFILER_HPP
+
+#include "Natrium/Core.hpp"
+
+#define NA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define NA_PROFILE_CONCAT(a, b) NA_PROFILE_CONCAT_IMPL(a, b)
+
+#if !defined(NA_CONFIG_DIST)
+	// name has to outlive the profiler, e.g. a string literal
+	#define NA_PROFILE_SCOPE(name) ::Na::ProfileZone NA_PROFILE_CONCAT(x_ProfileZone, __LINE__)(name)
+	#define NA_PROFILE_FUNCTION() NA_PROFILE_SCOPE(__func__)
+#else
+	#define NA_PROFILE_SCOPE(name)
+	#define NA_PROFILE_FUNCTION()
+#endif // NA_CONFIG
+
+namespace Na {
+	inline constexpr bool k_ProfilingEnabled = k_BuildConfig != BuildConfig::Distribution;
+
+	struct ProfileZoneRecord {
+		const char* name;
+		u64 start, end; // nanoseconds of Profiler::Now
+	};
+
+	struct ProfileThreadSnapshot {
+		u32 thread_id;
+		std::string thread_name;
+		std::vector<ProfileZoneRecord> zones; // in the order they ended
+	};
+
+	/// 
+	/// every thread records zones into its own ring buffer of k_ThreadCapacity zones,
+	/// registered on its first zone, the oldest zones are overwritten once it is full
+	/// 
+	/// recording never locks, Collect copies the rings while threads keep recording
+	/// and drops whatever might have been overwritten during the copy
+	/// 
+	class Profiler {
+	public:
+		static constexpr u64 k_ThreadCapacity = 16384;
+
+		[[nodiscard]] static inline u64 Now(void)
+		{
+			return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()
+			).count();
+		}
+
+		static void Record(const char* name, u64 start, u64 end);
+
+		static void SetThreadName(std::string_view name);
+
+		[[nodiscard]] static std::vector<ProfileThreadSnapshot> Collect(void);
+
+		/// 
+		/// chrome://tracing and perfetto open it directly, tracy through its import-chrome tool
+		/// 
+		static void WriteChromeTrace(const std::filesystem::path& path);
+	};
+
+	class ProfileZone {
+	public:
+		inline ProfileZone(const char* name) : m_Name(name), m_Start(Profiler::Now()) {}
+		inline ~ProfileZone(void) { Profiler::Record(m_Name, m_Start, Profiler::Now()); }
+
+		ProfileZone(const ProfileZone& other) = delete;
+		ProfileZone& operator=(const ProfileZone& other) = delete;
+	private:
+		const char* m_Name;
+		u64 m_Start;
+	};
+
+	/// 
+	/// the last capacity frame times, in seconds like DeltaTime
+	/// 
+	class FrameHistory {
+	public:
+		static constexpr u32 k_DefaultCapacity = 512;
+
+		FrameHistory(u32 capacity = k_DefaultCapacity) : m_Times(capacity ? capacity : 1, 0.0) {}
+
+		/// 
+		/// also records the frame as a zone on the calling thread, ending now
+		/// 
+		void push(double frame_time);
+		inline void clear(void) { m_Head = 0; m_Size = 0; }
+
+		[[nodiscard]] double min(void) const;
+		[[nodiscard]] double max(void) const;
+		[[nodiscard]] double average(void) const;
+
+		/// 
+		/// p in [0, 1], e.g. 0.99 for the time 99% of the frames stay below
+		/// 
+		[[nodiscard]] double percentile(double p) const;
+
+		[[nodiscard]] inline double last(void) const { return m_Size ? m_Times[(m_Head + m_Times.size() - 1) % m_Times.size()] : 0.0; }
+
+		[[nodiscard]] inline u32 size(void) const { return m_Size; }
+		[[nodiscard]] inline u32 capacity(void) const { return (u32)m_Times.size(); }
+		[[nodiscard]] inline bool empty(void) const { return !m_Size; }
+	private:
+		std::vector<double> m_Times;
+		u32 m_Head = 0;
+		u32 m_Size = 0;
+	};
+} // namespace Na
+
+#endif // NA_PROFILER_HPP
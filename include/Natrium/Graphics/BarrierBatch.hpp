@@ -0,0 +1,82 @@
+#if !defined(NA_BARRIER_BATCH_HPP)
+#define NA_BARRIER_BATCH_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Graphics/DeviceImage.hpp"
+
+namespace Na {
+	/// 
+	/// collects image, buffer and memory barriers and records all of them with one pipeline barrier,
+	/// with vkCmdPipelineBarrier2KHR each barrier keeps its own stages, otherwise they are combined
+	/// 
+	/// transitions of a DeviceImage start from its tracked state and update it, subresources already
+	/// in the state are skipped if neither side writes, neighbouring levels and layers share a barrier
+	/// 
+	class BarrierBatch {
+	public:
+		BarrierBatch(void) = default;
+
+		void transition(DeviceImage& image, const ImageState& state, const vk::ImageSubresourceRange& range);
+		inline void transition(DeviceImage& image, const ImageState& state) { this->transition(image, state, image.subresource_range); }
+		inline void transition(DeviceImage& image, vk::ImageLayout layout) { this->transition(image, ImageState::ForLayout(layout)); }
+
+		/// 
+		/// not tracked, e.g. for swapchain images
+		/// 
+		void image(vk::Image img, const vk::ImageSubresourceRange& range, const ImageState& src, const ImageState& dst);
+
+		void buffer(
+			vk::Buffer buffer,
+			vk::DeviceSize offset,
+			vk::DeviceSize size,
+			vk::PipelineStageFlags src_stages,
+			vk::AccessFlags src_access,
+			vk::PipelineStageFlags dst_stages,
+			vk::AccessFlags dst_access
+		);
+
+		void memory(
+			vk::PipelineStageFlags src_stages,
+			vk::AccessFlags src_access,
+			vk::PipelineStageFlags dst_stages,
+			vk::AccessFlags dst_access
+		);
+
+		/// 
+		/// records everything into cmd_buffer and clears the batch, nothing is recorded if it is empty
+		/// 
+		void record(vk::CommandBuffer cmd_buffer);
+
+		/// 
+		/// records into single time commands, waits for the gpu
+		/// 
+		void submit(void);
+
+		void clear(void);
+
+		[[nodiscard]] inline u64 size(void) const { return m_Images.size() + m_Buffers.size() + m_Memory.size(); }
+		[[nodiscard]] inline bool empty(void) const { return !this->size(); }
+	private:
+		struct ImageBarrier {
+			vk::Image img;
+			vk::ImageSubresourceRange range;
+			ImageState src, dst;
+		};
+
+		struct BufferBarrier {
+			vk::Buffer buffer;
+			vk::DeviceSize offset, size;
+			vk::PipelineStageFlags src_stages, dst_stages;
+			vk::AccessFlags src_access, dst_access;
+		};
+
+		void _record_legacy(vk::CommandBuffer cmd_buffer) const;
+		void _record_sync2(vk::CommandBuffer cmd_buffer, PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2) const;
+	private:
+		std::vector<ImageBarrier> m_Images;
+		std::vector<BufferBarrier> m_Buffers;
+		std::vector<BufferBarrier> m_Memory; // only the stages and accesses are used
+	};
+} // namespace Na
+
+#endif // NA_BARRIER_BATCH_HPP
\ No newline at end of file
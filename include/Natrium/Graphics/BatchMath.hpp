@@ -0,0 +1,41 @@
+#if !defined(NA_BATCH_MATH_HPP)
+#define NA_BATCH_MATH_HPP
+
+#include "Natrium/Graphics/Culling.hpp"
+
+namespace Na {
+	/// 
+	/// transforms as structure of arrays, one stream per component, count entries each
+	/// 
+	struct TransformStreams {
+		const float* position[3];
+		const float* rotation[4]; // unit quaternions, x y z w
+		const float* scale[3];
+	};
+
+	/// 
+	/// kernels over many objects at once, vectorized with AVX2, SSE or NEON
+	/// depending on what the build targets (scalar otherwise)
+	/// 
+	/// the outputs can go straight into mapped memory, e.g. Renderer::allocate_instances,
+	/// every kernel writes each output once
+	/// 
+	namespace BatchMath {
+		// dst[i] = translate(position) * rotate(rotation) * scale(scale)
+		void ComposeTransforms(const TransformStreams& transforms, glm::mat4* dst, u64 count);
+
+		// dst[i] = lhs * rhs[i], dst may be rhs, e.g. view_projection * world
+		void MultiplyMatrices(const glm::mat4& lhs, const glm::mat4* rhs, glm::mat4* dst, u64 count);
+
+		// dst[i] = the box around src[i] transformed by transforms[i], dst may be src
+		void TransformBoxes(const glm::mat4* transforms, const BoundingBox* src, BoundingBox* dst, u64 count);
+
+		/// 
+		/// writes 1 for every sphere that intersects frustum into visible, 0 otherwise,
+		/// returns the visible count
+		/// 
+		u64 CullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius, u64 count, u8* visible);
+	} // namespace BatchMath
+} // namespace Na
+
+#endif // NA_BATCH_MATH_HPP
\ No newline at end of file
@@ -0,0 +1,81 @@
+#if !defined(NA_BINDLESS_TABLE_HPP)
+#define NA_BINDLESS_TABLE_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Graphics/Vulkan.hpp"
+#include "Natrium/Template/RangeAllocator.hpp"
+
+namespace Na {
+	using BindlessIndex = u32;
+	constexpr BindlessIndex k_NullBindlessIndex = k_U32Max;
+
+	/// 
+	/// one update-after-bind descriptor set shared by every bindless pipeline (those created
+	/// with PipelineState::bindless), bound as set 0:
+	/// - binding 0: combined image samplers, indexed by Texture::bindless_index
+	/// - binding 1: storage buffers, indexed by StorageBuffer::bindless_index
+	/// 
+	/// shaders declare unsized arrays and read the indices from push constants, e.g.
+	///   layout(set = 0, binding = 0) uniform sampler2D u_Textures[];
+	///   layout(set = 0, binding = 0) uniform sampler2DArray u_TextureArrays[];
+	///   layout(set = 0, binding = 1) buffer Objects { Object objects[]; } u_Buffers[];
+	/// indices that may diverge inside a draw have to be wrapped in nonuniformEXT
+	/// 
+	/// only exists with ContextSettings::bindless and DeviceFeatures::descriptor_indexing, see VkContext::GetBindlessTable,
+	/// textures and storage buffers register themselves on creation and free their index on destruction
+	/// 
+	/// removed indices go through the DeletionQueue, so they are only reused once the frames
+	/// recorded before the removal completed
+	/// 
+	class BindlessTable {
+	public:
+		static constexpr u32 k_TextureBinding = 0;
+		static constexpr u32 k_StorageBufferBinding = 1;
+
+		static constexpr u32 k_DefaultTextureCapacity = 16384;
+		static constexpr u32 k_DefaultStorageBufferCapacity = 4096;
+
+		BindlessTable(void) = default;
+
+		// capacities are clamped to the device's update-after-bind limits
+		BindlessTable(u32 texture_capacity, u32 storage_buffer_capacity);
+		void destroy(void);
+		inline ~BindlessTable(void) { this->destroy(); }
+
+		BindlessTable(const BindlessTable& other) = delete;
+		BindlessTable& operator=(const BindlessTable& other) = delete;
+
+		BindlessTable(BindlessTable&& other) = delete;
+		BindlessTable& operator=(BindlessTable&& other) = delete;
+
+		[[nodiscard]] BindlessIndex add_texture(vk::ImageView img_view, vk::Sampler sampler);
+
+		/// 
+		/// count consecutive descriptors starting at the returned index,
+		/// descriptor i covers [offset + i * range, offset + (i + 1) * range)
+		/// 
+		[[nodiscard]] BindlessIndex add_storage_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range, u32 count = 1);
+
+		void remove_texture(BindlessIndex index);
+		void remove_storage_buffer(BindlessIndex index, u32 count = 1);
+
+		[[nodiscard]] inline vk::DescriptorSetLayout layout(void) const { return m_Layout; }
+		[[nodiscard]] inline const vk::DescriptorSet& descriptor_set(void) const { return m_DescriptorSet; }
+
+		[[nodiscard]] inline u32 texture_capacity(void) const { return m_Textures.capacity(); }
+		[[nodiscard]] inline u32 storage_buffer_capacity(void) const { return m_StorageBuffers.capacity(); }
+
+		[[nodiscard]] inline operator bool(void) const { return m_DescriptorSet; }
+	private:
+		vk::DescriptorSetLayout m_Layout = nullptr;
+		vk::DescriptorPool m_Pool = nullptr;
+		vk::DescriptorSet m_DescriptorSet = nullptr;
+
+		RangeAllocator m_Textures; // hands out k_NullBindlessIndex when full
+		RangeAllocator m_StorageBuffers;
+
+		std::mutex m_Mutex; // guards the allocators and descriptor writes
+	};
+} // namespace Na
+
+#endif // NA_BINDLESS_TABLE_HPP
@@ -0,0 +1,46 @@
+#if !defined(NA_BUFFER_TRACKER_HPP)
+#define NA_BUFFER_TRACKER_HPP
+
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+
+namespace Na {
+	/// 
+	/// the cpu copy of a buffer with BufferUpdateRate::Tracked and the byte ranges every
+	/// frame in flight has not seen yet, a frame's region only catches up when it is synced,
+	/// so bytes written once are copied once per frame in flight and never again
+	/// 
+	/// ranges are kept sorted and merged, past k_MaxRanges per frame they collapse into one
+	/// 
+	class BufferTracker {
+	public:
+		static constexpr u64 k_MaxRanges = 64;
+
+		BufferTracker(void) = default;
+		BufferTracker(u64 size, u32 frame_count); // every frame starts out fully dirty
+
+		// into the cpu copy, dirty for every frame
+		void write(const void* data, u64 size, u64 offset);
+
+		/// 
+		/// copies what frame_index has not seen into its region of buffer (starting at region_offset)
+		/// and flushes it if the memory is not coherent, returns how many bytes were copied
+		/// 
+		u64 sync(const DeviceBuffer& buffer, u64 region_offset, u32 frame_index);
+
+		[[nodiscard]] inline const Byte* data(void) const { return m_Data.data(); }
+		[[nodiscard]] inline u64 size(void) const { return m_Data.size(); }
+
+		[[nodiscard]] inline bool dirty(u32 frame_index) const { return !m_Pending[frame_index].empty(); }
+	private:
+		struct Range {
+			u64 begin, end;
+		};
+
+		static void _add_range(std::vector<Range>& ranges, Range range);
+	private:
+		std::vector<Byte> m_Data;
+		std::vector<std::vector<Range>> m_Pending; // [frame index], sorted, never touching
+	};
+} // namespace Na
+
+#endif // NA_BUFFER_TRACKER_HPP
\ No newline at end of file
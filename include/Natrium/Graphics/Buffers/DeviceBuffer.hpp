@@ -2,14 +2,33 @@
 #define NA_DEVICE_BUFFER
 
 #include "Natrium/Core.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
 
 namespace Na {
 	u32 FindMemoryType(u32 typeFilter, vk::MemoryPropertyFlags properties);
+
+	/// 
+	/// how UniformBuffers and StorageBuffers are written:
+	/// - PerFrame: host visible, one region per frame in flight, written through the mapping
+	/// - Static: device local, one region shared by every frame, uploaded through the UploadManager
+	/// - Tracked: like PerFrame, but written into a cpu copy whose dirty ranges each frame's region
+	///   catches up with when it is synced, so only changed bytes are copied, in cached host
+	///   memory if the device has it, see BufferTracker
+	/// 
+	enum class BufferUpdateRate : u8 {
+		PerFrame = 0,
+		Static,
+		Tracked
+	};
+
+	// for the host visible regions of UniformBuffers and StorageBuffers with update_rate
+	vk::MemoryPropertyFlags HostMemoryProperties(BufferUpdateRate update_rate);
+
 	class DeviceBuffer {
 	public:
 		vk::Buffer buffer = nullptr;
 		vk::DeviceSize size = 0;
-		vk::DeviceMemory memory = nullptr;
+		DeviceAllocation allocation;
 
 		DeviceBuffer(void) = default;
 		DeviceBuffer(
@@ -29,7 +48,12 @@ namespace Na {
 
 		void copy(const DeviceBuffer& other);
 
-		[[nodiscard]] inline operator bool(void) const { return buffer && size && memory; }
+		/// 
+		/// only set for host visible buffers, stays valid until the buffer is destroyed
+		/// 
+		[[nodiscard]] inline void* mapped(void) const { return allocation.mapped; }
+
+		[[nodiscard]] inline operator bool(void) const { return buffer && size && allocation; }
 	};
 } // namespace Na
 
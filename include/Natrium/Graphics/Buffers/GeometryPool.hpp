@@ -0,0 +1,100 @@
+#if !defined(NA_GEOMETRY_POOL_HPP)
+#define NA_GEOMETRY_POOL_HPP
+
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+#include "Natrium/Template/RangeAllocator.hpp"
+
+namespace Na {
+	/// 
+	/// the vertices and indices of one mesh inside a GeometryPool,
+	/// indices are relative to first_vertex, which indexed draws pass as their vertex offset
+	/// 
+	struct GeometryAllocation {
+		u32 first_vertex = 0;
+		u32 vertex_count = 0;
+		u32 first_index = 0;
+		u32 index_count = 0;
+
+		[[nodiscard]] inline vk::DrawIndexedIndirectCommand indirect_command(u32 instance_count = 1, u32 first_instance = 0) const
+		{
+			return vk::DrawIndexedIndirectCommand(index_count, instance_count, first_index, (i32)first_vertex, first_instance);
+		}
+
+		[[nodiscard]] inline operator bool(void) const { return vertex_count; }
+	};
+
+	/// 
+	/// one device local vertex buffer and one index buffer shared by many meshes, so their draws
+	/// (or a single multi-draw-indirect) only bind geometry once, see Renderer::bind_geometry
+	/// 
+	/// every vertex has the same stride and every index the same type, ranges are allocated
+	/// first fit out of freed ranges, then bumped from the end
+	/// 
+	/// a freed range is only reused once the frames in flight completed, see DeletionQueue
+	/// 
+	class GeometryPool {
+	public:
+		GeometryPool(void) = default;
+		GeometryPool(
+			u32 vertex_stride,
+			u32 vertex_capacity,
+			u32 index_capacity,
+			vk::IndexType index_type = vk::IndexType::eUint32
+		);
+		void destroy(void);
+		inline ~GeometryPool(void) { this->destroy(); }
+
+		GeometryPool(const GeometryPool& other) = delete;
+		GeometryPool& operator=(const GeometryPool& other) = delete;
+
+		GeometryPool(GeometryPool&& other);
+		GeometryPool& operator=(GeometryPool&& other);
+
+		/// 
+		/// returns an invalid allocation when either buffer has no range that fits
+		/// 
+		[[nodiscard]] GeometryAllocation allocate(u32 vertex_count, u32 index_count);
+		void free(const GeometryAllocation& allocation);
+
+		/// 
+		/// allocates and uploads, indices are narrowed while staging for 16 bit pools
+		/// 
+		[[nodiscard]] GeometryAllocation add(const void* vertices, u32 vertex_count, const u32* indices, u32 index_count);
+
+		// submitted with the next flush, at the latest by Renderer::end_frame
+		void set_vertices(const GeometryAllocation& allocation, const void* vertices);
+		void set_indices(const GeometryAllocation& allocation, const u32* indices);
+
+		[[nodiscard]] inline u32 vertex_stride(void) const { return m_VertexStride; }
+		[[nodiscard]] inline vk::IndexType index_type(void) const { return m_IndexType; }
+
+		[[nodiscard]] inline u32 vertex_capacity(void) const { return m_Ranges ? m_Ranges->vertices.capacity() : 0; }
+		[[nodiscard]] inline u32 index_capacity(void) const { return m_Ranges ? m_Ranges->indices.capacity() : 0; }
+
+		// freed ranges count until the deletion queue released them
+		[[nodiscard]] u32 used_vertices(void) const;
+		[[nodiscard]] u32 used_indices(void) const;
+
+		[[nodiscard]] inline const DeviceBuffer& vertex_buffer(void) const { return m_VertexBuffer; }
+		[[nodiscard]] inline const DeviceBuffer& index_buffer(void) const { return m_IndexBuffer; }
+
+		[[nodiscard]] inline operator bool(void) const { return m_VertexBuffer; }
+	private:
+		// shared with the deferred frees, so they outlive a move or destroy of the pool
+		struct Ranges {
+			std::mutex mutex; // the frees run from whichever thread collects the deletion queue
+			RangeAllocator vertices;
+			RangeAllocator indices;
+		};
+	private:
+		DeviceBuffer m_VertexBuffer;
+		DeviceBuffer m_IndexBuffer;
+
+		u32 m_VertexStride = 0;
+		vk::IndexType m_IndexType = vk::IndexType::eUint32;
+
+		std::shared_ptr<Ranges> m_Ranges;
+	};
+} // namespace Na
+
+#endif // NA_GEOMETRY_POOL_HPP
\ No newline at end of file
@@ -4,10 +4,17 @@
 #include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
 
 namespace Na {
+	[[nodiscard]] inline constexpr u32 IndexSize(vk::IndexType index_type) { return index_type == vk::IndexType::eUint16 ? sizeof(u16) : sizeof(u32); }
+
 	class IndexBuffer {
 	public:
 		IndexBuffer(void) = default;
-		IndexBuffer(u32 count, const u32* data);
+
+		/// 
+		/// eUint16 halves the buffer, the indices are narrowed while staging, so every one has to fit
+		/// 
+		IndexBuffer(u32 count, const u32* data, vk::IndexType index_type = vk::IndexType::eUint32);
+		IndexBuffer(u32 count, const u16* data);
 		void destroy(void);
 
 		IndexBuffer(const IndexBuffer& other) = delete;
@@ -17,15 +24,18 @@ namespace Na {
 		IndexBuffer& operator=(IndexBuffer&& other);
 
 		void set_data(const u32* data);
+		void set_data(const u16* data);
 
 		[[nodiscard]] inline u64 size(void) const { return m_Buffer.size; }
 		[[nodiscard]] inline u32 count(void) const { return m_Count; }
+		[[nodiscard]] inline vk::IndexType index_type(void) const { return m_IndexType; }
 
 		[[nodiscard]] inline operator bool(void) const { return m_Count; }
 		[[nodiscard]] inline vk::Buffer native(void) const { return m_Buffer.buffer; }
 	private:
 		DeviceBuffer m_Buffer;
 		u32 m_Count = 0;
+		vk::IndexType m_IndexType = vk::IndexType::eUint32;
 	};
 } // namespace Na
 
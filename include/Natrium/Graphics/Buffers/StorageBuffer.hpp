@@ -2,6 +2,7 @@
 #define NA_STORAGE_BUFFER_HPP
 
 #include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+#include "Natrium/Graphics/Buffers/BufferTracker.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
 
 namespace Na {
@@ -10,7 +11,7 @@ namespace Na {
 		const ShaderUniformType descriptor_type = ShaderUniformType::StorageBuffer;
 
 		StorageBuffer(void) = default;
-		StorageBuffer(u64 size, const RendererSettings& renderer_settings);
+		StorageBuffer(u64 size, const RendererSettings& renderer_settings, BufferUpdateRate update_rate = BufferUpdateRate::PerFrame);
 		void destroy(void);
 		inline ~StorageBuffer(void) { this->destroy(); }
 
@@ -25,16 +26,53 @@ namespace Na {
 		[[nodiscard]] inline u64 aligned_size(void) const { return m_AlignedSize; }
 		[[nodiscard]] inline u64 total_size(void) const { return m_Buffer.size; }
 
+		// between the regions of consecutive frames, 0 for static buffers
+		[[nodiscard]] inline u64 frame_stride(void) const { return m_UpdateRate == BufferUpdateRate::Static ? 0 : m_AlignedSize; }
+		[[nodiscard]] inline BufferUpdateRate update_rate(void) const { return m_UpdateRate; }
+
 		[[nodiscard]] inline operator bool(void) const { return m_Buffer; }
 
 		[[nodiscard]] inline const DeviceBuffer& buffer(void) const { return m_Buffer; }
-		[[nodiscard]] inline void* mapped_data(void) const { return m_Mapped; }
+		[[nodiscard]] inline void* mapped_data(void) const { return m_Mapped; } // null for static buffers, write tracked ones through write
+
+		/// 
+		/// copies size bytes at offset through the shared staging ring of the UploadManager,
+		/// visible to graphics submissions after its next flush (at the latest Renderer::end_frame)
+		/// 
+		/// warning: static buffers only, frames still in flight are not waited for,
+		/// so only write bytes they do not read (or data that is fine to change mid frame)
+		/// 
+		void upload(const void* data, u64 size, u64 offset = 0);
+
+		/// 
+		/// tracked buffers only, write marks size bytes at offset dirty for every frame,
+		/// sync copies what frame_index has not seen yet into its region, see BufferTracker
+		/// 
+		void write(const void* data, u64 size, u64 offset = 0);
+		u64 sync(u32 frame_index);
+
+		/// 
+		/// every frame in flight has its own descriptor covering its region, static buffers share one,
+		/// k_NullBindlessIndex without a bindless table
+		/// 
+		[[nodiscard]] inline BindlessIndex bindless_index(u32 frame_index) const
+		{
+			if (m_BindlessIndex == k_NullBindlessIndex || m_UpdateRate == BufferUpdateRate::Static)
+				return m_BindlessIndex;
+			return m_BindlessIndex + frame_index;
+		}
 	private:
 		DeviceBuffer m_Buffer;
-		void* m_Mapped;
+		void* m_Mapped = nullptr;
 
 		u64 m_PerFrameSize = 0;
 		u64 m_AlignedSize = 0;
+		BufferUpdateRate m_UpdateRate = BufferUpdateRate::PerFrame;
+
+		BufferTracker m_Tracker; // only with BufferUpdateRate::Tracked
+
+		BindlessIndex m_BindlessIndex = k_NullBindlessIndex;
+		u32 m_BindlessCount = 0;
 	};
 } // namespace Na
 
@@ -0,0 +1,88 @@
+#if !defined(NA_TRANSIENT_BUFFER_HPP)
+#define NA_TRANSIENT_BUFFER_HPP
+
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+#include "Natrium/Graphics/Pipeline.hpp"
+
+namespace Na {
+	struct TransientAllocation {
+		vk::Buffer buffer = nullptr;
+		u32 offset = 0; // from the start of the buffer, usable as a dynamic offset
+		u64 size = 0;
+		void* mapped = nullptr;
+
+		[[nodiscard]] inline operator bool(void) const { return mapped; }
+	};
+
+	/// 
+	/// one persistently mapped buffer split into a slice per frame in flight,
+	/// allocations are bumped linearly out of the current frame's slice
+	/// 
+	class TransientBuffer {
+	public:
+		TransientBuffer(void) = default;
+
+		/// 
+		/// binding_range is the descriptor range used when bound through GraphicsPipeline::bind_uniform,
+		/// i.e. the largest allocation that will be read as a uniform/storage block
+		/// 
+		TransientBuffer(
+			u64 per_frame_size,
+			ShaderUniformType type,
+			u64 binding_range,
+			const RendererSettings& renderer_settings
+		);
+		void destroy(void);
+		inline ~TransientBuffer(void) { this->destroy(); }
+
+		TransientBuffer(const TransientBuffer& other) = delete;
+		TransientBuffer& operator=(const TransientBuffer& other) = delete;
+
+		TransientBuffer(TransientBuffer&& other);
+		TransientBuffer& operator=(TransientBuffer&& other);
+
+		// resets the slice of frame_index, must be called after that frame's fence has been waited on
+		void begin_frame(u32 frame_index);
+
+		/// 
+		/// returns an invalid allocation when the frame's slice is exhausted
+		/// alignment of 0 uses the device's minimum offset alignment for the buffer type
+		/// 
+		[[nodiscard]] TransientAllocation allocate(u64 size, u64 alignment = 0);
+
+		template<typename T>
+		[[nodiscard]] inline TransientAllocation push(const T& data)
+		{
+			TransientAllocation allocation = this->allocate(sizeof(T));
+			if (allocation)
+				memcpy(allocation.mapped, &data, sizeof(T));
+			return allocation;
+		}
+
+		[[nodiscard]] inline ShaderUniformType type(void) const { return m_Type; }
+
+		[[nodiscard]] inline u64 per_frame_size(void) const { return m_PerFrameSize; }
+		[[nodiscard]] inline u64 binding_range(void) const { return m_BindingRange; }
+		[[nodiscard]] inline u64 used(void) const { return m_Head; }
+		[[nodiscard]] inline u64 total_size(void) const { return m_Buffer.size; }
+
+		[[nodiscard]] inline operator bool(void) const { return m_Buffer; }
+
+		[[nodiscard]] inline const DeviceBuffer& buffer(void) const { return m_Buffer; }
+		[[nodiscard]] inline void* mapped_data(void) const { return m_Mapped; }
+	private:
+		DeviceBuffer m_Buffer;
+		void* m_Mapped = nullptr;
+
+		ShaderUniformType m_Type = ShaderUniformType::None;
+
+		u64 m_PerFrameSize = 0;
+		u64 m_BindingRange = 0;
+		u64 m_Alignment = 1;
+
+		u64 m_FrameOffset = 0;
+		u64 m_Head = 0;
+	};
+} // namespace Na
+
+#endif // NA_TRANSIENT_BUFFER_HPP
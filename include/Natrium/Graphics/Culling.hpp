@@ -0,0 +1,79 @@
+#if !defined(NA_CULLING_HPP)
+#define NA_CULLING_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	struct BoundingBox {
+		glm::vec3 min{ 0.0f };
+		glm::vec3 max{ 0.0f };
+
+		[[nodiscard]] inline glm::vec3 center(void) const { return (min + max) * 0.5f; }
+		[[nodiscard]] inline glm::vec3 extent(void) const { return (max - min) * 0.5f; }
+
+		// the box around the transformed box
+		[[nodiscard]] BoundingBox transformed(const glm::mat4& transform) const;
+	};
+
+	struct BoundingSphere {
+		glm::vec3 center{ 0.0f };
+		float radius = -1.0f; // negative is never culled
+
+		// scaled by the largest axis scale of transform
+		[[nodiscard]] BoundingSphere transformed(const glm::mat4& transform) const;
+	};
+
+	/// 
+	/// the six planes of a view projection matrix (clip depth 0 to 1), normals point inwards
+	/// 
+	/// the tests are conservative, a volume that touches the corner outside of
+	/// two planes may pass
+	/// 
+	class Frustum {
+	public:
+		enum Plane : u8 { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+		Frustum(void) = default;
+		Frustum(const glm::mat4& view_projection);
+
+		[[nodiscard]] bool intersects(const BoundingSphere& sphere) const;
+		[[nodiscard]] bool intersects(const BoundingBox& box) const;
+
+		// xyz is the unit normal, w the distance
+		[[nodiscard]] inline const glm::vec4& plane(Plane plane) const { return m_Planes[plane]; }
+	private:
+		glm::vec4 m_Planes[Plane::Count]{};
+	};
+
+	/// 
+	/// tests many world space spheres against a frustum at once, stored as structure of
+	/// arrays for BatchMath::CullSpheres
+	/// 
+	/// warning: not thread safe, cull may be called from many threads once nothing is added
+	/// 
+	class FrustumCuller {
+	public:
+		FrustumCuller(void) = default;
+
+		// returns the index of the sphere
+		u32 add(const BoundingSphere& sphere);
+
+		void clear(void);
+
+		/// 
+		/// writes 1 for every sphere that intersects frustum into visible, 0 otherwise,
+		/// visible needs size() bytes, returns the visible count
+		/// 
+		u32 cull(const Frustum& frustum, u8* visible) const;
+
+		[[nodiscard]] inline u32 size(void) const { return (u32)m_X.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_X.empty(); }
+	private:
+		ArrayList<float> m_X;
+		ArrayList<float> m_Y;
+		ArrayList<float> m_Z;
+		ArrayList<float> m_Radius;
+	};
+} // namespace Na
+
+#endif // NA_CULLING_HPP
\ No newline at end of file
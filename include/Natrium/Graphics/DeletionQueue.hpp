@@ -0,0 +1,119 @@
+#if !defined(NA_DELETION_QUEUE_HPP)
+#define NA_DELETION_QUEUE_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
+
+namespace Na {
+	/// 
+	/// defers destroying device objects until the gpu is done with the frame that was being
+	/// recorded when they were pushed, so resources can be dropped mid frame without a device idle
+	/// 
+	/// frames are counted per submitter, every Renderer is one: before recording a frame it collects
+	/// with the number of its completed frames and sets its frame to the one being recorded,
+	/// an entry is destroyed once every submitter completed the frame it was recording at the push,
+	/// objects pushed before the first frame are destroyed on the first collect
+	/// 
+	/// internally synchronized, objects may be pushed from any thread
+	/// 
+	class DeletionQueue {
+	public:
+		DeletionQueue(void) = default;
+		inline ~DeletionQueue(void) { this->flush(); }
+
+		DeletionQueue(const DeletionQueue& other) = delete;
+		DeletionQueue& operator=(const DeletionQueue& other) = delete;
+
+		DeletionQueue(DeletionQueue&& other) = delete;
+		DeletionQueue& operator=(DeletionQueue&& other) = delete;
+
+		/// 
+		/// null handles are ignored, the allocation (if any) is freed with the object
+		/// 
+		template<typename t_Handle>
+		inline void push(t_Handle handle, const DeviceAllocation& allocation = {})
+		{
+			if (handle)
+				this->_push(t_Handle::objectType, (u64)(typename t_Handle::CType)handle, allocation);
+		}
+
+		inline void free(const DeviceAllocation& allocation)
+		{
+			if (allocation)
+				this->_push(vk::ObjectType::eUnknown, 0, allocation);
+		}
+
+		/// 
+		/// runs fn instead of destroying an object, e.g. to release a descriptor slot,
+		/// it is called without the queue locked, so it may push again
+		/// 
+		void defer(std::function<void(void)> fn);
+
+		/// 
+		/// submitters count their frames on their own, ids are reused once removed,
+		/// entries stop waiting on a removed submitter
+		/// 
+		[[nodiscard]] u32 add_submitter(void);
+		void remove_submitter(u32 submitter);
+
+		/// 
+		/// frame is the number of the frame submitter is recording, everything pushed from now on
+		/// waits for it to complete
+		/// 
+		void set_frame(u32 submitter, u64 frame);
+
+		/// 
+		/// keeps everything pushed from now on alive until unpinned, regardless of frames,
+		/// for work submitted outside of them, e.g. an ImmediateBatch
+		/// 
+		[[nodiscard]] u64 pin(void);
+		void unpin(u64 pin);
+
+		/// 
+		/// completed_frames of submitter are done, destroys everything no submitter may still use,
+		/// unless pinned, returns how many entries were destroyed
+		/// 
+		u32 collect(u32 submitter, u64 completed_frames);
+
+		/// 
+		/// destroys everything right away,
+		/// warning: only once the device is idle
+		/// 
+		u32 flush(void);
+
+		[[nodiscard]] u64 pending(void);
+	private:
+		struct Entry {
+			u64 sequence; // in push order
+			vk::ObjectType type;
+			u64 handle;
+			DeviceAllocation allocation;
+			std::function<void(void)> fn;
+		};
+
+		// the first entry pushed while the submitter recorded frame
+		struct FrameMarker {
+			u64 frame;
+			u64 first_sequence;
+		};
+
+		struct Submitter {
+			bool active = false;
+			std::deque<FrameMarker> frames; // not completed yet, oldest first
+		};
+
+		void _push(vk::ObjectType type, u64 handle, const DeviceAllocation& allocation, std::function<void(void)> fn = nullptr);
+
+		// takes the entries in [0, count) out, so they are destroyed without the lock
+		[[nodiscard]] std::vector<Entry> _take(u64 count);
+		static void _Destroy(std::vector<Entry>& entries);
+	private:
+		std::mutex m_Mutex;
+		std::deque<Entry> m_Entries;
+		std::multiset<u64> m_Pins; // sequences
+		std::vector<Submitter> m_Submitters;
+		u64 m_NextSequence = 0;
+	};
+} // namespace Na
+
+#endif // NA_DELETION_QUEUE_HPP
\ No newline at end of file
@@ -0,0 +1,58 @@
+#if !defined(NA_DESCRIPTOR_ALLOCATOR_HPP)
+#define NA_DESCRIPTOR_ALLOCATOR_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// hands out descriptor sets that live for one frame, each frame in flight allocates from
+	/// its own list of pools, which are reset wholesale once the frame's fence retired
+	/// 
+	/// a full pool moves allocation on to the next one, new pools grow geometrically,
+	/// so after a few frames every frame allocates from pools it already has
+	/// 
+	class DescriptorAllocator {
+	public:
+		static constexpr u32 k_DefaultSetsPerPool = 256;
+
+		DescriptorAllocator(void) = default;
+		DescriptorAllocator(u32 frame_count, u32 sets_per_pool = k_DefaultSetsPerPool);
+		void destroy(void);
+		inline ~DescriptorAllocator(void) { this->destroy(); }
+
+		DescriptorAllocator(const DescriptorAllocator& other) = delete;
+		DescriptorAllocator& operator=(const DescriptorAllocator& other) = delete;
+
+		DescriptorAllocator(DescriptorAllocator&& other);
+		DescriptorAllocator& operator=(DescriptorAllocator&& other);
+
+		/// 
+		/// the set is valid until frame_index is reset, safe to call from multiple threads
+		/// 
+		[[nodiscard]] vk::DescriptorSet allocate(u32 frame_index, vk::DescriptorSetLayout layout);
+
+		/// 
+		/// warning: the frame's fence has to have signaled
+		/// 
+		void reset(u32 frame_index);
+
+		[[nodiscard]] inline u32 frame_count(void) const { return (u32)m_Frames.size(); }
+		[[nodiscard]] u64 pool_count(void) const;
+	private:
+		struct FramePools {
+			std::vector<vk::DescriptorPool> pools;
+			u64 current = 0; // pools before it are full
+		};
+
+		vk::DescriptorPool _create_pool(u32 max_sets);
+	private:
+		std::vector<FramePools> m_Frames;
+		u32 m_SetsPerPool = 0;
+		u32 m_NextPoolSize = 0;
+
+		// heap allocated so the allocator stays movable
+		std::unique_ptr<std::mutex> m_Mutex;
+	};
+} // namespace Na
+
+#endif // NA_DESCRIPTOR_ALLOCATOR_HPP
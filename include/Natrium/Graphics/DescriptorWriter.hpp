@@ -0,0 +1,69 @@
+#if !defined(NA_DESCRIPTOR_WRITER_HPP)
+#define NA_DESCRIPTOR_WRITER_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// collects descriptor writes for any number of sets and submits them
+	/// with a single vkUpdateDescriptorSets call on flush (or destruction)
+	/// 
+	/// consecutive writes to neighbouring array elements of the same binding are merged
+	/// 
+	/// warning: not thread safe, sets being written must not be in use by pending command buffers
+	/// unless their bindings are update-after-bind
+	/// 
+	class DescriptorWriter {
+	public:
+		DescriptorWriter(void) = default;
+		inline ~DescriptorWriter(void) { this->flush(); }
+
+		DescriptorWriter(const DescriptorWriter& other) = delete;
+		DescriptorWriter& operator=(const DescriptorWriter& other) = delete;
+
+		DescriptorWriter(DescriptorWriter&& other);
+		DescriptorWriter& operator=(DescriptorWriter&& other); // flushes the writes queued here first
+
+		void write_image(
+			vk::DescriptorSet set,
+			u32 binding,
+			vk::DescriptorType type,
+			const vk::DescriptorImageInfo& image_info,
+			u32 array_element = 0
+		);
+		void write_buffer(
+			vk::DescriptorSet set,
+			u32 binding,
+			vk::DescriptorType type,
+			const vk::DescriptorBufferInfo& buffer_info,
+			u32 array_element = 0
+		);
+
+		/// 
+		/// submits every queued write, returns how many vk::WriteDescriptorSet were issued
+		/// 
+		u32 flush(void);
+
+		[[nodiscard]] inline u64 pending(void) const { return m_Writes.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_Writes.empty(); }
+	private:
+		struct Write {
+			vk::DescriptorSet set;
+			u32 binding;
+			u32 array_element;
+			u32 count;
+			vk::DescriptorType type;
+			bool image;
+			u64 first_info; // into m_ImageInfos or m_BufferInfos
+		};
+
+		// returns true if the write was appended to the last one
+		bool _merge(vk::DescriptorSet set, u32 binding, vk::DescriptorType type, u32 array_element, bool image, u64 info_index);
+	private:
+		std::vector<Write> m_Writes;
+		std::vector<vk::DescriptorImageInfo> m_ImageInfos;
+		std::vector<vk::DescriptorBufferInfo> m_BufferInfos;
+	};
+} // namespace Na
+
+#endif // NA_DESCRIPTOR_WRITER_HPP
@@ -0,0 +1,191 @@
+#if !defined(NA_DEVICE_ALLOCATOR_HPP)
+#define NA_DEVICE_ALLOCATOR_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	struct DeviceMemoryBlock;
+
+	/// 
+	/// what an allocation is used for, only for accounting
+	/// 
+	enum class DeviceMemoryCategory : u8 {
+		Other = 0,
+		Vertex,
+		Index,
+		Uniform,
+		Storage, // storage and indirect buffers
+		Staging, // transfer source only buffers
+		Texture,
+		Attachment,
+		Count
+	};
+
+	inline constexpr u32 k_DeviceMemoryCategoryCount = (u32)DeviceMemoryCategory::Count;
+
+	std::string_view DeviceMemoryCategoryStr(DeviceMemoryCategory category);
+
+	// the first matching usage wins, in the order of DeviceMemoryCategory
+	[[nodiscard]] DeviceMemoryCategory DeviceMemoryCategoryOf(vk::BufferUsageFlags usage);
+	[[nodiscard]] DeviceMemoryCategory DeviceMemoryCategoryOf(vk::ImageUsageFlags usage);
+
+	struct DeviceAllocation {
+		vk::DeviceMemory memory = nullptr;
+		vk::DeviceSize offset = 0;
+		vk::DeviceSize size = 0;
+		void* mapped = nullptr; // set if the memory is host visible, already offset
+		DeviceMemoryBlock* block = nullptr;
+		vk::MemoryPropertyFlags properties; // of the memory type, may have more flags than requested
+		DeviceMemoryCategory category = DeviceMemoryCategory::Other;
+
+		// host writes through mapped need DeviceAllocator::flush otherwise
+		[[nodiscard]] inline bool coherent(void) const { return (bool)(properties & vk::MemoryPropertyFlagBits::eHostCoherent); }
+
+		[[nodiscard]] inline operator bool(void) const { return memory; }
+	};
+
+	struct DeviceMemoryStats {
+		u64 block_count = 0;
+		u64 allocation_count = 0;
+		u64 free_range_count = 0; // more ranges than blocks means fragmentation
+		vk::DeviceSize reserved = 0; // allocated from the driver
+		vk::DeviceSize used = 0; // handed out to resources
+	};
+
+	struct DeviceMemoryCategoryStats {
+		u64 allocation_count = 0;
+		vk::DeviceSize used = 0;
+		vk::DeviceSize peak = 0; // highest used since the allocator was created
+	};
+
+	struct DeviceMemoryHeapStats {
+		vk::DeviceSize size = 0;
+		bool device_local = false;
+
+		// of this allocator only
+		vk::DeviceSize reserved = 0;
+		vk::DeviceSize peak_reserved = 0;
+		vk::DeviceSize used = 0;
+		vk::DeviceSize peak_used = 0;
+
+		// VK_EXT_memory_budget, zero without it
+		// usage counts every allocation of the process, also the ones made outside of the allocator
+		vk::DeviceSize budget = 0;
+		vk::DeviceSize usage = 0;
+	};
+
+	struct DeviceMemoryReport {
+		std::vector<DeviceMemoryHeapStats> heaps;
+		std::array<DeviceMemoryCategoryStats, k_DeviceMemoryCategoryCount> categories{};
+		DeviceMemoryStats total;
+		bool has_budget = false;
+		u64 failed_allocation_count = 0;
+
+		[[nodiscard]] inline const DeviceMemoryCategoryStats& operator[](DeviceMemoryCategory category) const { return categories[(u32)category]; }
+
+		/// 
+		/// one line per heap and per category that was ever used
+		/// 
+		void log(LogLevel level = LogLevel::Info) const;
+	};
+
+	/// 
+	/// sub-allocates buffers and images out of large vk::DeviceMemory blocks,
+	/// one pool of blocks per memory type and resource kind (linear/optimal)
+	/// so bufferImageGranularity never has to be respected inside a block
+	/// 
+	/// allocations larger than half a block get a dedicated block
+	/// host visible blocks are mapped once for their whole lifetime, allocations in
+	/// non coherent memory are aligned to nonCoherentAtomSize so flushes never overlap
+	/// 
+	/// if the driver runs out of memory, empty blocks are released and the allocation is retried once,
+	/// if it fails again the report is logged as an error before the exception is rethrown
+	/// 
+	class DeviceAllocator {
+	public:
+		static constexpr vk::DeviceSize k_DefaultBlockSize = 64ull * 1024 * 1024;
+
+		DeviceAllocator(void) = default;
+		/// 
+		/// get_memory_properties2 is only given with VK_EXT_memory_budget enabled,
+		/// reports have no budgets otherwise
+		/// 
+		DeviceAllocator(
+			vk::PhysicalDevice physical_device,
+			vk::Device logical_device,
+			vk::DeviceSize block_size = k_DefaultBlockSize,
+			PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties2 = nullptr
+		);
+		void destroy(void);
+		inline ~DeviceAllocator(void) { this->destroy(); }
+
+		DeviceAllocator(const DeviceAllocator& other) = delete;
+		DeviceAllocator& operator=(const DeviceAllocator& other) = delete;
+
+		DeviceAllocator(DeviceAllocator&& other) = delete;
+		DeviceAllocator& operator=(DeviceAllocator&& other) = delete;
+
+		/// 
+		/// linear is true for buffers and linearly tiled images
+		/// 
+		[[nodiscard]] DeviceAllocation allocate(
+			const vk::MemoryRequirements& requirements,
+			vk::MemoryPropertyFlags properties,
+			bool linear,
+			DeviceMemoryCategory category = DeviceMemoryCategory::Other
+		);
+		void free(DeviceAllocation& allocation);
+
+		/// 
+		/// makes host writes to size bytes at offset into allocation visible to the device,
+		/// does nothing for coherent memory
+		/// 
+		void flush(const DeviceAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) const;
+
+		/// 
+		/// frees every block that has no allocations left,
+		/// empty blocks are otherwise kept around to be reused
+		/// 
+		void release_empty_blocks(void);
+
+		[[nodiscard]] u32 find_memory_type(u32 type_filter, vk::MemoryPropertyFlags properties) const;
+
+		[[nodiscard]] DeviceMemoryStats stats(void) const;
+		[[nodiscard]] DeviceMemoryStats stats(u32 memory_type) const;
+
+		/// 
+		/// queries the budgets from the driver each call, cheap enough for once a frame
+		/// 
+		[[nodiscard]] DeviceMemoryReport report(void) const;
+
+		[[nodiscard]] inline const vk::PhysicalDeviceMemoryProperties& memory_properties(void) const { return m_MemoryProperties; }
+		[[nodiscard]] inline vk::DeviceSize block_size(void) const { return m_BlockSize; }
+	private:
+		DeviceMemoryBlock* _create_block(u32 pool_index, vk::DeviceSize size, bool dedicated);
+		void _destroy_block(DeviceMemoryBlock* block);
+
+		// m_Mutex has to be locked
+		void _release_empty_blocks(void);
+		DeviceMemoryReport _report(void) const;
+	private:
+		vk::PhysicalDevice m_PhysicalDevice = nullptr;
+		vk::Device m_LogicalDevice = nullptr;
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR m_GetMemoryProperties2 = nullptr;
+		vk::PhysicalDeviceMemoryProperties m_MemoryProperties{};
+		vk::DeviceSize m_BlockSize = 0;
+		vk::DeviceSize m_NonCoherentAtomSize = 1;
+
+		// [memory type * 2 + (linear ? 0 : 1)]
+		std::array<ArrayList<DeviceMemoryBlock*>, VK_MAX_MEMORY_TYPES * 2> m_Pools;
+
+		std::array<DeviceMemoryCategoryStats, k_DeviceMemoryCategoryCount> m_Categories{};
+		std::array<vk::DeviceSize, VK_MAX_MEMORY_HEAPS> m_HeapReserved{}, m_HeapPeakReserved{};
+		std::array<vk::DeviceSize, VK_MAX_MEMORY_HEAPS> m_HeapUsed{}, m_HeapPeakUsed{};
+		u64 m_FailedAllocationCount = 0;
+
+		mutable std::mutex m_Mutex;
+	};
+} // namespace Na
+
+#endif // NA_DEVICE_ALLOCATOR_HPP
@@ -2,6 +2,7 @@
 #define NA_DEVICE_IMAGE_HPP
 
 #include "Natrium/Core.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
 
 namespace Na {
 	vk::Format FindSupportedFormat(
@@ -10,10 +11,51 @@ namespace Na {
 		vk::FormatFeatureFlags features
 	);
 
+	/// 
+	/// levels of a full mip chain down to 1x1
+	/// 
+	[[nodiscard]] u32 MipLevelCount(const vk::Extent3D& extent);
+
+	/// 
+	/// blits every level of range from the one above it, level range.baseMipLevel has to be
+	/// in eTransferDstOptimal with its contents, the rest in eTransferDstOptimal as well,
+	/// the whole range ends up in final_layout
+	/// 
+	/// warning: needs a graphics queue and a format with linear filtering for blits
+	/// 
+	void RecordMipGeneration(
+		vk::CommandBuffer cmd_buffer,
+		vk::Image img,
+		const vk::Extent3D& extent,
+		const vk::ImageSubresourceRange& range,
+		vk::ImageLayout final_layout = vk::ImageLayout::eShaderReadOnlyOptimal
+	);
+
+	/// 
+	/// what a subresource is in and which stages last accessed it how,
+	/// the flags have the same values with synchronization2
+	/// 
+	struct ImageState {
+		vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags stages = {};
+		vk::AccessFlags access = {};
+
+		/// 
+		/// the stages and accesses anything in layout usually has, e.g. transfer writes for
+		/// eTransferDstOptimal or shader reads of the vertex, fragment and compute stages for
+		/// eShaderReadOnlyOptimal, layouts without a usual use get every stage and access
+		/// 
+		[[nodiscard]] static ImageState ForLayout(vk::ImageLayout layout);
+
+		[[nodiscard]] bool operator==(const ImageState& other) const = default;
+	};
+
+	class BarrierBatch;
+
 	class DeviceImage {
 	public:
 		vk::Image img = nullptr;
-		vk::DeviceMemory memory = nullptr;
+		DeviceAllocation allocation;
 
 		union {
 			vk::Extent3D extent;
@@ -34,7 +76,8 @@ namespace Na {
 			vk::ImageUsageFlags usage,
 			vk::SharingMode sharing_mode,
 			vk::SampleCountFlagBits sample_count,
-			vk::MemoryPropertyFlags memory_properties
+			vk::MemoryPropertyFlags memory_properties,
+			u32 mip_levels = 1
 		);
 		void destroy(void);
 
@@ -44,12 +87,50 @@ namespace Na {
 		DeviceImage(DeviceImage&& other);
 		DeviceImage& operator=(DeviceImage&& other);
 
-		void transition_layout(vk::ImageLayout old_layout, vk::ImageLayout new_layout);
+		/// 
+		/// the state of every subresource is tracked, it starts out as eUndefined, transitions
+		/// through BarrierBatch update it, anything else changing the layout has to report it
+		/// 
+		[[nodiscard]] const ImageState& state(u32 layer = 0, u32 mip_level = 0) const;
+		void set_state(const ImageState& state, const vk::ImageSubresourceRange& range);
+		inline void set_state(const ImageState& state) { this->set_state(state, this->subresource_range); }
 
-		void copy_from_buffer(vk::Buffer buffer, u32 starting_layer = 0, u32 layer_count = 1);
+		/// 
+		/// transitions level_count levels starting at base_mip_level from their tracked state,
+		/// every level by default, records into cmd_buffer, see BarrierBatch to merge more transitions
+		/// 
+		void transition_layout(
+			vk::CommandBuffer cmd_buffer,
+			vk::ImageLayout new_layout,
+			u32 base_mip_level = 0,
+			u32 level_count = VK_REMAINING_MIP_LEVELS
+		);
+
+		/// 
+		/// like the above in single time commands, waits for the gpu
+		/// 
+		void transition_layout(vk::ImageLayout new_layout, u32 base_mip_level = 0, u32 level_count = VK_REMAINING_MIP_LEVELS);
+
+		/// 
+		/// old_layout replaces the tracked layout of the levels first, waits for the gpu
+		/// 
+		void transition_layout(
+			vk::ImageLayout old_layout,
+			vk::ImageLayout new_layout,
+			u32 base_mip_level = 0,
+			u32 level_count = VK_REMAINING_MIP_LEVELS
+		);
+
+		void copy_from_buffer(vk::Buffer buffer, u32 starting_layer = 0, u32 layer_count = 1, u32 mip_level = 0);
 
 		void copy_all_from_buffer(vk::Buffer buffer, u32 starting_layer = 0);
 
+		/// 
+		/// copies one level of one layer into buffer, tightly packed, e.g. to read back a render target,
+		/// layout is the image's current layout, it is left in it
+		/// 
+		void copy_to_buffer(vk::Buffer buffer, vk::ImageLayout layout, u32 layer = 0, u32 mip_level = 0) const;
+
 		/// 
 		/// copies each buffer into a separate layer, starting at starting_layer
 		/// 
@@ -60,13 +141,36 @@ namespace Na {
 		/// 
 		inline void copy_from_buffers(const std::initializer_list<vk::Buffer> buffers, u32 starting_layer = 0) { this->copy_from_buffers(buffers.begin(), (u32)buffers.size(), starting_layer); }
 
+		/// 
+		/// fills every level below 0 from level 0, which has to be in eTransferDstOptimal
+		/// like the rest, waits for the gpu, see RecordMipGeneration, every level is tracked as final_layout
+		/// 
+		void generate_mipmaps(vk::ImageLayout final_layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
 		[[nodiscard]] vk::ImageView create_img_view(void) const;
 
+		[[nodiscard]] inline u32 mip_levels(void) const { return this->subresource_range.levelCount; }
+		[[nodiscard]] inline vk::Extent3D mip_extent(u32 mip_level) const
+		{
+			return vk::Extent3D(
+				std::max(this->width >> mip_level, 1u),
+				std::max(this->height >> mip_level, 1u),
+				std::max(this->depth >> mip_level, 1u)
+			);
+		}
+
 		[[nodiscard]] inline u32 layer_count(void) const { return this->subresource_range.layerCount; }
 		[[nodiscard]] inline operator bool(void) const { return format != vk::Format::eUndefined; }
+	private:
+		[[nodiscard]] inline ImageState& _state(u32 layer, u32 mip_level) { return m_States[layer * this->mip_levels() + mip_level]; }
+
+		// layer major, one per level of each layer
+		std::vector<ImageState> m_States;
+
+		friend class BarrierBatch;
 	};
 
-	vk::ImageView CreateImageView(vk::Image img, vk::ImageAspectFlags aspect_mask, vk::Format format, u32 layer_count = 1);
+	vk::ImageView CreateImageView(vk::Image img, vk::ImageAspectFlags aspect_mask, vk::Format format, u32 layer_count = 1, u32 mip_levels = 1);
 }
 
 #endif // NA_DEVICE_IMAGE_HPP
\ No newline at end of file
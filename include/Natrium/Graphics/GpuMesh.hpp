@@ -0,0 +1,61 @@
+#if !defined(NA_GPU_MESH_HPP)
+#define NA_GPU_MESH_HPP
+
+#include "Natrium/Assets/ModelAsset.hpp"
+#include "Natrium/Graphics/Buffers/VertexBuffer.hpp"
+#include "Natrium/Graphics/Buffers/IndexBuffer.hpp"
+
+namespace Na {
+	/// 
+	/// the vertex and index buffers of a ModelAsset with everything needed to draw and cull it,
+	/// so the model itself can be freed once uploaded, see AssetRegistry::load_mesh to share one per path
+	/// 
+	/// the quantized vertices are uploaded if the model has them, draw those with the
+	/// QuantizedVertex binding and dequantization_matrix
+	/// 
+	class GpuMesh : public Asset {
+	public:
+		GpuMesh(void) = default;
+
+		// the upload is submitted with the next flush of the UploadManager
+		GpuMesh(const ModelAsset& model);
+
+		[[nodiscard]] inline const VertexBuffer& vertex_buffer(void) const { return m_VertexBuffer; }
+		[[nodiscard]] inline const IndexBuffer& index_buffer(void) const { return m_IndexBuffer; }
+
+		[[nodiscard]] inline u32 vertex_count(void) const { return m_VertexCount; }
+		// the full mesh, total_index_count spans every level of detail in the index buffer
+		[[nodiscard]] inline u32 index_count(void) const { return m_Lods.empty() ? 0 : m_Lods[0].index_count; }
+		[[nodiscard]] inline u32 total_index_count(void) const { return m_IndexBuffer.count(); }
+		[[nodiscard]] inline vk::IndexType index_type(void) const { return m_IndexBuffer.index_type(); }
+
+		[[nodiscard]] inline bool quantized(void) const { return m_Quantized; }
+		[[nodiscard]] inline const glm::mat4& dequantization_matrix(void) const { return m_DequantizationMatrix; }
+
+		// the same levels as the model, the full mesh is level 0, see Renderer::draw_mesh
+		[[nodiscard]] inline u32 lod_count(void) const { return (u32)m_Lods.size(); }
+		[[nodiscard]] inline const MeshLod& lod(u32 level) const { return m_Lods[level]; }
+
+		[[nodiscard]] inline const BoundingBox& bounds(void) const { return m_Bounds; }
+		[[nodiscard]] inline const BoundingSphere& bounding_sphere(void) const { return m_BoundingSphere; }
+
+		[[nodiscard]] inline operator bool(void) const override { return m_VertexBuffer && m_IndexBuffer; }
+
+		// the buffers are in device memory
+		[[nodiscard]] inline u64 memory_usage(void) const override { return m_Lods.size() * sizeof(MeshLod); }
+	private:
+		VertexBuffer m_VertexBuffer;
+		IndexBuffer m_IndexBuffer;
+		u32 m_VertexCount = 0;
+
+		bool m_Quantized = false;
+		glm::mat4 m_DequantizationMatrix{ 1.0f };
+
+		std::vector<MeshLod> m_Lods;
+
+		BoundingBox m_Bounds;
+		BoundingSphere m_BoundingSphere;
+	};
+} // namespace Na
+
+#endif // NA_GPU_MESH_HPP
\ No newline at end of file
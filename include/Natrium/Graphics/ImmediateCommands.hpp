@@ -0,0 +1,86 @@
+#if !defined(NA_IMMEDIATE_COMMANDS_HPP)
+#define NA_IMMEDIATE_COMMANDS_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	/// 
+	/// recycles command buffers and fences for one-off work on the graphics queue,
+	/// backs VkContext::BeginSingleTimeCommands and ImmediateBatch
+	/// 
+	/// each submission is waited on by its own fence instead of idling the queue
+	/// 
+	/// warning: not thread safe, the command buffers share one pool
+	/// 
+	class ImmediateCommands {
+	public:
+		ImmediateCommands(void) = default;
+		ImmediateCommands(u32 queue_family, vk::Queue queue);
+		void destroy(void);
+		inline ~ImmediateCommands(void) { this->destroy(); }
+
+		ImmediateCommands(const ImmediateCommands& other) = delete;
+		ImmediateCommands& operator=(const ImmediateCommands& other) = delete;
+
+		ImmediateCommands(ImmediateCommands&& other) = delete;
+		ImmediateCommands& operator=(ImmediateCommands&& other) = delete;
+
+		[[nodiscard]] vk::CommandBuffer begin(void);
+
+		/// 
+		/// ends and submits cmd_buffer, blocks until it completed and recycles it
+		/// 
+		void submit(vk::CommandBuffer cmd_buffer);
+
+		[[nodiscard]] inline u64 recording(void) const { return m_Recording.size(); }
+	private:
+		struct Slot {
+			vk::CommandBuffer cmd_buffer;
+			vk::Fence fence;
+		};
+	private:
+		vk::CommandPool m_CmdPool;
+		vk::Queue m_Queue;
+
+		std::vector<Slot> m_Free;
+		std::vector<Slot> m_Recording;
+	};
+
+	/// 
+	/// while alive, every single-time command issued on this thread (transitions, copies,
+	/// mip generation) is recorded into one command buffer, submitted once on submit or
+	/// destruction, e.g. a texture waits once instead of once per step
+	/// 
+	/// a batch opened inside another joins it, resources released while the batch is open
+	/// stay alive until it was submitted
+	/// 
+	/// warning: results are only available after submit
+	/// 
+	class ImmediateBatch {
+	public:
+		ImmediateBatch(void);
+		inline ~ImmediateBatch(void) { this->submit(); }
+
+		ImmediateBatch(const ImmediateBatch& other) = delete;
+		ImmediateBatch& operator=(const ImmediateBatch& other) = delete;
+
+		ImmediateBatch(ImmediateBatch&& other) = delete;
+		ImmediateBatch& operator=(ImmediateBatch&& other) = delete;
+
+		void submit(void);
+
+		[[nodiscard]] inline vk::CommandBuffer cmd_buffer(void) const { return m_CmdBuffer; }
+		[[nodiscard]] inline operator bool(void) const { return m_CmdBuffer; }
+
+		// the innermost open batch of this thread, if any
+		[[nodiscard]] static inline ImmediateBatch* Current(void) { return s_Current; }
+	private:
+		vk::CommandBuffer m_CmdBuffer;
+		ImmediateBatch* m_Outer = nullptr; // joined, submitted by the outermost batch
+		u64 m_Pin = 0;
+
+		static inline thread_local ImmediateBatch* s_Current = nullptr;
+	};
+} // namespace Na
+
+#endif // NA_IMMEDIATE_COMMANDS_HPP
\ No newline at end of file
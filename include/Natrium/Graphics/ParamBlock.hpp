@@ -0,0 +1,105 @@
+#if !defined(NA_PARAM_BLOCK_HPP)
+#define NA_PARAM_BLOCK_HPP
+
+#include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/Buffers/TransientBuffer.hpp"
+
+// checks a member of the C++ mirror against the offset the shader block declares, e.g. with layout(offset = N)
+#define NA_PARAM_OFFSET(type, member, offset) static_assert(offsetof(type, member) == (offset), #type "::" #member " does not match its offset in the shader block!")
+#define NA_PARAM_SIZE(type, size) static_assert(sizeof(type) == (size), #type " does not match the size of the shader block!")
+
+namespace Na {
+	// the smallest maxPushConstantsSize the spec allows, every device supports at least this much
+	inline constexpr u32 k_MinPushConstantSize = 128;
+
+	template<typename T>
+	concept ParamBlockStruct = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>;
+
+	/// 
+	/// throws unless block lies within the reflected range and is visible to the same stages,
+	/// pushes have to name every stage of the range they touch
+	/// 
+	void VerifyPushConstant(const PushConstant& block, const PushConstant& reflected);
+
+	/// 
+	/// a push constant block described by the C++ struct mirroring it, e.g.
+	/// 
+	/// struct ObjectParams { glm::mat4 model; u32 material; u32 flags; glm::vec2 uv_scale; };
+	/// NA_PARAM_OFFSET(ObjectParams, material, 64);
+	/// using ObjectBlock = PushConstantBlock<ObjectParams, ShaderStageBits::Vertex>;
+	/// 
+	/// renderer.set_push_constant<ObjectBlock>(params, pipeline);
+	/// 
+	/// all of an object's parameters go into the one struct, so they are pushed with a single call,
+	/// size and offset are checked at compile time, Verify checks them against a reflected pipeline
+	/// 
+	template<ParamBlockStruct T, ShaderStageBits Stages, u32 Offset = 0>
+	struct PushConstantBlock {
+		static_assert(Stages != ShaderStageBits::None, "Push constant block is not visible to any stage!");
+		static_assert(Offset % 4 == 0, "Push constant offsets have to be a multiple of 4!");
+		static_assert(sizeof(T) % 4 == 0, "Push constant sizes have to be a multiple of 4!");
+		static_assert(Offset + sizeof(T) <= k_MinPushConstantSize, "Push constant block exceeds the 128 bytes every device supports!");
+
+		using Type = T;
+
+		// has static storage, so DrawItem::push_constant may point at it
+		static constexpr PushConstant k_Range{ Stages, (u32)sizeof(T), Offset };
+
+		inline static void Verify(const GraphicsPipeline& pipeline) { VerifyPushConstant(k_Range, pipeline.push_constant()); }
+		inline static void Verify(const ComputePipeline& pipeline) { VerifyPushConstant(k_Range, pipeline.push_constant()); }
+	};
+
+	template<typename T>
+	concept PushConstantBlockType = requires {
+		typename T::Type;
+		{ T::k_Range } -> std::convertible_to<PushConstant>;
+	};
+
+	/// 
+	/// gathers the parameters of many objects so they are uploaded with one allocation,
+	/// e.g. read in the shader as a storage buffer array indexed by gl_InstanceIndex
+	/// or a pushed index instead of pushing every object's parameters
+	/// 
+	/// warning: the array stride in the shader has to be sizeof(T), i.e. pad T to the
+	/// alignment of its largest member under std430 (16 bytes for vec3 and vec4)
+	/// 
+	template<ParamBlockStruct T>
+	class ParamArray {
+	public:
+		static_assert(sizeof(T) % 4 == 0, "Parameter blocks have to be a multiple of 4 bytes!");
+
+		ParamArray(void) = default;
+		inline ParamArray(u64 capacity) { m_Params.reserve(capacity); }
+
+		// returns the index of params in the array
+		inline u32 push(const T& params) { m_Params.push_back(params); return (u32)(m_Params.size() - 1); }
+
+		/// 
+		/// copies every parameter block into one allocation of buffer, returns an invalid allocation
+		/// when the frame's slice is exhausted or there is nothing to upload
+		/// 
+		[[nodiscard]] inline TransientAllocation upload(TransientBuffer& buffer) const
+		{
+			if (m_Params.empty())
+				return {};
+
+			u64 size = m_Params.size() * sizeof(T);
+			NA_ASSERT(size <= buffer.binding_range(), "Parameter array exceeds the binding range of the buffer!");
+
+			TransientAllocation allocation = buffer.allocate(size);
+			if (allocation)
+				memcpy(allocation.mapped, m_Params.data(), size);
+			return allocation;
+		}
+
+		inline void clear(void) { m_Params.clear(); }
+
+		[[nodiscard]] inline std::span<const T> params(void) const { return m_Params; }
+		[[nodiscard]] inline u64 size(void) const { return m_Params.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_Params.empty(); }
+	private:
+		std::vector<T> m_Params;
+	};
+} // namespace Na
+
+#endif // NA_PARAM_BLOCK_HPP
\ No newline at end of file
@@ -3,25 +3,72 @@
 
 #include "Natrium/Graphics/Renderer/RendererCore.hpp"
 #include "Natrium/Assets/ShaderAsset.hpp"
+#include "Natrium/Graphics/DescriptorWriter.hpp"
 
 namespace Na {
 	using PipelineShaderInfos = std::initializer_list<vk::PipelineShaderStageCreateInfo>;
 
+	class ShaderModule;
+	class SpecializationConstants;
+
+	// converts from a plain module, e.g. { &vertex_module, { &fragment_module, &fragment_constants } }
+	struct PipelineShaderStage {
+		inline PipelineShaderStage(const ShaderModule* module, const SpecializationConstants* specialization = nullptr)
+		: module(module), specialization(specialization)
+		{}
+
+		const ShaderModule* module;
+		const SpecializationConstants* specialization;
+	};
+	using PipelineShaderModules = std::initializer_list<PipelineShaderStage>;
+
+	/// 
+	/// the compact types are read as floats (vec2 / vec4) by the shader,
+	/// unorm maps to [0, 1] and snorm to [-1, 1], packed types hold x, y, z in 10 bits and w in 2
+	/// 
+	/// warning: Packed1010102Snorm is not a required vertex format, check the device before using it
+	/// 
 	enum class ShaderAttributeType : u32 {
-		None  = (u32)vk::Format::eUndefined,
-		Float = (u32)vk::Format::eR32Sfloat,
-		Vec2  = (u32)vk::Format::eR32G32Sfloat,
-		Vec3  = (u32)vk::Format::eR32G32B32Sfloat,
-		Vec4  = (u32)vk::Format::eR32G32B32A32Sfloat
+		None               = (u32)vk::Format::eUndefined,
+		Float              = (u32)vk::Format::eR32Sfloat,
+		Vec2               = (u32)vk::Format::eR32G32Sfloat,
+		Vec3               = (u32)vk::Format::eR32G32B32Sfloat,
+		Vec4               = (u32)vk::Format::eR32G32B32A32Sfloat,
+
+		Half2              = (u32)vk::Format::eR16G16Sfloat,
+		Half4              = (u32)vk::Format::eR16G16B16A16Sfloat,
+
+		Byte4Unorm         = (u32)vk::Format::eR8G8B8A8Unorm,
+		Byte4Snorm         = (u32)vk::Format::eR8G8B8A8Snorm,
+		Short2Unorm        = (u32)vk::Format::eR16G16Unorm,
+		Short2Snorm        = (u32)vk::Format::eR16G16Snorm,
+		Short4Unorm        = (u32)vk::Format::eR16G16B16A16Unorm,
+		Short4Snorm        = (u32)vk::Format::eR16G16B16A16Snorm,
+
+		Packed1010102Unorm = (u32)vk::Format::eA2B10G10R10UnormPack32,
+		Packed1010102Snorm = (u32)vk::Format::eA2B10G10R10SnormPack32
 	};
 	inline u32 SizeOf(ShaderAttributeType type)
 	{
 		switch (type)
 		{
-		case ShaderAttributeType::Float:  return sizeof(float);
-		case ShaderAttributeType::Vec2:   return sizeof(float) * 2;
-		case ShaderAttributeType::Vec3:   return sizeof(float) * 3;
-		case ShaderAttributeType::Vec4:   return sizeof(float) * 4;
+		case ShaderAttributeType::Float:              return sizeof(float);
+		case ShaderAttributeType::Vec2:               return sizeof(float) * 2;
+		case ShaderAttributeType::Vec3:               return sizeof(float) * 3;
+		case ShaderAttributeType::Vec4:               return sizeof(float) * 4;
+
+		case ShaderAttributeType::Half2:              return sizeof(u16) * 2;
+		case ShaderAttributeType::Half4:              return sizeof(u16) * 4;
+
+		case ShaderAttributeType::Byte4Unorm:         return sizeof(u8) * 4;
+		case ShaderAttributeType::Byte4Snorm:         return sizeof(u8) * 4;
+		case ShaderAttributeType::Short2Unorm:        return sizeof(u16) * 2;
+		case ShaderAttributeType::Short2Snorm:        return sizeof(u16) * 2;
+		case ShaderAttributeType::Short4Unorm:        return sizeof(u16) * 4;
+		case ShaderAttributeType::Short4Snorm:        return sizeof(u16) * 4;
+
+		case ShaderAttributeType::Packed1010102Unorm: return sizeof(u32);
+		case ShaderAttributeType::Packed1010102Snorm: return sizeof(u32);
 		}
 		return 0;
 	}
@@ -69,15 +116,114 @@ namespace Na {
 	};
 	using PushConstantLayout = std::initializer_list<PushConstant>;
 
+	enum class BlendMode : u8 {
+		Opaque = 0,
+		Alpha, // src * a + dst * (1 - a)
+		Additive, // src * a + dst
+		Premultiplied // src + dst * (1 - a)
+	};
+
+	/// 
+	/// fixed function state of a GraphicsPipeline, the defaults match what every
+	/// pipeline used before, i.e. opaque back face culled triangle lists with depth testing
+	/// 
+	struct PipelineState {
+		vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+		bool primitive_restart = false;
+
+		vk::PolygonMode polygon_mode = vk::PolygonMode::eFill; // anything else requires fillModeNonSolid
+		vk::CullModeFlags cull_mode = vk::CullModeFlagBits::eBack;
+		vk::FrontFace front_face = vk::FrontFace::eCounterClockwise;
+		float line_width = 1.0f; // anything else requires wideLines
+
+		BlendMode blend = BlendMode::Opaque; // applies to every color attachment
+
+		bool depth_test = true;
+		bool depth_write = true;
+		vk::CompareOp depth_compare = vk::CompareOp::eLess;
+
+		// the fraction of samples shaded individually with msaa, e.g. to smooth alpha tested edges,
+		// 0 shades once per pixel
+		float min_sample_shading = 0.0f;
+
+		// set 0 is VkContext::GetBindlessTable instead of the uniform layout, which has to be empty
+		bool bindless = false;
+
+		[[nodiscard]] bool operator==(const PipelineState& other) const = default;
+	};
+
+	class TransientBuffer;
+
+	using PipelineBuilder = std::function<void(void)>;
+
+	/// 
+	/// runs the builders as up to thread_count jobs (0 uses every JobSystem worker and the caller),
+	/// each one constructs pipelines, e.g. [&]{ pipeline = GraphicsPipeline(renderer_core, ...); }
+	/// driver compilation then overlaps, the context's pipeline cache is shared between them
+	/// 
+	/// rethrows the first exception once every builder finished
+	/// 
+	void BuildPipelines(const PipelineBuilder* builders, u64 count, u32 thread_count = 0);
+	inline void BuildPipelines(const std::initializer_list<PipelineBuilder>& builders, u32 thread_count = 0) { BuildPipelines(builders.begin(), builders.size(), thread_count); }
+
+	/// 
+	/// the render pass a GraphicsPipeline is used in, e.g. RenderGraphPass::target
+	/// 
+	/// without a render pass the pipeline is created for dynamic rendering
+	/// against the attachment formats instead, every color attachment shares color_format
+	/// 
+	struct GraphicsPipelineTarget {
+		vk::RenderPass render_pass = nullptr;
+		vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+		u32 color_attachment_count = 1;
+
+		vk::Format color_format = vk::Format::eUndefined;
+		vk::Format depth_format = vk::Format::eUndefined;
+	};
+
 	class GraphicsPipeline {
 	public:
 		GraphicsPipeline(void) = default;
+
+		// targets the renderer core's render pass, or its attachment formats with dynamic rendering
 		GraphicsPipeline(
 			RendererCore& renderer_core,
 			const PipelineShaderInfos& handles = {},
 			const ShaderAttributeLayout& vertex_buffer_layout = {},
 			const ShaderUniformLayout& uniform_data_layout = {},
-			const PushConstantLayout& push_constant_layout = {}
+			const PushConstantLayout& push_constant_layout = {},
+			const PipelineState& state = {}
+		);
+		GraphicsPipeline(
+			const RendererSettings& renderer_settings,
+			const GraphicsPipelineTarget& target,
+			const PipelineShaderInfos& handles = {},
+			const ShaderAttributeLayout& vertex_buffer_layout = {},
+			const ShaderUniformLayout& uniform_data_layout = {},
+			const PushConstantLayout& push_constant_layout = {},
+			const PipelineState& state = {}
+		);
+
+		/// 
+		/// uniform and push constant layouts come from the modules' reflection,
+		/// bindings shared by several stages are visible to all of them and the push constant
+		/// blocks are merged into one range, see push_constant
+		/// 
+		/// vertex inputs are packed into binding 0 in location order unless vertex_buffer_layout is given,
+		/// e.g. for instanced attributes
+		/// 
+		GraphicsPipeline(
+			RendererCore& renderer_core,
+			const PipelineShaderModules& shader_modules,
+			const PipelineState& state = {},
+			const ShaderAttributeLayout& vertex_buffer_layout = {}
+		);
+		GraphicsPipeline(
+			const RendererSettings& renderer_settings,
+			const GraphicsPipelineTarget& target,
+			const PipelineShaderModules& shader_modules,
+			const PipelineState& state = {},
+			const ShaderAttributeLayout& vertex_buffer_layout = {}
 		);
 		void destroy(void);
 		inline ~GraphicsPipeline(void) { this->destroy(); }
@@ -93,7 +239,35 @@ namespace Na {
 		/// uniforms not being bound with the order specified via the constructor is undefined behaviour
 		/// 
 		template<typename T>
-		inline void bind_uniform(u32 binding, const T& uniform) { this->_bind_uniform(binding, &uniform); }
+		inline void bind_uniform(u32 binding, const T& uniform) { DescriptorWriter writer; this->_bind_uniform(writer, binding, &uniform); }
+
+		/// 
+		/// the dynamic offset of a transient buffer changes per allocation,
+		/// so it has to be passed to Renderer::bind_pipeline together with the other dynamic offsets
+		/// 
+		inline void bind_uniform(u32 binding, const TransientBuffer& transient_buffer) { DescriptorWriter writer; this->bind_uniform(writer, binding, transient_buffer); }
+
+		/// 
+		/// queues the write instead, the dynamic offsets are still assigned in call order
+		/// 
+		template<typename T>
+		inline void bind_uniform(DescriptorWriter& writer, u32 binding, const T& uniform) { this->_bind_uniform(writer, binding, &uniform); }
+		void bind_uniform(DescriptorWriter& writer, u32 binding, const TransientBuffer& transient_buffer);
+
+		/// 
+		/// writes into a set allocated with this pipeline's descriptor layout,
+		/// e.g. by Renderer::allocate_descriptor_set, instead of the pipeline's own set
+		/// 
+		/// dynamic offsets of buffers written this way are passed to Renderer::bind_pipeline with the set
+		/// 
+		template<typename T>
+		inline void write_uniform(vk::DescriptorSet descriptor_set, u32 binding, const T& uniform) const { DescriptorWriter writer; this->_write_uniform(writer, descriptor_set, binding, &uniform); }
+		inline void write_uniform(vk::DescriptorSet descriptor_set, u32 binding, const TransientBuffer& transient_buffer) const { DescriptorWriter writer; this->write_uniform(writer, descriptor_set, binding, transient_buffer); }
+
+		// queued, e.g. every material of a scene flushed with one call
+		template<typename T>
+		inline void write_uniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const T& uniform) const { this->_write_uniform(writer, descriptor_set, binding, &uniform); }
+		void write_uniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const TransientBuffer& transient_buffer) const;
 
 		[[nodiscard]] inline vk::Pipeline pipeline(void) const { return m_Pipeline; }
 
@@ -109,9 +283,104 @@ namespace Na {
 		[[nodiscard]] inline u32 dynamic_offset_index(void) const { return m_DynamicOffsetIndex; }
 		inline void increment_dynamic_offset_index(void) { m_DynamicOffsetIndex++; }
 
+		// the descriptor set is the bindless table's, which the pipeline does not own
+		[[nodiscard]] inline bool bindless(void) const { return m_Bindless; }
+
+		// the merged range of reflected pipelines, to be passed to Renderer::set_push_constant
+		[[nodiscard]] inline const PushConstant& push_constant(void) const { return m_PushConstant; }
+
+		[[nodiscard]] inline operator bool(void) const { return m_Pipeline; }
+	private:
+		void _create(
+			const RendererSettings& renderer_settings,
+			const GraphicsPipelineTarget& target,
+			std::span<const vk::PipelineShaderStageCreateInfo> shader_infos,
+			std::span<const vk::VertexInputBindingDescription> binding_descriptions,
+			std::span<const vk::VertexInputAttributeDescription> attribute_descriptions,
+			std::span<const ShaderUniform> uniforms,
+			std::span<const PushConstant> push_constants,
+			const PipelineState& state
+		);
+		void _bind_uniform(DescriptorWriter& writer, u32 binding, const void* uniform);
+		void _write_uniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const void* uniform) const;
+	private:
+		vk::Pipeline m_Pipeline;
+		bool m_Bindless = false;
+
+		vk::DescriptorSetLayout m_DescriptorLayout;
+		vk::PipelineLayout m_Layout;
+
+		vk::DescriptorPool m_DescriptorPool;
+		vk::DescriptorSet m_DescriptorSet;
+
+		ArrayList<u32> m_DynamicOffsets;
+		u32 m_DynamicOffsetCount = 0;
+		u32 m_DynamicOffsetIndex = 0;
+
+		PushConstant m_PushConstant{ ShaderStageBits::None, 0, 0 };
+	};
+
+	/// 
+	/// dispatched through Renderer::dispatch, outside of the render pass
+	/// uniforms and push constants are described and bound like with GraphicsPipeline
+	/// 
+	class ComputePipeline {
+	public:
+		ComputePipeline(void) = default;
+		ComputePipeline(
+			const RendererSettings& renderer_settings,
+			const vk::PipelineShaderStageCreateInfo& shader_info,
+			const ShaderUniformLayout& uniform_data_layout = {},
+			const PushConstantLayout& push_constant_layout = {}
+		);
+
+		// layouts come from the module's reflection
+		ComputePipeline(const RendererSettings& renderer_settings, const ShaderModule& shader_module, const SpecializationConstants* specialization = nullptr);
+		void destroy(void);
+		inline ~ComputePipeline(void) { this->destroy(); }
+
+		ComputePipeline(const ComputePipeline& other) = delete;
+		ComputePipeline& operator=(const ComputePipeline& other) = delete;
+
+		ComputePipeline(ComputePipeline&& other);
+		ComputePipeline& operator=(ComputePipeline&& other);
+
+		/// 
+		/// warning:
+		/// uniforms not being bound with the order specified via the constructor is undefined behaviour
+		/// 
+		template<typename T>
+		inline void bind_uniform(u32 binding, const T& uniform) { DescriptorWriter writer; this->_bind_uniform(writer, binding, &uniform); }
+		inline void bind_uniform(u32 binding, const TransientBuffer& transient_buffer) { DescriptorWriter writer; this->bind_uniform(writer, binding, transient_buffer); }
+
+		template<typename T>
+		inline void bind_uniform(DescriptorWriter& writer, u32 binding, const T& uniform) { this->_bind_uniform(writer, binding, &uniform); }
+		void bind_uniform(DescriptorWriter& writer, u32 binding, const TransientBuffer& transient_buffer);
+
+		[[nodiscard]] inline vk::Pipeline pipeline(void) const { return m_Pipeline; }
+
+		[[nodiscard]] inline vk::DescriptorSetLayout descriptor_layout(void) const { return m_DescriptorLayout; }
+		[[nodiscard]] inline vk::PipelineLayout layout(void) const { return m_Layout; }
+
+		[[nodiscard]] inline vk::DescriptorPool descriptor_pool(void) const { return m_DescriptorPool; }
+		[[nodiscard]] inline const vk::DescriptorSet& descriptor_set(void) const { return m_DescriptorSet; }
+
+		[[nodiscard]] inline ArrayList<u32>& dynamic_offsets(void) { return m_DynamicOffsets; }
+		[[nodiscard]] inline const ArrayList<u32>& dynamic_offsets(void) const { return m_DynamicOffsets; }
+		[[nodiscard]] inline u32 dynamic_offset_count(void) const { return m_DynamicOffsetCount; }
+
+		// the reflected range, shader_stage is None for hand written layouts
+		[[nodiscard]] inline const PushConstant& push_constant(void) const { return m_PushConstant; }
+
 		[[nodiscard]] inline operator bool(void) const { return m_Pipeline; }
 	private:
-		void _bind_uniform(u32 binding, const void* uniform);
+		void _create(
+			const RendererSettings& renderer_settings,
+			const vk::PipelineShaderStageCreateInfo& shader_info,
+			std::span<const ShaderUniform> uniform_data_layout,
+			std::span<const PushConstant> push_constant_layout
+		);
+		void _bind_uniform(DescriptorWriter& writer, u32 binding, const void* uniform);
 	private:
 		vk::Pipeline m_Pipeline;
 
@@ -124,6 +393,8 @@ namespace Na {
 		ArrayList<u32> m_DynamicOffsets;
 		u32 m_DynamicOffsetCount = 0;
 		u32 m_DynamicOffsetIndex = 0;
+
+		PushConstant m_PushConstant{ ShaderStageBits::None, 0, 0 };
 	};
 } // namespace Na
 
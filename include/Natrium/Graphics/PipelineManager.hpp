@@ -0,0 +1,76 @@
+#if !defined(NA_PIPELINE_MANAGER_HPP)
+#define NA_PIPELINE_MANAGER_HPP
+
+#include "Natrium/Graphics/Pipeline.hpp"
+
+namespace Na {
+	using PipelineHandle = std::shared_ptr<GraphicsPipeline>;
+
+	/// 
+	/// hands out one shared GraphicsPipeline per distinct description, i.e. shaders
+	/// (SPIR-V, stage, entry point and specialization), vertex layout, uniform layout,
+	/// push constants, fixed function state, target and frames in flight
+	/// 
+	/// the modules have to be ShaderModules created from a ShaderBinary, see ShaderModule::FindBinaryHash
+	/// 
+	/// warning:
+	/// uniforms belong to the pipeline's descriptor set, so everything sharing a pipeline
+	/// also shares what is bound through GraphicsPipeline::bind_uniform
+	/// 
+	class PipelineManager {
+	public:
+		PipelineManager(void) = default;
+		inline ~PipelineManager(void) { this->clear(); }
+
+		PipelineManager(const PipelineManager& other) = delete;
+		PipelineManager& operator=(const PipelineManager& other) = delete;
+
+		PipelineManager(PipelineManager&& other) = delete;
+		PipelineManager& operator=(PipelineManager&& other) = delete;
+
+		/// 
+		/// builds the pipeline on a miss, safe to call from multiple threads,
+		/// e.g. from BuildPipelines
+		/// 
+		[[nodiscard]] PipelineHandle get(
+			RendererCore& renderer_core,
+			const PipelineShaderInfos& shader_infos,
+			const ShaderAttributeLayout& vertex_buffer_layout = {},
+			const ShaderUniformLayout& uniform_data_layout = {},
+			const PushConstantLayout& push_constant_layout = {},
+			const PipelineState& state = {}
+		);
+		[[nodiscard]] PipelineHandle get(
+			const RendererSettings& renderer_settings,
+			const GraphicsPipelineTarget& target,
+			const PipelineShaderInfos& shader_infos,
+			const ShaderAttributeLayout& vertex_buffer_layout = {},
+			const ShaderUniformLayout& uniform_data_layout = {},
+			const PushConstantLayout& push_constant_layout = {},
+			const PipelineState& state = {}
+		);
+
+		/// 
+		/// destroys every pipeline only the manager still refers to, returns how many
+		/// warning: the pipelines must not be used by a frame that is still in flight
+		/// 
+		u64 release_unused(void);
+
+		void clear(void);
+
+		[[nodiscard]] inline u64 size(void) const { std::lock_guard lock(m_Mutex); return m_Pipelines.size(); }
+
+		// lookups that found an existing pipeline / had to build one
+		[[nodiscard]] inline u64 hits(void) const { return m_Hits; }
+		[[nodiscard]] inline u64 misses(void) const { return m_Misses; }
+	private:
+		// the description serialized field by field, compared as a whole so there are no false hits
+		std::unordered_map<std::string, PipelineHandle> m_Pipelines;
+		mutable std::mutex m_Mutex;
+
+		std::atomic<u64> m_Hits = 0;
+		std::atomic<u64> m_Misses = 0;
+	};
+} // namespace Na
+
+#endif // NA_PIPELINE_MANAGER_HPP
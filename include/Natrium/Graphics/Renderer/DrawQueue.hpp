@@ -0,0 +1,145 @@
+#if !defined(NA_DRAW_QUEUE_HPP)
+#define NA_DRAW_QUEUE_HPP
+
+#include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/Buffers/VertexBuffer.hpp"
+#include "Natrium/Graphics/Buffers/IndexBuffer.hpp"
+#include "Natrium/Graphics/Buffers/GeometryPool.hpp"
+#include "Natrium/Graphics/Culling.hpp"
+
+namespace Na {
+	class Renderer;
+
+	struct DrawItem {
+		const GraphicsPipeline* pipeline = nullptr;
+		const VertexBuffer* vertex_buffer = nullptr;
+		const IndexBuffer* index_buffer = nullptr; // draws vertex_count vertices if null
+
+		u32 vertex_count = 0; // ignored for indexed draws
+
+		// a range of the index buffer, e.g. a MeshLod, 0 indices draw the rest of it
+		u32 first_index = 0;
+		u32 index_count = 0;
+
+		// replaces the buffers and ranges above, draws of the same pool share their binds
+		const GeometryPool* geometry_pool = nullptr;
+		GeometryAllocation geometry;
+
+		u32 instance_count = 1;
+		u32 first_instance = 0; // ignored with instance data
+
+		// instance_count * instance_stride bytes, copied on submit and bound at Renderer::k_InstanceBinding,
+		// opaque draws of the same geometry with instance data become a single instanced draw
+		const void* instance_data = nullptr;
+		u32 instance_stride = 0;
+
+		float depth = 0.0f; // view space distance, opaque draws go front to back
+		bool translucent = false; // drawn after every opaque draw, back to front
+
+		// world space, e.g. ModelAsset::bounding_sphere transformed by the model matrix,
+		// tested by DrawQueue::cull, the default is never culled
+		BoundingSphere bounds;
+
+		// e.g. &PushConstantBlock::k_Range, pushes repeating the last one's bytes are skipped
+		const PushConstant* push_constant = nullptr;
+		const void* push_data = nullptr; // copied on submit
+	};
+
+	struct DrawQueueStats {
+		u32 draws = 0; // submitted
+		u32 draw_calls = 0; // recorded after merging
+		u32 pipeline_binds = 0;
+		u32 vertex_buffer_binds = 0;
+		u32 index_buffer_binds = 0;
+		u32 instance_binds = 0;
+		u32 push_constants = 0; // recorded, redundant ones are not
+		u32 culled = 0; // by cull, not counted in draws
+	};
+
+	/// 
+	/// collects draws during the frame and records them sorted by a 64 bit key,
+	/// opaque: [pipeline | vertex buffer | depth], translucent: [inverted depth | pipeline | vertex buffer]
+	/// 
+	/// pipelines own their descriptor set, so sorting by pipeline groups descriptor sets as well
+	/// binds that match the previously recorded state are skipped and consecutive draws of the
+	/// same geometry without push constants whose instance ranges touch are merged into one,
+	/// a push of the same range and bytes as the last one under the same layout is skipped
+	/// 
+	/// opaque draws with instance data sort by their geometry in place of depth, their instances
+	/// are gathered into Renderer::allocate_instances at flush and drawn with one call
+	/// 
+	/// warning: not thread safe, submit from the thread that calls Renderer::end_frame
+	/// 
+	class DrawQueue {
+	public:
+		void submit(const DrawItem& item);
+
+		/// 
+		/// drops every submitted draw whose bounds are outside of frustum before anything is recorded,
+		/// the bounds are tested in batches, see FrustumCuller, returns how many draws were dropped
+		/// 
+		/// calling it again with another frustum (e.g. a shadow cascade) keeps what is inside of both
+		/// 
+		u32 cull(const Frustum& frustum);
+
+		/// 
+		/// records every submitted draw into cmd_buffer and clears the queue,
+		/// has to be called inside the render pass
+		/// 
+		void flush(Renderer& renderer, vk::CommandBuffer cmd_buffer);
+
+		void clear(void);
+
+		[[nodiscard]] inline bool empty(void) const { return m_Draws.empty(); }
+		[[nodiscard]] inline u64 size(void) const { return m_Draws.size(); }
+
+		// of the last flush
+		[[nodiscard]] inline const DrawQueueStats& stats(void) const { return m_Stats; }
+	private:
+		struct Draw {
+			const GraphicsPipeline* pipeline;
+			vk::Buffer vertex_buffer;
+			vk::Buffer index_buffer;
+			vk::IndexType index_type;
+
+			u32 count; // indices or vertices
+			u32 first_index;
+			i32 vertex_offset;
+			u32 instance_count;
+			u32 first_instance;
+
+			const PushConstant* push_constant;
+			u32 push_data_offset;
+
+			u32 instance_stride; // 0 without instance data
+			u32 instance_data_offset;
+		};
+
+		struct SortEntry {
+			u64 key;
+			u32 draw_index;
+		};
+
+		static u16 _key_index(std::unordered_map<const void*, u16>& indices, const void* handle, u16 max_index);
+	private:
+		ArrayList<Draw> m_Draws;
+		ArrayList<SortEntry> m_Entries;
+		ArrayList<Byte> m_PushData;
+		ArrayList<Byte> m_InstanceData;
+
+		// the draws with bounds, in submission order
+		FrustumCuller m_Culler;
+		ArrayList<u32> m_BoundedDraws;
+		ArrayList<u8> m_Visible;
+		u32 m_CulledCount = 0;
+
+		// order of first submission this frame, used in place of the handles in keys
+		std::unordered_map<const void*, u16> m_PipelineIndices;
+		std::unordered_map<const void*, u16> m_VertexBufferIndices;
+		std::unordered_map<u64, u32> m_GeometryIndices; // of draws with instance data
+
+		DrawQueueStats m_Stats;
+	};
+} // namespace Na
+
+#endif // NA_DRAW_QUEUE_HPP
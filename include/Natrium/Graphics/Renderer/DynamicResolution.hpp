@@ -0,0 +1,102 @@
+#if !defined(NA_DYNAMIC_RESOLUTION_HPP)
+#define NA_DYNAMIC_RESOLUTION_HPP
+
+#include "Natrium/Graphics/Renderer/Renderer.hpp"
+
+namespace Na {
+	struct DynamicResolutionInfo {
+		// milliseconds of gpu time per frame the scale is picked for, e.g. 1000 / 60
+		double target_frame_time = 1000.0 / 60.0;
+
+		// of the core's width and height
+		float min_scale = 0.5f;
+		float max_scale = 1.0f;
+
+		// the scale changes in multiples of it, so noise in the timings does not resize every frame
+		float scale_step = 1.0f / 32.0f;
+
+		// how much the scale may grow per report, it shrinks at once if the frame is too slow
+		float max_growth = 1.0f / 16.0f;
+
+		// reports averaged, more react slower but steadier
+		u32 history = 8;
+
+		// of the scene target, the core itself does not multisample with upscaling
+		vk::Format depth_format = vk::Format::eD32Sfloat;
+		vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+	};
+
+	/// 
+	/// renders the scene into an offscreen target at a fraction of the core's resolution,
+	/// picked from the GpuProfiler's frame timings to hold DynamicResolutionInfo::target_frame_time,
+	/// and upscales it into the core's image, requires RendererSettings::upscaling and
+	/// RendererSettings::gpu_profiler_scopes, without timings the scale stays at max_scale
+	/// 
+	/// the target is allocated at max_scale once and rendered to partially, so changing the
+	/// scale never reallocates, only resizing the core does
+	/// 
+	/// timings assume the whole frame scales with the pixel count, which overestimates fixed costs
+	/// and errs on the side of a lower scale
+	/// 
+	class DynamicResolution {
+	public:
+		DynamicResolution(void) = default;
+		DynamicResolution(RendererCore& core, const DynamicResolutionInfo& info = {});
+		inline void destroy(void) { m_Target.destroy(); }
+		inline ~DynamicResolution(void) { this->destroy(); }
+
+		DynamicResolution(const DynamicResolution& other) = delete;
+		DynamicResolution& operator=(const DynamicResolution& other) = delete;
+
+		DynamicResolution(DynamicResolution&& other) = default;
+		DynamicResolution& operator=(DynamicResolution&& other) = default;
+
+		/// 
+		/// picks this frame's scale and starts the target's render pass in the renderer's
+		/// pre-pass command buffer, the viewport and scissor cover extent()
+		/// 
+		vk::CommandBuffer begin(Renderer& renderer, const glm::vec4& clear_color = Colors::k_Black);
+
+		// ends the target's render pass and upscales it into the core's image
+		void end(Renderer& renderer);
+
+		[[nodiscard]] inline float scale(void) const { return m_Scale; }
+		[[nodiscard]] inline vk::Extent2D extent(void) const { return m_Extent; }
+
+		// average milliseconds per frame at full resolution, 0 before the first report
+		[[nodiscard]] inline double full_frame_time(void) const { return m_FullFrameTime; }
+
+		[[nodiscard]] inline const RenderTarget& target(void) const { return m_Target; }
+
+		// pipelines drawing the scene have to be created with it, the size of the target does not matter to them
+		[[nodiscard]] inline GraphicsPipelineTarget pipeline_target(void) const { return m_Target.target(); }
+
+		[[nodiscard]] inline const DynamicResolutionInfo& info(void) const { return m_Info; }
+		[[nodiscard]] inline operator bool(void) const { return m_Core; }
+	private:
+		// the frames whose scale is remembered until their report arrives, more than frames in flight
+		static constexpr u32 k_ScaleHistory = 16;
+
+		void _create_target(void);
+
+		// feeds the report of a completed frame into the history and picks the next scale
+		void _update(const GpuFrameReport& report);
+		[[nodiscard]] vk::Extent2D _scaled(float scale) const;
+	private:
+		RendererCore* m_Core = nullptr;
+		DynamicResolutionInfo m_Info;
+
+		RenderTarget m_Target;
+
+		float m_Scale = 1.0f;
+		vk::Extent2D m_Extent;
+
+		std::array<float, k_ScaleHistory> m_FrameScales{}; // [frame % k_ScaleHistory]
+		std::vector<double> m_FrameTimes; // full resolution milliseconds, ring of info.history
+		u32 m_FrameTimeCount = 0;
+		double m_FullFrameTime = 0.0;
+		u64 m_LastReport = k_U64Max;
+	};
+} // namespace Na
+
+#endif // NA_DYNAMIC_RESOLUTION_HPP
\ No newline at end of file
@@ -0,0 +1,113 @@
+#if !defined(NA_GPU_PROFILER_HPP)
+#define NA_GPU_PROFILER_HPP
+
+#include "Natrium/Core.hpp"
+
+namespace Na {
+	using GpuScope = u32;
+	constexpr GpuScope k_NullGpuScope = k_U32Max;
+
+	// in the order vulkan writes them
+	struct GpuPipelineStatistics {
+		u64 input_vertices = 0;
+		u64 input_primitives = 0;
+		u64 vertex_invocations = 0;
+		u64 clipping_primitives = 0; // primitives that made it to rasterization
+		u64 fragment_invocations = 0;
+		u64 compute_invocations = 0;
+	};
+
+	struct GpuScopeTiming {
+		std::string name;
+		double start = 0.0; // milliseconds since the frame started on the gpu
+		double duration = 0.0; // milliseconds
+
+		bool has_statistics = false;
+		GpuPipelineStatistics statistics;
+	};
+
+	struct GpuFrameReport {
+		u64 frame = 0; // number of frames submitted before the reported one
+		double duration = 0.0; // milliseconds from the start of the pre-pass to the end of the frame
+		std::vector<GpuScopeTiming> scopes; // in begin order, scopes that never ended are left out
+		u32 dropped_scopes = 0; // begun after max_scopes was reached
+	};
+
+	/// 
+	/// writes timestamp (and optionally pipeline statistics) queries around named scopes,
+	/// each frame in flight has its own query pools, read back once the frame's fence signaled
+	/// so the cpu never waits on them, i.e. the report lags max_frames_in_flight frames behind
+	/// 
+	/// scopes can be recorded into the renderer's pre-pass, primary and secondary command buffers,
+	/// the compute command buffer is submitted before the pools are reset and can not be profiled
+	/// 
+	/// warning: scopes collecting statistics must not nest within the same command buffer
+	/// 
+	class GpuProfiler {
+	public:
+		static constexpr u32 k_DefaultMaxScopes = 256;
+
+		GpuProfiler(void) = default;
+		GpuProfiler(u32 frame_count, u32 max_scopes = k_DefaultMaxScopes, bool pipeline_statistics = false);
+		void destroy(void);
+		inline ~GpuProfiler(void) { this->destroy(); }
+
+		GpuProfiler(const GpuProfiler& other) = delete;
+		GpuProfiler& operator=(const GpuProfiler& other) = delete;
+
+		GpuProfiler(GpuProfiler&& other);
+		GpuProfiler& operator=(GpuProfiler&& other);
+
+		/// 
+		/// reads back what was last recorded for frame_index, its fence has to have signaled,
+		/// returns true if report() changed
+		/// 
+		bool resolve(u32 frame_index);
+
+		/// 
+		/// both called by the Renderer, cmd_buffer of begin_frame has to be outside of a render pass
+		/// and submitted before anything else that records scopes
+		/// 
+		void begin_frame(vk::CommandBuffer cmd_buffer, u32 frame_index, u64 frame);
+		void end_frame(vk::CommandBuffer cmd_buffer);
+
+		/// 
+		/// safe to call from worker threads, the scope has to end in the same command buffer,
+		/// statistics are ignored unless the profiler collects pipeline statistics
+		/// 
+		[[nodiscard]] GpuScope begin_scope(vk::CommandBuffer cmd_buffer, std::string_view name, bool statistics = false);
+		void end_scope(vk::CommandBuffer cmd_buffer, GpuScope scope);
+
+		[[nodiscard]] inline const GpuFrameReport& report(void) const { return m_Report; }
+
+		[[nodiscard]] inline bool enabled(void) const { return !m_Frames.empty(); }
+		[[nodiscard]] inline bool pipeline_statistics(void) const { return m_PipelineStatistics; }
+		[[nodiscard]] inline u32 max_scopes(void) const { return m_MaxScopes; }
+	private:
+		struct FrameQueries {
+			vk::QueryPool timestamps = nullptr; // two per scope, the first two belong to the frame itself
+			vk::QueryPool statistics = nullptr; // one per scope, only with pipeline statistics
+
+			std::vector<std::string> names; // [scope]
+			std::vector<u8> has_statistics; // [scope]
+			std::atomic<u32> scope_count = 0; // including the frame
+
+			u64 frame = 0;
+			bool recorded = false;
+		};
+	private:
+		std::vector<FrameQueries> m_Frames;
+		u32 m_FrameIndex = 0;
+
+		u32 m_MaxScopes = 0;
+		bool m_PipelineStatistics = false;
+
+		double m_TimestampPeriod = 1.0; // nanoseconds per tick
+		u64 m_TimestampMask = k_U64Max;
+
+		GpuFrameReport m_Report;
+		std::vector<u64> m_Results; // readback scratch
+	};
+} // namespace Na
+
+#endif // NA_GPU_PROFILER_HPP
@@ -0,0 +1,205 @@
+#if !defined(NA_RENDER_GRAPH_HPP)
+#define NA_RENDER_GRAPH_HPP
+
+#include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
+#include "Natrium/Graphics/Colors.hpp"
+
+namespace Na {
+	using RenderGraphImage = u32;
+	constexpr RenderGraphImage k_NullRenderGraphImage = k_U32Max;
+
+	enum class RenderGraphAccess : u8 {
+		ColorAttachment = 0, // write
+		DepthAttachment, // write
+		Sampled, // read
+		StorageRead, // read
+		StorageWrite // write
+	};
+
+	enum class RenderGraphPassType : u8 {
+		Graphics = 0, // records inside a render pass made of its attachments
+		Compute
+	};
+
+	struct RenderGraphImageInfo {
+		vk::Extent2D extent;
+		vk::Format format = vk::Format::eUndefined;
+		vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+	};
+
+	class RenderGraph;
+
+	class RenderGraphPass {
+	public:
+		using Callback = std::function<void(vk::CommandBuffer cmd_buffer)>;
+
+		/// 
+		/// without clearing, the attachment is loaded and thus read as well
+		/// 
+		RenderGraphPass& color(RenderGraphImage image, const glm::vec4& clear_color = Colors::k_Black, bool clear = true);
+		RenderGraphPass& depth(RenderGraphImage image, float clear_depth = 1.0f, bool clear = true);
+
+		inline RenderGraphPass& sample(RenderGraphImage image) { return this->_use(image, RenderGraphAccess::Sampled); }
+		inline RenderGraphPass& storage_read(RenderGraphImage image) { return this->_use(image, RenderGraphAccess::StorageRead); }
+		inline RenderGraphPass& storage_write(RenderGraphImage image) { return this->_use(image, RenderGraphAccess::StorageWrite); }
+
+		// never culled, e.g. passes that write buffers the graph does not know about
+		inline RenderGraphPass& side_effect(void) { m_SideEffect = true; return *this; }
+
+		/// 
+		/// pipelines drawing in this pass have to be created with this target,
+		/// only valid after RenderGraph::compile
+		/// 
+		[[nodiscard]] GraphicsPipelineTarget target(void) const;
+
+		[[nodiscard]] inline const std::string& name(void) const { return m_Name; }
+		[[nodiscard]] inline RenderGraphPassType type(void) const { return m_Type; }
+		[[nodiscard]] inline bool culled(void) const { return m_Culled; }
+	private:
+		friend class RenderGraph;
+
+		struct Use {
+			RenderGraphImage image;
+			RenderGraphAccess access;
+			bool clear = false;
+			vk::ClearValue clear_value{};
+		};
+
+		RenderGraphPass& _use(RenderGraphImage image, RenderGraphAccess access);
+	private:
+		std::string m_Name;
+		RenderGraphPassType m_Type = RenderGraphPassType::Graphics;
+		Callback m_Callback;
+
+		std::vector<Use> m_Uses;
+		bool m_SideEffect = false;
+
+		// compiled
+		bool m_Culled = true;
+		vk::RenderPass m_RenderPass = nullptr;
+		vk::Framebuffer m_Framebuffer = nullptr;
+		vk::Extent2D m_Extent;
+		vk::SampleCountFlagBits m_Samples = vk::SampleCountFlagBits::e1;
+		u32 m_ColorCount = 0;
+		std::vector<vk::ClearValue> m_ClearValues;
+	};
+
+	/// 
+	/// passes declare which images they read and write, compile then
+	/// - orders the passes so every read follows the write it depends on,
+	///   a read binds to the last write declared before it (or the first one after)
+	/// - culls passes whose results never reach an output or a side effect pass
+	/// - lets images with disjoint lifetimes share memory, outputs are never aliased
+	/// - precomputes one batched pipeline barrier per pass, only where a layout
+	///   changes or a hazard exists, and the render pass/framebuffer of every graphics pass
+	/// 
+	/// images are only valid during the frame, except outputs, which are left in their output
+	/// access after execute, e.g. to be sampled by the renderer core's render pass
+	/// 
+	/// warning: declarations changed after compile take effect on the next compile
+	/// 
+	class RenderGraph {
+	public:
+		RenderGraph(void) = default;
+		void destroy(void);
+		inline ~RenderGraph(void) { this->destroy(); }
+
+		RenderGraph(const RenderGraph& other) = delete;
+		RenderGraph& operator=(const RenderGraph& other) = delete;
+
+		// references to the passes stay valid and now belong to this graph
+		RenderGraph(RenderGraph&& other);
+		RenderGraph& operator=(RenderGraph&& other);
+
+		[[nodiscard]] RenderGraphImage create_image(const RenderGraphImageInfo& info);
+
+		/// 
+		/// access is how the image is used after the graph executed,
+		/// graphics stages for attachments and sampling, compute for storage
+		/// 
+		void mark_output(RenderGraphImage image, RenderGraphAccess access = RenderGraphAccess::Sampled);
+
+		/// 
+		/// the returned reference stays valid, callbacks record with the Renderer's
+		/// command buffer overloads, e.g. Renderer::bind_pipeline(cmd_buffer, pipeline)
+		/// 
+		RenderGraphPass& add_pass(std::string_view name, RenderGraphPassType type, RenderGraphPass::Callback callback);
+
+		/// 
+		/// (re)creates every vulkan object, has to be called again after images were resized,
+		/// a previous compilation is released through the deletion queue
+		/// 
+		void compile(void);
+
+		/// 
+		/// records every pass that was not culled, has to be called outside of a render pass
+		/// 
+		void execute(vk::CommandBuffer cmd_buffer) const;
+
+		[[nodiscard]] vk::Image image(RenderGraphImage image) const;
+		[[nodiscard]] vk::ImageView image_view(RenderGraphImage image) const;
+		[[nodiscard]] inline const RenderGraphImageInfo& image_info(RenderGraphImage image) const { return m_Images[image].info; }
+
+		// device memory the images would take up without aliasing / with aliasing
+		[[nodiscard]] inline vk::DeviceSize unaliased_size(void) const { return m_UnaliasedSize; }
+		[[nodiscard]] vk::DeviceSize aliased_size(void) const;
+
+		[[nodiscard]] inline bool compiled(void) const { return m_Compiled; }
+	private:
+		struct ImageState {
+			vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+			vk::PipelineStageFlags stages;
+			vk::AccessFlags access;
+		};
+
+		struct Image {
+			RenderGraphImageInfo info;
+
+			bool output = false;
+			RenderGraphAccess output_access = RenderGraphAccess::Sampled;
+
+			// compiled
+			vk::Image img = nullptr;
+			vk::ImageView view = nullptr;
+			vk::ImageUsageFlags usage;
+			vk::ImageAspectFlags aspect;
+			u32 slot = k_U32Max;
+			u32 first_use = k_U32Max, last_use = 0; // in execution order
+			bool persistent = false; // output or read before written, keeps memory and layout across frames
+			ImageState final_state; // also the state at the start of the next frame
+		};
+
+		struct MemorySlot {
+			vk::MemoryRequirements requirements{};
+			std::vector<RenderGraphImage> images; // by first use
+			DeviceAllocation allocation;
+		};
+
+		struct Barriers {
+			vk::PipelineStageFlags src_stages, dst_stages;
+			std::vector<vk::ImageMemoryBarrier> image_barriers;
+		};
+
+		void _order_passes(void);
+		void _create_images(void);
+		void _create_barriers(void);
+		void _create_render_pass(RenderGraphPass& pass, u32 order_index);
+		void _release(void);
+
+		static void _record_barriers(vk::CommandBuffer cmd_buffer, const Barriers& barriers);
+	private:
+		std::deque<RenderGraphPass> m_Passes;
+		std::vector<Image> m_Images;
+
+		// compiled
+		std::vector<u32> m_Order;
+		std::vector<Barriers> m_PassBarriers; // recorded before m_Order[i]
+		Barriers m_OutputBarriers;
+		std::vector<MemorySlot> m_Slots;
+		vk::DeviceSize m_UnaliasedSize = 0;
+		bool m_Compiled = false;
+	};
+} // namespace Na
+
+#endif // NA_RENDER_GRAPH_HPP
@@ -0,0 +1,107 @@
+#if !defined(NA_RENDER_TARGET_HPP)
+#define NA_RENDER_TARGET_HPP
+
+#include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/DeviceImage.hpp"
+#include "Natrium/Graphics/Colors.hpp"
+
+namespace Na {
+	enum class MsaaResolve : u8 {
+		Attachment = 0, // by the render pass into the color image, averaging the samples
+
+		// the multisampled image is stored in final_layout with sampled usage and the color image
+		// is left for a pass of your own to resolve into, e.g. a compute shader that tonemaps
+		// before averaging, the color image then also has storage usage if its format allows
+		Manual
+	};
+
+	struct RenderTargetInfo {
+		vk::Extent2D extent;
+		vk::Format color_format = vk::Format::eR8G8B8A8Unorm;
+		vk::Format depth_format = vk::Format::eUndefined; // no depth attachment
+
+		// rendered into a transient image and resolved into the color image otherwise
+		vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+		MsaaResolve resolve = MsaaResolve::Attachment; // ignored without msaa
+
+		// of the color image after every pass, e.g. to be sampled or read back
+		vk::ImageLayout final_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	};
+
+	/// 
+	/// an offscreen color image, with optional depth and msaa attachments, and a render pass
+	/// and framebuffer of its own, drawn to between Renderer::begin_target and end_target
+	/// 
+	/// the color image is created with sampled and transfer src usage,
+	/// pipelines drawing into it have to be created with target()
+	/// 
+	class RenderTarget {
+	public:
+		RenderTarget(void) = default;
+		RenderTarget(const RenderTargetInfo& info);
+		void destroy(void);
+		inline ~RenderTarget(void) { this->destroy(); }
+
+		RenderTarget(const RenderTarget& other) = delete;
+		RenderTarget& operator=(const RenderTarget& other) = delete;
+
+		RenderTarget(RenderTarget&& other);
+		RenderTarget& operator=(RenderTarget&& other);
+
+		/// 
+		/// clears every attachment, the viewport and scissor cover the whole target
+		/// and are flipped like the renderer core's
+		/// 
+		void begin(vk::CommandBuffer cmd_buffer, const glm::vec4& clear_color = Colors::k_Black, float clear_depth = 1.0f) const;
+		inline void end(vk::CommandBuffer cmd_buffer) const { cmd_buffer.endRenderPass(); }
+
+		/// 
+		/// copies the color image into dst, width * height * texel_size bytes, blocks until done,
+		/// submissions drawing into it before are waited for by queue order
+		/// 
+		/// warning: inside an ImmediateBatch dst is only written once the batch was submitted
+		/// 
+		/// the color image has to be in final_layout, so a MsaaResolve::Manual target,
+		/// whose color image only your own pass writes, has to name its layout below
+		/// 
+		void read_back(void* dst, u32 texel_size = 4) const;
+		void read_back(void* dst, vk::ImageLayout layout, u32 texel_size = 4) const;
+
+		[[nodiscard]] GraphicsPipelineTarget target(void) const;
+
+		[[nodiscard]] inline const RenderTargetInfo& info(void) const { return m_Info; }
+		[[nodiscard]] inline vk::Extent2D extent(void) const { return m_Info.extent; }
+
+		[[nodiscard]] inline const DeviceImage& image(void) const { return m_Color; }
+		[[nodiscard]] inline vk::ImageView image_view(void) const { return m_ColorView; }
+
+		// only with msaa, sampled by a MsaaResolve::Manual resolve
+		[[nodiscard]] inline const DeviceImage& multisampled_image(void) const { return m_Multisampled; }
+		[[nodiscard]] inline vk::ImageView multisampled_view(void) const { return m_MultisampledView; }
+
+		[[nodiscard]] inline vk::RenderPass render_pass(void) const { return m_RenderPass; }
+		[[nodiscard]] inline vk::Framebuffer framebuffer(void) const { return m_Framebuffer; }
+
+		[[nodiscard]] inline operator bool(void) const { return m_RenderPass; }
+	private:
+		void _create_images(void);
+		void _create_render_pass(void);
+		void _create_framebuffer(void);
+	private:
+		RenderTargetInfo m_Info;
+
+		DeviceImage m_Color; // single sampled
+		vk::ImageView m_ColorView;
+
+		DeviceImage m_Multisampled; // only with msaa
+		vk::ImageView m_MultisampledView;
+
+		DeviceImage m_Depth;
+		vk::ImageView m_DepthView;
+
+		vk::RenderPass m_RenderPass;
+		vk::Framebuffer m_Framebuffer;
+	};
+} // namespace Na
+
+#endif // NA_RENDER_TARGET_HPP
\ No newline at end of file
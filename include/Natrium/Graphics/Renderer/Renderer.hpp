@@ -1,44 +1,349 @@
 #if !defined(NA_RENDERER_HPP)
 #define NA_RENDERER_HPP
 
+#include "Natrium/Core/Arena.hpp"
 #include "Natrium/Graphics/Renderer/RendererCore.hpp"
+#include "Natrium/Graphics/Renderer/DrawQueue.hpp"
+#include "Natrium/Graphics/Renderer/RenderGraph.hpp"
+#include "Natrium/Graphics/Renderer/RenderTarget.hpp"
+#include "Natrium/Graphics/Renderer/GpuProfiler.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/ParamBlock.hpp"
+#include "Natrium/Graphics/DescriptorAllocator.hpp"
 
 #include "Natrium/Graphics/Buffers/VertexBuffer.hpp"
 #include "Natrium/Graphics/Buffers/IndexBuffer.hpp"
 #include "Natrium/Graphics/Buffers/UniformBuffer.hpp"
 #include "Natrium/Graphics/Buffers/StorageBuffer.hpp"
+#include "Natrium/Graphics/Buffers/TransientBuffer.hpp"
+#include "Natrium/Graphics/Buffers/GeometryPool.hpp"
 
 namespace Na {
+	class GpuMesh;
+
+	struct WorkerCmdData {
+		vk::CommandPool              cmd_pool;
+		ArrayList<vk::CommandBuffer> cmd_buffers;
+		u32                          used = 0;
+	};
+
 	struct FrameData {
 		bool              valid = false;
 
 		vk::CommandBuffer cmd_buffer;
 
+		// recorded outside of the render pass and submitted ahead of cmd_buffer,
+		// begun by the first compute call of the frame
+		vk::CommandBuffer compute_cmd_buffer;
+		bool              compute_recording = false;
+		vk::Semaphore     compute_finished_semaphore; // only with async compute
+
+		// recorded outside of the render pass and submitted between compute and cmd_buffer,
+		// begun by the first render graph executed in the frame
+		vk::CommandBuffer pre_pass_cmd_buffer;
+		bool              pre_pass_recording = false;
+
+		// Renderer::upscale was recorded, end_frame clears the core's image otherwise
+		bool              upscaled = false;
+
+		// one pool per recording thread, reset wholesale once the frame's fence retires
+		ArrayVector<WorkerCmdData> workers;
+
 		vk::Semaphore     image_available_semaphore;
 		vk::Semaphore     render_finished_semaphore;
-		vk::Fence         in_flight_fence;
+		vk::Fence         in_flight_fence; // unused with a frame timeline
+
+		// scratch memory for the frame's cpu side data, reset when the slot is reused
+		Arena             arena;
 	};
 
 	class Renderer {
 	public:
+		// per-instance streams are bound here, per-vertex data stays at binding 0
+		static constexpr u32 k_InstanceBinding = 1;
+		static constexpr u64 k_InstanceAlignment = 16;
+
 		Renderer(void) = default;
 		Renderer(RendererCore& renderer_core);
 
 		void destroy(void);
 		inline ~Renderer(void) { this->destroy(); }
 
-		[[nodiscard]] bool begin_frame(const glm::vec4& color = Colors::k_Black);
+		/// 
+		/// blocks until the next frame may be recorded, see set_frame_latency
+		/// call it right before polling events so input is as fresh as possible once recording
+		/// starts, begin_frame calls it otherwise
+		/// 
+		/// returns false if RendererSettings::frame_timeout ran out, begin_frame then fails as well
+		/// 
+		[[nodiscard]] inline bool wait_for_frame(void) { return this->_wait_for_frame(m_Core->m_Settings.frame_timeout); }
+
+		/// 
+		/// both return false right away while the gpu is still busy with the frame that has to retire
+		/// first, so the caller can keep working, e.g. step the simulation, and try again later
+		/// 
+		/// try_begin_frame does not block on acquiring the swapchain image either, only on the
+		/// rare frame still rendering to the acquired image, it is counted in frame_wait_time
+		/// 
+		[[nodiscard]] inline bool try_wait_for_frame(void) { return this->_wait_for_frame(0); }
+		[[nodiscard]] inline bool try_begin_frame(const glm::vec4& color = Colors::k_Black) { return this->_begin_frame(color, false); }
+
+		[[nodiscard]] inline bool begin_frame(const glm::vec4& color = Colors::k_Black) { return this->_begin_frame(color, true); }
 		void end_frame(void);
 
-		void bind_pipeline(const GraphicsPipeline& pipeline);
-		void set_push_constant(const PushConstant& push_constant, const void* data, const GraphicsPipeline& pipeline);
+		/// 
+		/// ends the frames of several renderers, e.g. one per window, with a single graphics
+		/// queue submission and a single present covering every swapchain, renderers that did
+		/// not begin a frame (or whose begin_frame failed) are skipped
+		/// 
+		/// frames are still tracked per renderer: with timeline sync each renderer signals its
+		/// own timeline within the shared submission, with fences the first renderer's fence is
+		/// passed along and the others are signaled by empty submissions right after
+		/// 
+		static void EndFrames(std::span<Renderer* const> renderers);
+
+		// between a successful begin_frame and end_frame
+		[[nodiscard]] inline bool recording(void) const { return m_Recording; }
+
+		/// 
+		/// returns a secondary command buffer that continues the current render pass,
+		/// with the viewport and scissor already set
+		/// 
+		/// warning:
+		/// each worker_index must only be used by one thread at a time, and only
+		/// between begin_frame and end_frame; end_frame executes all of them in
+		/// worker order, requires RendererSettings::recording_threads > worker_index
+		/// 
+		[[nodiscard]] vk::CommandBuffer begin_secondary(u32 worker_index);
+		inline void end_secondary(vk::CommandBuffer cmd_buffer) { cmd_buffer.end(); }
+
+		inline void bind_pipeline(const GraphicsPipeline& pipeline) { this->bind_pipeline(this->_frame_cmd_buffer(), pipeline); }
+
+		/// 
+		/// overrides the pipeline's per-frame dynamic offsets, e.g. with TransientAllocation::offset
+		/// one offset per dynamic uniform, in binding order
+		/// 
+		inline void bind_pipeline(const GraphicsPipeline& pipeline, const std::initializer_list<u32>& dynamic_offsets) { this->bind_pipeline(this->_frame_cmd_buffer(), pipeline, dynamic_offsets.begin(), (u32)dynamic_offsets.size()); }
+		inline void set_push_constant(const PushConstant& push_constant, const void* data, const GraphicsPipeline& pipeline) { this->set_push_constant(this->_frame_cmd_buffer(), push_constant, data, pipeline); }
+
+		// typed, the range comes from the block, see PushConstantBlock
+		template<PushConstantBlockType Block>
+		inline void set_push_constant(const typename Block::Type& data, const GraphicsPipeline& pipeline) { this->set_push_constant(this->_frame_cmd_buffer(), Block::k_Range, &data, pipeline); }
+
+		/// 
+		/// binds descriptor_set instead of the pipeline's own set, e.g. one per material
+		/// written through GraphicsPipeline::write_uniform, one offset per dynamic uniform in binding order
+		/// 
+		inline void bind_pipeline(const GraphicsPipeline& pipeline, vk::DescriptorSet descriptor_set, const std::initializer_list<u32>& dynamic_offsets = {}) { this->bind_pipeline(this->_frame_cmd_buffer(), pipeline, descriptor_set, dynamic_offsets.begin(), (u32)dynamic_offsets.size()); }
+
+		/// 
+		/// a set with the pipeline's descriptor layout that stays valid until this frame slot
+		/// comes around again, safe to call from worker threads
+		/// 
+		[[nodiscard]] inline vk::DescriptorSet allocate_descriptor_set(const GraphicsPipeline& pipeline) { return m_DescriptorAllocator.allocate(m_FrameIndex, pipeline.descriptor_layout()); }
+		[[nodiscard]] inline vk::DescriptorSet allocate_descriptor_set(vk::DescriptorSetLayout layout) { return m_DescriptorAllocator.allocate(m_FrameIndex, layout); }
+
+		inline void draw_vertices(const VertexBuffer& vertex_buffer, u32 vertex_count, u32 instance_count = 1) { this->draw_vertices(this->_frame_cmd_buffer(), vertex_buffer, vertex_count, instance_count); }
+		inline void draw_indexed(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 instance_count = 1) { this->draw_indexed(this->_frame_cmd_buffer(), vertex_buffer, index_buffer, instance_count); }
+
+		// a range of the index buffer, e.g. a MeshLod
+		inline void draw_indexed(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 first_index, u32 index_count, u32 instance_count = 1) { this->draw_indexed(this->_frame_cmd_buffer(), vertex_buffer, index_buffer, first_index, index_count, instance_count); }
+
+		// one level of detail of the mesh, the full mesh is level 0
+		inline void draw_mesh(const GpuMesh& mesh, u32 level = 0, u32 instance_count = 1) { this->draw_mesh(this->_frame_cmd_buffer(), mesh, level, instance_count); }
+
+		inline void draw_vertices(const TransientAllocation& vertices, u32 vertex_count, u32 instance_count = 1) { this->draw_vertices(this->_frame_cmd_buffer(), vertices, vertex_count, instance_count); }
+
+		/// 
+		/// per-instance data for this frame, bound as a vertex buffer at k_InstanceBinding
+		/// for pipelines with a binding of AttributeInputRate::Instance there,
+		/// returns an invalid allocation once RendererSettings::instance_buffer_size is used up
+		/// 
+		/// warning: only valid between begin_frame and end_frame, not thread safe,
+		/// allocate from the thread that calls end_frame
+		/// 
+		[[nodiscard]] inline TransientAllocation allocate_instances(u64 size) { return m_InstanceBuffer ? m_InstanceBuffer.allocate(size, k_InstanceAlignment) : TransientAllocation{}; }
+
+		template<typename T>
+		[[nodiscard]] inline TransientAllocation push_instances(std::span<const T> instances)
+		{
+			TransientAllocation allocation = this->allocate_instances(instances.size_bytes());
+			if (allocation)
+				memcpy(allocation.mapped, instances.data(), instances.size_bytes());
+			return allocation;
+		}
+
+		// instance_count instances of instances, which are read from first_instance on
+		inline void draw_vertices(const VertexBuffer& vertex_buffer, u32 vertex_count, const TransientAllocation& instances, u32 instance_count, u32 first_instance = 0) { this->draw_vertices(this->_frame_cmd_buffer(), vertex_buffer, vertex_count, instances, instance_count, first_instance); }
+		inline void draw_indexed(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const TransientAllocation& instances, u32 instance_count, u32 first_instance = 0) { this->draw_indexed(this->_frame_cmd_buffer(), vertex_buffer, index_buffer, instances, instance_count, first_instance); }
+
+		/// 
+		/// binds the pool's vertex and index buffer, every draw of one of its allocations
+		/// after that only passes its offsets
+		/// 
+		inline void bind_geometry(const GeometryPool& pool) { this->bind_geometry(this->_frame_cmd_buffer(), pool); }
+		inline void draw_indexed(const GeometryAllocation& geometry, u32 instance_count = 1) { this->draw_indexed(this->_frame_cmd_buffer(), geometry, instance_count); }
+
+		/// 
+		/// draws draw_count vk::DrawIndexedIndirectCommands, tightly packed at the start of
+		/// the current frame's slice of commands, with the shared vertex/index buffers bound once
+		/// 
+		/// without the multiDrawIndirect feature this falls back to one indirect draw per command
+		/// 
+		inline void draw_indexed_indirect(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const StorageBuffer& commands, u32 draw_count) { this->draw_indexed_indirect(this->_frame_cmd_buffer(), vertex_buffer, index_buffer, commands, draw_count); }
+
+		// commands of allocations of the pool, see GeometryAllocation::indirect_command
+		inline void draw_indexed_indirect(const GeometryPool& pool, const StorageBuffer& commands, u32 draw_count) { this->draw_indexed_indirect(this->_frame_cmd_buffer(), pool, commands, draw_count); }
+
+		/// 
+		/// the draw count is read on the gpu from the first u32 of count_buffer's current frame slice,
+		/// clamped to max_draw_count (0 means as many commands as fit in commands)
+		/// warning: requires DeviceFeatures::draw_indirect_count
+		/// 
+		inline void draw_indexed_indirect_count(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const StorageBuffer& commands, const StorageBuffer& count_buffer, u32 max_draw_count = 0) { this->draw_indexed_indirect_count(this->_frame_cmd_buffer(), vertex_buffer, index_buffer, commands, count_buffer, max_draw_count); }
+		inline void draw_indexed_indirect_count(const GeometryPool& pool, const StorageBuffer& commands, const StorageBuffer& count_buffer, u32 max_draw_count = 0) { this->draw_indexed_indirect_count(this->_frame_cmd_buffer(), pool, commands, count_buffer, max_draw_count); }
+
+		/// 
+		/// deferred draws, sorted and recorded at end_frame after everything recorded directly,
+		/// only valid between begin_frame and end_frame
+		/// 
+		inline void submit(const DrawItem& item) { m_DrawQueue.submit(item); }
+
+		[[nodiscard]] inline DrawQueue& draw_queue(void) { return m_DrawQueue; }
+		[[nodiscard]] inline const DrawQueue& draw_queue(void) const { return m_DrawQueue; }
+
+		// recording into an explicit (e.g. secondary) command buffer, safe to call from worker threads
+		void bind_pipeline(vk::CommandBuffer cmd_buffer, const GraphicsPipeline& pipeline) const;
+		void bind_pipeline(vk::CommandBuffer cmd_buffer, const GraphicsPipeline& pipeline, const u32* dynamic_offsets, u32 dynamic_offset_count) const;
+		void bind_pipeline(vk::CommandBuffer cmd_buffer, const GraphicsPipeline& pipeline, vk::DescriptorSet descriptor_set, const u32* dynamic_offsets, u32 dynamic_offset_count) const;
+		void set_push_constant(vk::CommandBuffer cmd_buffer, const PushConstant& push_constant, const void* data, const GraphicsPipeline& pipeline) const;
+		template<PushConstantBlockType Block>
+		inline void set_push_constant(vk::CommandBuffer cmd_buffer, const typename Block::Type& data, const GraphicsPipeline& pipeline) const { this->set_push_constant(cmd_buffer, Block::k_Range, &data, pipeline); }
+
+		void draw_vertices(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, u32 vertex_count, u32 instance_count = 1) const;
+		void draw_indexed(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 instance_count = 1) const;
+		void draw_indexed(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 first_index, u32 index_count, u32 instance_count = 1) const;
+		void draw_mesh(vk::CommandBuffer cmd_buffer, const GpuMesh& mesh, u32 level = 0, u32 instance_count = 1) const;
+
+		void draw_vertices(vk::CommandBuffer cmd_buffer, const TransientAllocation& vertices, u32 vertex_count, u32 instance_count = 1) const;
+
+		void bind_instances(vk::CommandBuffer cmd_buffer, const TransientAllocation& instances) const;
+		void draw_vertices(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, u32 vertex_count, const TransientAllocation& instances, u32 instance_count, u32 first_instance = 0) const;
+		void draw_indexed(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const TransientAllocation& instances, u32 instance_count, u32 first_instance = 0) const;
+
+		void bind_geometry(vk::CommandBuffer cmd_buffer, const GeometryPool& pool) const;
+		void draw_indexed(vk::CommandBuffer cmd_buffer, const GeometryAllocation& geometry, u32 instance_count = 1) const;
+
+		void draw_indexed_indirect(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const StorageBuffer& commands, u32 draw_count) const;
+		void draw_indexed_indirect_count(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, const StorageBuffer& commands, const StorageBuffer& count_buffer, u32 max_draw_count = 0) const;
+
+		void draw_indexed_indirect(vk::CommandBuffer cmd_buffer, const GeometryPool& pool, const StorageBuffer& commands, u32 draw_count) const;
+		void draw_indexed_indirect_count(vk::CommandBuffer cmd_buffer, const GeometryPool& pool, const StorageBuffer& commands, const StorageBuffer& count_buffer, u32 max_draw_count = 0) const;
 
-		void draw_vertices(const VertexBuffer& vertex_buffer, u32 vertex_count, u32 instance_count = 1);
-		void draw_indexed(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 instance_count = 1);
+		// commands not owned by a StorageBuffer, e.g. a TransientAllocation
+		void draw_indexed_indirect(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, vk::Buffer commands, vk::DeviceSize offset, u32 draw_count) const;
+		void draw_indexed_indirect_count(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, vk::Buffer commands, vk::DeviceSize offset, vk::Buffer count_buffer, vk::DeviceSize count_offset, u32 max_draw_count) const;
 
+		/// 
+		/// writes a UniformBuffer or StorageBuffer, per frame buffers only in the region of the
+		/// current frame, static ones are uploaded for every frame, see UniformBuffer::upload
+		/// 
 		void set_descriptor_buffer(void* buffer, const void* data) const;
 
+		// only size bytes at offset, the rest keeps what was written before
+		void set_descriptor_buffer(void* buffer, const void* data, u64 size, u64 offset = 0) const;
+
+		/// 
+		/// catches the current frame's region of a tracked buffer up with writes made during
+		/// earlier frames, call it every frame the buffer is read but not written
+		/// (set_descriptor_buffer already syncs), does nothing for untracked buffers
+		/// 
+		void sync_descriptor_buffer(void* buffer) const;
+
+		/// 
+		/// compute work is recorded into its own command buffer which is submitted before the frame's
+		/// graphics commands, so it can be recorded at any point between begin_frame and end_frame
+		/// 
+		/// end_frame makes compute shader writes visible to every graphics stage,
+		/// the barriers below are only needed between dependent dispatches
+		/// 
+		void bind_pipeline(const ComputePipeline& pipeline);
+		void set_push_constant(const PushConstant& push_constant, const void* data, const ComputePipeline& pipeline);
+		template<PushConstantBlockType Block>
+		inline void set_push_constant(const typename Block::Type& data, const ComputePipeline& pipeline) { this->set_push_constant(Block::k_Range, &data, pipeline); }
+
+		void dispatch(u32 group_count_x, u32 group_count_y = 1, u32 group_count_z = 1);
+		inline void dispatch(const ComputePipeline& pipeline, u32 group_count_x, u32 group_count_y = 1, u32 group_count_z = 1) { this->bind_pipeline(pipeline); this->dispatch(group_count_x, group_count_y, group_count_z); }
+
+		/// 
+		/// warning: with async compute only compute and transfer stages may be used
+		/// 
+		void memory_barrier(
+			vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+			vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+		);
+		void buffer_barrier(
+			const DeviceBuffer& buffer,
+			vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+			vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+		);
+		void image_barrier(
+			const DeviceImage& image,
+			vk::ImageLayout old_layout, vk::ImageLayout new_layout,
+			vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+			vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+		);
+
+		[[nodiscard]] vk::CommandBuffer compute_cmd_buffer(void);
+
+		/// 
+		/// records the graph ahead of the renderer core's render pass, after this frame's compute work,
+		/// so its outputs can be sampled by anything drawn between begin_frame and end_frame
+		/// 
+		inline void execute(const RenderGraph& graph) { graph.execute(this->pre_pass_cmd_buffer()); }
+
+		[[nodiscard]] vk::CommandBuffer pre_pass_cmd_buffer(void);
+
+		/// 
+		/// starts the target's render pass in the pre-pass command buffer and returns it,
+		/// pipelines drawing into it are created with target.target(), see RenderTarget
+		/// 
+		inline vk::CommandBuffer begin_target(const RenderTarget& target, const glm::vec4& clear_color = Colors::k_Black)
+		{
+			vk::CommandBuffer cmd_buffer = this->pre_pass_cmd_buffer();
+			target.begin(cmd_buffer, clear_color);
+			return cmd_buffer;
+		}
+		inline void end_target(const RenderTarget& target) { target.end(m_Frames[m_FrameIndex].pre_pass_cmd_buffer); }
+
+		/// 
+		/// blits the top left extent of target's color image over the whole core image with linear
+		/// filtering, in the pre-pass command buffer after whatever rendered into target,
+		/// only with RendererSettings::upscaling, once per frame
+		/// 
+		/// the core's pass then draws on top of it at full resolution, e.g. the ui,
+		/// frames that skip it start from black
+		/// 
+		void upscale(const RenderTarget& target, vk::Extent2D extent);
+
+		/// 
+		/// times everything recorded between the two calls into the frame's primary command buffer,
+		/// see RendererSettings::gpu_profiler_scopes, does nothing if profiling is disabled
+		/// 
+		[[nodiscard]] inline GpuScope begin_gpu_scope(std::string_view name, bool statistics = false) { return m_Profiler.begin_scope(m_Frames[m_FrameIndex].cmd_buffer, name, statistics); }
+		inline void end_gpu_scope(GpuScope scope) { m_Profiler.end_scope(m_Frames[m_FrameIndex].cmd_buffer, scope); }
+
+		// e.g. within a render graph pass or a secondary command buffer
+		[[nodiscard]] inline GpuScope begin_gpu_scope(vk::CommandBuffer cmd_buffer, std::string_view name, bool statistics = false) { return m_Profiler.begin_scope(cmd_buffer, name, statistics); }
+		inline void end_gpu_scope(vk::CommandBuffer cmd_buffer, GpuScope scope) { m_Profiler.end_scope(cmd_buffer, scope); }
+
+		/// 
+		/// the latest frame the gpu finished, max_frames_in_flight frames behind the current one
+		/// 
+		[[nodiscard]] inline const GpuFrameReport& gpu_report(void) const { return m_Profiler.report(); }
+		[[nodiscard]] inline const GpuProfiler& gpu_profiler(void) const { return m_Profiler; }
+		[[nodiscard]] inline bool async_compute(void) const { return m_ComputeCmdPool; }
+
 		[[nodiscard]] inline const RendererSettings& settings(void) { return m_Core->settings(); }
 
 		[[nodiscard]] inline RendererCore& core(void) { return *m_Core; }
@@ -49,6 +354,42 @@ namespace Na {
 
 		[[nodiscard]] inline u32 current_frame_index(void) const { return m_FrameIndex; }
 
+		/// 
+		/// valid until the slot comes around again, max_frames_in_flight frames later,
+		/// use Arena::Thread for scratch data that only has to last until the next frame
+		/// 
+		[[nodiscard]] inline Arena& frame_arena(void) { return m_Frames[m_FrameIndex].arena; }
+
+		// e.g. for RendererCore::read_back once the frame completed
+		[[nodiscard]] inline u32 current_image_index(void) const { return m_ImageIndex; }
+
+		/// 
+		/// frames are numbered from 1 in submission order, completed_frames is the latest one
+		/// the gpu is known to have finished as of the last wait, everything before it finished too
+		/// 
+		[[nodiscard]] inline u64 submitted_frames(void) const { return m_SubmittedFrames; }
+		[[nodiscard]] inline u64 completed_frames(void) const { return m_CompletedFrames; }
+
+		/// 
+		/// frames the cpu may record ahead of the gpu, clamped to [1, max_frames_in_flight],
+		/// takes effect with the next wait_for_frame, starts out as RendererSettings::max_frame_latency
+		/// 
+		inline void set_frame_latency(u32 latency) { m_FrameLatency = std::clamp(latency, 1u, (u32)m_Frames.size()); }
+		[[nodiscard]] inline u32 frame_latency(void) const { return m_FrameLatency; }
+
+		/// 
+		/// how long the cpu blocked on the gpu before the last frame began, i.e. waiting for
+		/// the frame latency and for the acquired image, a steady value near the frame time
+		/// means the gpu is the bottleneck, 0 means the frames overlap fully
+		/// 
+		[[nodiscard]] inline std::chrono::nanoseconds frame_wait_time(void) const { return m_FrameWaitTime; }
+		[[nodiscard]] inline std::chrono::nanoseconds total_wait_time(void) const { return m_TotalWaitTime; }
+
+		// frames are tracked with a timeline semaphore instead of per-frame fences, see DeviceFeatures::timeline_semaphore
+		[[nodiscard]] inline bool timeline_sync(void) const { return m_FrameTimeline; }
+
+		[[nodiscard]] inline bool records_secondary(void) const { return m_Core->m_Settings.recording_threads; }
+
 		[[nodiscard]] inline operator bool(void) const { return m_Core; }
 
 		Renderer(const Renderer& other) = delete;
@@ -57,18 +398,95 @@ namespace Na {
 		Renderer(Renderer&& other);
 		Renderer& operator=(Renderer&& other);
 	private:
+		// the primary command buffer only executes the workers' buffers when recording secondary
+		[[nodiscard]] inline vk::CommandBuffer _frame_cmd_buffer(void) const
+		{
+			NA_VERIFY(!this->records_secondary(), "Failed to record: With RendererSettings::recording_threads draws go through begin_secondary!");
+			return m_Frames[m_FrameIndex].cmd_buffer;
+		}
+
 		void _create_command_objects(void);
 		void _create_sync_objects(void);
+
+		void _recreate_swapchain(void);
+
+		// the queue work of one frame, the infos point into the struct itself so it is filled in place
+		struct FrameSubmission {
+			vk::Semaphore wait_semaphores[2];
+			vk::PipelineStageFlags wait_stages[2];
+			vk::Semaphore signal_semaphores[2];
+			u64 signal_values[2];
+			vk::CommandBuffer cmd_buffers[3];
+
+			vk::TimelineSemaphoreSubmitInfoKHR timeline_info;
+			vk::SubmitInfo submit_info;
+			vk::Fence fence; // nullptr with a frame timeline
+
+			vk::SubmitInfo compute_submit_info; // only with async compute
+			bool compute = false;
+		};
+
+		// ends the frame's command buffers, the submission has to follow before the next begin_frame
+		void _prepare_submission(FrameSubmission& submission);
+
+		// after the submission, a headless frame is done with it
+		void _submitted(void);
+		void _presented(vk::Result result);
+
+		// clears the core's image if target is nullptr
+		void _upscale(const RenderTarget* target, vk::Extent2D extent);
+
+		// waits until frame (numbered like m_SubmittedFrames) completed, 0 is always complete,
+		// the time spent waiting is added to m_PendingWaitTime
+		[[nodiscard]] vk::Result _wait_for_submission(u64 frame, u64 timeout);
+
+		// false if timeout ran out, a timeout of 0 only polls
+		[[nodiscard]] bool _wait_for_frame(u64 timeout);
+
+		// without blocking the image is not waited for, false if none is available yet
+		[[nodiscard]] bool _begin_frame(const glm::vec4& color, bool blocking);
+
+		// dynamic rendering counterparts of beginning and ending the core's render pass
+		void _begin_rendering(vk::CommandBuffer cmd_buffer, const std::array<vk::ClearValue, 2>& clear_values);
+		void _end_rendering(vk::CommandBuffer cmd_buffer);
+
+		// with the geometry already bound
+		void _record_indexed_indirect(vk::CommandBuffer cmd_buffer, vk::Buffer commands, vk::DeviceSize offset, u32 draw_count) const;
+		void _record_indexed_indirect_count(vk::CommandBuffer cmd_buffer, vk::Buffer commands, vk::DeviceSize offset, vk::Buffer count_buffer, vk::DeviceSize count_offset, u32 max_draw_count) const;
+
+		// clamps max_draw_count of the StorageBuffer overloads
+		[[nodiscard]] static u32 _max_indirect_draws(const StorageBuffer& commands, u32 max_draw_count);
 	private:
 		RendererCore* m_Core = nullptr;
 
 		vk::CommandPool m_GraphicsCmdPool;
+		vk::CommandPool m_ComputeCmdPool; // only with async compute
 
 		ArrayVector<FrameData> m_Frames;
 		u32 m_FrameIndex = 0;
+		bool m_FrameWaited = false; // wait_for_frame was called for m_FrameIndex
+		u32 m_FrameLatency = 1;
+		bool m_Recording = false;
+		u64 m_SubmittedFrames = 0;
+		u64 m_CompletedFrames = 0;
+		u32 m_DeletionSubmitter = k_U32Max; // the frames of this renderer in the DeletionQueue
 
-		ArrayVector<vk::Fence> m_ImageInFlightFences;
+		// signaled with each frame's number, nullptr without DeviceFeatures::timeline_semaphore
+		vk::Semaphore m_FrameTimeline;
+
+		ArrayList<vk::CommandBuffer> m_SecondaryCmdBuffers;
+
+		DrawQueue m_DrawQueue;
+		TransientBuffer m_InstanceBuffer;
+		GpuProfiler m_Profiler;
+		DescriptorAllocator m_DescriptorAllocator;
+
+		ArrayVector<u64> m_ImageFrames; // the last frame rendered to each image, 0 if none
 		u32 m_ImageIndex = 0;
+
+		std::chrono::nanoseconds m_PendingWaitTime{ 0 }; // of the frame about to begin
+		std::chrono::nanoseconds m_FrameWaitTime{ 0 };
+		std::chrono::nanoseconds m_TotalWaitTime{ 0 };
 	};
 } // namespace Na
 
@@ -0,0 +1,142 @@
+#if !defined(NA_RENDERER_2D_HPP)
+#define NA_RENDERER_2D_HPP
+
+#include "Natrium/Graphics/Renderer/Renderer.hpp"
+#include "Natrium/Graphics/TextureAtlas.hpp"
+
+namespace Na {
+	/// 
+	/// pipelines drawing quads read one binding of them at rate Vertex:
+	/// location 0 Vec3 position, 1 Vec2 uv, 2 Byte4Unorm color, 3 Vec2 texture,
+	/// texture holds the bindless index and the array layer as floats, exact up to 2^24,
+	/// the index is -1 for untextured quads
+	/// 
+	struct QuadVertex {
+		glm::vec3 position;
+		glm::vec2 uv;
+		u32 color; // rgba8, see PackColor
+		glm::vec2 texture;
+	};
+
+	[[nodiscard]] inline u32 PackColor(const glm::vec4& color)
+	{
+		glm::vec4 bytes = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+		return (u32)bytes.r | (u32)bytes.g << 8 | (u32)bytes.b << 16 | (u32)bytes.a << 24;
+	}
+
+	struct Renderer2DInfo {
+		// per draw call, at most 16384 so the shared indices fit in 16 bits
+		u32 batch_quads = 4096;
+
+		// quads per frame in flight, drawing more than that in a frame drops the rest with a warning
+		u32 max_quads = 65536;
+	};
+
+	/// 
+	/// batches quads and sprites into a persistently mapped per-frame buffer and draws
+	/// every batch with one indexed draw against shared quad indices
+	/// 
+	/// a batch only breaks when the pipeline or the descriptor set changes, or after
+	/// Renderer2DInfo::batch_quads, textures are picked per quad through their bindless index,
+	/// so with a bindless table one pipeline draws everything in a few calls
+	/// 
+	/// quads are transformed on the cpu, the pipeline applies the camera, e.g. through a
+	/// push constant set before begin
+	/// 
+	/// warning: not thread safe, draws from one thread between begin and end
+	/// 
+	class Renderer2D {
+	public:
+		Renderer2D(void) = default;
+		Renderer2D(const RendererSettings& renderer_settings, const Renderer2DInfo& info = {});
+		void destroy(void);
+		inline ~Renderer2D(void) { this->destroy(); }
+
+		Renderer2D(const Renderer2D& other) = delete;
+		Renderer2D& operator=(const Renderer2D& other) = delete;
+
+		Renderer2D(Renderer2D&& other) = default;
+		Renderer2D& operator=(Renderer2D&& other) = default;
+
+		/// 
+		/// starts recording into cmd_buffer, the renderer's own by default, which has to be
+		/// within a render pass, can be called more than once per frame, e.g. per render target
+		/// 
+		void begin(Renderer& renderer, vk::CommandBuffer cmd_buffer = nullptr);
+
+		// draws what is left, the pipeline stays bound
+		void end(void);
+
+		/// 
+		/// breaks the batch if either changes, descriptor_set nullptr binds the pipeline's own set,
+		/// see Renderer::bind_pipeline
+		/// 
+		void set_pipeline(const GraphicsPipeline& pipeline, vk::DescriptorSet descriptor_set = nullptr);
+
+		// the corners of the unit square [0, 1] transformed, uv_min at the origin
+		void draw_quad(
+			const glm::mat4& transform,
+			const glm::vec4& color,
+			BindlessIndex texture = k_NullBindlessIndex,
+			const glm::vec2& uv_min = { 0.0f, 0.0f },
+			const glm::vec2& uv_max = { 1.0f, 1.0f },
+			u32 layer = 0
+		);
+
+		// axis aligned, position is the corner with uv_min
+		void draw_quad(
+			const glm::vec3& position,
+			const glm::vec2& size,
+			const glm::vec4& color,
+			BindlessIndex texture = k_NullBindlessIndex,
+			const glm::vec2& uv_min = { 0.0f, 0.0f },
+			const glm::vec2& uv_max = { 1.0f, 1.0f },
+			u32 layer = 0
+		);
+
+		inline void draw_sprite(const glm::vec3& position, const glm::vec2& size, const TextureAtlas& atlas, const AtlasRegion& region, const glm::vec4& tint = Colors::k_White)
+		{
+			this->draw_quad(position, size, tint, atlas.bindless_index(), region.uv_min, region.uv_max, region.layer);
+		}
+		inline void draw_sprite(const glm::mat4& transform, const TextureAtlas& atlas, const AtlasRegion& region, const glm::vec4& tint = Colors::k_White)
+		{
+			this->draw_quad(transform, tint, atlas.bindless_index(), region.uv_min, region.uv_max, region.layer);
+		}
+
+		// since the last begin
+		[[nodiscard]] inline u32 quad_count(void) const { return m_QuadCount; }
+		[[nodiscard]] inline u32 draw_calls(void) const { return m_DrawCalls; }
+
+		[[nodiscard]] inline const Renderer2DInfo& info(void) const { return m_Info; }
+		[[nodiscard]] inline operator bool(void) const { return m_Indices; }
+	private:
+		// returns the vertices of the next quad, nullptr once the frame's buffer is exhausted
+		[[nodiscard]] QuadVertex* _next_quad(void);
+
+		void _flush(void);
+	private:
+		Renderer2DInfo m_Info;
+
+		TransientBuffer m_Vertices;
+		IndexBuffer m_Indices;
+
+		Renderer* m_Renderer = nullptr;
+		vk::CommandBuffer m_CmdBuffer = nullptr;
+		u64 m_Frame = k_U64Max; // the renderer's frame m_Vertices was reset for
+
+		// the batch_quads quads being filled, bound as the vertex buffer
+		TransientAllocation m_Chunk;
+		u32 m_ChunkQuads = 0;
+		u32 m_BatchStart = 0; // quads of the chunk drawn already
+
+		const GraphicsPipeline* m_Pipeline = nullptr;
+		vk::DescriptorSet m_DescriptorSet = nullptr;
+		bool m_PipelineBound = false;
+
+		u32 m_QuadCount = 0;
+		u32 m_DrawCalls = 0;
+		bool m_Exhausted = false;
+	};
+} // namespace Na
+
+#endif // NA_RENDERER_2D_HPP
\ No newline at end of file
@@ -4,14 +4,26 @@
 #include "Natrium/Core/Window.hpp"
 #include "Natrium/Graphics/DeviceImage.hpp"
 #include "Natrium/Graphics/Colors.hpp"
+#include "Natrium/Graphics/VkContext.hpp"
 
 #include "Natrium/Graphics/Renderer/RendererSettings.hpp"
 
 namespace Na {
 	class RendererCore {
 	public:
+		static constexpr vk::Format k_HeadlessFormat = vk::Format::eR8G8B8A8Unorm;
+
 		RendererCore(void) = default;
 		RendererCore(Window& window, const RendererSettings& settings = RendererSettings::Default());
+
+		/// 
+		/// renders into images of its own instead of a swapchain, e.g. on machines without a display,
+		/// nothing is presented, frames are left in eTransferSrcOptimal to be read back,
+		/// RendererSettings::swapchain_image_count images are cycled (max_frames_in_flight if 0)
+		/// 
+		/// the size is fixed, there is no window, surface or swapchain
+		/// 
+		RendererCore(const vk::Extent2D& extent, const RendererSettings& settings = RendererSettings::Default());
 		void destroy(void);
 		inline ~RendererCore(void) { this->destroy(); }
 
@@ -23,18 +35,36 @@ namespace Na {
 		inline void set_viewport(const glm::vec4& viewport);
 		[[nodiscard]] inline glm::vec4 viewport(void) const { return glm::vec4(m_Viewport.x, m_Viewport.y, m_Viewport.width, m_Viewport.height); }
 
+		/// 
+		/// copies headless image image_index into dst, width * height * 4 bytes of k_HeadlessFormat,
+		/// blocks until done, see Renderer::current_image_index
+		/// 
+		void read_back(u32 image_index, void* dst) const;
+
+		[[nodiscard]] inline bool headless(void) const { return m_Headless; }
+
 		[[nodiscard]] inline Window& window(void) { return *m_Window; }
 		[[nodiscard]] inline const Window& window(void) const { return *m_Window; }
 
 		[[nodiscard]] inline vk::SurfaceKHR surface(void) const { return m_Surface; }
 		[[nodiscard]] inline vk::SwapchainKHR swapchain(void) const { return m_Swapchain; }
 		[[nodiscard]] inline vk::SurfaceFormatKHR swapchain_format(void) const { return m_SwapchainFormat; }
+		[[nodiscard]] inline vk::PresentModeKHR present_mode(void) const { return m_PresentMode; }
+		[[nodiscard]] inline u32 image_count(void) const { return (u32)m_Images.size(); }
 
+		/// 
+		/// nullptr with dynamic rendering
+		/// 
 		[[nodiscard]] inline vk::RenderPass render_pass(void) const { return m_RenderPass; }
+		[[nodiscard]] inline bool dynamic_rendering(void) const { return m_DynamicRendering; }
+		[[nodiscard]] inline bool upscaling(void) const { return m_Settings.upscaling; }
+
+		[[nodiscard]] inline vk::Format depth_format(void) const { return m_DepthFormat; }
+		[[nodiscard]] inline vk::SampleCountFlagBits samples(void) const { return (vk::SampleCountFlagBits)m_Settings.msaa_samples; }
 
 		[[nodiscard]] inline QueueFamilyIndices queue_family_indices(void) const { return m_QueueIndices; }
 
-		[[nodiscard]] inline operator bool(void) const { return m_Window; }
+		[[nodiscard]] inline operator bool(void) const { return m_Window || m_Headless; }
 
 		RendererCore(const RendererCore& other) = delete;
 		RendererCore& operator=(const RendererCore& other) = delete;
@@ -44,16 +74,41 @@ namespace Na {
 	private:
 		void _create_window_surface(void);
 		void _create_swapchain(void);
+		void _create_headless_images(void);
 		void _create_image_views(void);
 		void _create_color_buffer(void);
 		void _create_depth_buffer(void);
 		void _create_render_pass(void);
 		void _create_framebuffers(void);
 
-		void _recreate_swapchain(void);
+		/// 
+		/// creates the new swapchain from the old one and retires the old resources instead of
+		/// waiting for the device, frame is the number of frames submitted so far
+		/// 
+		void _recreate_swapchain(u64 frame);
+
+		/// 
+		/// destroys what was retired before completed_frames, i.e. resources
+		/// no frame that may still be executing refers to
+		/// 
+		void _destroy_retired(u64 completed_frames);
 	private:
 		friend class Renderer;
 
+		struct RetiredSwapchain {
+			vk::SwapchainKHR swapchain;
+			Na::ArrayVector<vk::ImageView> image_views;
+			ArrayVector<vk::Framebuffer> framebuffers;
+
+			DeviceImage color_image;
+			vk::ImageView color_image_view;
+
+			DeviceImage depth_image;
+			vk::ImageView depth_image_view;
+
+			u64 frame;
+		};
+
 		Window* m_Window = nullptr;
 		vk::SurfaceKHR m_Surface;
 
@@ -70,20 +125,33 @@ namespace Na {
 
 		vk::SwapchainKHR m_Swapchain;
 		vk::SurfaceFormatKHR m_SwapchainFormat;
+		vk::PresentModeKHR m_PresentMode = vk::PresentModeKHR::eFifo;
 
 		Na::ArrayVector<vk::Image> m_Images;
 		Na::ArrayVector<vk::ImageView> m_ImageViews;
 
+		// own m_Images when headless, swapchain_format is then k_HeadlessFormat
+		std::vector<DeviceImage> m_HeadlessImages;
+		bool m_Headless = false;
+
 		DeviceImage m_ColorImage;
 		vk::ImageView m_ColorImageView;
 
 		DeviceImage m_DepthImage;
 		vk::ImageView m_DepthImageView;
+		vk::Format m_DepthFormat = vk::Format::eUndefined;
 
+		// both empty with dynamic rendering
 		vk::RenderPass m_RenderPass;
 		ArrayVector<vk::Framebuffer> m_Framebuffers;
+		bool m_DynamicRendering = false;
 
 		RendererSettings m_Settings{};
+
+		std::vector<RetiredSwapchain> m_Retired;
+
+		bool m_SwapchainDirty = false; // out of date or suboptimal, recreate on the next frame
+		glm::uvec2 m_PendingSize = { 0, 0 }; // window size waiting to settle before recreating
 	};
 } // namespace Na
 
@@ -4,6 +4,13 @@
 #include "Natrium/Core.hpp"
 
 namespace Na {
+	enum class PresentMode : u8 {
+		Immediate = 0, // tears, lowest latency
+		Mailbox, // newest frame replaces the queued one, no tearing
+		Fifo, // vsync, always supported
+		FifoRelaxed // vsync, tears when a frame is late
+	};
+
 	struct RendererSettings {
 		u32 max_frames_in_flight;
 
@@ -12,6 +19,57 @@ namespace Na {
 
 		bool msaa_enabled;
 
+		// samples per pixel with msaa_enabled, clamped down to what the device supports,
+		// 0 picks the device maximum, which is rarely visibly better than 4 but costs a lot more
+		u32 msaa_samples = 4;
+
+		// Textures get a full mip chain blitted from their first level, if their format supports it,
+		// the lod range and bias apply to every Texture sampler
+		bool mipmaps = true;
+		float mip_lod_bias = 0.0f;
+		float min_lod = 0.0f;
+		float max_lod = VK_LOD_CLAMP_NONE;
+
+		// number of threads that record secondary command buffers through
+		// Renderer::begin_secondary, 0 records everything inline
+		u32 recording_threads = 0;
+
+		// submits Renderer::dispatch work to a compute only queue family if the device has one,
+		// buffers written by compute and read by graphics then need vk::SharingMode::eConcurrent
+		bool async_compute = false;
+
+		// falls back to Mailbox then Fifo if the surface does not support it
+		PresentMode present_mode = PresentMode::Mailbox;
+
+		// 0 picks minImageCount + 1, clamped to the surface's limits either way
+		u32 swapchain_image_count = 0;
+
+		// frames the cpu may record ahead of the gpu, 0 uses max_frames_in_flight,
+		// 1 waits for the previous frame to finish so input is sampled as late as possible
+		// at the cost of cpu/gpu overlap, 3 overlaps the most, see Renderer::set_frame_latency
+		u32 max_frame_latency = 0;
+
+		// nanoseconds Renderer::wait_for_frame blocks before the frame is skipped
+		u64 frame_timeout = k_U64Max;
+
+		// renders with VK_KHR_dynamic_rendering instead of a render pass and framebuffers,
+		// pipelines are then created against attachment formats, ignored if the device lacks it
+		bool dynamic_rendering = false;
+
+		// the core's color attachment is loaded instead of cleared, Renderer::upscale fills it
+		// ahead of the core's pass each frame, see DynamicResolution, msaa_enabled is then ignored
+		// since the scene is rendered and resolved in a target of its own
+		bool upscaling = false;
+
+		// scopes per frame the Renderer's GpuProfiler can time, 0 disables it,
+		// pipeline statistics are only collected if the device supports them
+		u32 gpu_profiler_scopes = 0;
+		bool pipeline_statistics = false;
+
+		// bytes per frame of the instance stream behind Renderer::allocate_instances,
+		// which also carries the instance data of DrawItems, 0 disables it
+		u64 instance_buffer_size = 4 * 1024 * 1024;
+
 		static RendererSettings Default(void);
 	};
 } // namespace Na
@@ -0,0 +1,68 @@
+#if !defined(NA_SAMPLER_CACHE_HPP)
+#define NA_SAMPLER_CACHE_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Graphics/Vulkan.hpp"
+#include "Natrium/Graphics/Renderer/RendererSettings.hpp"
+
+namespace Na {
+	struct SamplerInfo {
+		vk::Filter mag_filter = vk::Filter::eLinear; // oversampling
+		vk::Filter min_filter = vk::Filter::eLinear; // undersampling
+		vk::SamplerMipmapMode mipmap_mode = vk::SamplerMipmapMode::eLinear;
+
+		vk::SamplerAddressMode address_u = vk::SamplerAddressMode::eRepeat;
+		vk::SamplerAddressMode address_v = vk::SamplerAddressMode::eRepeat;
+		vk::SamplerAddressMode address_w = vk::SamplerAddressMode::eRepeat;
+		vk::BorderColor border_color = vk::BorderColor::eIntOpaqueBlack; // with eClampToBorder
+
+		bool anisotropy_enabled = false;
+		float max_anisotropy = 1.0f;
+
+		float mip_lod_bias = 0.0f;
+		float min_lod = 0.0f;
+		float max_lod = VK_LOD_CLAMP_NONE;
+
+		// e.g. for shadow maps
+		bool compare_enabled = false;
+		vk::CompareOp compare_op = vk::CompareOp::eAlways;
+
+		[[nodiscard]] auto operator<=>(const SamplerInfo& other) const = default;
+
+		// the Texture sampler described by the settings' anisotropy and lod fields
+		[[nodiscard]] static SamplerInfo FromSettings(const RendererSettings& settings);
+	};
+
+	/// 
+	/// creates every distinct sampler once and hands out the same vk::Sampler afterwards,
+	/// so thousands of textures share a handful of samplers and stay far below
+	/// maxSamplerAllocationCount, see VkContext::GetSamplerCache
+	/// 
+	/// samplers live until the cache is destroyed with the context, they are never freed
+	/// individually since a scene rarely uses more than a few dozen of them
+	/// 
+	/// internally synchronized, samplers may be requested from any thread
+	/// 
+	class SamplerCache {
+	public:
+		SamplerCache(void) = default;
+		void destroy(void);
+		inline ~SamplerCache(void) { this->destroy(); }
+
+		SamplerCache(const SamplerCache& other) = delete;
+		SamplerCache& operator=(const SamplerCache& other) = delete;
+
+		SamplerCache(SamplerCache&& other) = delete;
+		SamplerCache& operator=(SamplerCache&& other) = delete;
+
+		// throws once the device's sampler limit is reached
+		[[nodiscard]] vk::Sampler get(const SamplerInfo& info);
+
+		[[nodiscard]] inline u64 size(void) const { std::lock_guard lock(m_Mutex); return m_Samplers.size(); }
+	private:
+		mutable std::mutex m_Mutex;
+		std::map<SamplerInfo, vk::Sampler> m_Samplers;
+	};
+} // namespace Na
+
+#endif // NA_SAMPLER_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,124 @@
+#if !defined(NA_SHADER_HOT_RELOADER_HPP)
+#define NA_SHADER_HOT_RELOADER_HPP
+
+#include "Natrium/Core/FileWatcher.hpp"
+#include "Natrium/Core/JobSystem.hpp"
+#include "Natrium/Assets/AssetRegistry.hpp"
+#include "Natrium/Graphics/Pipeline.hpp"
+
+namespace Na {
+	struct HotReloadShader {
+		std::string src_path; // relative to the asset dir, like for create_shader_module_from_src
+		ShaderStageBits stage;
+		std::string entry_point = "main";
+		ShaderPermutation permutation = {};
+	};
+
+	/// 
+	/// gets the compiled modules in the order of the shaders passed to ShaderHotReloader::watch
+	/// 
+	/// the rebuilt pipeline comes with a descriptor set of its own, nothing bound to the old one
+	/// carries over, so the builder binds the uniforms again, in the same order as at creation, e.g.
+	///   [&](std::span<const ShaderModule> modules)
+	///   {
+	///       GraphicsPipeline pipeline(renderer_core, { &modules[0], &modules[1] });
+	///       pipeline.bind_uniform(0, camera_buffer);
+	///       pipeline.bind_uniform(1, albedo);
+	///       return pipeline;
+	///   }
+	/// sets written through GraphicsPipeline::write_uniform stay valid as long as the layout is the same
+	/// 
+	using HotReloadBuilder = std::function<GraphicsPipeline(std::span<const ShaderModule> shader_modules)>;
+
+	/// 
+	/// rebuilds GraphicsPipelines once the source of one of their shaders, or any file
+	/// it includes, changes on disk, without restarting or idling the device
+	/// 
+	/// the shaders are compiled through AssetRegistry's shader cache and the pipeline is built
+	/// with the context's pipeline cache on a JobSystem worker, update then assigns finished
+	/// pipelines in place, which sends the old ones to the deletion queue so frames in flight
+	/// keep using them
+	/// 
+	/// a failed rebuild is logged and the current pipeline is kept until the next edit
+	/// 
+	/// warning: not thread safe, meant to be used from the thread recording the frames
+	/// 
+	class ShaderHotReloader {
+	public:
+		// editors often save in several writes, a file has to be quiet this long before it is compiled
+		static constexpr std::chrono::milliseconds k_SettleTime{ 100 };
+
+		/// 
+		/// watches the registry's asset dir and its shader include dirs,
+		/// so include dirs have to be added to the registry first
+		/// 
+		ShaderHotReloader(AssetRegistry& registry);
+
+		// waits for the rebuilds in flight
+		~ShaderHotReloader(void);
+
+		ShaderHotReloader(const ShaderHotReloader& other) = delete;
+		ShaderHotReloader& operator=(const ShaderHotReloader& other) = delete;
+
+		ShaderHotReloader(ShaderHotReloader&& other) = delete;
+		ShaderHotReloader& operator=(ShaderHotReloader&& other) = delete;
+
+		/// 
+		/// update reassigns pipeline whenever it was rebuilt, so it has to stay at its address
+		/// until unwatched, e.g. a member or the GraphicsPipeline behind a PipelineHandle
+		/// 
+		/// returns the id to unwatch it with
+		/// 
+		u64 watch(GraphicsPipeline& pipeline, std::vector<HotReloadShader> shaders, HotReloadBuilder builder);
+		void unwatch(u64 id);
+
+		/// 
+		/// call once per frame before recording the commands using the pipelines,
+		/// returns how many pipelines were swapped
+		/// 
+		u32 update(void);
+
+		// rebuilds every watched pipeline, e.g. after changing a define the watcher can not see
+		void reload_all(void);
+
+		[[nodiscard]] inline u64 size(void) const { return m_Entries.size(); }
+		[[nodiscard]] u64 pending(void) const;
+	private:
+		struct Rebuild {
+			JobCounter counter;
+			GraphicsPipeline pipeline;
+			std::vector<std::filesystem::path> dependencies;
+		};
+
+		struct Entry {
+			GraphicsPipeline* pipeline;
+			std::vector<HotReloadShader> shaders;
+			HotReloadBuilder builder;
+
+			std::vector<std::filesystem::path> dependencies; // sorted, weakly canonical
+			std::unique_ptr<Rebuild> rebuild; // in flight
+			bool dirty = false; // changed again while rebuilding
+		};
+
+		[[nodiscard]] std::vector<std::filesystem::path> _dependencies(const std::vector<HotReloadShader>& shaders) const;
+
+		void _start(Entry& entry);
+
+		// true if the rebuild swapped in a pipeline
+		bool _finish(Entry& entry);
+	private:
+		AssetRegistry& m_Registry;
+		FileWatcher m_Watcher;
+
+		std::unordered_map<u64, Entry> m_Entries;
+		u64 m_NextID = 1;
+
+		// rebuilds of unwatched entries that are still running
+		std::vector<std::unique_ptr<Rebuild>> m_Orphans;
+
+		// when each changed file was last written
+		std::map<std::filesystem::path, std::chrono::steady_clock::time_point> m_Changes;
+	};
+} // namespace Na
+
+#endif // NA_SHADER_HOT_RELOADER_HPP
\ No newline at end of file
@@ -2,8 +2,50 @@
 #define NA_SHADER_MODULE_HPP
 
 #include "Natrium/Assets/ShaderAsset.hpp"
+#include "Natrium/Graphics/ShaderReflection.hpp"
 
 namespace Na {
+	template<typename T>
+	concept SpecializationConstantType = std::same_as<T, bool> || std::same_as<T, i32> || std::same_as<T, u32> || std::same_as<T, float>;
+
+	/// 
+	/// values for a stage's layout(constant_id = N) const declarations, folded in when the
+	/// pipeline is created, so branches on them cost nothing at runtime unlike on uniforms
+	/// 
+	/// bools are stored as VkBool32 like the shader expects them
+	/// warning: has to outlive the pipelines created with it
+	/// 
+	class SpecializationConstants {
+	public:
+		SpecializationConstants(void) = default;
+
+		// replaces the value of constant_id if it is already set
+		template<SpecializationConstantType T>
+		inline SpecializationConstants& set(u32 constant_id, T value)
+		{
+			if constexpr (std::same_as<T, bool>)
+			{
+				vk::Bool32 boolean = value ? VK_TRUE : VK_FALSE;
+				return this->_set(constant_id, &boolean, sizeof(boolean));
+			} else
+			{
+				return this->_set(constant_id, &value, sizeof(T));
+			}
+		}
+
+		// nullptr without any constants, points into this object
+		[[nodiscard]] const vk::SpecializationInfo* info(void) const;
+
+		[[nodiscard]] inline u64 size(void) const { return m_Entries.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_Entries.empty(); }
+	private:
+		SpecializationConstants& _set(u32 constant_id, const void* value, u32 size);
+	private:
+		std::vector<vk::SpecializationMapEntry> m_Entries;
+		std::vector<Byte> m_Data;
+		mutable vk::SpecializationInfo m_Info;
+	};
+
 	class ShaderModule {
 	public:
 		inline ShaderModule(
@@ -14,18 +56,30 @@ namespace Na {
 		: m_Module(module), m_Stage(stage), m_EntryPoint(entry_point)
 		{}
 
+		// reflects the binary
 		ShaderModule(
 			const ShaderBinary& binary,
 			ShaderStageBits stage,
 			const std::string_view& entry_point = "main"
 		);
 
+		// e.g. with a reflection loaded from AssetRegistry's cache
+		ShaderModule(
+			const ShaderBinary& binary,
+			ShaderStageBits stage,
+			ShaderReflection reflection,
+			const std::string_view& entry_point = "main"
+		);
+
 		~ShaderModule(void);
 
 		ShaderModule(ShaderModule&& other);
 		ShaderModule& operator=(ShaderModule&& other);
 
-		[[nodiscard]] inline vk::PipelineShaderStageCreateInfo pipeline_shader_info(void) const { return vk::PipelineShaderStageCreateInfo({}, (vk::ShaderStageFlagBits)this->m_Stage, this->m_Module, this->m_EntryPoint.data()); }
+		[[nodiscard]] inline vk::PipelineShaderStageCreateInfo pipeline_shader_info(const SpecializationConstants* specialization = nullptr) const
+		{
+			return vk::PipelineShaderStageCreateInfo({}, (vk::ShaderStageFlagBits)this->m_Stage, this->m_Module, this->m_EntryPoint.data(), specialization ? specialization->info() : nullptr);
+		}
 
 		[[nodiscard]] inline vk::ShaderModule module(void) const { return m_Module; }
 		[[nodiscard]] inline ShaderStageBits stage(void) const { return m_Stage; }
@@ -33,11 +87,27 @@ namespace Na {
 		[[nodiscard]] inline std::string_view& entry_point(void) { return m_EntryPoint; }
 		[[nodiscard]] inline const std::string_view& entry_point(void) const { return m_EntryPoint; }
 
+		// empty for modules wrapping a raw vk::ShaderModule
+		[[nodiscard]] inline const ShaderReflection& reflection(void) const { return m_Reflection; }
+
+		// of the SPIR-V words, 0 for modules wrapping a raw vk::ShaderModule
+		[[nodiscard]] inline u64 binary_hash(void) const { return m_BinaryHash; }
+
+		/// 
+		/// the binary_hash of the living ShaderModule that owns module, 0 if there is none,
+		/// handles are reused once destroyed, so they can not identify the code by themselves
+		/// 
+		[[nodiscard]] static u64 FindBinaryHash(vk::ShaderModule module);
+
 		[[nodiscard]] inline operator bool(void) const { return m_Module; };
+	private:
+		void _destroy(void);
 	private:
 		vk::ShaderModule m_Module;
 		ShaderStageBits m_Stage;
 		std::string_view m_EntryPoint;
+		ShaderReflection m_Reflection;
+		u64 m_BinaryHash = 0;
 	};
 }
 
@@ -0,0 +1,49 @@
+#if !defined(NA_SHADER_REFLECTION_HPP)
+#define NA_SHADER_REFLECTION_HPP
+
+#include "Natrium/Assets/ShaderAsset.hpp"
+#include "Natrium/Graphics/Pipeline.hpp"
+
+namespace Na {
+	/// 
+	/// the interface of one shader stage, read straight from its SPIR-V:
+	/// - vertex inputs (vertex stage only), sorted by location, built-ins are skipped
+	/// - descriptor set 0, uniform buffers and storage buffers map to their dynamic
+	///   ShaderUniformType like hand written layouts, sampled images to Texture
+	/// - the push constant block, if any
+	/// 
+	/// anything the pipelines can not express, e.g. other sets, arrays of descriptors
+	/// or integer vertex inputs, throws
+	/// 
+	class ShaderReflection {
+	public:
+		static constexpr u32 k_CacheVersion = 1;
+
+		ShaderReflection(void) = default;
+		ShaderReflection(const u32* spv, u64 word_count);
+		inline ShaderReflection(const ShaderBinary& binary) : ShaderReflection(binary.ptr(), binary.data().size()) {}
+
+		/// 
+		/// written next to the .spv by AssetRegistry, Load returns nullopt
+		/// if the file is missing or was written by another version
+		/// 
+		void save(const std::filesystem::path& path) const;
+		[[nodiscard]] static std::optional<ShaderReflection> Load(const std::filesystem::path& path);
+
+		[[nodiscard]] inline ShaderStageBits stage(void) const { return m_Stage; }
+
+		[[nodiscard]] inline const std::vector<ShaderAttribute>& vertex_inputs(void) const { return m_VertexInputs; }
+		[[nodiscard]] inline const std::vector<ShaderUniform>& uniforms(void) const { return m_Uniforms; }
+
+		// shader_stage is None without a push constant block
+		[[nodiscard]] inline const PushConstant& push_constant(void) const { return m_PushConstant; }
+	private:
+		ShaderStageBits m_Stage = ShaderStageBits::None;
+
+		std::vector<ShaderAttribute> m_VertexInputs;
+		std::vector<ShaderUniform> m_Uniforms;
+		PushConstant m_PushConstant{ ShaderStageBits::None, 0, 0 };
+	};
+} // namespace Na
+
+#endif // NA_SHADER_REFLECTION_HPP
@@ -0,0 +1,72 @@
+#if !defined(NA_SHADER_VARIANTS_HPP)
+#define NA_SHADER_VARIANTS_HPP
+
+#include "Natrium/Assets/AssetRegistry.hpp"
+#include "Natrium/Graphics/ShaderModule.hpp"
+
+namespace Na {
+	/// 
+	/// the variants of one shader source, each compiled through the registry the first time
+	/// its permutation is asked for and kept loaded after, keyed by ShaderPermutation::key
+	/// 
+	/// e.g. variants.get(ShaderPermutation().toggle("NORMAL_MAP", material.normal_map))
+	/// instead of branching on a uniform in the shader
+	/// 
+	/// safe to call from multiple threads, a variant is compiled once even if it is requested
+	/// by several at the same time
+	/// 
+	class ShaderVariants {
+	public:
+		ShaderVariants(
+			const AssetRegistry& registry,
+			const std::string_view& src_path,
+			ShaderStageBits stage,
+			const std::string_view& entry_point = "main"
+		);
+
+		ShaderVariants(const ShaderVariants& other) = delete;
+		ShaderVariants& operator=(const ShaderVariants& other) = delete;
+
+		// the modules view the entry point stored here
+		ShaderVariants(ShaderVariants&& other) = delete;
+		ShaderVariants& operator=(ShaderVariants&& other) = delete;
+
+		// stays valid until clear or destruction
+		[[nodiscard]] const ShaderModule& get(const ShaderPermutation& permutation = {});
+
+		/// 
+		/// compiles every permutation that is not loaded yet, as up to thread_count jobs
+		/// (0 uses every JobSystem worker and the caller), e.g. during a loading screen
+		/// 
+		void precompile(std::span<const ShaderPermutation> permutations, u32 thread_count = 0);
+
+		// warning: the modules must not be used by a pipeline that is still being created
+		void clear(void);
+
+		[[nodiscard]] inline u64 size(void) const { std::lock_guard lock(m_Mutex); return m_Variants.size(); }
+
+		[[nodiscard]] inline const std::string& src_path(void) const { return m_SrcPath; }
+		[[nodiscard]] inline ShaderStageBits stage(void) const { return m_Stage; }
+		[[nodiscard]] inline const std::string& entry_point(void) const { return m_EntryPoint; }
+	private:
+		struct Variant {
+			ShaderPermutation permutation;
+			std::once_flag compiled;
+			ShaderModule module;
+		};
+
+		Variant& _variant(const ShaderPermutation& permutation);
+	private:
+		const AssetRegistry* m_Registry;
+
+		std::string m_SrcPath;
+		ShaderStageBits m_Stage;
+		std::string m_EntryPoint;
+
+		// a key collision falls back to comparing the permutations
+		std::unordered_multimap<u64, std::unique_ptr<Variant>> m_Variants;
+		mutable std::mutex m_Mutex;
+	};
+} // namespace Na
+
+#endif // NA_SHADER_VARIANTS_HPP
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define NA_TEXTURE_HPP
 
 #include "Natrium/Assets/ImageAsset.hpp"
+#include "Natrium/Assets/ImageCompression.hpp"
 #include "Natrium/Graphics/DeviceImage.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/SamplerCache.hpp"
 
 namespace Na {
 	class Texture {
@@ -11,14 +13,48 @@ namespace Na {
 		const ShaderUniformType descriptor_type = ShaderUniformType::Texture;
 
 		Texture(void) = default;
+
+		/// 
+		/// the sampler comes from VkContext::GetSamplerCache, so textures with the same
+		/// description share it, SamplerInfo::FromSettings(renderer_settings) by default
+		/// 
+		Texture(const AssetHandle<Image>* imgs, u32 count, const RendererSettings& renderer_settings, const SamplerInfo& sampler_info);
+
+		Texture(const AssetHandle<Image>* imgs, u32 count, const RendererSettings& renderer_settings)
+		: Texture(imgs, count, renderer_settings, SamplerInfo::FromSettings(renderer_settings)) {}
+
 		Texture(AssetHandle<Image> img, const RendererSettings& renderer_settings)
 		: Texture(&img, 1, renderer_settings) {}
 
-		Texture(const AssetHandle<Image>* imgs, u32 count, const RendererSettings& renderer_settings);
+		Texture(AssetHandle<Image> img, const RendererSettings& renderer_settings, const SamplerInfo& sampler_info)
+		: Texture(&img, 1, renderer_settings, sampler_info) {}
 
 		Texture(const std::initializer_list<AssetHandle<Image>>& imgs, const RendererSettings& renderer_settings)
 		: Texture(imgs.begin(), (u32)imgs.size(), renderer_settings) {}
 
+		/// 
+		/// loads and decodes every image in parallel on the JobSystem, then creates an array
+		/// with a layer per path like the constructor, which needs them all the same size and format
+		/// 
+		/// decoded images are block compressed in parallel too unless compression is None,
+		/// the mip chain is then built on the cpu, container formats (.ktx2 / .dds) are kept as they are,
+		/// as are images when the device can not sample the compressed format
+		/// 
+		[[nodiscard]] static Texture LoadArray(
+			std::span<const std::filesystem::path> paths,
+			const RendererSettings& renderer_settings,
+			const SamplerInfo& sampler_info,
+			ImageCompression compression = ImageCompression::None
+		);
+		[[nodiscard]] static inline Texture LoadArray(
+			std::span<const std::filesystem::path> paths,
+			const RendererSettings& renderer_settings,
+			ImageCompression compression = ImageCompression::None
+		)
+		{
+			return LoadArray(paths, renderer_settings, SamplerInfo::FromSettings(renderer_settings), compression);
+		}
+
 		inline ~Texture(void) { this->destroy(); }
 		void destroy(void);
 
@@ -35,14 +71,26 @@ namespace Na {
 		[[nodiscard]] inline u32 width(void) const { return m_Image.width; }
 		[[nodiscard]] inline u32 height(void) const { return m_Image.height; }
 		[[nodiscard]] inline u32 count(void) const { return m_Image.layer_count(); }
+		[[nodiscard]] inline u32 mip_levels(void) const { return m_Image.mip_levels(); }
 
 		[[nodiscard]] inline const DeviceImage& img(void) const { return m_Image; }
 		[[nodiscard]] inline vk::ImageView img_view(void) const { return m_ImageView; }
-		[[nodiscard]] inline vk::Sampler sampler(void) const { return m_Sampler; }
+		[[nodiscard]] inline vk::Sampler sampler(void) const { return m_Sampler; } // owned by the sampler cache
+
+		/// 
+		/// stable for the texture's lifetime, k_NullBindlessIndex without a bindless table
+		/// 
+		[[nodiscard]] inline BindlessIndex bindless_index(void) const { return m_BindlessIndex; }
 	private:
+		friend class TextureStreamer;
+
+		// the view, sampler and bindless entry of m_Image
+		void _create_view(const SamplerInfo& sampler_info);
+
 		DeviceImage m_Image;
 		vk::ImageView m_ImageView = nullptr;
 		vk::Sampler m_Sampler = nullptr;
+		BindlessIndex m_BindlessIndex = k_NullBindlessIndex;
 	};
 } // namespace Na
 
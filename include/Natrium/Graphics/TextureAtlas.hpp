@@ -0,0 +1,131 @@
+#if !defined(NA_TEXTURE_ATLAS_HPP)
+#define NA_TEXTURE_ATLAS_HPP
+
+#include "Natrium/Assets/ImageAsset.hpp"
+#include "Natrium/Graphics/DeviceImage.hpp"
+#include "Natrium/Graphics/SamplerCache.hpp"
+#include "Natrium/Graphics/BindlessTable.hpp"
+
+namespace Na {
+	struct AtlasRegion {
+		u32 layer = 0;
+		u32 x = 0, y = 0, width = 0, height = 0; // texels within the layer, without padding
+
+		// normalized, sampled together with layer from a sampler2DArray
+		glm::vec2 uv_min = { 0.0f, 0.0f };
+		glm::vec2 uv_max = { 0.0f, 0.0f };
+
+		[[nodiscard]] inline operator bool(void) const { return width; }
+	};
+
+	struct TextureAtlasInfo {
+		u32 size = 2048; // width and height of every layer
+		u32 layer_count = 4; // allocated up front, add fails once all of them are full, one layer gets a plain 2D view
+
+		// images added have to match it, only formats with 4 bytes per texel
+		vk::Format format = vk::Format::eR8G8B8A8Srgb;
+
+		// cleared texels around each region, so linear filtering never bleeds into a neighbour
+		u32 padding = 1;
+
+		SamplerInfo sampler = {
+			.address_u = vk::SamplerAddressMode::eClampToEdge,
+			.address_v = vk::SamplerAddressMode::eClampToEdge,
+			.address_w = vk::SamplerAddressMode::eClampToEdge,
+			.max_lod = 0.0f // no mip levels, they would mix neighbouring regions
+		};
+	};
+
+	/// 
+	/// packs many small images into the layers of one array image with a skyline
+	/// (bottom left) packer, so sprites and icons share one image, view and sampler and
+	/// can be drawn without rebinding, see AtlasRegion::uv_min and uv_max
+	/// 
+	/// regions are added at runtime, their texels are copied on add and uploaded by the
+	/// next record on the graphics queue, so frames still in flight keep sampling the
+	/// other regions undisturbed, regions are never moved once packed
+	/// 
+	/// warning: not thread safe
+	/// 
+	class TextureAtlas {
+	public:
+		static constexpr u32 k_TexelSize = 4;
+
+		TextureAtlas(void) = default;
+		TextureAtlas(const TextureAtlasInfo& info);
+		void destroy(void);
+		inline ~TextureAtlas(void) { this->destroy(); }
+
+		TextureAtlas(const TextureAtlas& other) = delete;
+		TextureAtlas& operator=(const TextureAtlas& other) = delete;
+
+		TextureAtlas(TextureAtlas&& other);
+		TextureAtlas& operator=(TextureAtlas&& other);
+
+		/// 
+		/// pixels are width * height texels of the atlas' format, tightly packed,
+		/// returns an empty region if no layer has room left
+		/// 
+		[[nodiscard]] AtlasRegion add(const void* pixels, u32 width, u32 height);
+
+		// only the first level is packed, the format has to match the atlas'
+		[[nodiscard]] AtlasRegion add(const ImageAsset& img);
+
+		/// 
+		/// forgets every region, new ones overwrite the old texels, which frames still
+		/// in flight may read, so the previous regions must not be drawn anymore
+		/// 
+		void clear(void);
+
+		/// 
+		/// uploads what was added since the last call, cmd_buffer has to be outside of a render pass
+		/// and submitted before anything sampling the new regions, e.g. Renderer::pre_pass_cmd_buffer,
+		/// returns false if there was nothing to upload
+		/// 
+		bool record(vk::CommandBuffer cmd_buffer);
+
+		[[nodiscard]] inline bool pending(void) const { return !m_Copies.empty(); }
+
+		// of the packed area, padding included, 0 to 1
+		[[nodiscard]] float occupancy(u32 layer) const;
+
+		[[nodiscard]] inline const DeviceImage& img(void) const { return m_Image; }
+		[[nodiscard]] inline vk::ImageView img_view(void) const { return m_ImageView; }
+		[[nodiscard]] inline vk::Sampler sampler(void) const { return m_Sampler; } // owned by the sampler cache
+
+		// k_NullBindlessIndex without a bindless table
+		[[nodiscard]] inline BindlessIndex bindless_index(void) const { return m_BindlessIndex; }
+
+		[[nodiscard]] inline const TextureAtlasInfo& info(void) const { return m_Info; }
+		[[nodiscard]] inline operator bool(void) const { return m_Image; }
+	private:
+		// the top edge of the packed area over [x, x + width)
+		struct SkylineNode {
+			u32 x, y, width;
+		};
+
+		struct Layer {
+			std::vector<SkylineNode> skyline;
+			u64 used_area = 0;
+		};
+
+		// the lowest y a width wide rect starting at node fits at, k_U32Max if it does not
+		[[nodiscard]] u32 _fit(const Layer& layer, u64 node, u32 width, u32 height) const;
+		void _insert(Layer& layer, u64 node, u32 x, u32 y, u32 width, u32 height);
+	private:
+		TextureAtlasInfo m_Info;
+
+		DeviceImage m_Image;
+		vk::ImageView m_ImageView = nullptr;
+		vk::Sampler m_Sampler = nullptr;
+		BindlessIndex m_BindlessIndex = k_NullBindlessIndex;
+
+		std::vector<Layer> m_Layers;
+
+		// texels added since the last record, non-overlapping, so one barrier covers all of them
+		std::vector<Byte> m_Staging;
+		std::vector<vk::BufferImageCopy> m_Copies;
+	};
+} // namespace Na
+
+#endif // NA_TEXTURE_ATLAS_HPP
\ No newline at end of file
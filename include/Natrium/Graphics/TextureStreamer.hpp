@@ -0,0 +1,137 @@
+#if !defined(NA_TEXTURE_STREAMER_HPP)
+#define NA_TEXTURE_STREAMER_HPP
+
+#include "Natrium/Graphics/Texture.hpp"
+#include "Natrium/Graphics/UploadManager.hpp"
+
+namespace Na {
+	using StreamedTextureID = u32;
+	constexpr StreamedTextureID k_NullStreamedTextureID = k_U32Max;
+
+	struct TextureStreamerSettings {
+		// bytes of streamed mip levels resident on the gpu, the coarse levels
+		// every texture keeps (see min_resident_extent) may exceed it
+		u64 budget = 512ull * 1024 * 1024;
+
+		// textures start with, and are never evicted below, their largest level
+		// that fits this many texels on its longest side
+		u32 min_resident_extent = 64;
+
+		// finer levels staged per update, keeps a burst of requests from stalling a frame
+		u64 max_upload_bytes_per_update = 16ull * 1024 * 1024;
+
+		// updates without a request before a texture falls back to its coarse levels
+		u32 evict_after_updates = 120;
+	};
+
+	/// 
+	/// keeps the images of its textures on the cpu with every mip level and only
+	/// the levels that were requested on the gpu, within a budget:
+	/// - request() (e.g. from the screen size of the objects using a texture, see
+	///   mip_for_screen_size, or from shader feedback) asks for a finer level
+	/// - update() once per frame swaps in finished uploads, stages new ones and
+	///   evicts the least recently requested textures first when over budget
+	/// 
+	/// levels are changed by uploading a new image, a texture's image view (and its
+	/// bindless index) therefore change whenever update() lists it in changed(),
+	/// descriptor sets holding it have to be written again, the previous image stays
+	/// alive for max_frames_in_flight more updates
+	/// 
+	/// images without pre-baked mip levels (see ImageAsset) are always fully resident
+	/// 
+	/// warning: not thread safe
+	/// 
+	class TextureStreamer {
+	public:
+		TextureStreamer(void) = default;
+		TextureStreamer(const TextureStreamerSettings& settings, const RendererSettings& renderer_settings);
+		void destroy(void);
+		inline ~TextureStreamer(void) { this->destroy(); }
+
+		TextureStreamer(const TextureStreamer& other) = delete;
+		TextureStreamer& operator=(const TextureStreamer& other) = delete;
+
+		TextureStreamer(TextureStreamer&& other) = delete;
+		TextureStreamer& operator=(TextureStreamer&& other) = delete;
+
+		/// 
+		/// uploads the coarse levels right away, img is kept for the texture's lifetime
+		/// 
+		[[nodiscard]] StreamedTextureID add(AssetHandle<Image> img);
+		void remove(StreamedTextureID id);
+
+		/// 
+		/// mip is the finest level needed until the next update, requests within one update
+		/// keep the finest of them
+		/// 
+		void request(StreamedTextureID id, u32 mip);
+
+		/// 
+		/// the level whose texels roughly match screen_pixels, the longest side of the
+		/// area the texture covers on screen
+		/// 
+		[[nodiscard]] u32 mip_for_screen_size(StreamedTextureID id, float screen_pixels) const;
+
+		void update(void);
+
+		/// 
+		/// textures whose image view and bindless index changed in the last update
+		/// 
+		[[nodiscard]] inline const std::vector<StreamedTextureID>& changed(void) const { return m_Changed; }
+
+		[[nodiscard]] inline const Texture& texture(StreamedTextureID id) const { return m_Entries[id].texture; }
+		[[nodiscard]] inline u32 resident_mip(StreamedTextureID id) const { return m_Entries[id].resident_mip; }
+
+		[[nodiscard]] inline u64 resident_bytes(void) const { return m_ResidentBytes; }
+		[[nodiscard]] inline u64 budget(void) const { return m_Settings.budget; }
+		inline void set_budget(u64 budget) { m_Settings.budget = budget; }
+	private:
+		struct Entry {
+			AssetHandle<Image> source; // every level, on the cpu
+			Texture texture;
+
+			u32 resident_mip = 0; // finest level on the gpu
+			u32 coarsest_mip = 0; // coarsest level the texture may be evicted to
+			u32 requested_mip = 0;
+			u64 last_request = 0; // update of the last request
+
+			// at most one upload in flight, swapped in once the ticket completes
+			DeviceImage pending_img;
+			u32 pending_mip = k_U32Max;
+			UploadTicket ticket = 0;
+
+			bool alive = false;
+		};
+
+		// destroyed once the frames that may still read it are done
+		struct Retired {
+			DeviceImage img;
+			vk::ImageView img_view = nullptr;
+			BindlessIndex bindless_index = k_NullBindlessIndex;
+			u64 update = 0;
+		};
+
+		[[nodiscard]] u64 _bytes(const Entry& entry, u32 mip) const;
+		void _stage(Entry& entry, u32 mip);
+		void _swap(Entry& entry);
+		void _retire(Texture& texture);
+		void _destroy(Retired& retired);
+	private:
+		TextureStreamerSettings m_Settings;
+		u32 m_MaxFramesInFlight = 0;
+
+		vk::Sampler m_Sampler = nullptr; // shared by every streamed texture, owned by the sampler cache
+
+		// a deque so Texture references stay valid as textures are added
+		std::deque<Entry> m_Entries;
+		std::vector<StreamedTextureID> m_FreeIDs;
+
+		std::deque<Retired> m_Retired;
+		std::vector<StreamedTextureID> m_Changed;
+
+		u64 m_Update = 0;
+		u64 m_ResidentBytes = 0;
+	};
+} // namespace Na
+
+#endif // NA_TEXTURE_STREAMER_HPP
\ No newline at end of file
@@ -0,0 +1,132 @@
+#if !defined(NA_UPLOAD_MANAGER_HPP)
+#define NA_UPLOAD_MANAGER_HPP
+
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+#include "Natrium/Graphics/DeviceImage.hpp"
+
+namespace Na {
+	using UploadTicket = u64;
+
+	/// 
+	/// batches buffer and image uploads into one submission on the transfer queue,
+	/// staging memory comes from a persistently mapped ring that is recycled as batches complete
+	/// 
+	/// when the transfer queue belongs to a different family, ownership is released on it
+	/// and acquired on the graphics queue in the same flush, so later graphics submissions
+	/// are ordered after the upload without the cpu ever waiting
+	/// 
+	/// images end up in eShaderReadOnlyOptimal, unless every level is given only the first
+	/// mip level is uploaded and the rest of the chain is blitted from it on the graphics queue
+	/// (so those images need eTransferSrc usage and a format that supports linear blits)
+	/// 
+	class UploadManager {
+	public:
+		static constexpr vk::DeviceSize k_DefaultStagingSize = 32ull * 1024 * 1024;
+		static constexpr vk::DeviceSize k_StagingAlignment = 16; // covers texel and block sizes for buffer to image copies
+
+		UploadManager(void) = default;
+		UploadManager(vk::DeviceSize staging_size);
+		void destroy(void);
+		inline ~UploadManager(void) { this->destroy(); }
+
+		UploadManager(const UploadManager& other) = delete;
+		UploadManager& operator=(const UploadManager& other) = delete;
+
+		UploadManager(UploadManager&& other) = delete;
+		UploadManager& operator=(UploadManager&& other) = delete;
+
+		/// 
+		/// returns staging memory to be filled with size bytes for dst,
+		/// warning: has to be written before anything else is staged or flushed
+		/// 
+		[[nodiscard]] void* stage_buffer(const DeviceBuffer& dst, vk::DeviceSize size, vk::DeviceSize dst_offset = 0);
+
+		/// 
+		/// returns staging memory to be filled with every layer of dst, tightly packed
+		/// warning: has to be written before anything else is staged or flushed
+		/// 
+		[[nodiscard]] void* stage_image(DeviceImage& dst, vk::DeviceSize size);
+
+		/// 
+		/// copies data into staging memory right away, so it can be freed on return
+		/// 
+		void upload(const DeviceBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dst_offset = 0);
+		void upload(DeviceImage& dst, const void* data, vk::DeviceSize size);
+
+		/// 
+		/// layers has one pointer per layer of dst, each layer_size bytes
+		/// 
+		void upload(DeviceImage& dst, const void* const* layers, vk::DeviceSize layer_size);
+
+		/// 
+		/// uploads every mip level of dst, nothing is generated (e.g. block compressed images),
+		/// levels has one pointer per level of each layer, layer major, largest level first,
+		/// level_sizes has one size per level, each is copied straight from its pointer
+		/// 
+		void upload(DeviceImage& dst, const void* const* levels, const vk::DeviceSize* level_sizes);
+
+		/// 
+		/// submits everything staged so far, also retires completed batches
+		/// returns the ticket of the submitted batch (or of the last one if nothing was staged)
+		/// 
+		UploadTicket flush(void);
+
+		[[nodiscard]] bool is_complete(UploadTicket ticket);
+		void wait(UploadTicket ticket);
+		inline void wait_idle(void) { this->wait(this->flush()); }
+
+		[[nodiscard]] inline vk::DeviceSize staging_size(void) const { return m_Staging.size; }
+		[[nodiscard]] inline bool uses_transfer_queue(void) const { return m_TransferFamily != m_GraphicsFamily; }
+	private:
+		struct MipChain {
+			vk::Image img;
+			vk::Extent3D extent;
+			vk::ImageSubresourceRange range;
+		};
+
+		struct Batch {
+			vk::CommandBuffer transfer_cmd = nullptr;
+			vk::CommandBuffer acquire_cmd = nullptr; // only with a separate transfer family
+			vk::Semaphore semaphore = nullptr; // transfer -> acquire
+			vk::Fence fence = nullptr;
+
+			UploadTicket ticket = 0;
+			vk::DeviceSize staging_bytes = 0;
+			std::vector<DeviceBuffer> oversized; // uploads larger than the ring
+
+			// recorded at flush, split into release/acquire with a separate transfer family
+			std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+			std::vector<vk::ImageMemoryBarrier> image_barriers;
+
+			// generated after the acquire, images stay in eTransferDstOptimal until then
+			std::vector<MipChain> mip_chains;
+		};
+
+		void* _stage_buffer(const DeviceBuffer& dst, vk::DeviceSize size, vk::DeviceSize dst_offset);
+		void* _stage_image(DeviceImage& dst, vk::DeviceSize size, const vk::DeviceSize* level_sizes = nullptr);
+		void* _stage(vk::DeviceSize size, vk::Buffer& buffer, vk::DeviceSize& offset);
+		Batch& _current_batch(void);
+		UploadTicket _flush(void);
+		void _retire(bool wait_for_oldest);
+	private:
+		DeviceBuffer m_Staging;
+		vk::DeviceSize m_Head = 0;
+		vk::DeviceSize m_Used = 0;
+
+		u32 m_GraphicsFamily = 0;
+		u32 m_TransferFamily = 0;
+		vk::CommandPool m_TransferCmdPool = nullptr;
+		vk::CommandPool m_GraphicsCmdPool = nullptr;
+
+		std::optional<Batch> m_Current;
+		std::deque<Batch> m_InFlight;
+		std::vector<Batch> m_FreeBatches;
+
+		UploadTicket m_NextTicket = 1;
+		UploadTicket m_CompletedTicket = 0;
+
+		std::mutex m_Mutex;
+	};
+} // namespace Na
+
+#endif // NA_UPLOAD_MANAGER_HPP
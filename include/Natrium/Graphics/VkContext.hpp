@@ -2,20 +2,42 @@
 #define NA_VK_CONTEXT_HPP
 
 #include "Natrium/Core.hpp"
+#include "Natrium/Core/ContextSettings.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
+#include "Natrium/Graphics/UploadManager.hpp"
+#include "Natrium/Graphics/BindlessTable.hpp"
+#include "Natrium/Graphics/DeletionQueue.hpp"
+#include "Natrium/Graphics/ImmediateCommands.hpp"
+#include "Natrium/Graphics/SamplerCache.hpp"
 
 namespace Na {
     inline constexpr bool k_ValidationLayersEnabled = k_BuildConfig != BuildConfig::Distribution;
 
 	struct SurfaceSupport {
 		vk::SurfaceCapabilitiesKHR capabilities;
-		Na::ArrayVector<vk::SurfaceFormatKHR> formats;
-		Na::ArrayVector<vk::PresentModeKHR> present_modes;
+		Na::ArrayVector<vk::SurfaceFormatKHR, 16> formats;
+		Na::ArrayVector<vk::PresentModeKHR, 8> present_modes;
 
 		inline operator bool(void) const { return formats.size() && present_modes.size(); }
 
 		static SurfaceSupport Get(vk::SurfaceKHR surface, vk::PhysicalDevice device);
 	};
 
+	/// 
+	/// optional device features, enabled whenever the physical device supports them
+	/// 
+	struct DeviceFeatures {
+		bool multi_draw_indirect = false;
+		bool draw_indirect_first_instance = false;
+		bool draw_indirect_count = false; // VK_KHR_draw_indirect_count
+		bool dynamic_rendering = false; // VK_KHR_dynamic_rendering
+		bool pipeline_statistics_query = false;
+		bool descriptor_indexing = false; // VK_EXT_descriptor_indexing with everything BindlessTable needs
+		bool timeline_semaphore = false; // VK_KHR_timeline_semaphore
+		bool memory_budget = false; // VK_EXT_memory_budget, DeviceMemoryReport has budgets
+		bool synchronization2 = false; // VK_KHR_synchronization2, BarrierBatch records per barrier stages
+	};
+
 	class VkContext {
 	public:
 		VkContext(void) = default;
@@ -26,11 +48,30 @@ namespace Na {
 		VkContext(VkContext&& other);
 		VkContext& operator=(VkContext&& other);
 
-		static VkContext Initialize(void);
+		/// 
+		/// the pipeline cache is loaded from pipeline_cache_path if it was written for the same device
+		/// and driver, and saved there again on shutdown, an empty path disables the persistence
+		/// 
+		/// a headless context needs neither glfw nor a display, but can not present,
+		/// only headless RendererCores work with it
+		/// 
+		static VkContext Initialize(const std::filesystem::path& pipeline_cache_path = {}, const ContextSettings& settings = {});
 		static void Shutdown(void);
 
-		static inline void WaitForRemainingDeviceTasks(void) { s_Context->m_LogicalDevice.waitIdle(); }
+		/// 
+		/// writes the pipeline cache to the path given to Initialize, e.g. after loading a level
+		/// 
+		static void SavePipelineCache(void);
 
+		/// 
+		/// waits for the device to idle, then destroys everything left in the deletion queue
+		/// 
+		static void WaitForRemainingDeviceTasks(void);
+
+		/// 
+		/// a recycled command buffer for one-off work on the graphics queue, End submits it
+		/// and waits for its fence, both join the current ImmediateBatch of the thread instead
+		/// 
 		static vk::CommandBuffer BeginSingleTimeCommands(void);
 		static void EndSingleTimeCommands(vk::CommandBuffer cmd_buffer);
 
@@ -40,19 +81,125 @@ namespace Na {
 		[[nodiscard]] static inline vk::Device                 GetLogicalDevice(void)  { return s_Context->m_LogicalDevice; }
 
 		[[nodiscard]] static inline vk::Queue                  GetGraphicsQueue(void)  { return s_Context->m_GraphicsQueue; }
+		[[nodiscard]] static inline vk::Queue                  GetTransferQueue(void)  { return s_Context->m_TransferQueue; }
+		[[nodiscard]] static inline vk::Queue                  GetComputeQueue(void)   { return s_Context->m_ComputeQueue; }
+
+		[[nodiscard]] static inline QueueFamilyIndices         GetQueueFamilyIndices(void) { return s_Context->m_QueueIndices; }
+
+		/// 
+		/// queues have to be externally synchronized, hold this around every submit and present,
+		/// queues of the same family are the same VkQueue and share one lock
+		/// 
+		[[nodiscard]] static std::unique_lock<std::mutex> QueueLock(vk::Queue queue);
+
+		// internally synchronized, pipelines may be created with it from any thread
+		[[nodiscard]] static inline vk::PipelineCache          GetPipelineCache(void) { return s_Context->m_PipelineCache; }
+
+		[[nodiscard]] static inline DeviceAllocator&           GetDeviceAllocator(void) { return *s_Context->m_DeviceAllocator; }
+		[[nodiscard]] static inline UploadManager&             GetUploadManager(void)   { return *s_Context->m_UploadManager; }
+		[[nodiscard]] static inline DeletionQueue&             GetDeletionQueue(void)   { return *s_Context->m_DeletionQueue; }
+		[[nodiscard]] static inline ImmediateCommands&         GetImmediateCommands(void) { return *s_Context->m_ImmediateCommands; }
+		[[nodiscard]] static inline SamplerCache&              GetSamplerCache(void)    { return *s_Context->m_SamplerCache; }
+
+		/// 
+		/// per heap usage and budgets, usage by DeviceMemoryCategory and their high-water marks,
+		/// also logged by the allocator when it runs out of memory
+		/// 
+		[[nodiscard]] static inline DeviceMemoryReport         GetMemoryReport(void) { return s_Context->m_DeviceAllocator->report(); }
+		static inline void                                     LogMemoryReport(LogLevel level = LogLevel::Info) { s_Context->m_DeviceAllocator->report().log(level); }
+
+		/// 
+		/// queried once by Initialize, so hot paths never go to the driver for them
+		/// 
+		[[nodiscard]] static inline const vk::PhysicalDeviceProperties&       GetPhysicalDeviceProperties(void) { return s_Context->m_Properties; }
+		[[nodiscard]] static inline const vk::PhysicalDeviceLimits&           GetPhysicalDeviceLimits(void) { return s_Context->m_Properties.limits; }
+		[[nodiscard]] static inline const vk::PhysicalDeviceMemoryProperties& GetMemoryProperties(void) { return s_Context->m_MemoryProperties; }
+		[[nodiscard]] static inline std::span<const vk::QueueFamilyProperties> GetQueueFamilyProperties(void) { return *s_Context->m_QueueFamilyProperties; }
+
+		/// 
+		/// memoized per format on first use, safe to call from any thread
+		/// 
+		[[nodiscard]] static vk::FormatProperties GetFormatProperties(vk::Format format);
+
+		[[nodiscard]] static inline const DeviceFeatures&      GetDeviceFeatures(void) { return s_Context->m_Features; }
+		[[nodiscard]] static inline bool                       IsHeadless(void) { return s_Context->m_Headless; }
+
+		/// 
+		/// nullptr unless ContextSettings::bindless and DeviceFeatures::descriptor_indexing are set
+		/// 
+		[[nodiscard]] static inline BindlessTable*             GetBindlessTable(void) { return s_Context->m_BindlessTable; }
+
+		/// 
+		/// nullptr unless DeviceFeatures::draw_indirect_count is set
+		/// 
+		[[nodiscard]] static inline PFN_vkCmdDrawIndexedIndirectCountKHR GetCmdDrawIndexedIndirectCount(void) { return s_Context->m_CmdDrawIndexedIndirectCount; }
+
+		/// 
+		/// nullptr unless DeviceFeatures::dynamic_rendering is set
+		/// 
+		[[nodiscard]] static inline PFN_vkCmdBeginRenderingKHR GetCmdBeginRendering(void) { return s_Context->m_CmdBeginRendering; }
+		[[nodiscard]] static inline PFN_vkCmdEndRenderingKHR GetCmdEndRendering(void) { return s_Context->m_CmdEndRendering; }
+
+		/// 
+		/// nullptr unless DeviceFeatures::timeline_semaphore is set
+		/// 
+		[[nodiscard]] static inline PFN_vkWaitSemaphoresKHR GetWaitSemaphores(void) { return s_Context->m_WaitSemaphores; }
+		[[nodiscard]] static inline PFN_vkGetSemaphoreCounterValueKHR GetSemaphoreCounterValue(void) { return s_Context->m_GetSemaphoreCounterValue; }
+
+		/// 
+		/// nullptr unless DeviceFeatures::synchronization2 is set
+		/// 
+		[[nodiscard]] static inline PFN_vkCmdPipelineBarrier2KHR GetCmdPipelineBarrier2(void) { return s_Context->m_CmdPipelineBarrier2; }
 
 
 		[[nodiscard]] static inline vk::SampleCountFlagBits    GetMSAASamples(bool enabled = true) { return enabled ? s_Context->m_MSAASamples : vk::SampleCountFlagBits::e1; }
 
+		/// 
+		/// the largest count supported by both color and depth attachments that does not exceed
+		/// samples, 0 picks the maximum, see RendererSettings::msaa_samples
+		/// 
+		[[nodiscard]] static vk::SampleCountFlagBits PickMSAASamples(u32 samples);
+
+	private:
+		struct FormatCache;
+		struct QueueLocks;
 	private:
 		vk::Instance               m_Instance;
 		vk::DebugUtilsMessengerEXT m_DebugMessenger;
 		vk::PhysicalDevice         m_PhysicalDevice;
 		vk::Device                 m_LogicalDevice;
+
+		vk::PhysicalDeviceProperties       m_Properties;
+		vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
 												    
 		vk::Queue                  m_GraphicsQueue;
-
-		vk::CommandPool            m_SingleTimeCmdPool;
+		vk::Queue                  m_TransferQueue;
+		vk::Queue                  m_ComputeQueue;
+
+		QueueFamilyIndices         m_QueueIndices;
+
+		vk::PipelineCache          m_PipelineCache;
+
+		// heap allocated since the context is moved with memcpy
+		DeviceAllocator*           m_DeviceAllocator = nullptr;
+		UploadManager*             m_UploadManager = nullptr;
+		BindlessTable*             m_BindlessTable = nullptr;
+		DeletionQueue*             m_DeletionQueue = nullptr;
+		ImmediateCommands*         m_ImmediateCommands = nullptr;
+		SamplerCache*              m_SamplerCache = nullptr;
+		std::filesystem::path*     m_PipelineCachePath = nullptr;
+		std::vector<vk::QueueFamilyProperties>* m_QueueFamilyProperties = nullptr;
+		FormatCache*               m_FormatCache = nullptr;
+		QueueLocks*                m_QueueLocks = nullptr;
+
+		DeviceFeatures             m_Features;
+		bool                       m_Headless = false;
+		PFN_vkCmdDrawIndexedIndirectCountKHR m_CmdDrawIndexedIndirectCount = nullptr;
+		PFN_vkCmdBeginRenderingKHR m_CmdBeginRendering = nullptr;
+		PFN_vkCmdEndRenderingKHR m_CmdEndRendering = nullptr;
+		PFN_vkWaitSemaphoresKHR m_WaitSemaphores = nullptr;
+		PFN_vkGetSemaphoreCounterValueKHR m_GetSemaphoreCounterValue = nullptr;
+		PFN_vkCmdPipelineBarrier2KHR m_CmdPipelineBarrier2 = nullptr;
 
 
 		vk::SampleCountFlagBits    m_MSAASamples = vk::SampleCountFlagBits::e1;
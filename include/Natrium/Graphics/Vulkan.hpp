@@ -11,8 +11,13 @@
 namespace Na {
 	struct QueueFamilyIndices {
 		u32 graphics = UINT32_MAX;
+		// families may be the same, their queues then alias and share VkContext::QueueLock
+		u32 transfer = UINT32_MAX; // a transfer only family if there is one, another one without graphics next, graphics otherwise
+		u32 compute  = UINT32_MAX; // a compute family without graphics if there is one, graphics otherwise
+
 		inline operator bool(void) const { return graphics != UINT32_MAX; }
 
+		// without a surface presentation is not required
 		static QueueFamilyIndices Get(vk::PhysicalDevice device, vk::SurfaceKHR surface);
 	};
 } // namespace Na
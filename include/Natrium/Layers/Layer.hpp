@@ -3,11 +3,28 @@
 
 #include "Natrium/Core.hpp"
 #include "Natrium/Core/Event.hpp"
+#include "Natrium/Core/EventBus.hpp"
 
 namespace Na {
+	/// 
+	/// what a layer's update touches, as bits of resources defined by the application,
+	/// e.g. enum : u64 { Physics = 1 << 0, Audio = 1 << 1, Scene = 1 << 2 }
+	/// 
+	struct LayerAccess {
+		u64 reads = 0;
+		u64 writes = 0;
+
+		[[nodiscard]] inline bool conflicts(const LayerAccess& other) const
+		{
+			return (writes & (other.reads | other.writes)) || (other.writes & reads);
+		}
+	};
+
 	class Layer {
 	public:
-		Layer(i64 priority = 0) : m_Priority(priority) {}
+		// only events of event_types reach on_event, see LayerManager::on_event
+		Layer(i64 priority = 0, EventTypeMask event_types = k_AllEventTypes)
+		: m_Priority(priority), m_EventTypes(event_types) {}
 		virtual ~Layer(void) = default;
 
 		virtual void on_attach(void) {}
@@ -18,10 +35,31 @@ namespace Na {
 		virtual void draw(void) {}
 
 		[[nodiscard]] inline i64 priority(void) const { return m_Priority; }
+		[[nodiscard]] inline EventTypeMask event_types(void) const { return m_EventTypes; }
+
+		/// 
+		/// lets LayerManager::update run this update concurrently with neighbouring layers
+		/// it does not conflict with, layers that never declare their access update alone
+		/// 
+		/// draw and on_event are always called in priority order on the calling thread
+		/// 
+		inline void declare_update_access(u64 reads, u64 writes) { m_UpdateAccess = LayerAccess{ reads, writes }; }
+		[[nodiscard]] inline const std::optional<LayerAccess>& update_access(void) const { return m_UpdateAccess; }
 	private:
 		friend class LayerManager;
 
+		enum class State : u8 {
+			Detached = 0,
+			PendingAttach, Attached, PendingDetach
+		};
+
 		i64 m_Priority;
+		EventTypeMask m_EventTypes;
+		std::optional<LayerAccess> m_UpdateAccess;
+
+		State m_State = State::Detached;
+		u64 m_Index = k_U64Max; // in LayerManager::m_Layers while attached
+		EventSubscription m_Subscription; // to LayerManager::m_EventBus, dropped before the layer is detached
 	};
 
 	template<typename t_Layer = Layer>
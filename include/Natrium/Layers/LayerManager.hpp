@@ -2,9 +2,21 @@
 #define NA_LAYER_MANAGER_HPP
 
 #include "Natrium/Layers/Layer.hpp"
+#include "Natrium/Core/EventBus.hpp"
 #include "Natrium/Template/ArrayList.hpp"
 
 namespace Na {
+	/// 
+	/// keeps the layers sorted by descending priority, equal priorities in attach order,
+	/// attaching binary searches its place, detaching empties the layer's slot by its stored index,
+	/// the empty slots are compacted in one pass by the next apply_pending or attach_layer
+	/// 
+	/// attach_layer, detach_layer, detach_all and set_layer_priority called during update, draw
+	/// or on_event are deferred to apply_pending, which update calls before it starts,
+	/// layers waiting to be detached are skipped until then
+	/// 
+	/// warning: not thread safe, layers updating in parallel must not attach or detach layers
+	/// 
 	class LayerManager {
 	public:
 		using iterator = ArrayList<LayerHandle<>>::iterator;
@@ -14,21 +26,51 @@ namespace Na {
 	public:
 		LayerManager(u64 capacity = 2) : m_Layers(capacity) {}
 		~LayerManager(void) = default;
-		inline void destroy(void) { m_Layers.~ArrayList(); }
+		inline void destroy(void) { m_Layers.~ArrayList(); m_PendingAttach.~ArrayList(); }
 
 		inline void reserve(u64 extra_capacity) { m_Layers.reallocate(m_Layers.capacity() + extra_capacity); }
 
 		void attach_layer(LayerHandle<> layer);
-		void detach_layer(LayerHandle<> layer);
+		void detach_layer(const LayerHandle<>& layer);
 
 		void detach_all(void);
 
-		void set_layer_priority(LayerHandle<> layer, i64 new_priority);
+		void set_layer_priority(const LayerHandle<>& layer, i64 new_priority);
+		void set_layer_event_types(const LayerHandle<>& layer, EventTypeMask event_types);
 
+		// stable, only needed if priorities were changed without set_layer_priority
 		void resort(void);
 
-		[[nodiscard]] inline bool empty(void) const { return m_Layers.empty(); }
-		[[nodiscard]] inline u64 size(void) const { return m_Layers.size(); }
+		/// 
+		/// detaches the layers marked during iteration in one pass,
+		/// then merges the layers attached during iteration in
+		/// 
+		void apply_pending(void);
+
+		/// 
+		/// updates the layers in priority order, runs of neighbouring layers whose declared
+		/// access does not conflict update together on the JobSystem, see Layer::declare_update_access
+		/// 
+		/// a layer only starts once every earlier layer it conflicts with finished,
+		/// rethrows the first exception of a run once all of its layers finished
+		/// 
+		void update(double dt);
+
+		void draw(void);
+
+		/// 
+		/// only reaches the layers whose event_types contain the event's type,
+		/// in priority order, stops at the first layer that handles it
+		/// 
+		void on_event(Event& e);
+		void on_events(EventQueue& events);
+
+		[[nodiscard]] inline bool has_pending(void) const { return !m_PendingAttach.empty() || m_PendingDetachCount || m_EmptySlotCount || m_PendingResort; }
+
+		[[nodiscard]] inline bool empty(void) const { return this->size() == 0; }
+		[[nodiscard]] inline u64 size(void) const { return m_Layers.size() - m_EmptySlotCount; }
+
+		// warning: null where a layer was detached, until apply_pending compacted the slots
 
 		[[nodiscard]] inline iterator begin(void) { return m_Layers.begin(); }
 		[[nodiscard]] inline const_iterator begin(void) const { return m_Layers.begin(); }
@@ -45,8 +87,31 @@ namespace Na {
 		[[nodiscard]] inline reverse_iterator rend(void) { return m_Layers.rend(); }
 		[[nodiscard]] inline const_reverse_iterator rend(void) const { return m_Layers.rend(); }
 		[[nodiscard]] inline const_reverse_iterator crend(void) const { return m_Layers.crend(); }
+	private:
+		void _insert(LayerHandle<> layer);
+		void _erase(u64 index); // leaves the slot empty
+
+		// stable, drops the empty slots
+		void _compact(void);
+
+		// the bus holds a raw pointer, which must not outlive the layer's attachment
+		inline void _unsubscribe(Layer& layer) { m_EventBus.unsubscribe(std::exchange(layer.m_Subscription, {})); }
+
+		// from index to the end
+		void _reindex(u64 index);
 	private:
 		ArrayList<LayerHandle<>> m_Layers;
+		ArrayList<LayerHandle<>> m_PendingAttach;
+		u64 m_PendingDetachCount = 0;
+		u64 m_EmptySlotCount = 0; // null entries of m_Layers
+		bool m_PendingResort = false;
+
+		u32 m_IterationDepth = 0; // defers changes while above 0
+
+		EventBus m_EventBus; // rebuilt from m_Layers when dirty
+		bool m_EventBusDirty = true;
+
+		ArrayList<Layer*> m_UpdateRun; // reused by update
 	};
 } // namespace Na
 
@@ -0,0 +1,124 @@
+#if !defined(NA_MODULE_HPP)
+#define NA_MODULE_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Core/DynamicLibrary.hpp"
+#include "Natrium/Core/FileWatcher.hpp"
+#include "Natrium/Layers/LayerManager.hpp"
+
+#if defined(NA_PLATFORM_WINDOWS)
+	#define NA_MODULE_EXPORT extern "C" __declspec(dllexport)
+#else
+	#define NA_MODULE_EXPORT extern "C" __attribute__((visibility("default")))
+#endif // NA_PLATFORM_WINDOWS
+
+/// 
+/// defines the entry points ModuleHost looks up, in exactly one source file of the module,
+/// e.g. NA_MODULE(GameModule)
+/// 
+#define NA_MODULE(t_Module) \
+	NA_MODULE_EXPORT Na::u32 NaModuleVersion(void) { return Na::k_ModuleVersion; } \
+	NA_MODULE_EXPORT Na::Module* NaCreateModule(void) { return new t_Module; } \
+	NA_MODULE_EXPORT void NaDestroyModule(Na::Module* module) { delete module; }
+
+namespace Na {
+	// bumped whenever Module changes, ModuleHost refuses libraries built against another version
+	inline constexpr u32 k_ModuleVersion = 1;
+
+	using ModuleState = std::vector<Byte>;
+
+	/// 
+	/// the code of a reloadable library, created by ModuleHost through the entry points of NA_MODULE
+	/// 
+	/// everything the module created has to be gone after on_unload, the library is unloaded
+	/// right after it and with it the code of its layers, state is the only thing handed over
+	/// 
+	class Module {
+	public:
+		virtual ~Module(void) = default;
+
+		/// 
+		/// attach the module's layers here, state is what the previous version returned
+		/// from on_unload, empty on the first load
+		/// 
+		virtual void on_load(LayerManager& layers, std::span<const Byte> state) = 0;
+
+		/// 
+		/// detach every layer attached in on_load and return what the next version needs
+		/// to continue, the state is dropped if the host shuts down
+		/// 
+		[[nodiscard]] virtual ModuleState on_unload(LayerManager& layers) = 0;
+	};
+
+	/// 
+	/// loads a Module from a library next to the executable (see DynamicLibrary::PathOf)
+	/// and reloads it once the library is rebuilt, between frames
+	/// 
+	/// the library is loaded from a copy, so the build can overwrite it and every version gets
+	/// a path of its own, a new version is only swapped in once it loaded and has the entry
+	/// points, so a broken build keeps the old one running
+	/// 
+	/// warning:
+	/// the module has to share Natrium with the host instead of linking its own copy,
+	/// its globals (g_Logger, VkContext, ...) would be separate otherwise
+	/// nothing created by the module may outlive on_unload, e.g. a LayerHandle kept elsewhere
+	/// 
+	class ModuleHost {
+	public:
+		// linkers write in several steps, the library has to be quiet this long before it is reloaded
+		static constexpr std::chrono::milliseconds k_SettleTime{ 250 };
+
+		/// 
+		/// loads name and calls on_load, throws if it can not be loaded
+		/// 
+		ModuleHost(const std::string_view& name, LayerManager& layers);
+
+		// calls on_unload and drops the state
+		~ModuleHost(void);
+
+		ModuleHost(const ModuleHost& other) = delete;
+		ModuleHost& operator=(const ModuleHost& other) = delete;
+
+		ModuleHost(ModuleHost&& other) = delete;
+		ModuleHost& operator=(ModuleHost&& other) = delete;
+
+		/// 
+		/// reloads the module if its library changed, returns true if it was reloaded
+		/// warning: not during LayerManager::update, draw or on_event, the module's layers are detached
+		/// 
+		bool update(void);
+
+		// returns false and keeps the current version if the library can not be loaded
+		bool reload(void);
+
+		[[nodiscard]] inline Module* module(void) const { return m_Module; }
+		[[nodiscard]] inline const std::filesystem::path& library_path(void) const { return m_LibraryPath; }
+		// 1 for the first load, counts up with every reload
+		[[nodiscard]] inline u32 version(void) const { return m_Version; }
+	private:
+		struct Library {
+			DynamicLibrary library;
+			std::filesystem::path shadow_path;
+			u32 (*version)(void) = nullptr;
+			Module* (*create)(void) = nullptr;
+			void (*destroy)(Module*) = nullptr;
+		};
+
+		// nullopt if the copy can not be loaded or lacks the entry points, the reason is logged
+		[[nodiscard]] std::optional<Library> _load(void);
+		void _unload(void);
+	private:
+		std::string m_Name;
+		std::filesystem::path m_LibraryPath;
+		LayerManager& m_Layers;
+
+		Library m_Library;
+		Module* m_Module = nullptr;
+		u32 m_Version = 0;
+
+		FileWatcher m_Watcher;
+		std::optional<std::chrono::steady_clock::time_point> m_LastChange;
+	};
+} // namespace Na
+
+#endif // NA_MODULE_HPP
\ No newline at end of file
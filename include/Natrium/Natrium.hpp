@@ -4,29 +4,66 @@
 #include "./Core.hpp"
 #include "./Core/Context.hpp"
 #include "./Core/Logger.hpp"
+#include "./Core/BinaryLog.hpp"
 #include "./Core/Event.hpp"
+#include "./Core/EventBus.hpp"
 #include "./Core/Window.hpp"
 #include "./Core/Input.hpp"
 #include "./Core/DeltaTime.hpp"
+#include "./Core/Profiler.hpp"
+#include "./Core/Arena.hpp"
+#include "./Core/JobSystem.hpp"
+#include "./Core/FileWatcher.hpp"
 
 #include "./Layers/Layer.hpp"
 #include "./Layers/LayerManager.hpp"
+#include "./Layers/Module.hpp"
+
+#include "./Scene/ComponentPool.hpp"
+#include "./Scene/Scene.hpp"
+#include "./Scene/Transform.hpp"
 
 #include "./Assets/Asset.hpp"
+#include "./Assets/AssetPack.hpp"
 #include "./Assets/AssetRegistry.hpp"
 #include "./Assets/ImageAsset.hpp"
+#include "./Assets/ImageCompression.hpp"
 #include "./Assets/ShaderAsset.hpp"
 #include "./Assets/ModelAsset.hpp"
+#include "./Assets/MeshOptimizer.hpp"
 
 #include "./Graphics/Renderer/RendererSettings.hpp"
 #include "./Graphics/Renderer/RendererCore.hpp"
 #include "./Graphics/Pipeline.hpp"
+#include "./Graphics/PipelineManager.hpp"
+#include "./Graphics/ParamBlock.hpp"
+#include "./Graphics/ShaderHotReloader.hpp"
+#include "./Graphics/ShaderVariants.hpp"
+#include "./Graphics/ShaderReflection.hpp"
+#include "./Graphics/DescriptorAllocator.hpp"
+#include "./Graphics/DescriptorWriter.hpp"
+#include "./Graphics/BindlessTable.hpp"
+#include "./Graphics/ImmediateCommands.hpp"
+#include "./Graphics/BarrierBatch.hpp"
 #include "./Graphics/Buffers/VertexBuffer.hpp"
 #include "./Graphics/Buffers/IndexBuffer.hpp"
 #include "./Graphics/Buffers/UniformBuffer.hpp"
 #include "./Graphics/Buffers/StorageBuffer.hpp"
+#include "./Graphics/Buffers/TransientBuffer.hpp"
+#include "./Graphics/Buffers/GeometryPool.hpp"
+#include "./Graphics/GpuMesh.hpp"
+#include "./Graphics/SamplerCache.hpp"
 #include "./Graphics/Texture.hpp"
+#include "./Graphics/TextureAtlas.hpp"
+#include "./Graphics/Culling.hpp"
+#include "./Graphics/BatchMath.hpp"
 #include "./Graphics/Renderer/Renderer.hpp"
+#include "./Graphics/Renderer/DrawQueue.hpp"
+#include "./Graphics/Renderer/RenderGraph.hpp"
+#include "./Graphics/Renderer/RenderTarget.hpp"
+#include "./Graphics/Renderer/GpuProfiler.hpp"
+#include "./Graphics/Renderer/DynamicResolution.hpp"
+#include "./Graphics/Renderer/Renderer2D.hpp"
 
 // entry point
 #include "./Main.hpp"
@@ -20,6 +20,11 @@
 #include <filesystem>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #include <limits>
 #include <concepts>
 
@@ -27,16 +32,19 @@
 #include <string_view>
 #include <string>
 #include <array>
+#include <span>
 #include <vector>
 #include <deque>
 #include <list>
 #include <tuple>
+#include <optional>
 #include <memory>
 #include <map>
 #include <unordered_map>
 #include <set>
 #include <unordered_set>
 #include <bitset>
+#include <bit>
 
 #include <fmt/format.h>
 #include <fmt/chrono.h>
@@ -56,5 +64,6 @@
 #include "./Template/ArrayList.hpp"
 #include "./Template/ArrayVector.hpp"
 #include "./Template/DoubleList.hpp"
+#include "./Template/SlotMap.hpp"
 
 #endif // NA_PCH_BASE_HPP
@@ -5,6 +5,7 @@
 
 #include "Natrium/Core.hpp"
 #include "Natrium/Core/Event.hpp"
+#include "Natrium/Template/LockFreeQueue.hpp"
 
 struct GLFWwindow;
 
@@ -12,6 +13,50 @@ namespace Na {
 	void Window_SetGLFWCallbacks(GLFWwindow* window);
 	EventQueue& PollEvents(void);
 
+	// applies from the next PollEvents
+	void SetInputCoalescing(const InputCoalescing& coalescing);
+	[[nodiscard]] const InputCoalescing& GetInputCoalescing(void);
+
+	/// 
+	/// pumps OS events and polls gamepads at a fixed rate, independent of the frame rate,
+	/// and hands the events to one consumer thread through a lock-free queue
+	/// 
+	/// glfw only pumps events on the main thread, so run takes over the main thread
+	/// and the render loop moves to a thread of its own that calls drain every frame
+	/// instead of PollEvents
+	/// 
+	/// while it runs, window state such as width() is written by the pump thread and read
+	/// atomically, the drained events carry the same changes in order
+	/// 
+	/// once the consumer falls more than queue_capacity events behind, consecutive moves, scrolls,
+	/// resizes and axis changes still waiting are merged, presses and releases are always kept
+	/// 
+	class InputPump {
+	public:
+		InputPump(u32 rate_hz = 1000, u64 queue_capacity = 8192);
+
+		InputPump(const InputPump& other) = delete;
+		InputPump& operator=(const InputPump& other) = delete;
+
+		// main thread only, returns once stop was called
+		void run(void);
+
+		// any thread
+		void stop(void);
+		[[nodiscard]] inline bool stopped(void) const { return m_Stop.load(std::memory_order_acquire); }
+
+		// the consumer thread, everything queued since the last call, valid until the next one
+		EventQueue& drain(void);
+	private:
+		SpscQueue<Event> m_Queue;
+		EventQueue m_Backlog; // pumped events that did not fit into m_Queue yet
+		u64 m_BacklogLimit;
+		EventQueue m_Drained;
+
+		double m_Interval;
+		std::atomic<bool> m_Stop = false;
+	};
+
 	class WindowImpl_GLFW {
 	public:
 		WindowImpl_GLFW(void) = default;
@@ -25,29 +70,42 @@ namespace Na {
 		WindowImpl_GLFW& operator=(WindowImpl_GLFW&& other);
 
 		void focus(void);
-		[[nodiscard]] inline bool focused(void) const { return m_Focus; }
+		[[nodiscard]] inline bool focused(void) const { return m_Focus.load(std::memory_order_relaxed); }
 
-		[[nodiscard]] inline bool minimized(void) const { return m_Minimized; }
+		[[nodiscard]] inline bool minimized(void) const { return m_Minimized.load(std::memory_order_relaxed); }
 
-		[[nodiscard]] inline u32 width(void) const { return m_Width; }
-		[[nodiscard]] inline u32 height(void) const { return m_Height; }
+		// width and height of one size, see InputPump
+		[[nodiscard]] inline glm::uvec2 size(void) const { return m_Size.load(std::memory_order_relaxed); }
+		[[nodiscard]] inline u32 width(void) const { return this->size().x; }
+		[[nodiscard]] inline u32 height(void) const { return this->size().y; }
 		void set_size(u32 width, u32 height);
 
 		void set_title(const char* title);
 		[[nodiscard]] const char* title(void) const;
 
+		/// 
+		/// hides and captures the cursor and, if the platform supports it, reports unaccelerated
+		/// mouse motion, MouseMoved then carries a virtual position that is not clamped to the window
+		/// 
+		/// returns whether raw motion is active
+		/// 
+		bool set_raw_mouse_motion(bool enabled);
+		[[nodiscard]] inline bool raw_mouse_motion(void) const { return m_RawMouseMotion; }
+		[[nodiscard]] static bool RawMouseMotionSupported(void);
+
 		[[nodiscard]] inline GLFWwindow* native(void) { return m_Window; }
 		inline operator bool(void) const { return m_Window; }
 	private:
 		friend void Window_SetGLFWCallbacks(GLFWwindow* window);
 	private:
 		GLFWwindow* m_Window = nullptr;
-		union {
-			struct { u32 m_Width, m_Height; };
-			glm::uvec2 m_Size = { 0, 0 };
-		};
-		bool m_Focus = true;
-		bool m_Minimized = false;
+
+		// written by the glfw callbacks, which run on the InputPump thread while it pumps
+		std::atomic<glm::uvec2> m_Size = glm::uvec2{ 0, 0 };
+		std::atomic<bool> m_Focus = true;
+		std::atomic<bool> m_Minimized = false;
+
+		bool m_RawMouseMotion = false;
 	};
 
 	using Window = WindowImpl_GLFW;
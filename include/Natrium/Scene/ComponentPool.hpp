@@ -0,0 +1,163 @@
+#if !defined(NA_COMPONENT_POOL_HPP)
+#define NA_COMPONENT_POOL_HPP
+
+#include "Natrium/Core.hpp"
+#include "Natrium/Template/ArrayList.hpp"
+#include "Natrium/Template/SlotMap.hpp"
+
+namespace Na {
+	class Scene;
+
+	/// 
+	/// a generational handle like SlotHandle, the low 20 bits index the entity,
+	/// a destroyed entity's index is reused with the next generation
+	/// 
+	using Entity = SlotHandle<Scene>;
+
+	/// 
+	/// a sparse set, the owners of the components are stored densely next to them,
+	/// the sparse array maps an entity's index to its position in the dense arrays
+	/// 
+	/// the type erased part, so Scene can remove the components of a destroyed entity
+	/// 
+	class ComponentPoolBase {
+	public:
+		virtual ~ComponentPoolBase(void) = default;
+
+		// false if entity has no component in the pool
+		virtual bool remove(Entity entity) = 0;
+		virtual void clear(void) = 0;
+
+		// position of entity's component in the dense arrays, k_U32Max if it has none
+		[[nodiscard]] inline u32 index_of(Entity entity) const
+		{
+			u32 index = entity.index();
+			if (index >= m_Sparse.size())
+				return k_U32Max;
+
+			u32 dense_index = m_Sparse[index];
+			return dense_index < m_Entities.size() && m_Entities[dense_index] == entity ? dense_index : k_U32Max;
+		}
+		[[nodiscard]] inline bool contains(Entity entity) const { return this->index_of(entity) != k_U32Max; }
+
+		[[nodiscard]] inline std::span<const Entity> entities(void) const { return { m_Entities.ptr(), m_Entities.size() }; }
+
+		[[nodiscard]] inline u64 size(void) const { return m_Entities.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_Entities.empty(); }
+
+		// incremented whenever a component is added, replaced or removed, i.e. the dense indices may have changed
+		[[nodiscard]] inline u64 version(void) const { return m_Version; }
+	protected:
+		// the dense index entity was given, the caller appends its component
+		inline u32 _insert(Entity entity)
+		{
+			u32 index = entity.index();
+			if (index >= m_Sparse.size())
+				m_Sparse.emplace_n(index + 1 - m_Sparse.size(), k_U32Max);
+
+			u32 dense_index = (u32)m_Entities.emplace(entity);
+			m_Sparse[index] = dense_index;
+			m_Version++;
+
+			return dense_index;
+		}
+
+		// moves the last entity into the hole, the caller does the same with its components
+		inline void _erase(u32 dense_index)
+		{
+			u32 last = (u32)m_Entities.size() - 1;
+			m_Sparse[m_Entities[dense_index].index()] = k_U32Max;
+
+			if (dense_index != last)
+			{
+				m_Entities[dense_index] = m_Entities[last];
+				m_Sparse[m_Entities[dense_index].index()] = dense_index;
+			}
+			m_Entities.pop();
+			m_Version++;
+		}
+	protected:
+		ArrayList<u32> m_Sparse; // by entity index
+		ArrayList<Entity> m_Entities;
+		u64 m_Version = 0;
+	};
+
+	/// 
+	/// the components of one type, contiguous in no particular order so systems run over them
+	/// linearly, removing moves the last component into the hole
+	/// 
+	/// warning: pointers and dense indices are invalidated by adding and removing components
+	/// 
+	template<typename T>
+	class ComponentPool : public ComponentPoolBase {
+	public:
+		using T_t = T;
+	public:
+		ComponentPool(void) = default;
+
+		// replaces the component if entity already has one
+		template<typename... t_Args>
+		T& emplace(Entity entity, t_Args&&... __args)
+		{
+			if (u32 dense_index = this->index_of(entity); dense_index != k_U32Max)
+			{
+				m_Components[dense_index] = T(std::forward<t_Args>(__args)...);
+				m_Version++;
+				return m_Components[dense_index];
+			}
+
+			this->_insert(entity);
+			return m_Components[m_Components.emplace(std::forward<t_Args>(__args)...)];
+		}
+
+		bool remove(Entity entity) override
+		{
+			u32 dense_index = this->index_of(entity);
+			if (dense_index == k_U32Max)
+				return false;
+
+			u32 last = (u32)m_Components.size() - 1;
+			if (dense_index != last)
+				m_Components[dense_index] = std::move(m_Components[last]);
+			m_Components.pop();
+
+			this->_erase(dense_index);
+			return true;
+		}
+
+		void clear(void) override
+		{
+			m_Components.clear();
+			m_Entities.clear();
+			m_Sparse.clear();
+			m_Version++;
+		}
+
+		inline void reserve(u64 capacity)
+		{
+			if (capacity > m_Components.capacity())
+			{
+				m_Components.reallocate(capacity);
+				m_Entities.reallocate(capacity);
+			}
+		}
+
+		// nullptr if entity has no component in the pool
+		[[nodiscard]] inline T* get(Entity entity) { u32 dense_index = this->index_of(entity); return dense_index != k_U32Max ? &m_Components[dense_index] : nullptr; }
+		[[nodiscard]] inline const T* get(Entity entity) const { u32 dense_index = this->index_of(entity); return dense_index != k_U32Max ? &m_Components[dense_index] : nullptr; }
+
+		// by dense index, in the order of entities
+		[[nodiscard]] inline T& operator[](u64 dense_index) { return m_Components[dense_index]; }
+		[[nodiscard]] inline const T& operator[](u64 dense_index) const { return m_Components[dense_index]; }
+
+		[[nodiscard]] inline std::span<T> components(void) { return { m_Components.ptr(), m_Components.size() }; }
+		[[nodiscard]] inline std::span<const T> components(void) const { return { m_Components.ptr(), m_Components.size() }; }
+
+		[[nodiscard]] inline T* ptr(void) { return m_Components.ptr(); }
+		[[nodiscard]] inline const T* ptr(void) const { return m_Components.ptr(); }
+	private:
+		ArrayList<T> m_Components;
+	};
+} // namespace Na
+
+#endif // NA_COMPONENT_POOL_HPP
\ No newline at end of file
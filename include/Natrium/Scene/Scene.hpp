@@ -0,0 +1,191 @@
+#if !defined(NA_SCENE_HPP)
+#define NA_SCENE_HPP
+
+#include "Natrium/Scene/ComponentPool.hpp"
+#include "Natrium/Core/JobSystem.hpp"
+
+namespace Na {
+	/// 
+	/// entities are generational handles owning any number of components, at most one of each type,
+	/// every component type lives in its own ComponentPool, so systems iterate contiguous arrays
+	/// 
+	/// e.g. scene.each<Velocity, Transform>([dt](Entity entity, Velocity& velocity, Transform& transform) { ... });
+	/// 
+	/// warning: not thread safe, components must not be added or removed during each / parallel_each
+	/// 
+	class Scene {
+	public:
+		static constexpr u32 k_MaxEntities = Entity::k_IndexMask + 1;
+	public:
+		Scene(void) = default;
+
+		Scene(const Scene& other) = delete;
+		Scene& operator=(const Scene& other) = delete;
+
+		Scene(Scene&& other) = default;
+		Scene& operator=(Scene&& other) = default;
+
+		[[nodiscard]] Entity create(void);
+
+		// removes every component of entity, false if it is not alive
+		bool destroy(Entity entity);
+
+		[[nodiscard]] inline bool alive(Entity entity) const
+		{
+			return entity && entity.index() < m_Generations.size() && m_Generations[entity.index()] == entity.generation();
+		}
+
+		// destroys every entity, the pools keep their types
+		void clear(void);
+
+		// replaces the component if entity already has one of T
+		template<typename T, typename... t_Args>
+		inline T& add(Entity entity, t_Args&&... __args)
+		{
+			NA_ASSERT(this->alive(entity), "Failed to add component: Entity is not alive!");
+			return this->pool<T>().emplace(entity, std::forward<t_Args>(__args)...);
+		}
+
+		template<typename T>
+		inline bool remove(Entity entity) { ComponentPool<T>* pool = this->_find_pool<T>(); return pool && pool->remove(entity); }
+
+		// nullptr if entity has no T
+		template<typename T>
+		[[nodiscard]] inline T* get(Entity entity) { ComponentPool<T>* pool = this->_find_pool<T>(); return pool ? pool->get(entity) : nullptr; }
+		template<typename T>
+		[[nodiscard]] inline const T* get(Entity entity) const { const ComponentPool<T>* pool = this->_find_pool<T>(); return pool ? pool->get(entity) : nullptr; }
+
+		template<typename T>
+		[[nodiscard]] inline bool has(Entity entity) const { const ComponentPool<T>* pool = this->_find_pool<T>(); return pool && pool->contains(entity); }
+
+		// created on first use
+		template<typename T>
+		[[nodiscard]] ComponentPool<T>& pool(void)
+		{
+			u32 type_index = _TypeIndex<T>();
+			if (type_index >= m_Pools.size())
+				m_Pools.resize(type_index + 1);
+
+			std::unique_ptr<ComponentPoolBase>& pool = m_Pools[type_index];
+			if (!pool)
+				pool = std::make_unique<ComponentPool<T>>();
+
+			return static_cast<ComponentPool<T>&>(*pool);
+		}
+
+		/// 
+		/// calls fn(entity, components&...) for every entity with all of t_Components,
+		/// walks the smallest of the pools and looks the entity up in the others
+		/// 
+		template<typename... t_Components, typename t_Fn>
+		void each(t_Fn&& fn)
+		{
+			static_assert(sizeof...(t_Components), "each needs at least one component type!");
+
+			std::tuple<ComponentPool<t_Components>*...> pools{ this->_find_pool<t_Components>()... };
+			const ComponentPoolBase* driver = _Smallest(pools);
+			if (!driver)
+				return;
+
+			_EachRange(pools, *driver, 0, driver->size(), fn);
+		}
+
+		/// 
+		/// like each, the entities are split into batches of at least min_batch run through
+		/// JobSystem::parallel_for, fn is called concurrently for different entities
+		/// 
+		/// fn may write the components it is given and read any other,
+		/// writes to components of other entities are a data race
+		/// 
+		template<typename... t_Components, typename t_Fn>
+		void parallel_each(u64 min_batch, t_Fn&& fn)
+		{
+			static_assert(sizeof...(t_Components), "parallel_each needs at least one component type!");
+
+			std::tuple<ComponentPool<t_Components>*...> pools{ this->_find_pool<t_Components>()... };
+			const ComponentPoolBase* driver = _Smallest(pools);
+			if (!driver)
+				return;
+
+			JobSystem::Get().parallel_for(driver->size(), min_batch, [&](u64 begin, u64 end) { _EachRange(pools, *driver, begin, end, fn); });
+		}
+
+		// alive entities
+		[[nodiscard]] inline u64 size(void) const { return m_AliveCount; }
+		[[nodiscard]] inline bool empty(void) const { return !m_AliveCount; }
+	private:
+		template<typename T>
+		[[nodiscard]] inline ComponentPool<T>* _find_pool(void)
+		{
+			u32 type_index = _TypeIndex<T>();
+			return type_index < m_Pools.size() ? static_cast<ComponentPool<T>*>(m_Pools[type_index].get()) : nullptr;
+		}
+		template<typename T>
+		[[nodiscard]] inline const ComponentPool<T>* _find_pool(void) const
+		{
+			u32 type_index = _TypeIndex<T>();
+			return type_index < m_Pools.size() ? static_cast<const ComponentPool<T>*>(m_Pools[type_index].get()) : nullptr;
+		}
+
+		// nullptr if any of the pools does not exist yet, no entity can have all of them then
+		template<typename... t_Components>
+		[[nodiscard]] static const ComponentPoolBase* _Smallest(const std::tuple<ComponentPool<t_Components>*...>& pools)
+		{
+			const ComponentPoolBase* smallest = nullptr;
+			bool missing = false;
+
+			auto visit = [&](const ComponentPoolBase* pool)
+			{
+				if (!pool)
+					missing = true;
+				else if (!smallest || pool->size() < smallest->size())
+					smallest = pool;
+			};
+			std::apply([&](const auto*... pool) { (visit(pool), ...); }, pools);
+
+			return missing ? nullptr : smallest;
+		}
+
+		template<typename... t_Components, typename t_Fn>
+		static void _EachRange(const std::tuple<ComponentPool<t_Components>*...>& pools, const ComponentPoolBase& driver, u64 begin, u64 end, t_Fn& fn)
+		{
+			std::apply([&](ComponentPool<t_Components>*... pool)
+			{
+				std::span<const Entity> entities = driver.entities();
+
+				// a single pool is its own driver, its components are read in order without lookups
+				if constexpr (sizeof...(t_Components) == 1)
+				{
+					for (u64 i = begin; i < end; i++)
+						fn(entities[i], (*pool)[i]...);
+				} else
+				{
+					for (u64 i = begin; i < end; i++)
+					{
+						Entity entity = entities[i];
+						if ((pool->contains(entity) && ...))
+							fn(entity, *pool->get(entity)...);
+					}
+				}
+			}, pools);
+		}
+
+		// one per component type, shared by every scene
+		template<typename T>
+		[[nodiscard]] static u32 _TypeIndex(void)
+		{
+			static const u32 s_Index = s_NextTypeIndex++;
+			return s_Index;
+		}
+	private:
+		std::vector<std::unique_ptr<ComponentPoolBase>> m_Pools; // by _TypeIndex
+
+		ArrayList<u32> m_Generations; // by entity index
+		ArrayList<u32> m_FreeIndices;
+		u64 m_AliveCount = 0;
+
+		static inline std::atomic<u32> s_NextTypeIndex = 0;
+	};
+} // namespace Na
+
+#endif // NA_SCENE_HPP
\ No newline at end of file
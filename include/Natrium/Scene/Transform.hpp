@@ -0,0 +1,70 @@
+#if !defined(NA_TRANSFORM_HPP)
+#define NA_TRANSFORM_HPP
+
+#include "Natrium/Scene/Scene.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace Na {
+	// relative to the Parent, or the world without one
+	struct Transform {
+		glm::vec3 position{ 0.0f };
+		glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec3 scale{ 1.0f };
+
+		[[nodiscard]] glm::mat4 matrix(void) const;
+	};
+
+	// written by TransformHierarchy::update
+	struct WorldTransform {
+		glm::mat4 matrix{ 1.0f };
+	};
+
+	// change through Scene::add<Parent>, writing the component in place is not seen by TransformHierarchy
+	struct Parent {
+		Entity entity;
+	};
+
+	/// 
+	/// computes the WorldTransform of every entity with a Transform, adding it where it is missing,
+	/// parents are always done before their children
+	/// 
+	/// the entities are grouped by their depth in the hierarchy, each depth is one parallel_for
+	/// over dense pool indices, the order is only rebuilt after Transform, WorldTransform
+	/// or Parent components were added or removed
+	/// 
+	/// an entity whose parent is dead or has no Transform is a root, cycles throw
+	/// 
+	class TransformHierarchy {
+	public:
+		static constexpr u64 k_MinBatch = 512;
+	public:
+		TransformHierarchy(void) = default;
+
+		void update(Scene& scene);
+
+		// forces the next update to rebuild the order
+		inline void invalidate(void) { m_Valid = false; }
+
+		[[nodiscard]] inline u64 size(void) const { return m_Nodes.size(); }
+		[[nodiscard]] inline u32 depth(void) const { return m_LevelOffsets.empty() ? 0 : (u32)m_LevelOffsets.size() - 1; }
+	private:
+		struct Node {
+			u32 transform; // dense index in the Transform pool
+			u32 world; // in the WorldTransform pool
+			u32 parent_world; // in the WorldTransform pool, k_U32Max for roots
+		};
+
+		void _rebuild(Scene& scene);
+	private:
+		std::vector<Node> m_Nodes; // sorted by depth
+		std::vector<u64> m_LevelOffsets; // first node of each depth, plus the end
+
+		bool m_Valid = false;
+		u64 m_TransformVersion = 0;
+		u64 m_WorldVersion = 0;
+		u64 m_ParentVersion = 0;
+	};
+} // namespace Na
+
+#endif // NA_TRANSFORM_HPP
\ No newline at end of file
@@ -0,0 +1,41 @@
+#if !defined(NA_ALLOCATOR_HPP)
+#define NA_ALLOCATOR_HPP
+
+#include "../Core.hpp"
+
+namespace Na {
+	/// 
+	/// the allocator interface of the template containers, allocators are copyable handles:
+	/// - T* allocate(u64 count = 1)
+	/// - T* reallocate(T* buffer, u64 old_count, u64 new_count), may move the bytes of
+	///   the first old_count elements, only used for trivially relocatable types
+	/// - void deallocate(T* buffer, u64 count = 1)
+	/// - operator==, equal allocators can free each other's memory
+	/// 
+	/// HeapAllocator is the global heap through malloc, realloc and free
+	/// 
+	template<typename T>
+	class HeapAllocator {
+	public:
+		[[nodiscard]] inline T* allocate(u64 count = 1)
+		{
+			T* buffer = tmalloc<T>(count);
+			NA_VERIFY(buffer || !count, "Failed to allocate {} bytes: Out of memory!", count * sizeof(T));
+			return buffer;
+		}
+
+		[[nodiscard]] inline T* reallocate(T* buffer, u64 old_count, u64 new_count)
+		{
+			(void)old_count;
+			T* new_buffer = trealloc<T>(buffer, new_count);
+			NA_VERIFY(new_buffer || !new_count, "Failed to allocate {} bytes: Out of memory!", new_count * sizeof(T));
+			return new_buffer;
+		}
+
+		inline void deallocate(T* buffer, u64 count = 1) { (void)count; free((void*)buffer); }
+
+		[[nodiscard]] inline bool operator==(const HeapAllocator& other) const { (void)other; return true; }
+	};
+} // namespace Na
+
+#endif // NA_ALLOCATOR_HPP
\ No newline at end of file
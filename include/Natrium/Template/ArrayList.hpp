@@ -2,9 +2,20 @@
 #define NA_ARRAY_LIST_HPP
 
 #include "./ArrayIterator.hpp"
+#include "./Relocation.hpp"
+#include "./Allocator.hpp"
 
 namespace Na {
-	template<typename T>
+	/// 
+	/// a growable array with an explicit capacity, size changes through resize,
+	/// resize_uninitialized and the constructor's size neither construct nor destroy elements
+	/// 
+	/// reallocating relocates the elements with memcpy if they are trivially relocatable
+	/// and moves them otherwise, see IsTriviallyRelocatable
+	/// 
+	/// the buffer comes from t_Allocator, see Allocator.hpp
+	/// 
+	template<typename T, template<typename> typename t_Allocator = HeapAllocator>
 	class ArrayList {
 	public:
 		using iterator = Array_Iterator<ArrayList>;
@@ -12,18 +23,27 @@ namespace Na {
 		using const_iterator = Array_ConstIterator<ArrayList>;
 		using const_reverse_iterator = Array_ConstReverseIterator<ArrayList>;
 		using T_t = T;
+		using Allocator = t_Allocator<T>;
 	public:
 		inline ArrayList(void)
 		: m_Capacity(0), m_Size(0), m_Buffer(nullptr)
 		{}
 
 		inline ArrayList(u64 capacity, u64 size = 0)
-		: m_Capacity(capacity), m_Size(size), m_Buffer(tmalloc<T>(capacity))
+		: m_Capacity(capacity), m_Size(size), m_Buffer(m_Allocator.allocate(capacity))
+		{}
+
+		inline ArrayList(const Allocator& allocator)
+		: m_Allocator(allocator), m_Capacity(0), m_Size(0), m_Buffer(nullptr)
+		{}
+
+		inline ArrayList(u64 capacity, const Allocator& allocator)
+		: m_Allocator(allocator), m_Capacity(capacity), m_Size(0), m_Buffer(m_Allocator.allocate(capacity))
 		{}
 
 		template<typename t_Iterator>
 		inline ArrayList(const t_Iterator& begin, const t_Iterator& end)
-		: m_Capacity(std::distance(begin, end)), m_Size(m_Capacity), m_Buffer(tmalloc<T>(m_Size))
+		: m_Capacity(std::distance(begin, end)), m_Size(m_Capacity), m_Buffer(m_Allocator.allocate(m_Size))
 		{
 			u64 i = 0;
 			for (t_Iterator it = begin; it != end; it++)
@@ -32,14 +52,14 @@ namespace Na {
 
 
 		inline ArrayList(const T* buffer, u64 size)
-		: m_Capacity(size), m_Size(0), m_Buffer(tmalloc<T>(size))
+		: m_Capacity(size), m_Size(0), m_Buffer(m_Allocator.allocate(size))
 		{
 			while (m_Size < size)
 				this->emplace_d(buffer[m_Size]);
 		}
 
 		inline ArrayList(T* buffer, u64 size)
-		: m_Capacity(size), m_Size(size), m_Buffer(tmalloc<T>(size))
+		: m_Capacity(size), m_Size(0), m_Buffer(m_Allocator.allocate(size))
 		{
 			while (m_Size < size)
 				this->emplace_d(std::move(buffer[m_Size]));
@@ -56,20 +76,30 @@ namespace Na {
 
 			for (u64 i = 0; i < m_Size; i++)
 				m_Buffer[i].~T();
-			free(m_Buffer);
-			memset(this, 0, sizeof(ArrayList));
+			m_Allocator.deallocate(m_Buffer, m_Capacity);
+			m_Buffer = nullptr;
+			m_Capacity = 0;
+			m_Size = 0;
 		}
 
 		inline ArrayList(const ArrayList& other)
-		: ArrayList(other.m_Buffer, other.m_Size) {}
+		: ArrayList(other.m_Size, other.m_Allocator)
+		{
+			while (m_Size < other.m_Size)
+				this->emplace_d(other[m_Size]);
+		}
 
 		inline ArrayList& operator=(const ArrayList& other)
 		{
-			if (m_Capacity < other.m_Capacity)
+			if (this == &other)
+				return *this;
+
+			this->clear();
+			if (m_Capacity < other.m_Size)
 			{
-				free(m_Buffer);
-				m_Buffer = tmalloc<T>(other.m_Capacity);
-				m_Capacity = other.m_Capacity;
+				m_Allocator.deallocate(m_Buffer, m_Capacity);
+				m_Buffer = m_Allocator.allocate(other.m_Size);
+				m_Capacity = other.m_Size;
 			}
 
 			while (m_Size < other.m_Size)
@@ -78,18 +108,26 @@ namespace Na {
 			return *this;
 		}
 
+		// the other list keeps a copy of the allocator, so it stays usable
 		inline ArrayList(ArrayList&& other)
-		{
-			memcpy(this, &other, sizeof(ArrayList));
-			memset(&other, 0, sizeof(ArrayList));
-		}
+		: m_Allocator(other.m_Allocator),
+		m_Capacity(std::exchange(other.m_Capacity, 0)),
+		m_Size(std::exchange(other.m_Size, 0)),
+		m_Buffer(std::exchange(other.m_Buffer, nullptr))
+		{}
 
 		inline ArrayList& operator=(ArrayList&& other)
 		{
+			if (this == &other)
+				return *this;
+
 			this->clear();
-			free(m_Buffer);
-			memcpy(this, &other, sizeof(ArrayList));
-			memset(&other, 0, sizeof(ArrayList));
+			m_Allocator.deallocate(m_Buffer, m_Capacity);
+
+			m_Allocator = other.m_Allocator;
+			m_Capacity = std::exchange(other.m_Capacity, 0);
+			m_Size = std::exchange(other.m_Size, 0);
+			m_Buffer = std::exchange(other.m_Buffer, nullptr);
 			return *this;
 		}
 
@@ -99,16 +137,41 @@ namespace Na {
 			bool cleared = m_Size;
 			for (u64 i = 0; i < m_Size; i++)
 				m_Buffer[i].~T();
+			m_Size = 0;
 			return cleared;
 		}
 
+		// has to fit the capacity
 		inline void resize(u64 new_size) { m_Size = new_size; }
 
-		inline void reallocate(u64 new_capacity)
+		// grows the capacity if needed, the new elements are left for the caller to write
+		inline void resize_uninitialized(u64 new_size)
+		{
+			if (new_size > m_Capacity)
+				this->_grow(new_size);
+			m_Size = new_size;
+		}
+
+		// elements past the new capacity are destroyed
+		void reallocate(u64 new_capacity)
 		{
 			if (new_capacity == m_Capacity)
 				return;
-			m_Buffer = trealloc<T>(m_Buffer, new_capacity);
+
+			for (u64 i = new_capacity; i < m_Size; i++)
+				m_Buffer[i].~T();
+			m_Size = std::min(m_Size, new_capacity);
+
+			if constexpr (k_IsTriviallyRelocatable<T>)
+			{
+				m_Buffer = m_Allocator.reallocate(m_Buffer, m_Capacity, new_capacity);
+			} else
+			{
+				T* buffer = m_Allocator.allocate(new_capacity);
+				RelocateElements(buffer, m_Buffer, m_Size);
+				m_Allocator.deallocate(m_Buffer, m_Capacity);
+				m_Buffer = buffer;
+			}
 			m_Capacity = new_capacity;
 		}
 
@@ -116,19 +179,71 @@ namespace Na {
 
 		inline void reallocate(u64 new_capacity, u64 new_size)
 		{
-			m_Size = new_size;
 			this->reallocate(new_capacity);
+			m_Size = new_size;
 		}
 
 		template<typename... t_Args>
 		inline u64 emplace(t_Args&&... __args)
 		{
 			if (m_Size == m_Capacity)
+			{
+				// the arguments may refer to an element that is about to be relocated
+				T value(std::forward<t_Args>(__args)...);
 				this->reallocate(m_Capacity * 2 + 1);
+				new (m_Buffer + m_Size) T(std::move(value));
+				return m_Size++;
+			}
 			new (m_Buffer + m_Size) T(std::forward<t_Args>(__args)...);
 			return m_Size++;
 		}
 
+		// constructs count elements from the same arguments, returns the index of the first one
+		template<typename... t_Args>
+		u64 emplace_n(u64 count, const t_Args&... __args)
+		{
+			u64 first = m_Size;
+			if (m_Size + count > m_Capacity)
+				this->_grow(m_Size + count);
+
+			for (; m_Size < first + count; m_Size++)
+				new (m_Buffer + m_Size) T(__args...);
+			return first;
+		}
+
+		// returns the index of the first appended element
+		u64 append_range(const T* buffer, u64 count)
+		{
+			u64 first = m_Size;
+			if (m_Size + count > m_Capacity)
+				this->_grow(m_Size + count);
+
+			if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				if (count)
+					memcpy((void*)(m_Buffer + m_Size), (const void*)buffer, count * sizeof(T));
+				m_Size += count;
+			} else
+			{
+				for (u64 i = 0; i < count; i++)
+					new (m_Buffer + m_Size++) T(buffer[i]);
+			}
+			return first;
+		}
+
+		template<typename t_Iterator>
+		u64 append_range(const t_Iterator& begin, const t_Iterator& end)
+		{
+			u64 first = m_Size;
+			u64 count = std::distance(begin, end);
+			if (m_Size + count > m_Capacity)
+				this->_grow(m_Size + count);
+
+			for (t_Iterator it = begin; it != end; it++)
+				new (m_Buffer + m_Size++) T(*it);
+			return first;
+		}
+
 		template<typename... t_Args>
 		inline u64 emplace_d(t_Args&&... __args)
 		{
@@ -185,7 +300,13 @@ namespace Na {
 		[[nodiscard]] inline u64 free_space(void) const { return m_Capacity - m_Size; }
 		[[nodiscard]] inline bool empty(void) const { return !m_Size; }
 		[[nodiscard]] inline bool full(void) const { return m_Size == m_Capacity; }
+
+		[[nodiscard]] inline const Allocator& allocator(void) const { return m_Allocator; }
+	private:
+		// at least doubles, so repeated bulk appends stay amortized
+		inline void _grow(u64 min_capacity) { this->reallocate(std::max(min_capacity, m_Capacity * 2)); }
 	private:
+		[[no_unique_address]] Allocator m_Allocator; // first, the buffer is allocated in the member initializers
 		u64 m_Capacity, m_Size;
 		T* m_Buffer;
 	};
@@ -2,9 +2,34 @@
 #define NA_ARRAY_VECTOR_HPP
 
 #include "./ArrayIterator.hpp"
+#include "./Relocation.hpp"
+#include "./Allocator.hpp"
 
 namespace Na {
+	template<typename T, u64 t_Capacity>
+	struct ArrayVector_InlineStorage {
+		alignas(T) Byte data[sizeof(T) * t_Capacity];
+
+		[[nodiscard]] inline T* ptr(void) { return (T*)data; }
+		[[nodiscard]] inline const T* ptr(void) const { return (const T*)data; }
+	};
+
 	template<typename T>
+	struct ArrayVector_InlineStorage<T, 0> {
+		[[nodiscard]] inline T* ptr(void) { return nullptr; }
+		[[nodiscard]] inline const T* ptr(void) const { return nullptr; }
+	};
+
+	/// 
+	/// a heap array that grows geometrically, the first t_InlineCapacity elements
+	/// are stored inside the vector itself, so short temporary arrays never allocate
+	/// 
+	/// resize and pop keep the capacity, clear and shrink_to_fit release it,
+	/// elements are relocated with memcpy if they are trivially relocatable and moved otherwise
+	/// 
+	/// the heap buffer comes from t_Allocator, see Allocator.hpp
+	/// 
+	template<typename T, u64 t_InlineCapacity = 0, template<typename> typename t_Allocator = HeapAllocator>
 	class ArrayVector {
 	public:
 		using iterator = Array_Iterator<ArrayVector>;
@@ -12,34 +37,53 @@ namespace Na {
 		using const_iterator = Array_ConstIterator<ArrayVector>;
 		using const_reverse_iterator = Array_ConstReverseIterator<ArrayVector>;
 		using T_t = T;
+		using Allocator = t_Allocator<T>;
+
+		static constexpr u64 k_InlineCapacity = t_InlineCapacity;
 	public:
 		inline ArrayVector(void)
-		: m_Size(0), m_Buffer(nullptr)
-		{}
+		: m_Size(0), m_Capacity(t_InlineCapacity), m_Buffer(nullptr)
+		{
+			m_Buffer = m_Storage.ptr();
+		}
+
+		inline ArrayVector(const Allocator& allocator)
+		: m_Size(0), m_Capacity(t_InlineCapacity), m_Buffer(nullptr), m_Allocator(allocator)
+		{
+			m_Buffer = m_Storage.ptr();
+		}
 
+		// the elements are zeroed, not constructed
 		inline ArrayVector(u64 size)
-		: m_Size(size), m_Buffer(tcalloc<T>(size))
-		{}
+		: ArrayVector()
+		{
+			this->_reallocate(size);
+			if (size)
+				memset((void*)m_Buffer, 0, size * sizeof(T));
+			m_Size = size;
+		}
 
 		template<typename t_Iterator>
 		inline ArrayVector(const t_Iterator& begin, const t_Iterator& end)
-		: m_Size(std::distance(begin, end)), m_Buffer(tmalloc<T>(m_Size))
+		: ArrayVector()
 		{
-			u64 i = 0;
+			this->_reallocate(std::distance(begin, end));
 			for (t_Iterator it = begin; it != end; it++)
-				new (m_Buffer + i++) T(*it);
+				new (m_Buffer + m_Size++) T(*it);
 		}
 
 		inline ArrayVector(const T* buffer, u64 size)
-		: m_Size(0), m_Buffer(tmalloc<T>(size))
+		: ArrayVector()
 		{
+			this->_reallocate(size);
 			for (; m_Size < size; m_Size++)
 				new (m_Buffer + m_Size) T(buffer[m_Size]);
 		}
 
 		inline ArrayVector(T* buffer, u64 size)
-		: m_Size(0), m_Buffer(tmalloc<T>(size))
+		: ArrayVector()
 		{
+			this->_reallocate(size);
 			for (; m_Size < size; m_Size++)
 				new (m_Buffer + m_Size) T(std::move(buffer[m_Size]));
 		}
@@ -51,77 +95,88 @@ namespace Na {
 		inline ~ArrayVector(void) { this->clear(); }
 
 		inline ArrayVector(const ArrayVector& other)
-		: ArrayVector(other.m_Buffer, other.m_Size) {}
+		: ArrayVector(other.m_Allocator)
+		{
+			this->_reallocate(other.m_Size);
+			for (; m_Size < other.m_Size; m_Size++)
+				new (m_Buffer + m_Size) T(other.m_Buffer[m_Size]);
+		}
 
 		ArrayVector& operator=(const ArrayVector& other)
 		{
-			if (m_Size != other.m_Size)
-			{
-				for (u64 i = 0; i < m_Size; i++)
-					m_Buffer[i].~T();
-				free(m_Buffer);
-				m_Buffer = tmalloc<T>(other.m_Size);
-			} else
-			{
-				for (u64 i = 0; i < m_Size; i++)
-					m_Buffer[i].~T();
-			}
+			if (this == &other)
+				return *this;
+
+			this->_destroy(0);
+			if (m_Capacity < other.m_Size)
+				this->_reallocate(other.m_Size);
 
-			for (m_Size = 0; m_Size < other.m_Size; m_Size++)
+			for (; m_Size < other.m_Size; m_Size++)
 				new (m_Buffer + m_Size) T(other.m_Buffer[m_Size]);
 
 			return *this;
 		}
 
-		ArrayVector(ArrayVector&& other)
+		inline ArrayVector(ArrayVector&& other)
+		: ArrayVector()
 		{
-			memcpy(this, &other, sizeof(ArrayVector));
-			memset(&other, 0, sizeof(ArrayVector));
+			this->_take(other);
 		}
 
 		ArrayVector& operator=(ArrayVector&& other)
 		{
-			for (u64 i = 0; i < m_Size; i++)
-				m_Buffer[i].~T();
-			free(m_Buffer);
-			memcpy(this, &other, sizeof(ArrayVector));
-			memset(&other, 0, sizeof(ArrayVector));
+			if (this == &other)
+				return *this;
+
+			this->clear();
+			this->_take(other);
 			return *this;
 		}
 
+		// releases the heap buffer
 		inline void clear(void)
 		{
-			for (u64 i = 0; i < m_Size; i++)
-				m_Buffer[i].~T();
-			free(m_Buffer);
-			m_Buffer = nullptr;
-			m_Size = 0;
+			this->_destroy(0);
+			if (!this->inlined())
+				m_Allocator.deallocate(m_Buffer, m_Capacity);
+			m_Buffer = m_Storage.ptr();
+			m_Capacity = t_InlineCapacity;
 		}
 
 		inline void resize(u64 new_size)
 		{
-			if (m_Size == new_size)
-				return;
-
-			if (m_Size < new_size)
+			if (m_Size >= new_size)
 			{
-				m_Buffer = trealloc<T>(m_Buffer, new_size);
-				for (; m_Size < new_size; m_Size++)
-					new (m_Buffer + m_Size) T();
+				this->_destroy(new_size);
 				return;
 			}
 
-			for (u64 i = m_Size; i < new_size; i++)
-				m_Buffer[i].~T();
-			m_Buffer = trealloc<T>(m_Buffer, new_size);
+			if (new_size > m_Capacity)
+				this->_reallocate(std::max(new_size, m_Capacity * 2));
+
+			for (; m_Size < new_size; m_Size++)
+				new (m_Buffer + m_Size) T();
 		}
 
+		// never drops below the size or the inline capacity
+		inline void reallocate(u64 new_capacity) { this->_reallocate(std::max(new_capacity, m_Size)); }
+		inline void reserve(u64 extra_capacity) { this->reallocate(m_Size + extra_capacity); }
+		inline void shrink_to_fit(void) { this->_reallocate(m_Size); }
+
 		template<typename... t_Args>
 		u64 emplace(t_Args&&... __args)
 		{
-			m_Buffer = trealloc<T>(m_Buffer, ++m_Size);
-			new (m_Buffer + m_Size - 1) T(std::forward<t_Args>(__args)...);
-			return m_Size;
+			if (m_Size < m_Capacity)
+			{
+				new (m_Buffer + m_Size) T(std::forward<t_Args>(__args)...);
+				return ++m_Size;
+			}
+
+			// the arguments may refer to an element that is about to be relocated
+			T value(std::forward<t_Args>(__args)...);
+			this->_reallocate(m_Capacity * 2 + 1);
+			new (m_Buffer + m_Size) T(std::move(value));
+			return ++m_Size;
 		}
 
 		bool pop(void)
@@ -129,7 +184,6 @@ namespace Na {
 			if (m_Size)
 			{
 				m_Buffer[--m_Size].~T();
-				m_Buffer = trealloc<T>(m_Buffer, m_Size);
 				return true;
 			}
 			return false;
@@ -172,11 +226,83 @@ namespace Na {
 		[[nodiscard]] inline T& tail(void) { return *(m_Buffer + m_Size - 1); }
 		[[nodiscard]] inline const T& tail(void) const { return *(m_Buffer + m_Size - 1); }
 
+		[[nodiscard]] inline u64 capacity(void) const { return m_Capacity; }
 		[[nodiscard]] inline u64 size(void) const { return m_Size; }
 		[[nodiscard]] inline bool empty(void) const { return !m_Size; }
+
+		[[nodiscard]] inline const Allocator& allocator(void) const { return m_Allocator; }
+
+		// the elements live in the inline storage, always true without one
+		[[nodiscard]] inline bool inlined(void) const { return m_Buffer == m_Storage.ptr(); }
+	private:
+		// new_capacity has to fit the current size
+		void _reallocate(u64 new_capacity)
+		{
+			if (new_capacity <= t_InlineCapacity)
+			{
+				if (this->inlined())
+					return;
+
+				T* buffer = m_Storage.ptr();
+				RelocateElements(buffer, m_Buffer, m_Size);
+				m_Allocator.deallocate(m_Buffer, m_Capacity);
+
+				m_Buffer = buffer;
+				m_Capacity = t_InlineCapacity;
+				return;
+			}
+
+			if (new_capacity == m_Capacity)
+				return;
+
+			if constexpr (k_IsTriviallyRelocatable<T>)
+			{
+				if (!this->inlined())
+				{
+					m_Buffer = m_Allocator.reallocate(m_Buffer, m_Capacity, new_capacity);
+					m_Capacity = new_capacity;
+					return;
+				}
+			}
+
+			T* buffer = m_Allocator.allocate(new_capacity);
+			RelocateElements(buffer, m_Buffer, m_Size);
+			if (!this->inlined())
+				m_Allocator.deallocate(m_Buffer, m_Capacity);
+
+			m_Buffer = buffer;
+			m_Capacity = new_capacity;
+		}
+
+		// destroys every element from new_size on, keeps the buffer
+		inline void _destroy(u64 new_size)
+		{
+			for (u64 i = new_size; i < m_Size; i++)
+				m_Buffer[i].~T();
+			m_Size = std::min(m_Size, new_size);
+		}
+
+		// expects this to be empty and inlined, adopts the other's allocator
+		void _take(ArrayVector& other)
+		{
+			m_Allocator = other.m_Allocator;
+			if (other.inlined())
+			{
+				RelocateElements(m_Buffer, other.m_Buffer, other.m_Size);
+				m_Size = std::exchange(other.m_Size, 0);
+				return;
+			}
+
+			m_Size = std::exchange(other.m_Size, 0);
+			m_Capacity = std::exchange(other.m_Capacity, t_InlineCapacity);
+			m_Buffer = std::exchange(other.m_Buffer, other.m_Storage.ptr());
+		}
 	private:
 		u64 m_Size;
+		u64 m_Capacity;
 		T* m_Buffer;
+		[[no_unique_address]] ArrayVector_InlineStorage<T, t_InlineCapacity> m_Storage;
+		[[no_unique_address]] Allocator m_Allocator;
 	};
 } // namespace Na
 
@@ -3,12 +3,19 @@
 
 #include "./ListNode.hpp"
 #include "./DoubleListIterator.hpp"
+#include "./NodePool.hpp"
 
 namespace Na {
-	template<typename T>
+	/// 
+	/// nodes come from t_Allocator, by default a PoolAllocator so they stay close together,
+	/// lists constructed with a copy of another list's allocator share its pool and can
+	/// splice nodes between each other without allocating
+	/// 
+	template<typename T, template<typename> typename t_Allocator = PoolAllocator>
 	class DoubleList {
 	public:
 		using Node = DoubleList_Node<DoubleList>;
+		using Allocator = t_Allocator<Node>;
 		using iterator = DoubleList_Iterator<DoubleList>;
 		using const_iterator = DoubleList_ConstIterator<DoubleList>;
 		using reverse_iterator = DoubleList_ReverseIterator<DoubleList>;
@@ -16,11 +23,13 @@ namespace Na {
 		using T_t = T;
 	public:
 		inline DoubleList(void) : m_Head(nullptr), m_Tail(nullptr), m_Size(0) {}
+		inline DoubleList(const Allocator& allocator) : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_Allocator(allocator) {}
 		inline ~DoubleList(void) { this->clear(); }
 		inline void clear(void) { while (this->pop_back()); }
 
 		template<typename t_Iterator>
 		inline DoubleList(const t_Iterator& begin, const t_Iterator& end)
+		: DoubleList()
 		{
 			for (t_Iterator it = begin; it != end; it++)
 				this->emplace_back(*it);
@@ -43,6 +52,7 @@ namespace Na {
 		DoubleList(const std::initializer_list<T>& list)
 		: DoubleList(list.begin(), list.size()) {}
 
+		// gets its own allocator, use DoubleList(other.allocator()) to share the pool
 		DoubleList(const DoubleList& other)
 		: DoubleList()
 		{
@@ -65,17 +75,24 @@ namespace Na {
 			return *this;
 		}
 
+		// the other list keeps a copy of the allocator, so it stays usable
 		inline DoubleList(DoubleList&& other)
-		{
-			memcpy(this, &other, sizeof(DoubleList));
-			memset(&other, 0, sizeof(DoubleList));
-		}
+		: m_Head(std::exchange(other.m_Head, nullptr)),
+		m_Tail(std::exchange(other.m_Tail, nullptr)),
+		m_Size(std::exchange(other.m_Size, 0)),
+		m_Allocator(other.m_Allocator)
+		{}
 
 		inline DoubleList& operator=(DoubleList&& other)
 		{
+			if (this == &other)
+				return *this;
+
 			this->clear();
-			memcpy(this, &other, sizeof(DoubleList));
-			memset(&other, 0, sizeof(DoubleList));
+			m_Head = std::exchange(other.m_Head, nullptr);
+			m_Tail = std::exchange(other.m_Tail, nullptr);
+			m_Size = std::exchange(other.m_Size, 0);
+			m_Allocator = other.m_Allocator;
 			return *this;
 		}
 
@@ -85,7 +102,7 @@ namespace Na {
 			if (!m_Size++)
 				return &(this->_emplace_empty(std::forward<t_Args>(__args)...)->data);
 
-			m_Tail = new Node(nullptr, m_Tail, std::forward<t_Args>(__args)...);
+			m_Tail = this->_new_node(nullptr, m_Tail, std::forward<t_Args>(__args)...);
 			return &((m_Tail->previous->next = m_Tail)->data);
 		}
 
@@ -95,7 +112,7 @@ namespace Na {
 			if (!m_Size++)
 				return &(this->_emplace_empty(std::forward<t_Args>(__args)...)->data);
 
-			m_Head = new Node(m_Head, nullptr, std::forward<t_Args>(__args)...);
+			m_Head = this->_new_node(m_Head, nullptr, std::forward<t_Args>(__args)...);
 			return &((m_Head->next->previous = m_Head)->data);
 		}
 
@@ -107,12 +124,12 @@ namespace Na {
 
 			if (index >= m_Size)
 			{
-				m_Tail = new Node(nullptr, m_Tail, std::forward<t_Args>(__args)...);
+				m_Tail = this->_new_node(nullptr, m_Tail, std::forward<t_Args>(__args)...);
 				return &((m_Tail->previous->next = m_Tail)->data);
 			}
 
 			Node* node = this->at(index).node;
-			node = new Node(node, node->previous, std::forward<t_Args>(__args)...);
+			node = this->_new_node(node, node->previous, std::forward<t_Args>(__args)...);
 			if (node->previous)
 				node->previous->next = node;
 			return &((node->next->previous = node)->data);
@@ -126,11 +143,11 @@ namespace Na {
 			m_Size--;
 			if ((m_Tail = m_Tail->previous))
 			{
-				delete m_Tail->next;
+				this->_delete_node(m_Tail->next);
 				m_Tail->next = nullptr;
 			} else
 			{
-				delete m_Head;
+				this->_delete_node(m_Head);
 				m_Head = nullptr;
 			}
 			return true;
@@ -144,11 +161,11 @@ namespace Na {
 			m_Size--;
 			if ((m_Head = m_Head->next))
 			{
-				delete m_Head->previous;
+				this->_delete_node(m_Head->previous);
 				m_Head->previous = nullptr;
 			} else
 			{
-				delete m_Tail;
+				this->_delete_node(m_Tail);
 				m_Tail = nullptr;
 			}
 			return true;
@@ -156,16 +173,11 @@ namespace Na {
 
 		bool pop_at(u64 index)
 		{
-			if (!m_Head)
-				return false;
-
-			if (!--m_Size && index)
-				return false;
-
-			if (index > m_Size)
+			if (index >= m_Size)
 				return false;
 
 			Node* node = this->at(index).node;
+			m_Size--;
 
 			if (!node->is_tail())
 				node->next->previous = node->previous;
@@ -177,7 +189,7 @@ namespace Na {
 			else
 				m_Head = node->next;
 
-			delete node;
+			this->_delete_node(node);
 			return true;
 		}
 
@@ -186,7 +198,7 @@ namespace Na {
 			if (!find(data))
 				return false;
 
-			Node* node = (Node*)((Byte*)data - 16);
+			Node* node = (Node*)((Byte*)data - offsetof(Node, data));
 			if (!node->is_tail())
 				node->next->previous = node->previous;
 			else
@@ -198,7 +210,7 @@ namespace Na {
 				m_Head = node->next;
 
 			m_Size--;
-			delete node;
+			this->_delete_node(node);
 			return true;
 		}
 
@@ -277,24 +289,93 @@ namespace Na {
 		[[nodiscard]] inline T& operator[](u64 index) { return *(this->at(index)); }
 		[[nodiscard]] inline const T& operator[](u64 index) const { return *(this->at(index)); }
 
-		[[nodiscard]] inline T& head(void) { return *m_Head; }
-		[[nodiscard]] inline const T& head(void) const { return *m_Head; }
+		[[nodiscard]] inline T& head(void) { return m_Head->data; }
+		[[nodiscard]] inline const T& head(void) const { return m_Head->data; }
+
+		[[nodiscard]] inline T& tail(void) { return m_Tail->data; }
+		[[nodiscard]] inline const T& tail(void) const { return m_Tail->data; }
+
+		/// 
+		/// moves [first, last) of other in front of position (end() appends), no node is
+		/// allocated or copied, so pointers and iterators to them stay valid,
+		/// both lists have to share their allocator
+		/// 
+		void splice(iterator position, DoubleList& other, iterator first, iterator last)
+		{
+			if (first == last)
+				return;
+
+			NA_ASSERT(m_Allocator == other.m_Allocator, "Failed to splice lists: They do not share an allocator!");
 
-		[[nodiscard]] inline T& tail(void) { return *m_Tail; }
-		[[nodiscard]] inline const T& tail(void) const { return *m_Tail; }
+			Node* first_node = first.node;
+			Node* last_node = last.node ? last.node->previous : other.m_Tail;
 
-		[[nodiscard]] inline u64 size(void) { return m_Size; }
-		[[nodiscard]] inline bool empty(void) { return !m_Size; }
+			u64 count = 1;
+			for (Node* node = first_node; node != last_node; node = node->next)
+				count++;
+
+			// unlink from other
+			if (first_node->previous)
+				first_node->previous->next = last_node->next;
+			else
+				other.m_Head = last_node->next;
+
+			if (last_node->next)
+				last_node->next->previous = first_node->previous;
+			else
+				other.m_Tail = first_node->previous;
+
+			other.m_Size -= count;
+
+			// link in front of position
+			Node* next = position.node;
+			Node* previous = next ? next->previous : m_Tail;
+
+			first_node->previous = previous;
+			last_node->next = next;
+
+			if (previous)
+				previous->next = first_node;
+			else
+				m_Head = first_node;
+
+			if (next)
+				next->previous = last_node;
+			else
+				m_Tail = last_node;
+
+			m_Size += count;
+		}
+		inline void splice(iterator position, DoubleList& other) { this->splice(position, other, other.begin(), other.end()); }
+		inline void splice(iterator position, DoubleList& other, iterator it) { this->splice(position, other, it, it.node->next); }
+
+		[[nodiscard]] inline u64 size(void) const { return m_Size; }
+		[[nodiscard]] inline bool empty(void) const { return !m_Size; }
+
+		[[nodiscard]] inline const Allocator& allocator(void) const { return m_Allocator; }
 	private:
 		template<typename... t_Args>
 		Node* _emplace_empty(t_Args&&... __args)
 		{
-			m_Head = new Node(nullptr, nullptr, std::forward<t_Args>(__args)...);
+			m_Head = this->_new_node(nullptr, nullptr, std::forward<t_Args>(__args)...);
 			return m_Tail = m_Head;
 		}
+
+		template<typename... t_Args>
+		inline Node* _new_node(Node* next, Node* previous, t_Args&&... __args)
+		{
+			return new (m_Allocator.allocate()) Node(next, previous, std::forward<t_Args>(__args)...);
+		}
+
+		inline void _delete_node(Node* node)
+		{
+			node->~Node();
+			m_Allocator.deallocate(node);
+		}
 	private:
 		Node* m_Head, * m_Tail;
 		u64 m_Size;
+		Allocator m_Allocator;
 	};
 } // namespace Neo
 
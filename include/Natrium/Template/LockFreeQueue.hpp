@@ -0,0 +1,194 @@
+#if !defined(NA_LOCK_FREE_QUEUE_HPP)
+#define NA_LOCK_FREE_QUEUE_HPP
+
+#include "../Core.hpp"
+
+namespace Na {
+	// keeps atomics written by different threads on different cache lines
+	inline constexpr u64 k_CacheLineSize = 64;
+
+	/// 
+	/// a bounded single producer single consumer ring, the capacity is rounded up to a power of two,
+	/// try_push fails when full and try_pop when empty, neither blocks or allocates
+	/// 
+	template<typename T>
+	class SpscQueue {
+	public:
+		SpscQueue(u64 capacity)
+		: m_Capacity(std::bit_ceil(std::max<u64>(capacity, 2))),
+		m_Buffer(tmalloc<T>(m_Capacity))
+		{}
+
+		inline ~SpscQueue(void)
+		{
+			u64 tail = m_Tail.load(std::memory_order_acquire);
+			for (u64 i = m_Head.load(std::memory_order_acquire); i < tail; i++)
+				m_Buffer[i & (m_Capacity - 1)].~T();
+			free(m_Buffer);
+		}
+
+		SpscQueue(const SpscQueue& other) = delete;
+		SpscQueue& operator=(const SpscQueue& other) = delete;
+
+		// producer only
+		template<typename U>
+		bool try_push(U&& value)
+		{
+			u64 tail = m_Tail.load(std::memory_order_relaxed);
+			if (tail - m_CachedHead == m_Capacity)
+			{
+				m_CachedHead = m_Head.load(std::memory_order_acquire);
+				if (tail - m_CachedHead == m_Capacity)
+					return false;
+			}
+
+			new (m_Buffer + (tail & (m_Capacity - 1))) T(std::forward<U>(value));
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only
+		bool try_pop(T& value)
+		{
+			u64 head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_CachedTail)
+			{
+				m_CachedTail = m_Tail.load(std::memory_order_acquire);
+				if (head == m_CachedTail)
+					return false;
+			}
+
+			T& slot = m_Buffer[head & (m_Capacity - 1)];
+			value = std::move(slot);
+			slot.~T();
+			m_Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// a snapshot, exact only on the producer or consumer thread while the other is idle
+		[[nodiscard]] inline u64 size(void) const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+		[[nodiscard]] inline u64 capacity(void) const { return m_Capacity; }
+	private:
+		const u64 m_Capacity;
+		T* const m_Buffer;
+
+		alignas(k_CacheLineSize) std::atomic<u64> m_Head = 0;
+		u64 m_CachedTail = 0; // the consumer's last look at m_Tail
+
+		alignas(k_CacheLineSize) std::atomic<u64> m_Tail = 0;
+		u64 m_CachedHead = 0; // the producer's last look at m_Head
+	};
+
+	/// 
+	/// a bounded multi producer multi consumer ring (Vyukov), every cell carries a sequence
+	/// number, so producers and consumers only contend on their own index
+	/// 
+	/// the capacity is rounded up to a power of two, neither call blocks or allocates
+	/// 
+	template<typename T>
+	class MpmcQueue {
+	public:
+		MpmcQueue(u64 capacity)
+		: m_Capacity(std::bit_ceil(std::max<u64>(capacity, 2))),
+		m_Cells(tmalloc<Cell>(m_Capacity))
+		{
+			for (u64 i = 0; i < m_Capacity; i++)
+				new (&m_Cells[i].sequence) std::atomic<u64>(i);
+		}
+
+		inline ~MpmcQueue(void)
+		{
+			u64 enqueue = m_Enqueue.load(std::memory_order_acquire);
+			for (u64 i = m_Dequeue.load(std::memory_order_acquire); i < enqueue; i++)
+				((T*)m_Cells[i & (m_Capacity - 1)].data)->~T();
+
+			for (u64 i = 0; i < m_Capacity; i++)
+				m_Cells[i].sequence.~atomic();
+			free(m_Cells);
+		}
+
+		MpmcQueue(const MpmcQueue& other) = delete;
+		MpmcQueue& operator=(const MpmcQueue& other) = delete;
+
+		template<typename U>
+		bool try_push(U&& value)
+		{
+			u64 position = m_Enqueue.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;)
+			{
+				cell = &m_Cells[position & (m_Capacity - 1)];
+				u64 sequence = cell->sequence.load(std::memory_order_acquire);
+				i64 difference = (i64)sequence - (i64)position;
+
+				if (!difference)
+				{
+					if (m_Enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				} else if (difference < 0)
+				{
+					return false; // full
+				} else
+				{
+					position = m_Enqueue.load(std::memory_order_relaxed);
+				}
+			}
+
+			new (cell->data) T(std::forward<U>(value));
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool try_pop(T& value)
+		{
+			u64 position = m_Dequeue.load(std::memory_order_relaxed);
+			Cell* cell;
+			for (;;)
+			{
+				cell = &m_Cells[position & (m_Capacity - 1)];
+				u64 sequence = cell->sequence.load(std::memory_order_acquire);
+				i64 difference = (i64)sequence - (i64)(position + 1);
+
+				if (!difference)
+				{
+					if (m_Dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				} else if (difference < 0)
+				{
+					return false; // empty
+				} else
+				{
+					position = m_Dequeue.load(std::memory_order_relaxed);
+				}
+			}
+
+			T& data = *(T*)cell->data;
+			value = std::move(data);
+			data.~T();
+			cell->sequence.store(position + m_Capacity, std::memory_order_release);
+			return true;
+		}
+
+		// a snapshot, may be stale by the time it returns
+		[[nodiscard]] inline u64 size(void) const
+		{
+			u64 enqueue = m_Enqueue.load(std::memory_order_acquire);
+			u64 dequeue = m_Dequeue.load(std::memory_order_acquire);
+			return enqueue > dequeue ? enqueue - dequeue : 0;
+		}
+		[[nodiscard]] inline u64 capacity(void) const { return m_Capacity; }
+	private:
+		struct Cell {
+			std::atomic<u64> sequence;
+			alignas(T) Byte data[sizeof(T)];
+		};
+	private:
+		const u64 m_Capacity;
+		Cell* const m_Cells;
+
+		alignas(k_CacheLineSize) std::atomic<u64> m_Enqueue = 0;
+		alignas(k_CacheLineSize) std::atomic<u64> m_Dequeue = 0;
+	};
+} // namespace Na
+
+#endif // NA_LOCK_FREE_QUEUE_HPP
\ No newline at end of file
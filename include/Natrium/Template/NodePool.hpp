@@ -0,0 +1,155 @@
+#if !defined(NA_NODE_POOL_HPP)
+#define NA_NODE_POOL_HPP
+
+#include "./Allocator.hpp"
+
+namespace Na {
+	/// 
+	/// hands out uninitialized storage for t_Node from chunks of contiguous nodes,
+	/// freed nodes go onto a free list and are reused before a new chunk is allocated
+	/// 
+	/// chunks grow from k_FirstChunkSize up to k_MaxChunkSize nodes and are only
+	/// released with the pool, warning: not thread safe
+	/// 
+	template<typename t_Node>
+	class NodePool {
+	public:
+		static constexpr u64 k_FirstChunkSize = 16;
+		static constexpr u64 k_MaxChunkSize = 1024;
+	public:
+		NodePool(void) = default;
+		inline ~NodePool(void) { this->destroy(); }
+
+		// every node has to be deallocated (or never used again) before
+		void destroy(void)
+		{
+			while (m_Chunks)
+			{
+				Chunk* next = m_Chunks->next;
+				free(m_Chunks);
+				m_Chunks = next;
+			}
+			m_FreeList = nullptr;
+			m_NextChunkSize = k_FirstChunkSize;
+			m_Capacity = 0;
+			m_Used = 0;
+		}
+
+		NodePool(const NodePool& other) = delete;
+		NodePool& operator=(const NodePool& other) = delete;
+
+		NodePool(NodePool&& other) = delete;
+		NodePool& operator=(NodePool&& other) = delete;
+
+		[[nodiscard]] t_Node* allocate(void)
+		{
+			if (!m_FreeList)
+				this->_allocate_chunk();
+
+			FreeNode* node = m_FreeList;
+			m_FreeList = node->next;
+			m_Used++;
+			return (t_Node*)node;
+		}
+
+		void deallocate(t_Node* node)
+		{
+			FreeNode* free_node = (FreeNode*)node;
+			free_node->next = m_FreeList;
+			m_FreeList = free_node;
+			m_Used--;
+		}
+
+		[[nodiscard]] inline u64 capacity(void) const { return m_Capacity; }
+		[[nodiscard]] inline u64 used(void) const { return m_Used; }
+	private:
+		struct FreeNode {
+			FreeNode* next;
+		};
+
+		struct Chunk {
+			Chunk* next;
+			u64 size;
+		};
+
+		static constexpr u64 k_NodeSize = std::max(sizeof(t_Node), sizeof(FreeNode));
+		static constexpr u64 k_NodeAlign = std::max(alignof(t_Node), alignof(FreeNode));
+		static constexpr u64 k_HeaderSize = (sizeof(Chunk) + k_NodeAlign - 1) / k_NodeAlign * k_NodeAlign;
+		static constexpr u64 k_Stride = (k_NodeSize + k_NodeAlign - 1) / k_NodeAlign * k_NodeAlign;
+
+		static_assert(k_NodeAlign <= alignof(std::max_align_t), "NodePool does not support over-aligned nodes!");
+
+		void _allocate_chunk(void)
+		{
+			u64 size = m_NextChunkSize;
+			m_NextChunkSize = std::min(m_NextChunkSize * 2, k_MaxChunkSize);
+
+			Chunk* chunk = (Chunk*)malloc(k_HeaderSize + size * k_Stride);
+			NA_VERIFY(chunk, "Failed to allocate node pool chunk: Out of memory!");
+
+			chunk->next = m_Chunks;
+			chunk->size = size;
+			m_Chunks = chunk;
+			m_Capacity += size;
+
+			// threaded back to front, so the first allocations walk the chunk in order
+			Byte* nodes = (Byte*)chunk + k_HeaderSize;
+			for (u64 i = size; i-- > 0;)
+			{
+				FreeNode* node = (FreeNode*)(nodes + i * k_Stride);
+				node->next = m_FreeList;
+				m_FreeList = node;
+			}
+		}
+	private:
+		Chunk* m_Chunks = nullptr;
+		FreeNode* m_FreeList = nullptr;
+		u64 m_NextChunkSize = k_FirstChunkSize;
+		u64 m_Capacity = 0;
+		u64 m_Used = 0;
+	};
+
+	/// 
+	/// a shared handle to a NodePool, copies allocate from the same pool, which is
+	/// released with the last handle, containers with equal allocators can exchange nodes
+	/// 
+	/// the pool is created on first use, so default constructed allocators cost nothing,
+	/// copying an allocator creates it early so both copies end up with the same pool
+	/// 
+	/// hands out single nodes only, see Allocator.hpp for the interface
+	/// 
+	template<typename t_Node>
+	class PoolAllocator {
+	public:
+		PoolAllocator(void) = default;
+		inline PoolAllocator(const PoolAllocator& other) : m_Pool(other._shared_pool()) {}
+		inline PoolAllocator& operator=(const PoolAllocator& other)
+		{
+			m_Pool = other._shared_pool();
+			return *this;
+		}
+
+		[[nodiscard]] inline t_Node* allocate(u64 count = 1)
+		{
+			NA_ASSERT(count == 1, "Failed to allocate {} nodes: PoolAllocator hands out one node at a time!", count);
+			(void)count;
+			return this->_shared_pool()->allocate();
+		}
+		inline void deallocate(t_Node* node, u64 count = 1) { (void)count; m_Pool->deallocate(node); }
+
+		[[nodiscard]] inline NodePool<t_Node>& pool(void) const { return *this->_shared_pool(); }
+
+		[[nodiscard]] inline bool operator==(const PoolAllocator& other) const { return m_Pool == other.m_Pool; }
+	private:
+		const std::shared_ptr<NodePool<t_Node>>& _shared_pool(void) const
+		{
+			if (!m_Pool)
+				m_Pool = std::make_shared<NodePool<t_Node>>();
+			return m_Pool;
+		}
+	private:
+		mutable std::shared_ptr<NodePool<t_Node>> m_Pool;
+	};
+} // namespace Na
+
+#endif // NA_NODE_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,91 @@
+#if !defined(NA_RANGE_ALLOCATOR_HPP)
+#define NA_RANGE_ALLOCATOR_HPP
+
+#include "../Core.hpp"
+
+namespace Na {
+	/// 
+	/// hands out ranges of [0, capacity), e.g. of descriptor array elements or buffer elements,
+	/// first fit out of the freed ranges, then bumped from the end
+	/// 
+	/// freed ranges are kept sorted and merged with their neighbours,
+	/// one that reaches the end goes back to the bump allocator, warning: not thread safe
+	/// 
+	class RangeAllocator {
+	public:
+		RangeAllocator(void) = default;
+		explicit inline RangeAllocator(u32 capacity) : m_Capacity(capacity) {}
+
+		// k_U32Max if nothing fits
+		[[nodiscard]] u32 allocate(u32 count)
+		{
+			for (u64 i = 0; i < m_FreeRanges.size(); i++)
+			{
+				Range& range = m_FreeRanges[i];
+				if (range.count < count)
+					continue;
+
+				u32 first = range.first;
+				range.first += count;
+				range.count -= count;
+				if (!range.count)
+					m_FreeRanges.erase(m_FreeRanges.begin() + i);
+
+				m_Used += count;
+				return first;
+			}
+
+			if (count > m_Capacity - m_Next)
+				return k_U32Max;
+
+			u32 first = m_Next;
+			m_Next += count;
+			m_Used += count;
+			return first;
+		}
+
+		void free(u32 first, u32 count)
+		{
+			NA_ASSERT(first + count <= m_Next, "Failed to free range {}: It was never allocated!", first);
+			m_Used -= count;
+
+			auto it = std::lower_bound(
+				m_FreeRanges.begin(), m_FreeRanges.end(), first,
+				[](const Range& range, u32 index) { return range.first < index; }
+			);
+			it = m_FreeRanges.insert(it, Range{ first, count });
+
+			if (it + 1 != m_FreeRanges.end() && it->first + it->count == (it + 1)->first)
+			{
+				it->count += (it + 1)->count;
+				m_FreeRanges.erase(it + 1);
+			}
+			if (it != m_FreeRanges.begin() && (it - 1)->first + (it - 1)->count == it->first)
+			{
+				(it - 1)->count += it->count;
+				m_FreeRanges.erase(it);
+			}
+
+			if (!m_FreeRanges.empty() && m_FreeRanges.back().first + m_FreeRanges.back().count == m_Next)
+			{
+				m_Next = m_FreeRanges.back().first;
+				m_FreeRanges.pop_back();
+			}
+		}
+
+		[[nodiscard]] inline u32 capacity(void) const { return m_Capacity; }
+		[[nodiscard]] inline u32 used(void) const { return m_Used; }
+	private:
+		struct Range {
+			u32 first;
+			u32 count;
+		};
+	private:
+		u32 m_Capacity = 0;
+		u32 m_Next = 0; // everything from here on was never handed out
+		u32 m_Used = 0;
+		std::vector<Range> m_FreeRanges; // sorted, never touching
+	};
+} // namespace Na
+
+#endif // NA_RANGE_ALLOCATOR_HPP
\ No newline at end of file
@@ -0,0 +1,40 @@
+#if !defined(NA_RELOCATION_HPP)
+#define NA_RELOCATION_HPP
+
+#include "../Core.hpp"
+
+namespace Na {
+	/// 
+	/// whether moving an object to another address and forgetting the old one
+	/// is the same as copying its bytes, specialize it for types that are
+	/// relocatable but not trivially copyable to skip the per element moves
+	/// 
+	template<typename T>
+	struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+	template<typename T>
+	inline constexpr bool k_IsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+	/// 
+	/// moves count objects from src into the uninitialized dst and ends their lifetime in src,
+	/// the ranges must not overlap
+	/// 
+	template<typename T>
+	inline void RelocateElements(T* dst, T* src, u64 count)
+	{
+		if constexpr (k_IsTriviallyRelocatable<T>)
+		{
+			if (count)
+				memcpy((void*)dst, (const void*)src, count * sizeof(T));
+		} else
+		{
+			for (u64 i = 0; i < count; i++)
+			{
+				new (dst + i) T(std::move(src[i]));
+				src[i].~T();
+			}
+		}
+	}
+} // namespace Na
+
+#endif // NA_RELOCATION_HPP
\ No newline at end of file
@@ -0,0 +1,165 @@
+#if !defined(NA_SLOT_MAP_HPP)
+#define NA_SLOT_MAP_HPP
+
+#include "./ArrayList.hpp"
+
+namespace Na {
+	/// 
+	/// 32 bits, the low k_IndexBits pick the slot, the rest is the slot's generation when the
+	/// handle was given out, generation 0 is never used, so a zeroed handle is null
+	/// 
+	template<typename T>
+	struct SlotHandle {
+		static constexpr u32 k_IndexBits = 20;
+		static constexpr u32 k_IndexMask = (1u << k_IndexBits) - 1;
+		static constexpr u32 k_MaxGeneration = (1u << (32 - k_IndexBits)) - 1;
+
+		u32 value = 0;
+
+		SlotHandle(void) = default;
+		inline SlotHandle(u32 index, u32 generation) : value(index | (generation << k_IndexBits)) {}
+
+		[[nodiscard]] inline u32 index(void) const { return value & k_IndexMask; }
+		[[nodiscard]] inline u32 generation(void) const { return value >> k_IndexBits; }
+
+		[[nodiscard]] inline bool operator==(const SlotHandle& other) const = default;
+		[[nodiscard]] inline operator bool(void) const { return value; }
+	};
+
+	/// 
+	/// values are stored densely, in no particular order, and addressed through generational
+	/// handles, inserting and erasing are O(1), erasing moves the last value into the hole
+	/// 
+	/// a handle stays valid until its value is erased, stale handles are detected,
+	/// unless a slot was reused SlotHandle::k_MaxGeneration times in between
+	/// 
+	/// meant for tables iterated every frame (e.g. gpu resources), pointers to values are
+	/// invalidated by inserts and erases, keep handles instead, warning: not thread safe
+	/// 
+	template<typename T>
+	class SlotMap {
+	public:
+		using Handle = SlotHandle<T>;
+		using iterator = ArrayList<T>::iterator;
+		using const_iterator = ArrayList<T>::const_iterator;
+		using T_t = T;
+
+		static constexpr u32 k_MaxSize = Handle::k_IndexMask + 1;
+	public:
+		SlotMap(void) = default;
+
+		template<typename... t_Args>
+		Handle emplace(t_Args&&... __args)
+		{
+			u32 slot_index = m_FreeSlot;
+			if (slot_index != k_U32Max)
+			{
+				m_FreeSlot = m_Slots[slot_index].index;
+			} else
+			{
+				NA_VERIFY(m_Slots.size() < k_MaxSize, "Failed to insert into slot map: Exceeded {} slots!", k_MaxSize);
+				slot_index = (u32)m_Slots.size();
+				m_Slots.emplace(Slot{ 0, 1 });
+			}
+
+			Slot& slot = m_Slots[slot_index];
+			slot.index = (u32)m_Values.size();
+
+			m_Values.emplace(std::forward<t_Args>(__args)...);
+			m_ValueSlots.emplace(slot_index);
+
+			return Handle(slot_index, slot.generation);
+		}
+		inline Handle insert(const T& value) { return this->emplace(value); }
+		inline Handle insert(T&& value) { return this->emplace(std::move(value)); }
+
+		// false if the handle is stale
+		bool erase(Handle handle)
+		{
+			if (!this->contains(handle))
+				return false;
+
+			u32 slot_index = handle.index();
+			Slot& slot = m_Slots[slot_index];
+
+			u32 last = (u32)m_Values.size() - 1;
+			if (slot.index != last)
+			{
+				m_Values[slot.index] = std::move(m_Values[last]);
+				m_ValueSlots[slot.index] = m_ValueSlots[last];
+				m_Slots[m_ValueSlots[slot.index]].index = slot.index;
+			}
+			m_Values.pop();
+			m_ValueSlots.pop();
+
+			slot.generation = slot.generation == Handle::k_MaxGeneration ? 1 : slot.generation + 1;
+			slot.index = m_FreeSlot;
+			m_FreeSlot = slot_index;
+			return true;
+		}
+
+		// every handle becomes stale
+		void clear(void)
+		{
+			// from the back, so nothing is moved
+			while (!m_Values.empty())
+				this->erase(this->handle(m_Values.size() - 1));
+		}
+
+		inline void reserve(u64 capacity)
+		{
+			if (capacity > m_Values.capacity())
+			{
+				m_Values.reallocate(capacity);
+				m_ValueSlots.reallocate(capacity);
+			}
+			if (capacity > m_Slots.capacity())
+				m_Slots.reallocate(capacity);
+		}
+
+		[[nodiscard]] inline bool contains(Handle handle) const
+		{
+			return handle && handle.index() < m_Slots.size() && m_Slots[handle.index()].generation == handle.generation();
+		}
+
+		// nullptr if the handle is stale
+		[[nodiscard]] inline T* get(Handle handle) { return this->contains(handle) ? &m_Values[m_Slots[handle.index()].index] : nullptr; }
+		[[nodiscard]] inline const T* get(Handle handle) const { return this->contains(handle) ? &m_Values[m_Slots[handle.index()].index] : nullptr; }
+
+		[[nodiscard]] inline T& operator[](Handle handle) { return m_Values[m_Slots[handle.index()].index]; }
+		[[nodiscard]] inline const T& operator[](Handle handle) const { return m_Values[m_Slots[handle.index()].index]; }
+
+		// the handle of the value at position index of the dense array
+		[[nodiscard]] inline Handle handle(u64 index) const
+		{
+			u32 slot_index = m_ValueSlots[index];
+			return Handle(slot_index, m_Slots[slot_index].generation);
+		}
+
+		[[nodiscard]] inline iterator begin(void) { return m_Values.begin(); }
+		[[nodiscard]] inline const_iterator begin(void) const { return m_Values.begin(); }
+		[[nodiscard]] inline const_iterator cbegin(void) const { return m_Values.cbegin(); }
+
+		[[nodiscard]] inline iterator end(void) { return m_Values.end(); }
+		[[nodiscard]] inline const_iterator end(void) const { return m_Values.end(); }
+		[[nodiscard]] inline const_iterator cend(void) const { return m_Values.cend(); }
+
+		[[nodiscard]] inline T* ptr(void) { return m_Values.ptr(); }
+		[[nodiscard]] inline const T* ptr(void) const { return m_Values.ptr(); }
+
+		[[nodiscard]] inline u64 size(void) const { return m_Values.size(); }
+		[[nodiscard]] inline bool empty(void) const { return m_Values.empty(); }
+	private:
+		struct Slot {
+			u32 index; // into m_Values, or the next free slot
+			u32 generation;
+		};
+	private:
+		ArrayList<T> m_Values;
+		ArrayList<u32> m_ValueSlots; // the slot of each value
+		ArrayList<Slot> m_Slots;
+		u32 m_FreeSlot = k_U32Max;
+	};
+} // namespace Na
+
+#endif // NA_SLOT_MAP_HPP
\ No newline at end of file
@@ -0,0 +1,437 @@
+#include "Pch.hpp"
+#include "Natrium/Assets/AssetPack.hpp"
+
+#if defined(NA_PLATFORM_WINDOWS)
+#define C_STR string().c_str
+#elif defined(NA_PLATFORM_LINUX)
+#define C_STR c_str
+#else
+#define C_STR c_str
+#endif
+
+namespace Na {
+	// FNV-1a, stable across runs and platforms unlike std::hash
+	static u64 hashBytes(const void* data, u64 size)
+	{
+		u64 hash = 0xCBF29CE484222325ull;
+		for (u64 i = 0; i < size; i++)
+		{
+			hash ^= ((const Byte*)data)[i];
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	static inline u32 read32(const Byte* src)
+	{
+		u32 value;
+		memcpy(&value, src, sizeof(u32));
+		return value;
+	}
+
+	// LZ4's lengths, 15 in the token continues in bytes of 255 until a smaller one
+	static void writeLength(std::vector<Byte>& dst, u64 length)
+	{
+		for (; length >= 255; length -= 255)
+			dst.push_back(255);
+		dst.push_back((Byte)length);
+	}
+
+	/// 
+	/// the LZ4 block format with a greedy single probe matcher, fast but not the densest,
+	/// the last 5 bytes are always literals and no match starts in the last 12, as the format requires
+	/// 
+	static std::vector<Byte> lz4Compress(std::span<const Byte> src)
+	{
+		static constexpr u32 k_HashBits = 16;
+		static constexpr u64 k_MinMatch = 4;
+		static constexpr u64 k_MaxOffset = 65535;
+
+		std::vector<Byte> dst;
+		dst.reserve(src.size() / 2);
+
+		auto emit = [&](u64 literal_start, u64 literal_size, u64 offset, u64 match_size)
+		{
+			u64 token = dst.size();
+			dst.push_back((Byte)(std::min<u64>(literal_size, 15) << 4));
+			if (literal_size >= 15)
+				writeLength(dst, literal_size - 15);
+			dst.insert(dst.end(), src.data() + literal_start, src.data() + literal_start + literal_size);
+
+			// without a match, this was the last sequence
+			if (!match_size)
+				return;
+
+			dst[token] |= (Byte)std::min<u64>(match_size - k_MinMatch, 15);
+			dst.push_back((Byte)offset);
+			dst.push_back((Byte)(offset >> 8));
+			if (match_size - k_MinMatch >= 15)
+				writeLength(dst, match_size - k_MinMatch - 15);
+		};
+
+		u64 anchor = 0;
+		if (src.size() > 12)
+		{
+			std::vector<u64> table(1ull << k_HashBits, k_U64Max);
+
+			u64 match_limit = src.size() - 12;
+			u64 match_end = src.size() - 5;
+			for (u64 pos = 0; pos < match_limit;)
+			{
+				u32 sequence = read32(src.data() + pos);
+				u32 hash = (sequence * 2654435761u) >> (32 - k_HashBits);
+
+				u64 candidate = std::exchange(table[hash], pos);
+				if (candidate == k_U64Max || pos - candidate > k_MaxOffset || read32(src.data() + candidate) != sequence)
+				{
+					pos++;
+					continue;
+				}
+
+				u64 match_size = k_MinMatch;
+				while (pos + match_size < match_end && src[candidate + match_size] == src[pos + match_size])
+					match_size++;
+
+				emit(anchor, pos - anchor, pos - candidate, match_size);
+				pos += match_size;
+				anchor = pos;
+			}
+		}
+		emit(anchor, src.size() - anchor, 0, 0);
+
+		return dst;
+	}
+
+	static inline void verifyBlock(bool valid)
+	{
+		if (!valid)
+			throw std::runtime_error("Failed to decompress LZ4 block: It is corrupt!");
+	}
+
+	// [offset, offset + size) lies within [0, total), without offset + size wrapping around
+	static inline bool rangeFits(u64 offset, u64 size, u64 total)
+	{
+		return offset <= total && size <= total - offset;
+	}
+
+	static void lz4Decompress(std::span<const Byte> src, std::span<Byte> dst)
+	{
+		u64 in = 0, out = 0;
+		while (in < src.size())
+		{
+			Byte token = src[in++];
+
+			u64 literal_size = token >> 4;
+			if (literal_size == 15)
+			{
+				Byte extra;
+				do
+				{
+					verifyBlock(in < src.size());
+					extra = src[in++];
+					literal_size += extra;
+				} while (extra == 255);
+			}
+
+			verifyBlock(rangeFits(in, literal_size, src.size()) && rangeFits(out, literal_size, dst.size()));
+			if (literal_size)
+				memcpy(dst.data() + out, src.data() + in, literal_size);
+			in += literal_size;
+			out += literal_size;
+
+			if (in == src.size())
+				break;
+
+			verifyBlock(in + 2 <= src.size());
+			u64 offset = src[in] | (u64)src[in + 1] << 8;
+			in += 2;
+			verifyBlock(offset && offset <= out);
+
+			u64 match_size = token & 15;
+			if (match_size == 15)
+			{
+				Byte extra;
+				do
+				{
+					verifyBlock(in < src.size());
+					extra = src[in++];
+					match_size += extra;
+				} while (extra == 255);
+			}
+			match_size += 4;
+
+			verifyBlock(rangeFits(out, match_size, dst.size()));
+
+			// matches may overlap what they write, e.g. runs with an offset of 1
+			for (u64 i = 0; i < match_size; i++, out++)
+				dst[out] = dst[out - offset];
+		}
+
+		verifyBlock(out == dst.size());
+	}
+
+	AssetPack::AssetPack(const std::filesystem::path& path)
+	: m_File(std::make_shared<MappedFile>(path)),
+	m_Path(path)
+	{
+		const MappedFile& file = *m_File;
+
+		Header header;
+		NA_VERIFY(file.size() >= sizeof(Header), "Failed to open asset pack {}: Not an asset pack!", path.C_STR());
+		memcpy(&header, file.data(), sizeof(Header));
+
+		NA_VERIFY(header.magic == k_Magic, "Failed to open asset pack {}: Not an asset pack!", path.C_STR());
+		NA_VERIFY(header.version == k_Version, "Failed to open asset pack {}: Version {} is not supported!", path.C_STR(), header.version);
+		NA_VERIFY(
+			header.toc_offset % alignof(Entry) == 0 &&
+			header.toc_offset <= file.size() &&
+			header.entry_count <= (file.size() - header.toc_offset) / sizeof(Entry) &&
+			rangeFits(header.paths_offset, header.paths_size, file.size()),
+			"Failed to open asset pack {}: It is truncated!",
+				path.C_STR()
+		);
+
+		// the mapping is page aligned, so the entries can be used in place
+		m_Entries = { (const Entry*)(file.data() + header.toc_offset), header.entry_count };
+		m_Paths = { (const char*)file.data() + header.paths_offset, header.paths_size };
+
+		for (const Entry& entry : m_Entries)
+			NA_VERIFY(
+				rangeFits(entry.offset, entry.stored_size, file.size()) && rangeFits(entry.path_offset, entry.path_size, m_Paths.size()),
+				"Failed to open asset pack {}: An entry is out of bounds!",
+					path.C_STR()
+			);
+	}
+
+	const AssetPack::Entry* AssetPack::find(std::string_view path) const
+	{
+		u64 hash = HashPath(path);
+
+		auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash, [](const Entry& entry, u64 hash) { return entry.path_hash < hash; });
+		for (; it != m_Entries.end() && it->path_hash == hash; it++)
+		{
+			if (this->entry_path(*it) == path)
+				return &*it;
+		}
+
+		return nullptr;
+	}
+
+	std::optional<AssetBlob> AssetPack::read(std::string_view path) const
+	{
+		const Entry* entry = this->find(path);
+		if (!entry)
+			return std::nullopt;
+
+		return this->read(*entry);
+	}
+
+	AssetBlob AssetPack::read(const Entry& entry) const
+	{
+		AssetBlob blob;
+		blob.path = this->entry_path(entry);
+
+		std::span<const Byte> stored = { m_File->data() + entry.offset, entry.stored_size };
+		switch (entry.compression)
+		{
+		case PackCompression::None:
+			NA_VERIFY(entry.stored_size == entry.size, "Failed to read {} from asset pack {}: Its size is corrupt!", blob.path.C_STR(), m_Path.C_STR());
+			blob.bytes = stored;
+			blob.owner = m_File;
+			break;
+		case PackCompression::LZ4:
+		{
+			std::shared_ptr<Byte[]> data(new Byte[entry.size]);
+			lz4Decompress(stored, { data.get(), entry.size });
+			blob.bytes = { data.get(), entry.size };
+			blob.owner = std::move(data);
+			break;
+		}
+		default:
+			throw std::runtime_error(NA_FORMAT("Failed to read {} from asset pack {}: Unknown compression!", blob.path.C_STR(), m_Path.C_STR()));
+		}
+
+		// hashing every read would cost more than the mapping saves
+		if (k_BuildConfig == BuildConfig::Debug)
+			NA_VERIFY(
+				hashBytes(blob.bytes.data(), blob.bytes.size()) == entry.content_hash,
+				"Failed to read {} from asset pack {}: Its contents do not match their hash!",
+					blob.path.C_STR(),
+					m_Path.C_STR()
+			);
+
+		return blob;
+	}
+
+	std::string_view AssetPack::entry_path(const Entry& entry) const
+	{
+		return { m_Paths.data() + entry.path_offset, entry.path_size };
+	}
+
+	u64 AssetPack::HashPath(std::string_view path)
+	{
+		return hashBytes(path.data(), path.size());
+	}
+
+	void AssetPackWriter::add(std::string_view path, std::span<const Byte> data, PackCompression compression)
+	{
+		u64 content_hash = hashBytes(data.data(), data.size());
+
+		Blob blob;
+		blob.size = data.size();
+		blob.content_hash = content_hash;
+		blob.compression = PackCompression::None;
+
+		if (compression == PackCompression::LZ4)
+		{
+			std::vector<Byte> compressed = lz4Compress(data);
+			if (compressed.size() < data.size())
+			{
+				blob.data = std::move(compressed);
+				blob.compression = PackCompression::LZ4;
+			}
+		}
+		if (blob.compression == PackCompression::None)
+			blob.data.assign(data.begin(), data.end());
+
+		// compression is deterministic, so equal stored bytes mean equal contents
+		u64 blob_index = m_Blobs.size();
+		auto [first, last] = m_BlobsByHash.equal_range(content_hash);
+		for (auto it = first; it != last; it++)
+		{
+			const Blob& other = m_Blobs[it->second];
+			if (other.size == blob.size && other.compression == blob.compression && other.data == blob.data)
+			{
+				blob_index = it->second;
+				break;
+			}
+		}
+
+		if (blob_index == m_Blobs.size())
+		{
+			m_BlobsByHash.emplace(content_hash, blob_index);
+			m_Blobs.push_back(std::move(blob));
+		}
+
+		m_Entries.insert_or_assign(std::string(path), blob_index);
+	}
+
+	void AssetPackWriter::add_file(std::string_view path, const std::filesystem::path& file, PackCompression compression)
+	{
+		MappedFile mapped_file(file);
+		this->add(path, mapped_file.bytes(), compression);
+	}
+
+	u64 AssetPackWriter::add_directory(const std::filesystem::path& dir, PackCompression compression)
+	{
+		u64 count = 0;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(dir))
+		{
+			if (!entry.is_regular_file())
+				continue;
+
+			this->add_file(std::filesystem::relative(entry.path(), dir).generic_string(), entry.path(), compression);
+			count++;
+		}
+
+		return count;
+	}
+
+	void AssetPackWriter::write(const std::filesystem::path& path) const
+	{
+		auto align = [](u64 offset) { return (offset + AssetPack::k_EntryAlignment - 1) & ~(AssetPack::k_EntryAlignment - 1); };
+
+		// blobs no path refers to anymore are skipped, the rest are written in order of first use
+		std::vector<u64> blob_offsets(m_Blobs.size(), k_U64Max);
+		std::vector<const Blob*> written_blobs;
+
+		u64 offset = align(sizeof(AssetPack::Header));
+		for (const auto& [entry_path, blob_index] : m_Entries)
+		{
+			if (blob_offsets[blob_index] != k_U64Max)
+				continue;
+
+			blob_offsets[blob_index] = offset;
+			written_blobs.push_back(&m_Blobs[blob_index]);
+			offset = align(offset + m_Blobs[blob_index].data.size());
+		}
+
+		std::vector<AssetPack::Entry> entries;
+		entries.reserve(m_Entries.size());
+
+		std::string paths;
+		for (const auto& [entry_path, blob_index] : m_Entries)
+		{
+			const Blob& blob = m_Blobs[blob_index];
+
+			AssetPack::Entry& entry = entries.emplace_back();
+			memset(&entry, 0, sizeof(AssetPack::Entry));
+			entry.path_hash = AssetPack::HashPath(entry_path);
+			entry.content_hash = blob.content_hash;
+			entry.offset = blob_offsets[blob_index];
+			entry.stored_size = blob.data.size();
+			entry.size = blob.size;
+			entry.path_offset = (u32)paths.size();
+			entry.path_size = (u32)entry_path.size();
+			entry.compression = blob.compression;
+
+			paths += entry_path;
+		}
+		NA_VERIFY(paths.size() <= k_U32Max, "Failed to write asset pack {}: The paths exceed 4 GiB!", path.C_STR());
+
+		// looked up by binary search over the hashes, equal hashes are compared by path
+		std::sort(entries.begin(), entries.end(), [](const AssetPack::Entry& lhs, const AssetPack::Entry& rhs) { return lhs.path_hash < rhs.path_hash; });
+
+		AssetPack::Header header;
+		header.magic = AssetPack::k_Magic;
+		header.version = AssetPack::k_Version;
+		header.entry_count = (u32)entries.size();
+		header.reserved = 0;
+		header.toc_offset = offset;
+		header.paths_offset = offset + entries.size() * sizeof(AssetPack::Entry);
+		header.paths_size = paths.size();
+
+		std::filesystem::path tmp_path = path;
+		tmp_path += ".tmp";
+		{
+			std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+			NA_VERIFY(file, "Failed to write asset pack {}: The file could not be opened!", tmp_path.C_STR());
+
+			static constexpr Byte k_Zeros[AssetPack::k_EntryAlignment] = {};
+			auto pad = [&file, &align](u64 size) { file.write((const char*)k_Zeros, align(size) - size); };
+
+			file.write((const char*)&header, sizeof(header));
+			pad(sizeof(header));
+
+			for (const Blob* blob : written_blobs)
+			{
+				file.write((const char*)blob->data.data(), blob->data.size());
+				pad(blob->data.size());
+			}
+
+			file.write((const char*)entries.data(), entries.size() * sizeof(AssetPack::Entry));
+			file.write(paths.data(), paths.size());
+
+			NA_VERIFY(file, "Failed to write asset pack {}!", tmp_path.C_STR());
+		}
+
+		std::filesystem::rename(tmp_path, path);
+	}
+
+	u64 AssetPackWriter::stored_size(void) const
+	{
+		std::vector<bool> counted(m_Blobs.size());
+
+		u64 size = 0;
+		for (const auto& [entry_path, blob_index] : m_Entries)
+		{
+			if (counted[blob_index])
+				continue;
+
+			counted[blob_index] = true;
+			size += m_Blobs[blob_index].data.size();
+		}
+
+		return size;
+	}
+} // namespace Na
\ No newline at end of file
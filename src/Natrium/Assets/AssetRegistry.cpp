@@ -1,6 +1,10 @@
 #include "Pch.hpp"
 #include "Natrium/Assets/AssetRegistry.hpp"
 
+#include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/JobSystem.hpp"
+#include "Natrium/Graphics/GpuMesh.hpp"
+
 #if defined(NA_PLATFORM_WINDOWS)
 #define C_STR string().c_str
 #elif defined(NA_PLATFORM_LINUX)
@@ -10,65 +14,702 @@
 #endif
 
 namespace Na {
-	extern ArrayVector<u32> LoadSpv(const std::filesystem::path& path);
+	// bumped whenever the key or the output format changes
+	static constexpr u64 k_ShaderCacheVersion = 2;
+
+	// FNV-1a, stable across runs and platforms unlike std::hash
+	static u64 hashBytes(u64 hash, const void* data, u64 size)
+	{
+		for (u64 i = 0; i < size; i++)
+		{
+			hash ^= ((const Byte*)data)[i];
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	static inline u64 hashString(u64 hash, std::string_view str)
+	{
+		u64 size = str.size();
+		hash = hashBytes(hash, &size, sizeof(size));
+		return hashBytes(hash, str.data(), str.size());
+	}
+
+	static std::string readFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// everything but the sources that decides which files are included and what they compile to
+	static u64 hashShaderOptions(u64 hash, std::string_view source, const ShaderCompileOptions& options)
+	{
+		hash = hashString(hash, source);
+		hash = hashString(hash, options.entry_point);
+
+		u64 include_dir_count = options.include_dirs.size();
+		hash = hashBytes(hash, &include_dir_count, sizeof(include_dir_count));
+		for (const std::filesystem::path& include_dir : options.include_dirs)
+			hash = hashString(hash, include_dir.generic_string());
+
+		return hash;
+	}
+
+	static u64 shaderCacheKey(
+		std::string_view source,
+		const ShaderString& shader,
+		const ShaderCompileOptions& options,
+		const std::vector<std::filesystem::path>& dependencies
+	)
+	{
+		u64 hash = 0xCBF29CE484222325ull;
+		hash = hashBytes(hash, &k_ShaderCacheVersion, sizeof(k_ShaderCacheVersion));
+		hash = hashShaderOptions(hash, source, options);
+		hash = hashBytes(hash, &options.optimize, sizeof(options.optimize));
+
+		u64 define_count = options.permutation.defines().size();
+		hash = hashBytes(hash, &define_count, sizeof(define_count));
+		for (const ShaderDefine& define : options.permutation.defines())
+		{
+			hash = hashString(hash, define.name);
+			hash = hashString(hash, define.value);
+		}
+
+		hash = hashString(hash, shader.data());
+
+		// a missing include hashes as empty, it fails the compile once the key misses
+		for (const std::filesystem::path& dependency : dependencies)
+		{
+			hash = hashString(hash, dependency.string());
+			hash = hashString(hash, readFile(dependency));
+		}
+
+		return hash;
+	}
+
+	// every source, entry point, include dirs and permutation caches under its own name,
+	// so compiling one never removes another's outputs
+	static std::string shaderCacheName(std::string_view source, const ShaderCompileOptions& options)
+	{
+		u64 permutation_key = options.permutation.empty() ? 0 : options.permutation.key();
+
+		u64 hash = hashShaderOptions(0xCBF29CE484222325ull, source, options);
+		hash = hashBytes(hash, &permutation_key, sizeof(permutation_key));
 
-	AssetRegistry::AssetRegistry(
-		const std::filesystem::path& asset_dir,
-		const std::filesystem::path& shader_output_dir
+		return NA_FORMAT("{}.{:016x}", std::filesystem::path(source).filename().string(), hash);
+	}
+
+	// registered next to the model, no path ends like this
+	static inline std::string meshKey(std::string_view path)
+	{
+		return NA_FORMAT("{}?gpu", path);
+	}
+
+	// every file the last compile included, one per line
+	static std::vector<std::filesystem::path> readDependencies(const std::filesystem::path& path)
+	{
+		std::vector<std::filesystem::path> dependencies;
+
+		std::ifstream file(path);
+		for (std::string line; std::getline(file, line);)
+		{
+			if (!line.empty())
+				dependencies.emplace_back(line);
+		}
+
+		return dependencies;
+	}
+
+	static void writeDependencies(const std::filesystem::path& path, const std::vector<std::filesystem::path>& dependencies)
+	{
+		std::ofstream file(path);
+		for (const std::filesystem::path& dependency : dependencies)
+			file << dependency.string() << '\n';
+	}
+
+	// outputs of older versions of the same file, named "{cache_name}-{key}{extension}"
+	static void removeStaleOutputs(
+		const std::filesystem::path& output_dir,
+		std::string_view cache_name,
+		const std::filesystem::path& current_output,
+		const std::initializer_list<std::string_view>& extensions
 	)
+	{
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(output_dir, error))
+		{
+			const std::filesystem::path& path = entry.path();
+			if (std::find(extensions.begin(), extensions.end(), path.extension().string()) == extensions.end())
+				continue;
+
+			std::string stem = path.stem().string();
+			if (
+				stem.size() != cache_name.size() + 17 ||
+				!stem.starts_with(cache_name) ||
+				stem[cache_name.size()] != '-' ||
+				stem == current_output.stem().string()
+			)
+				continue;
+
+			std::filesystem::remove(path, error);
+		}
+	}
+
+	// the reflection is cached next to the .spv, so cached shaders skip parsing it again
+	static ShaderReflection writeShaderOutput(const std::filesystem::path& output_path, const ShaderBinary& shader_binary)
+	{
+		std::ofstream output_file(output_path, std::ios::binary);
+		NA_ASSERT(output_file, "Failed to open file {}", output_path.C_STR());
+
+		output_file.write((const char*)shader_binary.ptr(), shader_binary.size());
+		output_file.close();
+
+		ShaderReflection reflection(shader_binary);
+		reflection.save(std::filesystem::path(output_path).replace_extension(".refl"));
+		return reflection;
+	}
+
+	AssetRegistry::AssetRegistry(const std::filesystem::path& asset_dir, const std::filesystem::path& shader_output_dir)
 	: m_AssetDir(asset_dir),
-	m_ShaderOutputDir(shader_output_dir)
+	m_ShaderOutputDir(shader_output_dir),
+	m_AssetCacheDir(shader_output_dir)
 	{}
 
 	void AssetRegistry::destroy(void)
 	{
-		m_Assets.clear();
+		// the futures of skipped loads report a broken promise
+		m_StopLoading.store(true, std::memory_order_release);
+		if (!m_LoadJobs.done())
+			JobSystem::Get().wait(m_LoadJobs);
+		m_StopLoading.store(false, std::memory_order_relaxed);
+
+		m_PendingLoads.clear();
+		this->free_all();
 		m_AssetDir.clear();
 		m_ShaderOutputDir.clear();
+		m_AssetCacheDir.clear();
+		m_ShaderIncludeDirs.clear();
+		{
+			std::unique_lock lock(m_PacksMutex);
+			m_Packs.clear(); // assets read in place keep their pack mapped
+		}
+	}
+
+	void AssetRegistry::mount_pack(const std::filesystem::path& path)
+	{
+		// opened before locking, loads only wait for the pack to be added
+		AssetPack pack(path);
+
+		std::unique_lock lock(m_PacksMutex);
+		m_Packs.emplace_back(std::move(pack));
+	}
+
+	void AssetRegistry::free_asset(const std::string_view& name)
+	{
+		Shard& shard = this->_shard(name);
+		std::lock_guard lock(shard.mutex);
+
+		auto it = shard.assets.find(name);
+		if (it == shard.assets.end())
+			return;
+
+		m_MemoryUsage -= it->second.memory_usage;
+		shard.assets.erase(it);
+	}
+
+	void AssetRegistry::free_all(void)
+	{
+		for (Shard& shard : m_Shards)
+		{
+			std::lock_guard lock(shard.mutex);
+
+			for (auto& [path, entry] : shard.assets)
+				m_MemoryUsage -= entry.memory_usage;
+			shard.assets.clear();
+		}
+	}
+
+	u32 AssetRegistry::process_loads(void)
+	{
+		// taken out first, callbacks may start new loads
+		std::vector<std::pair<std::string, PendingLoad>> finished;
+		{
+			std::lock_guard lock(m_PendingMutex);
+			for (auto it = m_PendingLoads.begin(); it != m_PendingLoads.end();)
+			{
+				if (it->second.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					it++;
+					continue;
+				}
+
+				auto node = m_PendingLoads.extract(it++);
+				finished.emplace_back(std::move(node.key()), std::move(node.mapped()));
+			}
+		}
+
+		for (auto& [path, pending] : finished)
+		{
+			AssetHandle<> asset;
+			try
+			{
+				asset = pending.future.get();
+			} catch (const std::exception& e)
+			{
+				g_Logger.fmt(Error, "Failed to load {}: {}", path, e.what());
+				continue;
+			}
+
+			for (auto& callback : pending.callbacks)
+				callback(asset);
+		}
+
+		this->trim();
+
+		return (u32)finished.size();
+	}
+
+	u64 AssetRegistry::trim(void)
+	{
+		u64 budget = m_Budget;
+		if (m_MemoryUsage <= budget)
+			return 0;
+
+		return this->_evict(budget);
+	}
+
+	u64 AssetRegistry::evict_unused(void)
+	{
+		return this->_evict(0);
+	}
+
+	u64 AssetRegistry::pending_loads(void) const
+	{
+		std::lock_guard lock(m_PendingMutex);
+		return m_PendingLoads.size();
+	}
+
+	AssetHandle<> AssetRegistry::_find(std::string_view path)
+	{
+		Shard& shard = this->_shard(path);
+		std::lock_guard lock(shard.mutex);
+
+		auto it = shard.assets.find(path);
+		if (it == shard.assets.end())
+			return nullptr;
+
+		it->second.last_use = ++m_UseClock;
+		return it->second.asset;
+	}
+
+	void AssetRegistry::_insert(std::string_view path, const AssetHandle<>& asset)
+	{
+		u64 memory_usage = asset ? asset->memory_usage() : 0;
+
+		Shard& shard = this->_shard(path);
+		std::lock_guard lock(shard.mutex);
+
+		auto [it, inserted] = shard.assets.try_emplace(std::string(path));
+		if (!inserted)
+			m_MemoryUsage -= it->second.memory_usage;
+
+		it->second = Entry{ asset, memory_usage, ++m_UseClock };
+		m_MemoryUsage += memory_usage;
+	}
+
+	std::optional<std::shared_future<AssetHandle<>>> AssetRegistry::_begin_load(
+		std::string_view path,
+		std::promise<AssetHandle<>>& promise,
+		u64& load_id
+	)
+	{
+		std::lock_guard lock(m_PendingMutex);
+
+		auto it = m_PendingLoads.find(path);
+		if (it != m_PendingLoads.end())
+			return it->second.future;
+
+		// a load that finished since the caller looked is inserted before it is no longer pending
+		if (AssetHandle<> asset = this->_find(path))
+		{
+			std::promise<AssetHandle<>> loaded;
+			loaded.set_value(asset);
+			return loaded.get_future().share();
+		}
+
+		PendingLoad& pending = m_PendingLoads[std::string(path)];
+		pending.id = load_id = m_NextLoadID++;
+		pending.future = promise.get_future().share();
+
+		return std::nullopt;
+	}
+
+	void AssetRegistry::_end_load(std::string_view path, u64 load_id)
+	{
+		std::lock_guard lock(m_PendingMutex);
+
+		// callbacks keep it around until process_loads
+		auto it = m_PendingLoads.find(path);
+		if (it != m_PendingLoads.end() && it->second.id == load_id && it->second.callbacks.empty())
+			m_PendingLoads.erase(it);
+	}
+
+	std::shared_future<AssetHandle<>> AssetRegistry::_load_async(
+		std::string_view path,
+		AssetHandle<> (*load)(const AssetRegistry& registry, std::string_view path),
+		std::function<void(const AssetHandle<>&)> callback
+	)
+	{
+		std::lock_guard lock(m_PendingMutex);
+
+		auto it = m_PendingLoads.find(path);
+		if (it == m_PendingLoads.end())
+		{
+			if (AssetHandle<> asset = this->_find(path))
+			{
+				std::promise<AssetHandle<>> loaded;
+				loaded.set_value(asset);
+
+				std::shared_future<AssetHandle<>> future = loaded.get_future().share();
+				if (!callback)
+					return future;
+
+				it = m_PendingLoads.try_emplace(std::string(path)).first;
+				it->second.id = m_NextLoadID++;
+				it->second.future = future;
+			} else
+			{
+				it = m_PendingLoads.try_emplace(std::string(path)).first;
+				it->second.id = m_NextLoadID++;
+
+				auto task = std::make_shared<std::packaged_task<AssetHandle<>(void)>>(
+					[this, key = std::string(path), load_id = it->second.id, load](void) -> AssetHandle<>
+					{
+						AssetHandle<> asset = load(*this, key);
+						this->_insert(key, asset);
+						this->_end_load(key, load_id);
+						return asset;
+					}
+				);
+				it->second.future = task->get_future().share();
+
+				this->_enqueue_load([task](void) { (*task)(); });
+			}
+		}
+
+		if (callback)
+			it->second.callbacks.push_back(std::move(callback));
+
+		return it->second.future;
+	}
+
+	u64 AssetRegistry::_evict(u64 target_usage)
+	{
+		struct Candidate {
+			u64 last_use;
+			Shard* shard;
+			std::string path;
+		};
+
+		// only the registry refers to them, nobody else can get a new reference without a shard lock
+		std::vector<Candidate> candidates;
+		for (Shard& shard : m_Shards)
+		{
+			std::lock_guard lock(shard.mutex);
+			for (auto& [path, entry] : shard.assets)
+			{
+				if (entry.asset.use_count() == 1)
+					candidates.push_back(Candidate{ entry.last_use, &shard, path });
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.last_use < b.last_use; });
+
+		u64 evicted = 0;
+		for (const Candidate& candidate : candidates)
+		{
+			if (target_usage && m_MemoryUsage <= target_usage)
+				break;
+
+			std::lock_guard lock(candidate.shard->mutex);
+
+			// may have been looked up since
+			auto it = candidate.shard->assets.find(candidate.path);
+			if (it == candidate.shard->assets.end() || it->second.asset.use_count() != 1)
+				continue;
+
+			m_MemoryUsage -= it->second.memory_usage;
+			candidate.shard->assets.erase(it);
+			evicted++;
+		}
+
+		return evicted;
+	}
+
+	std::optional<AssetBlob> AssetRegistry::_read_from_packs(std::string_view path) const
+	{
+		std::shared_lock lock(m_PacksMutex);
+		for (auto it = m_Packs.rbegin(); it != m_Packs.rend(); it++)
+		{
+			if (std::optional<AssetBlob> blob = it->read(path))
+				return blob;
+		}
+
+		return std::nullopt;
+	}
+
+	std::filesystem::path AssetRegistry::_asset_cache_path(const std::filesystem::path& src_path, std::string_view extension, u32 version) const
+	{
+		std::error_code error;
+		u64 size = std::filesystem::file_size(src_path, error);
+		if (error)
+			return {};
+
+		auto write_time = std::filesystem::last_write_time(src_path, error);
+		if (error)
+			return {};
+
+		u64 write_ticks = (u64)write_time.time_since_epoch().count();
+
+		// the path hash is part of the name the stale sweep matches,
+		// so equally named files in different folders never replace each other's cache
+		u64 path_hash = hashString(0xCBF29CE484222325ull, std::filesystem::relative(src_path, m_AssetDir, error).generic_string());
+
+		u64 hash = path_hash;
+		hash = hashBytes(hash, &version, sizeof(version));
+		hash = hashBytes(hash, &size, sizeof(size));
+		hash = hashBytes(hash, &write_ticks, sizeof(write_ticks));
+
+		return m_AssetCacheDir / NA_FORMAT("{}-{:016x}-{:016x}{}", src_path.filename().string(), path_hash, hash, extension);
+	}
+
+	void AssetRegistry::_write_asset_cache(const std::filesystem::path& cache_path, const std::function<void(const std::filesystem::path&)>& save) const
+	{
+		std::string cache_name = cache_path.stem().string();
+		cache_name.resize(cache_name.size() - 17); // "-{key}", the rest ends in the path hash
+
+		std::error_code error;
+		std::filesystem::create_directories(m_AssetCacheDir, error);
+
+		std::filesystem::path tmp_path = cache_path;
+		tmp_path += NA_FORMAT(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+		// a failed cache only costs the next launch another import
+		try
+		{
+			save(tmp_path);
+			std::filesystem::rename(tmp_path, cache_path);
+		} catch (...)
+		{
+			std::filesystem::remove(tmp_path, error);
+			return;
+		}
+
+		removeStaleOutputs(m_AssetCacheDir, cache_name, cache_path, { cache_path.extension().string() });
+	}
+
+	void AssetRegistry::_enqueue_load(std::function<void(void)> task)
+	{
+		// exceptions end up in the task's future
+		JobSystem::Get().run(
+			[this, task = std::move(task)](void)
+			{
+				if (!m_StopLoading.load(std::memory_order_acquire))
+					task();
+			},
+			&m_LoadJobs
+		);
 	}
 
 	ShaderModule AssetRegistry::create_shader_module_from_src(
 		const std::string_view& src_path,
 		ShaderStageBits stage,
-		const std::string_view& entry_point
+		const std::string_view& entry_point,
+		const ShaderPermutation& permutation
 	) const
 	{
-		std::filesystem::path input_path = m_AssetDir / src_path;
-		std::filesystem::path output_path = m_ShaderOutputDir / input_path.filename().replace_extension(".spv");
+		ShaderString shader(m_AssetDir / src_path);
+		return this->_create_shader_module(shader, std::filesystem::path(src_path).generic_string(), stage, entry_point, permutation);
+	}
 
-		if (std::filesystem::exists(output_path) &&
-			std::filesystem::last_write_time(output_path)
-				> std::filesystem::last_write_time(input_path))
-			return ShaderModule(LoadSpv(output_path), stage, entry_point);
+	std::vector<std::filesystem::path> AssetRegistry::shader_dependencies(
+		const std::string_view& src_path,
+		const std::string_view& entry_point,
+		const ShaderPermutation& permutation
+	) const
+	{
+		std::filesystem::path path = m_AssetDir / src_path;
 
-		ShaderBinary shader_binary(ShaderString(m_AssetDir / src_path).compile());
+		ShaderCompileOptions options = this->_shader_compile_options(entry_point, permutation);
+		std::string cache_name = shaderCacheName(std::filesystem::path(src_path).generic_string(), options);
 
-		std::ofstream output_file(output_path, std::ios::binary);
-		NA_ASSERT(output_file, "Failed to open file {}", output_path.C_STR());
+		std::vector<std::filesystem::path> dependencies = readDependencies(m_ShaderOutputDir / NA_FORMAT("{}.deps", cache_name));
 
-		output_file.write((const char*)shader_binary.ptr(), shader_binary.size());
-		output_file.close();
+		std::error_code error;
+		dependencies.push_back(std::filesystem::weakly_canonical(path, error));
+
+		return dependencies;
+	}
+
+	ShaderModule AssetRegistry::create_shader_module(
+		const std::string_view& spv_path,
+		ShaderStageBits stage,
+		const std::string_view& entry_point
+	)
+	{
+		AssetHandle<ShaderBinary> shader_binary = this->load_asset<ShaderBinary>(spv_path);
+		NA_VERIFY(shader_binary && *shader_binary, "Failed to create shader module: {} is empty!", spv_path);
+
+		return ShaderModule(*shader_binary, stage, entry_point);
+	}
+
+	AssetHandle<GpuMesh> AssetRegistry::load_mesh(const std::string_view& path, bool keep_model)
+	{
+		std::string key = meshKey(path);
+		if (AssetHandle<> mesh = this->_find(key))
+			return std::dynamic_pointer_cast<GpuMesh>(mesh);
+
+		std::promise<AssetHandle<>> promise;
+		u64 load_id = 0;
+		if (std::optional<std::shared_future<AssetHandle<>>> loading = this->_begin_load(key, promise, load_id))
+			return std::dynamic_pointer_cast<GpuMesh>(loading->get());
 
-		return ShaderModule(shader_binary, stage, entry_point);
+		try
+		{
+			AssetHandle<ModelAsset> model = std::dynamic_pointer_cast<ModelAsset>(this->_find(path));
+			if (!model)
+				model = keep_model ? this->load_asset<ModelAsset>(path) : this->_load<ModelAsset>(path);
+			NA_VERIFY(model && *model, "Failed to load mesh: {} is empty!", path);
+
+			AssetHandle<> mesh = std::make_shared<GpuMesh>(*model);
+			this->_insert(key, mesh);
+			promise.set_value(mesh);
+			this->_end_load(key, load_id);
+
+			return std::dynamic_pointer_cast<GpuMesh>(mesh);
+		} catch (...)
+		{
+			promise.set_exception(std::current_exception());
+			this->_end_load(key, load_id);
+			throw;
+		}
+	}
+
+	void AssetRegistry::free_mesh(const std::string_view& path)
+	{
+		this->free_asset(meshKey(path));
 	}
 
 	ShaderModule AssetRegistry::create_shader_module_from_str(
 		const std::string_view& name,
 		const std::string_view& src,
 		ShaderStageBits stage,
-		const std::string_view& entry_point
+		const std::string_view& entry_point,
+		const ShaderPermutation& permutation
 	) const
 	{
-		std::filesystem::path output_path = (m_ShaderOutputDir / name).replace_extension(".spv");
+		ShaderString shader(src, name);
+		return this->_create_shader_module(shader, name, stage, entry_point, permutation);
+	}
 
-		ShaderBinary shader_binary(ShaderString(src, name).compile());
+	std::vector<ShaderModule> AssetRegistry::create_shader_modules_from_src(const ShaderSourceInfo* infos, u64 count, u32 thread_count) const
+	{
+		if (!thread_count)
+			thread_count = JobSystem::Get().worker_count() + 1;
+		thread_count = (u32)std::min<u64>(thread_count, count);
 
-		std::ofstream output_file(output_path, std::ios::binary);
-		NA_ASSERT(output_file, "Failed to open file {}", output_path.C_STR());
+		std::vector<ShaderModule> shader_modules(count);
 
-		output_file.write((const char*)shader_binary.ptr(), shader_binary.size());
-		output_file.close();
+		std::atomic<u64> next = 0;
+		std::exception_ptr exception = nullptr;
+		std::mutex exception_mutex;
+
+		auto work = [&](void)
+		{
+			for (u64 i = next++; i < count; i = next++)
+			{
+				try
+				{
+					shader_modules[i] = this->create_shader_module_from_src(infos[i].src_path, infos[i].stage, infos[i].entry_point, infos[i].permutation);
+				} catch (...)
+				{
+					std::lock_guard lock(exception_mutex);
+					if (!exception)
+						exception = std::current_exception();
+				}
+			}
+		};
+
+		// the calling thread compiles as well
+		JobSystem& job_system = JobSystem::Get();
+
+		JobCounter counter;
+		for (u32 i = 1; i < thread_count; i++)
+			job_system.run(work, &counter);
+
+		work();
+
+		job_system.wait(counter);
+
+		if (exception)
+			std::rethrow_exception(exception);
+
+		return shader_modules;
+	}
+
+	ShaderCompileOptions AssetRegistry::_shader_compile_options(const std::string_view& entry_point, const ShaderPermutation& permutation) const
+	{
+		ShaderCompileOptions options;
+		options.entry_point = entry_point;
+		options.permutation = permutation;
+		options.include_dirs = m_ShaderIncludeDirs;
+		options.include_dirs.push_back(m_AssetDir);
+		return options;
+	}
+
+	ShaderModule AssetRegistry::_create_shader_module(
+		const ShaderString& shader,
+		const std::string_view& source,
+		ShaderStageBits stage,
+		const std::string_view& entry_point,
+		const ShaderPermutation& permutation
+	) const
+	{
+		ShaderCompileOptions options = this->_shader_compile_options(entry_point, permutation);
+		std::string cache_name = shaderCacheName(source, options);
+
+		// the includes of the last compile, any new include has to come from an edit to one of them
+		std::filesystem::path dependencies_path = m_ShaderOutputDir / NA_FORMAT("{}.deps", cache_name);
+		std::vector<std::filesystem::path> dependencies = readDependencies(dependencies_path);
+
+		std::filesystem::path output_path = m_ShaderOutputDir / NA_FORMAT("{}-{:016x}.spv", cache_name, shaderCacheKey(source, shader, options, dependencies));
+		if (std::filesystem::exists(output_path))
+		{
+			// mapped only until the module is created
+			AssetHandle<ShaderBinary> shader_binary = ShaderBinary::Load(output_path);
+
+			std::optional<ShaderReflection> reflection = ShaderReflection::Load(std::filesystem::path(output_path).replace_extension(".refl"));
+			if (!reflection)
+			{
+				reflection = ShaderReflection(*shader_binary);
+				reflection->save(std::filesystem::path(output_path).replace_extension(".refl"));
+			}
+
+			return ShaderModule(*shader_binary, stage, std::move(*reflection), entry_point);
+		}
+
+		dependencies.clear();
+		options.dependencies = &dependencies;
+		ShaderBinary shader_binary(shader.compile(options));
+
+		std::sort(dependencies.begin(), dependencies.end());
+		dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+		writeDependencies(dependencies_path, dependencies);
+
+		output_path = m_ShaderOutputDir / NA_FORMAT("{}-{:016x}.spv", cache_name, shaderCacheKey(source, shader, options, dependencies));
+		removeStaleOutputs(m_ShaderOutputDir, cache_name, output_path, { ".spv", ".refl" });
 
-		return ShaderModule(shader_binary, stage, entry_point);
+		ShaderReflection reflection = writeShaderOutput(output_path, shader_binary);
+		return ShaderModule(shader_binary, stage, std::move(reflection), entry_point);
 	}
 } // namespace Na
@@ -12,20 +12,256 @@
 #endif
 
 namespace Na {
-	AssetHandle<ImageAsset> ImageAsset::Load(const std::filesystem::path& path)
+	template<typename T>
+	static T readValue(std::span<const Byte> file, u64 offset)
 	{
-		AssetHandle<ImageAsset> img_asset = std::make_shared<ImageAsset>();
+		if (offset + sizeof(T) > file.size())
+			throw std::runtime_error("Failed to load image: Unexpected end of file!");
+
+		T value;
+		memcpy(&value, file.data() + offset, sizeof(T));
+		return value;
+	}
+
+	// where the levels of a loaded image are, data is either malloc'd or points into the file
+	struct ImageLayout {
+		const void* data = nullptr;
+		int width = 0, height = 0;
+		vk::Format format = vk::Format::eR8G8B8A8Srgb;
+		std::vector<u64> level_sizes;
+		std::vector<u64> level_offsets;
+	};
+
+	// blocks are 4x4 texels for every compressed format the dds loader maps to,
+	// block_bytes is the texel size of the uncompressed ones
+	struct DdsFormat {
+		vk::Format format;
+		u32 block_bytes;
+		bool compressed;
+	};
+
+	static std::optional<DdsFormat> ddsFormatFromDxgi(u32 dxgi_format)
+	{
+		switch (dxgi_format)
+		{
+		case 28: return DdsFormat{ vk::Format::eR8G8B8A8Unorm, 4, false };
+		case 29: return DdsFormat{ vk::Format::eR8G8B8A8Srgb, 4, false };
+		case 71: return DdsFormat{ vk::Format::eBc1RgbaUnormBlock, 8, true };
+		case 72: return DdsFormat{ vk::Format::eBc1RgbaSrgbBlock, 8, true };
+		case 74: return DdsFormat{ vk::Format::eBc2UnormBlock, 16, true };
+		case 75: return DdsFormat{ vk::Format::eBc2SrgbBlock, 16, true };
+		case 77: return DdsFormat{ vk::Format::eBc3UnormBlock, 16, true };
+		case 78: return DdsFormat{ vk::Format::eBc3SrgbBlock, 16, true };
+		case 80: return DdsFormat{ vk::Format::eBc4UnormBlock, 8, true };
+		case 81: return DdsFormat{ vk::Format::eBc4SnormBlock, 8, true };
+		case 83: return DdsFormat{ vk::Format::eBc5UnormBlock, 16, true };
+		case 84: return DdsFormat{ vk::Format::eBc5SnormBlock, 16, true };
+		case 95: return DdsFormat{ vk::Format::eBc6HUfloatBlock, 16, true };
+		case 96: return DdsFormat{ vk::Format::eBc6HSfloatBlock, 16, true };
+		case 98: return DdsFormat{ vk::Format::eBc7UnormBlock, 16, true };
+		case 99: return DdsFormat{ vk::Format::eBc7SrgbBlock, 16, true };
+		default: return std::nullopt;
+		}
+	}
+
+	static constexpr u32 fourCC(const char (&code)[5])
+	{
+		return (u32)code[0] | ((u32)code[1] << 8) | ((u32)code[2] << 16) | ((u32)code[3] << 24);
+	}
+
+	// legacy headers without the DX10 extension, color is assumed to be srgb like decoded images
+	static std::optional<DdsFormat> ddsFormatFromFourCC(u32 four_cc)
+	{
+		switch (four_cc)
+		{
+		case fourCC("DXT1"): return DdsFormat{ vk::Format::eBc1RgbaSrgbBlock, 8, true };
+		case fourCC("DXT3"): return DdsFormat{ vk::Format::eBc2SrgbBlock, 16, true };
+		case fourCC("DXT5"): return DdsFormat{ vk::Format::eBc3SrgbBlock, 16, true };
+		case fourCC("ATI1"):
+		case fourCC("BC4U"): return DdsFormat{ vk::Format::eBc4UnormBlock, 8, true };
+		case fourCC("ATI2"):
+		case fourCC("BC5U"): return DdsFormat{ vk::Format::eBc5UnormBlock, 16, true };
+		default: return std::nullopt;
+		}
+	}
+
+	// decodes from the mapping, which saves reading the encoded file into a buffer first
+	static ImageLayout loadStb(std::span<const Byte> file)
+	{
+		ImageLayout layout;
 
 		int channels;
-		img_asset->m_Data = (void*)stbi_load(
-			path.C_STR(),
-			&img_asset->m_Width,
-			&img_asset->m_Height,
+		layout.data = (const void*)stbi_load_from_memory(
+			file.data(),
+			(int)file.size(),
+			&layout.width,
+			&layout.height,
 			&channels,
 			STBI_rgb_alpha
 		);
-		img_asset->m_Size = (u64)img_asset->m_Width * img_asset->m_Height * 4;
+		layout.level_sizes = { (u64)layout.width * layout.height * 4 };
+		layout.level_offsets = { 0 };
+
+		return layout;
+	}
+
+	static ImageLayout loadKtx2(const std::filesystem::path& path, std::span<const Byte> file)
+	{
+		static constexpr Byte k_Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		if (file.size() < 80 || memcmp(file.data(), k_Identifier, sizeof(k_Identifier)))
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Not a KTX2 file!", path.C_STR()));
+
+		ImageLayout layout;
+
+		u32 vk_format = readValue<u32>(file, 12);
+		layout.width = (int)readValue<u32>(file, 20);
+		layout.height = (int)std::max(readValue<u32>(file, 24), 1u);
+		u32 depth = readValue<u32>(file, 28);
+		u32 layer_count = readValue<u32>(file, 32);
+		u32 face_count = readValue<u32>(file, 36);
+		u32 level_count = std::max(readValue<u32>(file, 40), 1u);
+		u32 supercompression = readValue<u32>(file, 44);
+
+		if (!vk_format || supercompression)
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Basis Universal and supercompressed KTX2 files are not supported!", path.C_STR()));
+
+		if (depth > 1 || layer_count > 1 || face_count != 1)
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Only single layer 2D KTX2 files are supported!", path.C_STR()));
+
+		layout.format = (vk::Format)vk_format;
+		layout.data = file.data();
+
+		// the level index follows the header, 3 u64 per level: offset, length, uncompressed length,
+		// the levels themselves are stored smallest first
+		layout.level_sizes.resize(level_count);
+		layout.level_offsets.resize(level_count);
+		for (u32 i = 0; i < level_count; i++)
+		{
+			layout.level_offsets[i] = readValue<u64>(file, 80 + i * 24);
+			layout.level_sizes[i] = readValue<u64>(file, 80 + i * 24 + 8);
+
+			if (layout.level_offsets[i] + layout.level_sizes[i] > file.size())
+				throw std::runtime_error(NA_FORMAT("Failed to load {}: Level {} is out of bounds!", path.C_STR(), i));
+		}
+
+		return layout;
+	}
+
+	static ImageLayout loadDds(const std::filesystem::path& path, std::span<const Byte> file)
+	{
+		static constexpr u32 k_HeaderSize = 4 + 124; // magic + DDS_HEADER
+		static constexpr u32 k_Dx10HeaderSize = 20;
+		static constexpr u32 k_PixelFormatFourCC = 0x4;
+		static constexpr u32 k_PixelFormatRgb = 0x40;
+		static constexpr u32 k_Caps2Cubemap = 0x200;
+		static constexpr u32 k_Caps2Volume = 0x200000;
+
+		if (file.size() < k_HeaderSize || readValue<u32>(file, 0) != fourCC("DDS "))
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Not a DDS file!", path.C_STR()));
+
+		ImageLayout layout;
+
+		layout.height = (int)readValue<u32>(file, 4 + 8);
+		layout.width = (int)readValue<u32>(file, 4 + 12);
+		u32 level_count = std::max(readValue<u32>(file, 4 + 24), 1u);
+
+		u32 pixel_format_flags = readValue<u32>(file, 4 + 76);
+		u32 four_cc = readValue<u32>(file, 4 + 80);
+		u32 caps2 = readValue<u32>(file, 4 + 108);
+
+		if (caps2 & (k_Caps2Cubemap | k_Caps2Volume))
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Cubemap and volume DDS files are not supported!", path.C_STR()));
+
+		u64 data_offset = k_HeaderSize;
+		std::optional<DdsFormat> dds_format;
+
+		if ((pixel_format_flags & k_PixelFormatFourCC) && four_cc == fourCC("DX10"))
+		{
+			if (readValue<u32>(file, k_HeaderSize + 12) > 1)
+				throw std::runtime_error(NA_FORMAT("Failed to load {}: DDS texture arrays are not supported!", path.C_STR()));
+
+			dds_format = ddsFormatFromDxgi(readValue<u32>(file, k_HeaderSize));
+			data_offset += k_Dx10HeaderSize;
+		} else if (pixel_format_flags & k_PixelFormatFourCC)
+		{
+			dds_format = ddsFormatFromFourCC(four_cc);
+		} else if (
+			(pixel_format_flags & k_PixelFormatRgb) &&
+			readValue<u32>(file, 4 + 84) == 32 && // bit count
+			readValue<u32>(file, 4 + 88) == 0x000000FF // red mask, RGBA byte order
+		)
+		{
+			dds_format = DdsFormat{ vk::Format::eR8G8B8A8Srgb, 4, false };
+		}
+
+		if (!dds_format)
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Unsupported DDS pixel format!", path.C_STR()));
+
+		layout.format = dds_format->format;
+		layout.data = file.data();
+
+		// levels follow the header largest first, tightly packed
+		u64 offset = data_offset;
+		layout.level_sizes.resize(level_count);
+		layout.level_offsets.resize(level_count);
+		for (u32 i = 0; i < level_count; i++)
+		{
+			u64 level_width = std::max((u32)layout.width >> i, 1u);
+			u64 level_height = std::max((u32)layout.height >> i, 1u);
+
+			if (dds_format->compressed)
+				layout.level_sizes[i] = ((level_width + 3) / 4) * ((level_height + 3) / 4) * dds_format->block_bytes;
+			else
+				layout.level_sizes[i] = level_width * level_height * dds_format->block_bytes;
+
+			layout.level_offsets[i] = offset;
+			offset += layout.level_sizes[i];
+		}
+
+		if (offset > file.size())
+			throw std::runtime_error(NA_FORMAT("Failed to load {}: Unexpected end of file!", path.C_STR()));
+
+		return layout;
+	}
+
+	AssetHandle<ImageAsset> ImageAsset::_load(const std::filesystem::path& path, std::span<const Byte> file, std::shared_ptr<const void> source)
+	{
+		AssetHandle<ImageAsset> img_asset = std::make_shared<ImageAsset>();
+
+		ImageLayout layout;
+		if (path.extension() == ".ktx2")
+			layout = loadKtx2(path, file);
+		else if (path.extension() == ".dds")
+			layout = loadDds(path, file);
+		else
+			layout = loadStb(file);
+
+		// the payload of containers is used in place, decoded images own their pixels
+		if (layout.data == file.data())
+			img_asset->m_Source = std::move(source);
+
+		img_asset->m_Data = layout.data;
+		img_asset->m_Width = layout.width;
+		img_asset->m_Height = layout.height;
+		img_asset->m_Format = layout.format;
+		img_asset->m_LevelSizes = std::move(layout.level_sizes);
+		img_asset->m_LevelOffsets = std::move(layout.level_offsets);
+
+		for (u64 level_size : img_asset->m_LevelSizes)
+			img_asset->m_Size += level_size;
 
 		return img_asset;
 	}
+
+	AssetHandle<ImageAsset> ImageAsset::Load(const std::filesystem::path& path)
+	{
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+		return _load(path, file->bytes(), file);
+	}
+
+	AssetHandle<ImageAsset> ImageAsset::Load(const AssetBlob& blob)
+	{
+		return _load(blob.path, blob.bytes, blob.owner);
+	}
 } // namespace Na
@@ -0,0 +1,212 @@
+#include "Pch.hpp"
+#include "Natrium/Assets/ImageCompression.hpp"
+
+namespace Na {
+	// the 16 texels of a block, row major
+	using BlockTexels = std::array<std::array<u8, 4>, 16>;
+
+	static void readBlock(const u8* rgba, u32 width, u32 height, u32 block_x, u32 block_y, BlockTexels& texels)
+	{
+		for (u32 y = 0; y < 4; y++)
+		{
+			u32 src_y = std::min(block_y * 4 + y, height - 1);
+			for (u32 x = 0; x < 4; x++)
+			{
+				u32 src_x = std::min(block_x * 4 + x, width - 1);
+				memcpy(texels[y * 4 + x].data(), rgba + ((u64)src_y * width + src_x) * 4, 4);
+			}
+		}
+	}
+
+	static u16 packRgb565(const u8* color)
+	{
+		return (u16)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+	}
+
+	static std::array<i32, 3> unpackRgb565(u16 color)
+	{
+		i32 r = (color >> 11) & 31;
+		i32 g = (color >> 5) & 63;
+		i32 b = color & 31;
+		return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+	}
+
+	// 8 bytes, always in the four color mode, which BC3 requires
+	static void encodeColorBlock(const BlockTexels& texels, Byte* dst)
+	{
+		u8 min[3] = { 255, 255, 255 };
+		u8 max[3] = { 0, 0, 0 };
+		for (const auto& texel : texels)
+		{
+			for (u32 c = 0; c < 3; c++)
+			{
+				min[c] = std::min(min[c], texel[c]);
+				max[c] = std::max(max[c], texel[c]);
+			}
+		}
+
+		// pulling the endpoints in a little lowers the error of the interpolated colors
+		for (u32 c = 0; c < 3; c++)
+		{
+			u8 inset = (u8)((max[c] - min[c]) / 16);
+			min[c] += inset;
+			max[c] -= inset;
+		}
+
+		u16 color0 = packRgb565(max);
+		u16 color1 = packRgb565(min);
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		u32 indices = 0;
+		if (color0 != color1)
+		{
+			std::array<i32, 3> palette[4];
+			palette[0] = unpackRgb565(color0);
+			palette[1] = unpackRgb565(color1);
+			for (u32 c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (u32 i = 0; i < 16; i++)
+			{
+				u32 best_index = 0;
+				i32 best_error = std::numeric_limits<i32>::max();
+				for (u32 p = 0; p < 4; p++)
+				{
+					i32 error = 0;
+					for (u32 c = 0; c < 3; c++)
+						error += (texels[i][c] - palette[p][c]) * (texels[i][c] - palette[p][c]);
+
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = p;
+					}
+				}
+				indices |= best_index << (i * 2);
+			}
+		}
+		// equal endpoints select the three color mode, index 0 is still the endpoint there
+
+		memcpy(dst, &color0, sizeof(u16));
+		memcpy(dst + 2, &color1, sizeof(u16));
+		memcpy(dst + 4, &indices, sizeof(u32));
+	}
+
+	// 8 bytes, the eight value mode between the block's extremes
+	static void encodeAlphaBlock(const BlockTexels& texels, Byte* dst)
+	{
+		u8 alpha0 = 0, alpha1 = 255;
+		for (const auto& texel : texels)
+		{
+			alpha0 = std::max(alpha0, texel[3]);
+			alpha1 = std::min(alpha1, texel[3]);
+		}
+
+		u64 indices = 0;
+		if (alpha0 != alpha1)
+		{
+			i32 palette[8];
+			palette[0] = alpha0;
+			palette[1] = alpha1;
+			for (i32 p = 1; p < 7; p++)
+				palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+
+			for (u32 i = 0; i < 16; i++)
+			{
+				u64 best_index = 0;
+				i32 best_error = 256;
+				for (u32 p = 0; p < 8; p++)
+				{
+					i32 error = std::abs(texels[i][3] - palette[p]);
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = p;
+					}
+				}
+				indices |= best_index << (i * 3);
+			}
+		}
+
+		dst[0] = alpha0;
+		dst[1] = alpha1;
+		for (u32 i = 0; i < 6; i++)
+			dst[2 + i] = (Byte)(indices >> (i * 8));
+	}
+
+	vk::Format CompressedFormat(ImageCompression compression)
+	{
+		switch (compression)
+		{
+		case ImageCompression::BC1: return vk::Format::eBc1RgbaSrgbBlock;
+		case ImageCompression::BC3: return vk::Format::eBc3SrgbBlock;
+		default:                    return vk::Format::eR8G8B8A8Srgb;
+		}
+	}
+
+	u64 CompressedSize(ImageCompression compression, u32 width, u32 height)
+	{
+		u64 blocks = (u64)((width + 3) / 4) * ((height + 3) / 4);
+		switch (compression)
+		{
+		case ImageCompression::BC1: return blocks * 8;
+		case ImageCompression::BC3: return blocks * 16;
+		default:                    return (u64)width * height * 4;
+		}
+	}
+
+	void CompressImage(ImageCompression compression, const u8* rgba, u32 width, u32 height, void* dst)
+	{
+		if (compression == ImageCompression::None)
+		{
+			memcpy(dst, rgba, (u64)width * height * 4);
+			return;
+		}
+
+		u32 block_size = compression == ImageCompression::BC3 ? 16 : 8;
+		Byte* block = (Byte*)dst;
+
+		BlockTexels texels;
+		for (u32 block_y = 0; block_y < (height + 3) / 4; block_y++)
+		{
+			for (u32 block_x = 0; block_x < (width + 3) / 4; block_x++)
+			{
+				readBlock(rgba, width, height, block_x, block_y, texels);
+
+				// BC3 puts its alpha block ahead of the color block
+				if (compression == ImageCompression::BC3)
+					encodeAlphaBlock(texels, block);
+				encodeColorBlock(texels, block + block_size - 8);
+
+				block += block_size;
+			}
+		}
+	}
+
+	void DownsampleImage(const u8* rgba, u32 width, u32 height, u8* dst)
+	{
+		u32 dst_width = std::max(width / 2, 1u);
+		u32 dst_height = std::max(height / 2, 1u);
+
+		for (u32 y = 0; y < dst_height; y++)
+		{
+			// a side of 1 samples the same texel twice
+			const u8* row0 = rgba + (u64)std::min(y * 2, height - 1) * width * 4;
+			const u8* row1 = rgba + (u64)std::min(y * 2 + 1, height - 1) * width * 4;
+
+			for (u32 x = 0; x < dst_width; x++)
+			{
+				u32 x0 = std::min(x * 2, width - 1) * 4;
+				u32 x1 = std::min(x * 2 + 1, width - 1) * 4;
+
+				u8* texel = dst + ((u64)y * dst_width + x) * 4;
+				for (u32 c = 0; c < 4; c++)
+					texel[c] = (u8)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,623 @@
+#include "Pch.hpp"
+#include "Natrium/Assets/MeshOptimizer.hpp"
+
+namespace Na {
+	// Forsyth's tuning, the cache is larger than the hardware ones on purpose
+	static constexpr u32 k_ScoreCacheSize = 32;
+	static constexpr float k_CacheDecayPower = 1.5f;
+	static constexpr float k_LastTriangleScore = 0.75f;
+	static constexpr float k_ValenceBoostScale = 2.0f;
+	static constexpr float k_ValenceBoostPower = 0.5f;
+
+	// the cache simulated while forming overdraw clusters
+	static constexpr u32 k_ClusterCacheSize = 16;
+
+	static float vertexScore(i32 cache_position, u32 live_triangles)
+	{
+		if (!live_triangles)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cache_position >= 0)
+		{
+			// the vertices of the last triangle score the same no matter their order
+			if (cache_position < 3)
+				score = k_LastTriangleScore;
+			else
+				score = powf(1.0f - (float)(cache_position - 3) / (float)(k_ScoreCacheSize - 3), k_CacheDecayPower);
+		}
+
+		// vertices with few triangles left are finished first, so they leave the cache for good
+		score += k_ValenceBoostScale * powf((float)live_triangles, -k_ValenceBoostPower);
+		return score;
+	}
+
+	void OptimizeVertexCache(u32* indices, u64 index_count, u32 vertex_count)
+	{
+		NA_ASSERT(index_count % 3 == 0, "Failed to optimize vertex cache: The index count is not a multiple of 3!");
+
+		u64 triangle_count = index_count / 3;
+		if (triangle_count < 2)
+			return;
+
+		std::vector<u32> live_triangles(vertex_count, 0);
+		for (u64 i = 0; i < index_count; i++)
+		{
+			NA_ASSERT(indices[i] < vertex_count, "Failed to optimize vertex cache: Index {} is out of range!", i);
+			live_triangles[indices[i]]++;
+		}
+
+		// the triangles of every vertex, the live ones are kept at the front
+		std::vector<u64> adjacency_offsets(vertex_count + 1, 0);
+		for (u32 v = 0; v < vertex_count; v++)
+			adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+
+		std::vector<u32> adjacency(index_count);
+		{
+			std::vector<u64> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (u64 i = 0; i < index_count; i++)
+				adjacency[fill[indices[i]]++] = (u32)(i / 3);
+		}
+
+		std::vector<i32> cache_positions(vertex_count, -1);
+		std::vector<float> vertex_scores(vertex_count);
+		for (u32 v = 0; v < vertex_count; v++)
+			vertex_scores[v] = vertexScore(-1, live_triangles[v]);
+
+		auto triangle_score = [&](u64 triangle) -> float
+		{
+			const u32* tri = indices + triangle * 3;
+			return vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+		};
+
+		std::vector<u8> emitted(triangle_count, 0);
+		std::vector<u32> output(index_count);
+
+		u32 cache[k_ScoreCacheSize + 3];
+		u32 cache_size = 0;
+
+		i64 best_triangle = 0;
+		{
+			float best_score = -1.0f;
+			for (u64 t = 0; t < triangle_count; t++)
+			{
+				float score = triangle_score(t);
+				if (score > best_score)
+				{
+					best_score = score;
+					best_triangle = (i64)t;
+				}
+			}
+		}
+
+		u64 dead_end_cursor = 0;
+		for (u64 emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+		{
+			// nothing in the cache has triangles left, continue with the next one in file order
+			if (best_triangle < 0)
+			{
+				while (emitted[dead_end_cursor])
+					dead_end_cursor++;
+				best_triangle = (i64)dead_end_cursor;
+			}
+
+			u64 triangle = (u64)best_triangle;
+			const u32* tri = indices + triangle * 3;
+
+			emitted[triangle] = 1;
+			memcpy(output.data() + emitted_count * 3, tri, 3 * sizeof(u32));
+
+			// most recently used first, degenerate triangles repeat vertices
+			u32 new_cache[k_ScoreCacheSize + 3];
+			u32 new_cache_size = 0;
+			for (u32 k = 0; k < 3; k++)
+			{
+				if (std::find(new_cache, new_cache + new_cache_size, tri[k]) != new_cache + new_cache_size)
+					continue;
+				new_cache[new_cache_size++] = tri[k];
+
+				u32* triangles = adjacency.data() + adjacency_offsets[tri[k]];
+				u32& live = live_triangles[tri[k]];
+				for (u32 j = 0; j < live; j++)
+				{
+					if (triangles[j] != triangle)
+						continue;
+
+					triangles[j] = triangles[live - 1];
+					live--;
+					break;
+				}
+			}
+
+			for (u32 i = 0; i < cache_size; i++)
+			{
+				if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+					new_cache[new_cache_size++] = cache[i];
+			}
+
+			// vertices pushed out of the cache are rescored too
+			for (u32 i = 0; i < new_cache_size; i++)
+			{
+				u32 v = new_cache[i];
+				cache_positions[v] = i < k_ScoreCacheSize ? (i32)i : -1;
+				vertex_scores[v] = vertexScore(cache_positions[v], live_triangles[v]);
+			}
+
+			best_triangle = -1;
+			float best_score = -1.0f;
+			for (u32 i = 0; i < new_cache_size; i++)
+			{
+				u32 v = new_cache[i];
+				const u32* triangles = adjacency.data() + adjacency_offsets[v];
+
+				for (u32 j = 0; j < live_triangles[v]; j++)
+				{
+					// a degenerate triangle stays listed once more for its repeated vertex
+					if (emitted[triangles[j]])
+						continue;
+
+					float score = triangle_score(triangles[j]);
+					if (score > best_score)
+					{
+						best_score = score;
+						best_triangle = (i64)triangles[j];
+					}
+				}
+			}
+
+			cache_size = std::min(new_cache_size, k_ScoreCacheSize);
+			memcpy(cache, new_cache, cache_size * sizeof(u32));
+		}
+
+		memcpy(indices, output.data(), index_count * sizeof(u32));
+	}
+
+	// a FIFO cache, a vertex is cached while fewer than cache_size misses happened since it was loaded
+	class CacheSimulation {
+	public:
+		inline CacheSimulation(u32 vertex_count, u32 cache_size)
+		: m_LoadTimes(vertex_count, 0), m_Time(cache_size + 1), m_CacheSize(cache_size)
+		{}
+
+		inline u32 triangle_misses(const u32* tri)
+		{
+			u32 misses = 0;
+			for (u32 k = 0; k < 3; k++)
+			{
+				if (m_Time - m_LoadTimes[tri[k]] > m_CacheSize)
+				{
+					m_LoadTimes[tri[k]] = m_Time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		inline void flush(void) { m_Time += m_CacheSize + 1; }
+	private:
+		std::vector<u64> m_LoadTimes;
+		u64 m_Time;
+		u32 m_CacheSize;
+	};
+
+	float AverageCacheMissRatio(const u32* indices, u64 index_count, u32 vertex_count, u32 cache_size)
+	{
+		if (index_count < 3)
+			return 0.0f;
+
+		CacheSimulation cache(vertex_count, cache_size);
+
+		u64 misses = 0;
+		for (u64 i = 0; i + 2 < index_count; i += 3)
+			misses += cache.triangle_misses(indices + i);
+
+		return (float)misses / (float)(index_count / 3);
+	}
+
+	void OptimizeOverdraw(
+		u32* indices, u64 index_count,
+		const glm::vec3* positions, u64 position_stride, u32 vertex_count,
+		float threshold
+	)
+	{
+		NA_ASSERT(index_count % 3 == 0, "Failed to optimize overdraw: The index count is not a multiple of 3!");
+
+		u64 triangle_count = index_count / 3;
+		if (triangle_count < 2)
+			return;
+
+		auto position = [positions, position_stride](u32 vertex) -> const glm::vec3&
+		{
+			return *(const glm::vec3*)((const u8*)positions + vertex * position_stride);
+		};
+
+		CacheSimulation cache(vertex_count, k_ClusterCacheSize);
+
+		// hard boundaries, where the cache has nothing of the previous triangles left
+		std::vector<u64> hard_clusters;
+		for (u64 t = 0; t < triangle_count; t++)
+		{
+			if (cache.triangle_misses(indices + t * 3) == 3 || !t)
+				hard_clusters.push_back(t);
+		}
+		hard_clusters.push_back(triangle_count);
+
+		// soft boundaries, where a cluster can be cut off without hurting the cache more than threshold allows
+		std::vector<u64> clusters;
+		for (u64 c = 0; c + 1 < hard_clusters.size(); c++)
+		{
+			u64 begin = hard_clusters[c];
+			u64 end = hard_clusters[c + 1];
+
+			cache.flush();
+			u64 cluster_misses = 0;
+			for (u64 t = begin; t < end; t++)
+				cluster_misses += cache.triangle_misses(indices + t * 3);
+
+			float target = threshold * (float)cluster_misses / (float)(end - begin);
+
+			cache.flush();
+			clusters.push_back(begin);
+
+			u64 misses = 0;
+			u64 triangles = 0;
+			for (u64 t = begin; t < end; t++)
+			{
+				misses += cache.triangle_misses(indices + t * 3);
+				triangles++;
+
+				// short clusters would be accepted on their first cold triangles alone
+				if (t + 1 < end && triangles >= k_ClusterCacheSize && (float)misses <= target * (float)triangles)
+				{
+					clusters.push_back(t + 1);
+					cache.flush();
+					misses = 0;
+					triangles = 0;
+				}
+			}
+		}
+		clusters.push_back(triangle_count);
+
+		glm::vec3 mesh_center(0.0f);
+		float mesh_area = 0.0f;
+
+		struct Cluster {
+			u64 begin, end;
+			glm::vec3 center; // area weighted
+			glm::vec3 normal; // scaled by the area
+			float area;
+			float sort_key;
+		};
+		std::vector<Cluster> sorted(clusters.size() - 1);
+
+		for (u64 c = 0; c < sorted.size(); c++)
+		{
+			Cluster& cluster = sorted[c];
+			cluster = Cluster{ clusters[c], clusters[c + 1], glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f };
+
+			for (u64 t = cluster.begin; t < cluster.end; t++)
+			{
+				const glm::vec3& p0 = position(indices[t * 3 + 0]);
+				const glm::vec3& p1 = position(indices[t * 3 + 1]);
+				const glm::vec3& p2 = position(indices[t * 3 + 2]);
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+
+				cluster.center += (p0 + p1 + p2) * (area / 3.0f);
+				cluster.normal += normal;
+				cluster.area += area;
+			}
+
+			mesh_center += cluster.center;
+			mesh_area += cluster.area;
+
+			if (cluster.area > 0.0f)
+				cluster.center /= cluster.area;
+		}
+
+		if (mesh_area > 0.0f)
+			mesh_center /= mesh_area;
+
+		for (Cluster& cluster : sorted)
+			cluster.sort_key = glm::dot(cluster.center - mesh_center, cluster.normal);
+
+		std::stable_sort(
+			sorted.begin(), sorted.end(),
+			[](const Cluster& a, const Cluster& b) -> bool { return a.sort_key > b.sort_key; }
+		);
+
+		std::vector<u32> output;
+		output.reserve(index_count);
+		for (const Cluster& cluster : sorted)
+			output.insert(output.end(), indices + cluster.begin * 3, indices + cluster.end * 3);
+
+		memcpy(indices, output.data(), index_count * sizeof(u32));
+	}
+
+	u32 OptimizeVertexFetch(void* vertices, u64 vertex_size, u32 vertex_count, u32* indices, u64 index_count)
+	{
+		std::vector<u32> remap(vertex_count, UINT32_MAX);
+
+		u32 used_count = 0;
+		for (u64 i = 0; i < index_count; i++)
+		{
+			NA_ASSERT(indices[i] < vertex_count, "Failed to optimize vertex fetch: Index {} is out of range!", i);
+
+			u32& new_index = remap[indices[i]];
+			if (new_index == UINT32_MAX)
+				new_index = used_count++;
+
+			indices[i] = new_index;
+		}
+
+		std::vector<u8> reordered(used_count * vertex_size);
+		for (u32 v = 0; v < vertex_count; v++)
+		{
+			if (remap[v] != UINT32_MAX)
+				memcpy(reordered.data() + remap[v] * vertex_size, (const u8*)vertices + v * vertex_size, vertex_size);
+		}
+
+		memcpy(vertices, reordered.data(), reordered.size());
+		return used_count;
+	}
+	// the summed squared distances to the planes of the triangles around a vertex, weighted by their area
+	struct Quadric {
+		float a2 = 0.0f, b2 = 0.0f, c2 = 0.0f, d2 = 0.0f;
+		float ab = 0.0f, ac = 0.0f, ad = 0.0f;
+		float bc = 0.0f, bd = 0.0f, cd = 0.0f;
+		float weight = 0.0f;
+
+		inline void add_plane(const glm::vec3& normal, float distance, float plane_weight)
+		{
+			a2 += normal.x * normal.x * plane_weight;
+			b2 += normal.y * normal.y * plane_weight;
+			c2 += normal.z * normal.z * plane_weight;
+			d2 += distance * distance * plane_weight;
+			ab += normal.x * normal.y * plane_weight;
+			ac += normal.x * normal.z * plane_weight;
+			ad += normal.x * distance * plane_weight;
+			bc += normal.y * normal.z * plane_weight;
+			bd += normal.y * distance * plane_weight;
+			cd += normal.z * distance * plane_weight;
+			weight += plane_weight;
+		}
+
+		inline Quadric& operator+=(const Quadric& other)
+		{
+			a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+			ab += other.ab; ac += other.ac; ad += other.ad;
+			bc += other.bc; bd += other.bd; cd += other.cd;
+			weight += other.weight;
+			return *this;
+		}
+
+		// mean squared distance
+		[[nodiscard]] inline float error(const glm::vec3& p) const
+		{
+			float sum =
+				a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z +
+				2.0f * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z) +
+				2.0f * (ad * p.x + bd * p.y + cd * p.z) +
+				d2;
+
+			return weight > 0.0f ? std::abs(sum) / weight : 0.0f;
+		}
+	};
+
+	u64 SimplifyMesh(
+		u32* destination,
+		const u32* indices, u64 index_count,
+		const glm::vec3* positions, u64 position_stride, u32 vertex_count,
+		u64 target_index_count, float target_error,
+		float* result_error
+	)
+	{
+		NA_ASSERT(index_count % 3 == 0, "Failed to simplify mesh: The index count is not a multiple of 3!");
+
+		if (result_error)
+			*result_error = 0.0f;
+
+		memcpy(destination, indices, index_count * sizeof(u32));
+		if (index_count <= target_index_count)
+			return index_count;
+
+		// scaled into a unit box, so target_error means the same for every mesh
+		glm::vec3 min_position(std::numeric_limits<float>::max());
+		glm::vec3 max_position(std::numeric_limits<float>::lowest());
+		for (u32 v = 0; v < vertex_count; v++)
+		{
+			const glm::vec3& position = *(const glm::vec3*)((const u8*)positions + v * position_stride);
+			min_position = glm::min(min_position, position);
+			max_position = glm::max(max_position, position);
+		}
+
+		glm::vec3 extents = max_position - min_position;
+		float extent = std::max(extents.x, std::max(extents.y, extents.z));
+		float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+		std::vector<glm::vec3> local_positions(vertex_count);
+		for (u32 v = 0; v < vertex_count; v++)
+			local_positions[v] = (*(const glm::vec3*)((const u8*)positions + v * position_stride) - min_position) * scale;
+
+		std::vector<Quadric> quadrics(vertex_count);
+		for (u64 i = 0; i < index_count; i += 3)
+		{
+			const glm::vec3& p0 = local_positions[indices[i + 0]];
+			const glm::vec3& p1 = local_positions[indices[i + 1]];
+			const glm::vec3& p2 = local_positions[indices[i + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			if (area <= 0.0f)
+				continue;
+
+			normal /= area;
+			float distance = -glm::dot(normal, p0);
+
+			for (u32 k = 0; k < 3; k++)
+				quadrics[indices[i + k]].add_plane(normal, distance, area);
+		}
+
+		// an edge without its reverse is open, either the border of the mesh or an attribute seam
+		std::vector<u8> locked(vertex_count, 0);
+		{
+			std::vector<u64> edges(index_count);
+			for (u64 i = 0; i < index_count; i += 3)
+			{
+				for (u32 k = 0; k < 3; k++)
+					edges[i + k] = (u64)indices[i + k] << 32 | indices[i + (k + 1) % 3];
+			}
+			std::sort(edges.begin(), edges.end());
+
+			for (u64 edge : edges)
+			{
+				u64 reverse = edge << 32 | edge >> 32;
+				if (!std::binary_search(edges.begin(), edges.end(), reverse))
+				{
+					locked[edge >> 32] = 1;
+					locked[edge & UINT32_MAX] = 1;
+				}
+			}
+		}
+
+		struct Collapse {
+			u32 from, to;
+			float error;
+		};
+
+		float max_error = target_error * target_error;
+		float largest_error = 0.0f;
+
+		u64 result_count = index_count;
+		std::vector<Collapse> collapses;
+		std::vector<u32> remap(vertex_count);
+		std::vector<u8> touched(vertex_count);
+		std::vector<u64> adjacency_offsets(vertex_count + 1);
+		std::vector<u32> adjacency;
+
+		// every pass collapses edges whose neighbourhoods do not overlap, cheapest first
+		while (result_count > target_index_count)
+		{
+			std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+			for (u64 i = 0; i < result_count; i++)
+				adjacency_offsets[destination[i] + 1]++;
+			for (u32 v = 0; v < vertex_count; v++)
+				adjacency_offsets[v + 1] += adjacency_offsets[v];
+
+			adjacency.resize(result_count);
+			{
+				std::vector<u64> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+				for (u64 i = 0; i < result_count; i++)
+					adjacency[fill[destination[i]]++] = (u32)(i / 3);
+			}
+
+			collapses.clear();
+			for (u64 i = 0; i < result_count; i++)
+			{
+				u32 a = destination[i];
+				u32 b = destination[i - i % 3 + (i + 1) % 3];
+
+				// interior edges are seen from both of their triangles
+				if (a > b || (locked[a] && locked[b]))
+					continue;
+
+				Quadric quadric = quadrics[a];
+				quadric += quadrics[b];
+
+				float a_to_b = locked[a] ? std::numeric_limits<float>::max() : quadric.error(local_positions[b]);
+				float b_to_a = locked[b] ? std::numeric_limits<float>::max() : quadric.error(local_positions[a]);
+
+				if (a_to_b <= b_to_a)
+					collapses.push_back(Collapse{ a, b, a_to_b });
+				else
+					collapses.push_back(Collapse{ b, a, b_to_a });
+			}
+
+			std::sort(
+				collapses.begin(), collapses.end(),
+				[](const Collapse& a, const Collapse& b) -> bool { return a.error < b.error; }
+			);
+
+			for (u32 v = 0; v < vertex_count; v++)
+				remap[v] = v;
+			std::fill(touched.begin(), touched.end(), 0);
+
+			// a collapse removes about two triangles
+			u64 removable = (result_count - target_index_count) / 6 + 1;
+			u64 collapse_count = 0;
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.error > max_error || collapse_count >= removable)
+					break;
+
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				const u32* triangles = adjacency.data() + adjacency_offsets[collapse.from];
+				u64 triangle_count = adjacency_offsets[collapse.from + 1] - adjacency_offsets[collapse.from];
+
+				// moving from onto to must not flip any triangle that survives
+				bool flips = false;
+				for (u64 j = 0; j < triangle_count && !flips; j++)
+				{
+					const u32* tri = destination + triangles[j] * 3;
+					if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+						continue;
+
+					glm::vec3 p[3];
+					glm::vec3 moved[3];
+					for (u32 k = 0; k < 3; k++)
+					{
+						p[k] = local_positions[tri[k]];
+						moved[k] = tri[k] == collapse.from ? local_positions[collapse.to] : p[k];
+					}
+
+					glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+					glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+					flips = glm::dot(before, after) <= 0.0f;
+				}
+
+				if (flips)
+					continue;
+
+				// the whole neighbourhood, so no other collapse of this pass changes a triangle checked above
+				for (u64 j = 0; j < triangle_count; j++)
+				{
+					const u32* tri = destination + triangles[j] * 3;
+					touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				largest_error = std::max(largest_error, collapse.error);
+				collapse_count++;
+			}
+
+			if (!collapse_count)
+				break;
+
+			u64 write = 0;
+			for (u64 i = 0; i < result_count; i += 3)
+			{
+				u32 v0 = remap[destination[i + 0]];
+				u32 v1 = remap[destination[i + 1]];
+				u32 v2 = remap[destination[i + 2]];
+
+				if (v0 == v1 || v1 == v2 || v0 == v2)
+					continue;
+
+				destination[write++] = v0;
+				destination[write++] = v1;
+				destination[write++] = v2;
+			}
+			result_count = write;
+		}
+
+		if (result_error)
+			*result_error = sqrtf(largest_error) * (extent > 0.0f ? extent : 1.0f);
+
+		return result_count;
+	}
+} // namespace Na
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "Pch.hpp"
 #include "Natrium/Assets/ModelAsset.hpp"
 
+#include "Natrium/Core/JobSystem.hpp"
+#include "Natrium/Core/MappedFile.hpp"
+#include "Natrium/Graphics/Buffers/IndexBuffer.hpp"
+
 #include <tiny_obj_loader/tiny_obj_loader.h>
 
 #if defined(NA_PLATFORM_WINDOWS)
@@ -12,6 +16,38 @@
 #endif
 
 namespace Na {
+    // splits the work into shards on the job system, the calling thread runs one of them
+    template<typename t_Fn>
+    static void parallelFor(u32 shard_count, const t_Fn& fn)
+    {
+        JobSystem& job_system = JobSystem::Get();
+
+        JobCounter counter;
+        for (u32 i = 1; i < shard_count; i++)
+            job_system.run([&fn, i](void) { fn(i); }, &counter);
+
+        fn(0);
+
+        job_system.wait(counter);
+    }
+
+    // one shard per thread that can run them, a calling worker already is one of the workers
+    static inline u32 shardCount(void)
+    {
+        return std::max<u32>(JobSystem::Get().worker_count() + (JobSystem::IsWorkerThread() ? 0 : 1), 1);
+    }
+
+    static inline u64 nextPowerOfTwo(u64 value)
+    {
+        u64 power = 1;
+        while (power < value)
+            power <<= 1;
+        return power;
+    }
+
+    // meshes below this many indices are not worth starting threads for
+    static constexpr u64 k_ParallelImportThreshold = 1ull << 16;
+
     static void loadObj(const std::filesystem::path& path, Na::ArrayList<Vertex>& vertices, Na::ArrayList<u32>& indices)
     {
         tinyobj::attrib_t attrib;
@@ -22,51 +58,437 @@ namespace Na {
         bool result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.C_STR());
         NA_ASSERT(result, "Failed to load {}: {} {}", path.C_STR(), warn, err);
 
-        u64 index_count = 0;
-        for (const auto& shape : shapes)
-            index_count += shape.mesh.indices.size();
+        std::vector<u64> shape_offsets(shapes.size() + 1, 0);
+        for (u64 i = 0; i < shapes.size(); i++)
+            shape_offsets[i + 1] = shape_offsets[i] + shapes[i].mesh.indices.size();
+
+        u64 index_count = shape_offsets.back();
 
-        indices.reallocate(index_count);
+        u32 thread_count = 1;
+        if (index_count >= k_ParallelImportThreshold)
+            thread_count = shardCount();
 
-        std::unordered_map<Vertex, u32> unique_vertices{};
+        // every corner of every face, shapes are spread over the threads
+        std::vector<Vertex> corners(index_count);
+        std::vector<u64> hashes(index_count);
 
-        for (const auto& shape : shapes)
+        std::atomic<u64> next_shape = 0;
+        parallelFor(thread_count, [&](u32)
         {
-            for (const auto& index : shape.mesh.indices)
+            for (u64 shape = next_shape++; shape < shapes.size(); shape = next_shape++)
             {
-                Vertex vertex{
-                    .position = {
+                const std::vector<tinyobj::index_t>& shape_indices = shapes[shape].mesh.indices;
+                for (u64 i = 0; i < shape_indices.size(); i++)
+                {
+                    const tinyobj::index_t& index = shape_indices[i];
+                    Vertex& vertex = corners[shape_offsets[shape] + i];
+
+                    vertex.position = {
                         attrib.vertices[3 * index.vertex_index + 0],
                         attrib.vertices[3 * index.vertex_index + 1],
                         attrib.vertices[3 * index.vertex_index + 2]
-                    },
-                    .uv_coord = {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                    };
+
+                    if (index.texcoord_index >= 0)
+                    {
+                        vertex.uv_coord = {
+                            attrib.texcoords[2 * index.texcoord_index + 0],
+                            1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                        };
+                    } else
+                    {
+                        vertex.uv_coord = { 0.0f, 0.0f };
                     }
-                };
 
-                if (unique_vertices.count(vertex) == 0)
+                    hashes[shape_offsets[shape] + i] = HashVertex(vertex);
+                }
+            }
+        });
+
+        // each thread deduplicates the corners whose hash falls into its partition, so equal
+        // vertices always meet in the same table, in order of their first occurrence
+        static constexpr u32 k_EmptySlot = k_U32Max;
+
+        std::vector<std::vector<Vertex>> partition_vertices(thread_count);
+        std::vector<u32> local_indices(index_count);
+
+        auto partitionOf = [thread_count](u64 hash) -> u32 { return (u32)((hash >> 32) % thread_count); };
+
+        parallelFor(thread_count, [&](u32 partition)
+        {
+            u64 count = 0;
+            for (u64 hash : hashes)
+                count += partitionOf(hash) == partition;
+
+            // open addressing with linear probing, at most half full
+            u64 mask = nextPowerOfTwo(std::max<u64>(count * 2, 16)) - 1;
+            std::vector<u32> slots(mask + 1, k_EmptySlot);
+
+            std::vector<Vertex>& unique = partition_vertices[partition];
+            unique.reserve(count);
+
+            for (u64 i = 0; i < index_count; i++)
+            {
+                if (partitionOf(hashes[i]) != partition)
+                    continue;
+
+                // bytewise, so -0.0 and NaN behave like any other value
+                u64 slot = hashes[i] & mask;
+                while (slots[slot] != k_EmptySlot && memcmp(&unique[slots[slot]], &corners[i], sizeof(Vertex)))
+                    slot = (slot + 1) & mask;
+
+                if (slots[slot] == k_EmptySlot)
                 {
-                    unique_vertices[vertex] = (u32)(vertices.size());
-                    vertices.emplace(vertex);
+                    slots[slot] = (u32)unique.size();
+                    unique.push_back(corners[i]);
                 }
 
-                indices.emplace(unique_vertices[vertex]);
+                local_indices[i] = slots[slot];
             }
+        });
+
+        std::vector<u32> partition_offsets(thread_count + 1, 0);
+        for (u32 i = 0; i < thread_count; i++)
+            partition_offsets[i + 1] = partition_offsets[i] + (u32)partition_vertices[i].size();
+
+        vertices.clear();
+        vertices.reallocate(partition_offsets.back());
+        for (u32 i = 0; i < thread_count; i++)
+            vertices.append_range(partition_vertices[i].data(), partition_vertices[i].size());
+
+        indices.clear();
+        indices.resize_uninitialized(index_count);
+        parallelFor(thread_count, [&](u32 thread)
+        {
+            u64 begin = index_count * thread / thread_count;
+            u64 end = index_count * (thread + 1) / thread_count;
+            for (u64 i = begin; i < end; i++)
+                indices[i] = partition_offsets[partitionOf(hashes[i])] + local_indices[i];
+        });
+    }
+
+    struct MeshHeader {
+        char magic[4];
+        u32 version;
+        u32 vertex_size; // guards against a changed Vertex layout
+        u32 index_size;
+        u64 vertex_count;
+        u64 index_count;
+        u64 lod_count; // MeshLods follow the indices
+        u64 quantized_vertex_count; // QuantizedVertices follow the MeshLods, 0 or vertex_count
+        float quantization_offset[3];
+        float quantization_scale[3];
+    };
+
+    void ModelAsset::_load_mesh(const std::filesystem::path& path)
+    {
+        MappedFile file(path);
+
+        MeshHeader header;
+        if (file.size() < sizeof(header))
+            throw std::runtime_error(NA_FORMAT("Failed to load {}: Not a mesh file!", path.C_STR()));
+        memcpy(&header, file.data(), sizeof(header));
+
+        if (memcmp(header.magic, "NAMS", 4))
+            throw std::runtime_error(NA_FORMAT("Failed to load {}: Not a mesh file!", path.C_STR()));
+
+        if (header.version != ModelAsset::k_CacheVersion || header.vertex_size != sizeof(Vertex) || (header.index_size != sizeof(u32) && header.index_size != sizeof(u16)))
+            throw std::runtime_error(NA_FORMAT("Failed to load {}: Written by an incompatible version!", path.C_STR()));
+
+        u64 vertex_bytes = header.vertex_count * sizeof(Vertex);
+        u64 index_bytes = header.index_count * header.index_size;
+        u64 lod_bytes = header.lod_count * sizeof(MeshLod);
+        u64 quantized_bytes = header.quantized_vertex_count * sizeof(QuantizedVertex);
+        if (sizeof(header) + vertex_bytes + index_bytes + lod_bytes + quantized_bytes > file.size())
+            throw std::runtime_error(NA_FORMAT("Failed to load {}: Unexpected end of file!", path.C_STR()));
+
+        if (header.quantized_vertex_count && header.quantized_vertex_count != header.vertex_count)
+            throw std::runtime_error(NA_FORMAT("Failed to load {}: Quantized vertices do not match the vertices!", path.C_STR()));
+
+        m_Vertices = Na::ArrayList<Vertex>(header.vertex_count, header.vertex_count);
+        memcpy(m_Vertices.ptr(), file.data() + sizeof(header), vertex_bytes);
+
+        m_Indices = Na::ArrayList<u32>(header.index_count, header.index_count);
+        const u8* index_data = file.data() + sizeof(header) + vertex_bytes;
+
+        if (header.index_size == sizeof(u32))
+        {
+            memcpy(m_Indices.ptr(), index_data, index_bytes);
+            m_IndexType = vk::IndexType::eUint32;
+        } else
+        {
+            // widened back, only the IndexBuffer keeps them 16 bit
+            for (u64 i = 0; i < header.index_count; i++)
+            {
+                u16 index;
+                memcpy(&index, index_data + i * sizeof(u16), sizeof(u16));
+                m_Indices[i] = index;
+            }
+            m_IndexType = vk::IndexType::eUint16;
         }
+
+        m_Lods.resize(header.lod_count);
+        memcpy(m_Lods.data(), index_data + index_bytes, lod_bytes);
+
+        for (const MeshLod& lod : m_Lods)
+        {
+            if ((u64)lod.first_index + lod.index_count > header.index_count)
+                throw std::runtime_error(NA_FORMAT("Failed to load {}: Level of detail out of range!", path.C_STR()));
+        }
+
+        m_QuantizedVertices = Na::ArrayList<QuantizedVertex>(header.quantized_vertex_count, header.quantized_vertex_count);
+        memcpy(m_QuantizedVertices.ptr(), index_data + index_bytes + lod_bytes, quantized_bytes);
+
+        m_QuantizationOffset = glm::vec3(header.quantization_offset[0], header.quantization_offset[1], header.quantization_offset[2]);
+        m_QuantizationScale = glm::vec3(header.quantization_scale[0], header.quantization_scale[1], header.quantization_scale[2]);
     }
 
-	AssetHandle<ModelAsset> ModelAsset::Load(const std::filesystem::path& path)
+	AssetHandle<ModelAsset> ModelAsset::Load(const std::filesystem::path& path, const MeshOptimizeSettings& settings)
 	{
         AssetHandle<ModelAsset> asset = std::make_shared<ModelAsset>();
 
         if (path.extension() == ".obj")
+        {
             loadObj(path, asset->m_Vertices, asset->m_Indices);
+            asset->optimize(settings);
+        }
+        else if (path.extension() == k_CacheExtension)
+            asset->_load_mesh(path);
         else
             throw std::runtime_error(NA_FORMAT("{} is an unknown or unsupported 3d model file format!", path.extension().C_STR()));
 
+        asset->_compute_bounds();
+
         return asset;
 	}
 
+	void ModelAsset::save(const std::filesystem::path& path) const
+	{
+		MeshHeader header{
+			.magic = { 'N', 'A', 'M', 'S' },
+			.version = k_CacheVersion,
+			.vertex_size = sizeof(Vertex),
+			.index_size = IndexSize(m_IndexType),
+			.vertex_count = m_Vertices.size(),
+			.index_count = m_Indices.size(),
+			.lod_count = m_Lods.size(),
+			.quantized_vertex_count = m_QuantizedVertices.size(),
+			.quantization_offset = { m_QuantizationOffset.x, m_QuantizationOffset.y, m_QuantizationOffset.z },
+			.quantization_scale = { m_QuantizationScale.x, m_QuantizationScale.y, m_QuantizationScale.z }
+		};
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+			throw std::runtime_error(NA_FORMAT("Failed to save {}: Could not open file!", path.C_STR()));
+
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)m_Vertices.ptr(), this->vertex_data_size());
+		if (m_IndexType == vk::IndexType::eUint32)
+		{
+			file.write((const char*)m_Indices.ptr(), this->index_data_size());
+		} else
+		{
+			Na::ArrayList<u16> compact(m_Indices.size(), m_Indices.size());
+			for (u64 i = 0; i < m_Indices.size(); i++)
+				compact[i] = (u16)m_Indices[i];
+
+			file.write((const char*)compact.ptr(), compact.size() * sizeof(u16));
+		}
+
+		file.write((const char*)m_Lods.data(), m_Lods.size() * sizeof(MeshLod));
+		file.write((const char*)m_QuantizedVertices.ptr(), this->quantized_vertex_data_size());
+
+		file.close();
+		if (!file)
+			throw std::runtime_error(NA_FORMAT("Failed to save {}: Could not write file!", path.C_STR()));
+	}
+
+	void ModelAsset::optimize(const MeshOptimizeSettings& settings)
+	{
+		if (m_Indices.empty())
+			return;
+
+		if (m_Lods.empty() && settings.lod_count > 1)
+			this->_generate_lods(settings);
+
+		// each level on its own, they are drawn on their own
+		for (u32 level = 0; level < this->lod_count(); level++)
+		{
+			MeshLod lod = this->lod(level);
+			u32* lod_indices = m_Indices.ptr() + lod.first_index;
+
+			if (settings.vertex_cache)
+				OptimizeVertexCache(lod_indices, lod.index_count, this->vertex_count());
+
+			// the clusters come from the cache optimized order
+			if (settings.overdraw)
+			{
+				OptimizeOverdraw(
+					lod_indices, lod.index_count,
+					&m_Vertices[0].position, sizeof(Vertex), this->vertex_count(),
+					settings.overdraw_threshold
+				);
+			}
+		}
+
+		// every level only uses vertices of the full mesh, so its order decides the vertex order
+		if (settings.vertex_fetch)
+			m_Vertices.resize(OptimizeVertexFetch(m_Vertices.ptr(), sizeof(Vertex), this->vertex_count(), m_Indices.ptr(), m_Indices.size()));
+
+		// 0xFFFF stays unused, it restarts primitives if the pipeline enables primitive restart
+		if (settings.compact_indices && this->vertex_count() <= UINT16_MAX)
+			m_IndexType = vk::IndexType::eUint16;
+		else
+			m_IndexType = vk::IndexType::eUint32;
+
+		// after the vertices got their final order
+		if (settings.quantize)
+			this->quantize();
+	}
+
+	void ModelAsset::quantize(void)
+	{
+		if (m_Vertices.empty())
+			return;
+
+		glm::vec3 min_position = m_Vertices[0].position;
+		glm::vec3 max_position = m_Vertices[0].position;
+		for (const Vertex& vertex : m_Vertices)
+		{
+			min_position = glm::min(min_position, vertex.position);
+			max_position = glm::max(max_position, vertex.position);
+		}
+
+		// flat axes keep a scale of 1, their positions are all 0
+		glm::vec3 extent = max_position - min_position;
+		for (u32 axis = 0; axis < 3; axis++)
+		{
+			if (extent[axis] <= 0.0f)
+				extent[axis] = 1.0f;
+		}
+
+		m_QuantizationOffset = min_position;
+		m_QuantizationScale = extent;
+
+		// area weighted, the levels of detail would count triangles twice
+		std::vector<glm::vec3> normals(m_Vertices.size(), glm::vec3(0.0f));
+		MeshLod full = this->lod(0);
+		for (u64 i = full.first_index; i + 2 < (u64)full.first_index + full.index_count; i += 3)
+		{
+			const glm::vec3& p0 = m_Vertices[m_Indices[i + 0]].position;
+			const glm::vec3& p1 = m_Vertices[m_Indices[i + 1]].position;
+			const glm::vec3& p2 = m_Vertices[m_Indices[i + 2]].position;
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			for (u32 k = 0; k < 3; k++)
+				normals[m_Indices[i + k]] += normal;
+		}
+
+		m_QuantizedVertices = Na::ArrayList<QuantizedVertex>(m_Vertices.size(), m_Vertices.size());
+		for (u64 i = 0; i < m_Vertices.size(); i++)
+		{
+			QuantizedVertex& quantized = m_QuantizedVertices[i];
+
+			glm::vec3 position = glm::clamp((m_Vertices[i].position - min_position) / extent, 0.0f, 1.0f);
+			u32 xy = glm::packUnorm2x16(glm::vec2(position.x, position.y));
+			u32 zw = glm::packUnorm2x16(glm::vec2(position.z, 1.0f)); // w of 1, so the dequantization matrix keeps its translation
+			memcpy(quantized.position, &xy, sizeof(xy));
+			memcpy(quantized.position + 2, &zw, sizeof(zw));
+
+			u32 uv = glm::packHalf2x16(m_Vertices[i].uv_coord);
+			memcpy(quantized.uv_coord, &uv, sizeof(uv));
+
+			float length = glm::length(normals[i]);
+			glm::vec3 normal = length > 0.0f ? normals[i] / length : glm::vec3(0.0f, 0.0f, 1.0f);
+			u32 packed_normal = glm::packSnorm4x8(glm::vec4(normal, 0.0f));
+			memcpy(quantized.normal, &packed_normal, sizeof(packed_normal));
+		}
+	}
+
+	void ModelAsset::_compute_bounds(void)
+	{
+		if (m_Vertices.empty())
+		{
+			m_Bounds = {};
+			m_BoundingSphere = {};
+			return;
+		}
+
+		m_Bounds = BoundingBox{ m_Vertices[0].position, m_Vertices[0].position };
+		for (const Vertex& vertex : m_Vertices)
+		{
+			m_Bounds.min = glm::min(m_Bounds.min, vertex.position);
+			m_Bounds.max = glm::max(m_Bounds.max, vertex.position);
+		}
+
+		// tighter than half the diagonal for anything but boxes
+		glm::vec3 center = m_Bounds.center();
+		float radius_squared = 0.0f;
+		for (const Vertex& vertex : m_Vertices)
+		{
+			glm::vec3 offset = vertex.position - center;
+			radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+		}
+
+		m_BoundingSphere = BoundingSphere{ center, sqrtf(radius_squared) };
+	}
+
+	u32 ModelAsset::lod_for_screen_error(float distance, float projection_scale, float max_pixel_error) const
+	{
+		distance = std::max(distance, 1e-4f);
+
+		u32 level = 0;
+		while (level + 1 < this->lod_count() && this->lod(level + 1).error * projection_scale / distance <= max_pixel_error)
+			level++;
+
+		return level;
+	}
+
+	u32 ModelAsset::lod_for_distance(float distance, std::span<const float> thresholds) const
+	{
+		u32 level = 0;
+		while (level < thresholds.size() && distance >= thresholds[level])
+			level++;
+
+		return std::min(level, this->lod_count() - 1);
+	}
+
+	void ModelAsset::_generate_lods(const MeshOptimizeSettings& settings)
+	{
+		u32 full_count = this->total_index_count();
+		m_Lods.push_back(MeshLod{ 0, full_count, 0.0f });
+
+		std::vector<u32> lod_indices(full_count);
+		u64 previous_count = full_count;
+
+		for (u32 level = 1; level < settings.lod_count; level++)
+		{
+			u64 target_count = (u64)((double)previous_count * settings.lod_reduction) / 3 * 3;
+
+			// always from the full mesh, so the errors do not add up
+			float error = 0.0f;
+			u64 lod_count = SimplifyMesh(
+				lod_indices.data(),
+				m_Indices.ptr(), full_count,
+				&m_Vertices[0].position, sizeof(Vertex), this->vertex_count(),
+				target_count, settings.lod_max_error,
+				&error
+			);
+
+			// a level barely smaller than the previous one is not worth its indices
+			if (!lod_count || (double)lod_count > (double)previous_count * 0.9)
+				break;
+
+			u32 first_index = this->total_index_count();
+			m_Indices.reallocate(first_index + lod_count, first_index + lod_count);
+			memcpy(m_Indices.ptr() + first_index, lod_indices.data(), lod_count * sizeof(u32));
+
+			m_Lods.push_back(MeshLod{ first_index, (u32)lod_count, error });
+			previous_count = lod_count;
+		}
+
+		if (m_Lods.size() == 1)
+			m_Lods.clear();
+	}
+
 } // namespace Na
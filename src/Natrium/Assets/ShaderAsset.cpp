@@ -2,6 +2,7 @@
 #include "Natrium/Assets/ShaderAsset.hpp"
 
 #include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/MappedFile.hpp"
 #include "Natrium/Graphics/VkContext.hpp"
 
 #include <shaderc/shaderc.hpp>
@@ -21,22 +22,97 @@ namespace Na {
 		NA_ASSERT(file, "Failed to open file {}", path.C_STR());
 
 		u64 size = file.tellg();
-		ArrayList<Byte> file_data(size + size % 4, size);
+
+		// read straight into the words, zeroed so a truncated last word is padded
+		ArrayVector<u32> spv((size + sizeof(u32) - 1) / sizeof(u32));
 
 		file.seekg(0);
-		file.read((char*)file_data.ptr(), size);
+		file.read((char*)spv.ptr(), size);
 		file.close();
 
-		while (file_data.size() % 4)
-			file_data.emplace(0);
-
-		ArrayVector<u32> spv((u32*)file_data.ptr(), file_data.size() / sizeof(u32));
-		memset(&file_data, 0, sizeof(ArrayList<Byte>));
 		return spv;
 	}
 
+	namespace {
+		class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface {
+		public:
+			ShaderIncluder(const ShaderCompileOptions& options)
+			: m_IncludeDirs(options.include_dirs), m_Dependencies(options.dependencies)
+			{}
+
+			shaderc_include_result* GetInclude(
+				const char* requested_source,
+				shaderc_include_type type,
+				const char* requesting_source,
+				size_t include_depth
+			) override
+			{
+				Include* include = new Include;
+
+				std::filesystem::path path = this->_resolve(requested_source, type, requesting_source);
+				if (path.empty())
+				{
+					// an empty source name reports the content as the error
+					include->content = NA_FORMAT("Failed to resolve include {}", requested_source);
+				} else
+				{
+					std::ifstream file(path, std::ios::binary);
+					include->name = path.string();
+					include->content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+					if (m_Dependencies)
+						m_Dependencies->push_back(path);
+				}
+
+				include->result.source_name = include->name.data();
+				include->result.source_name_length = include->name.size();
+				include->result.content = include->content.data();
+				include->result.content_length = include->content.size();
+				include->result.user_data = include;
+
+				return &include->result;
+			}
+
+			void ReleaseInclude(shaderc_include_result* data) override
+			{
+				delete (Include*)data->user_data;
+			}
+		private:
+			struct Include {
+				std::string name;
+				std::string content;
+				shaderc_include_result result{};
+			};
+
+			std::filesystem::path _resolve(const char* requested_source, shaderc_include_type type, const char* requesting_source) const
+			{
+				std::error_code error;
+
+				if (type == shaderc_include_type_relative)
+				{
+					std::filesystem::path path = std::filesystem::path(requesting_source).parent_path() / requested_source;
+					if (std::filesystem::is_regular_file(path, error))
+						return std::filesystem::weakly_canonical(path, error);
+				}
+
+				for (const std::filesystem::path& include_dir : m_IncludeDirs)
+				{
+					std::filesystem::path path = include_dir / requested_source;
+					if (std::filesystem::is_regular_file(path, error))
+						return std::filesystem::weakly_canonical(path, error);
+				}
+
+				return {};
+			}
+		private:
+			const std::vector<std::filesystem::path>& m_IncludeDirs;
+			std::vector<std::filesystem::path>* m_Dependencies;
+		};
+	} // namespace
+
 	ShaderString::ShaderString(const std::filesystem::path& path)
-	: m_Name(path.filename().string())
+	: m_Name(path.filename().string()),
+	m_Path(path)
 	{
 		std::ifstream shader_file(path, std::ios::ate | std::ios::binary);
 		NA_ASSERT(shader_file, "Failed to open file {}", path.C_STR());
@@ -48,20 +124,81 @@ namespace Na {
 		shader_file.close();
 	}
 
-	ArrayVector<u32> ShaderString::compile(const std::string_view& entry_point) const
+	ShaderPermutation::ShaderPermutation(const std::initializer_list<ShaderDefine>& defines)
+	{
+		for (const ShaderDefine& define : defines)
+			this->define(define.name, define.value);
+	}
+
+	ShaderPermutation& ShaderPermutation::define(const std::string_view& name, const std::string_view& value)
+	{
+		auto it = std::lower_bound(m_Defines.begin(), m_Defines.end(), name, [](const ShaderDefine& define, const std::string_view& name) { return define.name < name; });
+		if (it != m_Defines.end() && it->name == name)
+			it->value = value;
+		else
+			m_Defines.insert(it, ShaderDefine{ std::string(name), std::string(value) });
+
+		return *this;
+	}
+
+	ShaderPermutation& ShaderPermutation::undefine(const std::string_view& name)
 	{
-		shaderc::Compiler compiler;
+		auto it = std::lower_bound(m_Defines.begin(), m_Defines.end(), name, [](const ShaderDefine& define, const std::string_view& name) { return define.name < name; });
+		if (it != m_Defines.end() && it->name == name)
+			m_Defines.erase(it);
+
+		return *this;
+	}
+
+	u64 ShaderPermutation::key(void) const
+	{
+		if (m_Defines.empty())
+			return 0;
+
+		u64 hash = 0xCBF29CE484222325ull;
+		auto hashString = [&hash](const std::string& str)
+		{
+			// the terminator separates name and value, so "AB" = "C" differs from "A" = "BC"
+			for (u64 i = 0; i <= str.size(); i++)
+			{
+				hash ^= (u8)str.c_str()[i];
+				hash *= 0x100000001B3ull;
+			}
+		};
+
+		for (const ShaderDefine& define : m_Defines)
+		{
+			hashString(define.name);
+			hashString(define.value);
+		}
+
+		return hash;
+	}
+
+	ArrayVector<u32> ShaderString::compile(const ShaderCompileOptions& compile_options) const
+	{
+		// compilation through one compiler is thread safe
+		static shaderc::Compiler x_Compiler;
 		shaderc::CompileOptions options;
 
-		if (k_BuildConfig != BuildConfig::Debug)
+		if (compile_options.optimize)
 			options.SetOptimizationLevel(shaderc_optimization_level_performance);
 
-		shaderc::SpvCompilationResult spv = compiler.CompileGlslToSpv(
+		options.SetIncluder(std::make_unique<ShaderIncluder>(compile_options));
+
+		for (const ShaderDefine& define : compile_options.permutation.defines())
+			options.AddMacroDefinition(define.name, define.value);
+
+		// relative includes resolve against the input file name
+		std::string input_name = m_Path.empty() ? m_Name : m_Path.string();
+		std::string entry_point(compile_options.entry_point);
+
+		shaderc::SpvCompilationResult spv = x_Compiler.CompileGlslToSpv(
 			m_Data.c_str(),
 			m_Data.size(),
 			shaderc_glsl_infer_from_source,
-			m_Name.data(),
-			entry_point.data(),
+			input_name.c_str(),
+			entry_point.c_str(),
 			options
 		);
 
@@ -99,12 +236,31 @@ namespace Na {
 				throw std::runtime_error("Failed to compile shader!");
 			}
 		}
+		NA_VERIFY(spv.GetCompilationStatus() == shaderc_compilation_status_success, "Failed to compile {}!", m_Name);
 
 		return ArrayVector<u32>(spv.begin(), spv.end());
 	}
 
 	AssetHandle<ShaderBinary> ShaderBinary::Load(const std::filesystem::path& path)
 	{
-		return std::make_shared<ShaderBinary>(LoadSpv(path));
+		// mappings are page aligned
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+		if (file->size() % sizeof(u32))
+			return std::make_shared<ShaderBinary>(LoadSpv(path));
+
+		std::span<const u32> words((const u32*)file->data(), file->size() / sizeof(u32));
+		return std::make_shared<ShaderBinary>(words, std::move(file));
+	}
+
+	AssetHandle<ShaderBinary> ShaderBinary::Load(const AssetBlob& blob)
+	{
+		if ((uintptr_t)blob.bytes.data() % alignof(u32) == 0 && blob.bytes.size() % sizeof(u32) == 0)
+			return std::make_shared<ShaderBinary>(std::span<const u32>((const u32*)blob.bytes.data(), blob.bytes.size() / sizeof(u32)), blob.owner);
+
+		// zeroed so a truncated last word is padded
+		ArrayVector<u32> spv((blob.bytes.size() + sizeof(u32) - 1) / sizeof(u32));
+		memcpy(spv.ptr(), blob.bytes.data(), blob.bytes.size());
+
+		return std::make_shared<ShaderBinary>(std::move(spv));
 	}
 } // namespace Na
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "Pch.hpp"
+#include "Natrium/Core/Arena.hpp"
+
+namespace Na {
+	static std::atomic<u64> s_Frame = 0;
+
+	static inline Byte* alignUp(Byte* ptr, u64 alignment)
+	{
+		return (Byte*)(((uintptr_t)ptr + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	}
+
+	void Arena::destroy(void)
+	{
+		while (m_Blocks)
+		{
+			Block* next = m_Blocks->next;
+			free(m_Blocks);
+			m_Blocks = next;
+		}
+
+		m_Cursor = nullptr;
+		m_End = nullptr;
+		m_Last = nullptr;
+		m_Capacity = 0;
+		m_Used = 0;
+	}
+
+	Arena::Arena(Arena&& other)
+	: m_Blocks(std::exchange(other.m_Blocks, nullptr)),
+	m_Cursor(std::exchange(other.m_Cursor, nullptr)),
+	m_End(std::exchange(other.m_End, nullptr)),
+	m_Last(std::exchange(other.m_Last, nullptr)),
+	m_BlockSize(other.m_BlockSize),
+	m_Capacity(std::exchange(other.m_Capacity, 0)),
+	m_Used(std::exchange(other.m_Used, 0)),
+	m_Peak(std::exchange(other.m_Peak, 0))
+	{}
+
+	Arena& Arena::operator=(Arena&& other)
+	{
+		if (this == &other)
+			return *this;
+
+		this->destroy();
+
+		m_Blocks = std::exchange(other.m_Blocks, nullptr);
+		m_Cursor = std::exchange(other.m_Cursor, nullptr);
+		m_End = std::exchange(other.m_End, nullptr);
+		m_Last = std::exchange(other.m_Last, nullptr);
+		m_BlockSize = other.m_BlockSize;
+		m_Capacity = std::exchange(other.m_Capacity, 0);
+		m_Used = std::exchange(other.m_Used, 0);
+		m_Peak = std::exchange(other.m_Peak, 0);
+
+		return *this;
+	}
+
+	void* Arena::allocate(u64 size, u64 alignment)
+	{
+		Byte* ptr = alignUp(m_Cursor, alignment);
+		if (!m_Cursor || ptr + size > m_End)
+		{
+			this->_allocate_block(size + alignment);
+			ptr = alignUp(m_Cursor, alignment);
+		}
+
+		m_Used += size + (ptr - m_Cursor);
+		m_Peak = std::max(m_Peak, m_Used);
+
+		m_Cursor = ptr + size;
+		return m_Last = ptr;
+	}
+
+	void* Arena::reallocate(void* ptr, u64 old_size, u64 new_size, u64 alignment)
+	{
+		if (!ptr)
+			return this->allocate(new_size, alignment);
+
+		if (ptr == m_Last && (Byte*)ptr + new_size <= m_End)
+		{
+			m_Used = m_Used - old_size + new_size;
+			m_Peak = std::max(m_Peak, m_Used);
+			m_Cursor = (Byte*)ptr + new_size;
+			return ptr;
+		}
+
+		void* new_ptr = this->allocate(new_size, alignment);
+		memcpy(new_ptr, ptr, std::min(old_size, new_size));
+		return new_ptr;
+	}
+
+	void Arena::reset(void)
+	{
+		if (m_Blocks && m_Blocks->next)
+		{
+			u64 capacity = m_Capacity;
+			this->destroy();
+			this->_allocate_block(capacity);
+		}
+
+		if (m_Blocks)
+		{
+			m_Cursor = (Byte*)(m_Blocks + 1);
+			m_End = m_Cursor + m_Blocks->size;
+		}
+		m_Last = nullptr;
+		m_Used = 0;
+	}
+
+	Arena& Arena::Thread(void)
+	{
+		static thread_local Arena x_Arena;
+		static thread_local u64 x_Frame = 0;
+
+		u64 frame = s_Frame.load(std::memory_order_relaxed);
+		if (x_Frame != frame)
+		{
+			x_Arena.reset();
+			x_Frame = frame;
+		}
+		return x_Arena;
+	}
+
+	void Arena::NextFrame(void)
+	{
+		s_Frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Arena::_allocate_block(u64 min_size)
+	{
+		u64 size = std::max(min_size, m_BlockSize);
+
+		Block* block = (Block*)malloc(sizeof(Block) + size);
+		NA_VERIFY(block, "Failed to allocate arena block of {} bytes: Out of memory!", size);
+
+		block->next = m_Blocks;
+		block->size = size;
+		m_Blocks = block;
+		m_Capacity += size;
+
+		m_Cursor = (Byte*)(block + 1);
+		m_End = m_Cursor + size;
+	}
+} // namespace Na
\ No newline at end of file
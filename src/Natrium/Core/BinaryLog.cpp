@@ -0,0 +1,541 @@
+#include "Pch.hpp"
+#include "Natrium/Core/BinaryLog.hpp"
+
+#include "Natrium/Core/MappedFile.hpp"
+
+#include <fmt/args.h>
+
+#if defined(NA_PLATFORM_WINDOWS)
+#include <Windows.h>
+#include <intrin.h>
+#elif defined(NA_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif // NA_PLATFORM
+
+namespace Na {
+	static constexpr char k_BinaryLogMagic[8] = { 'N', 'A', 'B', 'I', 'N', 'L', 'O', 'G' };
+	static constexpr u32 k_BinaryLogVersion = 1;
+
+	static constexpr u64 k_BlockHeaderSize = 16; // the block's sequence, then padding
+	static constexpr u64 k_BlockPayload = BinaryLog::k_BlockSize - k_BlockHeaderSize;
+
+	struct BinaryLogHeader {
+		char magic[8];
+		u32 version;
+		u32 block_size;
+		u64 block_count;
+
+		u64 site_offset;
+		u64 site_capacity;
+		u64 site_used; // through atomic_ref
+
+		u64 data_offset;
+
+		double ticks_per_second;
+		u64 start_ticks;
+		i64 start_time; // system clock nanoseconds at start_ticks
+	};
+
+	// a site table entry, followed by the format and file strings
+	struct BinaryLogSiteEntry {
+		u32 size; // including the strings, 8 byte aligned
+		u32 id;
+		u32 line;
+		u16 format_size;
+		u16 file_size;
+		LogLevel level;
+		u8 padding[7];
+	};
+
+	struct BinaryLogFile {
+		Byte* data = nullptr;
+		u64 size = 0;
+	#if defined(NA_PLATFORM_WINDOWS)
+		HANDLE file = nullptr;
+		HANDLE mapping = nullptr;
+	#endif
+
+		alignas(k_CacheLineSize) std::atomic<u64> cursor = 0; // in payload bytes of the ring
+	};
+
+	static std::atomic<BinaryLogFile*> s_BinaryLog = nullptr;
+	static std::atomic<u32> s_BinaryLogWriters = 0; // between _Reserve and _Commit
+
+	// every site so far, new files start by writing all of them
+	static std::mutex s_SiteMutex;
+	static std::vector<BinaryLogSite*> s_Sites;
+
+	static std::atomic<u32> s_NextThreadId = 0;
+	static thread_local u32 s_ThreadId = k_U32Max;
+
+	static inline u64 readTicks(void)
+	{
+	#if defined(NA_PLATFORM_WINDOWS) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+	#else
+		return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count();
+	#endif // TSC
+	}
+
+	static double measureTicksPerSecond(void)
+	{
+	#if defined(NA_PLATFORM_WINDOWS) || defined(__x86_64__) || defined(__i386__)
+		// a few milliseconds of spinning, once per Open
+		auto start = std::chrono::steady_clock::now();
+		u64 start_ticks = readTicks();
+
+		auto end = start;
+		while (end - start < std::chrono::milliseconds(5))
+			end = std::chrono::steady_clock::now();
+		u64 end_ticks = readTicks();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		return (double)(end_ticks - start_ticks) / seconds;
+	#else
+		return 1e9;
+	#endif // TSC
+	}
+
+	static inline BinaryLogHeader& fileHeader(BinaryLogFile& file) { return *(BinaryLogHeader*)file.data; }
+
+	static inline Byte* blockPtr(BinaryLogFile& file, u64 block)
+	{
+		BinaryLogHeader& header = fileHeader(file);
+		return file.data + header.data_offset + (block % header.block_count) * BinaryLog::k_BlockSize;
+	}
+
+	static inline void startBlock(BinaryLogFile& file, u64 block)
+	{
+		std::atomic_ref<u64>(*(u64*)blockPtr(file, block)).store(block + 1, std::memory_order_release);
+	}
+
+	static inline void writePadding(BinaryLogFile& file, u64 block, u64 offset, u64 size)
+	{
+		// a full header does not always fit, the decoder only reads size and site of padding
+		u32* padding = (u32*)(blockPtr(file, block) + k_BlockHeaderSize + offset);
+		padding[1] = k_U32Max;
+		std::atomic_ref<u32>(padding[0]).store((u32)size, std::memory_order_release);
+	}
+
+	static void writeSite(BinaryLogFile& file, const BinaryLogSite& site)
+	{
+		BinaryLogHeader& header = fileHeader(file);
+
+		u16 format_size = (u16)std::min<u64>(strlen(site.format), UINT16_MAX);
+		u16 file_size = (u16)std::min<u64>(strlen(site.file), UINT16_MAX);
+		u32 size = (u32)((sizeof(BinaryLogSiteEntry) + format_size + file_size + 7) & ~7ull);
+
+		std::atomic_ref<u64> used(header.site_used);
+		u64 offset = used.load(std::memory_order_relaxed);
+		if (offset + size > header.site_capacity)
+			return; // the decoder prints the raw arguments of unknown sites
+
+		Byte* ptr = file.data + header.site_offset + offset;
+		BinaryLogSiteEntry entry{ size, site.id, site.line, format_size, file_size, site.level, {} };
+		memcpy(ptr, &entry, sizeof(BinaryLogSiteEntry));
+		memcpy(ptr + sizeof(BinaryLogSiteEntry), site.format, format_size);
+		memcpy(ptr + sizeof(BinaryLogSiteEntry) + format_size, site.file, file_size);
+
+		used.store(offset + size, std::memory_order_release);
+	}
+
+	static void mapFile(BinaryLogFile& file, const std::filesystem::path& path, u64 size)
+	{
+	#if defined(NA_PLATFORM_WINDOWS)
+		HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			throw std::runtime_error(NA_FORMAT("Failed to create binary log {}!", path.string()));
+
+		HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, nullptr);
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(handle);
+			throw std::runtime_error(NA_FORMAT("Failed to map binary log {}!", path.string()));
+		}
+
+		file.file = handle;
+		file.mapping = mapping;
+	#elif defined(NA_PLATFORM_LINUX)
+		int handle = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (handle < 0)
+			throw std::runtime_error(NA_FORMAT("Failed to create binary log {}: {}!", path.string(), strerror(errno)));
+
+		if (ftruncate(handle, (off_t)size))
+		{
+			::close(handle);
+			throw std::runtime_error(NA_FORMAT("Failed to size binary log {}: {}!", path.string(), strerror(errno)));
+		}
+
+		// shared, so the pages reach the file even if the process dies
+		void* data = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+		::close(handle);
+		if (data == MAP_FAILED)
+			throw std::runtime_error(NA_FORMAT("Failed to map binary log {}: {}!", path.string(), strerror(errno)));
+	#endif // NA_PLATFORM
+
+		file.data = (Byte*)data;
+		file.size = size;
+	}
+
+	static void unmapFile(BinaryLogFile& file)
+	{
+	#if defined(NA_PLATFORM_WINDOWS)
+		FlushViewOfFile(file.data, 0);
+		UnmapViewOfFile(file.data);
+		CloseHandle(file.mapping);
+		CloseHandle(file.file);
+	#elif defined(NA_PLATFORM_LINUX)
+		msync(file.data, (size_t)file.size, MS_ASYNC);
+		munmap(file.data, (size_t)file.size);
+	#endif // NA_PLATFORM
+	}
+
+	BinaryLogSite::BinaryLogSite(LogLevel level, const char* format, const char* file, u32 line)
+	: level(level), format(format), file(file), line(line), id(BinaryLog::RegisterSite(*this))
+	{}
+
+	u32 BinaryLog::RegisterSite(BinaryLogSite& site)
+	{
+		std::lock_guard lock(s_SiteMutex);
+
+		site.id = (u32)s_Sites.size();
+		s_Sites.push_back(&site);
+
+		if (BinaryLogFile* file = s_BinaryLog.load(std::memory_order_acquire))
+			writeSite(*file, site);
+
+		return site.id;
+	}
+
+	void BinaryLog::Open(const std::filesystem::path& path, u64 capacity)
+	{
+		NA_VERIFY(!s_BinaryLog.load(), "A binary log is already open!");
+
+		u64 block_count = std::max<u64>((capacity + k_BlockSize - 1) / k_BlockSize, 2);
+		u64 data_offset = k_BlockSize + k_SiteTableSize; // the header gets a block of its own
+
+		BinaryLogFile* file = new BinaryLogFile;
+		try
+		{
+			mapFile(*file, path, data_offset + block_count * k_BlockSize);
+		} catch (...)
+		{
+			delete file;
+			throw;
+		}
+
+		BinaryLogHeader& header = fileHeader(*file);
+		memcpy(header.magic, k_BinaryLogMagic, sizeof(header.magic));
+		header.version = k_BinaryLogVersion;
+		header.block_size = (u32)k_BlockSize;
+		header.block_count = block_count;
+		header.site_offset = k_BlockSize;
+		header.site_capacity = k_SiteTableSize;
+		header.site_used = 0;
+		header.data_offset = data_offset;
+		header.ticks_per_second = measureTicksPerSecond();
+		header.start_time = (i64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()
+		).count();
+		header.start_ticks = readTicks();
+
+		std::lock_guard lock(s_SiteMutex);
+		for (BinaryLogSite* site : s_Sites)
+			writeSite(*file, *site);
+
+		startBlock(*file, 0);
+		s_BinaryLog.store(file, std::memory_order_release);
+	}
+
+	void BinaryLog::Close(void)
+	{
+		BinaryLogFile* file;
+		{
+			std::lock_guard lock(s_SiteMutex); // RegisterSite writes into the file under it
+			file = s_BinaryLog.exchange(nullptr, std::memory_order_seq_cst);
+		}
+		if (!file)
+			return;
+
+		// new writers see no log, the ones that already reserved space finish first
+		while (s_BinaryLogWriters.load(std::memory_order_seq_cst))
+			std::this_thread::yield();
+
+		unmapFile(*file);
+		delete file;
+	}
+
+	bool BinaryLog::IsOpen(void)
+	{
+		return s_BinaryLog.load(std::memory_order_relaxed);
+	}
+
+	BinaryLog::RecordHeader* BinaryLog::_Reserve(u32 site, u32 size)
+	{
+		NA_ASSERT(size <= k_BlockPayload / 2, "Binary log record is too large!");
+
+		// counted before the file is loaded, so Close either sees this writer or it sees no file
+		s_BinaryLogWriters.fetch_add(1, std::memory_order_seq_cst);
+		BinaryLogFile* file = s_BinaryLog.load(std::memory_order_seq_cst);
+		if (!file)
+		{
+			s_BinaryLogWriters.fetch_sub(1, std::memory_order_release);
+			return nullptr;
+		}
+
+		for (;;)
+		{
+			u64 cursor = file->cursor.fetch_add(size, std::memory_order_relaxed);
+			u64 block = cursor / k_BlockPayload;
+			u64 offset = cursor % k_BlockPayload;
+
+			if (!offset && block)
+				startBlock(*file, block);
+
+			if (offset + size > k_BlockPayload)
+			{
+				// the reservation spans into the next block, which makes its header ours as well
+				writePadding(*file, block, offset, k_BlockPayload - offset);
+				startBlock(*file, block + 1);
+				writePadding(*file, block + 1, 0, offset + size - k_BlockPayload);
+				continue;
+			}
+
+			if (s_ThreadId == k_U32Max)
+				s_ThreadId = s_NextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+			// a reused block still holds a record of an earlier round here, its size
+			// must not describe the new one while it is being written
+			RecordHeader* header = (RecordHeader*)(blockPtr(*file, block) + k_BlockHeaderSize + offset);
+			std::atomic_ref<u32>(header->size).store(0, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			header->site = site;
+			header->sequence = (u32)(block + 1);
+			header->thread = s_ThreadId;
+			header->ticks = readTicks();
+			return header;
+		}
+	}
+
+	void BinaryLog::_Commit(RecordHeader* header, u32 size)
+	{
+		std::atomic_ref<u32>(header->size).store(size, std::memory_order_release);
+		s_BinaryLogWriters.fetch_sub(1, std::memory_order_release);
+	}
+
+	struct DecodedSite {
+		LogLevel level;
+		std::string format;
+		std::string file;
+		u32 line;
+	};
+
+	static std::string_view levelName(LogLevel level)
+	{
+		switch (level)
+		{
+		case Trace: return "Trace";
+		case Info:  return "Info";
+		case Warn:  return "Warn";
+		case Error: return "Error";
+		case Fatal: return "Fatal";
+		default:    return "None";
+		}
+	}
+
+	// false if the arguments run past end
+	static bool decodeArgs(const Byte* ptr, const Byte* end, fmt::dynamic_format_arg_store<fmt::format_context>& args)
+	{
+		while (ptr < end)
+		{
+			BinaryLog::ArgType type = (BinaryLog::ArgType)*ptr++;
+			switch (type)
+			{
+			case BinaryLog::ArgType::Bool:
+			case BinaryLog::ArgType::Char:
+				if (ptr + 1 > end)
+					return false;
+				if (type == BinaryLog::ArgType::Bool)
+					args.push_back((bool)*ptr);
+				else
+					args.push_back((char)*ptr);
+				ptr++;
+				break;
+			case BinaryLog::ArgType::Str:
+			{
+				u16 size;
+				if (ptr + sizeof(u16) > end)
+					return false;
+				memcpy(&size, ptr, sizeof(u16));
+				ptr += sizeof(u16);
+				if (ptr + size > end)
+					return false;
+				args.push_back(std::string((const char*)ptr, size));
+				ptr += size;
+				break;
+			}
+			case BinaryLog::ArgType::I64:
+			case BinaryLog::ArgType::U64:
+			case BinaryLog::ArgType::F64:
+			case BinaryLog::ArgType::Ptr:
+			{
+				u64 bits;
+				if (ptr + sizeof(u64) > end)
+					return false;
+				memcpy(&bits, ptr, sizeof(u64));
+				ptr += sizeof(u64);
+
+				if (type == BinaryLog::ArgType::I64)
+					args.push_back((i64)bits);
+				else if (type == BinaryLog::ArgType::U64)
+					args.push_back(bits);
+				else if (type == BinaryLog::ArgType::Ptr)
+					args.push_back((const void*)(uintptr_t)bits);
+				else
+				{
+					double value;
+					memcpy(&value, &bits, sizeof(double));
+					args.push_back(value);
+				}
+				break;
+			}
+			default:
+				return true; // the zero padding after the last argument
+			}
+		}
+		return true;
+	}
+
+	void BinaryLog::Decode(const std::filesystem::path& path, std::ostream& out)
+	{
+		MappedFile file(path);
+		NA_VERIFY(file.size() >= sizeof(BinaryLogHeader), "Failed to decode binary log {}: Not a binary log!", path.string());
+
+		const BinaryLogHeader& header = *(const BinaryLogHeader*)file.data();
+		NA_VERIFY(!memcmp(header.magic, k_BinaryLogMagic, sizeof(header.magic)), "Failed to decode binary log {}: Not a binary log!", path.string());
+		NA_VERIFY(header.version == k_BinaryLogVersion, "Failed to decode binary log {}: Written by version {}, expected {}!", path.string(), header.version, k_BinaryLogVersion);
+
+		// compared against what is left after each offset, so corrupt values can't wrap around
+		NA_VERIFY(
+			header.block_size == k_BlockSize &&
+			header.data_offset <= file.size() &&
+			header.block_count <= (file.size() - header.data_offset) / k_BlockSize,
+			"Failed to decode binary log {}: The block ring is truncated!",
+				path.string()
+		);
+		NA_VERIFY(
+			header.site_offset <= file.size() &&
+			header.site_used <= file.size() - header.site_offset,
+			"Failed to decode binary log {}: The site table is truncated!",
+				path.string()
+		);
+
+		std::unordered_map<u32, DecodedSite> sites;
+		for (u64 offset = 0; offset + sizeof(BinaryLogSiteEntry) <= header.site_used;)
+		{
+			BinaryLogSiteEntry entry;
+			memcpy(&entry, file.data() + header.site_offset + offset, sizeof(BinaryLogSiteEntry));
+			if (entry.size < sizeof(BinaryLogSiteEntry) || entry.size > header.site_used - offset ||
+				(u64)entry.format_size + entry.file_size > entry.size - sizeof(BinaryLogSiteEntry))
+				break;
+
+			const char* strings = (const char*)(file.data() + header.site_offset + offset + sizeof(BinaryLogSiteEntry));
+			sites[entry.id] = DecodedSite{
+				entry.level,
+				std::string(strings, entry.format_size),
+				std::string(strings + entry.format_size, entry.file_size),
+				entry.line
+			};
+			offset += entry.size;
+		}
+
+		// the ring may have wrapped, so blocks are ordered by their sequence
+		std::vector<std::pair<u64, u64>> blocks; // sequence, index
+		for (u64 i = 0; i < header.block_count; i++)
+		{
+			u64 sequence;
+			memcpy(&sequence, file.data() + header.data_offset + i * k_BlockSize, sizeof(u64));
+			if (sequence)
+				blocks.emplace_back(sequence, i);
+		}
+		std::sort(blocks.begin(), blocks.end());
+
+		for (auto [sequence, index] : blocks)
+		{
+			const Byte* block = file.data() + header.data_offset + index * k_BlockSize + k_BlockHeaderSize;
+
+			for (u64 offset = 0; offset + 2 * sizeof(u32) <= k_BlockPayload;)
+			{
+				u32 prefix[2];
+				memcpy(prefix, block + offset, sizeof(prefix));
+				if (!prefix[0] || prefix[0] % 8 || offset + prefix[0] > k_BlockPayload)
+					break; // the end of what was written
+
+				if (prefix[1] == k_U32Max)
+				{
+					offset += prefix[0];
+					continue;
+				}
+
+				RecordHeader record;
+				if (prefix[0] < sizeof(RecordHeader))
+					break;
+				memcpy(&record, block + offset, sizeof(RecordHeader));
+				if (record.sequence != (u32)sequence)
+					break; // left over from an earlier round of the ring
+
+				double seconds = (double)(i64)(record.ticks - header.start_ticks) / header.ticks_per_second;
+				auto time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+					std::chrono::nanoseconds(header.start_time + (i64)(seconds * 1e9))
+				));
+
+				const Byte* args_begin = block + offset + sizeof(RecordHeader);
+				const Byte* args_end = block + offset + record.size;
+
+				fmt::dynamic_format_arg_store<fmt::format_context> args;
+				bool complete = decodeArgs(args_begin, args_end, args);
+
+				auto site = sites.find(record.site);
+				std::string message;
+				if (site == sites.end())
+				{
+					message = NA_FORMAT("<unknown site #{}>", record.site);
+				} else
+				{
+					try
+					{
+						message = fmt::vformat(site->second.format, args);
+					} catch (const fmt::format_error& e)
+					{
+						message = NA_FORMAT("<{}: {}>", site->second.format, e.what());
+					}
+					if (!complete)
+						message += " <truncated>";
+				}
+
+				auto seconds_time = std::chrono::floor<std::chrono::seconds>(time);
+				out << NA_FORMAT(
+					"[{:%H:%M:%S}.{:06}][T{}][{}]: {}\n",
+					seconds_time,
+					std::chrono::duration_cast<std::chrono::microseconds>(time - seconds_time).count(),
+					record.thread,
+					levelName(site == sites.end() ? None : site->second.level),
+					message
+				);
+
+				offset += record.size;
+			}
+		}
+	}
+} // namespace Na
\ No newline at end of file
@@ -47,23 +47,28 @@ namespace Na {
 		return *this;
 	}
 
-	Context Context::Initialize(void)
+	Context Context::Initialize(const ContextSettings& settings)
 	{
 		Context context(getExecPath(), "Pre-Alpha");
 
 		g_Logger.header();
 		g_Logger.fmt(Info, "Initializing Natrium version {}", context.m_Version);
 
-		glfwSetErrorCallback([](int error, const char* description)
+		if (!settings.headless)
 		{
-			g_Logger.fmt(Error, "GLFW Error#{}: {}", error, description);
-			throw std::runtime_error(NA_FORMAT("GLFW Error #{}", error));
-		});
-		int result = glfwInit();
-		NA_ASSERT(result, "Failed to initialize glfw!");
-		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+			glfwSetErrorCallback([](int error, const char* description)
+			{
+				g_Logger.fmt(Error, "GLFW Error#{}: {}", error, description);
+				throw std::runtime_error(NA_FORMAT("GLFW Error #{}", error));
+			});
+			int result = glfwInit();
+			NA_ASSERT(result, "Failed to initialize glfw!");
+			glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		}
 
-		context.m_VkContext = VkContext::Initialize();
+		JobSystem::Initialize();
+
+		context.m_VkContext = VkContext::Initialize(context.m_ExecDir / "pipeline_cache.bin", settings);
 
 		s_Context = &context;
 		return context;
@@ -73,8 +78,11 @@ namespace Na {
 	{
 		g_Logger(Info, "Shutting down Natrium, Goodbye!");
 
+		// jobs may still own vulkan objects
+		JobSystem::Shutdown();
+
 		VkContext::Shutdown();
-		glfwTerminate();
+		glfwTerminate(); // does nothing if glfw was never initialized
 
 		s_Context = nullptr;
 	}
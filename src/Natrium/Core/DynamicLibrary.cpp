@@ -16,22 +16,39 @@ namespace Na {
 		if (name.empty())
 			return;
 
+		std::filesystem::path path = PathOf(name);
+		this->load_from(path);
+		m_Name = name;
+
+		NA_ASSERT(m_Handle, "Failed to load library {}", path.string());
+	}
+
+	void DynamicLibrary::load_from(const std::filesystem::path& path)
+	{
 		if (m_Handle)
 			this->unload();
 
-		m_Name = name;
+		g_Logger.fmt(Trace, "Loading library {}", path.string());
+	#if defined(NA_PLATFORM_WINDOWS)
+		m_Handle = LoadLibraryW(path.c_str());
+	#elif defined(NA_PLATFORM_LINUX)
+		m_Handle = dlopen(path.c_str(), RTLD_LAZY);
+		if (!m_Handle)
+			g_Logger.fmt(Error, "Failed to load library {}: {}", path.string(), dlerror());
+	#endif
 
-		g_Logger.fmt(Trace, "Loading library {}", name);
+		if (m_Handle)
+			m_Path = path;
+	}
+
+	std::filesystem::path DynamicLibrary::PathOf(const std::string_view& name)
+	{
 		std::filesystem::path dir = Context::GetExecDir();
 	#if defined(NA_PLATFORM_WINDOWS)
-		dir = (dir / name).replace_extension(".dll");
-		m_Handle = LoadLibraryW(dir.c_str());
+		return (dir / name).replace_extension(".dll");
 	#elif defined(NA_PLATFORM_LINUX)
-		dir = (dir / (std::string("lib") + std::string(name))).replace_extension(".so");
-		m_Handle = dlopen(dir.c_str(), RTLD_LAZY);
+		return (dir / (std::string("lib") + std::string(name))).replace_extension(".so");
 	#endif
-
-		NA_ASSERT(m_Handle, "Failed to load library {}", dir.string());
 	}
 
 	void DynamicLibrary::unload(void)
@@ -39,7 +56,7 @@ namespace Na {
 		if (!m_Handle)
 			return;
 
-		g_Logger.fmt(Trace, "Unloading library {}", m_Name);
+		g_Logger.fmt(Trace, "Unloading library {}", m_Path.string());
 	#if defined(NA_PLATFORM_WINDOWS)
 		FreeLibrary((HMODULE)m_Handle);
 	#elif defined(NA_PLATFORM_LINUX)
@@ -47,6 +64,7 @@ namespace Na {
 	#endif
 		m_Handle = nullptr;
 		m_Name = "";
+		m_Path.clear();
 	}
 
 	void* DynamicLibrary::fn(const char* name) const
@@ -64,7 +82,8 @@ namespace Na {
 
 	DynamicLibrary::DynamicLibrary(DynamicLibrary&& other)
 	: m_Handle(std::exchange(other.m_Handle, nullptr)),
-	m_Name(std::move(other.m_Name))
+	m_Name(std::move(other.m_Name)),
+	m_Path(std::move(other.m_Path))
 	{}
 
 	DynamicLibrary& DynamicLibrary::operator=(DynamicLibrary&& other)
@@ -72,6 +91,7 @@ namespace Na {
 		this->unload();
 		m_Handle = std::exchange(other.m_Handle, nullptr);
 		m_Name = std::move(other.m_Name);
+		m_Path = std::move(other.m_Path);
 		return *this;
 	}
 } // namespace Na
@@ -0,0 +1,159 @@
+#include "Pch.hpp"
+#include "Natrium/Core/EventBus.hpp"
+
+namespace Na {
+	EventSubscription EventBus::subscribe(EventTypeMask types, EventCallback callback, i64 priority)
+	{
+		NA_ASSERT(callback, "EventBus::subscribe needs a callback!");
+
+		u64 id = m_NextId++;
+		if (m_DispatchDepth)
+			m_PendingSubscriptions.emplace(PendingSubscription{ id, types, priority, std::move(callback) });
+		else
+			this->_insert(types, id, priority, callback);
+
+		return EventSubscription{ id };
+	}
+
+	void EventBus::unsubscribe(EventSubscription subscription)
+	{
+		if (!subscription)
+			return;
+
+		for (u64 i = 0; i < m_PendingSubscriptions.size(); i++)
+		{
+			if (m_PendingSubscriptions[i].id != subscription.id)
+				continue;
+
+			PendingSubscription* pending = m_PendingSubscriptions.ptr();
+			std::move(pending + i + 1, pending + m_PendingSubscriptions.size(), pending + i);
+			m_PendingSubscriptions.pop();
+			return;
+		}
+
+		for (ArrayList<Listener>& listeners : m_Listeners)
+		{
+			for (u64 i = 0; i < listeners.size(); i++)
+			{
+				if (listeners[i].id != subscription.id)
+					continue;
+
+				if (m_DispatchDepth)
+				{
+					listeners[i].callback = nullptr;
+					m_PendingRemovals = true;
+				} else
+				{
+					Listener* ptr = listeners.ptr();
+					std::move(ptr + i + 1, ptr + listeners.size(), ptr + i);
+					listeners.pop();
+				}
+				break; // a subscription is in each list at most once
+			}
+		}
+	}
+
+	void EventBus::clear(void)
+	{
+		m_PendingSubscriptions.clear();
+
+		if (m_DispatchDepth)
+		{
+			for (ArrayList<Listener>& listeners : m_Listeners)
+				for (Listener& listener : listeners)
+					listener.callback = nullptr;
+			m_PendingRemovals = true;
+			return;
+		}
+
+		for (ArrayList<Listener>& listeners : m_Listeners)
+			listeners.clear();
+	}
+
+	bool EventBus::dispatch(Event& e)
+	{
+		ArrayList<Listener>& listeners = m_Listeners[(u8)e.type];
+		if (listeners.empty())
+			return false;
+
+		m_DispatchDepth++;
+
+		// by index, callbacks never resize the list during dispatch but nested dispatches may read it
+		for (u64 i = 0; i < listeners.size() && !e.handled; i++)
+		{
+			if (!listeners[i].callback)
+				continue;
+
+			try
+			{
+				listeners[i].callback(e);
+			} catch (...)
+			{
+				if (!--m_DispatchDepth)
+					this->_apply_pending();
+				throw;
+			}
+		}
+
+		if (!--m_DispatchDepth)
+			this->_apply_pending();
+
+		return e.handled;
+	}
+
+	void EventBus::dispatch(EventQueue& events)
+	{
+		for (Event& e : events)
+			this->dispatch(e);
+	}
+
+	void EventBus::_insert(EventTypeMask types, u64 id, i64 priority, const EventCallback& callback)
+	{
+		for (u64 type = 0; type < k_EventTypeCount; type++)
+		{
+			if (!(types & (EventTypeMask(1) << type)))
+				continue;
+
+			ArrayList<Listener>& listeners = m_Listeners[type];
+
+			// after every listener of the same or a higher priority
+			Listener* ptr = listeners.ptr();
+			u64 index = std::upper_bound(ptr, ptr + listeners.size(), priority, [](i64 priority, const Listener& listener) {
+				return priority > listener.priority;
+			}) - ptr;
+
+			listeners.emplace(Listener{ id, priority, callback });
+
+			ptr = listeners.ptr();
+			std::rotate(ptr + index, ptr + listeners.size() - 1, ptr + listeners.size());
+		}
+	}
+
+	void EventBus::_apply_pending(void)
+	{
+		if (m_PendingRemovals)
+		{
+			for (ArrayList<Listener>& listeners : m_Listeners)
+			{
+				u64 kept = 0;
+				for (u64 i = 0; i < listeners.size(); i++)
+				{
+					if (!listeners[i].callback)
+						continue;
+
+					if (kept != i)
+						listeners[kept] = std::move(listeners[i]);
+					kept++;
+				}
+
+				while (listeners.size() > kept)
+					listeners.pop();
+			}
+			m_PendingRemovals = false;
+		}
+
+		ArrayList<PendingSubscription> pending = std::move(m_PendingSubscriptions);
+		for (PendingSubscription& subscription : pending)
+			this->_insert(subscription.types, subscription.id, subscription.priority, subscription.callback);
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "Pch.hpp"
+#include "Natrium/Core/FileWatcher.hpp"
+
+#if defined(NA_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(NA_PLATFORM_LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // NA_PLATFORM_WINDOWS
+
+namespace Na {
+#if defined(NA_PLATFORM_WINDOWS)
+	// one per watched root, ReadDirectoryChangesW covers the subdirectories
+	struct FileWatcher::WatchedDir {
+		std::filesystem::path path;
+		HANDLE handle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped{};
+		alignas(DWORD) Byte buffer[64 * 1024];
+	};
+
+	static bool readChanges(HANDLE handle, Byte* buffer, DWORD size, OVERLAPPED& overlapped)
+	{
+		return ReadDirectoryChangesW(
+			handle,
+			buffer, size,
+			TRUE, // subtree
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+			nullptr,
+			&overlapped,
+			nullptr
+		);
+	}
+#elif defined(NA_PLATFORM_LINUX)
+	// one per directory, inotify does not watch subdirectories
+	struct FileWatcher::WatchedDir {
+		std::filesystem::path path;
+		int watch = -1;
+	};
+
+	static constexpr u32 k_InotifyMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+#endif // NA_PLATFORM_WINDOWS
+
+	void FileWatcher::watch(const std::filesystem::path& dir)
+	{
+		std::error_code error;
+		std::filesystem::path path = std::filesystem::weakly_canonical(dir, error);
+		NA_VERIFY(std::filesystem::is_directory(path, error), "Failed to watch {}: Not a directory!", dir.string());
+
+		for (const WatchedDir* watched : m_Dirs)
+			if (watched->path == path)
+				return;
+
+	#if defined(NA_PLATFORM_WINDOWS)
+		HANDLE handle = CreateFileW(
+			path.c_str(),
+			FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			nullptr
+		);
+		NA_VERIFY(handle != INVALID_HANDLE_VALUE, "Failed to watch {}: Could not open directory!", path.string());
+
+		WatchedDir* watched = new WatchedDir;
+		watched->path = path;
+		watched->handle = handle;
+		watched->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+		if (!readChanges(handle, watched->buffer, sizeof(watched->buffer), watched->overlapped))
+		{
+			CloseHandle(watched->overlapped.hEvent);
+			CloseHandle(handle);
+			delete watched;
+			throw std::runtime_error(NA_FORMAT("Failed to watch {}: Could not read directory changes!", path.string()));
+		}
+
+		m_Dirs.push_back(watched);
+	#elif defined(NA_PLATFORM_LINUX)
+		if (m_Inotify < 0)
+		{
+			m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			NA_VERIFY(m_Inotify >= 0, "Failed to watch {}: {}!", path.string(), strerror(errno));
+		}
+
+		NA_VERIFY(this->_add_watch(path), "Failed to watch {}: {}!", path.string(), strerror(errno));
+	#endif
+	}
+
+#if defined(NA_PLATFORM_LINUX)
+	bool FileWatcher::_add_watch(const std::filesystem::path& dir)
+	{
+		int watch = inotify_add_watch(m_Inotify, dir.c_str(), k_InotifyMask);
+		if (watch < 0)
+			return false;
+
+		// inotify hands out the same descriptor for a directory that is watched already
+		bool found = false;
+		for (const WatchedDir* watched : m_Dirs)
+			found = found || watched->watch == watch;
+		if (!found)
+			m_Dirs.push_back(new WatchedDir{ dir, watch });
+
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(dir, error))
+			if (entry.is_directory(error) && !entry.is_symlink(error))
+				(void)this->_add_watch(entry.path()); // e.g. removed meanwhile
+
+		return true;
+	}
+#endif // NA_PLATFORM_LINUX
+
+	void FileWatcher::close(void)
+	{
+		for (WatchedDir* watched : m_Dirs)
+		{
+		#if defined(NA_PLATFORM_WINDOWS)
+			CancelIo(watched->handle);
+			CloseHandle(watched->handle);
+			CloseHandle(watched->overlapped.hEvent);
+		#endif
+			delete watched;
+		}
+		m_Dirs.clear();
+
+	#if defined(NA_PLATFORM_LINUX)
+		// closing the instance removes its watches
+		if (m_Inotify >= 0)
+			::close(std::exchange(m_Inotify, -1));
+	#endif
+	}
+
+	std::vector<std::filesystem::path> FileWatcher::poll(void)
+	{
+		std::vector<std::filesystem::path> changes;
+
+	#if defined(NA_PLATFORM_WINDOWS)
+		for (WatchedDir* watched : m_Dirs)
+		{
+			DWORD size = 0;
+			if (!GetOverlappedResult(watched->handle, &watched->overlapped, &size, FALSE))
+				continue; // ERROR_IO_INCOMPLETE, nothing changed yet
+
+			// a size of 0 means the buffer overflowed, the changes are lost
+			for (DWORD offset = 0; size;)
+			{
+				const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)(watched->buffer + offset);
+
+				if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+				{
+					std::filesystem::path path = watched->path / std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR));
+
+					std::error_code error;
+					if (!std::filesystem::is_directory(path, error))
+						changes.push_back(path.lexically_normal());
+				}
+
+				if (!info->NextEntryOffset)
+					break;
+				offset += info->NextEntryOffset;
+			}
+
+			ResetEvent(watched->overlapped.hEvent);
+			readChanges(watched->handle, watched->buffer, sizeof(watched->buffer), watched->overlapped);
+		}
+	#elif defined(NA_PLATFORM_LINUX)
+		if (m_Inotify < 0)
+			return changes;
+
+		alignas(inotify_event) Byte buffer[16 * 1024];
+		for (;;)
+		{
+			ssize_t size = read(m_Inotify, buffer, sizeof(buffer));
+			if (size <= 0)
+				break; // EAGAIN once the queue is empty
+
+			for (ssize_t offset = 0; offset < size;)
+			{
+				const inotify_event* event = (const inotify_event*)(buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				auto it = std::find_if(m_Dirs.begin(), m_Dirs.end(), [event](const WatchedDir* watched) { return watched->watch == event->wd; });
+				if (it == m_Dirs.end())
+					continue;
+
+				if (event->mask & IN_IGNORED)
+				{
+					// the directory was deleted
+					delete *it;
+					m_Dirs.erase(it);
+					continue;
+				}
+
+				if (!event->len)
+					continue;
+
+				std::filesystem::path path = (*it)->path / event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					// files written into a new directory before its watch was added are missed
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+						(void)this->_add_watch(path);
+				} else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					changes.push_back(std::move(path));
+				}
+			}
+		}
+	#endif
+
+		std::sort(changes.begin(), changes.end());
+		changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+
+		return changes;
+	}
+} // namespace Na
\ No newline at end of file
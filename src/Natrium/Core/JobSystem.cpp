@@ -0,0 +1,356 @@
+#include "Pch.hpp"
+#include "Natrium/Core/JobSystem.hpp"
+
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	static JobSystem* s_JobSystem = nullptr;
+
+	// the system the current thread works for and its index, k_U32Max for other threads
+	static thread_local const JobSystem* s_WorkerOwner = nullptr;
+	static thread_local u32 s_WorkerIndex = k_U32Max;
+
+	// rounds of looking for work before a worker goes to sleep
+	static constexpr u32 k_SpinCount = 64;
+
+	static inline u32 randomIndex(u32 bound)
+	{
+		// xorshift, only used to pick a victim
+		static thread_local u32 x_State = (u32)std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+		x_State ^= x_State << 13;
+		x_State ^= x_State >> 17;
+		x_State ^= x_State << 5;
+		return x_State % bound;
+	}
+
+	bool JobSystem::WorkStealingDeque::push(Task* task)
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+		i64 top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= (i64)k_DequeCapacity)
+			return false;
+
+		m_Tasks[bottom & (k_DequeCapacity - 1)].store(task, std::memory_order_release);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	JobSystem::Task* JobSystem::WorkStealingDeque::pop(void)
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_seq_cst);
+		i64 top = m_Top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Task* task = m_Tasks[bottom & (k_DequeCapacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// the last task, thieves may race for it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				task = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return task;
+	}
+
+	JobSystem::Task* JobSystem::WorkStealingDeque::steal(void)
+	{
+		i64 top = m_Top.load(std::memory_order_seq_cst);
+		i64 bottom = m_Bottom.load(std::memory_order_seq_cst);
+		if (top >= bottom)
+			return nullptr;
+
+		Task* task = m_Tasks[top & (k_DequeCapacity - 1)].load(std::memory_order_acquire);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+
+		return task;
+	}
+
+	JobSystem::JobSystem(u32 worker_count)
+	: m_WorkerCount(worker_count ? worker_count : std::max(std::thread::hardware_concurrency(), 2u) - 1),
+	m_Workers(std::make_unique<Worker[]>(m_WorkerCount))
+	{
+		for (u32 i = 0; i < m_WorkerCount; i++)
+			m_Workers[i].thread = std::thread(&JobSystem::_worker_main, this, i);
+	}
+
+	void JobSystem::destroy(void)
+	{
+		if (!m_Workers)
+			return;
+
+		m_Stop.store(true, std::memory_order_seq_cst);
+		m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+		m_Epoch.notify_all();
+
+		for (u32 i = 0; i < m_WorkerCount; i++)
+			m_Workers[i].thread.join();
+
+		// anything queued by the last jobs
+		while (Task* task = this->_find())
+			this->_execute(task);
+
+		m_Workers.reset();
+		m_WorkerCount = 0;
+	}
+
+	void JobSystem::run(Job job, JobCounter* counter, const JobCounter* dependency)
+	{
+		if (counter)
+			counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+		Task* task = new Task{ std::move(job), counter, dependency };
+		if (!dependency || !this->_park(task))
+			this->_push(task);
+	}
+
+	void JobSystem::wait(JobCounter& counter)
+	{
+		while (!counter.done())
+		{
+			if (Task* task = this->_find())
+				this->_execute(task);
+			else
+				std::this_thread::yield();
+		}
+
+		if (counter.m_Failed.load(std::memory_order_acquire))
+		{
+			// the counter can be reused afterwards
+			counter.m_Failed.store(false, std::memory_order_relaxed);
+			std::rethrow_exception(std::exchange(counter.m_Exception, nullptr));
+		}
+	}
+
+	void JobSystem::parallel_for(u64 count, u64 min_batch, const std::function<void(u64, u64)>& fn)
+	{
+		if (!count)
+			return;
+
+		// a few batches per thread, so a slow batch does not hold everyone up
+		u64 target_batches = (u64)(m_WorkerCount + 1) * 4;
+		u64 batch_size = std::max<u64>({ min_batch, (count + target_batches - 1) / target_batches, 1 });
+
+		JobCounter counter;
+		for (u64 begin = batch_size; begin < count; begin += batch_size)
+		{
+			u64 end = std::min(begin + batch_size, count);
+			this->run([&fn, begin, end](void) { fn(begin, end); }, &counter);
+		}
+
+		// the calling thread takes the first batch
+		try
+		{
+			fn(0, std::min(batch_size, count));
+		} catch (...)
+		{
+			this->wait(counter);
+			throw;
+		}
+		this->wait(counter);
+	}
+
+	bool JobSystem::IsWorkerThread(void)
+	{
+		return s_WorkerOwner;
+	}
+
+	void JobSystem::Initialize(u32 worker_count)
+	{
+		NA_VERIFY(!s_JobSystem, "JobSystem is already initialized!");
+		s_JobSystem = new JobSystem(worker_count);
+
+		g_Logger.fmt(Info, "Started {} job workers", s_JobSystem->worker_count());
+	}
+
+	void JobSystem::Shutdown(void)
+	{
+		delete s_JobSystem;
+		s_JobSystem = nullptr;
+	}
+
+	JobSystem& JobSystem::Get(void)
+	{
+		NA_ASSERT(s_JobSystem, "JobSystem is not initialized!");
+		return *s_JobSystem;
+	}
+
+	void JobSystem::_worker_main(u32 index)
+	{
+		s_WorkerOwner = this;
+		s_WorkerIndex = index;
+
+		u32 idle_rounds = 0;
+		for (;;)
+		{
+			if (Task* task = this->_find())
+			{
+				this->_execute(task);
+				idle_rounds = 0;
+				continue;
+			}
+
+			if (m_Stop.load(std::memory_order_acquire))
+				break;
+
+			if (++idle_rounds < k_SpinCount)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			// read before the last look, a push after it changes the epoch and the wait returns
+			u32 epoch = m_Epoch.load(std::memory_order_seq_cst);
+			m_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+			if (Task* task = this->_find())
+			{
+				m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+				this->_execute(task);
+				idle_rounds = 0;
+				continue;
+			}
+
+			if (!m_Stop.load(std::memory_order_acquire))
+				m_Epoch.wait(epoch, std::memory_order_seq_cst);
+
+			m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+			idle_rounds = 0;
+		}
+
+		s_WorkerOwner = nullptr;
+		s_WorkerIndex = k_U32Max;
+	}
+
+	void JobSystem::_push(Task* task)
+	{
+		bool pushed = s_WorkerOwner == this && !m_Stop.load(std::memory_order_relaxed) ?
+			m_Workers[s_WorkerIndex].deque.push(task) :
+			false;
+
+		if (!pushed)
+			pushed = m_Queue.try_push(task);
+
+		if (pushed)
+		{
+			this->_wake_one();
+			return;
+		}
+
+		// everything is full, rather than blocking the caller does the work
+		this->_execute(task);
+	}
+
+	JobSystem::Task* JobSystem::_find(void)
+	{
+		Task* task = nullptr;
+
+		bool worker = s_WorkerOwner == this;
+		if (worker && (task = m_Workers[s_WorkerIndex].deque.pop()))
+			return task;
+
+		if (m_Queue.try_pop(task))
+			return task;
+
+		if (!m_WorkerCount)
+			return nullptr;
+
+		u32 start = randomIndex(m_WorkerCount);
+		for (u32 i = 0; i < m_WorkerCount; i++)
+		{
+			u32 victim = (start + i) % m_WorkerCount;
+			if (worker && victim == s_WorkerIndex)
+				continue;
+
+			if ((task = m_Workers[victim].deque.steal()))
+				return task;
+		}
+
+		return nullptr;
+	}
+
+	bool JobSystem::_park(Task* task)
+	{
+		const JobCounter& dependency = *task->dependency;
+
+		std::lock_guard lock(dependency.m_ParkMutex);
+		if (dependency.done())
+			return false;
+
+		task->next_parked = std::exchange(dependency.m_Parked, task);
+		return true;
+	}
+
+	void JobSystem::_finish(JobCounter* counter)
+	{
+		// only the decrement to 0 takes the lock, so parking can not miss it
+		u32 pending = counter->m_Pending.load(std::memory_order_relaxed);
+		while (pending > 1)
+		{
+			if (counter->m_Pending.compare_exchange_weak(pending, pending - 1, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		}
+
+		Task* parked = nullptr;
+		{
+			std::lock_guard lock(counter->m_ParkMutex);
+			if (counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				parked = std::exchange(counter->m_Parked, nullptr);
+		}
+
+		// the counter may be gone by now
+		while (parked)
+		{
+			Task* next = std::exchange(parked->next_parked, nullptr);
+			this->_push(parked);
+			parked = next;
+		}
+	}
+
+	void JobSystem::_execute(Task* task)
+	{
+		JobCounter* counter = task->counter;
+		try
+		{
+			task->job();
+		} catch (...)
+		{
+			if (!counter)
+			{
+				try
+				{
+					throw;
+				} catch (const std::exception& e)
+				{
+					g_Logger.fmt(Error, "Job threw: {}", e.what());
+				} catch (...)
+				{
+					g_Logger(Error, "Job threw an unknown exception");
+				}
+			} else if (!counter->m_Failed.exchange(true, std::memory_order_relaxed))
+			{
+				counter->m_Exception = std::current_exception();
+			}
+		}
+
+		delete task;
+
+		// release publishes m_Exception along with the job's writes
+		if (counter)
+			this->_finish(counter);
+	}
+
+	void JobSystem::_wake_one(void)
+	{
+		m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_Sleeping.load(std::memory_order_seq_cst))
+			m_Epoch.notify_one();
+	}
+} // namespace Na
\ No newline at end of file
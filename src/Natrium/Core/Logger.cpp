@@ -0,0 +1,109 @@
+#include "Pch.hpp"
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	AsyncLogSink::AsyncLogSink(std::ostream* stream, u64 capacity)
+	: m_Stream(stream),
+	m_Queue(capacity),
+	m_Thread(&AsyncLogSink::_thread_main, this)
+	{}
+
+	void AsyncLogSink::destroy(void)
+	{
+		if (!m_Thread.joinable())
+			return;
+
+		m_Stop.store(true, std::memory_order_seq_cst);
+		m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+		m_Epoch.notify_one();
+
+		m_Thread.join();
+	}
+
+	void AsyncLogSink::push(LogRecord&& record)
+	{
+		LogLevel level = record.level;
+
+		m_Pushed.fetch_add(1, std::memory_order_relaxed);
+		while (!m_Queue.try_push(std::move(record)))
+		{
+			// full, the writer is behind
+			m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+			m_Epoch.notify_one();
+			std::this_thread::yield();
+		}
+
+		m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_Sleeping.load(std::memory_order_seq_cst))
+			m_Epoch.notify_one();
+
+		// the process may be about to go down
+		if (level == Fatal)
+			this->flush();
+	}
+
+	void AsyncLogSink::flush(void)
+	{
+		u64 target = m_Pushed.load(std::memory_order_acquire);
+		while (m_Written.load(std::memory_order_acquire) < target)
+		{
+			m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+			m_Epoch.notify_one();
+			std::this_thread::yield();
+		}
+	}
+
+	void AsyncLogSink::_thread_main(void)
+	{
+		std::string line;
+		LogRecord record;
+
+		for (;;)
+		{
+			u32 epoch = m_Epoch.load(std::memory_order_seq_cst);
+
+			u64 written = 0;
+			line.clear();
+			while (m_Queue.try_pop(record))
+			{
+				if (record.level == None)
+				{
+					line += record.message();
+				} else
+				{
+					fmt::format_to(
+						std::back_inserter(line),
+						"{}[{:%H:%M:%S}][{}]{}: {}\n",
+						LogLevelStr(record.level),
+						std::chrono::round<std::chrono::seconds>(record.time),
+						record.name,
+						NA_COLOR_RSET,
+						record.message()
+					);
+				}
+				record.long_text.clear();
+				written++;
+
+				// keeps a burst from holding everything back until the queue runs dry
+				if (line.size() >= 64 * 1024)
+					break;
+			}
+
+			if (written)
+			{
+				m_Stream->write(line.data(), line.size());
+				m_Stream->flush();
+				m_Written.fetch_add(written, std::memory_order_release);
+				continue;
+			}
+
+			if (m_Stop.load(std::memory_order_acquire))
+				break;
+
+			m_Sleeping.store(true, std::memory_order_seq_cst);
+			if (m_Queue.size() == 0 && !m_Stop.load(std::memory_order_seq_cst))
+				m_Epoch.wait(epoch, std::memory_order_seq_cst);
+			m_Sleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+} // namespace Na
\ No newline at end of file
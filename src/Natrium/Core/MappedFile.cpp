@@ -0,0 +1,120 @@
+#include "Pch.hpp"
+#include "Natrium/Core/MappedFile.hpp"
+
+#if defined(NA_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(NA_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // NA_PLATFORM_WINDOWS
+
+namespace Na {
+	void MappedFile::open(const std::filesystem::path& path)
+	{
+		if (m_Data)
+			this->close();
+
+	#if defined(NA_PLATFORM_WINDOWS)
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: Could not open file!", path.string()));
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: Could not query file size!", path.string()));
+		}
+
+		if (!size.QuadPart)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			if (mapping)
+				CloseHandle(mapping);
+			CloseHandle(file);
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: Could not map file!", path.string()));
+		}
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Data = (const Byte*)data;
+		m_Size = (u64)size.QuadPart;
+	#elif defined(NA_PLATFORM_LINUX)
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: {}!", path.string(), strerror(errno)));
+
+		struct stat info;
+		if (fstat(file, &info))
+		{
+			::close(file);
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: {}!", path.string(), strerror(errno)));
+		}
+
+		if (!info.st_size)
+		{
+			::close(file);
+			return;
+		}
+
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file); // the mapping keeps its own reference
+		if (data == MAP_FAILED)
+			throw std::runtime_error(NA_FORMAT("Failed to map {}: {}!", path.string(), strerror(errno)));
+
+		// assets are mostly read front to back once
+		madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+		m_Data = (const Byte*)data;
+		m_Size = (u64)info.st_size;
+	#endif
+	}
+
+	void MappedFile::close(void)
+	{
+		if (!m_Data)
+			return;
+
+	#if defined(NA_PLATFORM_WINDOWS)
+		UnmapViewOfFile(m_Data);
+		CloseHandle((HANDLE)m_Mapping);
+		CloseHandle((HANDLE)m_File);
+		m_Mapping = nullptr;
+		m_File = nullptr;
+	#elif defined(NA_PLATFORM_LINUX)
+		munmap((void*)m_Data, (size_t)m_Size);
+	#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	MappedFile::MappedFile(MappedFile&& other)
+	: m_Data(std::exchange(other.m_Data, nullptr)),
+	m_Size(std::exchange(other.m_Size, 0))
+	#if defined(NA_PLATFORM_WINDOWS)
+	, m_File(std::exchange(other.m_File, nullptr)),
+	m_Mapping(std::exchange(other.m_Mapping, nullptr))
+	#endif
+	{}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other)
+	{
+		this->close();
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+	#if defined(NA_PLATFORM_WINDOWS)
+		m_File = std::exchange(other.m_File, nullptr);
+		m_Mapping = std::exchange(other.m_Mapping, nullptr);
+	#endif
+		return *this;
+	}
+} // namespace Na
\ No newline at end of file
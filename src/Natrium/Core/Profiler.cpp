@@ -0,0 +1,203 @@
+#include "Pch.hpp"
+#include "Natrium/Core/Profiler.hpp"
+
+namespace Na {
+	struct ProfileThreadBuffer {
+		u32 thread_id = 0;
+		std::string thread_name;
+
+		std::atomic<u64> head = 0; // zones ever recorded, only written by the owning thread
+		ProfileZoneRecord zones[Profiler::k_ThreadCapacity];
+	};
+
+	// buffers outlive their threads so their zones can still be collected
+	static std::mutex threadBuffersMutex;
+	static std::vector<std::unique_ptr<ProfileThreadBuffer>> threadBuffers;
+
+	static thread_local ProfileThreadBuffer* threadBuffer = nullptr;
+
+	static ProfileThreadBuffer& getThreadBuffer(void)
+	{
+		if (threadBuffer)
+			return *threadBuffer;
+
+		std::lock_guard lock(threadBuffersMutex);
+
+		auto& buffer = threadBuffers.emplace_back(std::make_unique<ProfileThreadBuffer>());
+		buffer->thread_id = (u32)threadBuffers.size() - 1;
+		buffer->thread_name = NA_FORMAT("Thread #{}", buffer->thread_id);
+
+		return *(threadBuffer = buffer.get());
+	}
+
+	void Profiler::Record(const char* name, u64 start, u64 end)
+	{
+		ProfileThreadBuffer& buffer = getThreadBuffer();
+
+		u64 head = buffer.head.load(std::memory_order_relaxed);
+		buffer.zones[head % k_ThreadCapacity] = { name, start, end };
+		buffer.head.store(head + 1, std::memory_order_release);
+	}
+
+	void Profiler::SetThreadName(std::string_view name)
+	{
+		ProfileThreadBuffer& buffer = getThreadBuffer();
+
+		std::lock_guard lock(threadBuffersMutex);
+		buffer.thread_name = name;
+	}
+
+	std::vector<ProfileThreadSnapshot> Profiler::Collect(void)
+	{
+		std::lock_guard lock(threadBuffersMutex);
+
+		std::vector<ProfileThreadSnapshot> snapshots;
+		snapshots.reserve(threadBuffers.size());
+
+		for (const auto& buffer : threadBuffers)
+		{
+			ProfileThreadSnapshot& snapshot = snapshots.emplace_back();
+			snapshot.thread_id = buffer->thread_id;
+			snapshot.thread_name = buffer->thread_name;
+
+			u64 head = buffer->head.load(std::memory_order_acquire);
+			u64 first = head > k_ThreadCapacity ? head - k_ThreadCapacity : 0;
+
+			snapshot.zones.reserve(head - first);
+			for (u64 i = first; i < head; i++)
+				snapshot.zones.push_back(buffer->zones[i % k_ThreadCapacity]);
+
+			// zones the owning thread overwrote while they were copied, plus the slot
+			// it may be writing right now, which it only publishes afterwards
+			u64 new_head = buffer->head.load(std::memory_order_acquire);
+			u64 new_first = new_head + 1 > k_ThreadCapacity ? new_head + 1 - k_ThreadCapacity : 0;
+			if (new_first > first)
+				snapshot.zones.erase(snapshot.zones.begin(), snapshot.zones.begin() + std::min(new_first - first, head - first));
+		}
+
+		return snapshots;
+	}
+
+	static void writeJsonString(std::ofstream& file, std::string_view str)
+	{
+		file << '"';
+		for (char c : str)
+		{
+			switch (c)
+			{
+			case '"':
+				file << "\\\"";
+				break;
+			case '\\':
+				file << "\\\\";
+				break;
+			case '\b':
+				file << "\\b";
+				break;
+			case '\f':
+				file << "\\f";
+				break;
+			case '\n':
+				file << "\\n";
+				break;
+			case '\r':
+				file << "\\r";
+				break;
+			case '\t':
+				file << "\\t";
+				break;
+			default:
+				// the other control characters are invalid in json strings
+				if ((u8)c < 0x20)
+					file << NA_FORMAT("\\u{:04x}", (u8)c);
+				else
+					file << c;
+				break;
+			}
+		}
+		file << '"';
+	}
+
+	void Profiler::WriteChromeTrace(const std::filesystem::path& path)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+			throw std::runtime_error(NA_FORMAT("Failed to write chrome trace {}: Could not open file!", path.string()));
+
+		std::vector<ProfileThreadSnapshot> snapshots = Profiler::Collect();
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		bool first = true;
+		for (const ProfileThreadSnapshot& snapshot : snapshots)
+		{
+			file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << snapshot.thread_id << ",\"args\":{\"name\":";
+			writeJsonString(file, snapshot.thread_name);
+			file << "}}";
+			first = false;
+
+			for (const ProfileZoneRecord& zone : snapshot.zones)
+			{
+				// microseconds
+				file << ",\n{\"name\":";
+				writeJsonString(file, zone.name ? zone.name : "");
+				file << NA_FORMAT(
+					",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+					snapshot.thread_id,
+					(double)zone.start / 1000.0,
+					(double)(zone.end - zone.start) / 1000.0
+				);
+			}
+		}
+
+		file << "\n]}\n";
+	}
+
+	void FrameHistory::push(double frame_time)
+	{
+		u64 now = Profiler::Now();
+		if constexpr (k_ProfilingEnabled)
+			Profiler::Record("Frame", now - std::min(now, (u64)(frame_time * 1.0e+9)), now);
+
+		m_Times[m_Head] = frame_time;
+		m_Head = (m_Head + 1) % (u32)m_Times.size();
+		m_Size = std::min(m_Size + 1, (u32)m_Times.size());
+	}
+
+	double FrameHistory::min(void) const
+	{
+		if (!m_Size)
+			return 0.0;
+		return *std::min_element(m_Times.begin(), m_Times.begin() + m_Size);
+	}
+
+	double FrameHistory::max(void) const
+	{
+		if (!m_Size)
+			return 0.0;
+		return *std::max_element(m_Times.begin(), m_Times.begin() + m_Size);
+	}
+
+	double FrameHistory::average(void) const
+	{
+		if (!m_Size)
+			return 0.0;
+
+		double sum = 0.0;
+		for (u32 i = 0; i < m_Size; i++)
+			sum += m_Times[i];
+		return sum / m_Size;
+	}
+
+	double FrameHistory::percentile(double p) const
+	{
+		if (!m_Size)
+			return 0.0;
+
+		std::vector<double> times(m_Times.begin(), m_Times.begin() + m_Size);
+
+		u64 nth = (u64)std::clamp(p * (m_Size - 1) + 0.5, 0.0, (double)(m_Size - 1));
+		std::nth_element(times.begin(), times.begin() + nth, times.end());
+		return times[nth];
+	}
+} // namespace Na
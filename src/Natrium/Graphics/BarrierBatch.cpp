@@ -0,0 +1,286 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/BarrierBatch.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	static constexpr vk::AccessFlags k_WriteAccess =
+		vk::AccessFlagBits::eShaderWrite |
+		vk::AccessFlagBits::eColorAttachmentWrite |
+		vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+		vk::AccessFlagBits::eTransferWrite |
+		vk::AccessFlagBits::eHostWrite |
+		vk::AccessFlagBits::eMemoryWrite;
+
+	// the first 32 bits of the synchronization2 flags match the legacy ones
+	static inline vk::PipelineStageFlags2KHR toStages2(vk::PipelineStageFlags stages)
+	{
+		return vk::PipelineStageFlags2KHR((VkPipelineStageFlags2KHR)(VkPipelineStageFlags)stages);
+	}
+
+	static inline vk::AccessFlags2KHR toAccess2(vk::AccessFlags access)
+	{
+		return vk::AccessFlags2KHR((VkAccessFlags2KHR)(VkAccessFlags)access);
+	}
+
+	void BarrierBatch::transition(DeviceImage& image, const ImageState& state, const vk::ImageSubresourceRange& range)
+	{
+		u32 base_level = range.baseMipLevel;
+		u32 base_layer = range.baseArrayLayer;
+		u32 level_end = range.levelCount == VK_REMAINING_MIP_LEVELS ? image.mip_levels() : base_level + range.levelCount;
+		u32 layer_end = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? image.layer_count() : base_layer + range.layerCount;
+		NA_ASSERT(level_end <= image.mip_levels() && layer_end <= image.layer_count(), "Subresource range out of range!");
+
+		bool writes = bool(state.access & k_WriteAccess);
+		u64 first = m_Images.size();
+
+		for (u32 layer = base_layer; layer < layer_end; layer++)
+		{
+			u32 run_begin = k_U32Max;
+			ImageState run_src;
+
+			// a run of levels with the same state, it joins the same run of the layer before if there is one
+			auto flush = [&](u32 run_end)
+			{
+				if (run_begin == k_U32Max)
+					return;
+
+				for (u64 i = first; i < m_Images.size(); i++)
+				{
+					ImageBarrier& barrier = m_Images[i];
+					if (barrier.src == run_src
+					 && barrier.range.baseMipLevel == run_begin
+					 && barrier.range.levelCount == run_end - run_begin
+					 && barrier.range.baseArrayLayer + barrier.range.layerCount == layer)
+					{
+						barrier.range.layerCount++;
+						run_begin = k_U32Max;
+						return;
+					}
+				}
+
+				m_Images.push_back({
+					image.img,
+					vk::ImageSubresourceRange(range.aspectMask, run_begin, run_end - run_begin, layer, 1),
+					run_src,
+					state
+				});
+				run_begin = k_U32Max;
+			};
+
+			for (u32 level = base_level; level < level_end; level++)
+			{
+				ImageState& current = image._state(layer, level);
+
+				// reads in the same layout do not wait on each other, a later write waits on all of them
+				if (current.layout == state.layout && !writes && !(current.access & k_WriteAccess))
+				{
+					flush(level);
+					current.stages |= state.stages;
+					current.access |= state.access;
+					continue;
+				}
+
+				if (run_begin != k_U32Max && current != run_src)
+					flush(level);
+				if (run_begin == k_U32Max)
+				{
+					run_begin = level;
+					run_src = current;
+				}
+
+				current = state;
+			}
+
+			flush(level_end);
+		}
+	}
+
+	void BarrierBatch::image(vk::Image img, const vk::ImageSubresourceRange& range, const ImageState& src, const ImageState& dst)
+	{
+		m_Images.push_back({ img, range, src, dst });
+	}
+
+	void BarrierBatch::buffer(
+		vk::Buffer buffer,
+		vk::DeviceSize offset,
+		vk::DeviceSize size,
+		vk::PipelineStageFlags src_stages,
+		vk::AccessFlags src_access,
+		vk::PipelineStageFlags dst_stages,
+		vk::AccessFlags dst_access
+	)
+	{
+		m_Buffers.push_back({ buffer, offset, size, src_stages, dst_stages, src_access, dst_access });
+	}
+
+	void BarrierBatch::memory(
+		vk::PipelineStageFlags src_stages,
+		vk::AccessFlags src_access,
+		vk::PipelineStageFlags dst_stages,
+		vk::AccessFlags dst_access
+	)
+	{
+		m_Memory.push_back({ nullptr, 0, 0, src_stages, dst_stages, src_access, dst_access });
+	}
+
+	void BarrierBatch::record(vk::CommandBuffer cmd_buffer)
+	{
+		if (this->empty())
+			return;
+
+		if (PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2 = VkContext::GetCmdPipelineBarrier2())
+			this->_record_sync2(cmd_buffer, pipeline_barrier2);
+		else
+			this->_record_legacy(cmd_buffer);
+
+		this->clear();
+	}
+
+	void BarrierBatch::submit(void)
+	{
+		if (this->empty())
+			return;
+
+		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
+
+		this->record(cmd_buffer);
+
+		VkContext::EndSingleTimeCommands(cmd_buffer);
+	}
+
+	void BarrierBatch::clear(void)
+	{
+		m_Images.clear();
+		m_Buffers.clear();
+		m_Memory.clear();
+	}
+
+	void BarrierBatch::_record_legacy(vk::CommandBuffer cmd_buffer) const
+	{
+		vk::PipelineStageFlags src_stages;
+		vk::PipelineStageFlags dst_stages;
+
+		Na::ArrayVector<vk::MemoryBarrier> memory_barriers(m_Memory.size());
+		for (u64 i = 0; i < m_Memory.size(); i++)
+		{
+			const BufferBarrier& barrier = m_Memory[i];
+			memory_barriers[i] = vk::MemoryBarrier(barrier.src_access, barrier.dst_access);
+
+			src_stages |= barrier.src_stages;
+			dst_stages |= barrier.dst_stages;
+		}
+
+		Na::ArrayVector<vk::BufferMemoryBarrier> buffer_barriers(m_Buffers.size());
+		for (u64 i = 0; i < m_Buffers.size(); i++)
+		{
+			const BufferBarrier& barrier = m_Buffers[i];
+			buffer_barriers[i] = vk::BufferMemoryBarrier(
+				barrier.src_access,
+				barrier.dst_access,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				barrier.buffer,
+				barrier.offset,
+				barrier.size
+			);
+
+			src_stages |= barrier.src_stages;
+			dst_stages |= barrier.dst_stages;
+		}
+
+		Na::ArrayVector<vk::ImageMemoryBarrier> image_barriers(m_Images.size());
+		for (u64 i = 0; i < m_Images.size(); i++)
+		{
+			const ImageBarrier& barrier = m_Images[i];
+			image_barriers[i] = vk::ImageMemoryBarrier(
+				barrier.src.access,
+				barrier.dst.access,
+				barrier.src.layout,
+				barrier.dst.layout,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				barrier.img,
+				barrier.range
+			);
+
+			src_stages |= barrier.src.stages;
+			dst_stages |= barrier.dst.stages;
+		}
+
+		// empty stage masks are not allowed without synchronization2
+		if (!src_stages)
+			src_stages = vk::PipelineStageFlagBits::eTopOfPipe;
+		if (!dst_stages)
+			dst_stages = vk::PipelineStageFlagBits::eBottomOfPipe;
+
+		cmd_buffer.pipelineBarrier(
+			src_stages,
+			dst_stages,
+			{}, // dependency flags
+			(u32)memory_barriers.size(), memory_barriers.ptr(),
+			(u32)buffer_barriers.size(), buffer_barriers.ptr(),
+			(u32)image_barriers.size(), image_barriers.ptr()
+		);
+	}
+
+	void BarrierBatch::_record_sync2(vk::CommandBuffer cmd_buffer, PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2) const
+	{
+		Na::ArrayVector<vk::MemoryBarrier2KHR> memory_barriers(m_Memory.size());
+		for (u64 i = 0; i < m_Memory.size(); i++)
+		{
+			const BufferBarrier& barrier = m_Memory[i];
+			memory_barriers[i] = vk::MemoryBarrier2KHR(
+				toStages2(barrier.src_stages),
+				toAccess2(barrier.src_access),
+				toStages2(barrier.dst_stages),
+				toAccess2(barrier.dst_access)
+			);
+		}
+
+		Na::ArrayVector<vk::BufferMemoryBarrier2KHR> buffer_barriers(m_Buffers.size());
+		for (u64 i = 0; i < m_Buffers.size(); i++)
+		{
+			const BufferBarrier& barrier = m_Buffers[i];
+			buffer_barriers[i] = vk::BufferMemoryBarrier2KHR(
+				toStages2(barrier.src_stages),
+				toAccess2(barrier.src_access),
+				toStages2(barrier.dst_stages),
+				toAccess2(barrier.dst_access),
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				barrier.buffer,
+				barrier.offset,
+				barrier.size
+			);
+		}
+
+		Na::ArrayVector<vk::ImageMemoryBarrier2KHR> image_barriers(m_Images.size());
+		for (u64 i = 0; i < m_Images.size(); i++)
+		{
+			const ImageBarrier& barrier = m_Images[i];
+			image_barriers[i] = vk::ImageMemoryBarrier2KHR(
+				toStages2(barrier.src.stages),
+				toAccess2(barrier.src.access),
+				toStages2(barrier.dst.stages),
+				toAccess2(barrier.dst.access),
+				barrier.src.layout,
+				barrier.dst.layout,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				barrier.img,
+				barrier.range
+			);
+		}
+
+		vk::DependencyInfoKHR dependency_info;
+		dependency_info.memoryBarrierCount = (u32)memory_barriers.size();
+		dependency_info.pMemoryBarriers = memory_barriers.ptr();
+		dependency_info.bufferMemoryBarrierCount = (u32)buffer_barriers.size();
+		dependency_info.pBufferMemoryBarriers = buffer_barriers.ptr();
+		dependency_info.imageMemoryBarrierCount = (u32)image_barriers.size();
+		dependency_info.pImageMemoryBarriers = image_barriers.ptr();
+
+		pipeline_barrier2(cmd_buffer, (const VkDependencyInfoKHR*)&dependency_info);
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/BatchMath.hpp"
+
+#if defined(__AVX2__)
+#define NA_SIMD_AVX2
+#define NA_SIMD_SSE
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NA_SIMD_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define NA_SIMD_NEON
+#include <arm_neon.h>
+#endif // SIMD
+
+namespace Na::BatchMath {
+	// lanes: as many floats as the widest registers hold, for the structure of arrays kernels
+#if defined(NA_SIMD_AVX2)
+	using Lanes = __m256;
+	using LaneMask = __m256;
+	static constexpr u32 k_LaneCount = 8;
+
+	static inline Lanes lanesLoad(const float* src) { return _mm256_loadu_ps(src); }
+	static inline void lanesStore(float* dst, Lanes a) { _mm256_storeu_ps(dst, a); }
+	static inline Lanes lanesSet(float value) { return _mm256_set1_ps(value); }
+	static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+	static inline Lanes lanesSub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+	static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	#if defined(__FMA__)
+	static inline Lanes lanesMulAdd(Lanes a, Lanes b, Lanes c) { return _mm256_fmadd_ps(a, b, c); }
+	#else
+	static inline Lanes lanesMulAdd(Lanes a, Lanes b, Lanes c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+	#endif // __FMA__
+	static inline LaneMask lanesGreaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline LaneMask maskAll(void) { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+	static inline LaneMask maskAnd(LaneMask a, LaneMask b) { return _mm256_and_ps(a, b); }
+	static inline u32 maskBits(LaneMask mask) { return (u32)_mm256_movemask_ps(mask); }
+#elif defined(NA_SIMD_SSE)
+	using Lanes = __m128;
+	using LaneMask = __m128;
+	static constexpr u32 k_LaneCount = 4;
+
+	static inline Lanes lanesLoad(const float* src) { return _mm_loadu_ps(src); }
+	static inline void lanesStore(float* dst, Lanes a) { _mm_storeu_ps(dst, a); }
+	static inline Lanes lanesSet(float value) { return _mm_set1_ps(value); }
+	static inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	static inline Lanes lanesSub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+	static inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	static inline Lanes lanesMulAdd(Lanes a, Lanes b, Lanes c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static inline LaneMask lanesGreaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+	static inline LaneMask maskAll(void) { __m128 zero = _mm_setzero_ps(); return _mm_cmpeq_ps(zero, zero); }
+	static inline LaneMask maskAnd(LaneMask a, LaneMask b) { return _mm_and_ps(a, b); }
+	static inline u32 maskBits(LaneMask mask) { return (u32)_mm_movemask_ps(mask); }
+#elif defined(NA_SIMD_NEON)
+	using Lanes = float32x4_t;
+	using LaneMask = uint32x4_t;
+	static constexpr u32 k_LaneCount = 4;
+
+	static inline Lanes lanesLoad(const float* src) { return vld1q_f32(src); }
+	static inline void lanesStore(float* dst, Lanes a) { vst1q_f32(dst, a); }
+	static inline Lanes lanesSet(float value) { return vdupq_n_f32(value); }
+	static inline Lanes lanesAdd(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+	static inline Lanes lanesSub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+	static inline Lanes lanesMul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+	static inline Lanes lanesMulAdd(Lanes a, Lanes b, Lanes c) { return vfmaq_f32(c, a, b); }
+	static inline LaneMask lanesGreaterEqual(Lanes a, Lanes b) { return vcgeq_f32(a, b); }
+	static inline LaneMask maskAll(void) { return vdupq_n_u32(~0u); }
+	static inline LaneMask maskAnd(LaneMask a, LaneMask b) { return vandq_u32(a, b); }
+	static inline u32 maskBits(LaneMask mask)
+	{
+		static const u32 k_Bits[4] = { 1, 2, 4, 8 };
+		return vaddvq_u32(vandq_u32(mask, vld1q_u32(k_Bits)));
+	}
+#else
+	using Lanes = float;
+	using LaneMask = bool;
+	static constexpr u32 k_LaneCount = 1;
+
+	static inline Lanes lanesLoad(const float* src) { return *src; }
+	static inline void lanesStore(float* dst, Lanes a) { *dst = a; }
+	static inline Lanes lanesSet(float value) { return value; }
+	static inline Lanes lanesAdd(Lanes a, Lanes b) { return a + b; }
+	static inline Lanes lanesSub(Lanes a, Lanes b) { return a - b; }
+	static inline Lanes lanesMul(Lanes a, Lanes b) { return a * b; }
+	static inline Lanes lanesMulAdd(Lanes a, Lanes b, Lanes c) { return a * b + c; }
+	static inline LaneMask lanesGreaterEqual(Lanes a, Lanes b) { return a >= b; }
+	static inline LaneMask maskAll(void) { return true; }
+	static inline LaneMask maskAnd(LaneMask a, LaneMask b) { return a && b; }
+	static inline u32 maskBits(LaneMask mask) { return mask; }
+#endif // lanes
+
+	// quads: one column or vector of 4 floats, for the kernels over glm types
+#if defined(NA_SIMD_SSE)
+	using Quad = __m128;
+
+	static inline Quad quadLoad(const float* src) { return _mm_loadu_ps(src); }
+	static inline void quadStore(float* dst, Quad a) { _mm_storeu_ps(dst, a); }
+	static inline Quad quadSet(float value) { return _mm_set1_ps(value); }
+	static inline Quad quadAdd(Quad a, Quad b) { return _mm_add_ps(a, b); }
+	static inline Quad quadSub(Quad a, Quad b) { return _mm_sub_ps(a, b); }
+	static inline Quad quadMulAdd(Quad a, Quad b, Quad c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static inline Quad quadMul(Quad a, Quad b) { return _mm_mul_ps(a, b); }
+	static inline Quad quadAbs(Quad a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+#elif defined(NA_SIMD_NEON)
+	using Quad = float32x4_t;
+
+	static inline Quad quadLoad(const float* src) { return vld1q_f32(src); }
+	static inline void quadStore(float* dst, Quad a) { vst1q_f32(dst, a); }
+	static inline Quad quadSet(float value) { return vdupq_n_f32(value); }
+	static inline Quad quadAdd(Quad a, Quad b) { return vaddq_f32(a, b); }
+	static inline Quad quadSub(Quad a, Quad b) { return vsubq_f32(a, b); }
+	static inline Quad quadMulAdd(Quad a, Quad b, Quad c) { return vfmaq_f32(c, a, b); }
+	static inline Quad quadMul(Quad a, Quad b) { return vmulq_f32(a, b); }
+	static inline Quad quadAbs(Quad a) { return vabsq_f32(a); }
+#else
+	using Quad = glm::vec4;
+
+	static inline Quad quadLoad(const float* src) { return Quad(src[0], src[1], src[2], src[3]); }
+	static inline void quadStore(float* dst, Quad a) { memcpy(dst, &a, sizeof(a)); }
+	static inline Quad quadSet(float value) { return Quad(value); }
+	static inline Quad quadAdd(Quad a, Quad b) { return a + b; }
+	static inline Quad quadSub(Quad a, Quad b) { return a - b; }
+	static inline Quad quadMulAdd(Quad a, Quad b, Quad c) { return a * b + c; }
+	static inline Quad quadMul(Quad a, Quad b) { return a * b; }
+	static inline Quad quadAbs(Quad a) { return glm::abs(a); }
+#endif // quads
+
+	// the 12 non constant entries of the matrix, column major, for k_LaneCount transforms
+	static inline void composeLanes(const TransformStreams& transforms, u64 first, Lanes (&entries)[12])
+	{
+		Lanes x = lanesLoad(transforms.rotation[0] + first);
+		Lanes y = lanesLoad(transforms.rotation[1] + first);
+		Lanes z = lanesLoad(transforms.rotation[2] + first);
+		Lanes w = lanesLoad(transforms.rotation[3] + first);
+
+		Lanes x2 = lanesAdd(x, x);
+		Lanes y2 = lanesAdd(y, y);
+		Lanes z2 = lanesAdd(z, z);
+
+		Lanes xx = lanesMul(x, x2), yy = lanesMul(y, y2), zz = lanesMul(z, z2);
+		Lanes xy = lanesMul(x, y2), xz = lanesMul(x, z2), yz = lanesMul(y, z2);
+		Lanes wx = lanesMul(w, x2), wy = lanesMul(w, y2), wz = lanesMul(w, z2);
+
+		Lanes one = lanesSet(1.0f);
+		Lanes scale_x = lanesLoad(transforms.scale[0] + first);
+		Lanes scale_y = lanesLoad(transforms.scale[1] + first);
+		Lanes scale_z = lanesLoad(transforms.scale[2] + first);
+
+		entries[0] = lanesMul(lanesSub(one, lanesAdd(yy, zz)), scale_x);
+		entries[1] = lanesMul(lanesAdd(xy, wz), scale_x);
+		entries[2] = lanesMul(lanesSub(xz, wy), scale_x);
+
+		entries[3] = lanesMul(lanesSub(xy, wz), scale_y);
+		entries[4] = lanesMul(lanesSub(one, lanesAdd(xx, zz)), scale_y);
+		entries[5] = lanesMul(lanesAdd(yz, wx), scale_y);
+
+		entries[6] = lanesMul(lanesAdd(xz, wy), scale_z);
+		entries[7] = lanesMul(lanesSub(yz, wx), scale_z);
+		entries[8] = lanesMul(lanesSub(one, lanesAdd(xx, yy)), scale_z);
+
+		entries[9] = lanesLoad(transforms.position[0] + first);
+		entries[10] = lanesLoad(transforms.position[1] + first);
+		entries[11] = lanesLoad(transforms.position[2] + first);
+	}
+
+	static inline void composeOne(const TransformStreams& transforms, u64 i, glm::mat4& dst)
+	{
+		float x = transforms.rotation[0][i], y = transforms.rotation[1][i], z = transforms.rotation[2][i], w = transforms.rotation[3][i];
+		float scale_x = transforms.scale[0][i], scale_y = transforms.scale[1][i], scale_z = transforms.scale[2][i];
+
+		float xx = 2.0f * x * x, yy = 2.0f * y * y, zz = 2.0f * z * z;
+		float xy = 2.0f * x * y, xz = 2.0f * x * z, yz = 2.0f * y * z;
+		float wx = 2.0f * w * x, wy = 2.0f * w * y, wz = 2.0f * w * z;
+
+		dst[0] = glm::vec4((1.0f - yy - zz) * scale_x, (xy + wz) * scale_x, (xz - wy) * scale_x, 0.0f);
+		dst[1] = glm::vec4((xy - wz) * scale_y, (1.0f - xx - zz) * scale_y, (yz + wx) * scale_y, 0.0f);
+		dst[2] = glm::vec4((xz + wy) * scale_z, (yz - wx) * scale_z, (1.0f - xx - yy) * scale_z, 0.0f);
+		dst[3] = glm::vec4(transforms.position[0][i], transforms.position[1][i], transforms.position[2][i], 1.0f);
+	}
+
+	void ComposeTransforms(const TransformStreams& transforms, glm::mat4* dst, u64 count)
+	{
+		u64 i = 0;
+		for (; i + k_LaneCount <= count; i += k_LaneCount)
+		{
+			Lanes entries[12];
+			composeLanes(transforms, i, entries);
+
+			float columns[12][k_LaneCount];
+			for (u32 entry = 0; entry < 12; entry++)
+				lanesStore(columns[entry], entries[entry]);
+
+			// written whole and in order, so mapped memory sees full matrices
+			for (u32 lane = 0; lane < k_LaneCount; lane++)
+			{
+				float matrix[16] = {
+					columns[0][lane], columns[1][lane], columns[2][lane], 0.0f,
+					columns[3][lane], columns[4][lane], columns[5][lane], 0.0f,
+					columns[6][lane], columns[7][lane], columns[8][lane], 0.0f,
+					columns[9][lane], columns[10][lane], columns[11][lane], 1.0f
+				};
+				memcpy(dst + i + lane, matrix, sizeof(matrix));
+			}
+		}
+
+		for (; i < count; i++)
+			composeOne(transforms, i, dst[i]);
+	}
+
+	void MultiplyMatrices(const glm::mat4& lhs, const glm::mat4* rhs, glm::mat4* dst, u64 count)
+	{
+		Quad lhs_columns[4];
+		for (u32 column = 0; column < 4; column++)
+			lhs_columns[column] = quadLoad(&lhs[column][0]);
+
+		for (u64 i = 0; i < count; i++)
+		{
+			// each column only reads the same column of rhs, so dst may be rhs
+			const float* src = &rhs[i][0][0];
+			float* out = &dst[i][0][0];
+
+			for (u32 column = 0; column < 4; column++)
+			{
+				const float* src_column = src + column * 4;
+
+				Quad result = quadMul(lhs_columns[0], quadSet(src_column[0]));
+				result = quadMulAdd(lhs_columns[1], quadSet(src_column[1]), result);
+				result = quadMulAdd(lhs_columns[2], quadSet(src_column[2]), result);
+				result = quadMulAdd(lhs_columns[3], quadSet(src_column[3]), result);
+
+				quadStore(out + column * 4, result);
+			}
+		}
+	}
+
+	void TransformBoxes(const glm::mat4* transforms, const BoundingBox* src, BoundingBox* dst, u64 count)
+	{
+		for (u64 i = 0; i < count; i++)
+		{
+			const float* matrix = &transforms[i][0][0];
+			Quad column_x = quadLoad(matrix + 0);
+			Quad column_y = quadLoad(matrix + 4);
+			Quad column_z = quadLoad(matrix + 8);
+			Quad column_w = quadLoad(matrix + 12);
+
+			glm::vec3 center = src[i].center();
+			glm::vec3 extent = src[i].extent();
+
+			Quad new_center = quadMulAdd(column_x, quadSet(center.x), column_w);
+			new_center = quadMulAdd(column_y, quadSet(center.y), new_center);
+			new_center = quadMulAdd(column_z, quadSet(center.z), new_center);
+
+			// every axis of the box contributes its absolute projection onto the new axes
+			Quad new_extent = quadMul(quadAbs(column_x), quadSet(extent.x));
+			new_extent = quadMulAdd(quadAbs(column_y), quadSet(extent.y), new_extent);
+			new_extent = quadMulAdd(quadAbs(column_z), quadSet(extent.z), new_extent);
+
+			float box_min[4], box_max[4];
+			quadStore(box_min, quadSub(new_center, new_extent));
+			quadStore(box_max, quadAdd(new_center, new_extent));
+
+			dst[i] = BoundingBox{
+				glm::vec3(box_min[0], box_min[1], box_min[2]),
+				glm::vec3(box_max[0], box_max[1], box_max[2])
+			};
+		}
+	}
+
+	u64 CullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius, u64 count, u8* visible)
+	{
+		Lanes planes[Frustum::Count][4];
+		for (u32 p = 0; p < Frustum::Count; p++)
+		{
+			const glm::vec4& plane = frustum.plane((Frustum::Plane)p);
+			for (u32 k = 0; k < 4; k++)
+				planes[p][k] = lanesSet(plane[k]);
+		}
+
+		const Lanes zero = lanesSet(0.0f);
+		u64 visible_count = 0;
+
+		u64 i = 0;
+		for (; i + k_LaneCount <= count; i += k_LaneCount)
+		{
+			Lanes lanes_x = lanesLoad(x + i);
+			Lanes lanes_y = lanesLoad(y + i);
+			Lanes lanes_z = lanesLoad(z + i);
+			Lanes lanes_radius = lanesLoad(radius + i);
+
+			// distance + radius >= 0 for every plane
+			LaneMask inside = maskAll();
+			for (u32 p = 0; p < Frustum::Count; p++)
+			{
+				Lanes distance = lanesAdd(planes[p][3], lanes_radius);
+				distance = lanesMulAdd(lanes_x, planes[p][0], distance);
+				distance = lanesMulAdd(lanes_y, planes[p][1], distance);
+				distance = lanesMulAdd(lanes_z, planes[p][2], distance);
+				inside = maskAnd(inside, lanesGreaterEqual(distance, zero));
+			}
+
+			u32 bits = maskBits(inside);
+			for (u32 lane = 0; lane < k_LaneCount; lane++)
+			{
+				visible[i + lane] = (bits >> lane) & 1;
+				visible_count += visible[i + lane];
+			}
+		}
+
+		for (; i < count; i++)
+		{
+			bool inside = true;
+			for (u32 p = 0; p < Frustum::Count && inside; p++)
+			{
+				const glm::vec4& plane = frustum.plane((Frustum::Plane)p);
+				inside = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w + radius[i] >= 0.0f;
+			}
+
+			visible[i] = inside;
+			visible_count += inside;
+		}
+
+		return visible_count;
+	}
+} // namespace Na::BatchMath
\ No newline at end of file
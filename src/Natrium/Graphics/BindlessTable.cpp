@@ -0,0 +1,186 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/BindlessTable.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	static vk::PhysicalDeviceDescriptorIndexingPropertiesEXT getDescriptorIndexingProperties(void)
+	{
+		vk::PhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties;
+		vk::PhysicalDeviceProperties2KHR properties;
+		properties.pNext = &indexing_properties;
+
+		// VK_KHR_get_physical_device_properties2 is not part of a vulkan 1.0 loader's exports
+		auto func = (PFN_vkGetPhysicalDeviceProperties2KHR)vkGetInstanceProcAddr(VkContext::GetInstance(), "vkGetPhysicalDeviceProperties2KHR");
+		NA_VERIFY(func, "Failed to create bindless table: vkGetPhysicalDeviceProperties2KHR is not available!");
+		func(VkContext::GetPhysicalDevice(), (VkPhysicalDeviceProperties2*)&properties);
+
+		return indexing_properties;
+	}
+
+	BindlessTable::BindlessTable(u32 texture_capacity, u32 storage_buffer_capacity)
+	{
+		NA_VERIFY(VkContext::GetDeviceFeatures().descriptor_indexing, "Failed to create bindless table: Descriptor indexing is not supported!");
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		vk::PhysicalDeviceDescriptorIndexingPropertiesEXT limits = getDescriptorIndexingProperties();
+
+		texture_capacity = std::min({
+			texture_capacity,
+			limits.maxDescriptorSetUpdateAfterBindSampledImages,
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			limits.maxDescriptorSetUpdateAfterBindSamplers,
+			limits.maxPerStageDescriptorUpdateAfterBindSamplers
+		});
+		storage_buffer_capacity = std::min({
+			storage_buffer_capacity,
+			limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+			limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+		});
+
+		// both bindings count towards the per stage resource limit, textures get the larger share
+		u32 resource_limit = limits.maxPerStageUpdateAfterBindResources;
+		if ((u64)texture_capacity + storage_buffer_capacity > resource_limit)
+		{
+			storage_buffer_capacity = std::min(storage_buffer_capacity, resource_limit / 4);
+			texture_capacity = std::min(texture_capacity, resource_limit - storage_buffer_capacity);
+		}
+
+		m_Textures = RangeAllocator(texture_capacity);
+		m_StorageBuffers = RangeAllocator(storage_buffer_capacity);
+
+		std::array<vk::DescriptorSetLayoutBinding, 2> bindings;
+		bindings[k_TextureBinding].binding = k_TextureBinding;
+		bindings[k_TextureBinding].descriptorType = vk::DescriptorType::eCombinedImageSampler;
+		bindings[k_TextureBinding].descriptorCount = texture_capacity;
+		bindings[k_TextureBinding].stageFlags = vk::ShaderStageFlagBits::eAll;
+
+		bindings[k_StorageBufferBinding].binding = k_StorageBufferBinding;
+		bindings[k_StorageBufferBinding].descriptorType = vk::DescriptorType::eStorageBuffer;
+		bindings[k_StorageBufferBinding].descriptorCount = storage_buffer_capacity;
+		bindings[k_StorageBufferBinding].stageFlags = vk::ShaderStageFlagBits::eAll;
+
+		// unused entries never have to be valid, used ones may be written while the set is bound
+		vk::DescriptorBindingFlagsEXT binding_flags =
+			vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind |
+			vk::DescriptorBindingFlagBitsEXT::eUpdateUnusedWhilePending |
+			vk::DescriptorBindingFlagBitsEXT::ePartiallyBound;
+		std::array<vk::DescriptorBindingFlagsEXT, 2> flags = { binding_flags, binding_flags };
+
+		vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT flags_info;
+		flags_info.bindingCount = (u32)flags.size();
+		flags_info.pBindingFlags = flags.data();
+
+		vk::DescriptorSetLayoutCreateInfo layout_info;
+		layout_info.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT;
+		layout_info.bindingCount = (u32)bindings.size();
+		layout_info.pBindings = bindings.data();
+		layout_info.pNext = &flags_info;
+
+		m_Layout = logical_device.createDescriptorSetLayout(layout_info);
+
+		std::array<vk::DescriptorPoolSize, 2> pool_sizes = {
+			vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, texture_capacity),
+			vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, storage_buffer_capacity)
+		};
+
+		vk::DescriptorPoolCreateInfo pool_info;
+		pool_info.flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT;
+		pool_info.maxSets = 1;
+		pool_info.poolSizeCount = (u32)pool_sizes.size();
+		pool_info.pPoolSizes = pool_sizes.data();
+
+		m_Pool = logical_device.createDescriptorPool(pool_info);
+
+		vk::DescriptorSetAllocateInfo alloc_info;
+		alloc_info.descriptorPool = m_Pool;
+		alloc_info.descriptorSetCount = 1;
+		alloc_info.pSetLayouts = &m_Layout;
+
+		vk::Result result = logical_device.allocateDescriptorSets(&alloc_info, &m_DescriptorSet);
+		NA_VERIFY_VK(result, "Failed to allocate bindless descriptor set!");
+
+		g_Logger.fmt(Info, "Bindless table holds {} textures and {} storage buffers", texture_capacity, storage_buffer_capacity);
+	}
+
+	void BindlessTable::destroy(void)
+	{
+		if (!m_Layout)
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		logical_device.destroyDescriptorPool(m_Pool);
+		m_Pool = nullptr;
+		m_DescriptorSet = nullptr;
+
+		logical_device.destroyDescriptorSetLayout(m_Layout);
+		m_Layout = nullptr;
+	}
+
+	BindlessIndex BindlessTable::add_texture(vk::ImageView img_view, vk::Sampler sampler)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		BindlessIndex index = m_Textures.allocate(1);
+		NA_VERIFY(index != k_NullBindlessIndex, "Failed to add texture to bindless table: All {} entries are in use!", m_Textures.capacity());
+
+		vk::DescriptorImageInfo image_info(sampler, img_view, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+		vk::WriteDescriptorSet descriptor_write;
+		descriptor_write.dstSet = m_DescriptorSet;
+		descriptor_write.dstBinding = k_TextureBinding;
+		descriptor_write.dstArrayElement = index;
+		descriptor_write.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+		descriptor_write.descriptorCount = 1;
+		descriptor_write.pImageInfo = &image_info;
+
+		VkContext::GetLogicalDevice().updateDescriptorSets(1, &descriptor_write, 0, nullptr);
+
+		return index;
+	}
+
+	BindlessIndex BindlessTable::add_storage_buffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range, u32 count)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		BindlessIndex index = m_StorageBuffers.allocate(count);
+		NA_VERIFY(index != k_NullBindlessIndex, "Failed to add storage buffer to bindless table: Less than {} of {} entries are free!", count, m_StorageBuffers.capacity());
+
+		Na::ArrayVector<vk::DescriptorBufferInfo> buffer_infos(count);
+		for (u32 i = 0; i < count; i++)
+			buffer_infos[i] = vk::DescriptorBufferInfo(buffer, offset + i * range, range);
+
+		vk::WriteDescriptorSet descriptor_write;
+		descriptor_write.dstSet = m_DescriptorSet;
+		descriptor_write.dstBinding = k_StorageBufferBinding;
+		descriptor_write.dstArrayElement = index;
+		descriptor_write.descriptorType = vk::DescriptorType::eStorageBuffer;
+		descriptor_write.descriptorCount = count;
+		descriptor_write.pBufferInfo = buffer_infos.ptr();
+
+		VkContext::GetLogicalDevice().updateDescriptorSets(1, &descriptor_write, 0, nullptr);
+
+		return index;
+	}
+
+	// the stale descriptors stay, partially bound entries are only validated when used
+	void BindlessTable::remove_texture(BindlessIndex index)
+	{
+		// frames in flight may still read the descriptor, it is only rewritten once they completed
+		VkContext::GetDeletionQueue().defer([this, index](void)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Textures.free(index, 1);
+		});
+	}
+
+	void BindlessTable::remove_storage_buffer(BindlessIndex index, u32 count)
+	{
+		VkContext::GetDeletionQueue().defer([this, index, count](void)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_StorageBuffers.free(index, count);
+		});
+	}
+} // namespace Na
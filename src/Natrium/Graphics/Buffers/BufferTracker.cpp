@@ -0,0 +1,74 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Buffers/BufferTracker.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	BufferTracker::BufferTracker(u64 size, u32 frame_count)
+	: m_Data(size, 0), m_Pending(frame_count)
+	{
+		// the regions start out with whatever the memory held
+		for (std::vector<Range>& ranges : m_Pending)
+			ranges.push_back(Range{ 0, size });
+	}
+
+	void BufferTracker::write(const void* data, u64 size, u64 offset)
+	{
+		NA_ASSERT(offset + size <= m_Data.size(), "Failed to write tracked buffer: Range exceeds the buffer!");
+		if (!size)
+			return;
+
+		memcpy(m_Data.data() + offset, data, size);
+
+		for (std::vector<Range>& ranges : m_Pending)
+			_add_range(ranges, Range{ offset, offset + size });
+	}
+
+	u64 BufferTracker::sync(const DeviceBuffer& buffer, u64 region_offset, u32 frame_index)
+	{
+		std::vector<Range>& ranges = m_Pending[frame_index];
+		if (ranges.empty())
+			return 0;
+
+		Byte* mapped = (Byte*)buffer.mapped() + region_offset;
+		DeviceAllocator& allocator = VkContext::GetDeviceAllocator();
+
+		u64 copied = 0;
+		for (const Range& range : ranges)
+		{
+			memcpy(mapped + range.begin, m_Data.data() + range.begin, range.end - range.begin);
+			allocator.flush(buffer.allocation, region_offset + range.begin, range.end - range.begin);
+			copied += range.end - range.begin;
+		}
+
+		ranges.clear();
+		return copied;
+	}
+
+	void BufferTracker::_add_range(std::vector<Range>& ranges, Range range)
+	{
+		// the first range that ends at or after the new one begins, everything before stays
+		auto first = std::lower_bound(
+			ranges.begin(), ranges.end(), range.begin,
+			[](const Range& existing, u64 begin) -> bool { return existing.end < begin; }
+		);
+
+		auto last = first;
+		while (last != ranges.end() && last->begin <= range.end)
+		{
+			range.begin = std::min(range.begin, last->begin);
+			range.end = std::max(range.end, last->end);
+			last++;
+		}
+
+		first = ranges.erase(first, last);
+		ranges.insert(first, range);
+
+		// one big copy beats walking a long list every frame
+		if (ranges.size() > k_MaxRanges)
+		{
+			Range merged{ ranges.front().begin, ranges.back().end };
+			ranges.assign(1, merged);
+		}
+	}
+} // namespace Na
\ No newline at end of file
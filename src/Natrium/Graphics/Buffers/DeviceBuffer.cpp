@@ -6,13 +6,18 @@
 namespace Na {
 	u32 FindMemoryType(u32 typeFilter, vk::MemoryPropertyFlags properties)
 	{
-		vk::PhysicalDeviceMemoryProperties memory_properties = VkContext::GetPhysicalDevice().getMemoryProperties();
+		u32 memory_type = VkContext::GetDeviceAllocator().find_memory_type(typeFilter, properties);
+		return memory_type != k_U32Max ? memory_type : 0;
+	}
 
-		for (u32 i = 0; i < memory_properties.memoryTypeCount; i++)
-			if ((typeFilter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
-				return i;
+	vk::MemoryPropertyFlags HostMemoryProperties(BufferUpdateRate update_rate)
+	{
+		// tracked buffers read back nothing, cached memory only makes the copies cheaper
+		constexpr vk::MemoryPropertyFlags k_Cached = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached;
+		if (update_rate == BufferUpdateRate::Tracked && VkContext::GetDeviceAllocator().find_memory_type(k_U32Max, k_Cached) != k_U32Max)
+			return k_Cached;
 
-		return 0;
+		return vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
 	}
 
 	DeviceBuffer::DeviceBuffer(
@@ -30,24 +35,44 @@ namespace Na {
 		buffer_info.usage = usage;
 		buffer_info.sharingMode = sharing_mode;
 
+		// concurrent buffers are shared between every queue family the context uses
+		std::array<u32, 3> queue_families;
+		if (sharing_mode == vk::SharingMode::eConcurrent)
+		{
+			QueueFamilyIndices indices = VkContext::GetQueueFamilyIndices();
+
+			u32 family_count = 0;
+			for (u32 family : { indices.graphics, indices.transfer, indices.compute })
+				if (std::find(queue_families.begin(), queue_families.begin() + family_count, family) == queue_families.begin() + family_count)
+					queue_families[family_count++] = family;
+
+			if (family_count > 1)
+			{
+				buffer_info.queueFamilyIndexCount = family_count;
+				buffer_info.pQueueFamilyIndices = queue_families.data();
+			} else
+			{
+				buffer_info.sharingMode = vk::SharingMode::eExclusive;
+			}
+		}
+
 		this->buffer = logical_device.createBuffer(buffer_info);
 
 		vk::MemoryRequirements memory_requirements = logical_device.getBufferMemoryRequirements(this->buffer);
 
-		vk::MemoryAllocateInfo alloc_info;
-		alloc_info.allocationSize = memory_requirements.size;
-		alloc_info.memoryTypeIndex = FindMemoryType(memory_requirements.memoryTypeBits, properties);
-
-		this->memory = logical_device.allocateMemory(alloc_info);
-		logical_device.bindBufferMemory(this->buffer, this->memory, 0);
+		this->allocation = VkContext::GetDeviceAllocator().allocate(
+			memory_requirements,
+			properties,
+			true,
+			DeviceMemoryCategoryOf(buffer_info.usage)
+		);
+		logical_device.bindBufferMemory(this->buffer, this->allocation.memory, this->allocation.offset);
 	}
 
 	void DeviceBuffer::destroy(void)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-
-		logical_device.destroyBuffer(this->buffer);
-		logical_device.freeMemory(this->memory);
+		// pending frames may still read it
+		VkContext::GetDeletionQueue().push(this->buffer, this->allocation);
 
 		memset(this, 0, sizeof(DeviceBuffer));
 	}
@@ -69,7 +94,7 @@ namespace Na {
 	DeviceBuffer::DeviceBuffer(DeviceBuffer&& other)
 	: buffer(std::exchange(other.buffer, nullptr)),
 	size(std::exchange(other.size, 0)),
-	memory(std::exchange(other.memory, nullptr))
+	allocation(std::exchange(other.allocation, {}))
 	{}
 
 	DeviceBuffer& DeviceBuffer::operator=(DeviceBuffer&& other)
@@ -77,7 +102,7 @@ namespace Na {
 		this->destroy();
 		this->buffer = std::exchange(other.buffer, nullptr);
 		this->size = std::exchange(other.size, 0);
-		this->memory = std::exchange(other.memory, nullptr);
+		this->allocation = std::exchange(other.allocation, {});
 		return *this;
 	}
 
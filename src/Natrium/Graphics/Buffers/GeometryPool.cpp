@@ -0,0 +1,169 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Buffers/GeometryPool.hpp"
+
+#include "Natrium/Graphics/Buffers/IndexBuffer.hpp"
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	GeometryPool::GeometryPool(
+		u32 vertex_stride,
+		u32 vertex_capacity,
+		u32 index_capacity,
+		vk::IndexType index_type
+	)
+	: m_VertexBuffer(
+		(vk::DeviceSize)vertex_capacity * vertex_stride,
+		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+		vk::MemoryPropertyFlagBits::eDeviceLocal
+	),
+	m_IndexBuffer(
+		(vk::DeviceSize)index_capacity * IndexSize(index_type),
+		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+		vk::MemoryPropertyFlagBits::eDeviceLocal
+	),
+	m_VertexStride(vertex_stride),
+	m_IndexType(index_type),
+	m_Ranges(std::make_shared<Ranges>())
+	{
+		NA_ASSERT(vertex_stride && vertex_capacity && index_capacity, "Failed to create GeometryPool: Stride and capacities must not be 0!");
+		NA_ASSERT(index_type == vk::IndexType::eUint32 || index_type == vk::IndexType::eUint16, "Failed to create GeometryPool: Unsupported index type!");
+
+		m_Ranges->vertices = RangeAllocator(vertex_capacity);
+		m_Ranges->indices = RangeAllocator(index_capacity);
+	}
+
+	void GeometryPool::destroy(void)
+	{
+		m_VertexBuffer.destroy();
+		m_IndexBuffer.destroy();
+
+		m_Ranges.reset();
+	}
+
+	GeometryAllocation GeometryPool::allocate(u32 vertex_count, u32 index_count)
+	{
+		NA_ASSERT(vertex_count, "Failed to allocate geometry: Vertex count is 0!");
+		NA_ASSERT(m_Ranges, "Failed to allocate geometry: The pool was destroyed!");
+
+		std::lock_guard lock(m_Ranges->mutex);
+		u32 first_vertex = m_Ranges->vertices.allocate(vertex_count);
+		if (first_vertex == k_U32Max)
+			return GeometryAllocation{};
+
+		u32 first_index = 0;
+		if (index_count)
+		{
+			first_index = m_Ranges->indices.allocate(index_count);
+			if (first_index == k_U32Max)
+			{
+				m_Ranges->vertices.free(first_vertex, vertex_count); // never drawn, no need to wait
+				return GeometryAllocation{};
+			}
+		}
+
+		return GeometryAllocation{ first_vertex, vertex_count, first_index, index_count };
+	}
+
+	void GeometryPool::free(const GeometryAllocation& allocation)
+	{
+		if (!allocation)
+			return;
+		NA_ASSERT(m_Ranges, "Failed to free geometry: The pool was destroyed!");
+
+		// frames in flight may still draw from the ranges, an upload into them has to wait until they completed
+		VkContext::GetDeletionQueue().defer([ranges = m_Ranges, allocation](void)
+		{
+			std::lock_guard lock(ranges->mutex);
+			ranges->vertices.free(allocation.first_vertex, allocation.vertex_count);
+			if (allocation.index_count)
+				ranges->indices.free(allocation.first_index, allocation.index_count);
+		});
+	}
+
+	u32 GeometryPool::used_vertices(void) const
+	{
+		if (!m_Ranges)
+			return 0;
+
+		std::lock_guard lock(m_Ranges->mutex);
+		return m_Ranges->vertices.used();
+	}
+
+	u32 GeometryPool::used_indices(void) const
+	{
+		if (!m_Ranges)
+			return 0;
+
+		std::lock_guard lock(m_Ranges->mutex);
+		return m_Ranges->indices.used();
+	}
+
+	GeometryAllocation GeometryPool::add(const void* vertices, u32 vertex_count, const u32* indices, u32 index_count)
+	{
+		GeometryAllocation allocation = this->allocate(vertex_count, index_count);
+		if (!allocation)
+			return allocation;
+
+		this->set_vertices(allocation, vertices);
+		if (index_count)
+			this->set_indices(allocation, indices);
+
+		return allocation;
+	}
+
+	void GeometryPool::set_vertices(const GeometryAllocation& allocation, const void* vertices)
+	{
+		VkContext::GetUploadManager().upload(
+			m_VertexBuffer,
+			vertices,
+			(vk::DeviceSize)allocation.vertex_count * m_VertexStride,
+			(vk::DeviceSize)allocation.first_vertex * m_VertexStride
+		);
+	}
+
+	void GeometryPool::set_indices(const GeometryAllocation& allocation, const u32* indices)
+	{
+		if (m_IndexType == vk::IndexType::eUint32)
+		{
+			VkContext::GetUploadManager().upload(
+				m_IndexBuffer,
+				indices,
+				(vk::DeviceSize)allocation.index_count * sizeof(u32),
+				(vk::DeviceSize)allocation.first_index * sizeof(u32)
+			);
+			return;
+		}
+
+		u16* staging = (u16*)VkContext::GetUploadManager().stage_buffer(
+			m_IndexBuffer,
+			(vk::DeviceSize)allocation.index_count * sizeof(u16),
+			(vk::DeviceSize)allocation.first_index * sizeof(u16)
+		);
+		for (u32 i = 0; i < allocation.index_count; i++)
+		{
+			NA_ASSERT(indices[i] <= UINT16_MAX, "Failed to set geometry indices: Index {} does not fit 16 bits!", i);
+			staging[i] = (u16)indices[i];
+		}
+	}
+
+	GeometryPool::GeometryPool(GeometryPool&& other)
+	: m_VertexBuffer(std::move(other.m_VertexBuffer)),
+	m_IndexBuffer(std::move(other.m_IndexBuffer)),
+	m_VertexStride(std::exchange(other.m_VertexStride, 0)),
+	m_IndexType(other.m_IndexType),
+	m_Ranges(std::move(other.m_Ranges))
+	{}
+
+	GeometryPool& GeometryPool::operator=(GeometryPool&& other)
+	{
+		this->destroy();
+
+		m_VertexBuffer = std::move(other.m_VertexBuffer);
+		m_IndexBuffer = std::move(other.m_IndexBuffer);
+		m_VertexStride = std::exchange(other.m_VertexStride, 0);
+		m_IndexType = other.m_IndexType;
+		m_Ranges = std::move(other.m_Ranges);
+
+		return *this;
+	}
+} // namespace Na
\ No newline at end of file
@@ -4,10 +4,24 @@
 #include "Natrium/Graphics/VkContext.hpp"
 
 namespace Na {
-	IndexBuffer::IndexBuffer(u32 count, const u32* data)
+	IndexBuffer::IndexBuffer(u32 count, const u32* data, vk::IndexType index_type)
 	: m_Count(count),
+	m_IndexType(index_type),
 	m_Buffer(
-		count * sizeof(u32),
+		count * IndexSize(index_type),
+		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+		vk::MemoryPropertyFlagBits::eDeviceLocal
+	)
+	{
+		NA_ASSERT(index_type == vk::IndexType::eUint32 || index_type == vk::IndexType::eUint16, "Failed to create index buffer: Unsupported index type!");
+		this->set_data(data);
+	}
+
+	IndexBuffer::IndexBuffer(u32 count, const u16* data)
+	: m_Count(count),
+	m_IndexType(vk::IndexType::eUint16),
+	m_Buffer(
+		count * sizeof(u16),
 		vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
 		vk::MemoryPropertyFlagBits::eDeviceLocal
 	)
@@ -22,32 +36,39 @@ namespace Na {
 
 	void IndexBuffer::set_data(const u32* data)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-
-		DeviceBuffer stage_buffer(
-			m_Buffer.size,
-			vk::BufferUsageFlagBits::eTransferSrc,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-		);
+		// submitted with the next flush, at the latest by Renderer::end_frame
+		if (m_IndexType == vk::IndexType::eUint32)
+		{
+			VkContext::GetUploadManager().upload(m_Buffer, data, m_Buffer.size);
+			return;
+		}
 
-		void* memory = logical_device.mapMemory(stage_buffer.memory, 0, m_Buffer.size);
-		memcpy(memory, data, m_Buffer.size);
-		logical_device.unmapMemory(stage_buffer.memory);
-
-		m_Buffer.copy(stage_buffer);
+		// narrowed straight into staging memory
+		u16* staging = (u16*)VkContext::GetUploadManager().stage_buffer(m_Buffer, m_Buffer.size);
+		for (u32 i = 0; i < m_Count; i++)
+		{
+			NA_ASSERT(data[i] <= UINT16_MAX, "Failed to set index buffer data: Index {} does not fit 16 bits!", i);
+			staging[i] = (u16)data[i];
+		}
+	}
 
-		stage_buffer.destroy();
+	void IndexBuffer::set_data(const u16* data)
+	{
+		NA_ASSERT(m_IndexType == vk::IndexType::eUint16, "Failed to set index buffer data: The buffer holds 32 bit indices!");
+		VkContext::GetUploadManager().upload(m_Buffer, data, m_Buffer.size);
 	}
 
 	IndexBuffer::IndexBuffer(IndexBuffer&& other)
 	: m_Buffer(std::move(other.m_Buffer)),
-	m_Count(std::exchange(other.m_Count, 0))
+	m_Count(std::exchange(other.m_Count, 0)),
+	m_IndexType(std::exchange(other.m_IndexType, vk::IndexType::eUint32))
 	{}
 
 	IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other)
 	{
 		m_Buffer = std::move(other.m_Buffer);
 		m_Count = std::exchange(other.m_Count, 0);
+		m_IndexType = std::exchange(other.m_IndexType, vk::IndexType::eUint32);
 		return *this;
 	}
 } // namespace Na
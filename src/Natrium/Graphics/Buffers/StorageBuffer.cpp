@@ -2,44 +2,92 @@
 #include "Natrium/Graphics/Buffers/StorageBuffer.hpp"
 
 #include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/UploadManager.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
-#include "Internal.hpp"
 
 namespace Na {
-	StorageBuffer::StorageBuffer(u64 size, const RendererSettings& renderer_settings)
-	: m_PerFrameSize(size)
+	StorageBuffer::StorageBuffer(u64 size, const RendererSettings& renderer_settings, BufferUpdateRate update_rate)
+	: m_PerFrameSize(size), m_UpdateRate(update_rate)
 	{
-		static VkDeviceSize x_Alignment = VkContext::GetPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+		vk::DeviceSize alignment = VkContext::GetPhysicalDeviceLimits().minStorageBufferOffsetAlignment;
 
-		m_AlignedSize = (size + x_Alignment - 1) & ~(x_Alignment - 1);
+		m_AlignedSize = (size + alignment - 1) & ~(alignment - 1);
 
-		m_Buffer = DeviceBuffer(
-			m_AlignedSize * renderer_settings.max_frames_in_flight,
-			vk::BufferUsageFlagBits::eStorageBuffer,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-		);
+		// compute shaders may write draw commands
+		vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+		u32 region_count = renderer_settings.max_frames_in_flight;
 
-		m_Mapped = VkContext::GetLogicalDevice().mapMemory(m_Buffer.memory, 0, size);
+		if (update_rate == BufferUpdateRate::Static)
+		{
+			m_Buffer = DeviceBuffer(m_AlignedSize, usage | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+			region_count = 1;
+		} else
+		{
+			m_Buffer = DeviceBuffer(m_AlignedSize * region_count, usage, HostMemoryProperties(update_rate));
+			m_Mapped = m_Buffer.mapped();
+		}
+
+		if (update_rate == BufferUpdateRate::Tracked)
+			m_Tracker = BufferTracker(size, region_count);
+
+		if (BindlessTable* bindless_table = VkContext::GetBindlessTable())
+		{
+			m_BindlessCount = region_count;
+			m_BindlessIndex = bindless_table->add_storage_buffer(m_Buffer.buffer, 0, m_AlignedSize, m_BindlessCount);
+		}
 	}
 
 	void StorageBuffer::destroy(void)
 	{
+		if (m_BindlessIndex != k_NullBindlessIndex)
+			VkContext::GetBindlessTable()->remove_storage_buffer(std::exchange(m_BindlessIndex, k_NullBindlessIndex), m_BindlessCount);
+
 		m_Buffer.destroy();
 	}
 
+	void StorageBuffer::upload(const void* data, u64 size, u64 offset)
+	{
+		NA_ASSERT(m_UpdateRate == BufferUpdateRate::Static, "Failed to upload storage buffer: Only static buffers are uploaded, per frame buffers are written through their mapping!");
+		NA_ASSERT(offset + size <= m_PerFrameSize, "Failed to upload storage buffer: Range exceeds the buffer!");
+
+		VkContext::GetUploadManager().upload(m_Buffer, data, size, offset);
+	}
+
+	void StorageBuffer::write(const void* data, u64 size, u64 offset)
+	{
+		NA_VERIFY(m_UpdateRate == BufferUpdateRate::Tracked, "Failed to write storage buffer: Only tracked buffers are written through their cpu copy!");
+		m_Tracker.write(data, size, offset);
+	}
+
+	u64 StorageBuffer::sync(u32 frame_index)
+	{
+		NA_VERIFY(m_UpdateRate == BufferUpdateRate::Tracked, "Failed to sync storage buffer: Only tracked buffers have a cpu copy!");
+		return m_Tracker.sync(m_Buffer, frame_index * m_AlignedSize, frame_index);
+	}
+
 	StorageBuffer::StorageBuffer(StorageBuffer&& other)
 	: m_Buffer(std::move(other.m_Buffer)),
 	m_Mapped(std::exchange(other.m_Mapped, nullptr)),
 	m_PerFrameSize(other.m_PerFrameSize),
-	m_AlignedSize(other.m_AlignedSize)
+	m_AlignedSize(other.m_AlignedSize),
+	m_UpdateRate(other.m_UpdateRate),
+	m_Tracker(std::move(other.m_Tracker)),
+	m_BindlessIndex(std::exchange(other.m_BindlessIndex, k_NullBindlessIndex)),
+	m_BindlessCount(other.m_BindlessCount)
 	{}
 
 	StorageBuffer& StorageBuffer::operator=(StorageBuffer&& other)
 	{
+		this->destroy();
+
 		m_Buffer = std::move(other.m_Buffer);
 		m_Mapped = std::exchange(other.m_Mapped, nullptr);
 		m_PerFrameSize = other.m_PerFrameSize;
 		m_AlignedSize = other.m_AlignedSize;
+		m_UpdateRate = other.m_UpdateRate;
+		m_Tracker = std::move(other.m_Tracker);
+		m_BindlessIndex = std::exchange(other.m_BindlessIndex, k_NullBindlessIndex);
+		m_BindlessCount = other.m_BindlessCount;
 
 		return *this;
 	}
@@ -0,0 +1,108 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Buffers/TransientBuffer.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	TransientBuffer::TransientBuffer(
+		u64 per_frame_size,
+		ShaderUniformType type,
+		u64 binding_range,
+		const RendererSettings& renderer_settings
+	)
+	: m_Type(type),
+	m_BindingRange(binding_range)
+	{
+		const vk::PhysicalDeviceLimits& limits = VkContext::GetPhysicalDeviceLimits();
+
+		vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
+		switch (type)
+		{
+		case ShaderUniformType::UniformBuffer:
+			NA_ASSERT(binding_range <= limits.maxUniformBufferRange, "Failed to create TransientBuffer: binding range exceeds gpu limit!");
+			usage |= vk::BufferUsageFlagBits::eUniformBuffer;
+			m_Alignment = limits.minUniformBufferOffsetAlignment;
+			break;
+		case ShaderUniformType::StorageBuffer:
+			NA_ASSERT(binding_range <= limits.maxStorageBufferRange, "Failed to create TransientBuffer: binding range exceeds gpu limit!");
+			usage |= vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+			m_Alignment = limits.minStorageBufferOffsetAlignment;
+			break;
+		default:
+			throw std::runtime_error("Failed to create TransientBuffer: type must be a uniform or a storage buffer!");
+		}
+
+		m_PerFrameSize = (per_frame_size + m_Alignment - 1) & ~(m_Alignment - 1);
+		NA_ASSERT(
+			m_PerFrameSize * renderer_settings.max_frames_in_flight <= k_U32Max,
+			"Failed to create TransientBuffer: dynamic offsets must fit in 32 bits!"
+		);
+
+		// padded, so binding_range from an allocation at the very end of the last slice stays in the buffer
+		m_Buffer = DeviceBuffer(
+			m_PerFrameSize * renderer_settings.max_frames_in_flight + binding_range,
+			usage,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+
+		// stays mapped for the lifetime of the buffer
+		m_Mapped = m_Buffer.mapped();
+	}
+
+	void TransientBuffer::destroy(void)
+	{
+		m_Buffer.destroy();
+		m_Mapped = nullptr;
+		m_Head = 0;
+	}
+
+	void TransientBuffer::begin_frame(u32 frame_index)
+	{
+		m_FrameOffset = m_PerFrameSize * frame_index;
+		m_Head = 0;
+	}
+
+	TransientAllocation TransientBuffer::allocate(u64 size, u64 alignment)
+	{
+		if (!alignment)
+			alignment = m_Alignment;
+
+		u64 offset = (m_Head + alignment - 1) / alignment * alignment;
+		if (offset + size > m_PerFrameSize)
+			return {};
+
+		m_Head = offset + size;
+
+		return TransientAllocation{
+			.buffer = m_Buffer.buffer,
+			.offset = (u32)(m_FrameOffset + offset),
+			.size = size,
+			.mapped = (Byte*)m_Mapped + m_FrameOffset + offset
+		};
+	}
+
+	TransientBuffer::TransientBuffer(TransientBuffer&& other)
+	: m_Buffer(std::move(other.m_Buffer)),
+	m_Mapped(std::exchange(other.m_Mapped, nullptr)),
+	m_Type(other.m_Type),
+	m_PerFrameSize(other.m_PerFrameSize),
+	m_BindingRange(other.m_BindingRange),
+	m_Alignment(other.m_Alignment),
+	m_FrameOffset(other.m_FrameOffset),
+	m_Head(std::exchange(other.m_Head, 0))
+	{}
+
+	TransientBuffer& TransientBuffer::operator=(TransientBuffer&& other)
+	{
+		m_Buffer = std::move(other.m_Buffer);
+		m_Mapped = std::exchange(other.m_Mapped, nullptr);
+		m_Type = other.m_Type;
+		m_PerFrameSize = other.m_PerFrameSize;
+		m_BindingRange = other.m_BindingRange;
+		m_Alignment = other.m_Alignment;
+		m_FrameOffset = other.m_FrameOffset;
+		m_Head = std::exchange(other.m_Head, 0);
+
+		return *this;
+	}
+} // namespace Na
@@ -2,24 +2,37 @@
 #include "Natrium/Graphics/Buffers/UniformBuffer.hpp"
 
 #include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/UploadManager.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
-#include "Internal.hpp"
 
 namespace Na {
-	UniformBuffer::UniformBuffer(u64 size, const RendererSettings& renderer_settings)
-	: m_PerFrameSize(size)
+	UniformBuffer::UniformBuffer(u64 size, const RendererSettings& renderer_settings, BufferUpdateRate update_rate)
+	: m_PerFrameSize(size), m_UpdateRate(update_rate)
 	{
-		static VkDeviceSize x_Alignment = VkContext::GetPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+		vk::DeviceSize alignment = VkContext::GetPhysicalDeviceLimits().minUniformBufferOffsetAlignment;
 
-		m_AlignedSize = (size + x_Alignment - 1) & ~(x_Alignment - 1);
+		m_AlignedSize = (size + alignment - 1) & ~(alignment - 1);
+
+		if (update_rate == BufferUpdateRate::Static)
+		{
+			m_Buffer = DeviceBuffer(
+				m_AlignedSize,
+				vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				vk::MemoryPropertyFlagBits::eDeviceLocal
+			);
+			return;
+		}
 
 		m_Buffer = DeviceBuffer(
 			m_AlignedSize * renderer_settings.max_frames_in_flight,
 			vk::BufferUsageFlagBits::eUniformBuffer,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+			HostMemoryProperties(update_rate)
 		);
 
-		m_Mapped = VkContext::GetLogicalDevice().mapMemory(m_Buffer.memory, 0, size);
+		m_Mapped = m_Buffer.mapped();
+
+		if (update_rate == BufferUpdateRate::Tracked)
+			m_Tracker = BufferTracker(size, renderer_settings.max_frames_in_flight);
 	}
 
 	void UniformBuffer::destroy(void)
@@ -27,11 +40,33 @@ namespace Na {
 		m_Buffer.destroy();
 	}
 
+	void UniformBuffer::upload(const void* data, u64 size, u64 offset)
+	{
+		NA_ASSERT(m_UpdateRate == BufferUpdateRate::Static, "Failed to upload uniform buffer: Only static buffers are uploaded, per frame buffers are written through their mapping!");
+		NA_ASSERT(offset + size <= m_PerFrameSize, "Failed to upload uniform buffer: Range exceeds the buffer!");
+
+		VkContext::GetUploadManager().upload(m_Buffer, data, size, offset);
+	}
+
+	void UniformBuffer::write(const void* data, u64 size, u64 offset)
+	{
+		NA_VERIFY(m_UpdateRate == BufferUpdateRate::Tracked, "Failed to write uniform buffer: Only tracked buffers are written through their cpu copy!");
+		m_Tracker.write(data, size, offset);
+	}
+
+	u64 UniformBuffer::sync(u32 frame_index)
+	{
+		NA_VERIFY(m_UpdateRate == BufferUpdateRate::Tracked, "Failed to sync uniform buffer: Only tracked buffers have a cpu copy!");
+		return m_Tracker.sync(m_Buffer, frame_index * m_AlignedSize, frame_index);
+	}
+
 	UniformBuffer::UniformBuffer(UniformBuffer&& other)
 	: m_Buffer(std::move(other.m_Buffer)),
 	m_Mapped(std::exchange(other.m_Mapped, nullptr)),
 	m_PerFrameSize(other.m_PerFrameSize),
-	m_AlignedSize(other.m_AlignedSize)
+	m_AlignedSize(other.m_AlignedSize),
+	m_UpdateRate(other.m_UpdateRate),
+	m_Tracker(std::move(other.m_Tracker))
 	{}
 
 	UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other)
@@ -40,6 +75,8 @@ namespace Na {
 		m_Mapped = std::exchange(other.m_Mapped, nullptr);
 		m_PerFrameSize = other.m_PerFrameSize;
 		m_AlignedSize = other.m_AlignedSize;
+		m_UpdateRate = other.m_UpdateRate;
+		m_Tracker = std::move(other.m_Tracker);
 
 		return *this;
 	}
@@ -0,0 +1,112 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Culling.hpp"
+
+#include "Natrium/Graphics/BatchMath.hpp"
+
+namespace Na {
+	BoundingBox BoundingBox::transformed(const glm::mat4& transform) const
+	{
+		glm::vec3 center = glm::vec3(transform * glm::vec4(this->center(), 1.0f));
+
+		// every axis of the box contributes its absolute projection onto the new axes
+		glm::mat3 axes = glm::mat3(transform);
+		glm::vec3 extent = this->extent();
+		glm::vec3 new_extent =
+			glm::abs(axes[0]) * extent.x +
+			glm::abs(axes[1]) * extent.y +
+			glm::abs(axes[2]) * extent.z;
+
+		return BoundingBox{ center - new_extent, center + new_extent };
+	}
+
+	BoundingSphere BoundingSphere::transformed(const glm::mat4& transform) const
+	{
+		float scale_squared = std::max({
+			glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+			glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+			glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))
+		});
+
+		return BoundingSphere{
+			glm::vec3(transform * glm::vec4(center, 1.0f)),
+			radius < 0.0f ? radius : radius * sqrtf(scale_squared)
+		};
+	}
+
+	Frustum::Frustum(const glm::mat4& view_projection)
+	{
+		// glm is column major, the planes are sums of its rows
+		auto row = [&](u32 i) -> glm::vec4 {
+			return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+		};
+
+		m_Planes[Left] = row(3) + row(0);
+		m_Planes[Right] = row(3) - row(0);
+		m_Planes[Bottom] = row(3) + row(1);
+		m_Planes[Top] = row(3) - row(1);
+		m_Planes[Near] = row(2); // depth 0 to 1
+		m_Planes[Far] = row(3) - row(2);
+
+		for (glm::vec4& plane : m_Planes)
+		{
+			float length = glm::length(glm::vec3(plane));
+			if (length > 0.0f)
+				plane /= length;
+		}
+	}
+
+	bool Frustum::intersects(const BoundingSphere& sphere) const
+	{
+		if (sphere.radius < 0.0f)
+			return true;
+
+		for (const glm::vec4& plane : m_Planes)
+		{
+			if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Frustum::intersects(const BoundingBox& box) const
+	{
+		glm::vec3 center = box.center();
+		glm::vec3 extent = box.extent();
+
+		for (const glm::vec4& plane : m_Planes)
+		{
+			// the extent along the normal, the corner furthest inside decides
+			float radius = glm::dot(extent, glm::abs(glm::vec3(plane)));
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+		}
+
+		return true;
+	}
+
+	u32 FrustumCuller::add(const BoundingSphere& sphere)
+	{
+		m_X.emplace(sphere.center.x);
+		m_Y.emplace(sphere.center.y);
+		m_Z.emplace(sphere.center.z);
+
+		// survives every plane
+		m_Radius.emplace(sphere.radius < 0.0f ? std::numeric_limits<float>::infinity() : sphere.radius);
+
+		return (u32)m_X.size() - 1;
+	}
+
+	void FrustumCuller::clear(void)
+	{
+		m_X.resize(0);
+		m_Y.resize(0);
+		m_Z.resize(0);
+		m_Radius.resize(0);
+	}
+
+	u32 FrustumCuller::cull(const Frustum& frustum, u8* visible) const
+	{
+		return (u32)BatchMath::CullSpheres(frustum, m_X.ptr(), m_Y.ptr(), m_Z.ptr(), m_Radius.ptr(), m_X.size(), visible);
+	}
+} // namespace Na
\ No newline at end of file
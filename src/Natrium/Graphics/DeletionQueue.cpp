@@ -0,0 +1,194 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/DeletionQueue.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	template<typename t_Handle>
+	static inline t_Handle toHandle(u64 handle) { return t_Handle((typename t_Handle::CType)handle); }
+
+	static void destroyObject(vk::Device device, vk::ObjectType type, u64 handle)
+	{
+		switch (type)
+		{
+		case vk::ObjectType::eUnknown:
+			break; // only the allocation
+		case vk::ObjectType::eBuffer:
+			device.destroyBuffer(toHandle<vk::Buffer>(handle));
+			break;
+		case vk::ObjectType::eImage:
+			device.destroyImage(toHandle<vk::Image>(handle));
+			break;
+		case vk::ObjectType::eImageView:
+			device.destroyImageView(toHandle<vk::ImageView>(handle));
+			break;
+		case vk::ObjectType::eFramebuffer:
+			device.destroyFramebuffer(toHandle<vk::Framebuffer>(handle));
+			break;
+		case vk::ObjectType::eRenderPass:
+			device.destroyRenderPass(toHandle<vk::RenderPass>(handle));
+			break;
+		case vk::ObjectType::eSampler:
+			device.destroySampler(toHandle<vk::Sampler>(handle));
+			break;
+		case vk::ObjectType::ePipeline:
+			device.destroyPipeline(toHandle<vk::Pipeline>(handle));
+			break;
+		case vk::ObjectType::ePipelineLayout:
+			device.destroyPipelineLayout(toHandle<vk::PipelineLayout>(handle));
+			break;
+		case vk::ObjectType::eDescriptorSetLayout:
+			device.destroyDescriptorSetLayout(toHandle<vk::DescriptorSetLayout>(handle));
+			break;
+		case vk::ObjectType::eDescriptorPool:
+			device.destroyDescriptorPool(toHandle<vk::DescriptorPool>(handle));
+			break;
+		default:
+			NA_ASSERT(false, "Failed to destroy object: Unsupported object type {}!", vk::to_string(type));
+			break;
+		}
+	}
+
+	void DeletionQueue::defer(std::function<void(void)> fn)
+	{
+		if (fn)
+			this->_push(vk::ObjectType::eUnknown, 0, {}, std::move(fn));
+	}
+
+	u32 DeletionQueue::add_submitter(void)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		for (u32 i = 0; i < m_Submitters.size(); i++)
+		{
+			if (!m_Submitters[i].active)
+			{
+				m_Submitters[i].active = true;
+				return i;
+			}
+		}
+
+		m_Submitters.emplace_back().active = true;
+		return (u32)m_Submitters.size() - 1;
+	}
+
+	void DeletionQueue::remove_submitter(u32 submitter)
+	{
+		std::lock_guard lock(m_Mutex);
+		NA_ASSERT(submitter < m_Submitters.size() && m_Submitters[submitter].active, "Failed to remove deletion queue submitter: {} does not exist!", submitter);
+
+		m_Submitters[submitter] = Submitter();
+	}
+
+	void DeletionQueue::set_frame(u32 submitter, u64 frame)
+	{
+		std::lock_guard lock(m_Mutex);
+		NA_ASSERT(submitter < m_Submitters.size() && m_Submitters[submitter].active, "Failed to set deletion queue frame: Submitter {} does not exist!", submitter);
+
+		std::deque<FrameMarker>& frames = m_Submitters[submitter].frames;
+		if (frames.empty() || frames.back().frame != frame)
+			frames.push_back(FrameMarker{ frame, m_NextSequence });
+	}
+
+	u64 DeletionQueue::pin(void)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Pins.insert(m_NextSequence);
+		return m_NextSequence;
+	}
+
+	void DeletionQueue::unpin(u64 pin)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		auto it = m_Pins.find(pin);
+		NA_ASSERT(it != m_Pins.end(), "Failed to unpin deletion queue: {} is not pinned!", pin);
+		m_Pins.erase(it);
+	}
+
+	u32 DeletionQueue::collect(u32 submitter, u64 completed_frames)
+	{
+		std::vector<Entry> entries;
+		{
+			std::lock_guard lock(m_Mutex);
+			NA_ASSERT(submitter < m_Submitters.size() && m_Submitters[submitter].active, "Failed to collect deletion queue: Submitter {} does not exist!", submitter);
+
+			std::deque<FrameMarker>& frames = m_Submitters[submitter].frames;
+			while (!frames.empty() && frames.front().frame <= completed_frames)
+				frames.pop_front();
+
+			// pushed before the oldest frame any submitter still has in flight
+			u64 limit = m_NextSequence;
+			for (const Submitter& other : m_Submitters)
+			{
+				if (other.active && !other.frames.empty())
+					limit = std::min(limit, other.frames.front().first_sequence);
+			}
+			if (!m_Pins.empty())
+				limit = std::min(limit, *m_Pins.begin());
+
+			u64 count = 0;
+			while (count < m_Entries.size() && m_Entries[count].sequence < limit)
+				count++;
+
+			entries = this->_take(count);
+		}
+
+		_Destroy(entries);
+		return (u32)entries.size();
+	}
+
+	u32 DeletionQueue::flush(void)
+	{
+		std::vector<Entry> entries;
+		{
+			std::lock_guard lock(m_Mutex);
+			entries = this->_take(m_Entries.size());
+		}
+
+		_Destroy(entries);
+		return (u32)entries.size();
+	}
+
+	u64 DeletionQueue::pending(void)
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_Entries.size();
+	}
+
+	void DeletionQueue::_push(vk::ObjectType type, u64 handle, const DeviceAllocation& allocation, std::function<void(void)> fn)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Entries.emplace_back(Entry{ m_NextSequence++, type, handle, allocation, std::move(fn) });
+	}
+
+	std::vector<DeletionQueue::Entry> DeletionQueue::_take(u64 count)
+	{
+		std::vector<Entry> entries(
+			std::make_move_iterator(m_Entries.begin()),
+			std::make_move_iterator(m_Entries.begin() + count)
+		);
+		m_Entries.erase(m_Entries.begin(), m_Entries.begin() + count);
+
+		return entries;
+	}
+
+	void DeletionQueue::_Destroy(std::vector<Entry>& entries)
+	{
+		if (entries.empty())
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		DeviceAllocator& allocator = VkContext::GetDeviceAllocator();
+
+		// in push order, e.g. a buffer goes before the memory bound to it
+		for (Entry& entry : entries)
+		{
+			if (entry.fn)
+				entry.fn();
+
+			destroyObject(logical_device, entry.type, entry.handle);
+			allocator.free(entry.allocation);
+		}
+	}
+} // namespace Na
\ No newline at end of file
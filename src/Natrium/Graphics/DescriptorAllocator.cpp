@@ -0,0 +1,132 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/DescriptorAllocator.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	// descriptors per set, covering what the pipelines' uniform layouts use
+	static constexpr std::pair<vk::DescriptorType, float> k_PoolRatios[] = {
+		{ vk::DescriptorType::eCombinedImageSampler, 4.0f },
+		{ vk::DescriptorType::eUniformBufferDynamic, 2.0f },
+		{ vk::DescriptorType::eStorageBufferDynamic, 1.0f },
+		{ vk::DescriptorType::eUniformBuffer, 1.0f },
+		{ vk::DescriptorType::eStorageBuffer, 1.0f },
+		{ vk::DescriptorType::eStorageImage, 0.5f }
+	};
+
+	static constexpr u32 k_MaxSetsPerPool = 4096;
+
+	DescriptorAllocator::DescriptorAllocator(u32 frame_count, u32 sets_per_pool)
+	: m_Frames(frame_count),
+	m_SetsPerPool(sets_per_pool),
+	m_NextPoolSize(sets_per_pool),
+	m_Mutex(std::make_unique<std::mutex>())
+	{}
+
+	void DescriptorAllocator::destroy(void)
+	{
+		if (m_Frames.empty())
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		for (FramePools& frame : m_Frames)
+			for (vk::DescriptorPool pool : frame.pools)
+				logical_device.destroyDescriptorPool(pool);
+
+		m_Frames.clear();
+	}
+
+	vk::DescriptorSet DescriptorAllocator::allocate(u32 frame_index, vk::DescriptorSetLayout layout)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		std::lock_guard lock(*m_Mutex);
+		FramePools& frame = m_Frames[frame_index];
+
+		vk::DescriptorSetAllocateInfo alloc_info;
+		alloc_info.descriptorSetCount = 1;
+		alloc_info.pSetLayouts = &layout;
+
+		for (;; frame.current++)
+		{
+			bool fresh = frame.current == frame.pools.size();
+			if (fresh)
+			{
+				frame.pools.push_back(this->_create_pool(m_NextPoolSize));
+				m_NextPoolSize = std::min(m_NextPoolSize * 2, k_MaxSetsPerPool);
+			}
+
+			alloc_info.descriptorPool = frame.pools[frame.current];
+
+			vk::DescriptorSet descriptor_set;
+			vk::Result result = logical_device.allocateDescriptorSets(&alloc_info, &descriptor_set);
+			if (result == vk::Result::eSuccess)
+				return descriptor_set;
+
+			// a fresh pool that can not fit a single set means the layout exceeds the ratios
+			NA_VERIFY(
+				!fresh && (result == vk::Result::eErrorOutOfPoolMemory || result == vk::Result::eErrorFragmentedPool),
+				"Failed to allocate descriptor set: {}!", vk::to_string(result)
+			);
+		}
+	}
+
+	void DescriptorAllocator::reset(u32 frame_index)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		std::lock_guard lock(*m_Mutex);
+		FramePools& frame = m_Frames[frame_index];
+
+		for (u64 i = 0; i < frame.pools.size() && i <= frame.current; i++)
+			logical_device.resetDescriptorPool(frame.pools[i]);
+		frame.current = 0;
+	}
+
+	u64 DescriptorAllocator::pool_count(void) const
+	{
+		std::lock_guard lock(*m_Mutex);
+
+		u64 count = 0;
+		for (const FramePools& frame : m_Frames)
+			count += frame.pools.size();
+		return count;
+	}
+
+	vk::DescriptorPool DescriptorAllocator::_create_pool(u32 max_sets)
+	{
+		std::array<vk::DescriptorPoolSize, std::size(k_PoolRatios)> pool_sizes;
+		for (u64 i = 0; i < pool_sizes.size(); i++)
+		{
+			pool_sizes[i].type = k_PoolRatios[i].first;
+			pool_sizes[i].descriptorCount = std::max(1u, (u32)(k_PoolRatios[i].second * max_sets));
+		}
+
+		vk::DescriptorPoolCreateInfo create_info;
+		create_info.poolSizeCount = (u32)pool_sizes.size();
+		create_info.pPoolSizes = pool_sizes.data();
+		create_info.maxSets = max_sets;
+
+		return VkContext::GetLogicalDevice().createDescriptorPool(create_info);
+	}
+
+	DescriptorAllocator::DescriptorAllocator(DescriptorAllocator&& other)
+	: m_Frames(std::move(other.m_Frames)),
+	m_SetsPerPool(other.m_SetsPerPool),
+	m_NextPoolSize(other.m_NextPoolSize),
+	m_Mutex(std::move(other.m_Mutex))
+	{}
+
+	DescriptorAllocator& DescriptorAllocator::operator=(DescriptorAllocator&& other)
+	{
+		this->destroy();
+
+		m_Frames = std::move(other.m_Frames);
+		m_SetsPerPool = other.m_SetsPerPool;
+		m_NextPoolSize = other.m_NextPoolSize;
+		m_Mutex = std::move(other.m_Mutex);
+
+		return *this;
+	}
+} // namespace Na
@@ -0,0 +1,121 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/DescriptorWriter.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	void DescriptorWriter::write_image(
+		vk::DescriptorSet set,
+		u32 binding,
+		vk::DescriptorType type,
+		const vk::DescriptorImageInfo& image_info,
+		u32 array_element
+	)
+	{
+		u64 info_index = m_ImageInfos.size();
+		m_ImageInfos.push_back(image_info);
+
+		if (!this->_merge(set, binding, type, array_element, true, info_index))
+			m_Writes.push_back(Write{ set, binding, array_element, 1, type, true, info_index });
+	}
+
+	void DescriptorWriter::write_buffer(
+		vk::DescriptorSet set,
+		u32 binding,
+		vk::DescriptorType type,
+		const vk::DescriptorBufferInfo& buffer_info,
+		u32 array_element
+	)
+	{
+		u64 info_index = m_BufferInfos.size();
+		m_BufferInfos.push_back(buffer_info);
+
+		if (!this->_merge(set, binding, type, array_element, false, info_index))
+			m_Writes.push_back(Write{ set, binding, array_element, 1, type, false, info_index });
+	}
+
+	u32 DescriptorWriter::flush(void)
+	{
+		if (m_Writes.empty())
+			return 0;
+
+		// the info vectors are final now, so their pointers stay valid for the call
+		Na::ArrayVector<vk::WriteDescriptorSet> descriptor_writes(m_Writes.size());
+		for (u64 i = 0; i < m_Writes.size(); i++)
+		{
+			const Write& write = m_Writes[i];
+			vk::WriteDescriptorSet& descriptor_write = descriptor_writes[i];
+
+			descriptor_write.dstSet = write.set;
+			descriptor_write.dstBinding = write.binding;
+			descriptor_write.dstArrayElement = write.array_element;
+			descriptor_write.descriptorType = write.type;
+			descriptor_write.descriptorCount = write.count;
+
+			if (write.image)
+				descriptor_write.pImageInfo = m_ImageInfos.data() + write.first_info;
+			else
+				descriptor_write.pBufferInfo = m_BufferInfos.data() + write.first_info;
+		}
+
+		VkContext::GetLogicalDevice().updateDescriptorSets(
+			(u32)descriptor_writes.size(), descriptor_writes.ptr(),
+			0, nullptr // descriptor copy
+		);
+
+		u32 write_count = (u32)m_Writes.size();
+
+		// keeps the capacity, materials are usually written in waves
+		m_Writes.clear();
+		m_ImageInfos.clear();
+		m_BufferInfos.clear();
+
+		return write_count;
+	}
+
+	bool DescriptorWriter::_merge(
+		vk::DescriptorSet set,
+		u32 binding,
+		vk::DescriptorType type,
+		u32 array_element,
+		bool image,
+		u64 info_index
+	)
+	{
+		if (m_Writes.empty())
+			return false;
+
+		Write& last = m_Writes.back();
+		if (
+			last.set != set ||
+			last.binding != binding ||
+			last.type != type ||
+			last.image != image ||
+			last.array_element + last.count != array_element ||
+			last.first_info + last.count != info_index
+		)
+			return false;
+
+		last.count++;
+		return true;
+	}
+
+	DescriptorWriter::DescriptorWriter(DescriptorWriter&& other)
+	: m_Writes(std::exchange(other.m_Writes, {})),
+	m_ImageInfos(std::exchange(other.m_ImageInfos, {})),
+	m_BufferInfos(std::exchange(other.m_BufferInfos, {}))
+	{}
+
+	DescriptorWriter& DescriptorWriter::operator=(DescriptorWriter&& other)
+	{
+		if (this == &other)
+			return *this;
+
+		this->flush();
+
+		m_Writes = std::exchange(other.m_Writes, {});
+		m_ImageInfos = std::exchange(other.m_ImageInfos, {});
+		m_BufferInfos = std::exchange(other.m_BufferInfos, {});
+		return *this;
+	}
+} // namespace Na
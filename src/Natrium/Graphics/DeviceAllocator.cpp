@@ -0,0 +1,522 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/DeviceAllocator.hpp"
+
+namespace Na {
+	struct DeviceMemoryBlock {
+		struct Range {
+			vk::DeviceSize offset, size;
+		};
+
+		vk::DeviceMemory memory = nullptr;
+		vk::DeviceSize size = 0;
+		void* mapped = nullptr;
+
+		u32 pool = 0;
+		bool dedicated = false;
+
+		std::vector<Range> free_ranges; // sorted by offset, never adjacent
+		vk::DeviceSize used = 0;
+		u64 allocation_count = 0;
+	};
+
+	static inline vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// first fit, the padding in front of the allocation stays a free range
+	static bool allocateFromBlock(
+		DeviceMemoryBlock& block,
+		vk::DeviceSize size,
+		vk::DeviceSize alignment,
+		vk::DeviceSize& offset
+	)
+	{
+		for (u64 i = 0; i < block.free_ranges.size(); i++)
+		{
+			DeviceMemoryBlock::Range range = block.free_ranges[i];
+
+			vk::DeviceSize aligned = alignUp(range.offset, alignment);
+			vk::DeviceSize padding = aligned - range.offset;
+			if (padding + size > range.size)
+				continue;
+
+			vk::DeviceSize tail = range.size - padding - size;
+
+			if (padding && tail)
+			{
+				block.free_ranges[i].size = padding;
+				block.free_ranges.insert(block.free_ranges.begin() + i + 1, { aligned + size, tail });
+			} else if (padding)
+			{
+				block.free_ranges[i].size = padding;
+			} else if (tail)
+			{
+				block.free_ranges[i] = { aligned + size, tail };
+			} else
+			{
+				block.free_ranges.erase(block.free_ranges.begin() + i);
+			}
+
+			offset = aligned;
+			return true;
+		}
+
+		return false;
+	}
+
+	static void freeToBlock(DeviceMemoryBlock& block, vk::DeviceSize offset, vk::DeviceSize size)
+	{
+		auto& ranges = block.free_ranges;
+
+		auto next = std::lower_bound(
+			ranges.begin(), ranges.end(), offset,
+			[](const DeviceMemoryBlock::Range& range, vk::DeviceSize offset) -> bool { return range.offset < offset; }
+		);
+
+		bool merge_prev = next != ranges.begin() && (next - 1)->offset + (next - 1)->size == offset;
+		bool merge_next = next != ranges.end() && offset + size == next->offset;
+
+		if (merge_prev && merge_next)
+		{
+			(next - 1)->size += size + next->size;
+			ranges.erase(next);
+		} else if (merge_prev)
+		{
+			(next - 1)->size += size;
+		} else if (merge_next)
+		{
+			next->offset = offset;
+			next->size += size;
+		} else
+		{
+			ranges.insert(next, { offset, size });
+		}
+	}
+
+	static void addUsed(DeviceMemoryCategoryStats& stats, vk::DeviceSize size)
+	{
+		stats.allocation_count++;
+		stats.used += size;
+		stats.peak = std::max(stats.peak, stats.used);
+	}
+
+	static constexpr vk::DeviceSize k_MiB = 1024 * 1024;
+
+	// rounded up so tiny categories do not show as empty
+	static inline vk::DeviceSize toMiB(vk::DeviceSize size)
+	{
+		return (size + k_MiB - 1) / k_MiB;
+	}
+
+	std::string_view DeviceMemoryCategoryStr(DeviceMemoryCategory category)
+	{
+		switch (category)
+		{
+		case DeviceMemoryCategory::Other:      return "Other";
+		case DeviceMemoryCategory::Vertex:     return "Vertex";
+		case DeviceMemoryCategory::Index:      return "Index";
+		case DeviceMemoryCategory::Uniform:    return "Uniform";
+		case DeviceMemoryCategory::Storage:    return "Storage";
+		case DeviceMemoryCategory::Staging:    return "Staging";
+		case DeviceMemoryCategory::Texture:    return "Texture";
+		case DeviceMemoryCategory::Attachment: return "Attachment";
+		default: return "";
+		}
+	}
+
+	DeviceMemoryCategory DeviceMemoryCategoryOf(vk::BufferUsageFlags usage)
+	{
+		using Usage = vk::BufferUsageFlagBits;
+
+		if (usage & Usage::eVertexBuffer)
+			return DeviceMemoryCategory::Vertex;
+		if (usage & Usage::eIndexBuffer)
+			return DeviceMemoryCategory::Index;
+		if (usage & Usage::eUniformBuffer)
+			return DeviceMemoryCategory::Uniform;
+		if (usage & (Usage::eStorageBuffer | Usage::eIndirectBuffer))
+			return DeviceMemoryCategory::Storage;
+		if (usage == Usage::eTransferSrc)
+			return DeviceMemoryCategory::Staging;
+
+		return DeviceMemoryCategory::Other;
+	}
+
+	DeviceMemoryCategory DeviceMemoryCategoryOf(vk::ImageUsageFlags usage)
+	{
+		using Usage = vk::ImageUsageFlagBits;
+
+		if (usage & (Usage::eColorAttachment | Usage::eDepthStencilAttachment | Usage::eTransientAttachment))
+			return DeviceMemoryCategory::Attachment;
+		if (usage & (Usage::eSampled | Usage::eStorage))
+			return DeviceMemoryCategory::Texture;
+
+		return DeviceMemoryCategory::Other;
+	}
+
+	void DeviceMemoryReport::log(LogLevel level) const
+	{
+		g_Logger.fmt(
+			level, "Device memory: {} MiB reserved, {} MiB used by {} allocations in {} blocks",
+			toMiB(total.reserved), toMiB(total.used), total.allocation_count, total.block_count
+		);
+
+		for (u64 i = 0; i < heaps.size(); i++)
+		{
+			const DeviceMemoryHeapStats& heap = heaps[i];
+			if (has_budget)
+				g_Logger.fmt(
+					level, "  Heap #{}{}: {}/{} MiB reserved (peak {}), {} MiB used (peak {}), process usage {}/{} MiB budget",
+					i, heap.device_local ? " (device local)" : "",
+					toMiB(heap.reserved), toMiB(heap.size), toMiB(heap.peak_reserved),
+					toMiB(heap.used), toMiB(heap.peak_used),
+					toMiB(heap.usage), toMiB(heap.budget)
+				);
+			else
+				g_Logger.fmt(
+					level, "  Heap #{}{}: {}/{} MiB reserved (peak {}), {} MiB used (peak {})",
+					i, heap.device_local ? " (device local)" : "",
+					toMiB(heap.reserved), toMiB(heap.size), toMiB(heap.peak_reserved),
+					toMiB(heap.used), toMiB(heap.peak_used)
+				);
+		}
+
+		for (u32 i = 0; i < k_DeviceMemoryCategoryCount; i++)
+		{
+			const DeviceMemoryCategoryStats& category = categories[i];
+			if (!category.peak)
+				continue;
+
+			g_Logger.fmt(
+				level, "  {}: {} MiB in {} allocations (peak {} MiB)",
+				DeviceMemoryCategoryStr((DeviceMemoryCategory)i),
+				toMiB(category.used), category.allocation_count, toMiB(category.peak)
+			);
+		}
+
+		if (failed_allocation_count)
+			g_Logger.fmt(level, "  {} allocations failed", failed_allocation_count);
+	}
+
+	static void accumulateStats(DeviceMemoryStats& stats, const DeviceMemoryBlock& block)
+	{
+		stats.block_count++;
+		stats.allocation_count += block.allocation_count;
+		stats.free_range_count += block.free_ranges.size();
+		stats.reserved += block.size;
+		stats.used += block.used;
+	}
+
+	DeviceAllocator::DeviceAllocator(
+		vk::PhysicalDevice physical_device,
+		vk::Device logical_device,
+		vk::DeviceSize block_size,
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties2
+	)
+	: m_PhysicalDevice(physical_device),
+	m_LogicalDevice(logical_device),
+	m_GetMemoryProperties2(get_memory_properties2),
+	m_MemoryProperties(physical_device.getMemoryProperties()),
+	m_BlockSize(block_size),
+	m_NonCoherentAtomSize(physical_device.getProperties().limits.nonCoherentAtomSize)
+	{}
+
+	void DeviceAllocator::destroy(void)
+	{
+		for (ArrayList<DeviceMemoryBlock*>& pool : m_Pools)
+		{
+			for (DeviceMemoryBlock* block : pool)
+				this->_destroy_block(block);
+			pool.resize(0);
+		}
+
+		m_LogicalDevice = nullptr;
+	}
+
+	DeviceAllocation DeviceAllocator::allocate(
+		const vk::MemoryRequirements& requirements,
+		vk::MemoryPropertyFlags properties,
+		bool linear,
+		DeviceMemoryCategory category
+	)
+	{
+		u32 memory_type = this->find_memory_type(requirements.memoryTypeBits, properties);
+		if (memory_type == k_U32Max)
+			throw std::runtime_error("Failed to allocate device memory: No suitable memory type!");
+
+		u32 pool_index = memory_type * 2 + (linear ? 0 : 1);
+
+		vk::MemoryPropertyFlags type_properties = m_MemoryProperties.memoryTypes[memory_type].propertyFlags;
+		vk::DeviceSize alignment = requirements.alignment;
+		if ((type_properties & vk::MemoryPropertyFlagBits::eHostVisible) && !(type_properties & vk::MemoryPropertyFlagBits::eHostCoherent))
+			alignment = std::max(alignment, m_NonCoherentAtomSize);
+
+		std::lock_guard lock(m_Mutex);
+
+		DeviceMemoryBlock* block = nullptr;
+		vk::DeviceSize offset = 0;
+
+		if (requirements.size > m_BlockSize / 2)
+		{
+			block = this->_create_block(pool_index, requirements.size, true);
+			block->free_ranges.clear();
+		} else
+		{
+			for (DeviceMemoryBlock* candidate : m_Pools[pool_index])
+				if (!candidate->dedicated && allocateFromBlock(*candidate, requirements.size, alignment, offset))
+				{
+					block = candidate;
+					break;
+				}
+
+			if (!block)
+			{
+				block = this->_create_block(pool_index, m_BlockSize, false);
+				allocateFromBlock(*block, requirements.size, alignment, offset);
+			}
+		}
+
+		block->used += requirements.size;
+		block->allocation_count++;
+
+		addUsed(m_Categories[(u32)category], requirements.size);
+
+		u32 heap = m_MemoryProperties.memoryTypes[memory_type].heapIndex;
+		m_HeapUsed[heap] += requirements.size;
+		m_HeapPeakUsed[heap] = std::max(m_HeapPeakUsed[heap], m_HeapUsed[heap]);
+
+		return DeviceAllocation{
+			.memory = block->memory,
+			.offset = offset,
+			.size = requirements.size,
+			.mapped = block->mapped ? (Byte*)block->mapped + offset : nullptr,
+			.block = block,
+			.properties = type_properties,
+			.category = category
+		};
+	}
+
+	void DeviceAllocator::flush(const DeviceAllocation& allocation, vk::DeviceSize offset, vk::DeviceSize size) const
+	{
+		if (!allocation || allocation.coherent() || !size)
+			return;
+
+		// the allocation starts on an atom, so rounding outwards stays inside of it or the block
+		vk::DeviceSize begin = (allocation.offset + offset) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+		vk::DeviceSize end = alignUp(allocation.offset + offset + size, m_NonCoherentAtomSize);
+
+		vk::MappedMemoryRange range(allocation.memory, begin, end - begin);
+		if (end > allocation.block->size)
+			range.size = VK_WHOLE_SIZE;
+
+		vk::Result result = m_LogicalDevice.flushMappedMemoryRanges(1, &range);
+		NA_VERIFY_VK(result, "Failed to flush device memory: Error in flushing mapped range!");
+	}
+
+	void DeviceAllocator::free(DeviceAllocation& allocation)
+	{
+		if (!allocation)
+			return;
+
+		std::lock_guard lock(m_Mutex);
+
+		DeviceMemoryBlock* block = allocation.block;
+		block->used -= allocation.size;
+		block->allocation_count--;
+
+		DeviceMemoryCategoryStats& category = m_Categories[(u32)allocation.category];
+		category.allocation_count--;
+		category.used -= allocation.size;
+
+		m_HeapUsed[m_MemoryProperties.memoryTypes[block->pool / 2].heapIndex] -= allocation.size;
+
+		if (block->dedicated)
+		{
+			ArrayList<DeviceMemoryBlock*>& pool = m_Pools[block->pool];
+			for (u64 i = 0; i < pool.size(); i++)
+				if (pool[i] == block)
+				{
+					pool[i] = pool.tail();
+					pool.pop();
+					break;
+				}
+
+			this->_destroy_block(block);
+		} else
+		{
+			freeToBlock(*block, allocation.offset, allocation.size);
+		}
+
+		allocation = {};
+	}
+
+	void DeviceAllocator::release_empty_blocks(void)
+	{
+		std::lock_guard lock(m_Mutex);
+		this->_release_empty_blocks();
+	}
+
+	void DeviceAllocator::_release_empty_blocks(void)
+	{
+		for (ArrayList<DeviceMemoryBlock*>& pool : m_Pools)
+			for (u64 i = 0; i < pool.size();)
+			{
+				if (pool[i]->allocation_count)
+				{
+					i++;
+					continue;
+				}
+
+				this->_destroy_block(pool[i]);
+				pool[i] = pool.tail();
+				pool.pop();
+			}
+	}
+
+	u32 DeviceAllocator::find_memory_type(u32 type_filter, vk::MemoryPropertyFlags properties) const
+	{
+		for (u32 i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+			if ((type_filter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+				return i;
+
+		return k_U32Max;
+	}
+
+	DeviceMemoryStats DeviceAllocator::stats(void) const
+	{
+		std::lock_guard lock(m_Mutex);
+
+		DeviceMemoryStats stats{};
+		for (const ArrayList<DeviceMemoryBlock*>& pool : m_Pools)
+			for (const DeviceMemoryBlock* block : pool)
+				accumulateStats(stats, *block);
+
+		return stats;
+	}
+
+	DeviceMemoryStats DeviceAllocator::stats(u32 memory_type) const
+	{
+		std::lock_guard lock(m_Mutex);
+
+		DeviceMemoryStats stats{};
+		for (u32 i = memory_type * 2; i < memory_type * 2 + 2; i++)
+			for (const DeviceMemoryBlock* block : m_Pools[i])
+				accumulateStats(stats, *block);
+
+		return stats;
+	}
+
+	DeviceMemoryReport DeviceAllocator::report(void) const
+	{
+		std::lock_guard lock(m_Mutex);
+		return this->_report();
+	}
+
+	DeviceMemoryReport DeviceAllocator::_report(void) const
+	{
+		DeviceMemoryReport report;
+		report.categories = m_Categories;
+		report.failed_allocation_count = m_FailedAllocationCount;
+
+		for (const ArrayList<DeviceMemoryBlock*>& pool : m_Pools)
+			for (const DeviceMemoryBlock* block : pool)
+				accumulateStats(report.total, *block);
+
+		vk::PhysicalDeviceMemoryBudgetPropertiesEXT budget_properties;
+		if (m_GetMemoryProperties2)
+		{
+			vk::PhysicalDeviceMemoryProperties2KHR properties;
+			properties.pNext = &budget_properties;
+			m_GetMemoryProperties2(m_PhysicalDevice, (VkPhysicalDeviceMemoryProperties2*)&properties);
+			report.has_budget = true;
+		}
+
+		report.heaps.resize(m_MemoryProperties.memoryHeapCount);
+		for (u32 i = 0; i < m_MemoryProperties.memoryHeapCount; i++)
+		{
+			DeviceMemoryHeapStats& heap = report.heaps[i];
+			heap.size = m_MemoryProperties.memoryHeaps[i].size;
+			heap.device_local = (bool)(m_MemoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+			heap.reserved = m_HeapReserved[i];
+			heap.peak_reserved = m_HeapPeakReserved[i];
+			heap.used = m_HeapUsed[i];
+			heap.peak_used = m_HeapPeakUsed[i];
+
+			if (report.has_budget)
+			{
+				heap.budget = budget_properties.heapBudget[i];
+				heap.usage = budget_properties.heapUsage[i];
+			}
+		}
+
+		return report;
+	}
+
+	DeviceMemoryBlock* DeviceAllocator::_create_block(u32 pool_index, vk::DeviceSize size, bool dedicated)
+	{
+		u32 memory_type = pool_index / 2;
+
+		vk::MemoryAllocateInfo alloc_info;
+		alloc_info.allocationSize = size;
+		alloc_info.memoryTypeIndex = memory_type;
+
+		vk::DeviceMemory memory;
+		for (u32 attempt = 0;; attempt++)
+		{
+			try
+			{
+				memory = m_LogicalDevice.allocateMemory(alloc_info);
+				break;
+			} catch (const vk::OutOfDeviceMemoryError&)
+			{
+				// empty blocks of other pools may share the heap
+				if (attempt == 0)
+				{
+					this->_release_empty_blocks();
+					continue;
+				}
+
+				m_FailedAllocationCount++;
+				g_Logger.fmt(Error, "Failed to allocate {} bytes of device memory from memory type #{}: Out of device memory!", size, memory_type);
+				this->_report().log(Error);
+				throw;
+			} catch (const vk::OutOfHostMemoryError&)
+			{
+				m_FailedAllocationCount++;
+				g_Logger.fmt(Error, "Failed to allocate {} bytes of device memory from memory type #{}: Out of host memory!", size, memory_type);
+				this->_report().log(Error);
+				throw;
+			}
+		}
+
+		u32 heap = m_MemoryProperties.memoryTypes[memory_type].heapIndex;
+		m_HeapReserved[heap] += size;
+		m_HeapPeakReserved[heap] = std::max(m_HeapPeakReserved[heap], m_HeapReserved[heap]);
+
+		DeviceMemoryBlock* block = new DeviceMemoryBlock;
+		block->memory = memory;
+		block->size = size;
+		block->pool = pool_index;
+		block->dedicated = dedicated;
+		block->free_ranges.push_back({ 0, size });
+
+		if (m_MemoryProperties.memoryTypes[memory_type].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+			block->mapped = m_LogicalDevice.mapMemory(block->memory, 0, VK_WHOLE_SIZE);
+
+		m_Pools[pool_index].emplace(block);
+
+		return block;
+	}
+
+	void DeviceAllocator::_destroy_block(DeviceMemoryBlock* block)
+	{
+		if (block->mapped)
+			m_LogicalDevice.unmapMemory(block->memory);
+
+		m_HeapReserved[m_MemoryProperties.memoryTypes[block->pool / 2].heapIndex] -= block->size;
+
+		m_LogicalDevice.freeMemory(block->memory);
+		delete block;
+	}
+} // namespace Na
@@ -2,6 +2,7 @@
 #include "Natrium/Graphics/DeviceImage.hpp"
 
 #include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/BarrierBatch.hpp"
 #include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
 
 namespace Na {
@@ -13,7 +14,7 @@ namespace Na {
 	{
 		for (vk::Format format : candidates)
 		{
-			vk::FormatProperties properties = VkContext::GetPhysicalDevice().getFormatProperties(format);
+			vk::FormatProperties properties = VkContext::GetFormatProperties(format);
 
 			if (tiling == vk::ImageTiling::eLinear && (properties.linearTilingFeatures & features) == features)
 				return format;
@@ -25,6 +26,143 @@ namespace Na {
 		return vk::Format::eUndefined;
 	}
 
+	u32 MipLevelCount(const vk::Extent3D& extent)
+	{
+		u32 largest = std::max({ extent.width, extent.height, extent.depth });
+
+		u32 levels = 1;
+		while (largest >>= 1)
+			levels++;
+
+		return levels;
+	}
+
+	ImageState ImageState::ForLayout(vk::ImageLayout layout)
+	{
+		using Stage = vk::PipelineStageFlagBits;
+		using Access = vk::AccessFlagBits;
+
+		switch (layout)
+		{
+		case vk::ImageLayout::eUndefined:
+		case vk::ImageLayout::ePreinitialized:
+			return { layout, {}, {} };
+		case vk::ImageLayout::eTransferDstOptimal:
+			return { layout, Stage::eTransfer, Access::eTransferWrite };
+		case vk::ImageLayout::eTransferSrcOptimal:
+			return { layout, Stage::eTransfer, Access::eTransferRead };
+		case vk::ImageLayout::eShaderReadOnlyOptimal:
+			return { layout, Stage::eVertexShader | Stage::eFragmentShader | Stage::eComputeShader, Access::eShaderRead };
+		case vk::ImageLayout::eColorAttachmentOptimal:
+			return { layout, Stage::eColorAttachmentOutput, Access::eColorAttachmentRead | Access::eColorAttachmentWrite };
+		case vk::ImageLayout::eDepthStencilAttachmentOptimal:
+			return {
+				layout,
+				Stage::eEarlyFragmentTests | Stage::eLateFragmentTests,
+				Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite
+			};
+		case vk::ImageLayout::eDepthStencilReadOnlyOptimal:
+			return {
+				layout,
+				Stage::eEarlyFragmentTests | Stage::eLateFragmentTests | Stage::eFragmentShader,
+				Access::eDepthStencilAttachmentRead | Access::eShaderRead
+			};
+		case vk::ImageLayout::ePresentSrcKHR:
+			// presentation waits on a semaphore, nothing has to be made visible
+			return { layout, Stage::eBottomOfPipe, {} };
+		default:
+			return { layout, Stage::eAllCommands, Access::eMemoryRead | Access::eMemoryWrite };
+		}
+	}
+
+	void RecordMipGeneration(
+		vk::CommandBuffer cmd_buffer,
+		vk::Image img,
+		const vk::Extent3D& extent,
+		const vk::ImageSubresourceRange& range,
+		vk::ImageLayout final_layout
+	)
+	{
+		vk::ImageMemoryBarrier barrier;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = img;
+		barrier.subresourceRange = range;
+		barrier.subresourceRange.levelCount = 1;
+
+		auto levelExtent = [&extent](u32 level) -> vk::Offset3D
+		{
+			return vk::Offset3D(
+				(i32)std::max(extent.width >> level, 1u),
+				(i32)std::max(extent.height >> level, 1u),
+				(i32)std::max(extent.depth >> level, 1u)
+			);
+		};
+
+		u32 last_level = range.baseMipLevel + range.levelCount - 1;
+		for (u32 level = range.baseMipLevel; level < last_level; level++)
+		{
+			// the level above was just written, it becomes the blit source
+			barrier.subresourceRange.baseMipLevel = level;
+			barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+			barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+			barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+			barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+
+			cmd_buffer.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eTransfer,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				0, nullptr, // buffer memory barriers
+				1, &barrier // image memory barriers
+			);
+
+			vk::ImageBlit blit;
+			blit.srcSubresource = vk::ImageSubresourceLayers(range.aspectMask, level, range.baseArrayLayer, range.layerCount);
+			blit.srcOffsets[1] = levelExtent(level);
+			blit.dstSubresource = vk::ImageSubresourceLayers(range.aspectMask, level + 1, range.baseArrayLayer, range.layerCount);
+			blit.dstOffsets[1] = levelExtent(level + 1);
+
+			cmd_buffer.blitImage(
+				img, vk::ImageLayout::eTransferSrcOptimal,
+				img, vk::ImageLayout::eTransferDstOptimal,
+				1, &blit,
+				vk::Filter::eLinear
+			);
+
+			barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+			barrier.newLayout = final_layout;
+			barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+			barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+			cmd_buffer.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eAllCommands,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				0, nullptr, // buffer memory barriers
+				1, &barrier // image memory barriers
+			);
+		}
+
+		// the smallest level is never blitted from
+		barrier.subresourceRange.baseMipLevel = last_level;
+		barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		barrier.newLayout = final_layout;
+		barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+		barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eAllCommands,
+			{}, // dependency flags
+			0, nullptr, // memory barriers
+			0, nullptr, // buffer memory barriers
+			1, &barrier // image memory barriers
+		);
+	}
+
 	DeviceImage::DeviceImage(
 		const vk::Extent3D& extent,
 		u32 layer_count,
@@ -34,19 +172,22 @@ namespace Na {
 		vk::ImageUsageFlags usage,
 		vk::SharingMode sharing_mode,
 		vk::SampleCountFlagBits sample_count,
-		vk::MemoryPropertyFlags memory_properties
+		vk::MemoryPropertyFlags memory_properties,
+		u32 mip_levels
 	)
 	: extent(extent),
 	format(format),
 	subresource_range(
 		aspect_mask,
 		0,
-		1,
+		mip_levels,
 		0,
 		layer_count
-	)
+	),
+	m_States(layer_count * mip_levels)
 	{
 		NA_ASSERT(layer_count > 0, "Failed to create DeviceImage: Invalid layer count!");
+		NA_ASSERT(mip_levels > 0 && mip_levels <= MipLevelCount(extent), "Failed to create DeviceImage: Invalid mip level count!");
 
 		vk::Device logical_device = VkContext::GetLogicalDevice();
 
@@ -60,7 +201,7 @@ namespace Na {
 			throw std::runtime_error("Failed to create DeviceImage: Invalid depth!");
 
 		create_info.extent = extent;
-		create_info.mipLevels = 1;
+		create_info.mipLevels = mip_levels;
 		create_info.arrayLayers = layer_count;
 
 		create_info.format = format;
@@ -77,85 +218,93 @@ namespace Na {
 
 		vk::MemoryRequirements memory_requirements = logical_device.getImageMemoryRequirements(this->img);
 
-		vk::MemoryAllocateInfo alloc_info;
-		alloc_info.allocationSize = memory_requirements.size;
-		alloc_info.memoryTypeIndex = FindMemoryType(
-			memory_requirements.memoryTypeBits,
-			memory_properties
+		this->allocation = VkContext::GetDeviceAllocator().allocate(
+			memory_requirements,
+			memory_properties,
+			false, // always created with optimal tiling
+			DeviceMemoryCategoryOf(usage)
 		);
-
-		this->memory = logical_device.allocateMemory(alloc_info);
-		logical_device.bindImageMemory(this->img, this->memory, 0);
+		logical_device.bindImageMemory(this->img, this->allocation.memory, this->allocation.offset);
 	}
 
 	void DeviceImage::destroy(void)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-
+		// pending frames may still read it
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
 		if (this->img)
-			logical_device.destroyImage(this->img);
-
-		if (this->memory)
-			logical_device.freeMemory(this->memory);
-
-		memset(this, 0, sizeof(DeviceImage));
+			deletion_queue.push(this->img, this->allocation);
+		else
+			deletion_queue.free(this->allocation);
+
+		this->img = nullptr;
+		this->allocation = {};
+		this->extent = vk::Extent3D();
+		this->format = vk::Format::eUndefined;
+		this->subresource_range = vk::ImageSubresourceRange();
+		m_States = {};
 	}
 
-	void DeviceImage::transition_layout(vk::ImageLayout old_layout, vk::ImageLayout new_layout)
+	const ImageState& DeviceImage::state(u32 layer, u32 mip_level) const
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-
-		vk::ImageMemoryBarrier barrier;
-
-		barrier.oldLayout = old_layout;
-		barrier.newLayout = new_layout;
-
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-		barrier.image = this->img;
-		barrier.subresourceRange = this->subresource_range;
-
-		vk::PipelineStageFlags execute_stage;
-		vk::PipelineStageFlags wait_stage;
+		NA_ASSERT(layer < this->layer_count() && mip_level < this->mip_levels(), "Subresource out of range!");
+		return m_States[layer * this->mip_levels() + mip_level];
+	}
 
-		if (old_layout == vk::ImageLayout::eUndefined
-		 && new_layout == vk::ImageLayout::eTransferDstOptimal)
-		{
-			barrier.srcAccessMask = {};
-			barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-			
-			execute_stage = vk::PipelineStageFlagBits::eTopOfPipe;
-			wait_stage = vk::PipelineStageFlagBits::eTransfer;
-		} else
-		if (old_layout == vk::ImageLayout::eTransferDstOptimal
-		 && new_layout == vk::ImageLayout::eShaderReadOnlyOptimal)
-		{
-			barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-			barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+	void DeviceImage::set_state(const ImageState& state, const vk::ImageSubresourceRange& range)
+	{
+		u32 level_count = range.levelCount == VK_REMAINING_MIP_LEVELS ? this->mip_levels() - range.baseMipLevel : range.levelCount;
+		u32 layer_count = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? this->layer_count() - range.baseArrayLayer : range.layerCount;
+		NA_ASSERT(range.baseMipLevel + level_count <= this->mip_levels(), "Mip levels out of range!");
+		NA_ASSERT(range.baseArrayLayer + layer_count <= this->layer_count(), "Layers out of range!");
 
-			execute_stage = vk::PipelineStageFlagBits::eTransfer;
-			wait_stage = vk::PipelineStageFlagBits::eFragmentShader;
-		} else
+		for (u32 layer = range.baseArrayLayer; layer < range.baseArrayLayer + layer_count; layer++)
 		{
-			throw std::runtime_error("Unsupported image layout transition!");
+			for (u32 level = range.baseMipLevel; level < range.baseMipLevel + level_count; level++)
+				this->_state(layer, level) = state;
 		}
+	}
+
+	void DeviceImage::transition_layout(
+		vk::CommandBuffer cmd_buffer,
+		vk::ImageLayout new_layout,
+		u32 base_mip_level,
+		u32 level_count
+	)
+	{
+		vk::ImageSubresourceRange range = this->subresource_range;
+		range.baseMipLevel = base_mip_level;
+		range.levelCount = level_count;
 
+		BarrierBatch barriers;
+		barriers.transition(*this, ImageState::ForLayout(new_layout), range);
+		barriers.record(cmd_buffer);
+	}
+
+	void DeviceImage::transition_layout(vk::ImageLayout new_layout, u32 base_mip_level, u32 level_count)
+	{
 		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
 
-		cmd_buffer.pipelineBarrier(
-			execute_stage,
-			wait_stage,
-			{}, // dependency flags
-			0, nullptr, // memory barriers
-			0, nullptr, // buffer memory barriers
-			1, &barrier // image memory barriers
-		);
+		this->transition_layout(cmd_buffer, new_layout, base_mip_level, level_count);
 
 		VkContext::EndSingleTimeCommands(cmd_buffer);
 	}
 
-	void DeviceImage::copy_from_buffer(vk::Buffer buffer, u32 starting_layer, u32 layer_count)
+	void DeviceImage::transition_layout(
+		vk::ImageLayout old_layout,
+		vk::ImageLayout new_layout,
+		u32 base_mip_level,
+		u32 level_count
+	)
+	{
+		vk::ImageSubresourceRange range = this->subresource_range;
+		range.baseMipLevel = base_mip_level;
+		range.levelCount = level_count;
+		this->set_state(ImageState::ForLayout(old_layout), range);
+
+		this->transition_layout(new_layout, base_mip_level, level_count);
+	}
+
+	void DeviceImage::copy_from_buffer(vk::Buffer buffer, u32 starting_layer, u32 layer_count, u32 mip_level)
 	{
 		vk::BufferImageCopy region;
 		region.bufferOffset = 0;
@@ -163,12 +312,12 @@ namespace Na {
 		region.bufferImageHeight = 0;
 
 		region.imageSubresource.aspectMask = this->subresource_range.aspectMask;
-		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.mipLevel = mip_level;
 		region.imageSubresource.baseArrayLayer = starting_layer;
 		region.imageSubresource.layerCount = layer_count;
 
 		region.imageOffset = {{ 0, 0, 0 }};
-		region.imageExtent = this->extent;
+		region.imageExtent = this->mip_extent(mip_level);
 
 		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
 
@@ -182,6 +331,74 @@ namespace Na {
 		VkContext::EndSingleTimeCommands(cmd_buffer);
 	}
 
+	void DeviceImage::copy_to_buffer(vk::Buffer buffer, vk::ImageLayout layout, u32 layer, u32 mip_level) const
+	{
+		vk::ImageSubresourceRange range(this->subresource_range.aspectMask, mip_level, 1, layer, 1);
+
+		// whatever wrote the image before, e.g. a frame still in flight, is ordered by the queue
+		vk::ImageMemoryBarrier barriers[2];
+		barriers[0].oldLayout = layout;
+		barriers[0].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+		barriers[0].srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+		barriers[0].dstAccessMask = vk::AccessFlagBits::eTransferRead;
+		barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].image = this->img;
+		barriers[0].subresourceRange = range;
+
+		barriers[1] = barriers[0];
+		std::swap(barriers[1].oldLayout, barriers[1].newLayout);
+		barriers[1].srcAccessMask = {};
+		barriers[1].dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+
+		vk::BufferImageCopy region;
+		region.imageSubresource = vk::ImageSubresourceLayers(range.aspectMask, mip_level, layer, 1);
+		region.imageExtent = this->mip_extent(mip_level);
+
+		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eAllCommands,
+			vk::PipelineStageFlagBits::eTransfer,
+			{}, // dependency flags
+			0, nullptr, // memory barriers
+			0, nullptr, // buffer memory barriers
+			1, &barriers[0] // image memory barriers
+		);
+
+		cmd_buffer.copyImageToBuffer(
+			this->img,
+			vk::ImageLayout::eTransferSrcOptimal,
+			buffer,
+			1, &region
+		);
+
+		if (layout != vk::ImageLayout::eTransferSrcOptimal)
+			cmd_buffer.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eAllCommands,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				0, nullptr, // buffer memory barriers
+				1, &barriers[1] // image memory barriers
+			);
+
+		// the buffer is read on the host
+		vk::MemoryBarrier host_barrier;
+		host_barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+		host_barrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eHost,
+			{}, // dependency flags
+			1, &host_barrier, // memory barriers
+			0, nullptr, // buffer memory barriers
+			0, nullptr // image memory barriers
+		);
+
+		VkContext::EndSingleTimeCommands(cmd_buffer);
+	}
+
 	void DeviceImage::copy_all_from_buffer(vk::Buffer buffer, u32 starting_layer)
 	{
 		Na::ArrayVector<vk::BufferImageCopy> regions(this->layer_count() - starting_layer);
@@ -275,30 +492,44 @@ namespace Na {
 
 	DeviceImage::DeviceImage(DeviceImage&& other)
 	: img(std::exchange(other.img, nullptr)),
-	memory(std::exchange(other.memory, nullptr)),
+	allocation(std::exchange(other.allocation, {})),
 	extent(other.extent),
 	format(other.format),
-	subresource_range(other.subresource_range)
+	subresource_range(other.subresource_range),
+	m_States(std::move(other.m_States))
 	{}
 
 	DeviceImage& DeviceImage::operator=(DeviceImage&& other)
 	{
 		this->destroy();
 		this->img = std::exchange(other.img, nullptr);
-		this->memory = std::exchange(other.memory, nullptr);
+		this->allocation = std::exchange(other.allocation, {});
 		this->extent = other.extent;
 		this->format = other.format;
 		this->subresource_range = other.subresource_range;
+		m_States = std::move(other.m_States);
 		return *this;
 	}
 
+	void DeviceImage::generate_mipmaps(vk::ImageLayout final_layout)
+	{
+		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
+
+		RecordMipGeneration(cmd_buffer, this->img, this->extent, this->subresource_range, final_layout);
+
+		VkContext::EndSingleTimeCommands(cmd_buffer);
+
+		this->set_state(ImageState::ForLayout(final_layout));
+	}
+
 	vk::ImageView DeviceImage::create_img_view(void) const
 	{
 		return CreateImageView(
 			this->img,
 			this->subresource_range.aspectMask,
 			this->format,
-			this->layer_count()
+			this->layer_count(),
+			this->mip_levels()
 		);
 	}
 
@@ -306,7 +537,8 @@ namespace Na {
 		vk::Image img,
 		vk::ImageAspectFlags aspect_mask,
 		vk::Format format,
-		u32 layer_count
+		u32 layer_count,
+		u32 mip_levels
 	)
 	{
 		vk::ImageViewCreateInfo create_info;
@@ -324,7 +556,7 @@ namespace Na {
 		create_info.subresourceRange.aspectMask = aspect_mask;
 
 		create_info.subresourceRange.baseMipLevel = 0;
-		create_info.subresourceRange.levelCount = 1;
+		create_info.subresourceRange.levelCount = mip_levels;
 
 		create_info.subresourceRange.baseArrayLayer = 0;
 		create_info.subresourceRange.layerCount = layer_count;
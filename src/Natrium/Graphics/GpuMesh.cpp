@@ -0,0 +1,25 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/GpuMesh.hpp"
+
+namespace Na {
+	GpuMesh::GpuMesh(const ModelAsset& model)
+	: m_VertexCount(model.vertex_count()),
+	m_Quantized(!model.quantized_vertices().empty()),
+	m_DequantizationMatrix(model.dequantization_matrix()),
+	m_Bounds(model.bounds()),
+	m_BoundingSphere(model.bounding_sphere())
+	{
+		NA_VERIFY(model, "Failed to create GpuMesh: The model is empty!");
+
+		if (m_Quantized)
+			m_VertexBuffer = VertexBuffer(model.quantized_vertex_data_size(), model.quantized_vertices().ptr());
+		else
+			m_VertexBuffer = VertexBuffer(model.vertex_data_size(), model.vertices().ptr());
+
+		m_IndexBuffer = IndexBuffer(model.total_index_count(), model.indices().ptr(), model.index_type());
+
+		m_Lods.reserve(model.lod_count());
+		for (u32 i = 0; i < model.lod_count(); i++)
+			m_Lods.push_back(model.lod(i));
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/ImmediateCommands.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	ImmediateCommands::ImmediateCommands(u32 queue_family, vk::Queue queue)
+	: m_Queue(queue)
+	{
+		vk::CommandPoolCreateInfo pool_info;
+		pool_info.queueFamilyIndex = queue_family;
+		pool_info.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+
+		m_CmdPool = VkContext::GetLogicalDevice().createCommandPool(pool_info);
+	}
+
+	void ImmediateCommands::destroy(void)
+	{
+		if (!m_CmdPool)
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		// the command buffers go with the pool
+		for (Slot& slot : m_Free)
+			logical_device.destroyFence(slot.fence);
+		for (Slot& slot : m_Recording)
+			logical_device.destroyFence(slot.fence);
+
+		logical_device.destroyCommandPool(m_CmdPool);
+		m_CmdPool = nullptr;
+
+		m_Free.clear();
+		m_Recording.clear();
+	}
+
+	vk::CommandBuffer ImmediateCommands::begin(void)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		Slot slot;
+		if (!m_Free.empty())
+		{
+			slot = m_Free.back();
+			m_Free.pop_back();
+		} else
+		{
+			vk::CommandBufferAllocateInfo alloc_info;
+			alloc_info.level = vk::CommandBufferLevel::ePrimary;
+			alloc_info.commandPool = m_CmdPool;
+			alloc_info.commandBufferCount = 1;
+
+			vk::Result result = logical_device.allocateCommandBuffers(&alloc_info, &slot.cmd_buffer);
+			NA_VERIFY_VK(result, "Failed to begin single time commands: Error in allocating command buffer!");
+
+			slot.fence = logical_device.createFence({});
+		}
+
+		vk::CommandBufferBeginInfo begin_info;
+		begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+		slot.cmd_buffer.begin(begin_info);
+		m_Recording.push_back(slot);
+
+		return slot.cmd_buffer;
+	}
+
+	void ImmediateCommands::submit(vk::CommandBuffer cmd_buffer)
+	{
+		auto it = std::find_if(m_Recording.begin(), m_Recording.end(), [cmd_buffer](const Slot& slot) { return slot.cmd_buffer == cmd_buffer; });
+		NA_ASSERT(it != m_Recording.end(), "Failed to submit single time commands: Command buffer was not begun here!");
+
+		Slot slot = *it;
+		m_Recording.erase(it);
+
+		cmd_buffer.end();
+
+		vk::SubmitInfo submit_info;
+		submit_info.commandBufferCount = 1;
+		submit_info.pCommandBuffers = &cmd_buffer;
+
+		vk::Result result;
+		{
+			std::unique_lock queue_lock = VkContext::QueueLock(m_Queue);
+			result = m_Queue.submit(1, &submit_info, slot.fence);
+		}
+		NA_VERIFY_VK(result, "Failed to submit single time commands: Error in submitting to graphics queue!");
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		result = logical_device.waitForFences(1, &slot.fence, VK_TRUE, k_U64Max);
+		NA_VERIFY_VK(result, "Failed to submit single time commands: Error in waiting for fence!");
+
+		result = logical_device.resetFences(1, &slot.fence);
+		NA_VERIFY_VK(result, "Failed to submit single time commands: Error in resetting fence!");
+
+		cmd_buffer.reset();
+		m_Free.push_back(slot);
+	}
+
+	ImmediateBatch::ImmediateBatch(void)
+	: m_Outer(s_Current)
+	{
+		if (m_Outer)
+		{
+			m_CmdBuffer = m_Outer->m_CmdBuffer;
+		} else
+		{
+			m_Pin = VkContext::GetDeletionQueue().pin();
+			m_CmdBuffer = VkContext::GetImmediateCommands().begin();
+		}
+
+		s_Current = this;
+	}
+
+	void ImmediateBatch::submit(void)
+	{
+		if (!m_CmdBuffer)
+			return;
+
+		s_Current = m_Outer;
+
+		if (!m_Outer)
+		{
+			VkContext::GetImmediateCommands().submit(m_CmdBuffer);
+			VkContext::GetDeletionQueue().unpin(m_Pin);
+		}
+
+		m_CmdBuffer = nullptr;
+	}
+} // namespace Na
\ No newline at end of file
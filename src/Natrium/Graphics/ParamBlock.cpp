@@ -0,0 +1,21 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/ParamBlock.hpp"
+
+namespace Na {
+	void VerifyPushConstant(const PushConstant& block, const PushConstant& reflected)
+	{
+		NA_VERIFY(reflected.shader_stage != ShaderStageBits::None, "Push constant block of {} bytes does not match the pipeline, it has no reflected push constants!", block.size);
+		NA_VERIFY(
+			block.offset >= reflected.offset && block.offset + block.size <= reflected.offset + reflected.size,
+			"Push constant block [{}, {}) is outside of the reflected range [{}, {})!",
+				block.offset, block.offset + block.size,
+				reflected.offset, reflected.offset + reflected.size
+		);
+		NA_VERIFY(
+			block.shader_stage == reflected.shader_stage,
+			"Push constant block is visible to stages {:#x}, the reflected range to {:#x}!",
+				(u32)block.shader_stage,
+				(u32)reflected.shader_stage
+		);
+	}
+} // namespace Na
\ No newline at end of file
@@ -2,19 +2,22 @@
 #include "Natrium/Graphics/Pipeline.hpp"
 
 #include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Core/JobSystem.hpp"
 
 #include "./PipelineStates.hpp"
 
-#include "Internal.hpp"
 #include "Natrium/Graphics/Buffers/UniformBuffer.hpp"
 #include "Natrium/Graphics/Buffers/StorageBuffer.hpp"
+#include "Natrium/Graphics/Buffers/TransientBuffer.hpp"
 #include "Natrium/Graphics/Texture.hpp"
+#include "Natrium/Graphics/ShaderModule.hpp"
 
 namespace Na {
-	static std::tuple<
-		Na::ArrayVector<vk::VertexInputBindingDescription>,
-		Na::ArrayVector<vk::VertexInputAttributeDescription>
-	>
+	// sized for typical pipelines, so building them does not touch the heap
+	using VertexBindingDescriptions = Na::ArrayVector<vk::VertexInputBindingDescription, 4>;
+	using VertexAttributeDescriptions = Na::ArrayVector<vk::VertexInputAttributeDescription, 16>;
+
+	static std::tuple<VertexBindingDescriptions, VertexAttributeDescriptions>
 		GetVertexInputInfo(
 			const ShaderAttributeLayout& vertex_buffer_layout
 		)
@@ -22,13 +25,13 @@ namespace Na {
 		if (!vertex_buffer_layout.size())
 			return { {}, {} };
 
-		Na::ArrayVector<vk::VertexInputBindingDescription> binding_descriptions(vertex_buffer_layout.size());
+		VertexBindingDescriptions binding_descriptions(vertex_buffer_layout.size());
 
 		u64 attribute_count = 0;
 		for (const auto& binding : vertex_buffer_layout)
 			attribute_count += binding.attributes.size();
 
-		Na::ArrayVector<vk::VertexInputAttributeDescription> attribute_descriptions(attribute_count);
+		VertexAttributeDescriptions attribute_descriptions(attribute_count);
 
 		for (u32 i = 0; const auto& binding : vertex_buffer_layout)
 		{
@@ -51,12 +54,12 @@ namespace Na {
 			i++;
 		}
 
-		return { binding_descriptions, attribute_descriptions };
+		return { std::move(binding_descriptions), std::move(attribute_descriptions) };
 	}
 
-	static vk::DescriptorSetLayout createDescriptorSetLayout(const ShaderUniformLayout& descriptor_layout)
+	static vk::DescriptorSetLayout createDescriptorSetLayout(std::span<const ShaderUniform> descriptor_layout)
 	{
-		Na::ArrayVector<vk::DescriptorSetLayoutBinding> bindings(descriptor_layout.size());
+		Na::ArrayVector<vk::DescriptorSetLayoutBinding, 16> bindings(descriptor_layout.size());
 		for (size_t i = 0; const auto& binding : descriptor_layout)
 		{
 			bindings[i].binding            = binding.binding;
@@ -75,9 +78,9 @@ namespace Na {
 		return VkContext::GetLogicalDevice().createDescriptorSetLayout(create_info);
 	}
 
-	static vk::DescriptorPool createDescriptorPool(const ShaderUniformLayout& descriptor_layout)
+	static vk::DescriptorPool createDescriptorPool(std::span<const ShaderUniform> descriptor_layout)
 	{
-		Na::ArrayVector<vk::DescriptorPoolSize> pool_sizes(descriptor_layout.size());
+		Na::ArrayVector<vk::DescriptorPoolSize, 16> pool_sizes(descriptor_layout.size());
 		for (size_t i = 0; const ShaderUniform& uniform : descriptor_layout)
 		{
 			pool_sizes[i].descriptorCount = 1; // 1 * uniform.count
@@ -123,76 +126,413 @@ namespace Na {
 		return descriptor_sets;
 	}
 
-	GraphicsPipeline::GraphicsPipeline(
-		RendererCore& renderer_core,
-		const PipelineShaderInfos& shader_infos,
-		const ShaderAttributeLayout& vertex_buffer_layout,
-		const ShaderUniformLayout& uniform_data_layout,
-		const PushConstantLayout& push_constant_layout
+	// returns the aligned size of dynamic buffers, 0 for textures
+	static u64 writeUniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const void* uniform)
+	{
+		ShaderUniformType uniform_type = *(const ShaderUniformType*)uniform;
+		switch (uniform_type)
+		{
+			case ShaderUniformType::Texture:
+			{
+				const Texture& texture = *(const Texture*)uniform;
+				writer.write_image(
+					descriptor_set,
+					binding,
+					vk::DescriptorType::eCombinedImageSampler,
+					vk::DescriptorImageInfo(texture.sampler(), texture.img_view(), vk::ImageLayout::eShaderReadOnlyOptimal)
+				);
+
+				return 0;
+			}
+			case ShaderUniformType::UniformBuffer:
+			{
+				const UniformBuffer& uniform_buffer = *(const UniformBuffer*)uniform;
+				writer.write_buffer(
+					descriptor_set,
+					binding,
+					vk::DescriptorType::eUniformBufferDynamic,
+					vk::DescriptorBufferInfo(uniform_buffer.buffer().buffer, 0, uniform_buffer.aligned_size())
+				);
+
+				return uniform_buffer.frame_stride();
+			}
+			case ShaderUniformType::StorageBuffer:
+			{
+				const StorageBuffer& storage_buffer = *(const StorageBuffer*)uniform;
+				writer.write_buffer(
+					descriptor_set,
+					binding,
+					vk::DescriptorType::eStorageBufferDynamic,
+					vk::DescriptorBufferInfo(storage_buffer.buffer().buffer, 0, storage_buffer.aligned_size())
+				);
+
+				return storage_buffer.frame_stride();
+			}
+			default:
+				throw std::runtime_error("Failed to bind uniform to pipeline: Uniform object of unknown descriptor type!");
+		}
+	}
+
+	static void writeTransientBuffer(
+		DescriptorWriter& writer,
+		vk::DescriptorSet descriptor_set,
+		u32 binding,
+		const TransientBuffer& transient_buffer
 	)
 	{
+		writer.write_buffer(
+			descriptor_set,
+			binding,
+			(vk::DescriptorType)transient_buffer.type(),
+			vk::DescriptorBufferInfo(transient_buffer.buffer().buffer, 0, transient_buffer.binding_range())
+		);
+	}
+
+	static void bindUniform(
+		DescriptorWriter& writer,
+		vk::DescriptorSet descriptor_set,
+		ArrayList<u32>& dynamic_offsets,
+		u32 dynamic_offset_count,
+		u32& dynamic_offset_index,
+		u32 binding,
+		const void* uniform
+	)
+	{
+		u64 aligned_size = writeUniform(writer, descriptor_set, binding, uniform);
+		if (*(const ShaderUniformType*)uniform == ShaderUniformType::Texture)
+			return;
+
+		for (u64 i = dynamic_offset_index++; i < dynamic_offsets.size(); i += dynamic_offset_count)
+			dynamic_offsets[i] = u32(aligned_size * i);
+	}
+
+	static void bindTransientBuffer(
+		DescriptorWriter& writer,
+		vk::DescriptorSet descriptor_set,
+		ArrayList<u32>& dynamic_offsets,
+		u32 dynamic_offset_count,
+		u32& dynamic_offset_index,
+		u32 binding,
+		const TransientBuffer& transient_buffer
+	)
+	{
+		writeTransientBuffer(writer, descriptor_set, binding, transient_buffer);
+
+		// placeholder, the real offset comes from the allocation at bind time
+		for (u64 i = dynamic_offset_index++; i < dynamic_offsets.size(); i += dynamic_offset_count)
+			dynamic_offsets[i] = 0;
+	}
+
+	static u32 countDynamicOffsets(std::span<const ShaderUniform> uniform_data_layout)
+	{
+		u32 count = 0;
 		for (const ShaderUniform& uniform : uniform_data_layout)
 		{
 			if (
 				uniform.type == ShaderUniformType::StorageBuffer ||
 				uniform.type == ShaderUniformType::UniformBuffer
 			)
-				m_DynamicOffsetCount++;
+				count++;
+		}
+		return count;
+	}
+
+	static vk::PipelineLayout createPipelineLayout(
+		const vk::DescriptorSetLayout& descriptor_layout,
+		std::span<const PushConstant> push_constant_layout
+	)
+	{
+		Na::ArrayVector<vk::PushConstantRange, 4> push_constant_ranges(push_constant_layout.size());
+
+		for (u64 i = 0; const auto& push_constant : push_constant_layout)
+		{
+			push_constant_ranges[i].stageFlags = (vk::ShaderStageFlagBits)push_constant.shader_stage;
+			push_constant_ranges[i].offset = push_constant.offset;
+			push_constant_ranges[i].size = push_constant.size;
+			i++;
+		}
+
+		return VkContext::GetLogicalDevice().createPipelineLayout(
+			vk::PipelineLayoutCreateInfo(
+				{}, // flags
+				(bool)descriptor_layout, descriptor_layout ? &descriptor_layout : nullptr,
+				(u32)push_constant_ranges.size(), push_constant_ranges.ptr()
+			)
+		);
+	}
+
+	void BuildPipelines(const PipelineBuilder* builders, u64 count, u32 thread_count)
+	{
+		if (!thread_count)
+			thread_count = JobSystem::Get().worker_count() + 1;
+		thread_count = (u32)std::min<u64>(thread_count, count);
+
+		std::atomic<u64> next = 0;
+		std::exception_ptr exception = nullptr;
+		std::mutex exception_mutex;
+
+		auto work = [&](void)
+		{
+			for (u64 i = next++; i < count; i = next++)
+			{
+				try
+				{
+					builders[i]();
+				} catch (...)
+				{
+					std::lock_guard lock(exception_mutex);
+					if (!exception)
+						exception = std::current_exception();
+				}
+			}
+		};
+
+		// the calling thread builds as well
+		JobSystem& job_system = JobSystem::Get();
+
+		JobCounter counter;
+		for (u32 i = 1; i < thread_count; i++)
+			job_system.run(work, &counter);
+
+		work();
+
+		job_system.wait(counter);
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	GraphicsPipeline::GraphicsPipeline(
+		RendererCore& renderer_core,
+		const PipelineShaderInfos& shader_infos,
+		const ShaderAttributeLayout& vertex_buffer_layout,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout,
+		const PipelineState& state
+	)
+	: GraphicsPipeline(
+		renderer_core.settings(),
+		GraphicsPipelineTarget{
+			.render_pass = renderer_core.render_pass(),
+			.samples = renderer_core.samples(),
+			.color_attachment_count = 1,
+			.color_format = renderer_core.swapchain_format().format,
+			.depth_format = renderer_core.depth_format()
+		},
+		shader_infos,
+		vertex_buffer_layout,
+		uniform_data_layout,
+		push_constant_layout,
+		state
+	)
+	{}
+
+	GraphicsPipeline::GraphicsPipeline(
+		const RendererSettings& renderer_settings,
+		const GraphicsPipelineTarget& target,
+		const PipelineShaderInfos& shader_infos,
+		const ShaderAttributeLayout& vertex_buffer_layout,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout,
+		const PipelineState& state
+	)
+	{
+		auto [binding_descriptions, attribute_descriptions] = GetVertexInputInfo(vertex_buffer_layout);
+
+		this->_create(
+			renderer_settings,
+			target,
+			{ shader_infos.begin(), shader_infos.size() },
+			{ binding_descriptions.ptr(), binding_descriptions.size() },
+			{ attribute_descriptions.ptr(), attribute_descriptions.size() },
+			{ uniform_data_layout.begin(), uniform_data_layout.size() },
+			{ push_constant_layout.begin(), push_constant_layout.size() },
+			state
+		);
+	}
+
+	GraphicsPipeline::GraphicsPipeline(
+		RendererCore& renderer_core,
+		const PipelineShaderModules& shader_modules,
+		const PipelineState& state,
+		const ShaderAttributeLayout& vertex_buffer_layout
+	)
+	: GraphicsPipeline(
+		renderer_core.settings(),
+		GraphicsPipelineTarget{
+			.render_pass = renderer_core.render_pass(),
+			.samples = renderer_core.samples(),
+			.color_attachment_count = 1,
+			.color_format = renderer_core.swapchain_format().format,
+			.depth_format = renderer_core.depth_format()
+		},
+		shader_modules,
+		state,
+		vertex_buffer_layout
+	)
+	{}
+
+	GraphicsPipeline::GraphicsPipeline(
+		const RendererSettings& renderer_settings,
+		const GraphicsPipelineTarget& target,
+		const PipelineShaderModules& shader_modules,
+		const PipelineState& state,
+		const ShaderAttributeLayout& vertex_buffer_layout
+	)
+	{
+		Na::ArrayVector<vk::PipelineShaderStageCreateInfo, 4> shader_infos(shader_modules.size());
+		std::vector<ShaderUniform> uniforms;
+		PushConstant push_constant{ ShaderStageBits::None, 0, 0 };
+		u32 push_constant_end = 0;
+
+		VertexBindingDescriptions binding_descriptions;
+		VertexAttributeDescriptions attribute_descriptions;
+
+		for (u64 i = 0; const PipelineShaderStage& shader_stage : shader_modules)
+		{
+			const ShaderModule* shader_module = shader_stage.module;
+
+			const ShaderReflection& reflection = shader_module->reflection();
+			NA_ASSERT(reflection.stage() == shader_module->stage(), "Failed to create pipeline: Shader module {} was reflected as another stage!", i);
+
+			shader_infos[i++] = shader_module->pipeline_shader_info(shader_stage.specialization);
+
+			// the same binding in several stages becomes one binding visible to all of them
+			for (const ShaderUniform& uniform : reflection.uniforms())
+			{
+				auto it = std::find_if(uniforms.begin(), uniforms.end(), [&](const ShaderUniform& other) { return other.binding == uniform.binding; });
+				if (it == uniforms.end())
+				{
+					uniforms.push_back(uniform);
+					continue;
+				}
+
+				NA_VERIFY(it->type == uniform.type, "Failed to create pipeline: Binding {} has different types across stages!", uniform.binding);
+				it->shader_stage = ShaderStageBits((u32)it->shader_stage | (u32)uniform.shader_stage);
+			}
+
+			// one range covering every stage's block, so any stage may be pushed for
+			if (const PushConstant& stage_push_constant = reflection.push_constant(); stage_push_constant.shader_stage != ShaderStageBits::None)
+			{
+				push_constant.offset = push_constant.shader_stage == ShaderStageBits::None ? stage_push_constant.offset : std::min(push_constant.offset, stage_push_constant.offset);
+				push_constant_end = std::max(push_constant_end, stage_push_constant.offset + stage_push_constant.size);
+				push_constant.shader_stage = ShaderStageBits((u32)push_constant.shader_stage | (u32)stage_push_constant.shader_stage);
+			}
+
+			// tightly packed in location order in binding 0, unless a layout is given
+			if (reflection.stage() == ShaderStageBits::Vertex && !vertex_buffer_layout.size() && reflection.vertex_inputs().size())
+			{
+				attribute_descriptions = VertexAttributeDescriptions(reflection.vertex_inputs().size());
+
+				u32 offset = 0;
+				for (u64 j = 0; const ShaderAttribute& attribute : reflection.vertex_inputs())
+				{
+					attribute_descriptions[j++] = vk::VertexInputAttributeDescription(attribute.location, 0, (vk::Format)attribute.type, offset);
+					offset += SizeOf(attribute.type);
+				}
+
+				binding_descriptions = VertexBindingDescriptions(1);
+				binding_descriptions[0] = vk::VertexInputBindingDescription(0, offset, vk::VertexInputRate::eVertex);
+			}
 		}
-		m_DynamicOffsets.reallocate(u64(m_DynamicOffsetCount * renderer_core.settings().max_frames_in_flight));
+		push_constant.size = push_constant_end - push_constant.offset;
+
+		if (vertex_buffer_layout.size())
+			std::tie(binding_descriptions, attribute_descriptions) = GetVertexInputInfo(vertex_buffer_layout);
+
+		std::sort(uniforms.begin(), uniforms.end(), [](const ShaderUniform& a, const ShaderUniform& b) { return a.binding < b.binding; });
+		m_PushConstant = push_constant;
+
+		this->_create(
+			renderer_settings,
+			target,
+			{ shader_infos.ptr(), shader_infos.size() },
+			{ binding_descriptions.ptr(), binding_descriptions.size() },
+			{ attribute_descriptions.ptr(), attribute_descriptions.size() },
+			uniforms,
+			{ &push_constant, push_constant.shader_stage != ShaderStageBits::None ? 1ull : 0ull },
+			state
+		);
+	}
+
+	void GraphicsPipeline::_create(
+		const RendererSettings& renderer_settings,
+		const GraphicsPipelineTarget& target,
+		std::span<const vk::PipelineShaderStageCreateInfo> shader_infos,
+		std::span<const vk::VertexInputBindingDescription> binding_descriptions,
+		std::span<const vk::VertexInputAttributeDescription> attribute_descriptions,
+		std::span<const ShaderUniform> uniforms,
+		std::span<const PushConstant> push_constants,
+		const PipelineState& state
+	)
+	{
+		m_DynamicOffsetCount = countDynamicOffsets(uniforms);
+		m_DynamicOffsets.reallocate(u64(m_DynamicOffsetCount * renderer_settings.max_frames_in_flight));
 		m_DynamicOffsets.resize(m_DynamicOffsets.capacity());
 
-		Na::ArrayVector<vk::DynamicState> dynamic_states = {
+		Na::ArrayVector<vk::DynamicState, 4> dynamic_states = {
 			vk::DynamicState::eViewport,
 			vk::DynamicState::eScissor
 		};
 
-		auto [binding_descriptions, attribute_descriptions] = GetVertexInputInfo(vertex_buffer_layout);
-
 		vk::PipelineVertexInputStateCreateInfo vertex_input_info;
 		vertex_input_info.vertexAttributeDescriptionCount = (u32)attribute_descriptions.size();
-		vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.ptr();
+		vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data();
 		vertex_input_info.vertexBindingDescriptionCount = (u32)binding_descriptions.size();
-		vertex_input_info.pVertexBindingDescriptions = binding_descriptions.ptr();
+		vertex_input_info.pVertexBindingDescriptions = binding_descriptions.data();
 
 		auto dynamic_state_info = dynamicStateInfo(dynamic_states);
 		auto viewport_info = viewportInfo();
-		auto input_assembly_info = inputAssemblyInfo();
-		auto rasterization_info = rasterizationInfo();
-		auto multisample_info = multisampleInfo(renderer_core.settings().msaa_enabled);
-		auto color_blend_attachment = colorBlendAttachment(false);
-		auto color_blend_info = colorBlendInfo(color_blend_attachment);
-		auto depth_stencil_info = depthStencilInfo();
+		auto input_assembly_info = inputAssemblyInfo(state);
+		auto rasterization_info = rasterizationInfo(state);
+		auto multisample_info = multisampleInfo(target.samples, state);
 
-		if (uniform_data_layout.size())
-			m_DescriptorLayout = createDescriptorSetLayout(uniform_data_layout);
+		Na::ArrayVector<vk::PipelineColorBlendAttachmentState, 8> color_blend_attachments(target.color_attachment_count);
+		for (auto& color_blend_attachment : color_blend_attachments)
+			color_blend_attachment = colorBlendAttachment(state.blend);
+		auto color_blend_info = colorBlendInfo(color_blend_attachments);
+		auto depth_stencil_info = depthStencilInfo(state);
 
-		Na::ArrayVector<vk::PushConstantRange> push_constant_ranges(push_constant_layout.size());
+		if (state.bindless)
+		{
+			BindlessTable* bindless_table = VkContext::GetBindlessTable();
+			NA_VERIFY(bindless_table, "Failed to create pipeline: Bindless pipelines require ContextSettings::bindless and descriptor indexing!");
+			NA_ASSERT(uniforms.empty(), "Failed to create pipeline: Bindless pipelines can not have a uniform layout!");
 
-		for (u64 i = 0; const auto& push_constant : push_constant_layout)
+			m_Bindless = true;
+			m_Layout = createPipelineLayout(bindless_table->layout(), push_constants);
+		} else
 		{
-			push_constant_ranges[i].stageFlags = (vk::ShaderStageFlagBits)push_constant.shader_stage;
-			push_constant_ranges[i].offset = push_constant.offset;
-			push_constant_ranges[i].size = push_constant.size;
-			i++;
-		}
+			if (uniforms.size())
+				m_DescriptorLayout = createDescriptorSetLayout(uniforms);
 
-		m_Layout = VkContext::GetLogicalDevice().createPipelineLayout(
-			vk::PipelineLayoutCreateInfo(
-				{}, // flags
-				(bool)m_DescriptorLayout, uniform_data_layout.size() ? &m_DescriptorLayout : nullptr,
-				(u32)push_constant_ranges.size(), push_constant_ranges.ptr()
-			)
-		);
+			m_Layout = createPipelineLayout(m_DescriptorLayout, push_constants);
+		}
 
 		vk::GraphicsPipelineCreateInfo create_info;
 
 		create_info.stageCount = (u32)shader_infos.size();
-		create_info.pStages = shader_infos.begin();
+		create_info.pStages = shader_infos.data();
 
-		create_info.renderPass = renderer_core.render_pass();
+		create_info.renderPass = target.render_pass;
 		create_info.layout = m_Layout;
 
+		Na::ArrayVector<vk::Format, 8> color_formats(target.color_attachment_count);
+		vk::PipelineRenderingCreateInfoKHR rendering_info;
+		if (!target.render_pass)
+		{
+			NA_ASSERT(VkContext::GetDeviceFeatures().dynamic_rendering, "Failed to create pipeline: No render pass and dynamic rendering is not supported!");
+
+			for (vk::Format& format : color_formats)
+				format = target.color_format;
+
+			rendering_info.colorAttachmentCount = (u32)color_formats.size();
+			rendering_info.pColorAttachmentFormats = color_formats.ptr();
+			rendering_info.depthAttachmentFormat = target.depth_format;
+
+			create_info.pNext = &rendering_info;
+		}
+
 		create_info.pDynamicState = &dynamic_state_info;
 		create_info.pViewportState = &viewport_info;
 		create_info.pInputAssemblyState = &input_assembly_info;
@@ -202,98 +542,170 @@ namespace Na {
 		create_info.pColorBlendState = &color_blend_info;
 		create_info.pDepthStencilState = &depth_stencil_info;
 
-		m_Pipeline = VkContext::GetLogicalDevice().createGraphicsPipeline(nullptr, create_info).value;
+		m_Pipeline = VkContext::GetLogicalDevice().createGraphicsPipeline(VkContext::GetPipelineCache(), create_info).value;
 
-		if (uniform_data_layout.size())
+		if (m_Bindless)
+			m_DescriptorSet = VkContext::GetBindlessTable()->descriptor_set();
+		else if (uniforms.size())
 		{
-			m_DescriptorPool = createDescriptorPool(uniform_data_layout);
+			m_DescriptorPool = createDescriptorPool(uniforms);
 			m_DescriptorSet = createDescriptorSet(m_DescriptorLayout, m_DescriptorPool);
 		}
 	}
 
 	void GraphicsPipeline::destroy(void)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
 
-		logical_device.destroyDescriptorPool(m_DescriptorPool);
-		logical_device.destroyPipeline(m_Pipeline);
-		logical_device.destroyDescriptorSetLayout(m_DescriptorLayout);
-		logical_device.destroyPipelineLayout(m_Layout);
+		deletion_queue.push(std::exchange(m_DescriptorPool, nullptr));
+		deletion_queue.push(std::exchange(m_Pipeline, nullptr));
+		deletion_queue.push(std::exchange(m_DescriptorLayout, nullptr));
+		deletion_queue.push(std::exchange(m_Layout, nullptr));
 
 		m_DynamicOffsets.~ArrayList();
 	}
 
-	void GraphicsPipeline::_bind_uniform(u32 binding, const void* uniform)
+	void GraphicsPipeline::_bind_uniform(DescriptorWriter& writer, u32 binding, const void* uniform)
 	{
-		ShaderUniformType uniform_type = *(const ShaderUniformType*)uniform;
-		switch (uniform_type)
-		{
-			case ShaderUniformType::Texture:
-			{
-				const Texture& texture = *(const Texture*)uniform;
-				vk::DescriptorImageInfo image_info;
-				image_info.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-				image_info.imageView = texture.img_view();
-				image_info.sampler = texture.sampler();
+		bindUniform(writer, m_DescriptorSet, m_DynamicOffsets, m_DynamicOffsetCount, m_DynamicOffsetIndex, binding, uniform);
+	}
 
-				Internal::WriteToDescriptorSet(
-					m_DescriptorSet,
-					binding,
-					vk::DescriptorType::eCombinedImageSampler,
-					1,
-					nullptr, // buffer info
-					&image_info,
-					nullptr // texel buffer view
-				);
+	void GraphicsPipeline::bind_uniform(DescriptorWriter& writer, u32 binding, const TransientBuffer& transient_buffer)
+	{
+		bindTransientBuffer(writer, m_DescriptorSet, m_DynamicOffsets, m_DynamicOffsetCount, m_DynamicOffsetIndex, binding, transient_buffer);
+	}
 
-				break;
-			}
-			case ShaderUniformType::UniformBuffer:
-			{
-				const UniformBuffer& uniform_buffer = *(const UniformBuffer*)uniform;
-				vk::DescriptorBufferInfo buffer_info(uniform_buffer.buffer().buffer, 0, uniform_buffer.aligned_size());
+	void GraphicsPipeline::_write_uniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const void* uniform) const
+	{
+		(void)writeUniform(writer, descriptor_set, binding, uniform);
+	}
 
-				Internal::WriteToDescriptorSet(
-					m_DescriptorSet,
-					binding,
-					vk::DescriptorType::eUniformBufferDynamic,
-					1, // count
-					&buffer_info,
-					nullptr, // image info
-					nullptr // texel buffer view
-				);
+	void GraphicsPipeline::write_uniform(DescriptorWriter& writer, vk::DescriptorSet descriptor_set, u32 binding, const TransientBuffer& transient_buffer) const
+	{
+		writeTransientBuffer(writer, descriptor_set, binding, transient_buffer);
+	}
 
-				for (u64 i = m_DynamicOffsetIndex++; i < m_DynamicOffsets.size(); i += m_DynamicOffsetCount)
-					m_DynamicOffsets[i] = u32(uniform_buffer.aligned_size() * i);
+	GraphicsPipeline::GraphicsPipeline(GraphicsPipeline&& other)
+	: m_Pipeline(std::exchange(other.m_Pipeline, nullptr)),
+	m_Bindless(std::exchange(other.m_Bindless, false)),
 
-				break;
-			}
-			case ShaderUniformType::StorageBuffer:
-			{
-				const StorageBuffer& storage_buffer = *(const StorageBuffer*)uniform;
-				vk::DescriptorBufferInfo buffer_info(storage_buffer.buffer().buffer, 0, storage_buffer.aligned_size());
+	m_DescriptorLayout(std::exchange(other.m_DescriptorLayout, nullptr)),
+	m_Layout(std::exchange(other.m_Layout, nullptr)),
 
-				Internal::WriteToDescriptorSet(
-					m_DescriptorSet,
-					binding,
-					vk::DescriptorType::eStorageBufferDynamic,
-					1, // count
-					&buffer_info,
-					nullptr, // image info
-					nullptr // texel buffer view
-				);
+	m_DescriptorPool(std::exchange(other.m_DescriptorPool, nullptr)),
+	m_DescriptorSet(std::exchange(other.m_DescriptorSet, nullptr)),
+	m_DynamicOffsets(std::move(other.m_DynamicOffsets)),
+	m_DynamicOffsetCount(other.m_DynamicOffsetCount),
+	m_DynamicOffsetIndex(other.m_DynamicOffsetIndex),
+	m_PushConstant(other.m_PushConstant)
+	{}
 
-				for (u64 i = m_DynamicOffsetIndex++; i < m_DynamicOffsets.size(); i += m_DynamicOffsetCount)
-					m_DynamicOffsets[i] = u32(storage_buffer.aligned_size() * i);
+	GraphicsPipeline& GraphicsPipeline::operator=(GraphicsPipeline&& other)
+	{
+		this->destroy();
 
-				break;
-			}
-			default:
-				throw std::runtime_error("Failed to bind uniform to pipeline: Uniform object of unknown descriptor type!");
+		m_Pipeline = std::exchange(other.m_Pipeline, nullptr);
+		m_Bindless = std::exchange(other.m_Bindless, false);
+
+		m_DescriptorLayout = std::exchange(other.m_DescriptorLayout, nullptr);
+		m_Layout = std::exchange(other.m_Layout, nullptr);
+
+		m_DescriptorPool = std::exchange(other.m_DescriptorPool, nullptr);
+		m_DescriptorSet = std::exchange(other.m_DescriptorSet, nullptr);
+
+		m_DynamicOffsets = std::move(other.m_DynamicOffsets);
+		m_DynamicOffsetCount = other.m_DynamicOffsetCount;
+		m_DynamicOffsetIndex = other.m_DynamicOffsetIndex;
+		m_PushConstant = other.m_PushConstant;
+
+		return *this;
+	}
+
+	ComputePipeline::ComputePipeline(
+		const RendererSettings& renderer_settings,
+		const vk::PipelineShaderStageCreateInfo& shader_info,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout
+	)
+	{
+		this->_create(
+			renderer_settings,
+			shader_info,
+			{ uniform_data_layout.begin(), uniform_data_layout.size() },
+			{ push_constant_layout.begin(), push_constant_layout.size() }
+		);
+	}
+
+	ComputePipeline::ComputePipeline(const RendererSettings& renderer_settings, const ShaderModule& shader_module, const SpecializationConstants* specialization)
+	{
+		const ShaderReflection& reflection = shader_module.reflection();
+		m_PushConstant = reflection.push_constant();
+
+		this->_create(
+			renderer_settings,
+			shader_module.pipeline_shader_info(specialization),
+			reflection.uniforms(),
+			{ &m_PushConstant, m_PushConstant.shader_stage != ShaderStageBits::None ? 1ull : 0ull }
+		);
+	}
+
+	void ComputePipeline::_create(
+		const RendererSettings& renderer_settings,
+		const vk::PipelineShaderStageCreateInfo& shader_info,
+		std::span<const ShaderUniform> uniform_data_layout,
+		std::span<const PushConstant> push_constant_layout
+	)
+	{
+		NA_ASSERT(
+			shader_info.stage == vk::ShaderStageFlagBits::eCompute,
+			"Failed to create compute pipeline: shader is not a compute shader!"
+		);
+
+		m_DynamicOffsetCount = countDynamicOffsets(uniform_data_layout);
+		m_DynamicOffsets.reallocate(u64(m_DynamicOffsetCount * renderer_settings.max_frames_in_flight));
+		m_DynamicOffsets.resize(m_DynamicOffsets.capacity());
+
+		if (uniform_data_layout.size())
+			m_DescriptorLayout = createDescriptorSetLayout(uniform_data_layout);
+
+		m_Layout = createPipelineLayout(m_DescriptorLayout, push_constant_layout);
+
+		vk::ComputePipelineCreateInfo create_info;
+		create_info.stage = shader_info;
+		create_info.layout = m_Layout;
+
+		m_Pipeline = VkContext::GetLogicalDevice().createComputePipeline(VkContext::GetPipelineCache(), create_info).value;
+
+		if (uniform_data_layout.size())
+		{
+			m_DescriptorPool = createDescriptorPool(uniform_data_layout);
+			m_DescriptorSet = createDescriptorSet(m_DescriptorLayout, m_DescriptorPool);
 		}
 	}
 
-	GraphicsPipeline::GraphicsPipeline(GraphicsPipeline&& other)
+	void ComputePipeline::destroy(void)
+	{
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
+
+		deletion_queue.push(std::exchange(m_DescriptorPool, nullptr));
+		deletion_queue.push(std::exchange(m_Pipeline, nullptr));
+		deletion_queue.push(std::exchange(m_DescriptorLayout, nullptr));
+		deletion_queue.push(std::exchange(m_Layout, nullptr));
+
+		m_DynamicOffsets.~ArrayList();
+	}
+
+	void ComputePipeline::_bind_uniform(DescriptorWriter& writer, u32 binding, const void* uniform)
+	{
+		bindUniform(writer, m_DescriptorSet, m_DynamicOffsets, m_DynamicOffsetCount, m_DynamicOffsetIndex, binding, uniform);
+	}
+
+	void ComputePipeline::bind_uniform(DescriptorWriter& writer, u32 binding, const TransientBuffer& transient_buffer)
+	{
+		bindTransientBuffer(writer, m_DescriptorSet, m_DynamicOffsets, m_DynamicOffsetCount, m_DynamicOffsetIndex, binding, transient_buffer);
+	}
+
+	ComputePipeline::ComputePipeline(ComputePipeline&& other)
 	: m_Pipeline(std::exchange(other.m_Pipeline, nullptr)),
 
 	m_DescriptorLayout(std::exchange(other.m_DescriptorLayout, nullptr)),
@@ -301,12 +713,14 @@ namespace Na {
 
 	m_DescriptorPool(std::exchange(other.m_DescriptorPool, nullptr)),
 	m_DescriptorSet(std::exchange(other.m_DescriptorSet, nullptr)),
+
 	m_DynamicOffsets(std::move(other.m_DynamicOffsets)),
 	m_DynamicOffsetCount(other.m_DynamicOffsetCount),
-	m_DynamicOffsetIndex(other.m_DynamicOffsetIndex)
+	m_DynamicOffsetIndex(other.m_DynamicOffsetIndex),
+	m_PushConstant(other.m_PushConstant)
 	{}
 
-	GraphicsPipeline& GraphicsPipeline::operator=(GraphicsPipeline&& other)
+	ComputePipeline& ComputePipeline::operator=(ComputePipeline&& other)
 	{
 		this->destroy();
 
@@ -321,6 +735,7 @@ namespace Na {
 		m_DynamicOffsets = std::move(other.m_DynamicOffsets);
 		m_DynamicOffsetCount = other.m_DynamicOffsetCount;
 		m_DynamicOffsetIndex = other.m_DynamicOffsetIndex;
+		m_PushConstant = other.m_PushConstant;
 
 		return *this;
 	}
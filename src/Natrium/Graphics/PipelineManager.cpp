@@ -0,0 +1,201 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/PipelineManager.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/ShaderModule.hpp"
+
+namespace Na {
+	template<typename T>
+	static void appendKey(std::string& key, const T& value)
+	{
+		key.append((const char*)&value, sizeof(T));
+	}
+
+	static void appendKey(std::string& key, const PipelineShaderInfos& shader_infos)
+	{
+		appendKey(key, (u64)shader_infos.size());
+		for (const vk::PipelineShaderStageCreateInfo& info : shader_infos)
+		{
+			// by code, a handle may belong to a different module once its old one was destroyed
+			u64 binary_hash = ShaderModule::FindBinaryHash(info.module);
+			NA_VERIFY(binary_hash, "Failed to get pipeline: Shader module was not created from a ShaderBinary!");
+
+			appendKey(key, (VkShaderStageFlags)info.stage);
+			appendKey(key, binary_hash);
+			key.append(info.pName ? info.pName : "");
+			key.push_back('\0');
+
+			const vk::SpecializationInfo* specialization = info.pSpecializationInfo;
+			appendKey(key, specialization ? specialization->mapEntryCount : 0u);
+			if (!specialization)
+				continue;
+
+			for (u32 i = 0; i < specialization->mapEntryCount; i++)
+			{
+				const vk::SpecializationMapEntry& entry = specialization->pMapEntries[i];
+				appendKey(key, entry.constantID);
+				appendKey(key, entry.offset);
+				appendKey(key, (u64)entry.size);
+			}
+			appendKey(key, (u64)specialization->dataSize);
+			key.append((const char*)specialization->pData, specialization->dataSize);
+		}
+	}
+
+	static std::string pipelineKey(
+		const RendererSettings& renderer_settings,
+		const GraphicsPipelineTarget& target,
+		const PipelineShaderInfos& shader_infos,
+		const ShaderAttributeLayout& vertex_buffer_layout,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout,
+		const PipelineState& state
+	)
+	{
+		std::string key;
+		key.reserve(256);
+
+		appendKey(key, renderer_settings.max_frames_in_flight);
+
+		appendKey(key, (u64)(VkRenderPass)target.render_pass);
+		appendKey(key, target.samples);
+		appendKey(key, target.color_attachment_count);
+		appendKey(key, target.color_format);
+		appendKey(key, target.depth_format);
+
+		appendKey(key, shader_infos);
+
+		appendKey(key, (u64)vertex_buffer_layout.size());
+		for (const ShaderAttributeBinding& binding : vertex_buffer_layout)
+		{
+			appendKey(key, binding.binding);
+			appendKey(key, binding.input_rate);
+			appendKey(key, (u64)binding.attributes.size());
+			for (const ShaderAttribute& attribute : binding.attributes)
+			{
+				appendKey(key, attribute.location);
+				appendKey(key, attribute.type);
+			}
+		}
+
+		appendKey(key, (u64)uniform_data_layout.size());
+		for (const ShaderUniform& uniform : uniform_data_layout)
+		{
+			appendKey(key, uniform.binding);
+			appendKey(key, uniform.type);
+			appendKey(key, uniform.shader_stage);
+		}
+
+		appendKey(key, (u64)push_constant_layout.size());
+		for (const PushConstant& push_constant : push_constant_layout)
+		{
+			appendKey(key, push_constant.shader_stage);
+			appendKey(key, push_constant.size);
+			appendKey(key, push_constant.offset);
+		}
+
+		appendKey(key, state.topology);
+		appendKey(key, state.primitive_restart);
+		appendKey(key, state.polygon_mode);
+		appendKey(key, (VkCullModeFlags)state.cull_mode);
+		appendKey(key, state.front_face);
+		appendKey(key, state.line_width);
+		appendKey(key, state.blend);
+		appendKey(key, state.depth_test);
+		appendKey(key, state.depth_write);
+		appendKey(key, state.depth_compare);
+		appendKey(key, state.min_sample_shading);
+		appendKey(key, state.bindless);
+
+		return key;
+	}
+
+	PipelineHandle PipelineManager::get(
+		RendererCore& renderer_core,
+		const PipelineShaderInfos& shader_infos,
+		const ShaderAttributeLayout& vertex_buffer_layout,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout,
+		const PipelineState& state
+	)
+	{
+		return this->get(
+			renderer_core.settings(),
+			GraphicsPipelineTarget{
+				.render_pass = renderer_core.render_pass(),
+				.samples = renderer_core.samples(),
+				.color_attachment_count = 1,
+				.color_format = renderer_core.swapchain_format().format,
+				.depth_format = renderer_core.depth_format()
+			},
+			shader_infos,
+			vertex_buffer_layout,
+			uniform_data_layout,
+			push_constant_layout,
+			state
+		);
+	}
+
+	PipelineHandle PipelineManager::get(
+		const RendererSettings& renderer_settings,
+		const GraphicsPipelineTarget& target,
+		const PipelineShaderInfos& shader_infos,
+		const ShaderAttributeLayout& vertex_buffer_layout,
+		const ShaderUniformLayout& uniform_data_layout,
+		const PushConstantLayout& push_constant_layout,
+		const PipelineState& state
+	)
+	{
+		std::string key = pipelineKey(
+			renderer_settings,
+			target,
+			shader_infos,
+			vertex_buffer_layout,
+			uniform_data_layout,
+			push_constant_layout,
+			state
+		);
+
+		{
+			std::lock_guard lock(m_Mutex);
+
+			auto it = m_Pipelines.find(key);
+			if (it != m_Pipelines.end())
+			{
+				m_Hits++;
+				return it->second;
+			}
+		}
+
+		// built without holding the lock so misses compile in parallel,
+		// if another thread built the same pipeline meanwhile this one is dropped
+		PipelineHandle pipeline = std::make_shared<GraphicsPipeline>(
+			renderer_settings,
+			target,
+			shader_infos,
+			vertex_buffer_layout,
+			uniform_data_layout,
+			push_constant_layout,
+			state
+		);
+
+		std::lock_guard lock(m_Mutex);
+		m_Misses++;
+
+		auto [it, inserted] = m_Pipelines.emplace(std::move(key), std::move(pipeline));
+		return it->second;
+	}
+
+	u64 PipelineManager::release_unused(void)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		return std::erase_if(m_Pipelines, [](const auto& entry) { return entry.second.use_count() == 1; });
+	}
+
+	void PipelineManager::clear(void)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Pipelines.clear();
+	}
+} // namespace Na
@@ -2,7 +2,8 @@
 #include "Natrium/Graphics/Pipeline.hpp"
 
 namespace Na {
-	static vk::PipelineDynamicStateCreateInfo dynamicStateInfo(const Na::ArrayVector<vk::DynamicState>& states)
+	template<u64 t_InlineCapacity>
+	static vk::PipelineDynamicStateCreateInfo dynamicStateInfo(const Na::ArrayVector<vk::DynamicState, t_InlineCapacity>& states)
 	{
 		vk::PipelineDynamicStateCreateInfo dynamic_state_info;
 		dynamic_state_info.dynamicStateCount = (u32)states.size();
@@ -18,26 +19,26 @@ namespace Na {
 		return viewport_state_info;
 	}
 
-	static vk::PipelineInputAssemblyStateCreateInfo inputAssemblyInfo(void)
+	static vk::PipelineInputAssemblyStateCreateInfo inputAssemblyInfo(const PipelineState& state)
 	{
 		vk::PipelineInputAssemblyStateCreateInfo input_assembly_info;
-		input_assembly_info.topology = vk::PrimitiveTopology::eTriangleList;
-		input_assembly_info.primitiveRestartEnable = VK_FALSE;
+		input_assembly_info.topology = state.topology;
+		input_assembly_info.primitiveRestartEnable = state.primitive_restart;
 		return input_assembly_info;
 	}
 
-	static vk::PipelineRasterizationStateCreateInfo rasterizationInfo(void)
+	static vk::PipelineRasterizationStateCreateInfo rasterizationInfo(const PipelineState& state)
 	{
 		vk::PipelineRasterizationStateCreateInfo rasterization_info;
 
 		rasterization_info.depthClampEnable = VK_FALSE;
 		rasterization_info.rasterizerDiscardEnable = VK_FALSE;
 
-		rasterization_info.polygonMode = vk::PolygonMode::eFill;
-		rasterization_info.lineWidth = 1.0f;
+		rasterization_info.polygonMode = state.polygon_mode;
+		rasterization_info.lineWidth = state.line_width;
 
-		rasterization_info.cullMode = vk::CullModeFlagBits::eBack;
-		rasterization_info.frontFace = vk::FrontFace::eCounterClockwise;
+		rasterization_info.cullMode = state.cull_mode;
+		rasterization_info.frontFace = state.front_face;
 
 		rasterization_info.depthBiasEnable = VK_FALSE;
 		rasterization_info.depthBiasConstantFactor = 0.0f;
@@ -47,14 +48,15 @@ namespace Na {
 		return rasterization_info;
 	}
 
-	static vk::PipelineMultisampleStateCreateInfo multisampleInfo(bool enabled)
+	static vk::PipelineMultisampleStateCreateInfo multisampleInfo(vk::SampleCountFlagBits samples, const PipelineState& state)
 	{
 		vk::PipelineMultisampleStateCreateInfo multisample_info;
 
-		multisample_info.rasterizationSamples = VkContext::GetMSAASamples(enabled);
+		multisample_info.rasterizationSamples = samples;
 
-		multisample_info.sampleShadingEnable = VK_TRUE;
-		multisample_info.minSampleShading = 0.2f;
+		// pointless with a single sample
+		multisample_info.sampleShadingEnable = samples != vk::SampleCountFlagBits::e1 && state.min_sample_shading > 0.0f;
+		multisample_info.minSampleShading = state.min_sample_shading;
 
 		multisample_info.pSampleMask = nullptr;
 		multisample_info.alphaToCoverageEnable = VK_FALSE;
@@ -62,7 +64,7 @@ namespace Na {
 		return multisample_info;
 	}
 
-	static vk::PipelineColorBlendAttachmentState colorBlendAttachment(bool enabled)
+	static vk::PipelineColorBlendAttachmentState colorBlendAttachment(BlendMode mode)
 	{
 		vk::PipelineColorBlendAttachmentState color_blend_attachment;
 		color_blend_attachment.colorWriteMask =
@@ -75,28 +77,43 @@ namespace Na {
 		color_blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eZero;
 		color_blend_attachment.alphaBlendOp = vk::BlendOp::eAdd;
 
-		if ((color_blend_attachment.blendEnable = enabled))
+		color_blend_attachment.blendEnable = mode != BlendMode::Opaque;
+		color_blend_attachment.colorBlendOp = vk::BlendOp::eAdd;
+
+		switch (mode)
 		{
+		case BlendMode::Opaque:
+			color_blend_attachment.srcColorBlendFactor = vk::BlendFactor::eOne;
+			color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eZero;
+			break;
+		case BlendMode::Alpha:
 			color_blend_attachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
 			color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
-			color_blend_attachment.colorBlendOp = vk::BlendOp::eAdd;
-		} else
-		{
+			color_blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+			break;
+		case BlendMode::Additive:
+			color_blend_attachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+			color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eOne;
+			color_blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eOne;
+			break;
+		case BlendMode::Premultiplied:
 			color_blend_attachment.srcColorBlendFactor = vk::BlendFactor::eOne;
-			color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eZero;
-			color_blend_attachment.colorBlendOp = vk::BlendOp::eAdd;
+			color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+			color_blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+			break;
 		}
 
 		return color_blend_attachment;
 	}
 
-	static vk::PipelineColorBlendStateCreateInfo colorBlendInfo(vk::PipelineColorBlendAttachmentState& color_blend_attachment)
+	template<u64 t_InlineCapacity>
+	static vk::PipelineColorBlendStateCreateInfo colorBlendInfo(const Na::ArrayVector<vk::PipelineColorBlendAttachmentState, t_InlineCapacity>& color_blend_attachments)
 	{
 		vk::PipelineColorBlendStateCreateInfo color_blend_info;
 		color_blend_info.logicOpEnable = VK_FALSE;
 		color_blend_info.logicOp = vk::LogicOp::eCopy;
-		color_blend_info.attachmentCount = 1;
-		color_blend_info.pAttachments = &color_blend_attachment;
+		color_blend_info.attachmentCount = (u32)color_blend_attachments.size();
+		color_blend_info.pAttachments = color_blend_attachments.ptr();
 		color_blend_info.blendConstants[0] = 0.0f;
 		color_blend_info.blendConstants[1] = 0.0f;
 		color_blend_info.blendConstants[2] = 0.0f;
@@ -104,12 +121,12 @@ namespace Na {
 		return color_blend_info;
 	}
 
-	static vk::PipelineDepthStencilStateCreateInfo depthStencilInfo(void)
+	static vk::PipelineDepthStencilStateCreateInfo depthStencilInfo(const PipelineState& state)
 	{
 		vk::PipelineDepthStencilStateCreateInfo depth_stencil_info;
-		depth_stencil_info.depthTestEnable = VK_TRUE;
-		depth_stencil_info.depthWriteEnable = VK_TRUE;
-		depth_stencil_info.depthCompareOp = vk::CompareOp::eLess;
+		depth_stencil_info.depthTestEnable = state.depth_test;
+		depth_stencil_info.depthWriteEnable = state.depth_write;
+		depth_stencil_info.depthCompareOp = state.depth_compare;
 		depth_stencil_info.minDepthBounds = 0.0f;
 		depth_stencil_info.maxDepthBounds = 1.0f;
 		depth_stencil_info.stencilTestEnable = VK_FALSE;
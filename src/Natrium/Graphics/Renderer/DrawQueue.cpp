@@ -0,0 +1,276 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/DrawQueue.hpp"
+
+#include "Natrium/Graphics/Renderer/Renderer.hpp"
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	// maps the float order onto the unsigned integer order
+	static u32 sortableDepth(float depth)
+	{
+		u32 bits;
+		memcpy(&bits, &depth, sizeof(bits));
+		return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+	}
+
+	// the fields that tell apart what two draws of the same vertex buffer draw
+	static u64 geometryHash(vk::Buffer index_buffer, u32 count, u32 first_index, i32 vertex_offset)
+	{
+		u64 hash = (u64)(VkBuffer)index_buffer * 0x9E3779B97F4A7C15ull;
+		hash = (hash ^ count) * 0xFF51AFD7ED558CCDull;
+		hash = (hash ^ first_index) * 0xFF51AFD7ED558CCDull;
+		hash = (hash ^ (u32)vertex_offset) * 0xC4CEB9FE1A85EC53ull;
+		return hash ^ (hash >> 33);
+	}
+
+	// appends size bytes, growing like the push data
+	static u32 appendBytes(ArrayList<Byte>& bytes, const void* data, u64 size)
+	{
+		return (u32)bytes.append_range((const Byte*)data, size);
+	}
+
+	void DrawQueue::submit(const DrawItem& item)
+	{
+		NA_ASSERT(item.pipeline, "Failed to submit draw: pipeline is null!");
+		NA_ASSERT(item.vertex_buffer || item.geometry_pool, "Failed to submit draw: vertex buffer is null!");
+		NA_ASSERT(!item.push_constant || item.push_data, "Failed to submit draw: push constant has no data!");
+		NA_ASSERT(!item.index_buffer || (u64)item.first_index + item.index_count <= item.index_buffer->count(), "Failed to submit draw: index range exceeds the index buffer!");
+		NA_ASSERT(!item.instance_stride || item.instance_data, "Failed to submit draw: instance stride without instance data!");
+
+		Draw draw{
+			.pipeline = item.pipeline,
+			.push_constant = item.push_constant,
+			.push_data_offset = 0,
+			.instance_stride = item.instance_stride,
+			.instance_data_offset = 0
+		};
+
+		if (item.geometry_pool)
+		{
+			NA_ASSERT(item.geometry, "Failed to submit draw: geometry is not allocated!");
+
+			draw.vertex_buffer = item.geometry_pool->vertex_buffer().buffer;
+			draw.index_buffer = item.geometry.index_count ? item.geometry_pool->index_buffer().buffer : nullptr;
+			draw.index_type = item.geometry_pool->index_type();
+			draw.count = item.geometry.index_count ? item.geometry.index_count : item.geometry.vertex_count;
+			draw.first_index = item.geometry.first_index;
+			draw.vertex_offset = (i32)item.geometry.first_vertex;
+		} else
+		{
+			draw.vertex_buffer = item.vertex_buffer->native();
+			draw.index_buffer = item.index_buffer ? item.index_buffer->native() : nullptr;
+			draw.index_type = item.index_buffer ? item.index_buffer->index_type() : vk::IndexType::eUint32;
+			draw.count = item.index_buffer ? (item.index_count ? item.index_count : item.index_buffer->count() - item.first_index) : item.vertex_count;
+			draw.first_index = item.index_buffer ? item.first_index : 0;
+			draw.vertex_offset = 0;
+		}
+
+		draw.instance_count = item.instance_count;
+		draw.first_instance = item.instance_stride ? 0 : item.first_instance;
+
+		if (item.push_constant)
+			draw.push_data_offset = appendBytes(m_PushData, item.push_data, item.push_constant->size);
+
+		if (item.instance_stride)
+			draw.instance_data_offset = appendBytes(m_InstanceData, item.instance_data, (u64)item.instance_count * item.instance_stride);
+
+		u64 pipeline = _key_index(m_PipelineIndices, item.pipeline, k_I16Max);
+		u64 vertex_buffer = _key_index(m_VertexBufferIndices, draw.vertex_buffer, k_U16Max);
+		u64 depth = sortableDepth(item.depth);
+
+		// instances can not be sorted within their draw anyway, so grouping them wins over depth
+		if (item.instance_stride && !item.translucent)
+		{
+			u64 geometry = geometryHash(draw.index_buffer, draw.count, draw.first_index, draw.vertex_offset);
+			depth = m_GeometryIndices.try_emplace(geometry, (u32)m_GeometryIndices.size()).first->second;
+		}
+
+		u64 key = item.translucent
+			? (1ull << 63) | ((u64)(u32)~depth << 31) | (pipeline << 16) | vertex_buffer
+			: (pipeline << 48) | (vertex_buffer << 32) | depth;
+
+		if (item.bounds.radius >= 0.0f)
+		{
+			m_Culler.add(item.bounds);
+			m_BoundedDraws.emplace((u32)m_Draws.size());
+		}
+
+		m_Entries.emplace(SortEntry{ key, (u32)m_Draws.size() });
+		m_Draws.emplace(draw);
+	}
+
+	u32 DrawQueue::cull(const Frustum& frustum)
+	{
+		if (m_Culler.empty())
+			return 0;
+
+		if (m_Visible.capacity() < m_Culler.size())
+			m_Visible.reallocate(m_Culler.size());
+		m_Visible.resize(m_Culler.size());
+
+		m_Culler.cull(frustum, m_Visible.ptr());
+
+		// entries are unsorted until flush, so both are ordered by draw index
+		u64 kept = 0;
+		u64 bounded = 0;
+		for (u64 i = 0; i < m_Entries.size(); i++)
+		{
+			u32 draw_index = m_Entries[i].draw_index;
+			while (bounded < m_BoundedDraws.size() && m_BoundedDraws[bounded] < draw_index)
+				bounded++;
+
+			if (bounded < m_BoundedDraws.size() && m_BoundedDraws[bounded] == draw_index && !m_Visible[bounded])
+				continue;
+
+			m_Entries[kept++] = m_Entries[i];
+		}
+
+		u32 culled = (u32)(m_Entries.size() - kept);
+		m_Entries.resize(kept);
+		m_CulledCount += culled;
+
+		return culled;
+	}
+
+	void DrawQueue::flush(Renderer& renderer, vk::CommandBuffer cmd_buffer)
+	{
+		m_Stats = {};
+		m_Stats.draws = (u32)m_Entries.size();
+		m_Stats.culled = m_CulledCount;
+
+		// stable keeps submission order among equal keys
+		std::stable_sort(
+			m_Entries.ptr(), m_Entries.ptr() + m_Entries.size(),
+			[](const SortEntry& a, const SortEntry& b) -> bool { return a.key < b.key; }
+		);
+
+		const GraphicsPipeline* bound_pipeline = nullptr;
+		vk::Buffer bound_vertex_buffer = nullptr;
+		vk::Buffer bound_index_buffer = nullptr;
+
+		const PushConstant* pushed = nullptr;
+		vk::PipelineLayout pushed_layout = nullptr;
+		u32 pushed_data_offset = 0;
+
+		for (u64 i = 0; i < m_Entries.size(); i++)
+		{
+			const Draw& draw = m_Draws[m_Entries[i].draw_index];
+
+			if (draw.pipeline != bound_pipeline)
+			{
+				renderer.bind_pipeline(cmd_buffer, *draw.pipeline);
+				bound_pipeline = draw.pipeline;
+				m_Stats.pipeline_binds++;
+			}
+
+			if (draw.vertex_buffer != bound_vertex_buffer)
+			{
+				cmd_buffer.bindVertexBuffers(0, { draw.vertex_buffer }, { 0 });
+				bound_vertex_buffer = draw.vertex_buffer;
+				m_Stats.vertex_buffer_binds++;
+			}
+
+			if (draw.index_buffer && draw.index_buffer != bound_index_buffer)
+			{
+				cmd_buffer.bindIndexBuffer(draw.index_buffer, 0, draw.index_type);
+				bound_index_buffer = draw.index_buffer;
+				m_Stats.index_buffer_binds++;
+			}
+
+			// push constants survive binding pipelines of the same layout
+			if (draw.push_constant)
+			{
+				const Byte* push_data = m_PushData.ptr() + draw.push_data_offset;
+				if (
+					!pushed ||
+					pushed_layout != draw.pipeline->layout() ||
+					pushed->shader_stage != draw.push_constant->shader_stage ||
+					pushed->offset != draw.push_constant->offset ||
+					pushed->size != draw.push_constant->size ||
+					memcmp(m_PushData.ptr() + pushed_data_offset, push_data, pushed->size)
+				)
+				{
+					renderer.set_push_constant(cmd_buffer, *draw.push_constant, push_data, *draw.pipeline);
+					pushed = draw.push_constant;
+					pushed_layout = draw.pipeline->layout();
+					pushed_data_offset = draw.push_data_offset;
+					m_Stats.push_constants++;
+				}
+			}
+
+			u32 instance_count = draw.instance_count;
+			u64 first_entry = i;
+
+			// without push constants nothing but the instance index (or the instance data) tells the draws apart
+			while (!draw.push_constant && i + 1 < m_Entries.size())
+			{
+				const Draw& next = m_Draws[m_Entries[i + 1].draw_index];
+				if (next.pipeline != draw.pipeline || next.vertex_buffer != draw.vertex_buffer ||
+					next.index_buffer != draw.index_buffer || next.count != draw.count || next.first_index != draw.first_index ||
+					next.vertex_offset != draw.vertex_offset || next.push_constant || next.instance_stride != draw.instance_stride)
+					break;
+
+				if (!draw.instance_stride && next.first_instance != draw.first_instance + instance_count)
+					break;
+
+				instance_count += next.instance_count;
+				i++;
+			}
+
+			if (draw.instance_stride)
+			{
+				TransientAllocation instances = renderer.allocate_instances((u64)instance_count * draw.instance_stride);
+				if (!instances)
+				{
+					g_Logger.fmt(Warn, "DrawQueue: Skipped {} instances, the instance buffer is full!", instance_count);
+					continue;
+				}
+
+				Byte* dst = (Byte*)instances.mapped;
+				for (u64 entry = first_entry; entry <= i; entry++)
+				{
+					const Draw& merged = m_Draws[m_Entries[entry].draw_index];
+					u64 size = (u64)merged.instance_count * merged.instance_stride;
+
+					memcpy(dst, m_InstanceData.ptr() + merged.instance_data_offset, size);
+					dst += size;
+				}
+
+				renderer.bind_instances(cmd_buffer, instances);
+				m_Stats.instance_binds++;
+			}
+
+			if (draw.index_buffer)
+				cmd_buffer.drawIndexed(draw.count, instance_count, draw.first_index, draw.vertex_offset, draw.first_instance);
+			else
+				cmd_buffer.draw(draw.count, instance_count, (u32)draw.vertex_offset, draw.first_instance);
+
+			m_Stats.draw_calls++;
+		}
+
+		this->clear();
+	}
+
+	void DrawQueue::clear(void)
+	{
+		m_Draws.resize(0);
+		m_Entries.resize(0);
+		m_PushData.resize(0);
+		m_InstanceData.resize(0);
+
+		m_Culler.clear();
+		m_BoundedDraws.resize(0);
+		m_CulledCount = 0;
+
+		m_PipelineIndices.clear();
+		m_VertexBufferIndices.clear();
+		m_GeometryIndices.clear();
+	}
+
+	u16 DrawQueue::_key_index(std::unordered_map<const void*, u16>& indices, const void* handle, u16 max_index)
+	{
+		// past max_index handles share a key, their draws are still recorded correctly
+		auto [it, inserted] = indices.try_emplace(handle, (u16)std::min<u64>(indices.size(), max_index));
+		return it->second;
+	}
+} // namespace Na
@@ -0,0 +1,110 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/DynamicResolution.hpp"
+
+namespace Na {
+	DynamicResolution::DynamicResolution(RendererCore& core, const DynamicResolutionInfo& info)
+	: m_Core(&core), m_Info(info), m_Scale(info.max_scale)
+	{
+		NA_VERIFY(core.upscaling(), "Failed to create dynamic resolution: RendererSettings::upscaling is disabled!");
+		NA_ASSERT(
+			0.0f < info.min_scale && info.min_scale <= info.max_scale && info.scale_step > 0.0f,
+			"Failed to create dynamic resolution: Invalid scale range {} to {} in steps of {}!",
+				info.min_scale,
+				info.max_scale,
+				info.scale_step
+		);
+
+		m_FrameTimes.resize(std::max(info.history, 1u));
+
+		this->_create_target();
+		m_Extent = this->_scaled(m_Scale);
+	}
+
+	vk::CommandBuffer DynamicResolution::begin(Renderer& renderer, const glm::vec4& clear_color)
+	{
+		NA_ASSERT(&renderer.core() == m_Core, "Failed to begin dynamic resolution: Renderer belongs to another core!");
+
+		if (renderer.gpu_profiler().enabled())
+			this->_update(renderer.gpu_report());
+
+		// the core was resized, the target follows it
+		if (m_Target.extent() != this->_scaled(m_Info.max_scale))
+			this->_create_target();
+
+		m_Extent = this->_scaled(m_Scale);
+		m_FrameScales[renderer.submitted_frames() % k_ScaleHistory] = m_Scale;
+
+		vk::CommandBuffer cmd_buffer = renderer.begin_target(m_Target, clear_color);
+
+		// flipped like the target's own viewport
+		vk::Viewport viewport;
+		viewport.x = 0.0f;
+		viewport.y = (float)m_Extent.height;
+		viewport.width = (float)m_Extent.width;
+		viewport.height = -(float)m_Extent.height;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		vk::Rect2D scissor(vk::Offset2D{ 0, 0 }, m_Extent);
+
+		cmd_buffer.setViewport(0, 1, &viewport);
+		cmd_buffer.setScissor(0, 1, &scissor);
+
+		return cmd_buffer;
+	}
+
+	void DynamicResolution::end(Renderer& renderer)
+	{
+		renderer.end_target(m_Target);
+		renderer.upscale(m_Target, m_Extent);
+	}
+
+	void DynamicResolution::_create_target(void)
+	{
+		m_Target = RenderTarget(RenderTargetInfo{
+			.extent = this->_scaled(m_Info.max_scale),
+			.color_format = m_Core->swapchain_format().format,
+			.depth_format = m_Info.depth_format,
+			.samples = m_Info.samples,
+			.final_layout = vk::ImageLayout::eShaderReadOnlyOptimal
+		});
+	}
+
+	void DynamicResolution::_update(const GpuFrameReport& report)
+	{
+		if (report.frame == m_LastReport || report.duration <= 0.0)
+			return;
+		m_LastReport = report.frame;
+
+		// 0 if the frame was not rendered through the target
+		float frame_scale = m_FrameScales[report.frame % k_ScaleHistory];
+		if (frame_scale <= 0.0f)
+			return;
+
+		m_FrameTimes[m_FrameTimeCount++ % m_FrameTimes.size()] = report.duration / ((double)frame_scale * frame_scale);
+
+		u64 count = std::min<u64>(m_FrameTimeCount, m_FrameTimes.size());
+		double sum = 0.0;
+		for (u64 i = 0; i < count; i++)
+			sum += m_FrameTimes[i];
+		m_FullFrameTime = sum / (double)count;
+
+		// the pixel count is what scales, so the side length goes with the square root,
+		// rounding down holds the target rather than overshooting it
+		float scale = (float)std::sqrt(m_Info.target_frame_time / m_FullFrameTime);
+		scale = std::floor(scale / m_Info.scale_step) * m_Info.scale_step;
+
+		// a slow frame is fixed right away, a fast one might just be an easy view
+		scale = std::min(scale, m_Scale + m_Info.max_growth);
+
+		m_Scale = std::clamp(scale, m_Info.min_scale, m_Info.max_scale);
+	}
+
+	vk::Extent2D DynamicResolution::_scaled(float scale) const
+	{
+		return vk::Extent2D{
+			std::max(1u, (u32)std::lround(m_Core->width() * scale)),
+			std::max(1u, (u32)std::lround(m_Core->height() * scale))
+		};
+	}
+} // namespace Na
\ No newline at end of file
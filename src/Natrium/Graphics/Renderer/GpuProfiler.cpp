@@ -0,0 +1,248 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/GpuProfiler.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	static constexpr vk::QueryPipelineStatisticFlags k_PipelineStatistics =
+		vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+		vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+		vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+		vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+		vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+		vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+	// the statistics followed by availability
+	static constexpr u32 k_StatisticsStride = sizeof(GpuPipelineStatistics) / sizeof(u64) + 1;
+
+	GpuProfiler::GpuProfiler(u32 frame_count, u32 max_scopes, bool pipeline_statistics)
+	: m_MaxScopes(max_scopes)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		u32 valid_bits = VkContext::GetQueueFamilyProperties()[VkContext::GetQueueFamilyIndices().graphics].timestampValidBits;
+		if (!valid_bits)
+		{
+			g_Logger(Warn, "Graphics queue does not support timestamps, gpu profiling is disabled!");
+			return;
+		}
+
+		m_TimestampMask = valid_bits >= 64 ? k_U64Max : (1ull << valid_bits) - 1;
+		m_TimestampPeriod = (double)VkContext::GetPhysicalDeviceLimits().timestampPeriod;
+
+		m_PipelineStatistics = pipeline_statistics && VkContext::GetDeviceFeatures().pipeline_statistics_query;
+		if (pipeline_statistics && !m_PipelineStatistics)
+			g_Logger(Warn, "Pipeline statistics queries are not supported, only timestamps are collected!");
+
+		u32 query_count = m_MaxScopes + 1; // + the frame
+
+		m_Frames = std::vector<FrameQueries>(frame_count);
+		for (FrameQueries& fq : m_Frames)
+		{
+			vk::QueryPoolCreateInfo timestamp_info;
+			timestamp_info.queryType = vk::QueryType::eTimestamp;
+			timestamp_info.queryCount = query_count * 2;
+
+			fq.timestamps = logical_device.createQueryPool(timestamp_info);
+
+			if (m_PipelineStatistics)
+			{
+				vk::QueryPoolCreateInfo statistics_info;
+				statistics_info.queryType = vk::QueryType::ePipelineStatistics;
+				statistics_info.queryCount = query_count;
+				statistics_info.pipelineStatistics = k_PipelineStatistics;
+
+				fq.statistics = logical_device.createQueryPool(statistics_info);
+			}
+
+			fq.names.resize(query_count);
+			fq.has_statistics.resize(query_count);
+		}
+
+		m_Results.resize(query_count * 2 * 2 + query_count * k_StatisticsStride);
+	}
+
+	void GpuProfiler::destroy(void)
+	{
+		if (m_Frames.empty())
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		for (FrameQueries& fq : m_Frames)
+		{
+			logical_device.destroyQueryPool(fq.timestamps);
+			logical_device.destroyQueryPool(fq.statistics);
+		}
+
+		m_Frames.clear();
+	}
+
+	bool GpuProfiler::resolve(u32 frame_index)
+	{
+		if (m_Frames.empty())
+			return false;
+
+		FrameQueries& fq = m_Frames[frame_index];
+		if (!fq.recorded)
+			return false;
+		fq.recorded = false;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		u32 scope_count = fq.scope_count.load();
+		u32 count = std::min(scope_count, m_MaxScopes + 1);
+
+		// value and availability per query, unavailable ones are scopes that never ended
+		u64* timestamps = m_Results.data();
+		vk::Result result = logical_device.getQueryPoolResults(
+			fq.timestamps,
+			0, count * 2,
+			count * 2 * 2 * sizeof(u64), timestamps,
+			2 * sizeof(u64),
+			vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability
+		);
+		if (result != vk::Result::eNotReady)
+			NA_VERIFY_VK(result, "Failed to resolve gpu profiler queries of frame #{}!", frame_index);
+
+		u64* statistics = timestamps + count * 2 * 2;
+		if (m_PipelineStatistics)
+		{
+			result = logical_device.getQueryPoolResults(
+				fq.statistics,
+				0, count,
+				count * k_StatisticsStride * sizeof(u64), statistics,
+				k_StatisticsStride * sizeof(u64),
+				vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability
+			);
+			if (result != vk::Result::eNotReady)
+				NA_VERIFY_VK(result, "Failed to resolve gpu profiler statistics of frame #{}!", frame_index);
+		}
+
+		auto timestamp = [timestamps, this](u32 query, u64& value) -> bool
+		{
+			value = timestamps[query * 2] & m_TimestampMask;
+			return timestamps[query * 2 + 1];
+		};
+
+		u64 frame_begin, frame_end;
+		if (!timestamp(0, frame_begin) || !timestamp(1, frame_end))
+			return false;
+
+		double ms_per_tick = m_TimestampPeriod / 1'000'000.0;
+
+		m_Report.frame = fq.frame;
+		m_Report.duration = (double)(frame_end - frame_begin) * ms_per_tick;
+		m_Report.dropped_scopes = scope_count - count;
+		m_Report.scopes.clear();
+
+		for (u32 scope = 1; scope < count; scope++)
+		{
+			u64 begin, end;
+			if (!timestamp(scope * 2, begin) || !timestamp(scope * 2 + 1, end))
+				continue;
+
+			GpuScopeTiming& timing = m_Report.scopes.emplace_back();
+			timing.name = std::move(fq.names[scope]);
+			timing.start = (double)(begin - frame_begin) * ms_per_tick;
+			timing.duration = (double)(end - begin) * ms_per_tick;
+
+			const u64* values = statistics + scope * k_StatisticsStride;
+			timing.has_statistics = fq.has_statistics[scope] && values[k_StatisticsStride - 1];
+			if (timing.has_statistics)
+				memcpy(&timing.statistics, values, sizeof(GpuPipelineStatistics));
+		}
+
+		return true;
+	}
+
+	void GpuProfiler::begin_frame(vk::CommandBuffer cmd_buffer, u32 frame_index, u64 frame)
+	{
+		if (m_Frames.empty())
+			return;
+
+		m_FrameIndex = frame_index;
+		FrameQueries& fq = m_Frames[frame_index];
+
+		u32 query_count = m_MaxScopes + 1;
+		cmd_buffer.resetQueryPool(fq.timestamps, 0, query_count * 2);
+		if (m_PipelineStatistics)
+			cmd_buffer.resetQueryPool(fq.statistics, 0, query_count);
+
+		fq.scope_count.store(1);
+		fq.frame = frame;
+		fq.recorded = true;
+
+		cmd_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, fq.timestamps, 0);
+	}
+
+	void GpuProfiler::end_frame(vk::CommandBuffer cmd_buffer)
+	{
+		if (m_Frames.empty())
+			return;
+
+		cmd_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_Frames[m_FrameIndex].timestamps, 1);
+	}
+
+	GpuScope GpuProfiler::begin_scope(vk::CommandBuffer cmd_buffer, std::string_view name, bool statistics)
+	{
+		if (m_Frames.empty())
+			return k_NullGpuScope;
+
+		FrameQueries& fq = m_Frames[m_FrameIndex];
+
+		// every scope owns its own slots, so worker threads never touch the same ones
+		GpuScope scope = fq.scope_count.fetch_add(1, std::memory_order_relaxed);
+		if (scope > m_MaxScopes)
+			return k_NullGpuScope;
+
+		fq.names[scope] = name;
+		fq.has_statistics[scope] = statistics && m_PipelineStatistics;
+
+		cmd_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, fq.timestamps, scope * 2);
+		if (fq.has_statistics[scope])
+			cmd_buffer.beginQuery(fq.statistics, scope, {});
+
+		return scope;
+	}
+
+	void GpuProfiler::end_scope(vk::CommandBuffer cmd_buffer, GpuScope scope)
+	{
+		if (scope == k_NullGpuScope)
+			return;
+
+		FrameQueries& fq = m_Frames[m_FrameIndex];
+
+		if (fq.has_statistics[scope])
+			cmd_buffer.endQuery(fq.statistics, scope);
+		cmd_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, fq.timestamps, scope * 2 + 1);
+	}
+
+	GpuProfiler::GpuProfiler(GpuProfiler&& other)
+	: m_Frames(std::move(other.m_Frames)),
+	m_FrameIndex(other.m_FrameIndex),
+	m_MaxScopes(other.m_MaxScopes),
+	m_PipelineStatistics(other.m_PipelineStatistics),
+	m_TimestampPeriod(other.m_TimestampPeriod),
+	m_TimestampMask(other.m_TimestampMask),
+	m_Report(std::move(other.m_Report)),
+	m_Results(std::move(other.m_Results))
+	{}
+
+	GpuProfiler& GpuProfiler::operator=(GpuProfiler&& other)
+	{
+		this->destroy();
+
+		m_Frames = std::move(other.m_Frames);
+		m_FrameIndex = other.m_FrameIndex;
+		m_MaxScopes = other.m_MaxScopes;
+		m_PipelineStatistics = other.m_PipelineStatistics;
+		m_TimestampPeriod = other.m_TimestampPeriod;
+		m_TimestampMask = other.m_TimestampMask;
+		m_Report = std::move(other.m_Report);
+		m_Results = std::move(other.m_Results);
+
+		return *this;
+	}
+} // namespace Na
@@ -0,0 +1,817 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/RenderGraph.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	static constexpr vk::AccessFlags k_WriteAccess = vk::AccessFlagBits::eShaderWrite
+		| vk::AccessFlagBits::eColorAttachmentWrite
+		| vk::AccessFlagBits::eDepthStencilAttachmentWrite
+		| vk::AccessFlagBits::eTransferWrite;
+
+	static bool isDepthFormat(vk::Format format)
+	{
+		switch (format)
+		{
+		case vk::Format::eD16Unorm:
+		case vk::Format::eX8D24UnormPack32:
+		case vk::Format::eD32Sfloat:
+		case vk::Format::eD16UnormS8Uint:
+		case vk::Format::eD24UnormS8Uint:
+		case vk::Format::eD32SfloatS8Uint:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static bool hasStencil(vk::Format format)
+	{
+		return format == vk::Format::eD16UnormS8Uint
+			|| format == vk::Format::eD24UnormS8Uint
+			|| format == vk::Format::eD32SfloatS8Uint;
+	}
+
+	static bool isWrite(RenderGraphAccess access)
+	{
+		return access == RenderGraphAccess::ColorAttachment
+			|| access == RenderGraphAccess::DepthAttachment
+			|| access == RenderGraphAccess::StorageWrite;
+	}
+
+	static vk::ImageUsageFlags usageOf(RenderGraphAccess access)
+	{
+		switch (access)
+		{
+		case RenderGraphAccess::ColorAttachment: return vk::ImageUsageFlagBits::eColorAttachment;
+		case RenderGraphAccess::DepthAttachment: return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+		case RenderGraphAccess::Sampled:         return vk::ImageUsageFlagBits::eSampled;
+		case RenderGraphAccess::StorageRead:
+		case RenderGraphAccess::StorageWrite:    return vk::ImageUsageFlagBits::eStorage;
+		}
+		return {};
+	}
+
+	static vk::PipelineStageFlags shaderStages(RenderGraphPassType type)
+	{
+		return type == RenderGraphPassType::Compute
+			? vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader)
+			: vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+	}
+
+	template<typename t_State>
+	static t_State accessState(RenderGraphAccess access, RenderGraphPassType type)
+	{
+		switch (access)
+		{
+		case RenderGraphAccess::ColorAttachment:
+			return {
+				vk::ImageLayout::eColorAttachmentOptimal,
+				vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite
+			};
+		case RenderGraphAccess::DepthAttachment:
+			return {
+				vk::ImageLayout::eDepthStencilAttachmentOptimal,
+				vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+				vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite
+			};
+		case RenderGraphAccess::Sampled:
+			return { vk::ImageLayout::eShaderReadOnlyOptimal, shaderStages(type), vk::AccessFlagBits::eShaderRead };
+		case RenderGraphAccess::StorageRead:
+			return { vk::ImageLayout::eGeneral, shaderStages(type), vk::AccessFlagBits::eShaderRead };
+		case RenderGraphAccess::StorageWrite:
+			return { vk::ImageLayout::eGeneral, shaderStages(type), vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite };
+		}
+		return {};
+	}
+
+	// how the image is used after the graph, attachments and sampling are assumed to happen in graphics
+	static RenderGraphPassType outputPassType(RenderGraphAccess access)
+	{
+		return access == RenderGraphAccess::StorageRead || access == RenderGraphAccess::StorageWrite
+			? RenderGraphPassType::Compute
+			: RenderGraphPassType::Graphics;
+	}
+
+	RenderGraphPass& RenderGraphPass::color(RenderGraphImage image, const glm::vec4& clear_color, bool clear)
+	{
+		NA_ASSERT(m_Type == RenderGraphPassType::Graphics, "Failed to add color attachment to pass {}: not a graphics pass!", m_Name);
+
+		Use& use = m_Uses.emplace_back(Use{ image, RenderGraphAccess::ColorAttachment, clear });
+		use.clear_value.color = std::array<float, 4>{ clear_color.r, clear_color.g, clear_color.b, clear_color.a };
+		return *this;
+	}
+
+	RenderGraphPass& RenderGraphPass::depth(RenderGraphImage image, float clear_depth, bool clear)
+	{
+		NA_ASSERT(m_Type == RenderGraphPassType::Graphics, "Failed to add depth attachment to pass {}: not a graphics pass!", m_Name);
+
+		Use& use = m_Uses.emplace_back(Use{ image, RenderGraphAccess::DepthAttachment, clear });
+		use.clear_value.depthStencil = vk::ClearDepthStencilValue{ clear_depth, 0 };
+		return *this;
+	}
+
+	RenderGraphPass& RenderGraphPass::_use(RenderGraphImage image, RenderGraphAccess access)
+	{
+		m_Uses.emplace_back(Use{ image, access });
+		return *this;
+	}
+
+	GraphicsPipelineTarget RenderGraphPass::target(void) const
+	{
+		NA_ASSERT(m_RenderPass, "Failed to get target of pass {}: pass is culled or the graph is not compiled!", m_Name);
+
+		return GraphicsPipelineTarget{
+			.render_pass = m_RenderPass,
+			.samples = m_Samples,
+			.color_attachment_count = m_ColorCount
+		};
+	}
+
+	void RenderGraph::destroy(void)
+	{
+		this->_release();
+
+		m_Passes.clear();
+		m_Images.clear();
+	}
+
+	RenderGraph::RenderGraph(RenderGraph&& other)
+	: m_Passes(std::exchange(other.m_Passes, {})),
+	m_Images(std::exchange(other.m_Images, {})),
+	m_Order(std::exchange(other.m_Order, {})),
+	m_PassBarriers(std::exchange(other.m_PassBarriers, {})),
+	m_OutputBarriers(std::exchange(other.m_OutputBarriers, {})),
+	m_Slots(std::exchange(other.m_Slots, {})),
+	m_UnaliasedSize(std::exchange(other.m_UnaliasedSize, 0)),
+	m_Compiled(std::exchange(other.m_Compiled, false))
+	{}
+
+	RenderGraph& RenderGraph::operator=(RenderGraph&& other)
+	{
+		this->destroy();
+		m_Passes = std::exchange(other.m_Passes, {});
+		m_Images = std::exchange(other.m_Images, {});
+		m_Order = std::exchange(other.m_Order, {});
+		m_PassBarriers = std::exchange(other.m_PassBarriers, {});
+		m_OutputBarriers = std::exchange(other.m_OutputBarriers, {});
+		m_Slots = std::exchange(other.m_Slots, {});
+		m_UnaliasedSize = std::exchange(other.m_UnaliasedSize, 0);
+		m_Compiled = std::exchange(other.m_Compiled, false);
+		return *this;
+	}
+
+	RenderGraphImage RenderGraph::create_image(const RenderGraphImageInfo& info)
+	{
+		NA_ASSERT(info.extent.width && info.extent.height, "Failed to create render graph image: extent is empty!");
+
+		m_Images.emplace_back(Image{ .info = info });
+		return (RenderGraphImage)m_Images.size() - 1;
+	}
+
+	void RenderGraph::mark_output(RenderGraphImage image, RenderGraphAccess access)
+	{
+		m_Images[image].output = true;
+		m_Images[image].output_access = access;
+	}
+
+	RenderGraphPass& RenderGraph::add_pass(std::string_view name, RenderGraphPassType type, RenderGraphPass::Callback callback)
+	{
+		RenderGraphPass& pass = m_Passes.emplace_back();
+		pass.m_Name = name;
+		pass.m_Type = type;
+		pass.m_Callback = std::move(callback);
+		return pass;
+	}
+
+	void RenderGraph::compile(void)
+	{
+		this->_release();
+
+		this->_order_passes();
+		this->_create_images();
+		this->_create_barriers();
+
+		for (u32 k = 0; k < m_Order.size(); k++)
+			if (m_Passes[m_Order[k]].m_Type == RenderGraphPassType::Graphics)
+				this->_create_render_pass(m_Passes[m_Order[k]], k);
+
+		m_Compiled = true;
+	}
+
+	void RenderGraph::execute(vk::CommandBuffer cmd_buffer) const
+	{
+		NA_ASSERT(m_Compiled, "Failed to execute render graph: graph is not compiled!");
+
+		for (u64 i = 0; i < m_Order.size(); i++)
+		{
+			const RenderGraphPass& pass = m_Passes[m_Order[i]];
+
+			_record_barriers(cmd_buffer, m_PassBarriers[i]);
+
+			if (!pass.m_RenderPass)
+			{
+				pass.m_Callback(cmd_buffer);
+				continue;
+			}
+
+			vk::RenderPassBeginInfo render_pass_info;
+			render_pass_info.renderPass = pass.m_RenderPass;
+			render_pass_info.framebuffer = pass.m_Framebuffer;
+			render_pass_info.renderArea.offset = { { 0, 0 } };
+			render_pass_info.renderArea.extent = pass.m_Extent;
+			render_pass_info.clearValueCount = (u32)pass.m_ClearValues.size();
+			render_pass_info.pClearValues = pass.m_ClearValues.data();
+
+			cmd_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
+
+			// flipped like the renderer core's viewport
+			vk::Viewport viewport(0.0f, (float)pass.m_Extent.height, (float)pass.m_Extent.width, -(float)pass.m_Extent.height, 0.0f, 1.0f);
+			vk::Rect2D scissor({ 0, 0 }, pass.m_Extent);
+			cmd_buffer.setViewport(0, 1, &viewport);
+			cmd_buffer.setScissor(0, 1, &scissor);
+
+			pass.m_Callback(cmd_buffer);
+
+			cmd_buffer.endRenderPass();
+		}
+
+		_record_barriers(cmd_buffer, m_OutputBarriers);
+	}
+
+	vk::Image RenderGraph::image(RenderGraphImage image) const
+	{
+		NA_ASSERT(m_Images[image].img, "Failed to get render graph image #{}: image is unused or the graph is not compiled!", image);
+		return m_Images[image].img;
+	}
+
+	vk::ImageView RenderGraph::image_view(RenderGraphImage image) const
+	{
+		NA_ASSERT(m_Images[image].view, "Failed to get render graph image view #{}: image is unused or the graph is not compiled!", image);
+		return m_Images[image].view;
+	}
+
+	vk::DeviceSize RenderGraph::aliased_size(void) const
+	{
+		vk::DeviceSize size = 0;
+		for (const MemorySlot& slot : m_Slots)
+			size += slot.requirements.size;
+		return size;
+	}
+
+	void RenderGraph::_order_passes(void)
+	{
+		u32 pass_count = (u32)m_Passes.size();
+
+		std::vector<std::vector<u32>> dependencies(pass_count); // every ordering constraint
+		std::vector<std::vector<u32>> producers(pass_count); // only the passes whose results are read
+
+		std::vector<std::vector<u32>> writers(m_Images.size());
+		for (u32 i = 0; i < pass_count; i++)
+			for (const RenderGraphPass::Use& use : m_Passes[i].m_Uses)
+				if (isWrite(use.access) && (writers[use.image].empty() || writers[use.image].back() != i))
+					writers[use.image].push_back(i);
+
+		std::vector<u32> last_writer(m_Images.size(), k_U32Max);
+		std::vector<std::vector<u32>> readers(m_Images.size()); // since the last writer
+
+		for (u32 i = 0; i < pass_count; i++)
+		{
+			const RenderGraphPass& pass = m_Passes[i];
+
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+			{
+				bool reads = !isWrite(use.access) || (!use.clear && use.access != RenderGraphAccess::StorageWrite);
+				if (!reads)
+					continue;
+
+				u32 producer = last_writer[use.image];
+				if (producer == k_U32Max)
+				{
+					for (u32 writer : writers[use.image])
+						if (writer > i)
+						{
+							producer = writer;
+							break;
+						}
+				} else
+				{
+					readers[use.image].push_back(i);
+				}
+
+				if (producer != k_U32Max && producer != i)
+				{
+					dependencies[i].push_back(producer);
+					producers[i].push_back(producer);
+				}
+			}
+
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+			{
+				if (!isWrite(use.access) || last_writer[use.image] == i)
+					continue;
+
+				if (last_writer[use.image] != k_U32Max)
+					dependencies[i].push_back(last_writer[use.image]);
+
+				for (u32 reader : readers[use.image])
+					if (reader != i)
+						dependencies[i].push_back(reader);
+
+				readers[use.image].clear();
+				last_writer[use.image] = i;
+			}
+		}
+
+		// culling, walks back from outputs and side effects along the results that are read
+		std::vector<u32> stack;
+		for (u32 i = 0; i < pass_count; i++)
+		{
+			RenderGraphPass& pass = m_Passes[i];
+			pass.m_Culled = !pass.m_SideEffect;
+
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+				if (isWrite(use.access) && m_Images[use.image].output)
+					pass.m_Culled = false;
+
+			if (!pass.m_Culled)
+				stack.push_back(i);
+		}
+
+		while (!stack.empty())
+		{
+			u32 i = stack.back();
+			stack.pop_back();
+
+			for (u32 producer : producers[i])
+				if (m_Passes[producer].m_Culled)
+				{
+					m_Passes[producer].m_Culled = false;
+					stack.push_back(producer);
+				}
+		}
+
+		// topological order, ties go to the pass declared first
+		std::vector<u32> remaining(pass_count, 0);
+		std::vector<std::vector<u32>> dependents(pass_count);
+		for (u32 i = 0; i < pass_count; i++)
+		{
+			if (m_Passes[i].m_Culled)
+				continue;
+
+			std::sort(dependencies[i].begin(), dependencies[i].end());
+			dependencies[i].erase(std::unique(dependencies[i].begin(), dependencies[i].end()), dependencies[i].end());
+
+			for (u32 dependency : dependencies[i])
+				if (!m_Passes[dependency].m_Culled)
+				{
+					remaining[i]++;
+					dependents[dependency].push_back(i);
+				}
+		}
+
+		std::set<u32> ready;
+		u32 alive_count = 0;
+		for (u32 i = 0; i < pass_count; i++)
+			if (!m_Passes[i].m_Culled)
+			{
+				alive_count++;
+				if (!remaining[i])
+					ready.insert(i);
+			}
+
+		while (!ready.empty())
+		{
+			u32 i = *ready.begin();
+			ready.erase(ready.begin());
+			m_Order.push_back(i);
+
+			for (u32 dependent : dependents[i])
+				if (!--remaining[dependent])
+					ready.insert(dependent);
+		}
+
+		if (m_Order.size() != alive_count)
+			throw std::runtime_error("Failed to compile render graph: Passes depend on each other in a cycle!");
+	}
+
+	void RenderGraph::_create_images(void)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		u32 order_count = (u32)m_Order.size();
+
+		for (u32 k = 0; k < order_count; k++)
+		{
+			const RenderGraphPass& pass = m_Passes[m_Order[k]];
+
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+			{
+				Image& image = m_Images[use.image];
+
+				if (image.first_use == k_U32Max)
+				{
+					image.first_use = k;
+
+					// content from the previous frame is read, so nothing else may use the memory
+					bool discards = isWrite(use.access) && (use.clear || use.access == RenderGraphAccess::StorageWrite);
+					for (const RenderGraphPass::Use& other : pass.m_Uses)
+						if (other.image == use.image && !isWrite(other.access))
+							discards = false;
+					image.persistent |= !discards;
+				}
+
+				image.last_use = k;
+				image.usage |= usageOf(use.access);
+			}
+		}
+
+		std::vector<RenderGraphImage> by_size;
+		std::vector<vk::MemoryRequirements> requirements(m_Images.size());
+
+		for (RenderGraphImage i = 0; i < m_Images.size(); i++)
+		{
+			Image& image = m_Images[i];
+			if (image.first_use == k_U32Max)
+				continue;
+
+			if (image.output)
+			{
+				image.persistent = true;
+				image.usage |= usageOf(image.output_access);
+			}
+
+			if (image.persistent)
+			{
+				image.first_use = 0;
+				image.last_use = order_count;
+			}
+
+			image.aspect = isDepthFormat(image.info.format)
+				? (hasStencil(image.info.format) ? vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil : vk::ImageAspectFlagBits::eDepth)
+				: vk::ImageAspectFlagBits::eColor;
+
+			vk::ImageCreateInfo create_info;
+			create_info.imageType = vk::ImageType::e2D;
+			create_info.extent = vk::Extent3D{ image.info.extent.width, image.info.extent.height, 1 };
+			create_info.mipLevels = 1;
+			create_info.arrayLayers = 1;
+			create_info.format = image.info.format;
+			create_info.tiling = vk::ImageTiling::eOptimal;
+			create_info.initialLayout = vk::ImageLayout::eUndefined;
+			create_info.usage = image.usage;
+			create_info.sharingMode = vk::SharingMode::eExclusive;
+			create_info.samples = image.info.samples;
+
+			image.img = logical_device.createImage(create_info);
+			requirements[i] = logical_device.getImageMemoryRequirements(image.img);
+
+			m_UnaliasedSize += requirements[i].size;
+			by_size.push_back(i);
+		}
+
+		// largest first, each image goes into the first slot it does not overlap with
+		std::stable_sort(
+			by_size.begin(), by_size.end(),
+			[&requirements](RenderGraphImage a, RenderGraphImage b) -> bool { return requirements[a].size > requirements[b].size; }
+		);
+
+		for (RenderGraphImage i : by_size)
+		{
+			Image& image = m_Images[i];
+
+			for (u32 s = 0; s < m_Slots.size() && image.slot == k_U32Max; s++)
+			{
+				MemorySlot& slot = m_Slots[s];
+				if (!(slot.requirements.memoryTypeBits & requirements[i].memoryTypeBits))
+					continue;
+
+				bool overlaps = false;
+				for (RenderGraphImage other : slot.images)
+					if (image.first_use <= m_Images[other].last_use && m_Images[other].first_use <= image.last_use)
+					{
+						overlaps = true;
+						break;
+					}
+
+				if (overlaps)
+					continue;
+
+				slot.requirements.size = std::max(slot.requirements.size, requirements[i].size);
+				slot.requirements.alignment = std::max(slot.requirements.alignment, requirements[i].alignment);
+				slot.requirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+				slot.images.push_back(i);
+				image.slot = s;
+			}
+
+			if (image.slot == k_U32Max)
+			{
+				image.slot = (u32)m_Slots.size();
+				m_Slots.push_back(MemorySlot{ .requirements = requirements[i], .images = { i } });
+			}
+		}
+
+		for (MemorySlot& slot : m_Slots)
+		{
+			std::sort(
+				slot.images.begin(), slot.images.end(),
+				[this](RenderGraphImage a, RenderGraphImage b) -> bool { return m_Images[a].first_use < m_Images[b].first_use; }
+			);
+
+			slot.allocation = VkContext::GetDeviceAllocator().allocate(
+				slot.requirements,
+				vk::MemoryPropertyFlagBits::eDeviceLocal,
+				false, // optimal tiling
+				DeviceMemoryCategory::Attachment
+			);
+
+			for (RenderGraphImage i : slot.images)
+			{
+				logical_device.bindImageMemory(m_Images[i].img, slot.allocation.memory, slot.allocation.offset);
+				m_Images[i].view = CreateImageView(m_Images[i].img, m_Images[i].aspect, m_Images[i].info.format);
+			}
+		}
+	}
+
+	void RenderGraph::_create_barriers(void)
+	{
+		u32 order_count = (u32)m_Order.size();
+
+		// merges every use of an image in a pass into one state
+		auto pass_state = [this](const RenderGraphPass& pass, RenderGraphImage image) -> ImageState {
+			ImageState state{};
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+			{
+				if (use.image != image)
+					continue;
+
+				ImageState use_state = accessState<ImageState>(use.access, pass.m_Type);
+				NA_ASSERT(
+					state.layout == vk::ImageLayout::eUndefined || state.layout == use_state.layout,
+					"Failed to compile render graph: pass {} uses image #{} in two different layouts!",
+						pass.m_Name,
+						image
+				);
+
+				state.layout = use_state.layout;
+				state.stages |= use_state.stages;
+				state.access |= use_state.access;
+			}
+			return state;
+		};
+
+		for (u32 k = 0; k < order_count; k++)
+		{
+			const RenderGraphPass& pass = m_Passes[m_Order[k]];
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+				m_Images[use.image].final_state = pass_state(pass, use.image);
+		}
+
+		for (Image& image : m_Images)
+			if (image.output && image.img)
+				image.final_state = accessState<ImageState>(image.output_access, outputPassType(image.output_access));
+
+		std::vector<ImageState> current(m_Images.size());
+		std::vector<bool> seen(m_Images.size(), false);
+
+		auto transition = [&](Barriers& barriers, RenderGraphImage i, const ImageState& next) -> void {
+			const Image& image = m_Images[i];
+			ImageState& prev = current[i];
+
+			if (prev.layout == next.layout && !(prev.access & k_WriteAccess) && !(next.access & k_WriteAccess))
+			{
+				// read after read, only widens the stages that have to wait for the next write
+				prev.stages |= next.stages;
+				prev.access |= next.access;
+				return;
+			}
+
+			vk::ImageMemoryBarrier barrier;
+			barrier.oldLayout = prev.layout;
+			barrier.newLayout = next.layout;
+			barrier.srcAccessMask = prev.access & k_WriteAccess;
+			barrier.dstAccessMask = next.access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image.img;
+			barrier.subresourceRange = vk::ImageSubresourceRange(image.aspect, 0, 1, 0, 1);
+
+			barriers.src_stages |= prev.stages ? prev.stages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+			barriers.dst_stages |= next.stages;
+			barriers.image_barriers.push_back(barrier);
+
+			prev = next;
+		};
+
+		m_PassBarriers.resize(order_count);
+		for (u32 k = 0; k < order_count; k++)
+		{
+			const RenderGraphPass& pass = m_Passes[m_Order[k]];
+
+			for (u64 u = 0; u < pass.m_Uses.size(); u++)
+			{
+				RenderGraphImage i = pass.m_Uses[u].image;
+
+				bool handled = false;
+				for (u64 v = 0; v < u; v++)
+					handled |= pass.m_Uses[v].image == i;
+				if (handled)
+					continue;
+
+				if (!seen[i])
+				{
+					seen[i] = true;
+
+					const Image& image = m_Images[i];
+					const MemorySlot& slot = m_Slots[image.slot];
+
+					// waits for the previous frame's last use, and for the previous user of the memory
+					current[i] = image.final_state;
+					if (!image.persistent)
+					{
+						current[i].layout = vk::ImageLayout::eUndefined;
+
+						u64 position = std::find(slot.images.begin(), slot.images.end(), i) - slot.images.begin();
+						RenderGraphImage previous = slot.images[(position + slot.images.size() - 1) % slot.images.size()];
+						current[i].stages |= m_Images[previous].final_state.stages;
+						current[i].access |= m_Images[previous].final_state.access;
+					}
+				}
+
+				transition(m_PassBarriers[k], i, pass_state(pass, i));
+			}
+		}
+
+		for (RenderGraphImage i = 0; i < m_Images.size(); i++)
+			if (m_Images[i].output && seen[i])
+				transition(m_OutputBarriers, i, m_Images[i].final_state);
+
+		// persistent images start out in the layout the first frame expects
+		std::vector<vk::ImageMemoryBarrier> initial_barriers;
+		for (const Image& image : m_Images)
+		{
+			if (!image.persistent || !image.img)
+				continue;
+
+			vk::ImageMemoryBarrier barrier;
+			barrier.oldLayout = vk::ImageLayout::eUndefined;
+			barrier.newLayout = image.final_state.layout;
+			barrier.dstAccessMask = image.final_state.access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image.img;
+			barrier.subresourceRange = vk::ImageSubresourceRange(image.aspect, 0, 1, 0, 1);
+			initial_barriers.push_back(barrier);
+		}
+
+		if (!initial_barriers.empty())
+		{
+			vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
+			cmd_buffer.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTopOfPipe,
+				vk::PipelineStageFlagBits::eAllCommands,
+				{}, // dependency flags
+				0, nullptr,
+				0, nullptr,
+				(u32)initial_barriers.size(), initial_barriers.data()
+			);
+			VkContext::EndSingleTimeCommands(cmd_buffer);
+		}
+	}
+
+	void RenderGraph::_create_render_pass(RenderGraphPass& pass, u32 order_index)
+	{
+		std::vector<vk::AttachmentDescription> attachments;
+		std::vector<vk::AttachmentReference> color_refs;
+		vk::AttachmentReference depth_ref;
+		bool has_depth = false;
+
+		std::vector<vk::ImageView> views;
+		pass.m_ClearValues.clear();
+
+		// colors first, then depth
+		for (int depth = 0; depth < 2; depth++)
+			for (const RenderGraphPass::Use& use : pass.m_Uses)
+			{
+				RenderGraphAccess wanted = depth ? RenderGraphAccess::DepthAttachment : RenderGraphAccess::ColorAttachment;
+				if (use.access != wanted)
+					continue;
+
+				const Image& image = m_Images[use.image];
+				ImageState state = accessState<ImageState>(use.access, pass.m_Type);
+
+				if (attachments.empty())
+				{
+					pass.m_Extent = image.info.extent;
+					pass.m_Samples = image.info.samples;
+				}
+				NA_ASSERT(
+					pass.m_Extent == image.info.extent && pass.m_Samples == image.info.samples,
+					"Failed to compile render graph: attachments of pass {} differ in extent or sample count!",
+						pass.m_Name
+				);
+
+				// transitions are done by the barriers in front of the pass
+				vk::AttachmentDescription attachment;
+				attachment.format = image.info.format;
+				attachment.samples = image.info.samples;
+				attachment.loadOp = use.clear ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad;
+				attachment.storeOp = image.persistent || image.last_use > order_index ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare;
+				attachment.stencilLoadOp = attachment.loadOp;
+				attachment.stencilStoreOp = attachment.storeOp;
+				attachment.initialLayout = state.layout;
+				attachment.finalLayout = state.layout;
+
+				vk::AttachmentReference ref((u32)attachments.size(), state.layout);
+				if (depth)
+				{
+					NA_ASSERT(!has_depth, "Failed to compile render graph: pass {} has more than one depth attachment!", pass.m_Name);
+					depth_ref = ref;
+					has_depth = true;
+				} else
+				{
+					color_refs.push_back(ref);
+				}
+
+				attachments.push_back(attachment);
+				views.push_back(image.view);
+				pass.m_ClearValues.push_back(use.clear_value);
+			}
+
+		NA_ASSERT(!attachments.empty(), "Failed to compile render graph: graphics pass {} has no attachments!", pass.m_Name);
+
+		vk::SubpassDescription subpass;
+		subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
+		subpass.colorAttachmentCount = (u32)color_refs.size();
+		subpass.pColorAttachments = color_refs.data();
+		subpass.pDepthStencilAttachment = has_depth ? &depth_ref : nullptr;
+
+		vk::RenderPassCreateInfo create_info;
+		create_info.attachmentCount = (u32)attachments.size();
+		create_info.pAttachments = attachments.data();
+		create_info.subpassCount = 1;
+		create_info.pSubpasses = &subpass;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		pass.m_RenderPass = logical_device.createRenderPass(create_info);
+		pass.m_ColorCount = (u32)color_refs.size();
+
+		vk::FramebufferCreateInfo framebuffer_info;
+		framebuffer_info.renderPass = pass.m_RenderPass;
+		framebuffer_info.attachmentCount = (u32)views.size();
+		framebuffer_info.pAttachments = views.data();
+		framebuffer_info.width = pass.m_Extent.width;
+		framebuffer_info.height = pass.m_Extent.height;
+		framebuffer_info.layers = 1;
+
+		pass.m_Framebuffer = logical_device.createFramebuffer(framebuffer_info);
+	}
+
+	void RenderGraph::_release(void)
+	{
+		if (!m_Compiled && m_Slots.empty())
+			return;
+
+		// frames in flight may still use them, the images go before the memory they alias
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
+
+		for (RenderGraphPass& pass : m_Passes)
+		{
+			deletion_queue.push(std::exchange(pass.m_Framebuffer, nullptr));
+			deletion_queue.push(std::exchange(pass.m_RenderPass, nullptr));
+			pass.m_Culled = true;
+		}
+
+		for (Image& image : m_Images)
+		{
+			deletion_queue.push(image.view);
+			deletion_queue.push(image.img);
+			image = Image{ .info = image.info, .output = image.output, .output_access = image.output_access };
+		}
+
+		for (MemorySlot& slot : m_Slots)
+			deletion_queue.free(slot.allocation);
+
+		m_Order.clear();
+		m_PassBarriers.clear();
+		m_OutputBarriers = {};
+		m_Slots.clear();
+		m_UnaliasedSize = 0;
+		m_Compiled = false;
+	}
+
+	void RenderGraph::_record_barriers(vk::CommandBuffer cmd_buffer, const Barriers& barriers)
+	{
+		if (barriers.image_barriers.empty())
+			return;
+
+		cmd_buffer.pipelineBarrier(
+			barriers.src_stages,
+			barriers.dst_stages,
+			{}, // dependency flags
+			0, nullptr,
+			0, nullptr,
+			(u32)barriers.image_barriers.size(), barriers.image_barriers.data()
+		);
+	}
+} // namespace Na
@@ -0,0 +1,311 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/RenderTarget.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+
+namespace Na {
+	RenderTarget::RenderTarget(const RenderTargetInfo& info)
+	: m_Info(info)
+	{
+		NA_ASSERT(info.extent.width && info.extent.height, "Failed to create RenderTarget: Invalid extent!");
+
+		this->_create_images();
+		this->_create_render_pass();
+		this->_create_framebuffer();
+	}
+
+	void RenderTarget::destroy(void)
+	{
+		if (!m_RenderPass)
+			return;
+
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
+
+		deletion_queue.push(std::exchange(m_Framebuffer, nullptr));
+		deletion_queue.push(std::exchange(m_RenderPass, nullptr));
+
+		deletion_queue.push(std::exchange(m_DepthView, nullptr));
+		m_Depth.destroy();
+
+		deletion_queue.push(std::exchange(m_MultisampledView, nullptr));
+		m_Multisampled.destroy();
+
+		deletion_queue.push(std::exchange(m_ColorView, nullptr));
+		m_Color.destroy();
+	}
+
+	void RenderTarget::begin(vk::CommandBuffer cmd_buffer, const glm::vec4& clear_color, float clear_depth) const
+	{
+		// in attachment order
+		std::array<vk::ClearValue, 3> clear_values;
+		u32 clear_value_count = 0;
+
+		clear_values[clear_value_count++].color = std::array<float, 4>{ clear_color.r, clear_color.g, clear_color.b, clear_color.a };
+		if (m_Depth)
+			clear_values[clear_value_count++].depthStencil = vk::ClearDepthStencilValue{ clear_depth, 0 };
+		if (m_Multisampled && m_Info.resolve == MsaaResolve::Attachment)
+			clear_values[clear_value_count++].color = clear_values[0].color;
+
+		vk::RenderPassBeginInfo begin_info;
+		begin_info.renderPass = m_RenderPass;
+		begin_info.framebuffer = m_Framebuffer;
+		begin_info.renderArea.offset = vk::Offset2D{ 0, 0 };
+		begin_info.renderArea.extent = m_Info.extent;
+		begin_info.clearValueCount = clear_value_count;
+		begin_info.pClearValues = clear_values.data();
+
+		cmd_buffer.beginRenderPass(begin_info, vk::SubpassContents::eInline);
+
+		vk::Viewport viewport;
+		viewport.x = 0.0f;
+		viewport.y = (float)m_Info.extent.height;
+		viewport.width = (float)m_Info.extent.width;
+		viewport.height = -(float)m_Info.extent.height;
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		vk::Rect2D scissor(vk::Offset2D{ 0, 0 }, m_Info.extent);
+
+		cmd_buffer.setViewport(0, 1, &viewport);
+		cmd_buffer.setScissor(0, 1, &scissor);
+	}
+
+	void RenderTarget::read_back(void* dst, u32 texel_size) const
+	{
+		NA_VERIFY(!m_Multisampled || m_Info.resolve == MsaaResolve::Attachment, "Failed to read back RenderTarget: A manually resolved color image is not in final_layout, pass its layout!");
+		this->read_back(dst, m_Info.final_layout, texel_size);
+	}
+
+	void RenderTarget::read_back(void* dst, vk::ImageLayout layout, u32 texel_size) const
+	{
+		vk::DeviceSize size = (vk::DeviceSize)m_Info.extent.width * m_Info.extent.height * texel_size;
+
+		DeviceBuffer staging(
+			size,
+			vk::BufferUsageFlagBits::eTransferDst,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+
+		m_Color.copy_to_buffer(staging.buffer, layout);
+		memcpy(dst, staging.mapped(), size);
+	}
+
+	GraphicsPipelineTarget RenderTarget::target(void) const
+	{
+		return GraphicsPipelineTarget{
+			.render_pass = m_RenderPass,
+			.samples = m_Info.samples,
+			.color_attachment_count = 1,
+			.color_format = m_Info.color_format,
+			.depth_format = m_Info.depth_format
+		};
+	}
+
+	void RenderTarget::_create_images(void)
+	{
+		vk::Extent3D extent(m_Info.extent.width, m_Info.extent.height, 1);
+		bool manual_resolve = m_Info.samples != vk::SampleCountFlagBits::e1 && m_Info.resolve == MsaaResolve::Manual;
+
+		vk::ImageUsageFlags color_usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc;
+		if (manual_resolve && (VkContext::GetFormatProperties(m_Info.color_format).optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage))
+			color_usage |= vk::ImageUsageFlagBits::eStorage;
+
+		m_Color = DeviceImage(
+			extent,
+			1, // layer count
+			vk::ImageAspectFlagBits::eColor,
+			m_Info.color_format,
+			vk::ImageTiling::eOptimal,
+			color_usage,
+			vk::SharingMode::eExclusive,
+			vk::SampleCountFlagBits::e1,
+			vk::MemoryPropertyFlagBits::eDeviceLocal
+		);
+		m_ColorView = CreateImageView(m_Color.img, vk::ImageAspectFlagBits::eColor, m_Info.color_format);
+
+		if (m_Info.samples != vk::SampleCountFlagBits::e1)
+		{
+			m_Multisampled = DeviceImage(
+				extent,
+				1, // layer count
+				vk::ImageAspectFlagBits::eColor,
+				m_Info.color_format,
+				vk::ImageTiling::eOptimal,
+				manual_resolve
+					? vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled
+					: vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
+				vk::SharingMode::eExclusive,
+				m_Info.samples,
+				vk::MemoryPropertyFlagBits::eDeviceLocal
+			);
+			m_MultisampledView = CreateImageView(m_Multisampled.img, vk::ImageAspectFlagBits::eColor, m_Info.color_format);
+		}
+
+		if (m_Info.depth_format != vk::Format::eUndefined)
+		{
+			m_Depth = DeviceImage(
+				extent,
+				1, // layer count
+				vk::ImageAspectFlagBits::eDepth,
+				m_Info.depth_format,
+				vk::ImageTiling::eOptimal,
+				vk::ImageUsageFlagBits::eDepthStencilAttachment,
+				vk::SharingMode::eExclusive,
+				m_Info.samples,
+				vk::MemoryPropertyFlagBits::eDeviceLocal
+			);
+			m_DepthView = CreateImageView(m_Depth.img, vk::ImageAspectFlagBits::eDepth, m_Info.depth_format);
+		}
+	}
+
+	void RenderTarget::_create_render_pass(void)
+	{
+		bool resolve = m_Multisampled && m_Info.resolve == MsaaResolve::Attachment;
+
+		// color (multisampled with msaa), depth, resolve
+		std::array<vk::AttachmentDescription, 3> attachments{};
+		u32 attachment_count = 0;
+
+		vk::AttachmentReference color_ref;
+		vk::AttachmentReference depth_ref;
+		vk::AttachmentReference resolve_ref;
+
+		vk::AttachmentDescription& color_attachment = attachments[attachment_count];
+		color_attachment.format         = m_Info.color_format;
+		color_attachment.samples        = m_Info.samples;
+		color_attachment.loadOp         = vk::AttachmentLoadOp::eClear;
+		color_attachment.storeOp        = resolve ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
+		color_attachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
+		color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+		color_attachment.initialLayout  = vk::ImageLayout::eUndefined;
+		color_attachment.finalLayout    = resolve ? vk::ImageLayout::eColorAttachmentOptimal : m_Info.final_layout;
+
+		color_ref.attachment = attachment_count++;
+		color_ref.layout     = vk::ImageLayout::eColorAttachmentOptimal;
+
+		if (m_Depth)
+		{
+			vk::AttachmentDescription& depth_attachment = attachments[attachment_count];
+			depth_attachment.format         = m_Info.depth_format;
+			depth_attachment.samples        = m_Info.samples;
+			depth_attachment.loadOp         = vk::AttachmentLoadOp::eClear;
+			depth_attachment.storeOp        = vk::AttachmentStoreOp::eDontCare;
+			depth_attachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
+			depth_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+			depth_attachment.initialLayout  = vk::ImageLayout::eUndefined;
+			depth_attachment.finalLayout    = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+
+			depth_ref.attachment = attachment_count++;
+			depth_ref.layout     = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+		}
+
+		if (resolve)
+		{
+			vk::AttachmentDescription& resolve_attachment = attachments[attachment_count];
+			resolve_attachment.format         = m_Info.color_format;
+			resolve_attachment.samples        = vk::SampleCountFlagBits::e1;
+			resolve_attachment.loadOp         = vk::AttachmentLoadOp::eDontCare;
+			resolve_attachment.storeOp        = vk::AttachmentStoreOp::eStore;
+			resolve_attachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
+			resolve_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+			resolve_attachment.initialLayout  = vk::ImageLayout::eUndefined;
+			resolve_attachment.finalLayout    = m_Info.final_layout;
+
+			resolve_ref.attachment = attachment_count++;
+			resolve_ref.layout     = vk::ImageLayout::eColorAttachmentOptimal;
+		}
+
+		vk::SubpassDescription subpass;
+		subpass.pipelineBindPoint       = vk::PipelineBindPoint::eGraphics;
+		subpass.colorAttachmentCount    = 1;
+		subpass.pColorAttachments       = &color_ref;
+		subpass.pDepthStencilAttachment = m_Depth ? &depth_ref : nullptr;
+		subpass.pResolveAttachments     = resolve ? &resolve_ref : nullptr;
+
+		// the previous pass on the target, then whatever reads it afterwards
+		std::array<vk::SubpassDependency, 2> dependencies;
+
+		dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass    = 0;
+		dependencies[0].srcStageMask  = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests
+		                              | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTransfer;
+		dependencies[0].srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+		dependencies[0].dstStageMask  = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
+		dependencies[0].dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+
+		dependencies[1].srcSubpass    = 0;
+		dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask  = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		dependencies[1].srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+		dependencies[1].dstStageMask  = vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTransfer;
+		dependencies[1].dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead;
+
+		vk::RenderPassCreateInfo create_info;
+
+		create_info.attachmentCount = attachment_count;
+		create_info.pAttachments = attachments.data();
+
+		create_info.subpassCount = 1;
+		create_info.pSubpasses = &subpass;
+
+		create_info.dependencyCount = (u32)dependencies.size();
+		create_info.pDependencies = dependencies.data();
+
+		m_RenderPass = VkContext::GetLogicalDevice().createRenderPass(create_info);
+	}
+
+	void RenderTarget::_create_framebuffer(void)
+	{
+		std::array<vk::ImageView, 3> attachments;
+		u32 attachment_count = 0;
+
+		attachments[attachment_count++] = m_Multisampled ? m_MultisampledView : m_ColorView;
+		if (m_Depth)
+			attachments[attachment_count++] = m_DepthView;
+		if (m_Multisampled && m_Info.resolve == MsaaResolve::Attachment)
+			attachments[attachment_count++] = m_ColorView;
+
+		vk::FramebufferCreateInfo create_info;
+
+		create_info.renderPass = m_RenderPass;
+
+		create_info.attachmentCount = attachment_count;
+		create_info.pAttachments = attachments.data();
+
+		create_info.width = m_Info.extent.width;
+		create_info.height = m_Info.extent.height;
+		create_info.layers = 1;
+
+		m_Framebuffer = VkContext::GetLogicalDevice().createFramebuffer(create_info);
+	}
+
+	RenderTarget::RenderTarget(RenderTarget&& other)
+	: m_Info(other.m_Info),
+	m_Color(std::move(other.m_Color)),
+	m_ColorView(std::exchange(other.m_ColorView, nullptr)),
+	m_Multisampled(std::move(other.m_Multisampled)),
+	m_MultisampledView(std::exchange(other.m_MultisampledView, nullptr)),
+	m_Depth(std::move(other.m_Depth)),
+	m_DepthView(std::exchange(other.m_DepthView, nullptr)),
+	m_RenderPass(std::exchange(other.m_RenderPass, nullptr)),
+	m_Framebuffer(std::exchange(other.m_Framebuffer, nullptr))
+	{}
+
+	RenderTarget& RenderTarget::operator=(RenderTarget&& other)
+	{
+		this->destroy();
+
+		m_Info = other.m_Info;
+		m_Color = std::move(other.m_Color);
+		m_ColorView = std::exchange(other.m_ColorView, nullptr);
+		m_Multisampled = std::move(other.m_Multisampled);
+		m_MultisampledView = std::exchange(other.m_MultisampledView, nullptr);
+		m_Depth = std::move(other.m_Depth);
+		m_DepthView = std::exchange(other.m_DepthView, nullptr);
+		m_RenderPass = std::exchange(other.m_RenderPass, nullptr);
+		m_Framebuffer = std::exchange(other.m_Framebuffer, nullptr);
+
+		return *this;
+	}
+} // namespace Na
\ No newline at end of file
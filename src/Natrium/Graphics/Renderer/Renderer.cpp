@@ -3,17 +3,63 @@
 
 #include "Natrium/Graphics/VkContext.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/GpuMesh.hpp"
 #include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/Profiler.hpp"
 
 namespace Na {
+	// uniform and storage buffers, only the bytes in range are written
+	template<typename t_Buffer>
+	static void writeDescriptorBuffer(t_Buffer& buffer, u32 frame_index, const void* data, u64 size, u64 offset)
+	{
+		NA_ASSERT(offset + size <= buffer.per_frame_size(), "Failed to set descriptor buffer: Range exceeds the buffer!");
+
+		if (buffer.update_rate() == BufferUpdateRate::Static)
+		{
+			buffer.upload(data, size, offset);
+			return;
+		}
+
+		if (buffer.update_rate() == BufferUpdateRate::Tracked)
+		{
+			buffer.write(data, size, offset);
+			buffer.sync(frame_index);
+			return;
+		}
+
+		memcpy((Byte*)buffer.mapped_data() + frame_index * buffer.aligned_size() + offset, data, size);
+	}
+
 	Renderer::Renderer(RendererCore& renderer_core)
 	: m_Core(&renderer_core)
 	{
 		m_Frames.resize(renderer_core.m_Settings.max_frames_in_flight);
-		m_ImageInFlightFences.resize(renderer_core.m_Images.size());
+		m_ImageFrames = ArrayVector<u64>(renderer_core.m_Images.size());
+
+		u32 latency = renderer_core.m_Settings.max_frame_latency;
+		this->set_frame_latency(latency ? latency : (u32)m_Frames.size());
 
 		this->_create_command_objects();
 		this->_create_sync_objects();
+
+		m_DeletionSubmitter = VkContext::GetDeletionQueue().add_submitter();
+
+		m_DescriptorAllocator = DescriptorAllocator(renderer_core.m_Settings.max_frames_in_flight);
+
+		if (renderer_core.m_Settings.gpu_profiler_scopes)
+			m_Profiler = GpuProfiler(
+				renderer_core.m_Settings.max_frames_in_flight,
+				renderer_core.m_Settings.gpu_profiler_scopes,
+				renderer_core.m_Settings.pipeline_statistics
+			);
+
+		if (renderer_core.m_Settings.instance_buffer_size)
+			m_InstanceBuffer = TransientBuffer(
+				renderer_core.m_Settings.instance_buffer_size,
+				ShaderUniformType::StorageBuffer,
+				std::min<u64>(renderer_core.m_Settings.instance_buffer_size, VkContext::GetPhysicalDeviceLimits().maxStorageBufferRange),
+				renderer_core.m_Settings
+			);
 	}
 
 	void Renderer::destroy(void)
@@ -26,53 +72,154 @@ namespace Na {
 
 			logical_device.destroySemaphore(fd.image_available_semaphore);
 			logical_device.destroySemaphore(fd.render_finished_semaphore);
+			logical_device.destroySemaphore(fd.compute_finished_semaphore);
+
+			// freeing a pool frees its command buffers
+			for (WorkerCmdData& worker : fd.workers)
+				logical_device.destroyCommandPool(worker.cmd_pool);
 		}
+		logical_device.destroySemaphore(m_FrameTimeline);
 
 		logical_device.destroyCommandPool(m_GraphicsCmdPool);
+		logical_device.destroyCommandPool(m_ComputeCmdPool);
+
+		m_InstanceBuffer.destroy();
+		m_Profiler.destroy();
+		m_DescriptorAllocator.destroy();
+
+		if (m_DeletionSubmitter != k_U32Max)
+			VkContext::GetDeletionQueue().remove_submitter(std::exchange(m_DeletionSubmitter, k_U32Max));
+	}
+
+	bool Renderer::_wait_for_frame(u64 timeout)
+	{
+		if (m_FrameWaited)
+			return true;
+
+		NA_PROFILE_SCOPE("Renderer::wait_for_frame");
+
+		// the frame's own commands have to retire before they are reset,
+		// with a lower latency the frame submitted latency frames ago has to as well,
+		// which covers the former since submissions signal in order
+		u64 frame = m_SubmittedFrames + 1 > m_FrameLatency ? m_SubmittedFrames + 1 - m_FrameLatency : 0;
+
+		vk::Result result = this->_wait_for_submission(frame, timeout);
+		if (result == vk::Result::eTimeout)
+			return false;
+
+		NA_VERIFY_VK(
+			result, 
+			"Failed to begin frame #{} with image #{}:"
+			"Error in waiting for frame!",
+				m_FrameIndex,
+				m_ImageIndex
+		);
+
+		return m_FrameWaited = true;
+	}
+
+	vk::Result Renderer::_wait_for_submission(u64 frame, u64 timeout)
+	{
+		if (frame <= m_CompletedFrames)
+			return vk::Result::eSuccess;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		vk::Result result;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (m_FrameTimeline)
+		{
+			vk::SemaphoreWaitInfoKHR wait_info;
+			wait_info.semaphoreCount = 1;
+			wait_info.pSemaphores = &m_FrameTimeline;
+			wait_info.pValues = &frame;
+
+			result = (vk::Result)VkContext::GetWaitSemaphores()(logical_device, &static_cast<const VkSemaphoreWaitInfoKHR&>(wait_info), timeout);
+		} else
+		{
+			// frame n was submitted with the fence of slot (n - 1) % max_frames_in_flight,
+			// a later submission in the same slot only signals after it
+			vk::Fence fence = m_Frames[(frame - 1) % m_Frames.size()].in_flight_fence;
+			result = logical_device.waitForFences(1, &fence, VK_TRUE, timeout);
+		}
+		m_PendingWaitTime += std::chrono::steady_clock::now() - start;
+
+		if (result == vk::Result::eSuccess)
+			m_CompletedFrames = frame;
+
+		return result;
 	}
 
-	bool Renderer::begin_frame(const glm::vec4& color)
+	bool Renderer::_begin_frame(const glm::vec4& color, bool blocking)
 	{
 		//g_Logger.fmt(Na::Info, "Frame #{}, Image #{}", m_FrameIndex, m_ImageIndex);
+		NA_PROFILE_SCOPE("Renderer::begin_frame");
 
 		vk::Device logical_device = VkContext::GetLogicalDevice();
 		FrameData& fd = m_Frames[m_FrameIndex];
 
 		fd.valid = true;
+		m_DrawQueue.clear();
 
-		if (m_Core->m_Width  != m_Core->m_Window->width() ||
-			m_Core->m_Height != m_Core->m_Window->height())
+		if (!m_Core->headless())
 		{
-			m_Core->_recreate_swapchain();
-			return fd.valid = false;
+			const Window& window = *m_Core->m_Window;
+			glm::uvec2 window_size = window.size();
+			if (window.minimized() || !window_size.x || !window_size.y)
+				return fd.valid = false; // nothing to present to
+
+			// while the size keeps changing the old swapchain is presented, unless it went out of date
+			bool resized = window_size != m_Core->m_Size;
+			if (m_Core->m_SwapchainDirty || (resized && window_size == m_Core->m_PendingSize))
+				this->_recreate_swapchain();
+			else if (resized)
+				m_Core->m_PendingSize = window_size;
 		}
 
 		vk::Result result = vk::Result::eSuccess;
 
-		result = logical_device.waitForFences(
-			{ fd.in_flight_fence },
-			VK_TRUE, // wait all
-			UINT64_MAX // timeout
-		);
-		NA_VERIFY_VK(
-			result, 
-			"Failed to begin frame #{} with image #{}:"
-			"Error in waiting for fence!",
-				m_FrameIndex,
-				m_ImageIndex
-		);
-		
-		result = logical_device.acquireNextImageKHR(
-			m_Core->m_Swapchain,
-			UINT64_MAX, // timeout
-			fd.image_available_semaphore,
-			nullptr,
-			&m_ImageIndex
-		);
+		if (!this->_wait_for_frame(blocking ? m_Core->m_Settings.frame_timeout : 0))
+			return fd.valid = false;
+
+		// the gpu may be further along than what was waited for
+		if (m_FrameTimeline)
+		{
+			u64 completed_frames = 0;
+			result = (vk::Result)VkContext::GetSemaphoreCounterValue()(logical_device, m_FrameTimeline, &completed_frames);
+			NA_VERIFY_VK(result, "Failed to begin frame #{} with image #{}: Error in reading frame timeline!", m_FrameIndex, m_ImageIndex);
+			m_CompletedFrames = std::max(m_CompletedFrames, completed_frames);
+		}
+
+		// everything released during a completed frame is no longer in use,
+		// whatever is released while recording waits for this frame
+		m_Core->_destroy_retired(m_CompletedFrames);
+
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
+		deletion_queue.collect(m_DeletionSubmitter, m_CompletedFrames);
+		deletion_queue.set_frame(m_DeletionSubmitter, m_SubmittedFrames + 1);
+
+		if (m_InstanceBuffer)
+			m_InstanceBuffer.begin_frame(m_FrameIndex);
+
+		// headless images are used round robin, there is nothing to acquire them from
+		if (m_Core->headless())
+			m_ImageIndex = (u32)(m_SubmittedFrames % m_Core->m_Images.size());
+		else
+			result = logical_device.acquireNextImageKHR(
+				m_Core->m_Swapchain,
+				blocking ? UINT64_MAX : 0, // timeout
+				fd.image_available_semaphore,
+				nullptr,
+				&m_ImageIndex
+			);
+
+		// nothing was acquired, the wait stays done so the next try goes straight to acquiring
+		if (!blocking && (result == vk::Result::eTimeout || result == vk::Result::eNotReady))
+			return fd.valid = false;
 
 		if (result == vk::Result::eErrorOutOfDateKHR)
 		{
-			m_Core->_recreate_swapchain();
+			this->_recreate_swapchain();
 			return fd.valid = false;
 		} else
 		if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR)
@@ -83,24 +230,67 @@ namespace Na {
 					m_ImageIndex
 			));
 
-		if (m_ImageInFlightFences[m_ImageIndex])
+		// the last frame that rendered to the image may still be in flight
+		result = this->_wait_for_submission(m_ImageFrames[m_ImageIndex], UINT64_MAX);
+		NA_VERIFY_VK(result, "Failed to begin frame #{} with image #{}: Error in waiting for frame!", m_FrameIndex, m_ImageIndex);
+		m_ImageFrames[m_ImageIndex] = m_SubmittedFrames + 1;
+
+		m_FrameWaitTime = std::exchange(m_PendingWaitTime, std::chrono::nanoseconds(0));
+		m_TotalWaitTime += m_FrameWaitTime;
+
+		m_FrameWaited = false;
+		if (!m_FrameTimeline)
 		{
-			result = logical_device.waitForFences({ m_ImageInFlightFences[m_ImageIndex] }, VK_TRUE, UINT64_MAX);
-			NA_VERIFY_VK(result, "Failed to begin frame #{} with image #{}: Error in waiting for fence!", m_FrameIndex, m_ImageIndex);
+			result = logical_device.resetFences(1, &fd.in_flight_fence);
+			NA_VERIFY_VK(result, "Failed to begin frame #{} with image #{}: Error in resetting fence!", m_FrameIndex, m_ImageIndex);
 		}
-		m_ImageInFlightFences[m_ImageIndex] = fd.in_flight_fence;
-
-		result = logical_device.resetFences(1, &fd.in_flight_fence);
-		NA_VERIFY_VK(result, "Failed to begin frame #{} with image #{}: Error in resetting fence!", m_FrameIndex, m_ImageIndex);
 		fd.cmd_buffer.reset();
+		fd.compute_recording = false;
+		fd.pre_pass_recording = false;
+		fd.upscaled = false;
+
+		m_DescriptorAllocator.reset(m_FrameIndex);
+
+		fd.arena.reset();
+		Arena::NextFrame();
+
+		// the slot's fence signaled, so its queries are available without waiting
+		if (m_Profiler.enabled())
+		{
+			m_Profiler.resolve(m_FrameIndex);
+			m_Profiler.begin_frame(this->pre_pass_cmd_buffer(), m_FrameIndex, m_SubmittedFrames);
+		}
+
+		for (WorkerCmdData& worker : fd.workers)
+		{
+			if (!worker.used)
+				continue;
+
+			logical_device.resetCommandPool(worker.cmd_pool);
+			worker.used = 0;
+		}
 
 		vk::CommandBufferBeginInfo begin_info;
 		fd.cmd_buffer.begin(begin_info);
+		m_Recording = true;
 
 		std::array<vk::ClearValue, 2> clear_values;
 		clear_values[0].color = std::array<float, 4>{ color.r, color.g, color.g, color.a };
 		clear_values[1].depthStencil = { { 1.0f, 0 } };
 
+		if (m_Core->m_DynamicRendering)
+		{
+			this->_begin_rendering(fd.cmd_buffer, clear_values);
+
+			if (this->records_secondary())
+				return true;
+
+			fd.cmd_buffer.setViewport(0, 1, &m_Core->m_Viewport);
+			fd.cmd_buffer.setScissor(0, 1, &m_Core->m_Scissor);
+
+			return true;
+		}
+
 		vk::RenderPassBeginInfo render_pass_info;
 
 		render_pass_info.renderPass = m_Core->m_RenderPass;
@@ -112,6 +302,13 @@ namespace Na {
 		render_pass_info.clearValueCount = (u32)clear_values.size();
 		render_pass_info.pClearValues = clear_values.data();
 
+		if (this->records_secondary())
+		{
+			// only vkCmdExecuteCommands is allowed inside the pass from here on
+			fd.cmd_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eSecondaryCommandBuffers);
+			return true;
+		}
+
 		fd.cmd_buffer.beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
 
 		fd.cmd_buffer.setViewport(0, 1, &m_Core->m_Viewport);
@@ -120,33 +317,91 @@ namespace Na {
 		return true;
 	}
 
-	void Renderer::end_frame(void)
+	vk::CommandBuffer Renderer::begin_secondary(u32 worker_index)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
 		FrameData& fd = m_Frames[m_FrameIndex];
 
-		vk::Result result = vk::Result::eSuccess;
+		NA_ASSERT(
+			worker_index < fd.workers.size(),
+			"Failed to begin secondary command buffer: worker index {} exceeds recording thread count {}!",
+				worker_index,
+				fd.workers.size()
+		);
 
-		fd.cmd_buffer.endRenderPass();
-		fd.cmd_buffer.end();
+		WorkerCmdData& worker = fd.workers[worker_index];
 
-		vk::SubmitInfo submit_info;
+		if (worker.used == worker.cmd_buffers.size())
+		{
+			vk::CommandBufferAllocateInfo alloc_info;
+			alloc_info.commandPool = worker.cmd_pool;
+			alloc_info.level = vk::CommandBufferLevel::eSecondary;
+			alloc_info.commandBufferCount = 1;
+
+			vk::CommandBuffer cmd_buffer;
+			vk::Result result = VkContext::GetLogicalDevice().allocateCommandBuffers(&alloc_info, &cmd_buffer);
+			NA_VERIFY_VK(result, "Failed to allocate secondary command buffer for worker #{}!", worker_index);
+
+			worker.cmd_buffers.emplace(cmd_buffer);
+		}
+
+		vk::CommandBuffer cmd_buffer = worker.cmd_buffers[worker.used++];
+
+		vk::CommandBufferInheritanceInfo inheritance_info;
+		vk::CommandBufferInheritanceRenderingInfoKHR inheritance_rendering_info;
+		vk::Format color_format = m_Core->m_SwapchainFormat.format;
+
+		if (m_Core->m_DynamicRendering)
+		{
+			inheritance_rendering_info.colorAttachmentCount = 1;
+			inheritance_rendering_info.pColorAttachmentFormats = &color_format;
+			inheritance_rendering_info.depthAttachmentFormat = m_Core->m_DepthFormat;
+			inheritance_rendering_info.rasterizationSamples = m_Core->samples();
+
+			inheritance_info.pNext = &inheritance_rendering_info;
+		} else
+		{
+			inheritance_info.renderPass = m_Core->m_RenderPass;
+			inheritance_info.subpass = 0;
+			inheritance_info.framebuffer = m_Core->m_Framebuffers[m_ImageIndex];
+		}
+
+		vk::CommandBufferBeginInfo begin_info;
+		begin_info.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue
+			             | vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		begin_info.pInheritanceInfo = &inheritance_info;
+
+		cmd_buffer.begin(begin_info);
 
-		vk::Semaphore wait_semaphores[] = { fd.image_available_semaphore };
-		vk::PipelineStageFlags wait_stages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
+		// dynamic state is not inherited from the primary command buffer
+		cmd_buffer.setViewport(0, 1, &m_Core->m_Viewport);
+		cmd_buffer.setScissor(0, 1, &m_Core->m_Scissor);
 
-		submit_info.waitSemaphoreCount = sizeof(wait_semaphores) / sizeof(vk::Semaphore);
-		submit_info.pWaitSemaphores = wait_semaphores;
-		submit_info.pWaitDstStageMask = wait_stages;
+		return cmd_buffer;
+	}
+
+	void Renderer::end_frame(void)
+	{
+		NA_PROFILE_SCOPE("Renderer::end_frame");
 
-		vk::Semaphore signal_semaphores[] = { fd.render_finished_semaphore };
-		submit_info.signalSemaphoreCount = sizeof(signal_semaphores) / sizeof(VkSemaphore);
-		submit_info.pSignalSemaphores = signal_semaphores;
+		FrameSubmission submission;
+		this->_prepare_submission(submission);
 
-		submit_info.commandBufferCount = 1;
-		submit_info.pCommandBuffers = &fd.cmd_buffer;
+		// anything uploaded this frame is ordered before the frame's commands
+		VkContext::GetUploadManager().flush();
 
-		result = VkContext::GetGraphicsQueue().submit(1, &submit_info, fd.in_flight_fence);
+		vk::Result result;
+		if (submission.compute)
+		{
+			// the frame's fence (or timeline value) covers this submission as well, graphics waits on it
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetComputeQueue());
+			result = VkContext::GetComputeQueue().submit(1, &submission.compute_submit_info, nullptr);
+			NA_VERIFY_VK(result, "Failed to end frame #{} with image #{}: Error in submitting to compute queue!", m_FrameIndex, m_ImageIndex);
+		}
+
+		{
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+			result = VkContext::GetGraphicsQueue().submit(1, &submission.submit_info, submission.fence);
+		}
 		NA_VERIFY_VK(
 			result,
 			"Failed to end frame #{} with image #{}:"
@@ -154,50 +409,300 @@ namespace Na {
 				m_FrameIndex,
 				m_ImageIndex
 		);
+		this->_submitted();
+
+		if (m_Core->headless())
+			return;
+
+		FrameData& fd = m_Frames[m_FrameIndex];
 
 		vk::PresentInfoKHR present_info;
-		present_info.waitSemaphoreCount = submit_info.waitSemaphoreCount;
-		present_info.pWaitSemaphores = signal_semaphores;
+		present_info.waitSemaphoreCount = 1;
+		present_info.pWaitSemaphores = &fd.render_finished_semaphore;
 
 		present_info.swapchainCount = 1;
 		present_info.pSwapchains = &m_Core->m_Swapchain;
 		present_info.pImageIndices = &m_ImageIndex;
 
-		try
 		{
-			result = VkContext::GetGraphicsQueue().presentKHR(present_info);
-			switch (result)
+			NA_PROFILE_SCOPE("Renderer::present");
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+			result = VkContext::GetGraphicsQueue().presentKHR(&present_info);
+		}
+		this->_presented(result);
+	}
+
+	void Renderer::EndFrames(std::span<Renderer* const> renderers)
+	{
+		NA_PROFILE_SCOPE("Renderer::EndFrames");
+
+		// constructed, the submit infos need their structure types
+		std::vector<FrameSubmission> submissions(renderers.size());
+		ArrayVector<Renderer*> submitted(renderers.size());
+		u32 submission_count = 0;
+
+		for (Renderer* renderer : renderers)
+		{
+			if (!renderer->m_Recording)
+				continue;
+
+			renderer->_prepare_submission(submissions[submission_count]);
+			submitted[submission_count++] = renderer;
+		}
+
+		if (!submission_count)
+			return;
+
+		// once for every renderer, ahead of all of their commands
+		VkContext::GetUploadManager().flush();
+
+		ArrayVector<vk::SubmitInfo> submit_infos(submission_count);
+		ArrayVector<vk::SubmitInfo> compute_submit_infos(submission_count);
+		u32 compute_count = 0;
+
+		ArrayVector<vk::Fence> fences(submission_count);
+		u32 fence_count = 0;
+
+		for (u32 i = 0; i < submission_count; i++)
+		{
+			submit_infos[i] = submissions[i].submit_info;
+
+			if (submissions[i].compute)
+				compute_submit_infos[compute_count++] = submissions[i].compute_submit_info;
+
+			if (submissions[i].fence)
+				fences[fence_count++] = submissions[i].fence;
+		}
+
+		vk::Result result;
+		if (compute_count)
+		{
+			// binary semaphores have to be signaled by an earlier submission than the one waiting on them
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetComputeQueue());
+			result = VkContext::GetComputeQueue().submit(compute_count, compute_submit_infos.ptr(), nullptr);
+			NA_VERIFY_VK(result, "Failed to end {} frames: Error in submitting to compute queue!", submission_count);
+		}
+
+		{
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+
+			result = VkContext::GetGraphicsQueue().submit(submission_count, submit_infos.ptr(), fence_count ? fences[0] : nullptr);
+			NA_VERIFY_VK(result, "Failed to end {} frames: Error in submitting to graphics queue!", submission_count);
+
+			// a fence signals once all earlier work on the queue completed, so these retire with the batch
+			for (u32 i = 1; i < fence_count; i++)
 			{
-			case vk::Result::eSuboptimalKHR:
-				m_Core->_recreate_swapchain();
-				break;
-			case vk::Result::eErrorOutOfDateKHR:
-				m_Core->_recreate_swapchain();
-				break;
-			case vk::Result::eSuccess:
-				break;
-			default:
-				NA_VERIFY_VK(result, "Failed to end frame #{} with image #{}: Error in presenting to graphics queue!", m_FrameIndex, m_ImageIndex);
+				result = VkContext::GetGraphicsQueue().submit(0, nullptr, fences[i]);
+				NA_VERIFY_VK(result, "Failed to end {} frames: Error in signaling fence #{}!", submission_count, i);
 			}
+		}
+
+		ArrayVector<vk::Semaphore> wait_semaphores(submission_count);
+		ArrayVector<vk::SwapchainKHR> swapchains(submission_count);
+		ArrayVector<u32> image_indices(submission_count);
+		ArrayVector<Renderer*> presenting(submission_count);
+		u32 present_count = 0;
+
+		for (u32 i = 0; i < submission_count; i++)
+		{
+			Renderer* renderer = submitted[i];
+
+			// the frame index is still the submitted one's until _presented
+			renderer->_submitted();
+			if (renderer->m_Core->headless())
+				continue;
+
+			wait_semaphores[present_count] = renderer->m_Frames[renderer->m_FrameIndex].render_finished_semaphore;
+			swapchains[present_count] = renderer->m_Core->m_Swapchain;
+			image_indices[present_count] = renderer->m_ImageIndex;
+			presenting[present_count++] = renderer;
+		}
+
+		if (!present_count)
+			return;
+
+		ArrayVector<vk::Result> results(present_count);
+
+		vk::PresentInfoKHR present_info;
+		present_info.waitSemaphoreCount = present_count;
+		present_info.pWaitSemaphores = wait_semaphores.ptr();
+
+		present_info.swapchainCount = present_count;
+		present_info.pSwapchains = swapchains.ptr();
+		present_info.pImageIndices = image_indices.ptr();
+		present_info.pResults = results.ptr();
 
-		} catch (const vk::OutOfDateKHRError& err)
 		{
-			(void)err;
-			m_Core->_recreate_swapchain();
+			NA_PROFILE_SCOPE("Renderer::present");
+			std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+			result = VkContext::GetGraphicsQueue().presentKHR(&present_info);
 		}
 
-		m_FrameIndex = (m_FrameIndex + 1) % (u32)m_Frames.size();
+		// every swapchain reports on its own, one going out of date says nothing about the others
+		for (u32 i = 0; i < present_count; i++)
+			presenting[i]->_presented(results[i]);
 	}
 
-	void Renderer::bind_pipeline(const GraphicsPipeline& pipeline)
+	void Renderer::_prepare_submission(FrameSubmission& submission)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
 		FrameData& fd = m_Frames[m_FrameIndex];
 
-		fd.cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+		if (this->records_secondary())
+		{
+			m_SecondaryCmdBuffers.resize(0);
+			for (const WorkerCmdData& worker : fd.workers)
+				for (u32 i = 0; i < worker.used; i++)
+					m_SecondaryCmdBuffers.emplace(worker.cmd_buffers[i]);
+
+			// the workers are done by now, so the first one records the queue, executed last
+			if (!m_DrawQueue.empty())
+			{
+				vk::CommandBuffer cmd_buffer = this->begin_secondary(0);
+				m_DrawQueue.flush(*this, cmd_buffer);
+				this->end_secondary(cmd_buffer);
+
+				m_SecondaryCmdBuffers.emplace(cmd_buffer);
+			}
+
+			if (!m_SecondaryCmdBuffers.empty())
+				fd.cmd_buffer.executeCommands((u32)m_SecondaryCmdBuffers.size(), m_SecondaryCmdBuffers.ptr());
+		} else if (!m_DrawQueue.empty())
+		{
+			m_DrawQueue.flush(*this, fd.cmd_buffer);
+		}
+
+		if (m_Core->m_DynamicRendering)
+			this->_end_rendering(fd.cmd_buffer);
+		else
+			fd.cmd_buffer.endRenderPass();
+		m_Profiler.end_frame(fd.cmd_buffer);
+		fd.cmd_buffer.end();
+
+		// the core's pass loads the image, it has to be in the right layout either way
+		if (m_Core->upscaling() && !fd.upscaled)
+			this->_upscale(nullptr, m_Core->m_Extent);
+
+		vk::SubmitInfo& submit_info = submission.submit_info;
+
+		submission.wait_semaphores[0] = fd.image_available_semaphore;
+		submission.wait_semaphores[1] = fd.compute_finished_semaphore;
+		submission.wait_stages[0] = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		if (m_Core->upscaling())
+			submission.wait_stages[0] |= vk::PipelineStageFlagBits::eTransfer; // the swapchain image may be blitted to
+		submission.wait_stages[1] =
+			vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput |
+			vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+
+		// headless frames neither acquire nor present, so skip the swapchain semaphores
+		u32 first_semaphore = m_Core->headless() ? 1 : 0;
+
+		submit_info.waitSemaphoreCount = 1 - first_semaphore;
+		submit_info.pWaitSemaphores = submission.wait_semaphores + first_semaphore;
+		submit_info.pWaitDstStageMask = submission.wait_stages + first_semaphore;
+
+		// the binary semaphore ignores its value
+		submission.signal_semaphores[0] = fd.render_finished_semaphore;
+		submission.signal_semaphores[1] = m_FrameTimeline;
+		submission.signal_values[0] = 0;
+		submission.signal_values[1] = m_SubmittedFrames + 1;
+		submit_info.signalSemaphoreCount = (m_FrameTimeline ? 2 : 1) - first_semaphore;
+		submit_info.pSignalSemaphores = submission.signal_semaphores + first_semaphore;
+
+		if (m_FrameTimeline)
+		{
+			submission.timeline_info.signalSemaphoreValueCount = submit_info.signalSemaphoreCount;
+			submission.timeline_info.pSignalSemaphoreValues = submission.signal_values + first_semaphore;
+			submit_info.pNext = &submission.timeline_info;
+		}
+
+		submission.fence = m_FrameTimeline ? nullptr : fd.in_flight_fence;
+
+		u32 cmd_buffer_count = 0;
+
+		if (fd.compute_recording)
+		{
+			if (this->async_compute())
+			{
+				fd.compute_cmd_buffer.end();
+
+				submission.compute_submit_info.commandBufferCount = 1;
+				submission.compute_submit_info.pCommandBuffers = &fd.compute_cmd_buffer;
+				submission.compute_submit_info.signalSemaphoreCount = 1;
+				submission.compute_submit_info.pSignalSemaphores = &fd.compute_finished_semaphore;
+				submission.compute = true;
+
+				submit_info.waitSemaphoreCount++;
+			} else
+			{
+				this->memory_barrier(
+					vk::PipelineStageFlagBits::eComputeShader,
+					vk::AccessFlagBits::eShaderWrite,
+					vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput |
+					vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader,
+					vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead |
+					vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead
+				);
+				fd.compute_cmd_buffer.end();
+
+				submission.cmd_buffers[cmd_buffer_count++] = fd.compute_cmd_buffer;
+			}
+
+			fd.compute_recording = false;
+		}
+
+		if (fd.pre_pass_recording)
+		{
+			fd.pre_pass_cmd_buffer.end();
+			submission.cmd_buffers[cmd_buffer_count++] = fd.pre_pass_cmd_buffer;
+
+			fd.pre_pass_recording = false;
+		}
+
+		submission.cmd_buffers[cmd_buffer_count++] = fd.cmd_buffer;
+		submit_info.commandBufferCount = cmd_buffer_count;
+		submit_info.pCommandBuffers = submission.cmd_buffers;
+	}
+
+	void Renderer::_submitted(void)
+	{
+		m_SubmittedFrames++;
+		m_Recording = false;
+
+		if (m_Core->headless())
+			m_FrameIndex = (m_FrameIndex + 1) % (u32)m_Frames.size();
+	}
+
+	void Renderer::_presented(vk::Result result)
+	{
+		switch (result)
+		{
+		case vk::Result::eSuboptimalKHR:
+		case vk::Result::eErrorOutOfDateKHR:
+			m_Core->m_SwapchainDirty = true; // recreated once by the next begin_frame
+			break;
+		case vk::Result::eSuccess:
+			break;
+		default:
+			NA_VERIFY_VK(result, "Failed to end frame #{} with image #{}: Error in presenting to graphics queue!", m_FrameIndex, m_ImageIndex);
+		}
+
+		m_FrameIndex = (m_FrameIndex + 1) % (u32)m_Frames.size();
+	}
+
+	void Renderer::_recreate_swapchain(void)
+	{
+		m_Core->_recreate_swapchain(m_SubmittedFrames);
+
+		// the old images' frames say nothing about the new images
+		m_ImageFrames = ArrayVector<u64>(m_Core->m_Images.size());
+	}
+
+	void Renderer::bind_pipeline(vk::CommandBuffer cmd_buffer, const GraphicsPipeline& pipeline) const
+	{
+		cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
 
 		if (pipeline.descriptor_set())
-			fd.cmd_buffer.bindDescriptorSets(
+			cmd_buffer.bindDescriptorSets(
 				vk::PipelineBindPoint::eGraphics,
 				pipeline.layout(),
 				0, // first set
@@ -206,16 +711,65 @@ namespace Na {
 			);
 	}
 
+	void Renderer::bind_pipeline(
+		vk::CommandBuffer cmd_buffer,
+		const GraphicsPipeline& pipeline,
+		const u32* dynamic_offsets,
+		u32 dynamic_offset_count
+	) const
+	{
+		NA_ASSERT(
+			dynamic_offset_count == pipeline.dynamic_offset_count(),
+			"Failed to bind pipeline: expected {} dynamic offsets, got {}!",
+				pipeline.dynamic_offset_count(),
+				dynamic_offset_count
+		);
+
+		cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+
+		if (pipeline.descriptor_set())
+			cmd_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eGraphics,
+				pipeline.layout(),
+				0, // first set
+				1, &pipeline.descriptor_set(),
+				dynamic_offset_count, dynamic_offsets
+			);
+	}
+
+	void Renderer::bind_pipeline(
+		vk::CommandBuffer cmd_buffer,
+		const GraphicsPipeline& pipeline,
+		vk::DescriptorSet descriptor_set,
+		const u32* dynamic_offsets,
+		u32 dynamic_offset_count
+	) const
+	{
+		NA_ASSERT(
+			dynamic_offset_count == pipeline.dynamic_offset_count(),
+			"Failed to bind pipeline: expected {} dynamic offsets, got {}!",
+				pipeline.dynamic_offset_count(),
+				dynamic_offset_count
+		);
+
+		cmd_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.pipeline());
+		cmd_buffer.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			pipeline.layout(),
+			0, // first set
+			1, &descriptor_set,
+			dynamic_offset_count, dynamic_offsets
+		);
+	}
+
 	void Renderer::set_push_constant(
+		vk::CommandBuffer cmd_buffer,
 		const PushConstant& push_constant,
 		const void* data,
 		const GraphicsPipeline& pipeline
-	)
+	) const
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-		FrameData& fd = m_Frames[m_FrameIndex];
-
-		fd.cmd_buffer.pushConstants(
+		cmd_buffer.pushConstants(
 			pipeline.layout(),
 			(vk::ShaderStageFlagBits)push_constant.shader_stage,
 			push_constant.offset,
@@ -224,13 +778,23 @@ namespace Na {
 		);
 	}
 
-	void Renderer::draw_vertices(const VertexBuffer& vertex_buffer, u32 vertex_count, u32 instance_count)
+	void Renderer::draw_vertices(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, u32 vertex_count, u32 instance_count) const
 	{
-		FrameData& fd = m_Frames[m_FrameIndex];
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+
+		cmd_buffer.draw(
+			vertex_count,
+			instance_count,
+			0, // first vertex
+			0 // first instance
+		);
+	}
 
-		fd.cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+	void Renderer::draw_vertices(vk::CommandBuffer cmd_buffer, const TransientAllocation& vertices, u32 vertex_count, u32 instance_count) const
+	{
+		cmd_buffer.bindVertexBuffers(0, { vertices.buffer }, { (vk::DeviceSize)vertices.offset });
 
-		fd.cmd_buffer.draw(
+		cmd_buffer.draw(
 			vertex_count,
 			instance_count,
 			0, // first vertex
@@ -238,22 +802,258 @@ namespace Na {
 		);
 	}
 
-	void Renderer::draw_indexed(const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 instance_count)
+	void Renderer::draw_indexed(vk::CommandBuffer cmd_buffer, const VertexBuffer& vertex_buffer, const IndexBuffer& index_buffer, u32 instance_count) const
 	{
-		FrameData& fd = m_Frames[m_FrameIndex];
+		this->draw_indexed(cmd_buffer, vertex_buffer, index_buffer, 0, index_buffer.count(), instance_count);
+	}
+
+	void Renderer::draw_indexed(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		u32 first_index,
+		u32 index_count,
+		u32 instance_count
+	) const
+	{
+		NA_ASSERT((u64)first_index + index_count <= index_buffer.count(), "Failed to draw indexed: index range exceeds the index buffer!");
+
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+		cmd_buffer.bindIndexBuffer(index_buffer.native(), 0, index_buffer.index_type());
+
+		cmd_buffer.drawIndexed(
+			index_count,
+			instance_count,
+			first_index,
+			0, // vertex offset
+			0 // first instance
+		);
+	}
+
+	void Renderer::draw_mesh(vk::CommandBuffer cmd_buffer, const GpuMesh& mesh, u32 level, u32 instance_count) const
+	{
+		NA_ASSERT(level < mesh.lod_count(), "Failed to draw mesh: level of detail out of range!");
+
+		const MeshLod& lod = mesh.lod(level);
+		this->draw_indexed(cmd_buffer, mesh.vertex_buffer(), mesh.index_buffer(), lod.first_index, lod.index_count, instance_count);
+	}
 
-		fd.cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
-		fd.cmd_buffer.bindIndexBuffer(index_buffer.native(), 0, vk::IndexType::eUint32);
+	void Renderer::bind_instances(vk::CommandBuffer cmd_buffer, const TransientAllocation& instances) const
+	{
+		NA_ASSERT(instances, "Failed to bind instances: allocation is invalid!");
+		cmd_buffer.bindVertexBuffers(k_InstanceBinding, { instances.buffer }, { (vk::DeviceSize)instances.offset });
+	}
+
+	void Renderer::draw_vertices(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		u32 vertex_count,
+		const TransientAllocation& instances,
+		u32 instance_count,
+		u32 first_instance
+	) const
+	{
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+		this->bind_instances(cmd_buffer, instances);
 
-		fd.cmd_buffer.drawIndexed(
+		cmd_buffer.draw(
+			vertex_count,
+			instance_count,
+			0, // first vertex
+			first_instance
+		);
+	}
+
+	void Renderer::draw_indexed(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		const TransientAllocation& instances,
+		u32 instance_count,
+		u32 first_instance
+	) const
+	{
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+		cmd_buffer.bindIndexBuffer(index_buffer.native(), 0, index_buffer.index_type());
+		this->bind_instances(cmd_buffer, instances);
+
+		cmd_buffer.drawIndexed(
 			index_buffer.count(),
 			instance_count,
-			0,  // first index
+			0, // first index
 			0, // vertex offset
+			first_instance
+		);
+	}
+
+	void Renderer::bind_geometry(vk::CommandBuffer cmd_buffer, const GeometryPool& pool) const
+	{
+		cmd_buffer.bindVertexBuffers(0, { pool.vertex_buffer().buffer }, { 0 });
+		cmd_buffer.bindIndexBuffer(pool.index_buffer().buffer, 0, pool.index_type());
+	}
+
+	void Renderer::draw_indexed(vk::CommandBuffer cmd_buffer, const GeometryAllocation& geometry, u32 instance_count) const
+	{
+		NA_ASSERT(geometry, "Failed to draw indexed: geometry is not allocated!");
+
+		cmd_buffer.drawIndexed(
+			geometry.index_count,
+			instance_count,
+			geometry.first_index,
+			(i32)geometry.first_vertex,
 			0 // first instance
 		);
 	}
 
+	void Renderer::draw_indexed_indirect(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		const StorageBuffer& commands,
+		u32 draw_count
+	) const
+	{
+		NA_ASSERT(draw_count * sizeof(vk::DrawIndexedIndirectCommand) <= commands.per_frame_size(), "Failed to draw indexed indirect: draw count exceeds the command buffer!");
+
+		this->draw_indexed_indirect(
+			cmd_buffer,
+			vertex_buffer, index_buffer,
+			commands.buffer().buffer, m_FrameIndex * commands.frame_stride(),
+			draw_count
+		);
+	}
+
+	void Renderer::draw_indexed_indirect_count(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		const StorageBuffer& commands,
+		const StorageBuffer& count_buffer,
+		u32 max_draw_count
+	) const
+	{
+		this->draw_indexed_indirect_count(
+			cmd_buffer,
+			vertex_buffer, index_buffer,
+			commands.buffer().buffer, m_FrameIndex * commands.frame_stride(),
+			count_buffer.buffer().buffer, m_FrameIndex * count_buffer.frame_stride(),
+			_max_indirect_draws(commands, max_draw_count)
+		);
+	}
+
+	void Renderer::draw_indexed_indirect(
+		vk::CommandBuffer cmd_buffer,
+		const GeometryPool& pool,
+		const StorageBuffer& commands,
+		u32 draw_count
+	) const
+	{
+		NA_ASSERT(draw_count * sizeof(vk::DrawIndexedIndirectCommand) <= commands.per_frame_size(), "Failed to draw indexed indirect: draw count exceeds the command buffer!");
+
+		if (!draw_count)
+			return;
+
+		this->bind_geometry(cmd_buffer, pool);
+		this->_record_indexed_indirect(cmd_buffer, commands.buffer().buffer, m_FrameIndex * commands.frame_stride(), draw_count);
+	}
+
+	void Renderer::draw_indexed_indirect_count(
+		vk::CommandBuffer cmd_buffer,
+		const GeometryPool& pool,
+		const StorageBuffer& commands,
+		const StorageBuffer& count_buffer,
+		u32 max_draw_count
+	) const
+	{
+		NA_ASSERT(VkContext::GetDeviceFeatures().draw_indirect_count, "Failed to draw indexed indirect count: VK_KHR_draw_indirect_count is not supported!");
+
+		this->bind_geometry(cmd_buffer, pool);
+		this->_record_indexed_indirect_count(
+			cmd_buffer,
+			commands.buffer().buffer, m_FrameIndex * commands.frame_stride(),
+			count_buffer.buffer().buffer, m_FrameIndex * count_buffer.frame_stride(),
+			_max_indirect_draws(commands, max_draw_count)
+		);
+	}
+
+	void Renderer::draw_indexed_indirect(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		vk::Buffer commands,
+		vk::DeviceSize offset,
+		u32 draw_count
+	) const
+	{
+		if (!draw_count)
+			return;
+
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+		cmd_buffer.bindIndexBuffer(index_buffer.native(), 0, index_buffer.index_type());
+
+		this->_record_indexed_indirect(cmd_buffer, commands, offset, draw_count);
+	}
+
+	void Renderer::draw_indexed_indirect_count(
+		vk::CommandBuffer cmd_buffer,
+		const VertexBuffer& vertex_buffer,
+		const IndexBuffer& index_buffer,
+		vk::Buffer commands,
+		vk::DeviceSize offset,
+		vk::Buffer count_buffer,
+		vk::DeviceSize count_offset,
+		u32 max_draw_count
+	) const
+	{
+		NA_ASSERT(VkContext::GetDeviceFeatures().draw_indirect_count, "Failed to draw indexed indirect count: VK_KHR_draw_indirect_count is not supported!");
+
+		cmd_buffer.bindVertexBuffers(0, { vertex_buffer.native() }, { 0 });
+		cmd_buffer.bindIndexBuffer(index_buffer.native(), 0, index_buffer.index_type());
+
+		this->_record_indexed_indirect_count(cmd_buffer, commands, offset, count_buffer, count_offset, max_draw_count);
+	}
+
+	void Renderer::_record_indexed_indirect(vk::CommandBuffer cmd_buffer, vk::Buffer commands, vk::DeviceSize offset, u32 draw_count) const
+	{
+		constexpr u32 stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+		if (VkContext::GetDeviceFeatures().multi_draw_indirect)
+		{
+			cmd_buffer.drawIndexedIndirect(commands, offset, draw_count, stride);
+			return;
+		}
+
+		for (u32 i = 0; i < draw_count; i++)
+			cmd_buffer.drawIndexedIndirect(commands, offset + i * stride, 1, stride);
+	}
+
+	void Renderer::_record_indexed_indirect_count(
+		vk::CommandBuffer cmd_buffer,
+		vk::Buffer commands,
+		vk::DeviceSize offset,
+		vk::Buffer count_buffer,
+		vk::DeviceSize count_offset,
+		u32 max_draw_count
+	) const
+	{
+		VkContext::GetCmdDrawIndexedIndirectCount()(
+			cmd_buffer,
+			commands, offset,
+			count_buffer, count_offset,
+			max_draw_count,
+			sizeof(vk::DrawIndexedIndirectCommand)
+		);
+	}
+
+	u32 Renderer::_max_indirect_draws(const StorageBuffer& commands, u32 max_draw_count)
+	{
+		u32 capacity = (u32)(commands.per_frame_size() / sizeof(vk::DrawIndexedIndirectCommand));
+		if (!max_draw_count || max_draw_count > capacity)
+			return capacity;
+
+		return max_draw_count;
+	}
+
 	void Renderer::set_descriptor_buffer(void* buffer, const void* data) const
 	{
 		NA_ASSERT(buffer, "Failed to set descriptor buffer: buffer is null!");
@@ -263,19 +1063,57 @@ namespace Na {
 		switch (uniform_type)
 		{
 			case ShaderUniformType::UniformBuffer:
+				this->set_descriptor_buffer(buffer, data, ((UniformBuffer*)buffer)->per_frame_size());
+				break;
+			case ShaderUniformType::StorageBuffer:
+				this->set_descriptor_buffer(buffer, data, ((StorageBuffer*)buffer)->per_frame_size());
+				break;
+			default:
 			{
-				UniformBuffer& uniform_buffer = *(UniformBuffer*)buffer;
-				void* mapped = (Byte*)(uniform_buffer.mapped_data()) + (m_FrameIndex * uniform_buffer.aligned_size());
-				memcpy(mapped, data, uniform_buffer.per_frame_size());
+				throw std::runtime_error("Failed to set descriptor buffer: buffer has unknown type!");
 				break;
 			}
+		}
+	}
+
+	void Renderer::sync_descriptor_buffer(void* buffer) const
+	{
+		NA_ASSERT(buffer, "Failed to sync descriptor buffer: buffer is null!");
+
+		// other buffers have no cpu copy to catch up with
+		ShaderUniformType uniform_type = *(const ShaderUniformType*)buffer;
+		switch (uniform_type)
+		{
+			case ShaderUniformType::UniformBuffer:
+				if (((UniformBuffer*)buffer)->update_rate() == BufferUpdateRate::Tracked)
+					((UniformBuffer*)buffer)->sync(m_FrameIndex);
+				break;
 			case ShaderUniformType::StorageBuffer:
+				if (((StorageBuffer*)buffer)->update_rate() == BufferUpdateRate::Tracked)
+					((StorageBuffer*)buffer)->sync(m_FrameIndex);
+				break;
+			default:
 			{
-				StorageBuffer& storage_buffer = *(StorageBuffer*)buffer;
-				void* mapped = (Byte*)(storage_buffer.mapped_data()) + (m_FrameIndex * storage_buffer.aligned_size());
-				memcpy(mapped, data, storage_buffer.per_frame_size());
+				throw std::runtime_error("Failed to sync descriptor buffer: buffer has unknown type!");
 				break;
 			}
+		}
+	}
+
+	void Renderer::set_descriptor_buffer(void* buffer, const void* data, u64 size, u64 offset) const
+	{
+		NA_ASSERT(buffer, "Failed to set descriptor buffer: buffer is null!");
+		NA_ASSERT(data, "Failed to set descriptor buffer: data is null!");
+
+		ShaderUniformType uniform_type = *(const ShaderUniformType*)buffer;
+		switch (uniform_type)
+		{
+			case ShaderUniformType::UniformBuffer:
+				writeDescriptorBuffer(*(UniformBuffer*)buffer, m_FrameIndex, data, size, offset);
+				break;
+			case ShaderUniformType::StorageBuffer:
+				writeDescriptorBuffer(*(StorageBuffer*)buffer, m_FrameIndex, data, size, offset);
+				break;
 			default:
 			{
 				throw std::runtime_error("Failed to set descriptor buffer: buffer has unknown type!");
@@ -284,6 +1122,369 @@ namespace Na {
 		}
 	}
 
+	void Renderer::bind_pipeline(const ComputePipeline& pipeline)
+	{
+		vk::CommandBuffer cmd_buffer = this->compute_cmd_buffer();
+
+		cmd_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline.pipeline());
+
+		if (pipeline.descriptor_set())
+			cmd_buffer.bindDescriptorSets(
+				vk::PipelineBindPoint::eCompute,
+				pipeline.layout(),
+				0, // first set
+				1, &pipeline.descriptor_set(),
+				pipeline.dynamic_offset_count(), pipeline.dynamic_offsets().ptr() + (m_FrameIndex * pipeline.dynamic_offset_count())
+			);
+	}
+
+	void Renderer::set_push_constant(const PushConstant& push_constant, const void* data, const ComputePipeline& pipeline)
+	{
+		this->compute_cmd_buffer().pushConstants(
+			pipeline.layout(),
+			(vk::ShaderStageFlagBits)push_constant.shader_stage,
+			push_constant.offset,
+			push_constant.size,
+			data
+		);
+	}
+
+	void Renderer::dispatch(u32 group_count_x, u32 group_count_y, u32 group_count_z)
+	{
+		this->compute_cmd_buffer().dispatch(group_count_x, group_count_y, group_count_z);
+	}
+
+	void Renderer::memory_barrier(
+		vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+		vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+	)
+	{
+		vk::MemoryBarrier barrier(src_access, dst_access);
+
+		this->compute_cmd_buffer().pipelineBarrier(
+			src_stage,
+			dst_stage,
+			{}, // dependency flags
+			1, &barrier, // memory barriers
+			0, nullptr, // buffer memory barriers
+			0, nullptr // image memory barriers
+		);
+	}
+
+	void Renderer::buffer_barrier(
+		const DeviceBuffer& buffer,
+		vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+		vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+	)
+	{
+		vk::BufferMemoryBarrier barrier;
+		barrier.srcAccessMask = src_access;
+		barrier.dstAccessMask = dst_access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer.buffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+
+		this->compute_cmd_buffer().pipelineBarrier(
+			src_stage,
+			dst_stage,
+			{}, // dependency flags
+			0, nullptr, // memory barriers
+			1, &barrier, // buffer memory barriers
+			0, nullptr // image memory barriers
+		);
+	}
+
+	void Renderer::image_barrier(
+		const DeviceImage& image,
+		vk::ImageLayout old_layout, vk::ImageLayout new_layout,
+		vk::PipelineStageFlags src_stage, vk::AccessFlags src_access,
+		vk::PipelineStageFlags dst_stage, vk::AccessFlags dst_access
+	)
+	{
+		vk::ImageMemoryBarrier barrier;
+		barrier.oldLayout = old_layout;
+		barrier.newLayout = new_layout;
+		barrier.srcAccessMask = src_access;
+		barrier.dstAccessMask = dst_access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image.img;
+		barrier.subresourceRange = image.subresource_range;
+
+		this->compute_cmd_buffer().pipelineBarrier(
+			src_stage,
+			dst_stage,
+			{}, // dependency flags
+			0, nullptr, // memory barriers
+			0, nullptr, // buffer memory barriers
+			1, &barrier // image memory barriers
+		);
+	}
+
+	vk::CommandBuffer Renderer::compute_cmd_buffer(void)
+	{
+		FrameData& fd = m_Frames[m_FrameIndex];
+
+		if (!fd.compute_recording)
+		{
+			vk::CommandBufferBeginInfo begin_info;
+			begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+			// implicitly resets, the frame's fence has already been waited on
+			fd.compute_cmd_buffer.begin(begin_info);
+			fd.compute_recording = true;
+		}
+
+		return fd.compute_cmd_buffer;
+	}
+
+	void Renderer::_begin_rendering(vk::CommandBuffer cmd_buffer, const std::array<vk::ClearValue, 2>& clear_values)
+	{
+		// without msaa the swapchain image is rendered to directly, otherwise it is the resolve target
+		bool resolve = m_Core->samples() != vk::SampleCountFlagBits::e1;
+		vk::ImageView swapchain_view = m_Core->m_ImageViews[m_ImageIndex];
+
+		vk::ImageAspectFlags depth_aspect = vk::ImageAspectFlagBits::eDepth;
+		if (m_Core->m_DepthFormat != vk::Format::eD32Sfloat)
+			depth_aspect |= vk::ImageAspectFlagBits::eStencil;
+
+		// every attachment is cleared, so the previous contents are discarded with eUndefined
+		auto barrier = [](vk::Image image, vk::ImageAspectFlags aspect, vk::ImageLayout layout, vk::AccessFlags src_access, vk::AccessFlags dst_access)
+		{
+			vk::ImageMemoryBarrier barrier;
+			barrier.oldLayout = vk::ImageLayout::eUndefined;
+			barrier.newLayout = layout;
+			barrier.srcAccessMask = src_access;
+			barrier.dstAccessMask = dst_access;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { aspect, 0, 1, 0, 1 };
+			return barrier;
+		};
+
+		std::array<vk::ImageMemoryBarrier, 3> barriers;
+		u32 barrier_count = 0;
+
+		// an upscaled image was already transitioned by the pre-pass and must be kept
+		if (!m_Core->upscaling())
+			barriers[barrier_count++] = barrier(
+				m_Core->m_Images[m_ImageIndex],
+				vk::ImageAspectFlagBits::eColor,
+				vk::ImageLayout::eColorAttachmentOptimal,
+				{},
+				vk::AccessFlagBits::eColorAttachmentWrite
+			);
+		if (resolve)
+			barriers[barrier_count++] = barrier(
+				m_Core->m_ColorImage.img,
+				vk::ImageAspectFlagBits::eColor,
+				vk::ImageLayout::eColorAttachmentOptimal,
+				vk::AccessFlagBits::eColorAttachmentWrite,
+				vk::AccessFlagBits::eColorAttachmentWrite
+			);
+		barriers[barrier_count++] = barrier(
+			m_Core->m_DepthImage.img,
+			depth_aspect,
+			vk::ImageLayout::eDepthStencilAttachmentOptimal,
+			vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+			vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite
+		);
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests
+			| vk::PipelineStageFlagBits::eLateFragmentTests,
+			{},
+			0, nullptr,
+			0, nullptr,
+			barrier_count, barriers.data()
+		);
+
+		vk::RenderingAttachmentInfoKHR color_attachment;
+		color_attachment.imageView = resolve ? m_Core->m_ColorImageView : swapchain_view;
+		color_attachment.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		color_attachment.loadOp = m_Core->upscaling() ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
+		color_attachment.storeOp = resolve ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
+		color_attachment.clearValue = clear_values[0];
+		if (resolve)
+		{
+			color_attachment.resolveMode = vk::ResolveModeFlagBits::eAverage;
+			color_attachment.resolveImageView = swapchain_view;
+			color_attachment.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		}
+
+		vk::RenderingAttachmentInfoKHR depth_attachment;
+		depth_attachment.imageView = m_Core->m_DepthImageView;
+		depth_attachment.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+		depth_attachment.loadOp = vk::AttachmentLoadOp::eClear;
+		depth_attachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+		depth_attachment.clearValue = clear_values[1];
+
+		vk::RenderingInfoKHR rendering_info;
+		if (this->records_secondary())
+			rendering_info.flags = vk::RenderingFlagBitsKHR::eContentsSecondaryCommandBuffers;
+		rendering_info.renderArea.offset = { { 0, 0 } };
+		rendering_info.renderArea.extent = m_Core->m_Extent;
+		rendering_info.layerCount = 1;
+		rendering_info.colorAttachmentCount = 1;
+		rendering_info.pColorAttachments = &color_attachment;
+		rendering_info.pDepthAttachment = &depth_attachment;
+
+		VkContext::GetCmdBeginRendering()(cmd_buffer, &static_cast<const VkRenderingInfoKHR&>(rendering_info));
+	}
+
+	void Renderer::_end_rendering(vk::CommandBuffer cmd_buffer)
+	{
+		VkContext::GetCmdEndRendering()(cmd_buffer);
+
+		vk::ImageMemoryBarrier barrier;
+		barrier.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		barrier.newLayout = vk::ImageLayout::ePresentSrcKHR;
+		barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+
+		// headless images are left ready for read_back
+		vk::PipelineStageFlags dst_stage = vk::PipelineStageFlagBits::eBottomOfPipe;
+		if (m_Core->headless())
+		{
+			barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+			barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+			dst_stage = vk::PipelineStageFlagBits::eTransfer;
+		}
+
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = m_Core->m_Images[m_ImageIndex];
+		barrier.subresourceRange = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 };
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			dst_stage,
+			{},
+			0, nullptr,
+			0, nullptr,
+			1, &barrier
+		);
+	}
+
+	void Renderer::upscale(const RenderTarget& target, vk::Extent2D extent)
+	{
+		NA_ASSERT(m_Core->upscaling(), "Failed to upscale: RendererSettings::upscaling is disabled!");
+		NA_ASSERT(!m_Frames[m_FrameIndex].upscaled, "Failed to upscale: Frame #{} was upscaled already!", m_FrameIndex);
+		NA_ASSERT(
+			extent.width <= target.extent().width && extent.height <= target.extent().height,
+			"Failed to upscale: Extent {}x{} exceeds the target!",
+				extent.width,
+				extent.height
+		);
+
+		this->_upscale(&target, extent);
+	}
+
+	void Renderer::_upscale(const RenderTarget* target, vk::Extent2D extent)
+	{
+		vk::CommandBuffer cmd_buffer = this->pre_pass_cmd_buffer();
+
+		// msaa is off, so the swapchain image is the color attachment with or without a render pass
+		vk::Image dst = m_Core->m_Images[m_ImageIndex];
+		vk::ImageSubresourceRange range = { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 };
+
+		std::array<vk::ImageMemoryBarrier, 2> barriers;
+
+		// the whole image is overwritten, so the previous contents are discarded
+		barriers[0].oldLayout = vk::ImageLayout::eUndefined;
+		barriers[0].newLayout = vk::ImageLayout::eTransferDstOptimal;
+		barriers[0].srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+		barriers[0].dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+		barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].image = dst;
+		barriers[0].subresourceRange = range;
+
+		if (target)
+		{
+			barriers[1].oldLayout = target->info().final_layout;
+			barriers[1].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+			barriers[1].srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+			barriers[1].dstAccessMask = vk::AccessFlagBits::eTransferRead;
+			barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barriers[1].image = target->image().img;
+			barriers[1].subresourceRange = range;
+		}
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eTransfer,
+			{},
+			0, nullptr,
+			0, nullptr,
+			target ? 2 : 1, barriers.data()
+		);
+
+		if (target)
+		{
+			vk::ImageBlit blit;
+			blit.srcSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+			blit.srcOffsets[1] = vk::Offset3D{ (i32)extent.width, (i32)extent.height, 1 };
+			blit.dstSubresource = { vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+			blit.dstOffsets[1] = vk::Offset3D{ (i32)m_Core->m_Width, (i32)m_Core->m_Height, 1 };
+
+			cmd_buffer.blitImage(
+				target->image().img, vk::ImageLayout::eTransferSrcOptimal,
+				dst, vk::ImageLayout::eTransferDstOptimal,
+				1, &blit,
+				vk::Filter::eLinear
+			);
+		} else
+		{
+			vk::ClearColorValue clear_color(std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 1.0f });
+			cmd_buffer.clearColorImage(dst, vk::ImageLayout::eTransferDstOptimal, &clear_color, 1, &range);
+		}
+
+		barriers[0].oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		barriers[0].newLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		barriers[0].srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+		barriers[0].dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite;
+
+		if (target)
+		{
+			barriers[1].oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+			barriers[1].newLayout = target->info().final_layout;
+			barriers[1].srcAccessMask = {};
+			barriers[1].dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eColorAttachmentWrite;
+		}
+
+		cmd_buffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eFragmentShader,
+			{},
+			0, nullptr,
+			0, nullptr,
+			target ? 2 : 1, barriers.data()
+		);
+
+		m_Frames[m_FrameIndex].upscaled = true;
+	}
+
+	vk::CommandBuffer Renderer::pre_pass_cmd_buffer(void)
+	{
+		FrameData& fd = m_Frames[m_FrameIndex];
+
+		if (!fd.pre_pass_recording)
+		{
+			vk::CommandBufferBeginInfo begin_info;
+			begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+			fd.pre_pass_cmd_buffer.begin(begin_info);
+			fd.pre_pass_recording = true;
+		}
+
+		return fd.pre_pass_cmd_buffer;
+	}
+
 	void Renderer::_create_command_objects(void)
 	{
 		vk::Device logical_device = VkContext::GetLogicalDevice();
@@ -301,6 +1502,37 @@ namespace Na {
 
 		for (u64 i = 0; auto cmd_buffer : logical_device.allocateCommandBuffers(cmd_alloc_info))
 			m_Frames[i++].cmd_buffer = cmd_buffer;
+
+		for (u64 i = 0; auto cmd_buffer : logical_device.allocateCommandBuffers(cmd_alloc_info))
+			m_Frames[i++].pre_pass_cmd_buffer = cmd_buffer;
+
+		// a compute queue aliasing the graphics one gets its work in the graphics submission instead
+		QueueFamilyIndices context_indices = VkContext::GetQueueFamilyIndices();
+		if (m_Core->m_Settings.async_compute
+		 && context_indices.compute != m_Core->m_QueueIndices.graphics
+		 && VkContext::GetComputeQueue() != VkContext::GetGraphicsQueue())
+		{
+			vk::CommandPoolCreateInfo compute_pool_info;
+			compute_pool_info.queueFamilyIndex = context_indices.compute;
+			compute_pool_info.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+
+			m_ComputeCmdPool = logical_device.createCommandPool(compute_pool_info);
+		}
+
+		cmd_alloc_info.commandPool = m_ComputeCmdPool ? m_ComputeCmdPool : m_GraphicsCmdPool;
+		for (u64 i = 0; auto cmd_buffer : logical_device.allocateCommandBuffers(cmd_alloc_info))
+			m_Frames[i++].compute_cmd_buffer = cmd_buffer;
+
+		vk::CommandPoolCreateInfo worker_pool_info;
+		worker_pool_info.queueFamilyIndex = m_Core->m_QueueIndices.graphics;
+		worker_pool_info.flags = vk::CommandPoolCreateFlagBits::eTransient;
+
+		for (FrameData& fd : m_Frames)
+		{
+			fd.workers.resize(m_Core->m_Settings.recording_threads);
+			for (WorkerCmdData& worker : fd.workers)
+				worker.cmd_pool = logical_device.createCommandPool(worker_pool_info);
+		}
 	}
 
 	void Renderer::_create_sync_objects(void)
@@ -312,12 +1544,29 @@ namespace Na {
 		vk::FenceCreateInfo fence_info;
 		fence_info.flags = vk::FenceCreateFlagBits::eSignaled;
 
+		// one semaphore counting submitted frames replaces the per-frame fences
+		if (VkContext::GetDeviceFeatures().timeline_semaphore)
+		{
+			vk::SemaphoreTypeCreateInfoKHR type_info;
+			type_info.semaphoreType = vk::SemaphoreType::eTimeline;
+			type_info.initialValue = m_SubmittedFrames;
+
+			vk::SemaphoreCreateInfo timeline_info;
+			timeline_info.pNext = &type_info;
+
+			m_FrameTimeline = logical_device.createSemaphore(timeline_info);
+		}
+
 		for (u32 i = 0; i < m_Frames.size(); i++)
 		{
-			m_Frames[i].in_flight_fence = logical_device.createFence(fence_info);
+			if (!m_FrameTimeline)
+				m_Frames[i].in_flight_fence = logical_device.createFence(fence_info);
 
 			m_Frames[i].image_available_semaphore = logical_device.createSemaphore(semaphore_info);
 			m_Frames[i].render_finished_semaphore = logical_device.createSemaphore(semaphore_info);
+
+			if (m_ComputeCmdPool)
+				m_Frames[i].compute_finished_semaphore = logical_device.createSemaphore(semaphore_info);
 		}
 
 	}
@@ -325,9 +1574,26 @@ namespace Na {
 	Renderer::Renderer(Renderer&& other)
 	: m_Core(std::exchange(other.m_Core, nullptr)),
 	m_GraphicsCmdPool(std::exchange(other.m_GraphicsCmdPool, nullptr)),
+	m_ComputeCmdPool(std::exchange(other.m_ComputeCmdPool, nullptr)),
 	m_Frames(std::move(other.m_Frames)),
 	m_FrameIndex(other.m_FrameIndex),
-	m_ImageIndex(other.m_ImageIndex)
+	m_FrameWaited(other.m_FrameWaited),
+	m_FrameLatency(other.m_FrameLatency),
+	m_Recording(std::exchange(other.m_Recording, false)),
+	m_SubmittedFrames(other.m_SubmittedFrames),
+	m_CompletedFrames(other.m_CompletedFrames),
+	m_DeletionSubmitter(std::exchange(other.m_DeletionSubmitter, k_U32Max)),
+	m_FrameTimeline(std::exchange(other.m_FrameTimeline, nullptr)),
+	m_SecondaryCmdBuffers(std::move(other.m_SecondaryCmdBuffers)),
+	m_DrawQueue(std::move(other.m_DrawQueue)),
+	m_InstanceBuffer(std::move(other.m_InstanceBuffer)),
+	m_Profiler(std::move(other.m_Profiler)),
+	m_DescriptorAllocator(std::move(other.m_DescriptorAllocator)),
+	m_ImageFrames(std::move(other.m_ImageFrames)),
+	m_ImageIndex(other.m_ImageIndex),
+	m_PendingWaitTime(other.m_PendingWaitTime),
+	m_FrameWaitTime(other.m_FrameWaitTime),
+	m_TotalWaitTime(other.m_TotalWaitTime)
 	{}
 
 	Renderer& Renderer::operator=(Renderer&& other)
@@ -336,9 +1602,26 @@ namespace Na {
 
 		m_Core = std::exchange(other.m_Core, nullptr);
 		m_GraphicsCmdPool = std::exchange(other.m_GraphicsCmdPool, nullptr);
+		m_ComputeCmdPool = std::exchange(other.m_ComputeCmdPool, nullptr);
 		m_Frames = std::move(other.m_Frames);
 		m_FrameIndex = other.m_FrameIndex;
+		m_FrameWaited = other.m_FrameWaited;
+		m_FrameLatency = other.m_FrameLatency;
+		m_Recording = std::exchange(other.m_Recording, false);
+		m_SubmittedFrames = other.m_SubmittedFrames;
+		m_CompletedFrames = other.m_CompletedFrames;
+		m_DeletionSubmitter = std::exchange(other.m_DeletionSubmitter, k_U32Max);
+		m_FrameTimeline = std::exchange(other.m_FrameTimeline, nullptr);
+		m_SecondaryCmdBuffers = std::move(other.m_SecondaryCmdBuffers);
+		m_DrawQueue = std::move(other.m_DrawQueue);
+		m_InstanceBuffer = std::move(other.m_InstanceBuffer);
+		m_Profiler = std::move(other.m_Profiler);
+		m_DescriptorAllocator = std::move(other.m_DescriptorAllocator);
+		m_ImageFrames = std::move(other.m_ImageFrames);
 		m_ImageIndex = other.m_ImageIndex;
+		m_PendingWaitTime = other.m_PendingWaitTime;
+		m_FrameWaitTime = other.m_FrameWaitTime;
+		m_TotalWaitTime = other.m_TotalWaitTime;
 
 		return *this;
 	}
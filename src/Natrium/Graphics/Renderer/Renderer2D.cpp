@@ -0,0 +1,206 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/Renderer/Renderer2D.hpp"
+
+namespace Na {
+	Renderer2D::Renderer2D(const RendererSettings& renderer_settings, const Renderer2DInfo& info)
+	: m_Info(info)
+	{
+		NA_VERIFY(
+			info.batch_quads && info.batch_quads <= 16384 && info.batch_quads <= info.max_quads,
+			"Failed to create Renderer2D: {} quads per batch do not fit 16 bit indices or {} quads per frame!",
+				info.batch_quads,
+				info.max_quads
+		);
+
+		// whole chunks only, the last one of a frame may stay partly unused
+		u64 chunk_size = (u64)info.batch_quads * 4 * sizeof(QuadVertex);
+		u64 per_frame_size = (info.max_quads + info.batch_quads - 1) / info.batch_quads * chunk_size;
+
+		m_Vertices = TransientBuffer(
+			per_frame_size,
+			ShaderUniformType::StorageBuffer,
+			std::min<u64>(chunk_size, VkContext::GetPhysicalDeviceLimits().maxStorageBufferRange),
+			renderer_settings
+		);
+
+		ArrayVector<u16> indices(info.batch_quads * 6);
+		for (u32 quad = 0; quad < info.batch_quads; quad++)
+		{
+			u16 vertex = (u16)(quad * 4);
+			u16* index = indices.ptr() + quad * 6;
+
+			index[0] = vertex;
+			index[1] = vertex + 1;
+			index[2] = vertex + 2;
+			index[3] = vertex + 2;
+			index[4] = vertex + 3;
+			index[5] = vertex;
+		}
+		m_Indices = IndexBuffer((u32)indices.size(), indices.ptr());
+	}
+
+	void Renderer2D::destroy(void)
+	{
+		m_Vertices.destroy();
+		m_Indices.destroy();
+
+		m_Renderer = nullptr;
+		m_Chunk = {};
+	}
+
+	void Renderer2D::begin(Renderer& renderer, vk::CommandBuffer cmd_buffer)
+	{
+		NA_ASSERT(renderer.recording(), "Failed to begin Renderer2D: The renderer is not recording a frame!");
+
+		m_Renderer = &renderer;
+		m_CmdBuffer = cmd_buffer ? cmd_buffer : renderer.current_frame().cmd_buffer;
+
+		// the frame's slot was waited on by begin_frame, a later begin in the same frame keeps filling its chunk
+		if (m_Frame != renderer.submitted_frames())
+		{
+			m_Frame = renderer.submitted_frames();
+			m_Vertices.begin_frame(renderer.current_frame_index());
+
+			m_Chunk = {};
+			m_ChunkQuads = 0;
+			m_BatchStart = 0;
+			m_Exhausted = false;
+		}
+
+		m_BatchStart = m_ChunkQuads;
+		m_Pipeline = nullptr;
+		m_DescriptorSet = nullptr;
+		m_PipelineBound = false;
+
+		m_QuadCount = 0;
+		m_DrawCalls = 0;
+	}
+
+	void Renderer2D::end(void)
+	{
+		this->_flush();
+		m_Renderer = nullptr;
+	}
+
+	void Renderer2D::set_pipeline(const GraphicsPipeline& pipeline, vk::DescriptorSet descriptor_set)
+	{
+		if (m_Pipeline == &pipeline && m_DescriptorSet == descriptor_set)
+			return;
+
+		this->_flush();
+
+		m_Pipeline = &pipeline;
+		m_DescriptorSet = descriptor_set;
+		m_PipelineBound = false;
+	}
+
+	void Renderer2D::draw_quad(
+		const glm::mat4& transform,
+		const glm::vec4& color,
+		BindlessIndex texture,
+		const glm::vec2& uv_min,
+		const glm::vec2& uv_max,
+		u32 layer
+	)
+	{
+		QuadVertex* vertices = this->_next_quad();
+		if (!vertices)
+			return;
+
+		u32 packed_color = PackColor(color);
+		glm::vec2 texture_layer(texture == k_NullBindlessIndex ? -1.0f : (float)texture, (float)layer);
+
+		// the columns are the transformed unit axes, so each corner is a sum of them
+		glm::vec3 origin = transform[3];
+		glm::vec3 x_axis = transform[0];
+		glm::vec3 y_axis = transform[1];
+
+		vertices[0] = QuadVertex{ origin, uv_min, packed_color, texture_layer };
+		vertices[1] = QuadVertex{ origin + x_axis, { uv_max.x, uv_min.y }, packed_color, texture_layer };
+		vertices[2] = QuadVertex{ origin + x_axis + y_axis, uv_max, packed_color, texture_layer };
+		vertices[3] = QuadVertex{ origin + y_axis, { uv_min.x, uv_max.y }, packed_color, texture_layer };
+	}
+
+	void Renderer2D::draw_quad(
+		const glm::vec3& position,
+		const glm::vec2& size,
+		const glm::vec4& color,
+		BindlessIndex texture,
+		const glm::vec2& uv_min,
+		const glm::vec2& uv_max,
+		u32 layer
+	)
+	{
+		QuadVertex* vertices = this->_next_quad();
+		if (!vertices)
+			return;
+
+		u32 packed_color = PackColor(color);
+		glm::vec2 texture_layer(texture == k_NullBindlessIndex ? -1.0f : (float)texture, (float)layer);
+
+		vertices[0] = QuadVertex{ position, uv_min, packed_color, texture_layer };
+		vertices[1] = QuadVertex{ { position.x + size.x, position.y, position.z }, { uv_max.x, uv_min.y }, packed_color, texture_layer };
+		vertices[2] = QuadVertex{ { position.x + size.x, position.y + size.y, position.z }, uv_max, packed_color, texture_layer };
+		vertices[3] = QuadVertex{ { position.x, position.y + size.y, position.z }, { uv_min.x, uv_max.y }, packed_color, texture_layer };
+	}
+
+	QuadVertex* Renderer2D::_next_quad(void)
+	{
+		NA_ASSERT(m_Renderer, "Failed to draw quad: Renderer2D::begin was not called!");
+		NA_ASSERT(m_Pipeline, "Failed to draw quad: No pipeline was set!");
+
+		if (m_ChunkQuads == m_Info.batch_quads || !m_Chunk)
+		{
+			// a partly drawn chunk is abandoned, so flush before moving on
+			this->_flush();
+
+			m_Chunk = m_Exhausted ? TransientAllocation{} : m_Vertices.allocate((u64)m_Info.batch_quads * 4 * sizeof(QuadVertex));
+			m_ChunkQuads = 0;
+			m_BatchStart = 0;
+
+			if (!m_Chunk)
+			{
+				if (!m_Exhausted)
+					g_Logger.fmt(Warn, "Renderer2D: More than {} quads were drawn in a frame, dropping the rest!", m_Info.max_quads);
+				m_Exhausted = true;
+				return nullptr;
+			}
+		}
+
+		m_QuadCount++;
+		return (QuadVertex*)m_Chunk.mapped + (u64)m_ChunkQuads++ * 4;
+	}
+
+	void Renderer2D::_flush(void)
+	{
+		if (!m_Chunk || m_BatchStart == m_ChunkQuads)
+			return;
+
+		if (!m_PipelineBound)
+		{
+			if (m_DescriptorSet)
+			{
+				const u32* dynamic_offsets = m_Pipeline->dynamic_offsets().ptr() + m_Renderer->current_frame_index() * m_Pipeline->dynamic_offset_count();
+				m_Renderer->bind_pipeline(m_CmdBuffer, *m_Pipeline, m_DescriptorSet, dynamic_offsets, m_Pipeline->dynamic_offset_count());
+			} else
+			{
+				m_Renderer->bind_pipeline(m_CmdBuffer, *m_Pipeline);
+			}
+			m_PipelineBound = true;
+		}
+
+		m_CmdBuffer.bindVertexBuffers(0, { m_Chunk.buffer }, { (vk::DeviceSize)m_Chunk.offset });
+		m_CmdBuffer.bindIndexBuffer(m_Indices.native(), 0, m_Indices.index_type());
+
+		m_CmdBuffer.drawIndexed(
+			(m_ChunkQuads - m_BatchStart) * 6,
+			1, // instance count
+			0, // first index
+			(i32)(m_BatchStart * 4), // vertex offset
+			0 // first instance
+		);
+
+		m_BatchStart = m_ChunkQuads;
+		m_DrawCalls++;
+	}
+} // namespace Na
\ No newline at end of file
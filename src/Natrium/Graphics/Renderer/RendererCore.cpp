@@ -5,6 +5,7 @@
 
 #include "Natrium/Graphics/VkContext.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
 
 #if defined(NA_PLATFORM_WINDOWS) || defined(NA_PLATFORM_LINUX)
 
@@ -16,7 +17,7 @@
 namespace Na {
 	extern vk::SurfaceKHR createWindowSurface(GLFWwindow* window);
 
-	static vk::SurfaceFormatKHR pickSurfaceFormat(const Na::ArrayVector<vk::SurfaceFormatKHR>& formats)
+	static vk::SurfaceFormatKHR pickSurfaceFormat(const Na::ArrayVector<vk::SurfaceFormatKHR, 16>& formats)
 	{
 		for (auto it = formats.begin(); it != formats.end(); it++)
 			if (it->format == vk::Format::eR8G8B8A8Uint
@@ -25,14 +26,44 @@ namespace Na {
 		return formats[0];
 	}
 
-	static vk::PresentModeKHR pickPresentMode(const Na::ArrayVector<vk::PresentModeKHR>& present_modes)
+	static vk::PresentModeKHR pickPresentMode(const Na::ArrayVector<vk::PresentModeKHR, 8>& present_modes, PresentMode requested)
 	{
-		for (auto it = present_modes.begin(); it != present_modes.end(); it++)
-			if (*it == vk::PresentModeKHR::eMailbox)
-				return *it;
+		static constexpr vk::PresentModeKHR x_Modes[] = {
+			vk::PresentModeKHR::eImmediate,
+			vk::PresentModeKHR::eMailbox,
+			vk::PresentModeKHR::eFifo,
+			vk::PresentModeKHR::eFifoRelaxed
+		};
+
+		auto supported = [&present_modes](vk::PresentModeKHR mode) -> bool {
+			for (auto it = present_modes.begin(); it != present_modes.end(); it++)
+				if (*it == mode)
+					return true;
+			return false;
+		};
+
+		vk::PresentModeKHR mode = x_Modes[(u8)requested];
+		if (supported(mode))
+			return mode;
+
+		g_Logger.fmt(Warn, "Present mode {} is not supported, falling back!", vk::to_string(mode));
+
+		if (supported(vk::PresentModeKHR::eMailbox))
+			return vk::PresentModeKHR::eMailbox;
 		return vk::PresentModeKHR::eFifo;
 	}
 
+	static u32 pickImageCount(const vk::SurfaceCapabilitiesKHR& capabilities, u32 requested)
+	{
+		u32 count = requested ? requested : capabilities.minImageCount + 1;
+		count = std::max(count, capabilities.minImageCount);
+
+		if (capabilities.maxImageCount > 0) // 0 means no limit
+			count = std::min(count, capabilities.maxImageCount);
+
+		return count;
+	}
+
 	static vk::Extent2D pickResolution(const vk::SurfaceCapabilitiesKHR& capabilities, u32 window_width, u32 window_height)
 	{
 		if (capabilities.currentExtent.width != UINT32_MAX)
@@ -44,11 +75,41 @@ namespace Na {
 		};
 	}
 
+	// upscaling blits into the swapchain images, which the surface or its format may not allow
+	static bool supportsSwapchainBlit(vk::SurfaceKHR surface)
+	{
+		SurfaceSupport support = SurfaceSupport::Get(surface, VkContext::GetPhysicalDevice());
+		if (!support || !(support.capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst))
+			return false;
+
+		vk::FormatProperties properties = VkContext::GetFormatProperties(pickSurfaceFormat(support.formats).format);
+		return (bool)(properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eBlitDst);
+	}
+
 	RendererCore::RendererCore(Window& window, const RendererSettings& settings)
 	: m_Window(&window),
 	m_Settings(settings)
 	{
+		m_DynamicRendering = m_Settings.dynamic_rendering && VkContext::GetDeviceFeatures().dynamic_rendering;
+		if (m_Settings.dynamic_rendering && !m_DynamicRendering)
+			g_Logger(Warn, "Dynamic rendering is not supported, falling back to render passes!");
+
 		_create_window_surface();
+
+		// settings() reports whether it is actually used
+		if (m_Settings.upscaling && !supportsSwapchainBlit(m_Surface))
+		{
+			g_Logger(Warn, "Swapchain images can not be blitted to, upscaling is disabled!");
+			m_Settings.upscaling = false;
+		}
+
+		// the core's pass only draws on top of the upscaled image, it has nothing to resolve
+		if (m_Settings.upscaling)
+			m_Settings.msaa_enabled = false;
+
+		// settings() reports the count actually used
+		m_Settings.msaa_samples = m_Settings.msaa_enabled ? (u32)VkContext::PickMSAASamples(m_Settings.msaa_samples) : 1;
+
 		_create_swapchain();
 		_create_image_views();
 		_create_color_buffer();
@@ -57,13 +118,53 @@ namespace Na {
 		_create_framebuffers();
 	}
 
+	RendererCore::RendererCore(const vk::Extent2D& extent, const RendererSettings& settings)
+	: m_QueueIndices(VkContext::GetQueueFamilyIndices()),
+	m_Headless(true),
+	m_Settings(settings)
+	{
+		m_DynamicRendering = m_Settings.dynamic_rendering && VkContext::GetDeviceFeatures().dynamic_rendering;
+		if (m_Settings.dynamic_rendering && !m_DynamicRendering)
+			g_Logger(Warn, "Dynamic rendering is not supported, falling back to render passes!");
+
+		// the core's pass only draws on top of the upscaled image, it has nothing to resolve
+		if (m_Settings.upscaling)
+			m_Settings.msaa_enabled = false;
+
+		// settings() reports the count actually used
+		m_Settings.msaa_samples = m_Settings.msaa_enabled ? (u32)VkContext::PickMSAASamples(m_Settings.msaa_samples) : 1;
+
+		m_Extent = extent;
+		m_SwapchainFormat = vk::SurfaceFormatKHR(k_HeadlessFormat, vk::ColorSpaceKHR::eSrgbNonlinear);
+
+		m_Viewport.x = 0.0f;
+		m_Viewport.y = (float)m_Height;
+		m_Viewport.width = (float)m_Width;
+		m_Viewport.height = -(float)m_Height;
+		m_Viewport.minDepth = 0.0f;
+		m_Viewport.maxDepth = 1.0f;
+
+		m_Scissor.offset.x = 0;
+		m_Scissor.offset.y = 0;
+		m_Scissor.extent = m_Extent;
+
+		_create_headless_images();
+		_create_image_views();
+		_create_color_buffer();
+		_create_depth_buffer();
+		_create_render_pass();
+		_create_framebuffers();
+	}
+
 	void RendererCore::destroy(void)
 	{
-		if (!m_Window)
+		if (!m_Window && !m_Headless)
 			return;
 
 		vk::Device logical_device = VkContext::GetLogicalDevice();
 
+		this->_destroy_retired(k_U64Max);
+
 		for (vk::Framebuffer framebuffer : m_Framebuffers)
 			logical_device.destroyFramebuffer(framebuffer);
 
@@ -78,6 +179,13 @@ namespace Na {
 		for (auto& img_view : m_ImageViews)
 			logical_device.destroyImageView(img_view);
 
+		if (m_Headless)
+		{
+			m_HeadlessImages.clear();
+			m_Headless = false;
+			return;
+		}
+
 		logical_device.destroySwapchainKHR(m_Swapchain);
 
 		VkContext::GetInstance().destroySurfaceKHR(m_Surface);
@@ -85,6 +193,22 @@ namespace Na {
 		m_Window = nullptr;
 	}
 
+	void RendererCore::read_back(u32 image_index, void* dst) const
+	{
+		NA_ASSERT(m_Headless, "Failed to read back image #{}: Renderer core is not headless!", image_index);
+
+		vk::DeviceSize size = (vk::DeviceSize)m_Width * m_Height * 4;
+
+		DeviceBuffer staging(
+			size,
+			vk::BufferUsageFlagBits::eTransferDst,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+
+		m_HeadlessImages[image_index].copy_to_buffer(staging.buffer, vk::ImageLayout::eTransferSrcOptimal);
+		memcpy(dst, staging.mapped(), size);
+	}
+
 	void RendererCore::_create_window_surface(void)
 	{
 		m_Surface = createWindowSurface(m_Window->native());
@@ -92,8 +216,7 @@ namespace Na {
 		if (!m_QueueIndices)
 			throw std::runtime_error("Queue indices is incomplete!");
 
-		m_Width = m_Window->width();
-		m_Height = m_Window->height();
+		m_Size = m_Window->size();
 
 		m_Viewport.x = 0.0f;
 		m_Viewport.y = (float)m_Height;
@@ -128,19 +251,19 @@ namespace Na {
 
 		create_info.imageArrayLayers = 1;
 		create_info.imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+		if (m_Settings.upscaling)
+			create_info.imageUsage |= vk::ImageUsageFlagBits::eTransferDst; // checked by supportsSwapchainBlit
 
-		if (support.capabilities.maxImageCount > 0
-		&& support.capabilities.minImageCount + 1 > support.capabilities.maxImageCount)
-			create_info.minImageCount = support.capabilities.maxImageCount;
-		else
-			create_info.minImageCount = support.capabilities.minImageCount + 1;
+		create_info.minImageCount = pickImageCount(support.capabilities, m_Settings.swapchain_image_count);
 
 		create_info.imageSharingMode = vk::SharingMode::eExclusive;
 
 		create_info.preTransform = support.capabilities.currentTransform;
 		create_info.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
-		create_info.presentMode = pickPresentMode(support.present_modes);
+		m_PresentMode = pickPresentMode(support.present_modes, m_Settings.present_mode);
+		create_info.presentMode = m_PresentMode;
 		create_info.clipped = true;
+		create_info.oldSwapchain = m_Swapchain; // null unless recreating, lets the driver hand over images
 
 		m_Swapchain = logical_device.createSwapchainKHR(create_info);
 		
@@ -150,6 +273,29 @@ namespace Na {
 		(void)logical_device.getSwapchainImagesKHR(m_Swapchain, &img_count, m_Images.ptr());
 	}
 
+	void RendererCore::_create_headless_images(void)
+	{
+		u32 count = m_Settings.swapchain_image_count ? m_Settings.swapchain_image_count : m_Settings.max_frames_in_flight;
+
+		m_HeadlessImages.reserve(count);
+		m_Images.resize(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			m_HeadlessImages.emplace_back(
+				vk::Extent3D(m_Width, m_Height, 1),
+				1, // layer count
+				vk::ImageAspectFlagBits::eColor,
+				k_HeadlessFormat,
+				vk::ImageTiling::eOptimal,
+				vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+				vk::SharingMode::eExclusive,
+				vk::SampleCountFlagBits::e1,
+				vk::MemoryPropertyFlagBits::eDeviceLocal
+			);
+			m_Images[i] = m_HeadlessImages[i].img;
+		}
+	}
+
 	void RendererCore::_create_image_views(void)
 	{
 		m_ImageViews.resize(m_Images.size());
@@ -172,7 +318,7 @@ namespace Na {
 			vk::ImageTiling::eOptimal,
 			vk::ImageUsageFlagBits::eTransientAttachment | vk::ImageUsageFlagBits::eColorAttachment,
 			vk::SharingMode::eExclusive,
-			VkContext::GetMSAASamples(m_Settings.msaa_enabled),
+			this->samples(),
 			vk::MemoryPropertyFlagBits::eDeviceLocal
 		);
 		m_ColorImageView = CreateImageView(
@@ -190,6 +336,7 @@ namespace Na {
 			vk::ImageTiling::eOptimal,
 			vk::FormatFeatureFlagBits::eDepthStencilAttachment
 		);
+		m_DepthFormat = depth_format;
 
 		m_DepthImage = DeviceImage(
 			{ m_Width, m_Height, 1 },
@@ -199,7 +346,7 @@ namespace Na {
 			vk::ImageTiling::eOptimal,
 			vk::ImageUsageFlagBits::eDepthStencilAttachment,
 			vk::SharingMode::eExclusive,
-			VkContext::GetMSAASamples(m_Settings.msaa_enabled),
+			this->samples(),
 			vk::MemoryPropertyFlagBits::eDeviceLocal
 		);
 		m_DepthImageView = CreateImageView(
@@ -212,6 +359,9 @@ namespace Na {
 
 	void RendererCore::_create_render_pass(void)
 	{
+		if (m_DynamicRendering)
+			return;
+
 		std::array<vk::AttachmentDescription, 3> attachments{};
 		attachments.fill({});
 
@@ -225,6 +375,10 @@ namespace Na {
 		vk::AttachmentDescription& depth_attachment = attachments[1];
 		vk::AttachmentDescription& color_attachment_resolve = attachments[2];
 
+		// without msaa the swapchain image is rendered to directly, otherwise it is the resolve target
+		bool resolve = this->samples() != vk::SampleCountFlagBits::e1;
+		vk::ImageLayout present_layout = m_Headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+
 		vk::AttachmentReference color_attachment_ref;
 		vk::AttachmentReference depth_attachment_ref;
 		vk::AttachmentReference color_attachment_resolve_ref;
@@ -233,19 +387,19 @@ namespace Na {
 		vk::SubpassDependency dependency;
 
 		color_attachment.format         = m_SwapchainFormat.format;
-		color_attachment.samples        = VkContext::GetMSAASamples(m_Settings.msaa_enabled);
-		color_attachment.loadOp         = vk::AttachmentLoadOp::eClear;
+		color_attachment.samples        = this->samples();
+		color_attachment.loadOp         = m_Settings.upscaling ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
 		color_attachment.storeOp        = vk::AttachmentStoreOp::eStore;
 		color_attachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
 		color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-		color_attachment.initialLayout  = vk::ImageLayout::eUndefined;
-		color_attachment.finalLayout    = vk::ImageLayout::eColorAttachmentOptimal;
+		color_attachment.initialLayout  = m_Settings.upscaling ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::eUndefined;
+		color_attachment.finalLayout    = resolve ? vk::ImageLayout::eColorAttachmentOptimal : present_layout;
 
 		color_attachment_ref.attachment = 0;
 		color_attachment_ref.layout     = vk::ImageLayout::eColorAttachmentOptimal;
 
 		depth_attachment.format         = depth_format;
-		depth_attachment.samples        = VkContext::GetMSAASamples(m_Settings.msaa_enabled);
+		depth_attachment.samples        = this->samples();
 		depth_attachment.loadOp         = vk::AttachmentLoadOp::eClear;
 		depth_attachment.storeOp        = vk::AttachmentStoreOp::eDontCare;
 		depth_attachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
@@ -263,7 +417,7 @@ namespace Na {
 		color_attachment_resolve.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
 		color_attachment_resolve.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 		color_attachment_resolve.initialLayout  = vk::ImageLayout::eUndefined;
-		color_attachment_resolve.finalLayout    = vk::ImageLayout::ePresentSrcKHR;
+		color_attachment_resolve.finalLayout    = present_layout;
 			
 		color_attachment_resolve_ref.attachment = 2;
 		color_attachment_resolve_ref.layout = vk::ImageLayout::eColorAttachmentOptimal;;
@@ -273,7 +427,7 @@ namespace Na {
 		subpass.colorAttachmentCount    = 1;
 		subpass.pColorAttachments       = &color_attachment_ref;
 		subpass.pDepthStencilAttachment = &depth_attachment_ref;
-		subpass.pResolveAttachments     = &color_attachment_resolve_ref;
+		subpass.pResolveAttachments     = resolve ? &color_attachment_resolve_ref : nullptr;
 
 		dependency.srcSubpass           = VK_SUBPASS_EXTERNAL;
 		dependency.dstSubpass           = 0;
@@ -290,27 +444,43 @@ namespace Na {
 		dependency.dstAccessMask        = vk::AccessFlagBits::eColorAttachmentWrite
 			                            | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
 
+		// headless frames are read back instead of presented
+		vk::SubpassDependency read_back_dependency;
+		read_back_dependency.srcSubpass    = 0;
+		read_back_dependency.dstSubpass    = VK_SUBPASS_EXTERNAL;
+		read_back_dependency.srcStageMask  = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		read_back_dependency.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+		read_back_dependency.dstStageMask  = vk::PipelineStageFlagBits::eTransfer;
+		read_back_dependency.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+
+		std::array<vk::SubpassDependency, 2> dependencies = { dependency, read_back_dependency };
+
 		vk::RenderPassCreateInfo create_info;
 
-		create_info.attachmentCount = (u32)attachments.size();
+		create_info.attachmentCount = resolve ? 3 : 2;
 		create_info.pAttachments = attachments.data();
 
 		create_info.subpassCount = 1;
 		create_info.pSubpasses = &subpass;
 
-		create_info.dependencyCount = 1;
-		create_info.pDependencies = &dependency;
+		create_info.dependencyCount = m_Headless ? 2 : 1;
+		create_info.pDependencies = dependencies.data();
 
 		m_RenderPass = VkContext::GetLogicalDevice().createRenderPass(create_info);
 	}
 
 	void RendererCore::_create_framebuffers(void)
 	{
+		if (m_DynamicRendering)
+			return;
+
 		m_Framebuffers.resize(m_ImageViews.size());
 		for (u64 i = 0; i < m_ImageViews.size(); i++)
 		{
+			// matches _create_render_pass, the resolve target only exists with msaa
+			bool resolve = this->samples() != vk::SampleCountFlagBits::e1;
 			std::array<vk::ImageView, 3> attachments = {
-				m_ColorImageView,
+				resolve ? m_ColorImageView : m_ImageViews[i],
 				m_DepthImageView,
 				m_ImageViews[i],
 			};
@@ -319,7 +489,7 @@ namespace Na {
 
 			create_info.renderPass = m_RenderPass;
 
-			create_info.attachmentCount = (u32)attachments.size();
+			create_info.attachmentCount = resolve ? 3 : 2;
 			create_info.pAttachments = attachments.data();
 
 			create_info.width = m_Width;
@@ -330,12 +500,11 @@ namespace Na {
 		}
 	}
 
-	void RendererCore::_recreate_swapchain(void)
+	void RendererCore::_recreate_swapchain(u64 frame)
 	{
-		vk::Device logical_device = VkContext::GetLogicalDevice();
-
-		m_Width = m_Window->width();
-		m_Height = m_Window->height();
+		m_SwapchainDirty = false;
+		m_Size = m_Window->size();
+		m_PendingSize = m_Size;
 
 		m_Viewport.y = (float)m_Height;
 		m_Viewport.width = (float)m_Width;
@@ -343,21 +512,17 @@ namespace Na {
 		m_Scissor.extent.width = m_Width;
 		m_Scissor.extent.height = m_Height;
 
-		logical_device.waitIdle();
-
-		for (auto& framebuffer : m_Framebuffers)
-			logical_device.destroyFramebuffer(framebuffer);
-
-		m_DepthImage.destroy();
-		logical_device.destroyImageView(m_DepthImageView);
-
-		m_ColorImage.destroy();
-		logical_device.destroyImageView(m_ColorImageView);
-
-		for (auto& img_view : m_ImageViews)
-			logical_device.destroyImageView(img_view);
-
-		logical_device.destroySwapchainKHR(m_Swapchain);
+		// _create_swapchain hands m_Swapchain over as the old swapchain before replacing it
+		m_Retired.push_back(RetiredSwapchain{
+			.swapchain = m_Swapchain,
+			.image_views = std::move(m_ImageViews),
+			.framebuffers = std::move(m_Framebuffers),
+			.color_image = std::move(m_ColorImage),
+			.color_image_view = std::exchange(m_ColorImageView, nullptr),
+			.depth_image = std::move(m_DepthImage),
+			.depth_image_view = std::exchange(m_DepthImageView, nullptr),
+			.frame = frame
+		});
 
 		_create_swapchain();
 		_create_image_views();
@@ -366,6 +531,34 @@ namespace Na {
 		_create_framebuffers();
 	}
 
+	void RendererCore::_destroy_retired(u64 completed_frames)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		// retired in frame order
+		u64 count = 0;
+		for (; count < m_Retired.size() && m_Retired[count].frame <= completed_frames; count++)
+		{
+			RetiredSwapchain& retired = m_Retired[count];
+
+			for (vk::Framebuffer framebuffer : retired.framebuffers)
+				logical_device.destroyFramebuffer(framebuffer);
+
+			retired.depth_image.destroy();
+			logical_device.destroyImageView(retired.depth_image_view);
+
+			retired.color_image.destroy();
+			logical_device.destroyImageView(retired.color_image_view);
+
+			for (vk::ImageView img_view : retired.image_views)
+				logical_device.destroyImageView(img_view);
+
+			logical_device.destroySwapchainKHR(retired.swapchain);
+		}
+
+		m_Retired.erase(m_Retired.begin(), m_Retired.begin() + count);
+	}
+
 	inline void RendererCore::set_viewport(const glm::vec4& viewport)
 	{
 		m_Viewport.x = viewport.x;
@@ -391,12 +584,17 @@ namespace Na {
 
 	m_Swapchain(std::exchange(other.m_Swapchain, nullptr)),
 	m_SwapchainFormat(std::move(other.m_SwapchainFormat)),
+	m_PresentMode(other.m_PresentMode),
 
 	m_Images(std::move(other.m_Images)),
 	m_ImageViews(std::move(other.m_ImageViews)),
 
+	m_HeadlessImages(std::move(other.m_HeadlessImages)),
+	m_Headless(std::exchange(other.m_Headless, false)),
+
 	m_DepthImage(std::move(other.m_DepthImage)),
 	m_DepthImageView(std::exchange(other.m_DepthImageView, nullptr)),
+	m_DepthFormat(other.m_DepthFormat),
 
 	m_ColorImage(std::move(other.m_ColorImage)),
 	m_ColorImageView(std::exchange(other.m_ColorImageView, nullptr)),
@@ -404,8 +602,13 @@ namespace Na {
 	m_RenderPass(std::exchange(other.m_RenderPass, nullptr)),
 
 	m_Framebuffers(std::move(other.m_Framebuffers)),
+	m_DynamicRendering(other.m_DynamicRendering),
 
-	m_Settings(other.m_Settings)
+	m_Settings(other.m_Settings),
+
+	m_Retired(std::move(other.m_Retired)),
+	m_SwapchainDirty(other.m_SwapchainDirty),
+	m_PendingSize(other.m_PendingSize)
 	{}
 
 	RendererCore& RendererCore::operator=(RendererCore&& other)
@@ -425,12 +628,17 @@ namespace Na {
 
 		m_Swapchain = std::exchange(other.m_Swapchain, nullptr);
 		m_SwapchainFormat = std::move(other.m_SwapchainFormat);
+		m_PresentMode = other.m_PresentMode;
 
 		m_Images = std::move(other.m_Images);
 		m_ImageViews = std::move(other.m_ImageViews);
 
+		m_HeadlessImages = std::move(other.m_HeadlessImages);
+		m_Headless = std::exchange(other.m_Headless, false);
+
 		m_DepthImage = std::move(other.m_DepthImage);
 		m_DepthImageView = std::exchange(other.m_DepthImageView, nullptr);
+		m_DepthFormat = other.m_DepthFormat;
 
 		m_ColorImage = std::move(other.m_ColorImage);
 		m_ColorImageView = std::exchange(other.m_ColorImageView, nullptr);
@@ -438,9 +646,14 @@ namespace Na {
 		m_RenderPass = std::exchange(other.m_RenderPass, nullptr);
 
 		m_Framebuffers = std::move(other.m_Framebuffers);
+		m_DynamicRendering = other.m_DynamicRendering;
 
 		m_Settings = std::move(other.m_Settings);
 
+		m_Retired = std::move(other.m_Retired);
+		m_SwapchainDirty = other.m_SwapchainDirty;
+		m_PendingSize = other.m_PendingSize;
+
 		return *this;
 	}
 } // namespace Na
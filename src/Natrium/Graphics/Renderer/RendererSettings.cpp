@@ -9,8 +9,24 @@ namespace Na {
 		return RendererSettings{
 			.max_frames_in_flight = 2,
 			.anisotropy_enabled = true,
-			.max_anisotropy = VkContext::GetPhysicalDevice().getProperties().limits.maxSamplerAnisotropy,
-			.msaa_enabled = true
+			.max_anisotropy = VkContext::GetPhysicalDeviceLimits().maxSamplerAnisotropy,
+			.msaa_enabled = true,
+			.msaa_samples = 4,
+			.mipmaps = true,
+			.mip_lod_bias = 0.0f,
+			.min_lod = 0.0f,
+			.max_lod = VK_LOD_CLAMP_NONE,
+			.recording_threads = 0,
+			.async_compute = false,
+			.present_mode = PresentMode::Mailbox,
+			.swapchain_image_count = 0,
+			.max_frame_latency = 0,
+			.frame_timeout = k_U64Max,
+			.dynamic_rendering = false,
+			.upscaling = false,
+			.gpu_profiler_scopes = 0,
+			.pipeline_statistics = false,
+			.instance_buffer_size = 4 * 1024 * 1024
 		};
 	}
 } // namespace Na
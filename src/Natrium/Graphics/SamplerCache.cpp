@@ -0,0 +1,81 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/SamplerCache.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	SamplerInfo SamplerInfo::FromSettings(const RendererSettings& settings)
+	{
+		SamplerInfo info;
+		info.anisotropy_enabled = settings.anisotropy_enabled;
+		info.max_anisotropy = settings.max_anisotropy;
+		info.mip_lod_bias = settings.mip_lod_bias;
+		info.min_lod = settings.min_lod;
+		info.max_lod = settings.max_lod;
+		return info;
+	}
+
+	void SamplerCache::destroy(void)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		if (m_Samplers.empty())
+			return;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		for (auto& [info, sampler] : m_Samplers)
+			logical_device.destroySampler(sampler);
+
+		m_Samplers.clear();
+	}
+
+	vk::Sampler SamplerCache::get(const SamplerInfo& info)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		auto [it, inserted] = m_Samplers.try_emplace(info);
+		if (!inserted)
+			return it->second;
+
+		u32 max_samplers = VkContext::GetPhysicalDeviceLimits().maxSamplerAllocationCount;
+		if (m_Samplers.size() > max_samplers)
+		{
+			m_Samplers.erase(it);
+			throw std::runtime_error(NA_FORMAT("Failed to create sampler: All {} samplers of the device are in use!", max_samplers));
+		}
+
+		vk::SamplerCreateInfo create_info;
+
+		create_info.magFilter = info.mag_filter;
+		create_info.minFilter = info.min_filter;
+		create_info.mipmapMode = info.mipmap_mode;
+
+		create_info.addressModeU = info.address_u;
+		create_info.addressModeV = info.address_v;
+		create_info.addressModeW = info.address_w;
+		create_info.borderColor = info.border_color;
+
+		create_info.anisotropyEnable = info.anisotropy_enabled;
+		create_info.maxAnisotropy = info.max_anisotropy;
+
+		create_info.unnormalizedCoordinates = VK_FALSE;
+
+		create_info.compareEnable = info.compare_enabled;
+		create_info.compareOp = info.compare_op;
+
+		create_info.mipLodBias = info.mip_lod_bias;
+		create_info.minLod = info.min_lod;
+		create_info.maxLod = info.max_lod;
+
+		try
+		{
+			it->second = VkContext::GetLogicalDevice().createSampler(create_info);
+		} catch (...)
+		{
+			m_Samplers.erase(it);
+			throw;
+		}
+
+		return it->second;
+	}
+} // namespace Na
\ No newline at end of file
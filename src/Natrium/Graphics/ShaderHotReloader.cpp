@@ -0,0 +1,170 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/ShaderHotReloader.hpp"
+
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	ShaderHotReloader::ShaderHotReloader(AssetRegistry& registry)
+	: m_Registry(registry)
+	{
+		m_Watcher.watch(registry.asset_dir());
+		for (const std::filesystem::path& include_dir : registry.shader_include_dirs())
+			m_Watcher.watch(include_dir);
+	}
+
+	ShaderHotReloader::~ShaderHotReloader(void)
+	{
+		JobSystem& job_system = JobSystem::Get();
+
+		// the jobs write into the rebuilds, their exceptions do not matter anymore
+		auto wait = [&job_system](Rebuild& rebuild)
+		{
+			try
+			{
+				job_system.wait(rebuild.counter);
+			} catch (...)
+			{}
+		};
+
+		for (auto& [id, entry] : m_Entries)
+			if (entry.rebuild)
+				wait(*entry.rebuild);
+		for (std::unique_ptr<Rebuild>& rebuild : m_Orphans)
+			wait(*rebuild);
+	}
+
+	u64 ShaderHotReloader::watch(GraphicsPipeline& pipeline, std::vector<HotReloadShader> shaders, HotReloadBuilder builder)
+	{
+		u64 id = m_NextID++;
+
+		Entry& entry = m_Entries[id];
+		entry.pipeline = &pipeline;
+		entry.dependencies = this->_dependencies(shaders);
+		entry.shaders = std::move(shaders);
+		entry.builder = std::move(builder);
+
+		return id;
+	}
+
+	void ShaderHotReloader::unwatch(u64 id)
+	{
+		auto it = m_Entries.find(id);
+		if (it == m_Entries.end())
+			return;
+
+		if (it->second.rebuild)
+			m_Orphans.push_back(std::move(it->second.rebuild));
+
+		m_Entries.erase(it);
+	}
+
+	u32 ShaderHotReloader::update(void)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		for (std::filesystem::path& path : m_Watcher.poll())
+			m_Changes[std::move(path)] = now;
+
+		for (auto it = m_Changes.begin(); it != m_Changes.end();)
+		{
+			if (now - it->second < k_SettleTime)
+			{
+				it++;
+				continue;
+			}
+
+			for (auto& [id, entry] : m_Entries)
+				if (std::binary_search(entry.dependencies.begin(), entry.dependencies.end(), it->first))
+					entry.dirty = true;
+
+			it = m_Changes.erase(it);
+		}
+
+		std::erase_if(m_Orphans, [](const std::unique_ptr<Rebuild>& rebuild) { return rebuild->counter.done(); });
+
+		u32 swapped = 0;
+		for (auto& [id, entry] : m_Entries)
+		{
+			if (entry.rebuild && entry.rebuild->counter.done())
+				swapped += this->_finish(entry);
+
+			if (entry.dirty && !entry.rebuild)
+				this->_start(entry);
+		}
+
+		return swapped;
+	}
+
+	void ShaderHotReloader::reload_all(void)
+	{
+		for (auto& [id, entry] : m_Entries)
+			entry.dirty = true;
+	}
+
+	u64 ShaderHotReloader::pending(void) const
+	{
+		u64 pending = 0;
+		for (const auto& [id, entry] : m_Entries)
+			pending += entry.dirty || entry.rebuild;
+
+		return pending;
+	}
+
+	std::vector<std::filesystem::path> ShaderHotReloader::_dependencies(const std::vector<HotReloadShader>& shaders) const
+	{
+		std::vector<std::filesystem::path> dependencies;
+		for (const HotReloadShader& shader : shaders)
+		{
+			std::vector<std::filesystem::path> shader_dependencies = m_Registry.shader_dependencies(shader.src_path, shader.entry_point, shader.permutation);
+			dependencies.insert(dependencies.end(), shader_dependencies.begin(), shader_dependencies.end());
+		}
+
+		std::sort(dependencies.begin(), dependencies.end());
+		dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+		return dependencies;
+	}
+
+	void ShaderHotReloader::_start(Entry& entry)
+	{
+		entry.dirty = false;
+		entry.rebuild = std::make_unique<Rebuild>();
+
+		// everything is copied, the entry may be unwatched while the job runs
+		JobSystem::Get().run(
+			[this, rebuild = entry.rebuild.get(), shaders = entry.shaders, builder = entry.builder](void)
+			{
+				std::vector<ShaderModule> shader_modules;
+				shader_modules.reserve(shaders.size());
+				for (const HotReloadShader& shader : shaders)
+					shader_modules.push_back(m_Registry.create_shader_module_from_src(shader.src_path, shader.stage, shader.entry_point, shader.permutation));
+
+				rebuild->pipeline = builder(shader_modules);
+
+				// includes may have been added or removed by the edit
+				rebuild->dependencies = this->_dependencies(shaders);
+			},
+			&entry.rebuild->counter
+		);
+	}
+
+	bool ShaderHotReloader::_finish(Entry& entry)
+	{
+		std::unique_ptr<Rebuild> rebuild = std::move(entry.rebuild);
+
+		try
+		{
+			JobSystem::Get().wait(rebuild->counter);
+		} catch (const std::exception& e)
+		{
+			g_Logger.fmt(Error, "Failed to reload {}: {}", entry.shaders.empty() ? "pipeline" : entry.shaders.front().src_path, e.what());
+			return false;
+		}
+
+		*entry.pipeline = std::move(rebuild->pipeline);
+		entry.dependencies = std::move(rebuild->dependencies);
+
+		g_Logger.fmt(Info, "Reloaded {}", entry.shaders.empty() ? "pipeline" : entry.shaders.front().src_path);
+		return true;
+	}
+} // namespace Na
\ No newline at end of file
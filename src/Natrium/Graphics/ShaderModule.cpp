@@ -4,9 +4,60 @@
 #include "Natrium/Graphics/VkContext.hpp"
 
 namespace Na {
+	// FNV-1a, never 0 for the words of a real module
+	static u64 hashWords(std::span<const u32> words)
+	{
+		u64 hash = 0xCBF29CE484222325ull;
+		for (std::byte byte : std::as_bytes(words))
+		{
+			hash ^= (u8)byte;
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	// the living modules created from a binary, see FindBinaryHash
+	static std::mutex s_BinaryHashMutex;
+	static std::unordered_map<VkShaderModule, u64> s_BinaryHashes;
+
+	const vk::SpecializationInfo* SpecializationConstants::info(void) const
+	{
+		if (m_Entries.empty())
+			return nullptr;
+
+		// refreshed on every call, the vectors may have moved since
+		m_Info = vk::SpecializationInfo((u32)m_Entries.size(), m_Entries.data(), m_Data.size(), m_Data.data());
+		return &m_Info;
+	}
+
+	SpecializationConstants& SpecializationConstants::_set(u32 constant_id, const void* value, u32 size)
+	{
+		auto it = std::find_if(m_Entries.begin(), m_Entries.end(), [constant_id](const vk::SpecializationMapEntry& entry) { return entry.constantID == constant_id; });
+		if (it != m_Entries.end())
+		{
+			NA_VERIFY(it->size == size, "Specialization constant {} was already set with another type!", constant_id);
+			memcpy(m_Data.data() + it->offset, value, size);
+			return *this;
+		}
+
+		m_Entries.emplace_back(constant_id, (u32)m_Data.size(), size);
+		m_Data.insert(m_Data.end(), (const Byte*)value, (const Byte*)value + size);
+
+		return *this;
+	}
+
+	ShaderModule::ShaderModule(
+		const ShaderBinary& binary,
+		ShaderStageBits stage,
+		const std::string_view& entry_point
+	)
+	: ShaderModule(binary, stage, ShaderReflection(binary), entry_point)
+	{}
+
 	ShaderModule::ShaderModule(
 		const ShaderBinary& binary,
 		ShaderStageBits stage,
+		ShaderReflection reflection,
 		const std::string_view& entry_point
 	)
 	: m_Module(VkContext::GetLogicalDevice()
@@ -16,26 +67,56 @@ namespace Na {
 				   binary.ptr()
 			   ))),
 	m_Stage(stage),
-	m_EntryPoint(entry_point)
-	{}
+	m_EntryPoint(entry_point),
+	m_Reflection(std::move(reflection)),
+	m_BinaryHash(hashWords(binary.data()))
+	{
+		std::lock_guard lock(s_BinaryHashMutex);
+		s_BinaryHashes[(VkShaderModule)m_Module] = m_BinaryHash;
+	}
 
 	ShaderModule::~ShaderModule(void)
 	{
-		VkContext::GetLogicalDevice().destroyShaderModule(m_Module);
+		this->_destroy();
+	}
+
+	u64 ShaderModule::FindBinaryHash(vk::ShaderModule module)
+	{
+		std::lock_guard lock(s_BinaryHashMutex);
+
+		auto it = s_BinaryHashes.find((VkShaderModule)module);
+		return it != s_BinaryHashes.end() ? it->second : 0;
+	}
+
+	void ShaderModule::_destroy(void)
+	{
+		// before the handle can be handed out again
+		if (m_BinaryHash)
+		{
+			std::lock_guard lock(s_BinaryHashMutex);
+			s_BinaryHashes.erase((VkShaderModule)m_Module);
+		}
+
+		VkContext::GetLogicalDevice().destroyShaderModule(std::exchange(m_Module, nullptr));
+		m_BinaryHash = 0;
 	}
 
 	ShaderModule::ShaderModule(ShaderModule&& other)
 	: m_Module(std::exchange(other.m_Module, nullptr)),
 	m_Stage(std::move(other.m_Stage)),
-	m_EntryPoint(std::move(other.m_EntryPoint))
+	m_EntryPoint(std::move(other.m_EntryPoint)),
+	m_Reflection(std::move(other.m_Reflection)),
+	m_BinaryHash(std::exchange(other.m_BinaryHash, 0))
 	{}
 
 	ShaderModule& ShaderModule::operator=(ShaderModule&& other)
 	{
-		VkContext::GetLogicalDevice().destroyShaderModule(m_Module);
+		this->_destroy();
 		m_Module = std::exchange(other.m_Module, nullptr);
 		m_Stage = std::move(other.m_Stage);
 		m_EntryPoint = std::move(other.m_EntryPoint);
+		m_Reflection = std::move(other.m_Reflection);
+		m_BinaryHash = std::exchange(other.m_BinaryHash, 0);
 		return *this;
 	}
 } // namespace Na
@@ -0,0 +1,387 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/ShaderReflection.hpp"
+
+namespace Na {
+	// the subset of the SPIR-V specification the reflection reads
+	namespace Spv {
+		constexpr u32 k_Magic = 0x07230203;
+		constexpr u64 k_HeaderWords = 5;
+
+		enum Op : u16 {
+			OpEntryPoint       = 15,
+			OpTypeBool         = 20,
+			OpTypeInt          = 21,
+			OpTypeFloat        = 22,
+			OpTypeVector       = 23,
+			OpTypeMatrix       = 24,
+			OpTypeImage        = 25,
+			OpTypeSampler      = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray        = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct       = 30,
+			OpTypePointer      = 32,
+			OpConstant         = 43,
+			OpSpecConstant     = 50,
+			OpVariable         = 59,
+			OpDecorate         = 71,
+			OpMemberDecorate   = 72
+		};
+
+		enum Decoration : u32 {
+			Block         = 2,
+			BufferBlock   = 3,
+			ArrayStride   = 6,
+			MatrixStride  = 7,
+			BuiltIn       = 11,
+			Location      = 30,
+			Binding       = 33,
+			DescriptorSet = 34,
+			Offset        = 35
+		};
+
+		enum StorageClass : u32 {
+			UniformConstant = 0,
+			Input           = 1,
+			Uniform         = 2,
+			PushConstant    = 9,
+			StorageBuffer   = 12
+		};
+
+		enum ExecutionModel : u32 {
+			Vertex   = 0,
+			Fragment = 4,
+			GLCompute = 5
+		};
+	} // namespace Spv
+
+	namespace {
+		struct SpvMember {
+			u32 offset = 0;
+			u32 matrix_stride = 0;
+		};
+
+		struct SpvId {
+			u16 op = 0;
+			std::vector<u32> operands; // without the result id
+
+			// decorations
+			u32 set = k_U32Max, binding = k_U32Max, location = k_U32Max;
+			u32 array_stride = 0;
+			bool block = false, buffer_block = false, built_in = false;
+			std::vector<SpvMember> members;
+		};
+
+		class SpvModule {
+		public:
+			SpvModule(const u32* spv, u64 word_count)
+			{
+				NA_VERIFY(word_count >= Spv::k_HeaderWords && spv[0] == Spv::k_Magic, "Failed to reflect shader: Not a SPIR-V module!");
+
+				m_Ids.resize(spv[3]); // id bound
+
+				for (u64 i = Spv::k_HeaderWords; i < word_count;)
+				{
+					u16 op = u16(spv[i] & 0xFFFF);
+					u16 count = u16(spv[i] >> 16);
+					NA_VERIFY(count && i + count <= word_count, "Failed to reflect shader: Truncated instruction at word {}!", i);
+
+					this->_parse(op, spv + i + 1, count - 1u);
+					i += count;
+				}
+			}
+
+			[[nodiscard]] inline const SpvId& operator[](u32 id) const { return m_Ids[id]; }
+			[[nodiscard]] inline const std::vector<SpvId>& ids(void) const { return m_Ids; }
+			[[nodiscard]] inline u32 execution_model(void) const { return m_ExecutionModel; }
+
+			// follows arrays down to their element type, a length only known once specialized counts as runtime sized (0)
+			[[nodiscard]] u32 element_type(u32 type, u32& array_length) const
+			{
+				array_length = 1;
+				while (m_Ids[type].op == Spv::OpTypeArray || m_Ids[type].op == Spv::OpTypeRuntimeArray)
+				{
+					if (m_Ids[type].op == Spv::OpTypeRuntimeArray || m_Ids[m_Ids[type].operands[1]].op != Spv::OpConstant)
+						array_length = 0;
+					else
+						array_length *= m_Ids[m_Ids[type].operands[1]].operands[1]; // OpConstant value
+					type = m_Ids[type].operands[0];
+				}
+				return type;
+			}
+
+			// a specialization constant counts with its default value
+			[[nodiscard]] u32 array_length(u32 array_type) const
+			{
+				u32 length = m_Ids[array_type].operands[1];
+				NA_VERIFY(
+					m_Ids[length].op == Spv::OpConstant || m_Ids[length].op == Spv::OpSpecConstant,
+					"Failed to reflect shader: The length of array type {} is not a constant!",
+						array_type
+				);
+				return m_Ids[length].operands[1];
+			}
+
+			[[nodiscard]] u32 size_of(u32 type, u32 matrix_stride = 0) const
+			{
+				const SpvId& id = m_Ids[type];
+				switch (id.op)
+				{
+				case Spv::OpTypeBool:
+					return 4;
+				case Spv::OpTypeInt:
+				case Spv::OpTypeFloat:
+					return id.operands[0] / 8;
+				case Spv::OpTypeVector:
+					return this->size_of(id.operands[0]) * id.operands[1];
+				case Spv::OpTypeMatrix:
+					return (matrix_stride ? matrix_stride : this->size_of(id.operands[0])) * id.operands[1];
+				case Spv::OpTypeArray:
+				{
+					u32 length = this->array_length(type);
+					return (id.array_stride ? id.array_stride : this->size_of(id.operands[0], matrix_stride)) * length;
+				}
+				case Spv::OpTypeRuntimeArray:
+					return 0;
+				case Spv::OpTypeStruct:
+				{
+					u32 size = 0;
+					for (u64 i = 0; i < id.operands.size(); i++)
+					{
+						SpvMember member = i < id.members.size() ? id.members[i] : SpvMember{};
+						size = std::max(size, member.offset + this->size_of(id.operands[i], member.matrix_stride));
+					}
+					return size;
+				}
+				default:
+					throw std::runtime_error(NA_FORMAT("Failed to reflect shader: Can not size type with opcode {}!", id.op));
+				}
+			}
+		private:
+			void _parse(u16 op, const u32* operands, u32 count)
+			{
+				switch (op)
+				{
+				case Spv::OpEntryPoint:
+					if (m_ExecutionModel == k_U32Max)
+						m_ExecutionModel = operands[0];
+					break;
+				case Spv::OpTypeBool:
+				case Spv::OpTypeInt:
+				case Spv::OpTypeFloat:
+				case Spv::OpTypeVector:
+				case Spv::OpTypeMatrix:
+				case Spv::OpTypeImage:
+				case Spv::OpTypeSampler:
+				case Spv::OpTypeSampledImage:
+				case Spv::OpTypeArray:
+				case Spv::OpTypeRuntimeArray:
+				case Spv::OpTypeStruct:
+				case Spv::OpTypePointer:
+				{
+					SpvId& id = m_Ids[operands[0]];
+					id.op = op;
+					id.operands.assign(operands + 1, operands + count);
+					break;
+				}
+				case Spv::OpConstant:
+				case Spv::OpSpecConstant:
+				case Spv::OpVariable:
+				{
+					// result type, result id, value (the default one if specialized) / storage class
+					SpvId& id = m_Ids[operands[1]];
+					id.op = op;
+					id.operands = { operands[0], operands[2] };
+					break;
+				}
+				case Spv::OpDecorate:
+				{
+					SpvId& id = m_Ids[operands[0]];
+					switch (operands[1])
+					{
+					case Spv::Block:         id.block = true; break;
+					case Spv::BufferBlock:   id.buffer_block = true; break;
+					case Spv::BuiltIn:       id.built_in = true; break;
+					case Spv::ArrayStride:   id.array_stride = operands[2]; break;
+					case Spv::Location:      id.location = operands[2]; break;
+					case Spv::Binding:       id.binding = operands[2]; break;
+					case Spv::DescriptorSet: id.set = operands[2]; break;
+					}
+					break;
+				}
+				case Spv::OpMemberDecorate:
+				{
+					SpvId& id = m_Ids[operands[0]];
+					if (id.members.size() <= operands[1])
+						id.members.resize(operands[1] + 1ull);
+
+					if (operands[2] == Spv::Offset)
+						id.members[operands[1]].offset = operands[3];
+					else if (operands[2] == Spv::MatrixStride)
+						id.members[operands[1]].matrix_stride = operands[3];
+					break;
+				}
+				}
+			}
+		private:
+			std::vector<SpvId> m_Ids;
+			u32 m_ExecutionModel = k_U32Max;
+		};
+	} // namespace
+
+	static ShaderStageBits stageOf(u32 execution_model)
+	{
+		switch (execution_model)
+		{
+		case Spv::Vertex:    return ShaderStageBits::Vertex;
+		case Spv::Fragment:  return ShaderStageBits::Fragment;
+		case Spv::GLCompute: return ShaderStageBits::Compute;
+		}
+		throw std::runtime_error(NA_FORMAT("Failed to reflect shader: Unsupported execution model {}!", execution_model));
+	}
+
+	static ShaderAttributeType attributeTypeOf(const SpvModule& spv_module, u32 type)
+	{
+		u32 components = 1;
+		if (spv_module[type].op == Spv::OpTypeVector)
+		{
+			components = spv_module[type].operands[1];
+			type = spv_module[type].operands[0];
+		}
+		NA_VERIFY(
+			spv_module[type].op == Spv::OpTypeFloat && spv_module[type].operands[0] == 32,
+			"Failed to reflect shader: Vertex inputs have to be 32 bit floats or float vectors!"
+		);
+
+		switch (components)
+		{
+		case 1: return ShaderAttributeType::Float;
+		case 2: return ShaderAttributeType::Vec2;
+		case 3: return ShaderAttributeType::Vec3;
+		case 4: return ShaderAttributeType::Vec4;
+		}
+		return ShaderAttributeType::None;
+	}
+
+	ShaderReflection::ShaderReflection(const u32* spv, u64 word_count)
+	{
+		SpvModule spv_module(spv, word_count);
+		m_Stage = stageOf(spv_module.execution_model());
+
+		for (u32 i = 0; i < (u32)spv_module.ids().size(); i++)
+		{
+			const SpvId& variable = spv_module[i];
+			if (variable.op != Spv::OpVariable)
+				continue;
+
+			u32 storage_class = variable.operands[1];
+			u32 pointee = spv_module[variable.operands[0]].operands[1]; // OpTypePointer: storage class, type
+
+			switch (storage_class)
+			{
+			case Spv::Input:
+			{
+				if (m_Stage != ShaderStageBits::Vertex || variable.built_in || spv_module[pointee].block)
+					break;
+
+				NA_VERIFY(variable.location != k_U32Max, "Failed to reflect shader: Vertex input %{} has no location!", i);
+				m_VertexInputs.push_back(ShaderAttribute{ variable.location, attributeTypeOf(spv_module, pointee) });
+				break;
+			}
+			case Spv::PushConstant:
+			{
+				// a stage only sees the part of the range it declares members for
+				u32 offset = spv_module[pointee].members.empty() ? 0 : k_U32Max;
+				for (const SpvMember& member : spv_module[pointee].members)
+					offset = std::min(offset, member.offset);
+
+				m_PushConstant.shader_stage = m_Stage;
+				m_PushConstant.offset = offset;
+				m_PushConstant.size = spv_module.size_of(pointee) - offset;
+				break;
+			}
+			case Spv::UniformConstant:
+			case Spv::Uniform:
+			case Spv::StorageBuffer:
+			{
+				u32 array_length;
+				u32 type = spv_module.element_type(pointee, array_length);
+
+				ShaderUniformType uniform_type = ShaderUniformType::None;
+				if (storage_class == Spv::StorageBuffer || spv_module[type].buffer_block)
+					uniform_type = ShaderUniformType::StorageBuffer;
+				else if (storage_class == Spv::Uniform)
+					uniform_type = ShaderUniformType::UniformBuffer;
+				else if (spv_module[type].op == Spv::OpTypeSampledImage)
+					uniform_type = ShaderUniformType::Texture;
+
+				NA_VERIFY(uniform_type != ShaderUniformType::None, "Failed to reflect shader: Descriptor at binding {} has an unsupported type!", variable.binding);
+				NA_VERIFY(variable.set == 0, "Failed to reflect shader: Binding {} is in set {}, only set 0 is supported!", variable.binding, variable.set);
+				NA_VERIFY(array_length == 1, "Failed to reflect shader: Binding {} is an array of descriptors!", variable.binding);
+
+				m_Uniforms.push_back(ShaderUniform{ variable.binding, uniform_type, m_Stage });
+				break;
+			}
+			}
+		}
+
+		std::sort(m_VertexInputs.begin(), m_VertexInputs.end(), [](const ShaderAttribute& a, const ShaderAttribute& b) { return a.location < b.location; });
+		std::sort(m_Uniforms.begin(), m_Uniforms.end(), [](const ShaderUniform& a, const ShaderUniform& b) { return a.binding < b.binding; });
+	}
+
+	struct ReflectionCacheHeader {
+		u32 magic = 0x4E415246; // NARF
+		u32 version = ShaderReflection::k_CacheVersion;
+		ShaderStageBits stage = ShaderStageBits::None;
+		PushConstant push_constant{ ShaderStageBits::None, 0, 0 };
+		u32 vertex_input_count = 0;
+		u32 uniform_count = 0;
+	};
+
+	void ShaderReflection::save(const std::filesystem::path& path) const
+	{
+		ReflectionCacheHeader header;
+		header.stage = m_Stage;
+		header.push_constant = m_PushConstant;
+		header.vertex_input_count = (u32)m_VertexInputs.size();
+		header.uniform_count = (u32)m_Uniforms.size();
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+		{
+			g_Logger.fmt(Warn, "Failed to write shader reflection to {}!", path.string());
+			return;
+		}
+
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)m_VertexInputs.data(), m_VertexInputs.size() * sizeof(ShaderAttribute));
+		file.write((const char*)m_Uniforms.data(), m_Uniforms.size() * sizeof(ShaderUniform));
+	}
+
+	std::optional<ShaderReflection> ShaderReflection::Load(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return std::nullopt;
+
+		ReflectionCacheHeader header;
+		file.read((char*)&header, sizeof(header));
+		if (!file || header.magic != ReflectionCacheHeader{}.magic || header.version != k_CacheVersion)
+			return std::nullopt;
+
+		ShaderReflection reflection;
+		reflection.m_Stage = header.stage;
+		reflection.m_PushConstant = header.push_constant;
+
+		reflection.m_VertexInputs.resize(header.vertex_input_count);
+		file.read((char*)reflection.m_VertexInputs.data(), header.vertex_input_count * sizeof(ShaderAttribute));
+
+		reflection.m_Uniforms.resize(header.uniform_count);
+		file.read((char*)reflection.m_Uniforms.data(), header.uniform_count * sizeof(ShaderUniform));
+
+		if (!file)
+			return std::nullopt;
+
+		return reflection;
+	}
+} // namespace Na
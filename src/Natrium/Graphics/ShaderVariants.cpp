@@ -0,0 +1,101 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/ShaderVariants.hpp"
+
+#include "Natrium/Core/JobSystem.hpp"
+
+namespace Na {
+	ShaderVariants::ShaderVariants(
+		const AssetRegistry& registry,
+		const std::string_view& src_path,
+		ShaderStageBits stage,
+		const std::string_view& entry_point
+	)
+	: m_Registry(&registry),
+	m_SrcPath(src_path),
+	m_Stage(stage),
+	m_EntryPoint(entry_point)
+	{}
+
+	const ShaderModule& ShaderVariants::get(const ShaderPermutation& permutation)
+	{
+		Variant& variant = this->_variant(permutation);
+
+		// compiled outside of the lock, other variants are not held up by it,
+		// an exception leaves the flag unset so the next get retries
+		std::call_once(variant.compiled, [&](void)
+		{
+			variant.module = m_Registry->create_shader_module_from_src(m_SrcPath, m_Stage, m_EntryPoint, variant.permutation);
+		});
+
+		return variant.module;
+	}
+
+	void ShaderVariants::precompile(std::span<const ShaderPermutation> permutations, u32 thread_count)
+	{
+		if (permutations.empty())
+			return;
+
+		if (!thread_count)
+			thread_count = JobSystem::Get().worker_count() + 1;
+		thread_count = (u32)std::min<u64>(thread_count, permutations.size());
+
+		std::atomic<u64> next = 0;
+		std::exception_ptr exception = nullptr;
+		std::mutex exception_mutex;
+
+		auto work = [&](void)
+		{
+			for (u64 i = next++; i < permutations.size(); i = next++)
+			{
+				try
+				{
+					(void)this->get(permutations[i]);
+				} catch (...)
+				{
+					std::lock_guard lock(exception_mutex);
+					if (!exception)
+						exception = std::current_exception();
+				}
+			}
+		};
+
+		// the calling thread compiles as well
+		JobSystem& job_system = JobSystem::Get();
+
+		JobCounter counter;
+		for (u32 i = 1; i < thread_count; i++)
+			job_system.run(work, &counter);
+
+		work();
+
+		job_system.wait(counter);
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	void ShaderVariants::clear(void)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Variants.clear();
+	}
+
+	ShaderVariants::Variant& ShaderVariants::_variant(const ShaderPermutation& permutation)
+	{
+		u64 key = permutation.key();
+
+		std::lock_guard lock(m_Mutex);
+
+		auto [begin, end] = m_Variants.equal_range(key);
+		for (auto it = begin; it != end; ++it)
+		{
+			if (it->second->permutation == permutation)
+				return *it->second;
+		}
+
+		std::unique_ptr<Variant> variant = std::make_unique<Variant>();
+		variant->permutation = permutation;
+
+		return *m_Variants.emplace(key, std::move(variant))->second;
+	}
+} // namespace Na
\ No newline at end of file
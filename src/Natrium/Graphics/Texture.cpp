@@ -4,18 +4,20 @@
 #include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
 #include "Natrium/Graphics/VkContext.hpp"
 #include "Natrium/Graphics/Pipeline.hpp"
-#include "Internal.hpp"
+#include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/JobSystem.hpp"
 
 namespace Na {
 	Texture::Texture(
 		const AssetHandle<Image>* imgs,
 		u32 count,
-		const RendererSettings& renderer_settings
+		const RendererSettings& renderer_settings,
+		const SamplerInfo& sampler_info
 	)
 	{
 		NA_ASSERT(imgs, "Failed to create TextureArray: imgs is null!");
 		NA_ASSERT(count, "Failed to create TextureArray: count is 0!");
-		NA_ASSERT(count <= VkContext::GetPhysicalDevice().getProperties().limits.maxImageArrayLayers,
+		NA_ASSERT(count <= VkContext::GetPhysicalDeviceLimits().maxImageArrayLayers,
 				  "Failed to create TextureArray: image count exceeded gpu limit!");
 
 		const AssetHandle<Image>& first_img = imgs[0];
@@ -28,49 +30,199 @@ namespace Na {
 					throw std::runtime_error(NA_FORMAT("Failed to create TextureArray: Invalid image at index {}", i));
 
 				if (imgs[i]->size() != first_img->size())
-					throw std::runtime_error("Failed to create TextureArray: Image at index {} has a different size!");
+					throw std::runtime_error(NA_FORMAT("Failed to create TextureArray: Image at index {} has a different size!", i));
+
+				if (imgs[i]->format() != first_img->format() || imgs[i]->mip_levels() != first_img->mip_levels())
+					throw std::runtime_error(NA_FORMAT("Failed to create TextureArray: Image at index {} has a different format!", i));
 			}
 		}
 
-		vk::Device logical_device = VkContext::GetLogicalDevice();
+		vk::Extent3D extent{ (u32)first_img->width(), (u32)first_img->height(), 1 };
+		vk::Format format = first_img->format();
 
-		DeviceBuffer buffer(
-			first_img->size() * count,
-			vk::BufferUsageFlagBits::eTransferSrc,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-		);
+		// block compressed payloads go to the gpu as they are, so the device has to sample them natively
+		if (FindSupportedFormat({ format }, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eSampledImage) == vk::Format::eUndefined)
+			throw std::runtime_error(NA_FORMAT("Failed to create Texture: {} is not supported by the device!", vk::to_string(format)));
+
+		// pre-baked levels are uploaded as they are, otherwise the chain is blitted from the first level
+		u32 mip_levels = first_img->mip_levels();
+		bool generate_mips = false;
+		if (mip_levels == 1 && renderer_settings.mipmaps)
+		{
+			vk::Format blit_format = FindSupportedFormat(
+				{ format },
+				vk::ImageTiling::eOptimal,
+				vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear
+			);
 
-		void* data = logical_device.mapMemory(buffer.memory, 0, first_img->size() * count);
-		for (u32 i = 0; i < count; i++)
-			memcpy((Byte*)data + i * first_img->size(), imgs[i]->data(), imgs[i]->size());
-		logical_device.unmapMemory(buffer.memory);
+			if (blit_format != vk::Format::eUndefined)
+			{
+				mip_levels = MipLevelCount(extent);
+				generate_mips = mip_levels > 1;
+			} else
+			{
+				g_Logger(Warn, "Texture format does not support linear blits, creating it without mipmaps!");
+			}
+		}
 
 		m_Image = DeviceImage(
-			{ (u32)first_img->width(), (u32)first_img->height(), 1 }, // extent
+			extent,
 			count, // layer count
 			vk::ImageAspectFlagBits::eColor,
-			vk::Format::eR8G8B8A8Srgb,
+			format,
+			vk::ImageTiling::eOptimal,
+			(generate_mips ? vk::ImageUsageFlagBits::eTransferSrc : vk::ImageUsageFlags{}) | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+			vk::SharingMode::eExclusive,
+			vk::SampleCountFlagBits::e1,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			mip_levels
+		);
+
+		// submitted with the next flush, at the latest by Renderer::end_frame,
+		// a generated mip chain is built by the same submission
+		if (generate_mips)
+		{
+			Na::ArrayVector<const void*> layers(count);
+			for (u32 i = 0; i < count; i++)
+				layers[i] = imgs[i]->data();
+
+			VkContext::GetUploadManager().upload(m_Image, layers.ptr(), first_img->size());
+		} else
+		{
+			// straight from the images, mapped ones are never copied on the cpu before staging
+			Na::ArrayVector<const void*> levels(count * mip_levels);
+			for (u32 i = 0; i < count; i++)
+			{
+				for (u32 level = 0; level < mip_levels; level++)
+					levels[i * mip_levels + level] = imgs[i]->level_data(level);
+			}
+
+			VkContext::GetUploadManager().upload(m_Image, levels.ptr(), first_img->level_sizes().data());
+		}
+
+		this->_create_view(sampler_info);
+	}
+
+	Texture Texture::LoadArray(
+		std::span<const std::filesystem::path> paths,
+		const RendererSettings& renderer_settings,
+		const SamplerInfo& sampler_info,
+		ImageCompression compression
+	)
+	{
+		NA_VERIFY(!paths.empty(), "Failed to load texture array: No paths given!");
+
+		std::vector<AssetHandle<Image>> imgs(paths.size());
+		JobSystem::Get().parallel_for(paths.size(), 1, [&](u64 begin, u64 end)
+		{
+			for (u64 i = begin; i < end; i++)
+				imgs[i] = ImageAsset::Load(paths[i]);
+		});
+
+		const AssetHandle<Image>& first_img = imgs[0];
+
+		vk::Format format = CompressedFormat(compression);
+		if (
+			compression != ImageCompression::None &&
+			FindSupportedFormat({ format }, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eSampledImage) == vk::Format::eUndefined
+		)
+		{
+			g_Logger.fmt(Warn, "{} is not supported by the device, loading the texture array uncompressed!", vk::to_string(format));
+			compression = ImageCompression::None;
+		}
+
+		if (compression == ImageCompression::None || !*first_img || first_img->format() != vk::Format::eR8G8B8A8Srgb)
+			return Texture(imgs.data(), (u32)imgs.size(), renderer_settings, sampler_info);
+
+		for (u64 i = 0; i < imgs.size(); i++)
+		{
+			if (!*imgs[i])
+				throw std::runtime_error(NA_FORMAT("Failed to load texture array: Invalid image at index {}", i));
+
+			if (imgs[i]->width() != first_img->width() || imgs[i]->height() != first_img->height() || imgs[i]->format() != first_img->format())
+				throw std::runtime_error(NA_FORMAT("Failed to load texture array: Image at index {} has a different size or format!", i));
+		}
+
+		vk::Extent3D extent{ (u32)first_img->width(), (u32)first_img->height(), 1 };
+		u32 mip_levels = renderer_settings.mipmaps ? MipLevelCount(extent) : 1;
+
+		// blocks can not be blitted, so every level is encoded
+		std::vector<vk::DeviceSize> level_sizes(mip_levels);
+		vk::DeviceSize layer_size = 0;
+		for (u32 level = 0; level < mip_levels; level++)
+		{
+			level_sizes[level] = CompressedSize(compression, std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u));
+			layer_size += level_sizes[level];
+		}
+
+		std::vector<Byte> encoded(layer_size * imgs.size());
+		JobSystem::Get().parallel_for(imgs.size(), 1, [&](u64 begin, u64 end)
+		{
+			std::vector<u8> level_texels, next_texels;
+			for (u64 i = begin; i < end; i++)
+			{
+				const u8* texels = (const u8*)imgs[i]->data();
+				Byte* dst = encoded.data() + i * layer_size;
+
+				for (u32 level = 0; level < mip_levels; level++)
+				{
+					u32 width = std::max(extent.width >> level, 1u);
+					u32 height = std::max(extent.height >> level, 1u);
+
+					CompressImage(compression, texels, width, height, dst);
+					dst += level_sizes[level];
+
+					if (level + 1 == mip_levels)
+						break;
+
+					next_texels.resize((u64)std::max(width / 2, 1u) * std::max(height / 2, 1u) * 4);
+					DownsampleImage(texels, width, height, next_texels.data());
+
+					std::swap(level_texels, next_texels);
+					texels = level_texels.data();
+				}
+			}
+		});
+
+		Texture texture;
+		texture.m_Image = DeviceImage(
+			extent,
+			(u32)imgs.size(), // layer count
+			vk::ImageAspectFlagBits::eColor,
+			format,
 			vk::ImageTiling::eOptimal,
 			vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
 			vk::SharingMode::eExclusive,
 			vk::SampleCountFlagBits::e1,
-			vk::MemoryPropertyFlagBits::eDeviceLocal
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			mip_levels
 		);
 
-		m_Image.transition_layout(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-		m_Image.copy_all_from_buffer(buffer.buffer);
-		m_Image.transition_layout(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+		// one staging region for every layer and level, submitted with the next flush
+		Na::ArrayVector<const void*> levels(imgs.size() * mip_levels);
+		for (u64 i = 0; i < imgs.size(); i++)
+		{
+			const Byte* level_data = encoded.data() + i * layer_size;
+			for (u32 level = 0; level < mip_levels; level++)
+			{
+				levels[i * mip_levels + level] = level_data;
+				level_data += level_sizes[level];
+			}
+		}
+		VkContext::GetUploadManager().upload(texture.m_Image, levels.ptr(), level_sizes.data());
 
-		buffer.destroy();
+		texture._create_view(sampler_info);
+		return texture;
+	}
 
+	void Texture::_create_view(const SamplerInfo& sampler_info)
+	{
 		m_ImageView = m_Image.create_img_view();
 
-		m_Sampler = Internal::CreateSampler(
-			vk::Filter::eLinear, // oversampling filter
-			vk::Filter::eLinear, // undersampling filter
-			renderer_settings.anisotropy_enabled,
-			renderer_settings.max_anisotropy
-		);
+		m_Sampler = VkContext::GetSamplerCache().get(sampler_info);
+
+		if (BindlessTable* bindless_table = VkContext::GetBindlessTable())
+			m_BindlessIndex = bindless_table->add_texture(m_ImageView, m_Sampler);
 	}
 
 	void Texture::destroy(void)
@@ -78,13 +230,13 @@ namespace Na {
 		if (!m_Image)
 			return;
 
-		vk::Device logical_device = VkContext::GetLogicalDevice();
+		if (m_BindlessIndex != k_NullBindlessIndex)
+			VkContext::GetBindlessTable()->remove_texture(std::exchange(m_BindlessIndex, k_NullBindlessIndex));
 
-		logical_device.destroySampler(m_Sampler);
-		m_Sampler = nullptr;
+		DeletionQueue& deletion_queue = VkContext::GetDeletionQueue();
 
-		logical_device.destroyImageView(m_ImageView);
-		m_ImageView = nullptr;
+		deletion_queue.push(std::exchange(m_ImageView, nullptr));
+		m_Sampler = nullptr;
 
 		m_Image.destroy();
 	}
@@ -92,7 +244,8 @@ namespace Na {
 	Texture::Texture(Texture&& other)
 	: m_Image(std::move(other.m_Image)),
 	m_ImageView(std::exchange(other.m_ImageView, nullptr)),
-	m_Sampler(std::exchange(other.m_Sampler, nullptr))
+	m_Sampler(std::exchange(other.m_Sampler, nullptr)),
+	m_BindlessIndex(std::exchange(other.m_BindlessIndex, k_NullBindlessIndex))
 	{}
 
 	Texture& Texture::operator=(Texture&& other)
@@ -101,6 +254,7 @@ namespace Na {
 		m_Image = std::move(other.m_Image);
 		m_ImageView = std::exchange(other.m_ImageView, nullptr);
 		m_Sampler = std::exchange(other.m_Sampler, nullptr);
+		m_BindlessIndex = std::exchange(other.m_BindlessIndex, k_NullBindlessIndex);
 		return *this;
 	}
 } // namespace Na
@@ -0,0 +1,298 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/TextureAtlas.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+#include "Natrium/Graphics/Buffers/DeviceBuffer.hpp"
+
+namespace Na {
+	TextureAtlas::TextureAtlas(const TextureAtlasInfo& info)
+	: m_Info(info)
+	{
+		NA_ASSERT(info.size && info.layer_count, "Failed to create texture atlas: Invalid size {} with {} layers!", info.size, info.layer_count);
+		NA_VERIFY(
+			info.size <= VkContext::GetPhysicalDeviceLimits().maxImageDimension2D &&
+			info.layer_count <= VkContext::GetPhysicalDeviceLimits().maxImageArrayLayers,
+			"Failed to create texture atlas: {} layers of {}x{} exceed the device's limits!",
+				info.layer_count,
+				info.size,
+				info.size
+		);
+		// add packs k_TexelSize bytes per texel, compressed formats have no texels of their own
+		NA_VERIFY(
+			vk::texelsPerBlock(info.format) == 1 && vk::blockSize(info.format) == k_TexelSize,
+			"Failed to create texture atlas: {} does not have {} bytes per texel!",
+				vk::to_string(info.format),
+				k_TexelSize
+		);
+
+		m_Image = DeviceImage(
+			{ info.size, info.size, 1 },
+			info.layer_count,
+			vk::ImageAspectFlagBits::eColor,
+			info.format,
+			vk::ImageTiling::eOptimal,
+			vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+			vk::SharingMode::eExclusive,
+			vk::SampleCountFlagBits::e1,
+			vk::MemoryPropertyFlagBits::eDeviceLocal
+		);
+
+		// every layer starts out transparent and readable, so it can be sampled before anything is added
+		vk::CommandBuffer cmd_buffer = VkContext::BeginSingleTimeCommands();
+
+		m_Image.transition_layout(cmd_buffer, vk::ImageLayout::eTransferDstOptimal);
+
+		vk::ClearColorValue clear_color(std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 0.0f });
+		cmd_buffer.clearColorImage(m_Image.img, vk::ImageLayout::eTransferDstOptimal, &clear_color, 1, &m_Image.subresource_range);
+
+		m_Image.transition_layout(cmd_buffer, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+		VkContext::EndSingleTimeCommands(cmd_buffer);
+
+		m_ImageView = m_Image.create_img_view();
+		m_Sampler = VkContext::GetSamplerCache().get(info.sampler);
+
+		if (BindlessTable* bindless_table = VkContext::GetBindlessTable())
+			m_BindlessIndex = bindless_table->add_texture(m_ImageView, m_Sampler);
+
+		m_Layers.resize(info.layer_count);
+		this->clear();
+	}
+
+	void TextureAtlas::destroy(void)
+	{
+		if (!m_Image)
+			return;
+
+		if (m_BindlessIndex != k_NullBindlessIndex)
+			VkContext::GetBindlessTable()->remove_texture(std::exchange(m_BindlessIndex, k_NullBindlessIndex));
+
+		VkContext::GetDeletionQueue().push(std::exchange(m_ImageView, nullptr));
+		m_Image.destroy();
+		m_Sampler = nullptr;
+
+		m_Layers.clear();
+		m_Staging.clear();
+		m_Copies.clear();
+	}
+
+	AtlasRegion TextureAtlas::add(const void* pixels, u32 width, u32 height)
+	{
+		NA_ASSERT(pixels && width && height, "Failed to add {}x{} image to texture atlas: Invalid image!", width, height);
+
+		u32 padded_width = width + 2 * m_Info.padding;
+		u32 padded_height = height + 2 * m_Info.padding;
+		if (padded_width > m_Info.size || padded_height > m_Info.size)
+			return AtlasRegion{};
+
+		// the lowest top edge within the first layer that has room, ties go to the narrower node,
+		// which leaves the wider gaps for larger images
+		for (u32 layer_index = 0; layer_index < (u32)m_Layers.size(); layer_index++)
+		{
+			Layer& layer = m_Layers[layer_index];
+
+			u64 best_node = k_U64Max;
+			u32 best_top = k_U32Max;
+			u32 best_width = k_U32Max;
+			u32 best_y = 0;
+
+			for (u64 node = 0; node < layer.skyline.size(); node++)
+			{
+				u32 y = this->_fit(layer, node, padded_width, padded_height);
+				if (y == k_U32Max)
+					continue;
+
+				u32 top = y + padded_height;
+				if (top < best_top || (top == best_top && layer.skyline[node].width < best_width))
+				{
+					best_node = node;
+					best_top = top;
+					best_width = layer.skyline[node].width;
+					best_y = y;
+				}
+			}
+
+			if (best_node == k_U64Max)
+				continue;
+
+			u32 x = layer.skyline[best_node].x;
+			this->_insert(layer, best_node, x, best_y, padded_width, padded_height);
+			layer.used_area += (u64)padded_width * padded_height;
+
+			// the padding is uploaded with the texels, cleared, so nothing of an earlier clear bleeds through
+			u64 offset = m_Staging.size();
+			m_Staging.resize(offset + (u64)padded_width * padded_height * k_TexelSize);
+
+			Byte* dst = m_Staging.data() + offset;
+			memset(dst, 0, (u64)padded_width * padded_height * k_TexelSize);
+			for (u32 row = 0; row < height; row++)
+				memcpy(
+					dst + ((u64)(row + m_Info.padding) * padded_width + m_Info.padding) * k_TexelSize,
+					(const Byte*)pixels + (u64)row * width * k_TexelSize,
+					(u64)width * k_TexelSize
+				);
+
+			vk::BufferImageCopy copy;
+			copy.bufferOffset = offset;
+			copy.imageSubresource = { vk::ImageAspectFlagBits::eColor, 0, layer_index, 1 };
+			copy.imageOffset = vk::Offset3D{ (i32)x, (i32)best_y, 0 };
+			copy.imageExtent = vk::Extent3D{ padded_width, padded_height, 1 };
+			m_Copies.push_back(copy);
+
+			AtlasRegion region;
+			region.layer = layer_index;
+			region.x = x + m_Info.padding;
+			region.y = best_y + m_Info.padding;
+			region.width = width;
+			region.height = height;
+			region.uv_min = glm::vec2(region.x, region.y) / (float)m_Info.size;
+			region.uv_max = glm::vec2(region.x + width, region.y + height) / (float)m_Info.size;
+			return region;
+		}
+
+		return AtlasRegion{};
+	}
+
+	AtlasRegion TextureAtlas::add(const ImageAsset& img)
+	{
+		NA_VERIFY(
+			img.format() == m_Info.format,
+			"Failed to add image to texture atlas: Its format {} does not match {}!",
+				vk::to_string(img.format()),
+				vk::to_string(m_Info.format)
+		);
+
+		return this->add(img.level_data(0), (u32)img.width(), (u32)img.height());
+	}
+
+	void TextureAtlas::clear(void)
+	{
+		for (Layer& layer : m_Layers)
+		{
+			layer.skyline.assign(1, SkylineNode{ 0, 0, m_Info.size });
+			layer.used_area = 0;
+		}
+
+		m_Staging.clear();
+		m_Copies.clear();
+	}
+
+	bool TextureAtlas::record(vk::CommandBuffer cmd_buffer)
+	{
+		if (m_Copies.empty())
+			return false;
+
+		// freed once the frame recording the copy completed
+		DeviceBuffer staging(
+			m_Staging.size(),
+			vk::BufferUsageFlagBits::eTransferSrc,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+		memcpy(staging.mapped(), m_Staging.data(), m_Staging.size());
+
+		// earlier frames on the queue may still sample the image, their reads finish first
+		m_Image.transition_layout(cmd_buffer, vk::ImageLayout::eTransferDstOptimal);
+
+		cmd_buffer.copyBufferToImage(staging.buffer, m_Image.img, vk::ImageLayout::eTransferDstOptimal, (u32)m_Copies.size(), m_Copies.data());
+
+		m_Image.transition_layout(cmd_buffer, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+		m_Staging.clear();
+		m_Copies.clear();
+
+		return true;
+	}
+
+	float TextureAtlas::occupancy(u32 layer) const
+	{
+		NA_ASSERT(layer < m_Layers.size(), "Failed to get texture atlas occupancy: Layer {} does not exist!", layer);
+		return (float)((double)m_Layers[layer].used_area / ((double)m_Info.size * m_Info.size));
+	}
+
+	u32 TextureAtlas::_fit(const Layer& layer, u64 node, u32 width, u32 height) const
+	{
+		u32 x = layer.skyline[node].x;
+		if (x + width > m_Info.size)
+			return k_U32Max;
+
+		// rests on the highest node it spans
+		u32 y = 0;
+		u32 remaining = width;
+		for (u64 i = node; remaining; i++)
+		{
+			y = std::max(y, layer.skyline[i].y);
+			if (y + height > m_Info.size)
+				return k_U32Max;
+
+			remaining -= std::min(remaining, layer.skyline[i].width);
+		}
+
+		return y;
+	}
+
+	void TextureAtlas::_insert(Layer& layer, u64 node, u32 x, u32 y, u32 width, u32 height)
+	{
+		std::vector<SkylineNode>& skyline = layer.skyline;
+		skyline.insert(skyline.begin() + node, SkylineNode{ x, y + height, width });
+
+		// the nodes now underneath the rect shrink or go
+		for (u64 i = node + 1; i < skyline.size();)
+		{
+			const SkylineNode& previous = skyline[i - 1];
+			u32 previous_end = previous.x + previous.width;
+			if (skyline[i].x >= previous_end)
+				break;
+
+			u32 overlap = previous_end - skyline[i].x;
+			if (skyline[i].width <= overlap)
+			{
+				skyline.erase(skyline.begin() + i);
+				continue;
+			}
+
+			skyline[i].x += overlap;
+			skyline[i].width -= overlap;
+			break;
+		}
+
+		// neighbours at the same height become one node
+		for (u64 i = 0; i + 1 < skyline.size();)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			} else
+			{
+				i++;
+			}
+		}
+	}
+
+	TextureAtlas::TextureAtlas(TextureAtlas&& other)
+	: m_Info(other.m_Info),
+	m_Image(std::move(other.m_Image)),
+	m_ImageView(std::exchange(other.m_ImageView, nullptr)),
+	m_Sampler(std::exchange(other.m_Sampler, nullptr)),
+	m_BindlessIndex(std::exchange(other.m_BindlessIndex, k_NullBindlessIndex)),
+	m_Layers(std::move(other.m_Layers)),
+	m_Staging(std::move(other.m_Staging)),
+	m_Copies(std::move(other.m_Copies))
+	{}
+
+	TextureAtlas& TextureAtlas::operator=(TextureAtlas&& other)
+	{
+		this->destroy();
+
+		m_Info = other.m_Info;
+		m_Image = std::move(other.m_Image);
+		m_ImageView = std::exchange(other.m_ImageView, nullptr);
+		m_Sampler = std::exchange(other.m_Sampler, nullptr);
+		m_BindlessIndex = std::exchange(other.m_BindlessIndex, k_NullBindlessIndex);
+		m_Layers = std::move(other.m_Layers);
+		m_Staging = std::move(other.m_Staging);
+		m_Copies = std::move(other.m_Copies);
+
+		return *this;
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/TextureStreamer.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	TextureStreamer::TextureStreamer(const TextureStreamerSettings& settings, const RendererSettings& renderer_settings)
+	: m_Settings(settings),
+	m_MaxFramesInFlight(renderer_settings.max_frames_in_flight),
+	m_Sampler(VkContext::GetSamplerCache().get(SamplerInfo::FromSettings(renderer_settings)))
+	{}
+
+	void TextureStreamer::destroy(void)
+	{
+		if (m_Entries.empty() && m_Retired.empty())
+			return;
+
+		// pending images may still be written by the transfer queue
+		VkContext::GetUploadManager().wait_idle();
+
+		for (Entry& entry : m_Entries)
+		{
+			if (entry.pending_img)
+				entry.pending_img.destroy();
+		}
+		m_Entries.clear(); // the textures destroy themselves
+		m_FreeIDs.clear();
+
+		for (Retired& retired : m_Retired)
+			this->_destroy(retired);
+		m_Retired.clear();
+
+		m_Changed.clear();
+		m_ResidentBytes = 0;
+	}
+
+	StreamedTextureID TextureStreamer::add(AssetHandle<Image> img)
+	{
+		NA_ASSERT(img && *img, "Failed to add streamed texture: Invalid image!");
+
+		vk::Format format = img->format();
+		if (FindSupportedFormat({ format }, vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eSampledImage) == vk::Format::eUndefined)
+			throw std::runtime_error(NA_FORMAT("Failed to add streamed texture: {} is not supported by the device!", vk::to_string(format)));
+
+		StreamedTextureID id;
+		if (!m_FreeIDs.empty())
+		{
+			id = m_FreeIDs.back();
+			m_FreeIDs.pop_back();
+		} else
+		{
+			id = (StreamedTextureID)m_Entries.size();
+			m_Entries.emplace_back();
+		}
+
+		Entry& entry = m_Entries[id];
+		entry.source = std::move(img);
+		entry.alive = true;
+
+		u32 largest = (u32)std::max(entry.source->width(), entry.source->height());
+		entry.coarsest_mip = 0;
+		while (entry.coarsest_mip + 1 < entry.source->mip_levels() && (largest >> entry.coarsest_mip) > m_Settings.min_resident_extent)
+			entry.coarsest_mip++;
+
+		entry.requested_mip = entry.coarsest_mip;
+		entry.last_request = m_Update;
+
+		entry.texture.m_Sampler = m_Sampler;
+
+		// graphics submissions after the next flush are ordered after the upload, so the coarse
+		// levels can be used right away like any other Texture
+		this->_stage(entry, entry.coarsest_mip);
+		this->_swap(entry);
+
+		m_ResidentBytes += this->_bytes(entry, entry.resident_mip);
+
+		return id;
+	}
+
+	void TextureStreamer::remove(StreamedTextureID id)
+	{
+		Entry& entry = m_Entries[id];
+		NA_ASSERT(entry.alive, "Failed to remove streamed texture: #{} does not exist!", id);
+
+		m_ResidentBytes -= this->_bytes(entry, entry.resident_mip);
+
+		this->_retire(entry.texture);
+		entry.texture.m_Sampler = nullptr;
+
+		// may still be written by an upload
+		if (entry.pending_img)
+			m_Retired.push_back(Retired{ .img = std::move(entry.pending_img), .update = m_Update });
+
+		entry = Entry{};
+		m_FreeIDs.push_back(id);
+	}
+
+	void TextureStreamer::request(StreamedTextureID id, u32 mip)
+	{
+		Entry& entry = m_Entries[id];
+		NA_ASSERT(entry.alive, "Failed to request streamed texture: #{} does not exist!", id);
+
+		if (entry.last_request != m_Update)
+			entry.requested_mip = mip;
+		else
+			entry.requested_mip = std::min(entry.requested_mip, mip);
+
+		entry.last_request = m_Update;
+	}
+
+	u32 TextureStreamer::mip_for_screen_size(StreamedTextureID id, float screen_pixels) const
+	{
+		const Entry& entry = m_Entries[id];
+
+		float largest = (float)std::max(entry.source->width(), entry.source->height());
+		if (screen_pixels <= 0.0f)
+			return entry.coarsest_mip;
+
+		float mip = std::floor(std::log2(largest / screen_pixels));
+		if (mip <= 0.0f)
+			return 0;
+
+		return std::min((u32)mip, entry.coarsest_mip);
+	}
+
+	void TextureStreamer::update(void)
+	{
+		m_Update++;
+		m_Changed.clear();
+
+		UploadManager& upload_manager = VkContext::GetUploadManager();
+
+		while (!m_Retired.empty() && m_Update - m_Retired.front().update > m_MaxFramesInFlight)
+		{
+			this->_destroy(m_Retired.front());
+			m_Retired.pop_front();
+		}
+
+		for (StreamedTextureID id = 0; id < m_Entries.size(); id++)
+		{
+			Entry& entry = m_Entries[id];
+			if (!entry.alive || entry.pending_mip == k_U32Max || !upload_manager.is_complete(entry.ticket))
+				continue;
+
+			m_ResidentBytes -= this->_bytes(entry, entry.resident_mip);
+			this->_swap(entry);
+			m_ResidentBytes += this->_bytes(entry, entry.resident_mip);
+
+			m_Changed.push_back(id);
+		}
+
+		std::vector<StreamedTextureID> order;
+		order.reserve(m_Entries.size() - m_FreeIDs.size());
+
+		std::vector<u32> desired(m_Entries.size(), 0);
+		u64 desired_bytes = 0;
+
+		for (StreamedTextureID id = 0; id < m_Entries.size(); id++)
+		{
+			const Entry& entry = m_Entries[id];
+			if (!entry.alive)
+				continue;
+
+			if (m_Update - entry.last_request <= m_Settings.evict_after_updates)
+				desired[id] = std::min(entry.requested_mip, entry.coarsest_mip);
+			else
+				desired[id] = entry.coarsest_mip;
+
+			desired_bytes += this->_bytes(entry, desired[id]);
+			order.push_back(id);
+		}
+
+		// least recently requested first
+		std::sort(order.begin(), order.end(), [this](StreamedTextureID a, StreamedTextureID b)
+		{
+			return m_Entries[a].last_request < m_Entries[b].last_request;
+		});
+
+		for (StreamedTextureID id : order)
+		{
+			if (desired_bytes <= m_Settings.budget)
+				break;
+
+			const Entry& entry = m_Entries[id];
+			while (desired_bytes > m_Settings.budget && desired[id] < entry.coarsest_mip)
+				desired_bytes -= entry.source->level_sizes()[desired[id]++];
+		}
+
+		// most recently requested first, so the upload limit goes to what is on screen
+		bool staged = false;
+		u64 upload_bytes = 0;
+		for (auto it = order.rbegin(); it != order.rend(); it++)
+		{
+			Entry& entry = m_Entries[*it];
+			u32 mip = desired[*it];
+
+			// a different level is picked once the current upload is swapped in
+			if (entry.pending_mip != k_U32Max || mip == entry.resident_mip)
+				continue;
+
+			// only finer levels count against the limit, evicting uploads less than is resident
+			if (mip < entry.resident_mip)
+			{
+				u64 bytes = this->_bytes(entry, mip);
+				if (upload_bytes && upload_bytes + bytes > m_Settings.max_upload_bytes_per_update)
+					continue;
+
+				upload_bytes += bytes;
+			}
+
+			this->_stage(entry, mip);
+			staged = true;
+		}
+
+		if (!staged)
+			return;
+
+		UploadTicket ticket = upload_manager.flush();
+		for (Entry& entry : m_Entries)
+		{
+			if (entry.pending_mip != k_U32Max && !entry.ticket)
+				entry.ticket = ticket;
+		}
+	}
+
+	u64 TextureStreamer::_bytes(const Entry& entry, u32 mip) const
+	{
+		const std::vector<u64>& level_sizes = entry.source->level_sizes();
+
+		u64 bytes = 0;
+		for (u32 i = mip; i < level_sizes.size(); i++)
+			bytes += level_sizes[i];
+		return bytes;
+	}
+
+	void TextureStreamer::_stage(Entry& entry, u32 mip)
+	{
+		const Image& source = *entry.source;
+
+		entry.pending_img = DeviceImage(
+			{ std::max((u32)source.width() >> mip, 1u), std::max((u32)source.height() >> mip, 1u), 1 }, // extent
+			1, // layer count
+			vk::ImageAspectFlagBits::eColor,
+			source.format(),
+			vk::ImageTiling::eOptimal,
+			vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+			vk::SharingMode::eExclusive,
+			vk::SampleCountFlagBits::e1,
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			source.mip_levels() - mip
+		);
+
+		Na::ArrayVector<const void*> levels(source.mip_levels() - mip);
+		for (u32 i = 0; i < levels.size(); i++)
+			levels[i] = source.level_data(mip + i);
+
+		VkContext::GetUploadManager().upload(entry.pending_img, levels.ptr(), source.level_sizes().data() + mip);
+
+		entry.pending_mip = mip;
+		entry.ticket = 0;
+	}
+
+	void TextureStreamer::_swap(Entry& entry)
+	{
+		this->_retire(entry.texture);
+
+		Texture& texture = entry.texture;
+		texture.m_Image = std::move(entry.pending_img);
+		entry.pending_img = DeviceImage(); // a moved from image still has its format
+		texture.m_ImageView = texture.m_Image.create_img_view();
+
+		if (BindlessTable* bindless_table = VkContext::GetBindlessTable())
+			texture.m_BindlessIndex = bindless_table->add_texture(texture.m_ImageView, texture.m_Sampler);
+
+		entry.resident_mip = entry.pending_mip;
+		entry.pending_mip = k_U32Max;
+		entry.ticket = 0;
+	}
+
+	void TextureStreamer::_retire(Texture& texture)
+	{
+		if (!texture.m_Image)
+			return;
+
+		// the bindless slot may still be read by pending frames, it is freed with the image
+		Retired retired;
+		retired.img = std::move(texture.m_Image);
+		retired.img_view = std::exchange(texture.m_ImageView, nullptr);
+		retired.bindless_index = std::exchange(texture.m_BindlessIndex, k_NullBindlessIndex);
+		texture.m_Image = DeviceImage(); // a moved from image still has its format
+		retired.update = m_Update;
+
+		m_Retired.push_back(std::move(retired));
+	}
+
+	void TextureStreamer::_destroy(Retired& retired)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		if (retired.bindless_index != k_NullBindlessIndex)
+			VkContext::GetBindlessTable()->remove_texture(retired.bindless_index);
+
+		if (retired.img_view)
+			logical_device.destroyImageView(retired.img_view);
+
+		if (retired.img)
+			retired.img.destroy();
+	}
+} // namespace Na
\ No newline at end of file
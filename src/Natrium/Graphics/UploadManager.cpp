@@ -0,0 +1,521 @@
+#include "Pch.hpp"
+#include "Natrium/Graphics/UploadManager.hpp"
+
+#include "Natrium/Graphics/VkContext.hpp"
+
+namespace Na {
+	static inline vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	static vk::CommandPool createUploadCmdPool(vk::Device device, u32 queue_family)
+	{
+		vk::CommandPoolCreateInfo create_info;
+		create_info.queueFamilyIndex = queue_family;
+		create_info.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+
+		return device.createCommandPool(create_info);
+	}
+
+	UploadManager::UploadManager(vk::DeviceSize staging_size)
+	: m_Staging(
+		staging_size,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+	)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+		QueueFamilyIndices indices = VkContext::GetQueueFamilyIndices();
+
+		m_GraphicsFamily = indices.graphics;
+		m_TransferFamily = indices.transfer;
+
+		m_TransferCmdPool = createUploadCmdPool(logical_device, m_TransferFamily);
+		if (this->uses_transfer_queue())
+			m_GraphicsCmdPool = createUploadCmdPool(logical_device, m_GraphicsFamily);
+	}
+
+	void UploadManager::destroy(void)
+	{
+		if (!m_TransferCmdPool)
+			return;
+
+		this->wait_idle();
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		for (Batch& batch : m_FreeBatches)
+		{
+			logical_device.destroyFence(batch.fence);
+			if (batch.semaphore)
+				logical_device.destroySemaphore(batch.semaphore);
+		}
+		m_FreeBatches.clear();
+
+		// frees the command buffers as well
+		logical_device.destroyCommandPool(m_TransferCmdPool);
+		m_TransferCmdPool = nullptr;
+
+		if (m_GraphicsCmdPool)
+			logical_device.destroyCommandPool(m_GraphicsCmdPool);
+		m_GraphicsCmdPool = nullptr;
+
+		m_Staging.destroy();
+		m_Head = 0;
+		m_Used = 0;
+	}
+
+	void* UploadManager::stage_buffer(const DeviceBuffer& dst, vk::DeviceSize size, vk::DeviceSize dst_offset)
+	{
+		std::lock_guard lock(m_Mutex);
+		return this->_stage_buffer(dst, size, dst_offset);
+	}
+
+	void* UploadManager::stage_image(DeviceImage& dst, vk::DeviceSize size)
+	{
+		std::lock_guard lock(m_Mutex);
+		return this->_stage_image(dst, size);
+	}
+
+	void UploadManager::upload(const DeviceBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dst_offset)
+	{
+		std::lock_guard lock(m_Mutex);
+		memcpy(this->_stage_buffer(dst, size, dst_offset), data, size);
+	}
+
+	void UploadManager::upload(DeviceImage& dst, const void* data, vk::DeviceSize size)
+	{
+		std::lock_guard lock(m_Mutex);
+		memcpy(this->_stage_image(dst, size), data, size);
+	}
+
+	void UploadManager::upload(DeviceImage& dst, const void* const* layers, vk::DeviceSize layer_size)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		Byte* staged = (Byte*)this->_stage_image(dst, layer_size * dst.layer_count());
+		for (u32 i = 0; i < dst.layer_count(); i++)
+			memcpy(staged + i * layer_size, layers[i], layer_size);
+	}
+
+	void UploadManager::upload(DeviceImage& dst, const void* const* levels, const vk::DeviceSize* level_sizes)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		// every level starts aligned for the copy, the same layout _stage_image records
+		vk::DeviceSize layer_size = 0;
+		for (u32 i = 0; i < dst.mip_levels(); i++)
+			layer_size = alignUp(layer_size + level_sizes[i], k_StagingAlignment);
+
+		Byte* staged = (Byte*)this->_stage_image(dst, layer_size * dst.layer_count(), level_sizes);
+		for (u32 i = 0; i < dst.layer_count(); i++)
+		{
+			vk::DeviceSize level_offset = i * layer_size;
+			for (u32 level = 0; level < dst.mip_levels(); level++)
+			{
+				memcpy(staged + level_offset, levels[i * dst.mip_levels() + level], level_sizes[level]);
+				level_offset = alignUp(level_offset + level_sizes[level], k_StagingAlignment);
+			}
+		}
+	}
+
+	UploadTicket UploadManager::flush(void)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		this->_retire(false);
+		return this->_flush();
+	}
+
+	bool UploadManager::is_complete(UploadTicket ticket)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		this->_retire(false);
+		return ticket <= m_CompletedTicket;
+	}
+
+	void UploadManager::wait(UploadTicket ticket)
+	{
+		std::lock_guard lock(m_Mutex);
+
+		while (ticket > m_CompletedTicket && !m_InFlight.empty())
+			this->_retire(true);
+	}
+
+	void* UploadManager::_stage_buffer(const DeviceBuffer& dst, vk::DeviceSize size, vk::DeviceSize dst_offset)
+	{
+		NA_ASSERT(dst_offset + size <= dst.size, "Failed to stage buffer upload: {} bytes at offset {} exceed the buffer size of {}!", size, dst_offset, dst.size);
+
+		vk::Buffer src;
+		vk::DeviceSize src_offset;
+		void* staged = this->_stage(size, src, src_offset);
+
+		Batch& batch = this->_current_batch();
+
+		vk::BufferCopy region(src_offset, dst_offset, size);
+		batch.transfer_cmd.copyBuffer(src, dst.buffer, 1, &region);
+
+		vk::BufferMemoryBarrier& barrier = batch.buffer_barriers.emplace_back();
+		barrier.buffer = dst.buffer;
+		barrier.offset = dst_offset;
+		barrier.size = size;
+
+		return staged;
+	}
+
+	void* UploadManager::_stage_image(DeviceImage& dst, vk::DeviceSize size, const vk::DeviceSize* level_sizes)
+	{
+		NA_ASSERT(size % dst.layer_count() == 0, "Failed to stage image upload: size is not a multiple of the layer count!");
+
+		vk::Buffer src;
+		vk::DeviceSize src_offset;
+		void* staged = this->_stage(size, src, src_offset);
+
+		// where the graphics queue leaves it once the batch was acquired
+		dst.set_state(ImageState::ForLayout(vk::ImageLayout::eShaderReadOnlyOptimal));
+
+		Batch& batch = this->_current_batch();
+
+		vk::ImageMemoryBarrier to_transfer;
+		to_transfer.oldLayout = vk::ImageLayout::eUndefined;
+		to_transfer.newLayout = vk::ImageLayout::eTransferDstOptimal;
+		to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		to_transfer.image = dst.img;
+		to_transfer.subresourceRange = dst.subresource_range;
+		to_transfer.srcAccessMask = {};
+		to_transfer.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+		batch.transfer_cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTopOfPipe,
+			vk::PipelineStageFlagBits::eTransfer,
+			{}, // dependency flags
+			0, nullptr, // memory barriers
+			0, nullptr, // buffer memory barriers
+			1, &to_transfer // image memory barriers
+		);
+
+		vk::DeviceSize layer_size = size / dst.layer_count();
+		u32 level_count = level_sizes ? dst.mip_levels() : 1;
+
+		// layer major, so the levels of one layer are contiguous in staging memory
+		Na::ArrayVector<vk::BufferImageCopy> regions(dst.layer_count() * level_count);
+		for (u32 i = 0; i < dst.layer_count(); i++)
+		{
+			vk::DeviceSize level_offset = 0;
+			for (u32 level = 0; level < level_count; level++)
+			{
+				vk::BufferImageCopy& region = regions[i * level_count + level];
+				region.bufferOffset = src_offset + i * layer_size + level_offset;
+				region.imageSubresource = vk::ImageSubresourceLayers(
+					dst.subresource_range.aspectMask,
+					level,
+					i, // layer
+					1 // layer count (1 at a time)
+				);
+				region.imageExtent = dst.mip_extent(level);
+
+				// bufferOffset has to be a multiple of 4 and of the texel block size
+				if (level_sizes)
+					level_offset = alignUp(level_offset + level_sizes[level], k_StagingAlignment);
+			}
+		}
+
+		batch.transfer_cmd.copyBufferToImage(
+			src,
+			dst.img,
+			vk::ImageLayout::eTransferDstOptimal,
+			(u32)regions.size(), regions.ptr()
+		);
+
+		bool generate_mips = !level_sizes && dst.mip_levels() > 1;
+		if (generate_mips)
+		{
+			// the transfer queue may not support blits, the chain is built once the graphics queue owns the image
+			if (!this->uses_transfer_queue())
+			{
+				RecordMipGeneration(batch.transfer_cmd, dst.img, dst.extent, dst.subresource_range);
+				return staged;
+			}
+
+			batch.mip_chains.push_back(MipChain{ dst.img, dst.extent, dst.subresource_range });
+		}
+
+		vk::ImageMemoryBarrier& barrier = batch.image_barriers.emplace_back();
+		barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		barrier.newLayout = generate_mips ? vk::ImageLayout::eTransferDstOptimal : vk::ImageLayout::eShaderReadOnlyOptimal;
+		barrier.image = dst.img;
+		barrier.subresourceRange = dst.subresource_range;
+
+		return staged;
+	}
+
+	void* UploadManager::_stage(vk::DeviceSize size, vk::Buffer& buffer, vk::DeviceSize& offset)
+	{
+		if (size > m_Staging.size)
+		{
+			DeviceBuffer& oversized = this->_current_batch().oversized.emplace_back(
+				size,
+				vk::BufferUsageFlagBits::eTransferSrc,
+				vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+			);
+
+			buffer = oversized.buffer;
+			offset = 0;
+			return oversized.mapped();
+		}
+
+		vk::DeviceSize consumed = 0;
+		for (;;)
+		{
+			if (!m_Used)
+				m_Head = 0;
+
+			vk::DeviceSize aligned = alignUp(m_Head, k_StagingAlignment);
+			if (aligned + size <= m_Staging.size)
+			{
+				offset = aligned;
+				consumed = aligned - m_Head + size;
+			} else
+			{
+				// wrap around, the end of the ring stays used until this batch retires
+				offset = 0;
+				consumed = m_Staging.size - m_Head + size;
+			}
+
+			if (m_Used + consumed <= m_Staging.size)
+				break;
+
+			// the current batch holds the rest of the ring, it has to go first
+			if (m_InFlight.empty())
+				this->_flush();
+			this->_retire(true);
+		}
+
+		m_Head = offset + size;
+		m_Used += consumed;
+		this->_current_batch().staging_bytes += consumed;
+
+		buffer = m_Staging.buffer;
+		return (Byte*)m_Staging.mapped() + offset;
+	}
+
+	UploadManager::Batch& UploadManager::_current_batch(void)
+	{
+		if (m_Current)
+			return *m_Current;
+
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		Batch batch;
+		if (!m_FreeBatches.empty())
+		{
+			batch = std::move(m_FreeBatches.back());
+			m_FreeBatches.pop_back();
+		} else
+		{
+			vk::CommandBufferAllocateInfo alloc_info;
+			alloc_info.level = vk::CommandBufferLevel::ePrimary;
+			alloc_info.commandBufferCount = 1;
+
+			alloc_info.commandPool = m_TransferCmdPool;
+			(void)logical_device.allocateCommandBuffers(&alloc_info, &batch.transfer_cmd);
+
+			if (this->uses_transfer_queue())
+			{
+				alloc_info.commandPool = m_GraphicsCmdPool;
+				(void)logical_device.allocateCommandBuffers(&alloc_info, &batch.acquire_cmd);
+
+				batch.semaphore = logical_device.createSemaphore({});
+			}
+
+			batch.fence = logical_device.createFence({});
+		}
+
+		vk::CommandBufferBeginInfo begin_info;
+		begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		batch.transfer_cmd.begin(begin_info);
+
+		return m_Current.emplace(std::move(batch));
+	}
+
+	UploadTicket UploadManager::_flush(void)
+	{
+		if (!m_Current)
+			return m_NextTicket - 1;
+
+		Batch batch = std::move(*m_Current);
+		m_Current.reset();
+
+		vk::Result result = vk::Result::eSuccess;
+
+		if (this->uses_transfer_queue())
+		{
+			for (vk::BufferMemoryBarrier& barrier : batch.buffer_barriers)
+			{
+				barrier.srcQueueFamilyIndex = m_TransferFamily;
+				barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+				barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+				barrier.dstAccessMask = {};
+			}
+
+			for (vk::ImageMemoryBarrier& barrier : batch.image_barriers)
+			{
+				barrier.srcQueueFamilyIndex = m_TransferFamily;
+				barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+				barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+				barrier.dstAccessMask = {};
+			}
+
+			// release
+			batch.transfer_cmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eBottomOfPipe,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				(u32)batch.buffer_barriers.size(), batch.buffer_barriers.data(),
+				(u32)batch.image_barriers.size(), batch.image_barriers.data()
+			);
+			batch.transfer_cmd.end();
+
+			for (vk::BufferMemoryBarrier& barrier : batch.buffer_barriers)
+			{
+				barrier.srcAccessMask = {};
+				barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+			}
+
+			for (vk::ImageMemoryBarrier& barrier : batch.image_barriers)
+			{
+				barrier.srcAccessMask = {};
+				barrier.dstAccessMask = barrier.newLayout == vk::ImageLayout::eTransferDstOptimal
+					? vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite
+					: vk::AccessFlagBits::eShaderRead;
+			}
+
+			// acquire
+			vk::CommandBufferBeginInfo begin_info;
+			begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+			batch.acquire_cmd.begin(begin_info);
+			batch.acquire_cmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eAllCommands,
+				vk::PipelineStageFlagBits::eAllCommands,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				(u32)batch.buffer_barriers.size(), batch.buffer_barriers.data(),
+				(u32)batch.image_barriers.size(), batch.image_barriers.data()
+			);
+			for (const MipChain& mip_chain : batch.mip_chains)
+				RecordMipGeneration(batch.acquire_cmd, mip_chain.img, mip_chain.extent, mip_chain.range);
+			batch.acquire_cmd.end();
+
+			vk::SubmitInfo transfer_submit;
+			transfer_submit.commandBufferCount = 1;
+			transfer_submit.pCommandBuffers = &batch.transfer_cmd;
+			transfer_submit.signalSemaphoreCount = 1;
+			transfer_submit.pSignalSemaphores = &batch.semaphore;
+
+			{
+				std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetTransferQueue());
+				result = VkContext::GetTransferQueue().submit(1, &transfer_submit, nullptr);
+			}
+			NA_VERIFY_VK(result, "Failed to flush uploads: Error in submitting to transfer queue!");
+
+			vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eAllCommands;
+
+			vk::SubmitInfo acquire_submit;
+			acquire_submit.waitSemaphoreCount = 1;
+			acquire_submit.pWaitSemaphores = &batch.semaphore;
+			acquire_submit.pWaitDstStageMask = &wait_stage;
+			acquire_submit.commandBufferCount = 1;
+			acquire_submit.pCommandBuffers = &batch.acquire_cmd;
+
+			{
+				std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+				result = VkContext::GetGraphicsQueue().submit(1, &acquire_submit, batch.fence);
+			}
+			NA_VERIFY_VK(result, "Failed to flush uploads: Error in submitting to graphics queue!");
+		} else
+		{
+			for (vk::BufferMemoryBarrier& barrier : batch.buffer_barriers)
+			{
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+				barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+			}
+
+			for (vk::ImageMemoryBarrier& barrier : batch.image_barriers)
+			{
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+				barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+			}
+
+			batch.transfer_cmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eAllCommands,
+				{}, // dependency flags
+				0, nullptr, // memory barriers
+				(u32)batch.buffer_barriers.size(), batch.buffer_barriers.data(),
+				(u32)batch.image_barriers.size(), batch.image_barriers.data()
+			);
+			batch.transfer_cmd.end();
+
+			vk::SubmitInfo submit_info;
+			submit_info.commandBufferCount = 1;
+			submit_info.pCommandBuffers = &batch.transfer_cmd;
+
+			{
+				std::unique_lock queue_lock = VkContext::QueueLock(VkContext::GetGraphicsQueue());
+				result = VkContext::GetGraphicsQueue().submit(1, &submit_info, batch.fence);
+			}
+			NA_VERIFY_VK(result, "Failed to flush uploads: Error in submitting to graphics queue!");
+		}
+
+		batch.ticket = m_NextTicket++;
+		m_InFlight.push_back(std::move(batch));
+
+		return m_InFlight.back().ticket;
+	}
+
+	void UploadManager::_retire(bool wait_for_oldest)
+	{
+		vk::Device logical_device = VkContext::GetLogicalDevice();
+
+		while (!m_InFlight.empty())
+		{
+			Batch& batch = m_InFlight.front();
+
+			if (wait_for_oldest)
+			{
+				vk::Result result = logical_device.waitForFences({ batch.fence }, VK_TRUE, UINT64_MAX);
+				NA_VERIFY_VK(result, "Failed to retire upload batch #{}: Error in waiting for fence!", batch.ticket);
+				wait_for_oldest = false;
+			} else if (logical_device.getFenceStatus(batch.fence) != vk::Result::eSuccess)
+			{
+				break;
+			}
+
+			m_Used -= batch.staging_bytes;
+			m_CompletedTicket = batch.ticket;
+
+			logical_device.resetFences({ batch.fence });
+			batch.transfer_cmd.reset();
+			if (batch.acquire_cmd)
+				batch.acquire_cmd.reset();
+
+			batch.ticket = 0;
+			batch.staging_bytes = 0;
+			batch.oversized.clear();
+			batch.buffer_barriers.clear();
+			batch.image_barriers.clear();
+			batch.mip_chains.clear();
+
+			m_FreeBatches.push_back(std::move(batch));
+			m_InFlight.pop_front();
+		}
+	}
+} // namespace Na
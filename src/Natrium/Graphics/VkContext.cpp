@@ -57,6 +57,29 @@ namespace Na {
 		//VK_EXT_DEPTH_RANGE_UNRESTRICTED_EXTENSION_NAME
 	};
 
+	// VK_KHR_dynamic_rendering and what it depends on with a vulkan 1.0 instance
+	static Na::ArrayList<const char*> dynamicRenderingDeviceExtensions = {
+		VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+		VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+		VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+		VK_KHR_MULTIVIEW_EXTENSION_NAME,
+		VK_KHR_MAINTENANCE2_EXTENSION_NAME
+	};
+	static Na::ArrayList<const char*> descriptorIndexingDeviceExtensions = {
+		VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME,
+		VK_KHR_MAINTENANCE3_EXTENSION_NAME
+	};
+	static bool physicalDeviceProperties2Enabled = false;
+
+	// enumerated once per device while initializing, picking and creating the device ask a lot
+	static std::unordered_map<VkPhysicalDevice, std::set<std::string, std::less<>>> deviceExtensionCache;
+	static bool headlessEnabled = false; // no surface, so no swapchain either
+
+	static bool isExtensionRequired(const char* extension)
+	{
+		return !headlessEnabled || strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+
 	vk::SurfaceKHR createWindowSurface(GLFWwindow* window)
 	{
 		VkSurfaceKHR surface;
@@ -111,7 +134,7 @@ namespace Na {
 		for (u32 i = 0; const auto& property : properties)
 		{
 			if (property.queueFlags & vk::QueueFlagBits::eGraphics)
-				if (device.getSurfaceSupportKHR(i, surface))
+				if (!surface || device.getSurfaceSupportKHR(i, surface))
 					indices.graphics = i;
 
 			if (indices)
@@ -120,18 +143,70 @@ namespace Na {
 			i++;
 		}
 
+		if (!indices)
+			return indices;
+
+		// prefer a dedicated dma family, then any family without graphics
+		for (u32 i = 0; const auto& property : properties)
+		{
+			bool transfer = (bool)(property.queueFlags & vk::QueueFlagBits::eTransfer);
+			bool graphics = (bool)(property.queueFlags & vk::QueueFlagBits::eGraphics);
+			bool compute  = (bool)(property.queueFlags & vk::QueueFlagBits::eCompute);
+
+			if (transfer && !graphics && !compute)
+			{
+				indices.transfer = i;
+				break;
+			}
+
+			if (transfer && !graphics && indices.transfer == UINT32_MAX)
+				indices.transfer = i;
+
+			i++;
+		}
+
+		if (indices.transfer == UINT32_MAX)
+			indices.transfer = indices.graphics;
+
+		for (u32 i = 0; const auto& property : properties)
+		{
+			if ((property.queueFlags & vk::QueueFlagBits::eCompute) && !(property.queueFlags & vk::QueueFlagBits::eGraphics))
+			{
+				indices.compute = i;
+				break;
+			}
+
+			i++;
+		}
+
+		if (indices.compute == UINT32_MAX)
+			indices.compute = indices.graphics;
+
 		return indices;
 	}
 
-	static bool areRequiredDeviceExtensionsSupported(vk::PhysicalDevice device)
+	static const std::set<std::string, std::less<>>& getDeviceExtensions(vk::PhysicalDevice device)
 	{
-		auto available_extensions = device.enumerateDeviceExtensionProperties();
-        std::set<std::string_view> required_extensions(requiredDeviceExtensions.begin(), requiredDeviceExtensions.end());
+		auto [it, inserted] = deviceExtensionCache.try_emplace((VkPhysicalDevice)device);
+		if (inserted)
+			for (const auto& extension : device.enumerateDeviceExtensionProperties())
+				it->second.emplace(extension.extensionName.data());
 
-        for (const auto& extension : available_extensions)
-            required_extensions.erase(extension.extensionName);
+		return it->second;
+	}
+
+	static bool isDeviceExtensionSupported(vk::PhysicalDevice device, std::string_view name)
+	{
+		return getDeviceExtensions(device).contains(name);
+	}
+
+	static bool areRequiredDeviceExtensionsSupported(vk::PhysicalDevice device)
+	{
+		for (const char* extension : requiredDeviceExtensions)
+			if (isExtensionRequired(extension) && !isDeviceExtensionSupported(device, extension))
+				return false;
 
-		return required_extensions.empty();
+		return true;
 	}
 
 	SurfaceSupport SurfaceSupport::Get(vk::SurfaceKHR surface, vk::PhysicalDevice device)
@@ -147,8 +222,8 @@ namespace Na {
 
 		u32 present_mode_count;
 		(void)device.getSurfacePresentModesKHR(surface, &present_mode_count, nullptr);
-		support.present_modes.resize(format_count);
-		(void)device.getSurfacePresentModesKHR(surface, &format_count, support.present_modes.ptr());
+		support.present_modes.resize(present_mode_count);
+		(void)device.getSurfacePresentModesKHR(surface, &present_mode_count, support.present_modes.ptr());
 
 		return support;
 	}
@@ -173,7 +248,7 @@ namespace Na {
 		if (!areRequiredDeviceExtensionsSupported(device))
 			return 0;
 
-		if (!SurfaceSupport::Get(surface, device))
+		if (surface && !SurfaceSupport::Get(surface, device))
 			return 0;
 
 		if (properties.deviceType == vk::PhysicalDeviceType::eDiscreteGpu)
@@ -182,6 +257,14 @@ namespace Na {
 		return properties.limits.maxImageDimension2D;
 	}
 
+	static bool isInstanceExtensionSupported(std::string_view name)
+	{
+		for (const auto& extension : vk::enumerateInstanceExtensionProperties())
+			if (name == extension.extensionName)
+				return true;
+		return false;
+	}
+
 	static vk::Instance createInstance(void)
 	{
 		if (k_ValidationLayersEnabled && !validationLayersSupported())
@@ -193,13 +276,18 @@ namespace Na {
 		vk::InstanceCreateInfo create_info;
 		create_info.pApplicationInfo = &app_info;
 
+		// the surface extensions, glfw is not initialized without a display
 		u32 required_extension_count = 0;
-		const char** required_extensions = glfwGetRequiredInstanceExtensions(&required_extension_count);
+		const char** required_extensions = headlessEnabled ? nullptr : glfwGetRequiredInstanceExtensions(&required_extension_count);
 
 		extensions.reallocate(required_extension_count);
 		for (u32 i = 0; i < required_extension_count; i++)
 			extensions.emplace(required_extensions[i]);
 
+		physicalDeviceProperties2Enabled = isInstanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+		if (physicalDeviceProperties2Enabled)
+			extensions.emplace(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
 		vk::DebugUtilsMessengerCreateInfoEXT debug_create_info;
 		if (k_ValidationLayersEnabled)
 		{
@@ -255,9 +343,8 @@ namespace Na {
 		return chosen_device;
 	}
 
-	static vk::SampleCountFlagBits getMaxSampleCount(vk::PhysicalDevice physical_device)
+	static vk::SampleCountFlagBits getMaxSampleCount(const vk::PhysicalDeviceProperties& properties)
 	{
-		vk::PhysicalDeviceProperties properties = physical_device.getProperties();
 		vk::SampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
 
 		if (counts & vk::SampleCountFlagBits::e64) return vk::SampleCountFlagBits::e64;
@@ -280,69 +367,428 @@ namespace Na {
 		return create_info;
 	}
 
-	static vk::Device createLogicalDevice(vk::PhysicalDevice physical_device, QueueFamilyIndices queue_indices, vk::Queue& queue)
+	// zeroed without VK_KHR_get_physical_device_properties2 or VK_EXT_descriptor_indexing
+	static vk::PhysicalDeviceDescriptorIndexingFeaturesEXT getDescriptorIndexingFeatures(vk::PhysicalDevice physical_device)
+	{
+		vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features;
+		if (!physicalDeviceProperties2Enabled || !isDeviceExtensionSupported(physical_device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+			return indexing_features;
+
+		auto func = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(VkContext::GetInstance(), "vkGetPhysicalDeviceFeatures2KHR");
+		if (!func)
+			return indexing_features;
+
+		vk::PhysicalDeviceFeatures2KHR features;
+		features.pNext = &indexing_features;
+		func(physical_device, (VkPhysicalDeviceFeatures2*)&features);
+
+		indexing_features.pNext = nullptr;
+		return indexing_features;
+	}
+
+	// zeroed without VK_KHR_get_physical_device_properties2 or VK_KHR_timeline_semaphore
+	static vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR getTimelineSemaphoreFeatures(vk::PhysicalDevice physical_device)
+	{
+		vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features;
+		if (!physicalDeviceProperties2Enabled || !isDeviceExtensionSupported(physical_device, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+			return timeline_features;
+
+		auto func = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(VkContext::GetInstance(), "vkGetPhysicalDeviceFeatures2KHR");
+		if (!func)
+			return timeline_features;
+
+		vk::PhysicalDeviceFeatures2KHR features;
+		features.pNext = &timeline_features;
+		func(physical_device, (VkPhysicalDeviceFeatures2*)&features);
+
+		timeline_features.pNext = nullptr;
+		return timeline_features;
+	}
+
+	// zeroed without VK_KHR_get_physical_device_properties2 or VK_KHR_synchronization2
+	static vk::PhysicalDeviceSynchronization2FeaturesKHR getSynchronization2Features(vk::PhysicalDevice physical_device)
+	{
+		vk::PhysicalDeviceSynchronization2FeaturesKHR sync2_features;
+		if (!physicalDeviceProperties2Enabled || !isDeviceExtensionSupported(physical_device, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+			return sync2_features;
+
+		auto func = (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(VkContext::GetInstance(), "vkGetPhysicalDeviceFeatures2KHR");
+		if (!func)
+			return sync2_features;
+
+		vk::PhysicalDeviceFeatures2KHR features;
+		features.pNext = &sync2_features;
+		func(physical_device, (VkPhysicalDeviceFeatures2*)&features);
+
+		sync2_features.pNext = nullptr;
+		return sync2_features;
+	}
+
+	static vk::Device createLogicalDevice(
+		vk::PhysicalDevice physical_device,
+		QueueFamilyIndices queue_indices,
+		vk::Queue& queue,
+		vk::Queue& transfer_queue,
+		vk::Queue& compute_queue,
+		DeviceFeatures& features
+	)
 	{
 		Na::ArrayList<vk::DeviceQueueCreateInfo> queue_create_infos;
 		queue_create_infos.emplace(createQueueCreateInfo(queue_indices.graphics));
+		if (queue_indices.transfer != queue_indices.graphics)
+			queue_create_infos.emplace(createQueueCreateInfo(queue_indices.transfer));
+		if (queue_indices.compute != queue_indices.graphics && queue_indices.compute != queue_indices.transfer)
+			queue_create_infos.emplace(createQueueCreateInfo(queue_indices.compute));
 
 		vk::DeviceCreateInfo create_info;
 
 		create_info.queueCreateInfoCount = (u32)queue_create_infos.size();
 		create_info.pQueueCreateInfos = queue_create_infos.ptr();
 
+		vk::PhysicalDeviceFeatures supported_features = physical_device.getFeatures();
+		features.multi_draw_indirect = supported_features.multiDrawIndirect;
+		features.draw_indirect_first_instance = supported_features.drawIndirectFirstInstance;
+		features.pipeline_statistics_query = supported_features.pipelineStatisticsQuery;
+
 		vk::PhysicalDeviceFeatures device_features{};
 		device_features.samplerAnisotropy = VK_TRUE;
 		device_features.sampleRateShading = VK_TRUE;
+		device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+		device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+		device_features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
 		create_info.pEnabledFeatures = &device_features;
 
-		create_info.enabledExtensionCount = (u32)requiredDeviceExtensions.size();
-		create_info.ppEnabledExtensionNames = requiredDeviceExtensions.ptr();
+		Na::ArrayList<const char*> device_extensions;
+		for (const char* extension : requiredDeviceExtensions)
+			if (isExtensionRequired(extension))
+				device_extensions.emplace(extension);
+
+		features.draw_indirect_count = isDeviceExtensionSupported(physical_device, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		if (features.draw_indirect_count)
+			device_extensions.emplace(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+		// the feature has to be supported whenever the extension is
+		features.dynamic_rendering = physicalDeviceProperties2Enabled;
+		for (const char* extension : dynamicRenderingDeviceExtensions)
+			features.dynamic_rendering = features.dynamic_rendering && isDeviceExtensionSupported(physical_device, extension);
+
+		vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_features;
+		if (features.dynamic_rendering)
+		{
+			for (const char* extension : dynamicRenderingDeviceExtensions)
+				device_extensions.emplace(extension);
+
+			dynamic_rendering_features.dynamicRendering = VK_TRUE;
+			dynamic_rendering_features.pNext = (void*)create_info.pNext;
+			create_info.pNext = &dynamic_rendering_features;
+		}
+
+		vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features = getDescriptorIndexingFeatures(physical_device);
+		features.descriptor_indexing = physicalDeviceProperties2Enabled;
+		for (const char* extension : descriptorIndexingDeviceExtensions)
+			features.descriptor_indexing = features.descriptor_indexing && isDeviceExtensionSupported(physical_device, extension);
+		features.descriptor_indexing = features.descriptor_indexing &&
+			descriptor_indexing_features.runtimeDescriptorArray &&
+			descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing &&
+			descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+			descriptor_indexing_features.descriptorBindingStorageBufferUpdateAfterBind &&
+			descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending &&
+			descriptor_indexing_features.descriptorBindingPartiallyBound;
+
+		if (features.descriptor_indexing)
+		{
+			for (const char* extension : descriptorIndexingDeviceExtensions)
+				device_extensions.emplace(extension);
+
+			// enables exactly what the physical device reported
+			descriptor_indexing_features.pNext = (void*)create_info.pNext;
+			create_info.pNext = &descriptor_indexing_features;
+		}
+
+		vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features = getTimelineSemaphoreFeatures(physical_device);
+		features.timeline_semaphore = timeline_features.timelineSemaphore;
+		if (features.timeline_semaphore)
+		{
+			device_extensions.emplace(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+			timeline_features.pNext = (void*)create_info.pNext;
+			create_info.pNext = &timeline_features;
+		}
+
+		vk::PhysicalDeviceSynchronization2FeaturesKHR sync2_features = getSynchronization2Features(physical_device);
+		features.synchronization2 = sync2_features.synchronization2;
+		if (features.synchronization2)
+		{
+			device_extensions.emplace(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+			sync2_features.pNext = (void*)create_info.pNext;
+			create_info.pNext = &sync2_features;
+		}
+
+		features.memory_budget = physicalDeviceProperties2Enabled && isDeviceExtensionSupported(physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		if (features.memory_budget)
+			device_extensions.emplace(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		create_info.enabledExtensionCount = (u32)device_extensions.size();
+		create_info.ppEnabledExtensionNames = device_extensions.ptr();
 
 		vk::Device device = physical_device.createDevice(create_info);
 		queue = device.getQueue(queue_indices.graphics, 0);
+		transfer_queue = device.getQueue(queue_indices.transfer, 0);
+		compute_queue = device.getQueue(queue_indices.compute, 0);
 
 		return device;
 	}
 
-	static vk::CommandPool createSingleTimeCmdPool(vk::Device device, QueueFamilyIndices indices)
+	// prefixed to the driver's data, the driver validates its own header as well
+	// but some do not check the driver version
+	struct PipelineCacheHeader {
+		u32 magic;
+		u32 vendor_id;
+		u32 device_id;
+		u32 driver_version;
+		u8 uuid[VK_UUID_SIZE];
+		u64 data_size;
+	};
+	static constexpr u32 k_PipelineCacheMagic = 0x4350414e; // "NAPC"
+
+	static PipelineCacheHeader getPipelineCacheHeader(const vk::PhysicalDeviceProperties& properties, u64 data_size)
+	{
+		PipelineCacheHeader header{};
+		header.magic = k_PipelineCacheMagic;
+		header.vendor_id = properties.vendorID;
+		header.device_id = properties.deviceID;
+		header.driver_version = properties.driverVersion;
+		memcpy(header.uuid, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+		header.data_size = data_size;
+
+		return header;
+	}
+
+	static std::vector<Byte> loadPipelineCacheData(const vk::PhysicalDeviceProperties& properties, const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return {};
+
+		u64 file_size = (u64)file.tellg();
+		file.seekg(0);
+
+		PipelineCacheHeader header{};
+		if (file_size < sizeof(header) || !file.read((char*)&header, sizeof(header)))
+			return {};
+
+		PipelineCacheHeader expected = getPipelineCacheHeader(properties, file_size - sizeof(header));
+		if (memcmp(&header, &expected, sizeof(header)))
+		{
+			g_Logger(Info, "Discarding pipeline cache written for a different device or driver!");
+			return {};
+		}
+
+		std::vector<Byte> data(header.data_size);
+		if (!file.read((char*)data.data(), data.size()))
+			return {};
+
+		return data;
+	}
+
+	static vk::PipelineCache createPipelineCache(const vk::PhysicalDeviceProperties& properties, vk::Device device, const std::filesystem::path& path)
+	{
+		std::vector<Byte> data;
+		if (!path.empty())
+			data = loadPipelineCacheData(properties, path);
+
+		vk::PipelineCacheCreateInfo create_info;
+		create_info.initialDataSize = data.size();
+		create_info.pInitialData = data.data();
+
+		return device.createPipelineCache(create_info);
+	}
+
+	struct VkContext::QueueLocks {
+		std::mutex graphics;
+		std::mutex transfer;
+		std::mutex compute;
+	};
+
+	std::unique_lock<std::mutex> VkContext::QueueLock(vk::Queue queue)
+	{
+		QueueLocks& locks = *s_Context->m_QueueLocks;
+
+		// without a family of their own the transfer and compute queues are the graphics queue
+		// (or each other), the first match makes them share its lock
+		if (queue == s_Context->m_GraphicsQueue)
+			return std::unique_lock(locks.graphics);
+		if (queue == s_Context->m_TransferQueue)
+			return std::unique_lock(locks.transfer);
+
+		NA_ASSERT(queue == s_Context->m_ComputeQueue, "Failed to lock queue: Not a queue of the context!");
+		return std::unique_lock(locks.compute);
+	}
+
+	struct VkContext::FormatCache {
+		std::mutex mutex;
+		std::unordered_map<VkFormat, vk::FormatProperties> properties;
+	};
+
+	vk::FormatProperties VkContext::GetFormatProperties(vk::Format format)
+	{
+		FormatCache& cache = *s_Context->m_FormatCache;
+
+		std::lock_guard lock(cache.mutex);
+
+		auto [it, inserted] = cache.properties.try_emplace((VkFormat)format);
+		if (inserted)
+			it->second = s_Context->m_PhysicalDevice.getFormatProperties(format);
+
+		return it->second;
+	}
+
+	vk::SampleCountFlagBits VkContext::PickMSAASamples(u32 samples)
 	{
-		vk::CommandPoolCreateInfo single_time_pool_info;
-		single_time_pool_info.queueFamilyIndex = indices.graphics;
-		single_time_pool_info.flags = vk::CommandPoolCreateFlagBits::eTransient;
+		if (!samples || samples >= (u32)s_Context->m_MSAASamples)
+			return s_Context->m_MSAASamples;
+
+		const vk::PhysicalDeviceLimits& limits = s_Context->m_Properties.limits;
+		vk::SampleCountFlags counts = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
 
-		return device.createCommandPool(single_time_pool_info);
+		// the flag bits are the counts themselves
+		for (u32 count = std::bit_floor(samples); count > 1; count >>= 1)
+			if (counts & (vk::SampleCountFlagBits)count)
+				return (vk::SampleCountFlagBits)count;
+
+		return vk::SampleCountFlagBits::e1;
 	}
 
-	VkContext VkContext::Initialize(void)
+	VkContext VkContext::Initialize(const std::filesystem::path& pipeline_cache_path, const ContextSettings& settings)
 	{
+		bool headless = settings.headless;
+
 		VkContext context;
 		s_Context = &context;
 
-		g_Logger(Info, "Initializing vulkan!");
+		g_Logger(Info, headless ? "Initializing vulkan headless!" : "Initializing vulkan!");
+
+		headlessEnabled = headless;
+		context.m_Headless = headless;
 
 		context.m_Instance = createInstance();
 		context.m_DebugMessenger = createDebugMessenger(context.m_Instance);
 
-		GLFWwindow* temp_window = glfwCreateWindow(1, 1, "", nullptr, nullptr);
-		vk::SurfaceKHR temp_surface = createWindowSurface(temp_window);
+		// the device has to present to a surface like the windows' ones, unless headless
+		GLFWwindow* temp_window = nullptr;
+		vk::SurfaceKHR temp_surface = nullptr;
+		if (!headless)
+		{
+			temp_window = glfwCreateWindow(1, 1, "", nullptr, nullptr);
+			temp_surface = createWindowSurface(temp_window);
+		}
 
 		context.m_PhysicalDevice = pickPhysicalDevice(context.m_Instance, temp_surface);
-		auto queue_indices = QueueFamilyIndices::Get(context.m_PhysicalDevice, temp_surface);
+		context.m_Properties = context.m_PhysicalDevice.getProperties();
+		context.m_MemoryProperties = context.m_PhysicalDevice.getMemoryProperties();
+		context.m_QueueFamilyProperties = new std::vector<vk::QueueFamilyProperties>(context.m_PhysicalDevice.getQueueFamilyProperties());
+		context.m_FormatCache = new FormatCache;
+		context.m_QueueLocks = new QueueLocks;
 
-		context.m_MSAASamples = getMaxSampleCount(context.m_PhysicalDevice);
-		context.m_LogicalDevice = createLogicalDevice(context.m_PhysicalDevice, queue_indices, context.m_GraphicsQueue);
-		context.m_SingleTimeCmdPool = createSingleTimeCmdPool(context.m_LogicalDevice, queue_indices);
+		auto queue_indices = QueueFamilyIndices::Get(context.m_PhysicalDevice, temp_surface);
+		context.m_QueueIndices = queue_indices;
+
+		context.m_MSAASamples = getMaxSampleCount(context.m_Properties);
+		context.m_LogicalDevice = createLogicalDevice(
+			context.m_PhysicalDevice,
+			queue_indices,
+			context.m_GraphicsQueue,
+			context.m_TransferQueue,
+			context.m_ComputeQueue,
+			context.m_Features
+		);
+		if (queue_indices.compute == queue_indices.graphics)
+			g_Logger(Info, "No compute family without graphics, compute work is submitted with the graphics queue");
+		else if (queue_indices.compute == queue_indices.transfer)
+			g_Logger(Info, "Compute and transfer share a queue family, their submits share one queue lock");
+		if (context.m_Features.draw_indirect_count)
+			context.m_CmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)context.m_LogicalDevice.getProcAddr("vkCmdDrawIndexedIndirectCountKHR");
+		if (context.m_Features.dynamic_rendering)
+		{
+			context.m_CmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)context.m_LogicalDevice.getProcAddr("vkCmdBeginRenderingKHR");
+			context.m_CmdEndRendering = (PFN_vkCmdEndRenderingKHR)context.m_LogicalDevice.getProcAddr("vkCmdEndRenderingKHR");
+		}
+		if (context.m_Features.timeline_semaphore)
+		{
+			context.m_WaitSemaphores = (PFN_vkWaitSemaphoresKHR)context.m_LogicalDevice.getProcAddr("vkWaitSemaphoresKHR");
+			context.m_GetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)context.m_LogicalDevice.getProcAddr("vkGetSemaphoreCounterValueKHR");
+		}
+		if (context.m_Features.synchronization2)
+			context.m_CmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)context.m_LogicalDevice.getProcAddr("vkCmdPipelineBarrier2KHR");
+		context.m_PipelineCachePath = new std::filesystem::path(pipeline_cache_path);
+		context.m_PipelineCache = createPipelineCache(context.m_Properties, context.m_LogicalDevice, pipeline_cache_path);
+		PFN_vkGetPhysicalDeviceMemoryProperties2KHR get_memory_properties2 = nullptr;
+		if (context.m_Features.memory_budget)
+			get_memory_properties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(context.m_Instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+		context.m_DeviceAllocator = new DeviceAllocator(
+			context.m_PhysicalDevice,
+			context.m_LogicalDevice,
+			DeviceAllocator::k_DefaultBlockSize,
+			get_memory_properties2
+		);
+		context.m_UploadManager = new UploadManager(UploadManager::k_DefaultStagingSize);
+		context.m_DeletionQueue = new DeletionQueue;
+		context.m_ImmediateCommands = new ImmediateCommands(queue_indices.graphics, context.m_GraphicsQueue);
+		context.m_SamplerCache = new SamplerCache;
+		if (settings.bindless && context.m_Features.descriptor_indexing)
+			context.m_BindlessTable = new BindlessTable(BindlessTable::k_DefaultTextureCapacity, BindlessTable::k_DefaultStorageBufferCapacity);
+
+		if (!headless)
+		{
+			vkDestroySurfaceKHR(context.m_Instance, temp_surface, nullptr);
+			glfwDestroyWindow(temp_window);
+		}
 
-		vkDestroySurfaceKHR(context.m_Instance, temp_surface, nullptr);
-		glfwDestroyWindow(temp_window);
+		deviceExtensionCache.clear();
 
 		return context;
 	}
 
 	void VkContext::Shutdown(void)
 	{
-		if (s_Context->m_SingleTimeCmdPool)
-			s_Context->m_LogicalDevice.destroyCommandPool(s_Context->m_SingleTimeCmdPool);
+		// deferred bindless index releases still refer to the table
+		if (s_Context->m_DeletionQueue)
+		{
+			QueueLocks& locks = *s_Context->m_QueueLocks;
+			std::scoped_lock lock(locks.graphics, locks.transfer, locks.compute);
+			s_Context->m_LogicalDevice.waitIdle();
+			s_Context->m_DeletionQueue->flush();
+		}
+
+		delete s_Context->m_BindlessTable;
+		delete s_Context->m_UploadManager;
+
+		// anything the two above pushed is freed too, before the allocator goes
+		if (s_Context->m_DeletionQueue)
+		{
+			{
+				QueueLocks& locks = *s_Context->m_QueueLocks;
+				std::scoped_lock lock(locks.graphics, locks.transfer, locks.compute);
+				s_Context->m_LogicalDevice.waitIdle();
+			}
+			delete s_Context->m_DeletionQueue;
+			s_Context->m_DeletionQueue = nullptr;
+		}
+		delete s_Context->m_DeviceAllocator;
+		delete s_Context->m_SamplerCache;
+
+		if (s_Context->m_PipelineCache)
+		{
+			VkContext::SavePipelineCache();
+			s_Context->m_LogicalDevice.destroyPipelineCache(s_Context->m_PipelineCache);
+		}
+		delete s_Context->m_PipelineCachePath;
+
+		delete s_Context->m_ImmediateCommands;
+		delete s_Context->m_QueueFamilyProperties;
+		delete s_Context->m_FormatCache;
+		delete s_Context->m_QueueLocks;
 
 		if (s_Context->m_LogicalDevice)
 			s_Context->m_LogicalDevice.destroy();
@@ -356,36 +802,64 @@ namespace Na {
 		s_Context = nullptr;
 	}
 
-	vk::CommandBuffer VkContext::BeginSingleTimeCommands(void)
+	void VkContext::WaitForRemainingDeviceTasks(void)
+	{
+		{
+			// waiting for the device idle accesses every queue
+			QueueLocks& locks = *s_Context->m_QueueLocks;
+			std::scoped_lock lock(locks.graphics, locks.transfer, locks.compute);
+			s_Context->m_LogicalDevice.waitIdle();
+		}
+		s_Context->m_DeletionQueue->flush();
+	}
+
+	void VkContext::SavePipelineCache(void)
 	{
-		vk::CommandBufferAllocateInfo alloc_info;
-		alloc_info.level = vk::CommandBufferLevel::ePrimary;
-		alloc_info.commandPool = s_Context->m_SingleTimeCmdPool;
-		alloc_info.commandBufferCount = 1;
+		const std::filesystem::path& path = *s_Context->m_PipelineCachePath;
+		if (path.empty())
+			return;
 
-		vk::CommandBuffer cmd_buffer;
-		(void)VkContext::GetLogicalDevice().allocateCommandBuffers(&alloc_info, &cmd_buffer);
+		std::vector<u8> data = s_Context->m_LogicalDevice.getPipelineCacheData(s_Context->m_PipelineCache);
+		PipelineCacheHeader header = getPipelineCacheHeader(s_Context->m_Properties, data.size());
 
-		vk::CommandBufferBeginInfo begin_info;
-		begin_info.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		// written next to it first, so an interrupted save never leaves a truncated cache behind
+		std::filesystem::path temp_path = path;
+		temp_path += ".tmp";
 
-		cmd_buffer.begin(begin_info);
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				g_Logger.fmt(Warn, "Failed to save pipeline cache to {}: Could not open file!", path.string());
+				return;
+			}
+
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)data.data(), data.size());
+		}
 
-		return cmd_buffer;
+		std::error_code error;
+		std::filesystem::rename(temp_path, path, error);
+		if (error)
+			g_Logger.fmt(Warn, "Failed to save pipeline cache to {}: {}!", path.string(), error.message());
 	}
 
-	void VkContext::EndSingleTimeCommands(vk::CommandBuffer cmd_buffer)
+	vk::CommandBuffer VkContext::BeginSingleTimeCommands(void)
 	{
-		cmd_buffer.end();
+		// recorded into the open batch, submitted with it
+		if (ImmediateBatch* batch = ImmediateBatch::Current())
+			return batch->cmd_buffer();
 
-		vk::SubmitInfo submit_info;
-		submit_info.commandBufferCount = 1;
-		submit_info.pCommandBuffers = &cmd_buffer;
+		return s_Context->m_ImmediateCommands->begin();
+	}
 
-		(void)VkContext::GetGraphicsQueue().submit(1, &submit_info, nullptr);
-		VkContext::GetGraphicsQueue().waitIdle();
+	void VkContext::EndSingleTimeCommands(vk::CommandBuffer cmd_buffer)
+	{
+		ImmediateBatch* batch = ImmediateBatch::Current();
+		if (batch && batch->cmd_buffer() == cmd_buffer)
+			return;
 
-		VkContext::GetLogicalDevice().freeCommandBuffers(s_Context->m_SingleTimeCmdPool, 1, &cmd_buffer);
+		s_Context->m_ImmediateCommands->submit(cmd_buffer);
 	}
 
 	VkContext::VkContext(VkContext&& other)
@@ -1,71 +1,389 @@
 #include "Pch.hpp"
 #include "Natrium/Layers/LayerManager.hpp"
 
+#include "Natrium/Core/JobSystem.hpp"
+
 namespace Na {
+	// undeclared layers conflict with everything, so they keep the old serial order
+	static inline bool updatesConflict(const Layer& a, const Layer& b)
+	{
+		if (!a.update_access() || !b.update_access())
+			return true;
+
+		return a.update_access()->conflicts(*b.update_access());
+	}
+
+	// descending priority, stable algorithms keep attach order for equal ones
+	static inline bool higherPriority(const LayerHandle<>& a, const LayerHandle<>& b)
+	{
+		return a->priority() > b->priority();
+	}
+
+	// defers changes to the layers for as long as it lives
+	class IterationScope {
+	public:
+		inline IterationScope(u32& depth) : m_Depth(depth) { m_Depth++; }
+		inline ~IterationScope(void) { m_Depth--; }
+	private:
+		u32& m_Depth;
+	};
+
 	void LayerManager::resort(void)
 	{
-		for (u64 i = 0; i < m_Layers.size() - 1; i++)
+		this->_compact();
+		std::stable_sort(m_Layers.ptr(), m_Layers.ptr() + m_Layers.size(), higherPriority);
+		this->_reindex(0);
+	}
+
+	void LayerManager::attach_layer(LayerHandle<> layer)
+	{
+		NA_ASSERT(layer->m_State == Layer::State::Detached, "Layer is already attached!");
+
+		if (m_IterationDepth)
 		{
-			for (u64 j = 0; j < m_Layers.size() - i - 1; j++)
+			layer->m_State = Layer::State::PendingAttach;
+			m_PendingAttach.emplace(std::move(layer));
+			return;
+		}
+
+		layer->on_attach();
+		this->_insert(std::move(layer));
+	}
+
+	void LayerManager::detach_layer(const LayerHandle<>& layer)
+	{
+		switch (layer->m_State)
+		{
+		case Layer::State::PendingAttach:
+		{
+			// never attached, so on_attach and on_detach are both skipped
+			for (u64 i = 0; i < m_PendingAttach.size(); i++)
+			{
+				if (m_PendingAttach[i] != layer)
+					continue;
+
+				layer->m_State = Layer::State::Detached;
+				std::move(m_PendingAttach.ptr() + i + 1, m_PendingAttach.ptr() + m_PendingAttach.size(), m_PendingAttach.ptr() + i);
+				m_PendingAttach.pop();
+				return;
+			}
+			break;
+		}
+		case Layer::State::Attached:
+		{
+			NA_ASSERT(layer->m_Index < m_Layers.size() && m_Layers[layer->m_Index] == layer, "Failed to find layer in LayerManager!");
+
+			if (m_IterationDepth)
 			{
-				if (m_Layers[j]->priority() < m_Layers[j + 1]->priority())
+				layer->m_State = Layer::State::PendingDetach;
+				m_PendingDetachCount++;
+				return;
+			}
+
+			layer->on_detach();
+			this->_erase(layer->m_Index);
+			return;
+		}
+		case Layer::State::PendingDetach:
+			return;
+		default:
+			break;
+		}
+
+		NA_ASSERT(false, "Failed to find layer in LayerManager!");
+	}
+
+	void LayerManager::detach_all(void)
+	{
+		for (LayerHandle<>& layer : m_PendingAttach)
+			layer->m_State = Layer::State::Detached;
+		m_PendingAttach.clear();
+
+		if (m_IterationDepth)
+		{
+			for (LayerHandle<>& layer : m_Layers)
+			{
+				if (layer && layer->m_State == Layer::State::Attached)
 				{
-					std::swap(m_Layers[j], m_Layers[j + 1]);
+					layer->m_State = Layer::State::PendingDetach;
+					m_PendingDetachCount++;
 				}
 			}
+			return;
+		}
+
+		// skips the listeners of the current dispatch, if there is one
+		m_EventBus.clear();
+
+		for (u64 i = 0; i < m_Layers.size(); i++)
+		{
+			if (!m_Layers[i])
+				continue;
+
+			m_Layers[i]->m_Subscription = {};
+			m_Layers[i]->on_detach();
+			m_Layers[i]->m_State = Layer::State::Detached;
+			m_Layers[i]->m_Index = k_U64Max;
 		}
+		m_Layers.clear();
+		m_PendingDetachCount = 0;
+		m_EmptySlotCount = 0;
+		m_EventBusDirty = true;
 	}
 
-	void LayerManager::attach_layer(LayerHandle<> layer)
+	void LayerManager::set_layer_priority(const LayerHandle<>& layer, i64 new_priority)
 	{
-		layer->on_attach();
+		if (layer->m_Priority == new_priority)
+			return;
+
+		if (layer->m_State != Layer::State::Attached || m_IterationDepth)
+		{
+			layer->m_Priority = new_priority;
+			m_PendingResort |= layer->m_State != Layer::State::Detached && layer->m_State != Layer::State::PendingAttach;
+			return;
+		}
 
-		m_Layers.emplace(layer);
-		this->resort();
+		LayerHandle<> handle = layer; // m_Layers held the last reference the caller may have passed
+		this->_erase(layer->m_Index);
+		handle->m_Priority = new_priority;
+		this->_insert(std::move(handle));
 	}
 
-	void LayerManager::detach_layer(LayerHandle<> layer)
+	void LayerManager::set_layer_event_types(const LayerHandle<>& layer, EventTypeMask event_types)
 	{
-		layer->on_detach();
+		layer->m_EventTypes = event_types;
+		m_EventBusDirty = true;
+	}
 
-		if (m_Layers.size() == 1)
+	void LayerManager::apply_pending(void)
+	{
+		NA_ASSERT(!m_IterationDepth, "LayerManager::apply_pending called while iterating the layers!");
+		if (!this->has_pending())
+			return;
+
+		// what on_attach changes waits for the next call
+		IterationScope scope(m_IterationDepth);
+
+		// on_detach may detach more layers, those behind the current one are caught by the
+		// same pass, the ones in front of it by the next, the empty slots go with the first
+		while (m_PendingDetachCount || m_EmptySlotCount)
 		{
-			m_Layers.pop();
+			u64 kept = 0;
+			for (u64 i = 0; i < m_Layers.size(); i++)
+			{
+				LayerHandle<>& layer = m_Layers[i];
+				if (!layer)
+				{
+					m_EmptySlotCount--;
+					continue;
+				}
+
+				if (layer->m_State == Layer::State::PendingDetach)
+				{
+					m_PendingDetachCount--;
+					this->_unsubscribe(*layer);
+					layer->on_detach();
+					layer->m_State = Layer::State::Detached;
+					layer->m_Index = k_U64Max;
+					layer.reset();
+					continue;
+				}
+
+				// kept current, on_detach may look the moved layers up
+				if (kept != i)
+				{
+					m_Layers[kept] = std::move(layer);
+					m_Layers[kept]->m_Index = kept;
+				}
+				kept++;
+			}
+
+			while (m_Layers.size() > kept)
+				m_Layers.pop();
+		}
+
+		if (m_PendingResort)
+		{
+			std::stable_sort(m_Layers.ptr(), m_Layers.ptr() + m_Layers.size(), higherPriority);
+			m_PendingResort = false;
+		}
+
+		if (!m_PendingAttach.empty())
+		{
+			ArrayList<LayerHandle<>> attached = std::move(m_PendingAttach);
+
+			u64 middle = m_Layers.size();
+			m_Layers.reserve(attached.size());
+			for (LayerHandle<>& layer : attached)
+			{
+				layer->m_State = Layer::State::Attached;
+				m_Layers.emplace(layer);
+			}
+
+			// equal priorities keep the already attached layers first
+			LayerHandle<>* layers = m_Layers.ptr();
+			std::stable_sort(layers + middle, layers + m_Layers.size(), higherPriority);
+			std::inplace_merge(layers, layers + middle, layers + m_Layers.size(), higherPriority);
+			this->_reindex(0);
+
+			// in place already, so they may detach themselves
+			for (LayerHandle<>& layer : attached)
+				layer->on_attach();
 			return;
 		}
 
-		u64 i;
-		for (i = 0; i < m_Layers.size(); i++)
-			if (m_Layers[i] == layer)
-				break;
+		this->_reindex(0);
+	}
 
-		NA_ASSERT(i < m_Layers.size(), "Failed to find layer in LayerManager!");
+	void LayerManager::update(double dt)
+	{
+		this->apply_pending();
+
+		IterationScope scope(m_IterationDepth);
 
-		if (i == m_Layers.size() - 1)
+		auto run_update = [this, dt](void)
 		{
-			m_Layers.pop();
-			return;
+			if (m_UpdateRun.size() == 1)
+			{
+				m_UpdateRun[0]->update(dt);
+				return;
+			}
+
+			JobSystem& job_system = JobSystem::Get();
+
+			JobCounter counter;
+			for (u64 i = 1; i < m_UpdateRun.size(); i++)
+				job_system.run([layer = m_UpdateRun[i], dt](void) { layer->update(dt); }, &counter);
+
+			// the calling thread takes the first one
+			try
+			{
+				m_UpdateRun[0]->update(dt);
+			} catch (...)
+			{
+				job_system.wait(counter);
+				throw;
+			}
+			job_system.wait(counter);
+		};
+
+		m_UpdateRun.clear();
+		for (LayerHandle<>& layer : m_Layers)
+		{
+			if (!layer || layer->m_State != Layer::State::Attached)
+				continue;
+
+			bool conflict = false;
+			for (Layer* other : m_UpdateRun)
+			{
+				if (updatesConflict(*layer, *other))
+				{
+					conflict = true;
+					break;
+				}
+			}
+
+			if (conflict)
+			{
+				run_update();
+				m_UpdateRun.clear();
+			}
+
+			m_UpdateRun.emplace(layer.get());
 		}
 
-		m_Layers.resize(m_Layers.size() - 1);
-		for (; i < m_Layers.size(); i++)
-			m_Layers[i] = std::move(m_Layers[i + 1]);
+		if (!m_UpdateRun.empty())
+			run_update();
+		m_UpdateRun.clear();
 	}
 
-	void LayerManager::detach_all(void)
+	void LayerManager::draw(void)
 	{
-		for (u64 i = 0; i < m_Layers.size(); i++)
+		IterationScope scope(m_IterationDepth);
+
+		for (LayerHandle<>& layer : m_Layers)
 		{
-			m_Layers[i]->on_detach();
-			m_Layers[i].~shared_ptr();
+			if (layer && layer->m_State == Layer::State::Attached)
+				layer->draw();
+		}
+	}
+
+	void LayerManager::on_event(Event& e)
+	{
+		if (m_EventBusDirty && !m_IterationDepth)
+		{
+			// m_Layers is in priority order already, so equal bus priorities keep it
+			m_EventBus.clear();
+			for (LayerHandle<>& layer : m_Layers)
+			{
+				if (!layer)
+					continue;
+
+				layer->m_Subscription = m_EventBus.subscribe(layer->m_EventTypes, [layer = layer.get()](Event& e)
+				{
+					if (layer->m_State == Layer::State::Attached)
+						layer->on_event(e);
+				});
+			}
+			m_EventBusDirty = false;
 		}
-		m_Layers.resize(0);
+
+		IterationScope scope(m_IterationDepth);
+		m_EventBus.dispatch(e);
+	}
+
+	void LayerManager::on_events(EventQueue& events)
+	{
+		for (Event& e : events)
+			this->on_event(e);
 	}
 
-	void LayerManager::set_layer_priority(LayerHandle<> layer, i64 new_priority)
+	void LayerManager::_insert(LayerHandle<> layer)
 	{
-		layer->m_Priority = new_priority;
-		this->resort();
+		this->_compact();
+
+		// after every layer of the same or a higher priority
+		u64 index = std::upper_bound(m_Layers.ptr(), m_Layers.ptr() + m_Layers.size(), layer, higherPriority) - m_Layers.ptr();
+
+		layer->m_State = Layer::State::Attached;
+		m_Layers.emplace(std::move(layer));
+
+		LayerHandle<>* layers = m_Layers.ptr();
+		std::rotate(layers + index, layers + m_Layers.size() - 1, layers + m_Layers.size());
+
+		this->_reindex(index);
+	}
+
+	void LayerManager::_erase(u64 index)
+	{
+		this->_unsubscribe(*m_Layers[index]);
+		m_Layers[index]->m_State = Layer::State::Detached;
+		m_Layers[index]->m_Index = k_U64Max;
+
+		// the layers behind keep their index, so removing stays O(1)
+		m_Layers[index].reset();
+		m_EmptySlotCount++;
+	}
+
+	void LayerManager::_compact(void)
+	{
+		if (!m_EmptySlotCount)
+			return;
+
+		LayerHandle<>* layers = m_Layers.ptr();
+		u64 kept = std::remove(layers, layers + m_Layers.size(), nullptr) - layers;
+		while (m_Layers.size() > kept)
+			m_Layers.pop();
+		m_EmptySlotCount = 0;
+
+		this->_reindex(0);
 	}
 
-} // namespace Na
+	void LayerManager::_reindex(u64 index)
+	{
+		for (; index < m_Layers.size(); index++)
+			m_Layers[index]->m_Index = index;
+
+		m_EventBusDirty = true;
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Pch.hpp"
+#include "Natrium/Layers/Module.hpp"
+
+#include "Natrium/Core/Logger.hpp"
+
+namespace Na {
+	ModuleHost::ModuleHost(const std::string_view& name, LayerManager& layers)
+	: m_Name(name),
+	m_LibraryPath(DynamicLibrary::PathOf(name)),
+	m_Layers(layers)
+	{
+		std::optional<Library> library = this->_load();
+		NA_VERIFY(library, "Failed to load module {}!", m_Name);
+
+		m_Library = std::move(*library);
+		m_Module = m_Library.create();
+		m_Module->on_load(m_Layers, {});
+
+		// the build output dir, the library is usually replaced by renaming a new file over it
+		m_Watcher.watch(m_LibraryPath.parent_path());
+	}
+
+	ModuleHost::~ModuleHost(void)
+	{
+		if (m_Module)
+			(void)m_Module->on_unload(m_Layers);
+
+		this->_unload();
+	}
+
+	bool ModuleHost::update(void)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		std::error_code error;
+		std::filesystem::path library_path = std::filesystem::weakly_canonical(m_LibraryPath, error);
+		for (const std::filesystem::path& path : m_Watcher.poll())
+			if (path == library_path)
+				m_LastChange = now;
+
+		if (!m_LastChange || now - *m_LastChange < k_SettleTime)
+			return false;
+
+		m_LastChange.reset();
+		return this->reload();
+	}
+
+	bool ModuleHost::reload(void)
+	{
+		// the old version keeps running until the new one is known to work
+		std::optional<Library> library = this->_load();
+		if (!library)
+			return false;
+
+		ModuleState state = m_Module->on_unload(m_Layers);
+		this->_unload();
+
+		m_Library = std::move(*library);
+		m_Module = m_Library.create();
+		m_Module->on_load(m_Layers, state);
+
+		g_Logger.fmt(Info, "Reloaded module {} ({} bytes of state)", m_Name, state.size());
+		return true;
+	}
+
+	std::optional<ModuleHost::Library> ModuleHost::_load(void)
+	{
+		std::error_code error;
+
+		// a new name per version, dlopen would hand out the previous handle for the same path
+		Library library;
+		library.shadow_path = m_LibraryPath;
+		library.shadow_path.replace_filename(NA_FORMAT(
+			"{}-hot{}{}", m_LibraryPath.stem().string(), m_Version + 1, m_LibraryPath.extension().string()
+		));
+
+		if (!std::filesystem::copy_file(m_LibraryPath, library.shadow_path, std::filesystem::copy_options::overwrite_existing, error))
+		{
+			g_Logger.fmt(Error, "Failed to load module {}: Could not copy {} ({})!", m_Name, m_LibraryPath.string(), error.message());
+			return std::nullopt;
+		}
+
+		library.library.load_from(library.shadow_path);
+		if (!library.library)
+		{
+			std::filesystem::remove(library.shadow_path, error);
+			return std::nullopt;
+		}
+
+		library.version = library.library.fn<u32 (*)(void)>("NaModuleVersion");
+		library.create = library.library.fn<Module* (*)(void)>("NaCreateModule");
+		library.destroy = library.library.fn<void (*)(Module*)>("NaDestroyModule");
+
+		const char* failure = nullptr;
+		if (!library.version || !library.create || !library.destroy)
+			failure = "Missing entry points, see NA_MODULE";
+		else if (library.version() != k_ModuleVersion)
+			failure = "Built against another module version";
+
+		if (failure)
+		{
+			g_Logger.fmt(Error, "Failed to load module {}: {}!", m_Name, failure);
+			library.library.unload();
+			std::filesystem::remove(library.shadow_path, error);
+			return std::nullopt;
+		}
+
+		m_Version++;
+		return library;
+	}
+
+	void ModuleHost::_unload(void)
+	{
+		if (m_Module)
+			m_Library.destroy(std::exchange(m_Module, nullptr));
+
+		m_Library.library.unload();
+
+		std::error_code error;
+		if (!m_Library.shadow_path.empty())
+			std::filesystem::remove(m_Library.shadow_path, error);
+
+		m_Library = {};
+	}
+} // namespace Na
\ No newline at end of file
@@ -5,26 +5,105 @@
 
 #include "Natrium/Core/Event.hpp"
 #include "Natrium/Core/Context.hpp"
+#include "Natrium/Core/Profiler.hpp"
 
 #include <GLFW/glfw3.h>
 
 namespace Na {
-	static std::unordered_map<Joystick, GLFWgamepadstate> previousGamepadStates;
+	struct GamepadSlot {
+		GLFWgamepadstate previous_state;
+		std::array<float, GamepadAxes::k_Last + 1> emitted_axes; // the last values queued, after the deadzone
+	};
 
-	EventQueue& PollEvents(void)
+	// indexed by Joystick, only the connected gamepads are polled
+	static std::array<GamepadSlot, Joysticks::k_Last + 1> gamepadSlots;
+	static std::bitset<Joysticks::k_Last + 1> connectedGamepads;
+	static bool gamepadsScanned = false;
+
+	static void resetGamepadSlot(Joystick jid)
 	{
-		Context::GetEventQueue().resize(0);
-		glfwPollEvents();
+		GamepadSlot& slot = gamepadSlots[jid];
+		memset(&slot.previous_state, 0, sizeof(GLFWgamepadstate));
+
+		// the same rest values Input starts with
+		slot.emitted_axes.fill(0.0f);
+		slot.emitted_axes[GamepadAxes::k_LeftTrigger] = -1.0f;
+		slot.emitted_axes[GamepadAxes::k_RightTrigger] = -1.0f;
+	}
+
+	static InputCoalescing inputCoalescing;
+
+	static inline bool isStickAxis(GamepadAxis axis)
+	{
+		return axis <= GamepadAxes::k_RightY;
+	}
+
+	static inline float applyDeadzone(GamepadAxis axis, float value)
+	{
+		if (!isStickAxis(axis) || fabsf(value) >= inputCoalescing.axis_deadzone)
+			return value;
+		return 0.0f;
+	}
+
+	static inline bool axisChanged(GamepadAxis axis, float emitted, float value)
+	{
+		if (value == emitted)
+			return false;
+
+		// the rest and the ends of the range always get through, so the last event is exact
+		float rest = isStickAxis(axis) ? 0.0f : -1.0f;
+		if (value == rest || value == 1.0f || value == -1.0f)
+			return true;
+
+		return fabsf(value - emitted) > inputCoalescing.axis_epsilon;
+	}
+
+	// merges consecutive events of the type and window into the last one if enabled
+	static inline Event* coalesceTarget(bool enabled, EventType type, Window* window)
+	{
+		EventQueue& queue = Context::GetEventQueue();
+		if (!enabled || queue.empty())
+			return nullptr;
+
+		Event& last = queue.tail();
+		if (last.type != type || last.window != window)
+			return nullptr;
+
+		return &last;
+	}
+
+	void SetInputCoalescing(const InputCoalescing& coalescing) { inputCoalescing = coalescing; }
+	const InputCoalescing& GetInputCoalescing(void) { return inputCoalescing; }
+
+	static void pollGamepads(void)
+	{
+		if (!gamepadsScanned)
+		{
+			// afterwards the joystick callback keeps the set up to date
+			for (Joystick jid = Joysticks::k_1; jid <= Joysticks::k_Last; jid++)
+			{
+				bool connected = glfwJoystickPresent(jid) && glfwJoystickIsGamepad(jid);
+				connectedGamepads.set(jid, connected);
+				resetGamepadSlot(jid);
+			}
+			gamepadsScanned = true;
+		}
+
+		if (connectedGamepads.none())
+			return;
+
+		double poll_time = glfwGetTime();
 
 		for (Joystick jid = Joysticks::k_1; jid <= Joysticks::k_Last; jid++)
 		{
-			if (glfwJoystickPresent(jid) && glfwJoystickIsGamepad(jid))
+			if (connectedGamepads.test(jid))
 			{
 				GLFWgamepadstate current_state;
 				if (glfwGetGamepadState(jid, &current_state))
 				{
-					auto& previous_state = previousGamepadStates[jid];
-					
+					GamepadSlot& slot = gamepadSlots[jid];
+					GLFWgamepadstate& previous_state = slot.previous_state;
+
 					for (GamepadButton button = 0; button <= GamepadButtons::k_Last; button++)
 					{
 						if (current_state.buttons[button] == previous_state.buttons[button])
@@ -35,6 +114,7 @@ namespace Na {
 								EventType::GamepadButtonPressed,
 								false,
 								nullptr,
+								poll_time,
 								jid,
 								button
 						    }});
@@ -43,6 +123,7 @@ namespace Na {
 								EventType::GamepadButtonReleased,
 								false,
 								nullptr,
+								poll_time,
 								jid,
 								button
 							}});
@@ -53,13 +134,20 @@ namespace Na {
 						if (current_state.axes[axis] == previous_state.axes[axis])
 							continue;
 
+						float value = applyDeadzone(axis, current_state.axes[axis]);
+						float& emitted = slot.emitted_axes[axis];
+						if (!axisChanged(axis, emitted, value))
+							continue;
+
+						emitted = value;
 						Context::GetEventQueue().emplace(Event{.gamepad_axis_moved = {
 							EventType::GamepadAxisMoved,
 							false,
 							nullptr,
+							poll_time,
 							jid,
 							axis,
-							current_state.axes[axis]
+							value
 						}});
 					}
 
@@ -67,12 +155,135 @@ namespace Na {
 				}
 			}
 		}
+	}
+
+	EventQueue& PollEvents(void)
+	{
+		NA_PROFILE_SCOPE("PollEvents");
+
+		Context::GetEventQueue().resize(0);
+		glfwPollEvents();
+		pollGamepads();
 
 		return Context::GetEventQueue();
 	}
 
+	static inline bool isContinuousEvent(const Event& e)
+	{
+		switch (e.type)
+		{
+		case EventType::WindowResized:
+		case EventType::MouseMoved:
+		case EventType::MouseScrolled:
+		case EventType::GamepadAxisMoved:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static inline bool sameEventSource(const Event& a, const Event& b)
+	{
+		if (a.type != b.type || a.window != b.window)
+			return false;
+
+		if (a.type == EventType::GamepadAxisMoved)
+			return a.gamepad_axis_moved.joystick_id == b.gamepad_axis_moved.joystick_id
+				&& a.gamepad_axis_moved.axis == b.gamepad_axis_moved.axis;
+
+		return true;
+	}
+
+	// merges continuous events into the latest one of their source, a discrete event in between keeps them apart
+	static void coalesceEvents(EventQueue& events)
+	{
+		u64 kept = 0;
+		u64 run_begin = 0; // the continuous events since the last discrete one
+
+		for (u64 i = 0; i < events.size(); i++)
+		{
+			const Event e = events[i];
+			if (!isContinuousEvent(e))
+			{
+				events[kept++] = e;
+				run_begin = kept;
+				continue;
+			}
+
+			u64 j = run_begin;
+			while (j < kept && !sameEventSource(events[j], e))
+				j++;
+
+			if (j == kept)
+			{
+				events[kept++] = e;
+				continue;
+			}
+
+			if (e.type == EventType::MouseScrolled)
+			{
+				events[j].timestamp = e.timestamp;
+				events[j].mouse_scrolled.x_offset += e.mouse_scrolled.x_offset;
+				events[j].mouse_scrolled.y_offset += e.mouse_scrolled.y_offset;
+			} else
+			{
+				events[j] = e;
+			}
+		}
+
+		events.resize(kept);
+	}
+
+	InputPump::InputPump(u32 rate_hz, u64 queue_capacity)
+	: m_Queue(queue_capacity),
+	m_BacklogLimit(queue_capacity),
+	m_Interval(1.0 / std::max(rate_hz, 1u))
+	{}
+
+	void InputPump::run(void)
+	{
+		EventQueue& events = Context::GetEventQueue();
+
+		while (!m_Stop.load(std::memory_order_acquire))
+		{
+			events.resize(0);
+			glfwWaitEventsTimeout(m_Interval);
+			pollGamepads();
+
+			// a full queue keeps the rest in order for the next round, dropping a release would stick keys
+			m_Backlog.append_range(events.ptr(), events.size());
+			if (m_Backlog.size() > m_BacklogLimit)
+				coalesceEvents(m_Backlog);
+
+			u64 sent = 0;
+			while (sent < m_Backlog.size() && m_Queue.try_push(m_Backlog[sent]))
+				sent++;
+
+			Event* backlog = m_Backlog.ptr();
+			std::move(backlog + sent, backlog + m_Backlog.size(), backlog);
+			m_Backlog.resize(m_Backlog.size() - sent);
+		}
+	}
+
+	void InputPump::stop(void)
+	{
+		m_Stop.store(true, std::memory_order_release);
+		glfwPostEmptyEvent(); // wakes glfwWaitEventsTimeout
+	}
+
+	EventQueue& InputPump::drain(void)
+	{
+		m_Drained.resize(0);
+
+		Event e{};
+		while (m_Queue.try_pop(e))
+			m_Drained.emplace(e);
+
+		return m_Drained;
+	}
+
 	Window::WindowImpl_GLFW(u32 width, u32 height, const std::string_view& title)
-	: m_Width(width), m_Height(height)
+	: m_Size(glm::uvec2{ width, height })
 	{
 		m_Window = glfwCreateWindow(width, height, title.data(), nullptr, nullptr);
 		NA_ASSERT(m_Window, "Failed to create glfw window!");
@@ -94,14 +305,13 @@ namespace Na {
 	void Window::focus(void)
 	{
 		glfwFocusWindow(m_Window);
-		m_Focus = true;
+		m_Focus.store(true, std::memory_order_relaxed);
 	}
 
 	void Window::set_size(u32 width, u32 height)
 	{
 		glfwSetWindowSize(m_Window, width, height);
-		m_Width = width;
-		m_Height = height;
+		m_Size.store(glm::uvec2{ width, height }, std::memory_order_relaxed);
 	}
 
 	void Window::set_title(const char* title)
@@ -114,23 +324,46 @@ namespace Na {
 		return glfwGetWindowTitle(m_Window);
 	}
 
+	bool Window::set_raw_mouse_motion(bool enabled)
+	{
+		glfwSetInputMode(m_Window, GLFW_CURSOR, enabled ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+
+		m_RawMouseMotion = enabled && RawMouseMotionSupported();
+		if (RawMouseMotionSupported())
+			glfwSetInputMode(m_Window, GLFW_RAW_MOUSE_MOTION, m_RawMouseMotion);
+
+		return m_RawMouseMotion;
+	}
+
+	bool Window::RawMouseMotionSupported(void)
+	{
+		return glfwRawMouseMotionSupported();
+	}
+
 	WindowImpl_GLFW::WindowImpl_GLFW(WindowImpl_GLFW&& other)
 	: m_Window(std::exchange(other.m_Window, nullptr)),
-	m_Width(std::exchange(other.m_Width, 0)),
-	m_Height(std::exchange(other.m_Height, 0)),
-	m_Focus(other.m_Focus),
-	m_Minimized(other.m_Minimized)
-	{}
+	m_Size(other.m_Size.exchange(glm::uvec2{ 0, 0 })),
+	m_Focus(other.m_Focus.load()),
+	m_Minimized(other.m_Minimized.load()),
+	m_RawMouseMotion(other.m_RawMouseMotion)
+	{
+		// the callbacks find the window through its user pointer
+		if (m_Window)
+			glfwSetWindowUserPointer(m_Window, this);
+	}
 
 	WindowImpl_GLFW& WindowImpl_GLFW::operator=(WindowImpl_GLFW&& other)
 	{
 		glfwDestroyWindow(m_Window);
 
 		m_Window = std::exchange(other.m_Window, nullptr);
-		m_Width = std::exchange(other.m_Width, 0);
-		m_Height = std::exchange(other.m_Height, 0);
-		m_Focus = other.m_Focus;
-		m_Minimized = other.m_Minimized;
+		m_Size = other.m_Size.exchange(glm::uvec2{ 0, 0 });
+		m_Focus = other.m_Focus.load();
+		m_Minimized = other.m_Minimized.load();
+		m_RawMouseMotion = other.m_RawMouseMotion;
+
+		if (m_Window)
+			glfwSetWindowUserPointer(m_Window, this);
 
 		return *this;
 	}
@@ -148,6 +381,7 @@ namespace Na {
 					EventType::KeyPressed,
 					false,
 					__window,
+					glfwGetTime(),
 					(Key)key,
 					(KeyMod)mods,
 					false
@@ -158,6 +392,7 @@ namespace Na {
 					EventType::KeyPressed,
 					false,
 					__window,
+					glfwGetTime(),
 					(Key)key,
 					(KeyMod)mods,
 					true
@@ -168,6 +403,7 @@ namespace Na {
 					EventType::KeyReleased,
 					false,
 					__window,
+					glfwGetTime(),
 					(Key)key,
 					(KeyMod)mods
 				}});
@@ -177,12 +413,12 @@ namespace Na {
 		glfwSetWindowSizeCallback(_window, [](GLFWwindow* window, int width, int height)
 		{
 			Window* __window = (Window*)glfwGetWindowUserPointer(window);
-			__window->m_Width = width;
-			__window->m_Height = height;
+			__window->m_Size.store(glm::uvec2{ (u32)width, (u32)height }, std::memory_order_relaxed);
 			Context::GetEventQueue().emplace(Event{.window_resized = {
 				EventType::WindowResized,
 				false,
 				__window,
+				glfwGetTime(),
 				(u32)width, (u32)height
 			}});
 		});
@@ -192,61 +428,83 @@ namespace Na {
 			Context::GetEventQueue().emplace(Event{.window_closed = {
 				EventType::WindowClosed,
 				false,
-				__window
+				__window,
+				glfwGetTime()
 			}});
 		});
 		glfwSetWindowFocusCallback(_window, [](GLFWwindow* window, int focus)
 		{
 			Window* __window = (Window*)glfwGetWindowUserPointer(window);
-			__window->m_Focus = focus;
+			__window->m_Focus.store(focus, std::memory_order_relaxed);
 			if (focus)
 				Context::GetEventQueue().emplace(Event{.window_focused = {
 					EventType::WindowFocused,
 					false,
-					__window
+					__window,
+					glfwGetTime()
 				}});
 			else
 				Context::GetEventQueue().emplace(Event{.window_lost_focus = {
 					EventType::WindowLostFocus,
 					false,
-					__window
+					__window,
+					glfwGetTime()
 				}});
 		});
 		glfwSetWindowIconifyCallback(_window, [](GLFWwindow* window, int iconified)
 		{
 			Window* __window = (Window*)glfwGetWindowUserPointer(window);
-			__window->m_Minimized = iconified;
+			__window->m_Minimized.store(iconified, std::memory_order_relaxed);
 			if (iconified)
 				Context::GetEventQueue().emplace(Event{.window_minimized = {
 					EventType::WindowMinimized,
 					false,
-					__window
+					__window,
+					glfwGetTime()
 				}});
 			else
-				__window->m_Minimized = false;
 				Context::GetEventQueue().emplace(Event{.window_restored = {
 					EventType::WindowRestored,
 					false,
-					__window
+					__window,
+					glfwGetTime()
 				}});
 		});
 		glfwSetCursorPosCallback(_window, [](GLFWwindow* window, double x, double y)
 		{
 			Window* __window = (Window*)glfwGetWindowUserPointer(window);
+			if (Event* last = coalesceTarget(inputCoalescing.mouse_moves, EventType::MouseMoved, __window))
+			{
+				last->timestamp = glfwGetTime();
+				last->mouse_moved.x = (float)x;
+				last->mouse_moved.y = (float)y;
+				return;
+			}
+
 			Context::GetEventQueue().emplace(Event{.mouse_moved = {
 				EventType::MouseMoved,
 				false,
 				__window,
+				glfwGetTime(),
 				(float)x, (float)y
 			}});
 		});
 		glfwSetScrollCallback(_window, [](GLFWwindow* window, double x_offset, double y_offset)
 		{
 			Window* __window = (Window*)glfwGetWindowUserPointer(window);
+			if (Event* last = coalesceTarget(inputCoalescing.mouse_scrolls, EventType::MouseScrolled, __window))
+			{
+				last->timestamp = glfwGetTime();
+				last->mouse_scrolled.x_offset += (float)x_offset;
+				last->mouse_scrolled.y_offset += (float)y_offset;
+				return;
+			}
+
 			Context::GetEventQueue().emplace(Event{.mouse_scrolled = {
 				EventType::MouseScrolled,
 				false,
 				__window,
+				glfwGetTime(),
 				(float)x_offset, (float)y_offset
 			}});
 		});
@@ -260,6 +518,7 @@ namespace Na {
 					EventType::MouseButtonPressed,
 					false,
 					__window,
+					glfwGetTime(),
 					(MouseButton)button
 				}});
 				break;
@@ -268,6 +527,7 @@ namespace Na {
 					EventType::MouseButtonReleased,
 					false,
 					__window,
+					glfwGetTime(),
 					(MouseButton)button
 				}});
 				break;
@@ -275,27 +535,30 @@ namespace Na {
 		});
 		glfwSetJoystickCallback([](int jid, int event)
 		{
-			if (!glfwJoystickIsGamepad(jid))
-				return;
-
-			if (event == GLFW_CONNECTED)
+			// a disconnected joystick no longer reports whether it was a gamepad
+			if (event == GLFW_CONNECTED && glfwJoystickIsGamepad(jid))
 			{
+				connectedGamepads.set(jid, true);
+				resetGamepadSlot((Joystick)jid);
 				Context::GetEventQueue().emplace(Event{.gamepad_connected = {
 					EventType::GamepadConnected,
 					false,
 					nullptr,
+					glfwGetTime(),
 					(Joystick)jid
 				}});
 			} else
-			if (event == GLFW_DISCONNECTED)
+			if (event == GLFW_DISCONNECTED && connectedGamepads.test(jid))
 			{
+				connectedGamepads.set(jid, false);
 				Context::GetEventQueue().emplace(Event{.gamepad_disconnected = {
 					EventType::GamepadDisconnected,
 					false,
 					nullptr,
+					glfwGetTime(),
 					(Joystick)jid
 				}});
-				previousGamepadStates.erase(jid);
+				resetGamepadSlot((Joystick)jid);
 			}
 		});
 	}
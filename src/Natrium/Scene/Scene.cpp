@@ -0,0 +1,61 @@
+#include "Pch.hpp"
+#include "Natrium/Scene/Scene.hpp"
+
+namespace Na {
+	Entity Scene::create(void)
+	{
+		u32 index;
+		if (!m_FreeIndices.empty())
+		{
+			index = m_FreeIndices.tail();
+			m_FreeIndices.pop();
+		} else
+		{
+			NA_VERIFY(m_Generations.size() < k_MaxEntities, "Failed to create entity: Exceeded {} entities!", k_MaxEntities);
+			index = (u32)m_Generations.emplace(1u);
+		}
+
+		m_AliveCount++;
+		return Entity(index, m_Generations[index]);
+	}
+
+	bool Scene::destroy(Entity entity)
+	{
+		if (!this->alive(entity))
+			return false;
+
+		for (std::unique_ptr<ComponentPoolBase>& pool : m_Pools)
+		{
+			if (pool)
+				pool->remove(entity);
+		}
+
+		u32& generation = m_Generations[entity.index()];
+		generation = generation == Entity::k_MaxGeneration ? 1 : generation + 1;
+
+		m_FreeIndices.emplace(entity.index());
+		m_AliveCount--;
+
+		return true;
+	}
+
+	void Scene::clear(void)
+	{
+		for (std::unique_ptr<ComponentPoolBase>& pool : m_Pools)
+		{
+			if (pool)
+				pool->clear();
+		}
+
+		// every handle goes stale, the indices are all free again
+		m_FreeIndices.clear();
+		for (u32 i = (u32)m_Generations.size(); i-- > 0;)
+		{
+			u32& generation = m_Generations[i];
+			generation = generation == Entity::k_MaxGeneration ? 1 : generation + 1;
+			m_FreeIndices.emplace(i);
+		}
+
+		m_AliveCount = 0;
+	}
+} // namespace Na
\ No newline at end of file
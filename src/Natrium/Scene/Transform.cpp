@@ -0,0 +1,132 @@
+#include "Pch.hpp"
+#include "Natrium/Scene/Transform.hpp"
+
+namespace Na {
+	glm::mat4 Transform::matrix(void) const
+	{
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= scale.x;
+		matrix[1] *= scale.y;
+		matrix[2] *= scale.z;
+		matrix[3] = glm::vec4(position, 1.0f);
+		return matrix;
+	}
+
+	void TransformHierarchy::update(Scene& scene)
+	{
+		ComponentPool<Transform>& transforms = scene.pool<Transform>();
+		ComponentPool<WorldTransform>& worlds = scene.pool<WorldTransform>();
+		ComponentPool<Parent>& parents = scene.pool<Parent>();
+
+		if (
+			!m_Valid ||
+			transforms.version() != m_TransformVersion ||
+			worlds.version() != m_WorldVersion ||
+			parents.version() != m_ParentVersion
+		)
+			this->_rebuild(scene);
+
+		const Transform* local = transforms.ptr();
+		WorldTransform* world = worlds.ptr();
+
+		JobSystem& job_system = JobSystem::Get();
+		for (u64 level = 0; level + 1 < m_LevelOffsets.size(); level++)
+		{
+			const Node* nodes = m_Nodes.data() + m_LevelOffsets[level];
+			u64 count = m_LevelOffsets[level + 1] - m_LevelOffsets[level];
+
+			// every parent is on an earlier level, so the nodes of one level are independent
+			auto work = [&](u64 begin, u64 end)
+			{
+				for (u64 i = begin; i < end; i++)
+				{
+					const Node& node = nodes[i];
+					glm::mat4 matrix = local[node.transform].matrix();
+					world[node.world].matrix = node.parent_world == k_U32Max ? matrix : world[node.parent_world].matrix * matrix;
+				}
+			};
+
+			if (count <= k_MinBatch)
+				work(0, count);
+			else
+				job_system.parallel_for(count, k_MinBatch, work);
+		}
+	}
+
+	void TransformHierarchy::_rebuild(Scene& scene)
+	{
+		ComponentPool<Transform>& transforms = scene.pool<Transform>();
+		ComponentPool<WorldTransform>& worlds = scene.pool<WorldTransform>();
+		ComponentPool<Parent>& parents = scene.pool<Parent>();
+
+		std::span<const Entity> entities = transforms.entities();
+		for (Entity entity : entities)
+		{
+			if (!worlds.contains(entity))
+				worlds.emplace(entity);
+		}
+
+		// by dense index of the Transform pool, k_U32Max until known
+		std::vector<u32> depths(entities.size(), k_U32Max);
+		std::vector<u32> parent_indices(entities.size(), k_U32Max);
+		std::vector<u32> chain;
+
+		for (u32 i = 0; i < (u32)entities.size(); i++)
+		{
+			// walks up until a node of known depth or a root, then assigns the depths on the way back
+			u32 current = i;
+			while (depths[current] == k_U32Max)
+			{
+				chain.push_back(current);
+				NA_VERIFY(chain.size() <= entities.size(), "Failed to update transforms: The hierarchy has a cycle!");
+
+				const Parent* parent = parents.get(entities[current]);
+				u32 parent_index = parent && scene.alive(parent->entity) ? transforms.index_of(parent->entity) : k_U32Max;
+				if (parent_index == k_U32Max)
+				{
+					depths[current] = 0;
+					chain.pop_back();
+					break;
+				}
+
+				parent_indices[current] = parent_index;
+				current = parent_index;
+			}
+
+			u32 depth = depths[current];
+			while (!chain.empty())
+			{
+				depths[chain.back()] = ++depth;
+				chain.pop_back();
+			}
+		}
+
+		// a counting sort by depth, stable so siblings keep the pool's order
+		u32 max_depth = 0;
+		for (u32 depth : depths)
+			max_depth = std::max(max_depth, depth);
+
+		m_LevelOffsets.assign(entities.empty() ? 0 : max_depth + 2, 0);
+		for (u32 depth : depths)
+			m_LevelOffsets[depth + 1]++;
+		for (u64 level = 1; level < m_LevelOffsets.size(); level++)
+			m_LevelOffsets[level] += m_LevelOffsets[level - 1];
+
+		m_Nodes.resize(entities.size());
+		std::vector<u64> cursors(m_LevelOffsets.begin(), m_LevelOffsets.end());
+		for (u32 i = 0; i < (u32)entities.size(); i++)
+		{
+			u32 parent_index = parent_indices[i];
+			m_Nodes[cursors[depths[i]]++] = Node{
+				.transform = i,
+				.world = worlds.index_of(entities[i]),
+				.parent_world = parent_index == k_U32Max ? k_U32Max : worlds.index_of(entities[parent_index])
+			};
+		}
+
+		m_Valid = true;
+		m_TransformVersion = transforms.version();
+		m_WorldVersion = worlds.version();
+		m_ParentVersion = parents.version();
+	}
+} // namespace Na
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "BenchCommon/BenchStats.hpp"
+
+#include <numeric>
+
+namespace Na::Bench {
+	Stats Stats::Of(std::vector<double> samples)
+	{
+		Stats stats;
+		if (samples.empty())
+			return stats;
+
+		std::sort(samples.begin(), samples.end());
+
+		// nearest rank, so every reported value was actually measured
+		auto percentile = [&](double p) { return samples[std::min((u64)(p * (double)samples.size()), (u64)samples.size() - 1)]; };
+
+		stats.count = samples.size();
+		stats.min = samples.front();
+		stats.max = samples.back();
+		stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / (double)samples.size();
+		stats.p50 = percentile(0.5);
+		stats.p90 = percentile(0.9);
+		stats.p99 = percentile(0.99);
+		return stats;
+	}
+
+	void WriteStats(std::ostream& out, const Stats& stats)
+	{
+		out << NA_FORMAT(
+			"{{\"count\": {}, \"min\": {}, \"mean\": {}, \"p50\": {}, \"p90\": {}, \"p99\": {}, \"max\": {}}}",
+			stats.count, stats.min, stats.mean, stats.p50, stats.p90, stats.p99, stats.max
+		);
+	}
+
+	void WriteValues(std::ostream& out, const Values& values)
+	{
+		out << "{";
+		for (u64 i = 0; i < values.size(); i++)
+			out << NA_FORMAT("{}\"{}\": {}", i ? ", " : "", values[i].first, values[i].second);
+		out << "}";
+	}
+
+	std::string EscapeJson(std::string_view str)
+	{
+		std::string escaped;
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			if ((u8)c >= 0x20)
+				escaped += c;
+		}
+		return escaped;
+	}
+} // namespace Na::Bench
\ No newline at end of file
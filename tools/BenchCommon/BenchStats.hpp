@@ -0,0 +1,27 @@
+#if !defined(NA_BENCH_STATS_HPP)
+#define NA_BENCH_STATS_HPP
+
+#include "Natrium/PchBase.hpp"
+#include "Natrium/Core.hpp"
+
+// shared by the benchmark tools, so their reports read the same
+namespace Na::Bench {
+	// in the unit of the samples, count is 0 if nothing was measured
+	struct Stats {
+		u64 count = 0;
+		double min = 0.0, mean = 0.0, max = 0.0;
+		double p50 = 0.0, p90 = 0.0, p99 = 0.0;
+
+		[[nodiscard]] static Stats Of(std::vector<double> samples);
+	};
+
+	using Values = std::vector<std::pair<std::string, double>>;
+
+	// json objects, names are written as they are
+	void WriteStats(std::ostream& out, const Stats& stats);
+	void WriteValues(std::ostream& out, const Values& values);
+
+	[[nodiscard]] std::string EscapeJson(std::string_view str);
+} // namespace Na::Bench
+
+#endif // NA_BENCH_STATS_HPP
\ No newline at end of file
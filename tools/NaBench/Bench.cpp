@@ -0,0 +1,182 @@
+#include "Bench.hpp"
+
+namespace Na::Bench {
+	static constexpr std::string_view k_VertexShader = R"(
+#version 450
+
+layout(location = 0) in vec2 a_Position;
+
+layout(push_constant) uniform Draw {
+	vec2 offset;
+	float scale;
+} u_Draw;
+
+void main()
+{
+	gl_Position = vec4(a_Position * u_Draw.scale + u_Draw.offset, 0.0, 1.0);
+}
+)";
+
+	static constexpr std::string_view k_FragmentShader = R"(
+#version 450
+
+layout(location = 0) out vec4 o_Color;
+
+void main()
+{
+	o_Color = vec4(1.0, 0.5, 0.2, 1.0);
+}
+)";
+
+	static RendererSettings benchSettings(void)
+	{
+		RendererSettings settings = RendererSettings::Default();
+
+		// nothing waits for vblank, so frame times are the renderer's own
+		settings.present_mode = PresentMode::Immediate;
+		settings.msaa_enabled = false;
+		settings.gpu_profiler_scopes = 16;
+		return settings;
+	}
+
+	Harness::Harness(const Options& options)
+	: m_Options(options), m_Context(Context::Initialize(ContextSettings{ .headless = options.headless }))
+	{
+		if (options.headless)
+		{
+			m_Core = RendererCore(vk::Extent2D{ options.width, options.height }, benchSettings());
+		} else
+		{
+			m_Window = Window(options.width, options.height, "NaBench");
+			m_Core = RendererCore(m_Window, benchSettings());
+		}
+		m_Renderer = Renderer(m_Core);
+
+		ShaderBinary vertex_binary(ShaderString(k_VertexShader, "NaBench.vert").compile());
+		ShaderBinary fragment_binary(ShaderString(k_FragmentShader, "NaBench.frag").compile());
+		m_VertexShader = std::make_unique<ShaderModule>(vertex_binary, ShaderStageBits::Vertex);
+		m_FragmentShader = std::make_unique<ShaderModule>(fragment_binary, ShaderStageBits::Fragment);
+
+		m_ScratchDir = std::filesystem::temp_directory_path() / NA_FORMAT("NaBench-{}", Profiler::Now());
+		std::filesystem::create_directories(m_ScratchDir);
+	}
+
+	Harness::~Harness(void)
+	{
+		VkContext::WaitForRemainingDeviceTasks();
+
+		m_VertexShader.reset();
+		m_FragmentShader.reset();
+
+		m_Renderer.destroy();
+		m_Core.destroy();
+		m_Window.destroy();
+
+		Context::Shutdown();
+
+		std::error_code error;
+		std::filesystem::remove_all(m_ScratchDir, error);
+	}
+
+	bool Harness::frame(const std::function<void(Renderer&)>& record)
+	{
+		if (!m_Options.headless)
+			PollEvents();
+
+		if (!m_Renderer.begin_frame())
+			return false;
+
+		if (record)
+			record(m_Renderer);
+
+		m_Renderer.end_frame();
+		return true;
+	}
+
+	std::pair<Stats, Stats> Harness::run_frames(const std::function<void(Renderer&)>& record)
+	{
+		for (u32 i = 0; i < m_Options.warmup_frames; i++)
+			this->frame(record);
+
+		std::vector<double> cpu_times, gpu_times;
+		cpu_times.reserve(m_Options.frames);
+		gpu_times.reserve(m_Options.frames);
+
+		// reports lag max_frames_in_flight frames behind, only the measured frames' are collected
+		u64 first_frame = m_Renderer.submitted_frames();
+		u64 last_report = k_U64Max;
+		auto collect = [&]()
+		{
+			const GpuFrameReport& report = m_Renderer.gpu_report();
+			if (report.frame < first_frame || report.frame == last_report || report.frame >= first_frame + m_Options.frames)
+				return;
+
+			gpu_times.push_back(report.duration);
+			last_report = report.frame;
+		};
+
+		for (u32 i = 0; i < m_Options.frames; i++)
+		{
+			u64 start = Profiler::Now();
+			bool rendered = this->frame(record);
+			u64 end = Profiler::Now();
+
+			if (rendered)
+				cpu_times.push_back((double)(end - start) * 1e-6);
+			collect();
+		}
+
+		// empty frames until the last measured frame was resolved
+		if (m_Renderer.gpu_profiler().enabled())
+		{
+			for (u32 i = 0; i < m_Core.settings().max_frames_in_flight + 1; i++)
+			{
+				this->frame();
+				collect();
+			}
+		}
+
+		return { Stats::Of(std::move(cpu_times)), Stats::Of(std::move(gpu_times)) };
+	}
+
+	void Harness::idle(void)
+	{
+		VkContext::GetUploadManager().wait_idle();
+		VkContext::GetLogicalDevice().waitIdle();
+	}
+
+	void WriteJson(std::ostream& out, const Options& options, const std::vector<Result>& results)
+	{
+		const vk::PhysicalDeviceProperties& properties = VkContext::GetPhysicalDeviceProperties();
+
+		out << "{\n";
+		out << "\t\"version\": 1,\n";
+		out << NA_FORMAT("\t\"device\": \"{}\",\n", EscapeJson(properties.deviceName.data()));
+		out << NA_FORMAT(
+			"\t\"driver_version\": {},\n\t\"api_version\": \"{}.{}.{}\",\n",
+			properties.driverVersion,
+			VK_API_VERSION_MAJOR(properties.apiVersion), VK_API_VERSION_MINOR(properties.apiVersion), VK_API_VERSION_PATCH(properties.apiVersion)
+		);
+		out << NA_FORMAT("\t\"headless\": {},\n", options.headless);
+		out << NA_FORMAT("\t\"width\": {},\n\t\"height\": {},\n", options.width, options.height);
+		out << NA_FORMAT("\t\"frames\": {},\n\t\"warmup_frames\": {},\n\t\"iterations\": {},\n", options.frames, options.warmup_frames, options.iterations);
+		out << "\t\"results\": [";
+
+		for (u64 i = 0; i < results.size(); i++)
+		{
+			const Result& result = results[i];
+			out << (i ? ",\n" : "\n");
+			out << NA_FORMAT("\t\t{{\n\t\t\t\"name\": \"{}\",\n\t\t\t\"params\": ", result.name);
+			WriteValues(out, result.params);
+			out << ",\n\t\t\t\"cpu_ms\": ";
+			WriteStats(out, result.cpu);
+			out << ",\n\t\t\t\"gpu_ms\": ";
+			WriteStats(out, result.gpu);
+			out << ",\n\t\t\t\"metrics\": ";
+			WriteValues(out, result.metrics);
+			out << "\n\t\t}";
+		}
+
+		out << "\n\t]\n}\n";
+	}
+} // namespace Na::Bench
\ No newline at end of file
@@ -0,0 +1,91 @@
+#if !defined(NA_BENCH_HPP)
+#define NA_BENCH_HPP
+
+#include "BenchCommon/BenchStats.hpp"
+#include "Natrium/Natrium.hpp"
+#include "Natrium/Graphics/ShaderModule.hpp"
+
+namespace Na::Bench {
+	struct Result {
+		std::string name;
+		Values params; // what the workload was run with, e.g. the draw count
+		Stats cpu; // milliseconds like gpu
+		Stats gpu; // empty unless the workload runs in frames and the gpu profiler is enabled
+		Values metrics; // derived numbers, e.g. bytes per second
+	};
+
+	struct Options {
+		u32 frames = 300; // measured per workload, after warmup_frames
+		u32 warmup_frames = 30;
+		u32 iterations = 20; // of workloads that run outside of frames, e.g. uploads
+
+		u32 width = 1280, height = 720;
+		bool headless = false;
+
+		std::string filter; // only workloads whose name contains it
+		std::filesystem::path output; // stdout if empty
+	};
+
+	/// 
+	/// what every workload runs against, the window is only open without headless
+	/// 
+	class Harness {
+	public:
+		Harness(const Options& options);
+		~Harness(void);
+
+		Harness(const Harness& other) = delete;
+		Harness& operator=(const Harness& other) = delete;
+
+		/// 
+		/// renders options.warmup_frames, then options.frames frames calling record between
+		/// begin_frame and end_frame, cpu times are full frames including the wait for the gpu,
+		/// gpu times come from the profiler's frame report
+		/// 
+		[[nodiscard]] std::pair<Stats, Stats> run_frames(const std::function<void(Renderer&)>& record);
+
+		// one frame, returns whether it was rendered
+		bool frame(const std::function<void(Renderer&)>& record = {});
+
+		// blocks until every submitted frame and upload finished
+		void idle(void);
+
+		[[nodiscard]] inline bool enabled(std::string_view name) const { return m_Options.filter.empty() || name.find(m_Options.filter) != std::string_view::npos; }
+
+		[[nodiscard]] inline const Options& options(void) const { return m_Options; }
+
+		[[nodiscard]] inline RendererCore& core(void) { return m_Core; }
+		[[nodiscard]] inline Renderer& renderer(void) { return m_Renderer; }
+		[[nodiscard]] inline Window& window(void) { return m_Window; }
+
+		// a vertex and fragment shader drawing vec2 positions offset by a push constant
+		[[nodiscard]] inline const ShaderModule& vertex_shader(void) const { return *m_VertexShader; }
+		[[nodiscard]] inline const ShaderModule& fragment_shader(void) const { return *m_FragmentShader; }
+
+		// a temporary directory for generated files, removed on destruction
+		[[nodiscard]] inline const std::filesystem::path& scratch_dir(void) const { return m_ScratchDir; }
+	private:
+		Options m_Options;
+
+		Context m_Context;
+		Window m_Window;
+		RendererCore m_Core;
+		Renderer m_Renderer;
+
+		std::unique_ptr<ShaderModule> m_VertexShader, m_FragmentShader;
+
+		std::filesystem::path m_ScratchDir;
+	};
+
+	// every workload appends its results
+	void DrawIndexed(Harness& harness, std::vector<Result>& results);
+	void DescriptorBuffer(Harness& harness, std::vector<Result>& results);
+	void VertexUpload(Harness& harness, std::vector<Result>& results);
+	void TextureUpload(Harness& harness, std::vector<Result>& results);
+	void PipelineCreation(Harness& harness, std::vector<Result>& results);
+	void SwapchainRecreation(Harness& harness, std::vector<Result>& results);
+
+	void WriteJson(std::ostream& out, const Options& options, const std::vector<Result>& results);
+} // namespace Na::Bench
+
+#endif // NA_BENCH_HPP
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "Bench.hpp"
+
+namespace Na::Bench {
+	struct DrawConstants {
+		glm::vec2 offset;
+		float scale;
+	};
+
+	// a quad, small enough that the draws are bound by submission rather than fill rate
+	static constexpr glm::vec2 k_QuadVertices[] = {
+		{ -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f }
+	};
+	static constexpr u32 k_QuadIndices[] = { 0, 1, 2, 2, 3, 0 };
+
+	static PipelineState benchState(void)
+	{
+		PipelineState state;
+		state.cull_mode = vk::CullModeFlagBits::eNone;
+		state.depth_test = false;
+		state.depth_write = false;
+		return state;
+	}
+
+	// samples taken inside run_frames include the warmup frames
+	static Stats measuredStats(std::vector<double> samples, const Options& options)
+	{
+		samples.erase(samples.begin(), samples.begin() + std::min<u64>(options.warmup_frames, samples.size()));
+		return Stats::Of(std::move(samples));
+	}
+
+	static double elapsedMs(u64 start) { return (double)(Profiler::Now() - start) * 1e-6; }
+
+	// bytes per second of size bytes taking ms milliseconds
+	static double throughput(u64 size, double ms) { return ms > 0.0 ? (double)size / (ms * 1e-3) : 0.0; }
+
+	void DrawIndexed(Harness& harness, std::vector<Result>& results)
+	{
+		GraphicsPipeline pipeline(harness.core(), { &harness.vertex_shader(), &harness.fragment_shader() }, benchState());
+		VertexBuffer vertex_buffer(sizeof(k_QuadVertices), k_QuadVertices);
+		IndexBuffer index_buffer((u32)std::size(k_QuadIndices), k_QuadIndices);
+		harness.idle();
+
+		for (u32 draw_count : { 100u, 1000u, 10000u, 50000u })
+		{
+			// a fixed grid, every run draws exactly the same thing
+			u32 columns = (u32)std::ceil(std::sqrt((double)draw_count));
+			float cell = 2.0f / (float)columns;
+
+			std::vector<double> record_times;
+			auto [cpu, gpu] = harness.run_frames([&](Renderer& renderer)
+			{
+				u64 start = Profiler::Now();
+
+				renderer.bind_pipeline(pipeline);
+				for (u32 i = 0; i < draw_count; i++)
+				{
+					DrawConstants constants{
+						{ -1.0f + cell * ((float)(i % columns) + 0.5f), -1.0f + cell * ((float)(i / columns) + 0.5f) },
+						cell * 0.4f
+					};
+					renderer.set_push_constant(pipeline.push_constant(), &constants, pipeline);
+					renderer.draw_indexed(vertex_buffer, index_buffer);
+				}
+
+				record_times.push_back(elapsedMs(start));
+			});
+
+			Stats record = measuredStats(std::move(record_times), harness.options());
+			results.push_back(Result{
+				"draw_indexed",
+				{ { "draws", (double)draw_count } },
+				cpu, gpu,
+				{
+					{ "record_ms_p50", record.p50 },
+					{ "record_ms_p99", record.p99 },
+					{ "draws_per_second", record.p50 > 0.0 ? (double)draw_count / (record.p50 * 1e-3) : 0.0 }
+				}
+			});
+		}
+
+		harness.idle();
+	}
+
+	void DescriptorBuffer(Harness& harness, std::vector<Result>& results)
+	{
+		static constexpr u32 k_WritesPerFrame = 64;
+
+		for (u64 size : { 256ull, 4096ull, 16384ull })
+		{
+			UniformBuffer buffer(size, harness.core().settings());
+			std::vector<Byte> data(size);
+			for (u64 i = 0; i < size; i++)
+				data[i] = (Byte)(i * 31);
+
+			std::vector<double> write_times;
+			harness.run_frames([&](Renderer& renderer)
+			{
+				u64 start = Profiler::Now();
+				for (u32 i = 0; i < k_WritesPerFrame; i++)
+					renderer.set_descriptor_buffer(&buffer, data.data());
+				write_times.push_back(elapsedMs(start));
+			});
+
+			// the frames themselves are not what is measured, only the writes
+			Stats writes = measuredStats(std::move(write_times), harness.options());
+			results.push_back(Result{
+				"set_descriptor_buffer",
+				{ { "size", (double)size }, { "writes_per_frame", (double)k_WritesPerFrame } },
+				writes, Stats{},
+				{ { "bytes_per_second", throughput(size * k_WritesPerFrame, writes.p50) } }
+			});
+
+			harness.idle();
+		}
+	}
+
+	void VertexUpload(Harness& harness, std::vector<Result>& results)
+	{
+		for (u64 size : { 64ull * 1024, 1024ull * 1024, 16ull * 1024 * 1024 })
+		{
+			std::vector<Byte> data(size);
+			for (u64 i = 0; i < size; i++)
+				data[i] = (Byte)(i * 131);
+
+			// from the call until the copy completed on the gpu
+			std::vector<double> latencies;
+			for (u32 i = 0; i < harness.options().iterations; i++)
+			{
+				harness.idle();
+
+				u64 start = Profiler::Now();
+				VertexBuffer vertex_buffer(size, data.data());
+				VkContext::GetUploadManager().wait_idle();
+				latencies.push_back(elapsedMs(start));
+			}
+
+			Stats latency = Stats::Of(latencies);
+			results.push_back(Result{
+				"vertex_buffer_upload",
+				{ { "size", (double)size } },
+				latency, Stats{},
+				{ { "bytes_per_second", throughput(size, latency.p50) } }
+			});
+		}
+
+		harness.idle();
+	}
+
+	// uncompressed 32 bit tga, which stb_image decodes to rgba like any other RGBA8 image
+	static void writeTga(const std::filesystem::path& path, u32 width, u32 height)
+	{
+		std::ofstream file(path, std::ios::binary);
+		NA_VERIFY(file, "Failed to create {}!", path.string());
+
+		u8 header[18] = {};
+		header[2] = 2; // uncompressed true color
+		header[12] = (u8)width; header[13] = (u8)(width >> 8);
+		header[14] = (u8)height; header[15] = (u8)(height >> 8);
+		header[16] = 32;
+		header[17] = 0x28; // top left origin, 8 alpha bits
+		file.write((const char*)header, sizeof(header));
+
+		std::vector<u8> row(width * 4);
+		for (u32 y = 0; y < height; y++)
+		{
+			for (u32 x = 0; x < width; x++)
+			{
+				u8* pixel = row.data() + x * 4; // bgra
+				pixel[0] = (u8)(x ^ y);
+				pixel[1] = (u8)y;
+				pixel[2] = (u8)x;
+				pixel[3] = 255;
+			}
+			file.write((const char*)row.data(), row.size());
+		}
+	}
+
+	void TextureUpload(Harness& harness, std::vector<Result>& results)
+	{
+		for (u32 extent : { 256u, 1024u, 2048u })
+		{
+			std::filesystem::path path = harness.scratch_dir() / NA_FORMAT("texture_{}.tga", extent);
+			writeTga(path, extent, extent);
+
+			// decoding is not part of the upload, only done once
+			AssetHandle<Image> image = Image::Load(path);
+
+			// from the call until the upload and the mip chain completed on the gpu
+			std::vector<double> latencies;
+			for (u32 i = 0; i < harness.options().iterations; i++)
+			{
+				harness.idle();
+
+				u64 start = Profiler::Now();
+				Texture texture(image, harness.core().settings());
+				harness.idle();
+				latencies.push_back(elapsedMs(start));
+			}
+
+			Stats latency = Stats::Of(latencies);
+			results.push_back(Result{
+				"texture_upload",
+				{ { "width", (double)extent }, { "height", (double)extent }, { "mipmaps", (double)harness.core().settings().mipmaps } },
+				latency, Stats{},
+				{ { "bytes_per_second", throughput(image->size(), latency.p50) } }
+			});
+		}
+	}
+
+	void PipelineCreation(Harness& harness, std::vector<Result>& results)
+	{
+		static constexpr vk::CullModeFlagBits k_CullModes[] = { vk::CullModeFlagBits::eNone, vk::CullModeFlagBits::eBack, vk::CullModeFlagBits::eFront };
+		static constexpr BlendMode k_BlendModes[] = { BlendMode::Opaque, BlendMode::Alpha, BlendMode::Additive, BlendMode::Premultiplied };
+
+		// every iteration is a different state, the pipeline cache still remembers earlier runs
+		std::vector<double> times;
+		for (u32 i = 0; i < harness.options().iterations; i++)
+		{
+			PipelineState state = benchState();
+			state.cull_mode = k_CullModes[i % std::size(k_CullModes)];
+			state.blend = k_BlendModes[(i / std::size(k_CullModes)) % std::size(k_BlendModes)];
+			state.depth_test = (i / (std::size(k_CullModes) * std::size(k_BlendModes))) % 2;
+
+			u64 start = Profiler::Now();
+			GraphicsPipeline pipeline(harness.core(), { &harness.vertex_shader(), &harness.fragment_shader() }, state);
+			times.push_back(elapsedMs(start));
+		}
+
+		double first = times.empty() ? 0.0 : times.front();
+		results.push_back(Result{
+			"graphics_pipeline_creation",
+			{ { "pipelines", (double)harness.options().iterations } },
+			Stats::Of(std::move(times)), Stats{},
+			{ { "first_ms", first } }
+		});
+
+		harness.idle();
+	}
+
+	void SwapchainRecreation(Harness& harness, std::vector<Result>& results)
+	{
+		if (harness.options().headless)
+			return; // no swapchain
+
+		static constexpr u32 k_MaxFrames = 120; // for the window manager to apply the size
+
+		u32 width = harness.options().width, height = harness.options().height;
+
+		// the frame that recreated the swapchain, frames waiting for the size to settle are left out
+		std::vector<double> times;
+		u32 missed = 0;
+		for (u32 i = 0; i < harness.options().iterations; i++)
+		{
+			u32 target_width = i % 2 ? width : width * 3 / 4;
+			u32 target_height = i % 2 ? height : height * 3 / 4;
+			harness.window().set_size(target_width, target_height);
+
+			bool recreated = false;
+			for (u32 frame = 0; frame < k_MaxFrames && !recreated; frame++)
+			{
+				u64 start = Profiler::Now();
+				harness.frame();
+				double time = elapsedMs(start);
+
+				if (harness.core().width() == target_width && harness.core().height() == target_height)
+				{
+					times.push_back(time);
+					recreated = true;
+				}
+			}
+			missed += !recreated;
+		}
+
+		harness.window().set_size(width, height);
+		for (u32 frame = 0; frame < k_MaxFrames && harness.core().width() != width; frame++)
+			harness.frame();
+
+		results.push_back(Result{
+			"swapchain_recreation",
+			{ { "resizes", (double)harness.options().iterations } },
+			Stats::Of(std::move(times)), Stats{},
+			{ { "missed", (double)missed } }
+		});
+
+		harness.idle();
+	}
+} // namespace Na::Bench
\ No newline at end of file
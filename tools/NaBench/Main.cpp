@@ -0,0 +1,130 @@
+#include "Bench.hpp"
+
+using namespace Na;
+
+static void printUsage(const char* name)
+{
+	fmt::print(
+		stderr,
+		"Usage: {} [options]\n"
+		"  --headless          render offscreen, skips swapchain recreation\n"
+		"  --frames <n>        measured frames per workload (default 300)\n"
+		"  --warmup <n>        frames before measuring (default 30)\n"
+		"  --iterations <n>    repetitions of uploads and pipeline creation (default 20)\n"
+		"  --size <w>x<h>      render size (default 1280x720)\n"
+		"  --filter <name>     only workloads whose name contains it\n"
+		"  --out <file>        json report, stdout if not given\n",
+		name
+	);
+}
+
+// returns false on invalid arguments
+static bool parseOptions(int argc, char** argv, Bench::Options& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		auto number = [&](u32& out)
+		{
+			if (!value)
+				return false;
+			out = (u32)std::strtoul(value, nullptr, 10);
+			i++;
+			return true;
+		};
+
+		if (arg == "--headless")
+		{
+			options.headless = true;
+		} else if (arg == "--frames")
+		{
+			if (!number(options.frames))
+				return false;
+		} else if (arg == "--warmup")
+		{
+			if (!number(options.warmup_frames))
+				return false;
+		} else if (arg == "--iterations")
+		{
+			if (!number(options.iterations))
+				return false;
+		} else if (arg == "--size")
+		{
+			if (!value || std::sscanf(value, "%ux%u", &options.width, &options.height) != 2)
+				return false;
+			i++;
+		} else if (arg == "--filter")
+		{
+			if (!value)
+				return false;
+			options.filter = value;
+			i++;
+		} else if (arg == "--out")
+		{
+			if (!value)
+				return false;
+			options.output = value;
+			i++;
+		} else
+		{
+			return false;
+		}
+	}
+
+	return options.frames && options.width && options.height;
+}
+
+int main(int argc, char** argv)
+{
+	Bench::Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argc ? argv[0] : "NaBench");
+		return 1;
+	}
+
+	try
+	{
+		// the log goes to std::clog, i.e. stderr, so a report written to stdout stays clean
+
+		Bench::Harness harness(options);
+
+		using Workload = void(*)(Bench::Harness&, std::vector<Bench::Result>&);
+		static constexpr std::pair<std::string_view, Workload> k_Workloads[] = {
+			{ "draw_indexed", Bench::DrawIndexed },
+			{ "set_descriptor_buffer", Bench::DescriptorBuffer },
+			{ "vertex_buffer_upload", Bench::VertexUpload },
+			{ "texture_upload", Bench::TextureUpload },
+			{ "graphics_pipeline_creation", Bench::PipelineCreation },
+			{ "swapchain_recreation", Bench::SwapchainRecreation }
+		};
+
+		std::vector<Bench::Result> results;
+		for (auto [name, workload] : k_Workloads)
+		{
+			if (!harness.enabled(name))
+				continue;
+
+			g_Logger.fmt(Info, "Running {}", name);
+			workload(harness, results);
+		}
+
+		if (options.output.empty())
+		{
+			Bench::WriteJson(std::cout, options, results);
+		} else
+		{
+			std::ofstream out(options.output);
+			NA_VERIFY(out, "Failed to open {}!", options.output.string());
+			Bench::WriteJson(out, options, results);
+		}
+	} catch (const std::exception& e)
+	{
+		fmt::print(stderr, "{}\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "Natrium/PchBase.hpp"
+#include "Natrium/Core/BinaryLog.hpp"
+
+// NaLogDecode <log file> [output file], writes to stdout without an output file
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 3)
+	{
+		fmt::print(stderr, "Usage: {} <log file> [output file]\n", argc ? argv[0] : "NaLogDecode");
+		return 1;
+	}
+
+	try
+	{
+		if (argc == 3)
+		{
+			std::ofstream out(argv[2]);
+			if (!out)
+			{
+				fmt::print(stderr, "Failed to open {}!\n", argv[2]);
+				return 1;
+			}
+			Na::BinaryLog::Decode(argv[1], out);
+		} else
+		{
+			Na::BinaryLog::Decode(argv[1], std::cout);
+		}
+	} catch (const std::exception& e)
+	{
+		fmt::print(stderr, "{}\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
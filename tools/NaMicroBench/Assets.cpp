@@ -0,0 +1,150 @@
+#include "MicroBench.hpp"
+
+#include "Natrium/Assets/AssetRegistry.hpp"
+#include "Natrium/Assets/ModelAsset.hpp"
+#include "Natrium/Assets/ShaderAsset.hpp"
+
+#include <cmath>
+#include <numbers>
+
+namespace Na::Bench {
+	struct ReferenceMesh {
+		std::string_view name;
+		u32 segments, rings;
+	};
+
+	// uv spheres stand in for real meshes, so the inputs never change between commits
+	static constexpr ReferenceMesh k_ReferenceMeshes[] = {
+		{ "sphere_64.obj", 64, 32 },
+		{ "sphere_512.obj", 512, 256 }
+	};
+
+	// returns the triangle count
+	static u64 writeSphereObj(const std::filesystem::path& path, u32 segments, u32 rings)
+	{
+		std::ofstream file(path);
+		NA_VERIFY(file, "Failed to create {}!", path.string());
+
+		for (u32 ring = 0; ring <= rings; ring++)
+		{
+			double theta = std::numbers::pi * (double)ring / (double)rings;
+			for (u32 segment = 0; segment <= segments; segment++)
+			{
+				double phi = 2.0 * std::numbers::pi * (double)segment / (double)segments;
+				file << NA_FORMAT(
+					"v {:.6f} {:.6f} {:.6f}\nvt {:.6f} {:.6f}\n",
+					std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi),
+					(double)segment / (double)segments, (double)ring / (double)rings
+				);
+			}
+		}
+
+		u64 triangles = 0;
+		for (u32 ring = 0; ring < rings; ring++)
+		{
+			for (u32 segment = 0; segment < segments; segment++)
+			{
+				// obj indices start at 1
+				u32 a = ring * (segments + 1) + segment + 1;
+				u32 b = a + segments + 1;
+				file << NA_FORMAT("f {0}/{0} {1}/{1} {2}/{2}\nf {2}/{2} {3}/{3} {0}/{0}\n", a, b, b + 1, a + 1);
+				triangles += 2;
+			}
+		}
+		return triangles;
+	}
+
+	static void clearDirectory(const std::filesystem::path& dir)
+	{
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+			std::filesystem::remove_all(entry.path());
+	}
+
+	void Assets(Suite& suite)
+	{
+		std::filesystem::path asset_dir = suite.scratch_dir() / "assets";
+		std::filesystem::path cache_dir = suite.scratch_dir() / "cache";
+		std::filesystem::create_directories(asset_dir);
+		std::filesystem::create_directories(cache_dir);
+
+		// loadObj alone, without anything ModelAsset::optimize would do afterwards
+		static constexpr MeshOptimizeSettings k_ParseOnly{
+			.vertex_cache = false,
+			.overdraw = false,
+			.vertex_fetch = false,
+			.compact_indices = false,
+			.lod_count = 1
+		};
+
+		for (const ReferenceMesh& mesh : k_ReferenceMeshes)
+		{
+			std::filesystem::path path = asset_dir / mesh.name;
+			u64 triangles = writeSphereObj(path, mesh.segments, mesh.rings);
+			Values params = { { "triangles", (double)triangles } };
+
+			// per triangle, so meshes of different sizes compare
+			suite.run(NA_FORMAT("obj_parse.{}", mesh.name), params, triangles, [&]()
+			{
+				Consume((uintptr_t)ModelAsset::Load(path, k_ParseOnly).get());
+			});
+			suite.run(NA_FORMAT("obj_import.{}", mesh.name), params, triangles, [&]()
+			{
+				Consume((uintptr_t)ModelAsset::Load(path).get());
+			});
+		}
+
+		{
+			static constexpr u64 k_Lookups = 1000;
+			std::string_view name = k_ReferenceMeshes[0].name;
+
+			AssetRegistry registry(asset_dir, cache_dir, 1);
+
+			// the first load imports the obj and writes the .namesh cache
+			AssetHandle<ModelAsset> held = registry.load_asset<ModelAsset>(name);
+			suite.run("asset_registry.hit", {}, k_Lookups, [&]()
+			{
+				for (u64 i = 0; i < k_Lookups; i++)
+					Consume((uintptr_t)registry.load_asset<ModelAsset>(name).get());
+			});
+			held.reset();
+
+			suite.run("asset_registry.disk_cache", {}, 1, [&]()
+			{
+				Consume((uintptr_t)registry.load_asset<ModelAsset>(name).get());
+			}, [&]()
+			{
+				registry.free_asset(name);
+			});
+
+			suite.run("asset_registry.uncached", {}, 1, [&]()
+			{
+				Consume((uintptr_t)registry.load_asset<ModelAsset>(name).get());
+			}, [&]()
+			{
+				registry.free_asset(name);
+				clearDirectory(cache_dir);
+			});
+		}
+
+		// ShaderBinary::Load only maps the words, the contents do not have to be a valid module
+		for (u64 size : { 16ull * 1024, 1024ull * 1024 })
+		{
+			std::filesystem::path path = asset_dir / NA_FORMAT("shader_{}.spv", size);
+			{
+				std::vector<u32> words(size / sizeof(u32));
+				for (u64 i = 0; i < words.size(); i++)
+					words[i] = (u32)(i * 2654435761u);
+				words[0] = 0x07230203; // the spir-v magic, for tools looking at the file
+
+				std::ofstream file(path, std::ios::binary);
+				NA_VERIFY(file, "Failed to create {}!", path.string());
+				file.write((const char*)words.data(), size);
+			}
+
+			suite.run(NA_FORMAT("load_spv.{}", size), { { "bytes", (double)size } }, 1, [&]()
+			{
+				Consume(ShaderBinary::Load(path)->size());
+			});
+		}
+	}
+} // namespace Na::Bench
\ No newline at end of file
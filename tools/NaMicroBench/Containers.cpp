@@ -0,0 +1,186 @@
+#include "MicroBench.hpp"
+
+#include <random>
+
+namespace Na::Bench {
+	// the size of a small component, big enough that copies are not free
+	struct Payload {
+		u64 values[8];
+
+		Payload(void) = default;
+		inline Payload(u64 value) { for (u64& v : values) v = value; }
+
+		[[nodiscard]] inline u64 key(void) const { return values[0]; }
+	};
+
+	[[nodiscard]] static inline u64 keyOf(u64 value) { return value; }
+	[[nodiscard]] static inline u64 keyOf(const Payload& value) { return value.key(); }
+
+	// one spelling of every operation per container
+	template<typename T> inline void pushBack(std::vector<T>& c, const T& value) { c.push_back(value); }
+	template<typename T> inline void pushBack(std::list<T>& c, const T& value) { c.push_back(value); }
+	template<typename T> inline void pushBack(ArrayList<T>& c, const T& value) { c.emplace(value); }
+	template<typename T> inline void pushBack(ArrayVector<T>& c, const T& value) { c.emplace(value); }
+	template<typename T> inline void pushBack(DoubleList<T>& c, const T& value) { c.emplace_back(value); }
+
+	template<typename T> inline void popBack(std::vector<T>& c) { c.pop_back(); }
+	template<typename T> inline void popBack(std::list<T>& c) { c.pop_back(); }
+	template<typename T> inline void popBack(ArrayList<T>& c) { c.pop(); }
+	template<typename T> inline void popBack(ArrayVector<T>& c) { c.pop(); }
+	template<typename T> inline void popBack(DoubleList<T>& c) { c.pop_back(); }
+
+	template<typename T> inline void pushFront(std::list<T>& c, const T& value) { c.push_front(value); }
+	template<typename T> inline void pushFront(DoubleList<T>& c, const T& value) { c.emplace_front(value); }
+
+	template<typename T> inline void popFront(std::list<T>& c) { c.pop_front(); }
+	template<typename T> inline void popFront(DoubleList<T>& c) { c.pop_front(); }
+
+	// the arrays have no insert, so they shift like LayerManager does
+	template<typename t_Array, typename T>
+	static inline void insertArray(t_Array& c, const T& value)
+	{
+		u64 index = c.size() / 2;
+		c.emplace(value);
+		std::rotate(c.ptr() + index, c.ptr() + c.size() - 1, c.ptr() + c.size());
+	}
+
+	template<typename t_Array>
+	static inline void eraseArray(t_Array& c)
+	{
+		u64 index = c.size() / 2;
+		std::move(c.ptr() + index + 1, c.ptr() + c.size(), c.ptr() + index);
+		c.pop();
+	}
+
+	// at the middle, the lists walk there first
+	template<typename T> inline void insertMiddle(std::vector<T>& c, const T& value) { c.insert(c.begin() + c.size() / 2, value); }
+	template<typename T> inline void insertMiddle(std::list<T>& c, const T& value) { c.insert(std::next(c.begin(), c.size() / 2), value); }
+	template<typename T> inline void insertMiddle(ArrayList<T>& c, const T& value) { insertArray(c, value); }
+	template<typename T> inline void insertMiddle(ArrayVector<T>& c, const T& value) { insertArray(c, value); }
+	template<typename T> inline void insertMiddle(DoubleList<T>& c, const T& value) { c.emplace_at(c.size() / 2, value); }
+
+	template<typename T> inline void eraseMiddle(std::vector<T>& c) { c.erase(c.begin() + c.size() / 2); }
+	template<typename T> inline void eraseMiddle(std::list<T>& c) { c.erase(std::next(c.begin(), c.size() / 2)); }
+	template<typename T> inline void eraseMiddle(ArrayList<T>& c) { eraseArray(c); }
+	template<typename T> inline void eraseMiddle(ArrayVector<T>& c) { eraseArray(c); }
+	template<typename T> inline void eraseMiddle(DoubleList<T>& c) { c.pop_at(c.size() / 2); }
+
+	// the same pseudo random values for every container
+	template<typename T>
+	static std::vector<T> makeValues(u64 count)
+	{
+		std::mt19937_64 random(0x4E41424E43484D4Bull);
+		std::vector<T> values;
+		values.reserve(count);
+		for (u64 i = 0; i < count; i++)
+			values.emplace_back(T(random()));
+		return values;
+	}
+
+	template<typename t_Container, typename T>
+	static void benchSequence(Suite& suite, std::string_view container, std::string_view type, const std::vector<T>& values)
+	{
+		u64 count = values.size();
+		Values params = { { "count", (double)count } };
+
+		// includes growing from empty and destroying the container again
+		suite.run(NA_FORMAT("push_back.{}.{}", container, type), params, count, [&]()
+		{
+			t_Container c;
+			for (const T& value : values)
+				pushBack(c, value);
+			Consume(keyOf(*c.begin()));
+		});
+
+		t_Container filled;
+		for (const T& value : values)
+			pushBack(filled, value);
+
+		suite.run(NA_FORMAT("iterate.{}.{}", container, type), params, count, [&]()
+		{
+			u64 sum = 0;
+			for (const T& value : filled)
+				sum += keyOf(value);
+			Consume(sum);
+		});
+
+		t_Container popped;
+		suite.run(NA_FORMAT("pop_back.{}.{}", container, type), params, count, [&]()
+		{
+			for (u64 i = 0; i < count; i++)
+				popBack(popped);
+		}, [&]()
+		{
+			for (const T& value : values)
+				pushBack(popped, value);
+		});
+
+		if constexpr (requires(t_Container& c, const T& value) { pushFront(c, value); popFront(c); })
+		{
+			suite.run(NA_FORMAT("push_front.{}.{}", container, type), params, count, [&]()
+			{
+				t_Container c;
+				for (const T& value : values)
+					pushFront(c, value);
+				Consume(keyOf(*c.begin()));
+			});
+
+			suite.run(NA_FORMAT("pop_front.{}.{}", container, type), params, count, [&]()
+			{
+				for (u64 i = 0; i < count; i++)
+					popFront(popped);
+			}, [&]()
+			{
+				for (const T& value : values)
+					pushBack(popped, value);
+			});
+		}
+
+		// every one is linear, so only a slice of the values goes in and out
+		u64 middle_count = std::min<u64>(count, 256);
+		Values middle_params = { { "count", (double)count }, { "operations", (double)middle_count } };
+
+		t_Container middle;
+		auto refill = [&]()
+		{
+			middle = t_Container();
+			for (const T& value : values)
+				pushBack(middle, value);
+		};
+
+		suite.run(NA_FORMAT("insert_middle.{}.{}", container, type), middle_params, middle_count, [&]()
+		{
+			for (u64 i = 0; i < middle_count; i++)
+				insertMiddle(middle, values[i]);
+			Consume(keyOf(*middle.begin()));
+		}, refill);
+
+		suite.run(NA_FORMAT("erase_middle.{}.{}", container, type), middle_params, middle_count, [&]()
+		{
+			for (u64 i = 0; i < middle_count; i++)
+				eraseMiddle(middle);
+			Consume(keyOf(*middle.begin()));
+		}, refill);
+	}
+
+	template<typename T>
+	static void benchType(Suite& suite, std::string_view type, u64 count)
+	{
+		std::vector<T> values = makeValues<T>(count);
+
+		benchSequence<std::vector<T>>(suite, "std::vector", type, values);
+		benchSequence<ArrayList<T>>(suite, "ArrayList", type, values);
+		benchSequence<ArrayVector<T>>(suite, "ArrayVector", type, values);
+		benchSequence<std::list<T>>(suite, "std::list", type, values);
+		benchSequence<DoubleList<T>>(suite, "DoubleList", type, values);
+	}
+
+	void Containers(Suite& suite)
+	{
+		for (u64 count : { 1024ull, 65536ull })
+		{
+			benchType<u64>(suite, "u64", count);
+			benchType<Payload>(suite, "Payload64", count);
+		}
+	}
+} // namespace Na::Bench
\ No newline at end of file
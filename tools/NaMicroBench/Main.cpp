@@ -0,0 +1,92 @@
+#include "MicroBench.hpp"
+
+#include "Natrium/Main.hpp"
+#include "Natrium/Core/Logger.hpp"
+#include "Natrium/Core/JobSystem.hpp"
+
+using namespace Na;
+
+static void printUsage(const char* name)
+{
+	fmt::print(
+		stderr,
+		"Usage: {} [options]\n"
+		"  --samples <n>       measured samples per case (default 50)\n"
+		"  --warmup <n>        samples before measuring (default 5)\n"
+		"  --filter <name>     only cases whose name contains it, e.g. DoubleList\n"
+		"  --label <text>      stored in the report, e.g. the commit being measured\n"
+		"  --out <file>        json report, stdout if not given\n",
+		name
+	);
+}
+
+// returns false on invalid arguments
+static bool parseOptions(int argc, char** argv, Bench::Options& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value)
+			return false;
+
+		if (arg == "--samples")
+			options.samples = (u32)std::strtoul(value, nullptr, 10);
+		else if (arg == "--warmup")
+			options.warmup_samples = (u32)std::strtoul(value, nullptr, 10);
+		else if (arg == "--filter")
+			options.filter = value;
+		else if (arg == "--label")
+			options.label = value;
+		else if (arg == "--out")
+			options.output = value;
+		else
+			return false;
+
+		i++;
+	}
+
+	return options.samples;
+}
+
+int main(int argc, char** argv)
+{
+	Bench::Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argc ? argv[0] : "NaMicroBench");
+		return 1;
+	}
+
+	// the log goes to stdout, keep it apart from a report written there
+	if (options.output.empty())
+		g_Logger.stream = &std::cerr;
+
+	// cpu only, the obj import is the only user of the workers
+	JobSystem::Initialize();
+
+	try
+	{
+		Bench::Suite suite(options);
+		Bench::Containers(suite);
+		Bench::Assets(suite);
+
+		if (options.output.empty())
+		{
+			suite.write_json(std::cout);
+		} else
+		{
+			std::ofstream out(options.output);
+			NA_VERIFY(out, "Failed to open {}!", options.output.string());
+			suite.write_json(out);
+		}
+	} catch (const std::exception& e)
+	{
+		JobSystem::Shutdown();
+		fmt::print(stderr, "{}\n", e.what());
+		return 1;
+	}
+
+	JobSystem::Shutdown();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "MicroBench.hpp"
+
+namespace Na::Bench {
+	static volatile u64 s_Sink = 0;
+
+	void Consume(u64 value) { s_Sink = s_Sink + value; }
+
+	Suite::Suite(const Options& options)
+	: m_Options(options)
+	{
+		m_ScratchDir = std::filesystem::temp_directory_path() / NA_FORMAT("NaMicroBench-{}", Profiler::Now());
+		std::filesystem::create_directories(m_ScratchDir);
+	}
+
+	Suite::~Suite(void)
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_ScratchDir, error);
+	}
+
+	static std::string_view buildConfigName(void)
+	{
+		switch (k_BuildConfig)
+		{
+		case BuildConfig::Debug:        return "debug";
+		case BuildConfig::Release:      return "release";
+		case BuildConfig::Distribution: return "dist";
+		default:                        return "unknown";
+		}
+	}
+
+	void Suite::write_json(std::ostream& out) const
+	{
+		out << "{\n";
+		out << "\t\"version\": 1,\n";
+		out << NA_FORMAT("\t\"label\": \"{}\",\n", EscapeJson(m_Options.label));
+		out << NA_FORMAT("\t\"config\": \"{}\",\n", buildConfigName());
+		out << NA_FORMAT("\t\"hardware_threads\": {},\n", std::thread::hardware_concurrency());
+		out << NA_FORMAT("\t\"samples\": {},\n\t\"warmup_samples\": {},\n", m_Options.samples, m_Options.warmup_samples);
+		out << "\t\"results\": [";
+
+		for (u64 i = 0; i < m_Results.size(); i++)
+		{
+			const Result& result = m_Results[i];
+			out << (i ? ",\n" : "\n");
+			out << NA_FORMAT("\t\t{{\n\t\t\t\"name\": \"{}\",\n\t\t\t\"params\": ", result.name);
+			WriteValues(out, result.params);
+			out << ",\n\t\t\t\"ns_per_item\": ";
+			WriteStats(out, result.ns_per_item);
+			out << ",\n\t\t\t\"metrics\": ";
+			WriteValues(out, result.metrics);
+			out << "\n\t\t}";
+		}
+
+		out << "\n\t]\n}\n";
+	}
+} // namespace Na::Bench
\ No newline at end of file
@@ -0,0 +1,90 @@
+#if !defined(NA_MICRO_BENCH_HPP)
+#define NA_MICRO_BENCH_HPP
+
+#include "BenchCommon/BenchStats.hpp"
+#include "Natrium/Core/Profiler.hpp"
+
+namespace Na::Bench {
+	struct Result {
+		std::string name;
+		Values params; // e.g. the container, element type and count
+		Stats ns_per_item; // nanoseconds per element, lookup, file, ...
+		Values metrics;
+	};
+
+	struct Options {
+		u32 samples = 50; // measured per case, after warmup_samples
+		u32 warmup_samples = 5;
+
+		std::string filter; // only cases whose name contains it
+		std::string label; // written to the report as is, e.g. a commit hash
+		std::filesystem::path output; // stdout if empty
+	};
+
+	/// 
+	/// runs every case as samples timed calls of its body, each processing items items,
+	/// setup runs before every call and is not timed, e.g. to refill a container
+	/// 
+	/// inputs are generated from fixed seeds, so reports of different commits
+	/// on the same machine measure exactly the same work
+	/// 
+	class Suite {
+	public:
+		Suite(const Options& options);
+		~Suite(void);
+
+		Suite(const Suite& other) = delete;
+		Suite& operator=(const Suite& other) = delete;
+
+		template<typename t_Body>
+		void run(std::string_view name, Values params, u64 items, t_Body&& body, const std::function<void(void)>& setup = {})
+		{
+			if (!this->enabled(name))
+				return;
+
+			std::vector<double> samples;
+			samples.reserve(m_Options.samples);
+
+			for (u32 i = 0; i < m_Options.warmup_samples + m_Options.samples; i++)
+			{
+				if (setup)
+					setup();
+
+				u64 start = Profiler::Now();
+				body();
+				u64 end = Profiler::Now();
+
+				if (i >= m_Options.warmup_samples)
+					samples.push_back((double)(end - start) / (double)std::max<u64>(items, 1));
+			}
+
+			m_Results.push_back(Result{ std::string(name), std::move(params), Stats::Of(std::move(samples)), {} });
+		}
+
+		// adds to the metrics of the last case run
+		inline void metric(std::string_view name, double value) { if (!m_Results.empty()) m_Results.back().metrics.emplace_back(name, value); }
+
+		[[nodiscard]] inline bool enabled(std::string_view name) const { return m_Options.filter.empty() || name.find(m_Options.filter) != std::string_view::npos; }
+
+		void write_json(std::ostream& out) const;
+
+		[[nodiscard]] inline const Options& options(void) const { return m_Options; }
+		[[nodiscard]] inline const std::vector<Result>& results(void) const { return m_Results; }
+
+		// a temporary directory for generated files, removed on destruction
+		[[nodiscard]] inline const std::filesystem::path& scratch_dir(void) const { return m_ScratchDir; }
+	private:
+		Options m_Options;
+		std::vector<Result> m_Results;
+
+		std::filesystem::path m_ScratchDir;
+	};
+
+	// keeps the compiler from dropping work whose result is otherwise unused
+	void Consume(u64 value);
+
+	void Containers(Suite& suite);
+	void Assets(Suite& suite);
+} // namespace Na::Bench
+
+#endif // NA_MICRO_BENCH_HPP
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "Natrium/PchBase.hpp"
+#include "Natrium/Assets/AssetPack.hpp"
+
+// NaPack <asset dir> <output file> [--store], packs every file under the asset dir, --store skips compression
+int main(int argc, char** argv)
+{
+	if (argc < 3 || argc > 4 || (argc == 4 && std::string_view(argv[3]) != "--store"))
+	{
+		fmt::print(stderr, "Usage: {} <asset dir> <output file> [--store]\n", argc ? argv[0] : "NaPack");
+		return 1;
+	}
+
+	try
+	{
+		Na::PackCompression compression = argc == 4 ? Na::PackCompression::None : Na::PackCompression::LZ4;
+
+		Na::AssetPackWriter writer;
+		u64 file_count = writer.add_directory(argv[1], compression);
+		writer.write(argv[2]);
+
+		fmt::print("Packed {} files into {} ({} entries, {} bytes of data)\n", file_count, argv[2], writer.entry_count(), writer.stored_size());
+	} catch (const std::exception& e)
+	{
+		fmt::print(stderr, "{}\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file